@@ -103,6 +103,26 @@
 #define BROTLI_WINDOW_GAP 16
 #define BROTLI_MAX_BACKWARD_LIMIT(W) (((size_t)1 << (W)) - BROTLI_WINDOW_GAP)
 
+/* Restart-point frames (not part of RFC 7932). Every chunk of a stream encoded
+   with BROTLI_PARAM_RESTART_POINTS is preceded by a metadata block with the
+   following content (multi-byte values are little-endian):
+     4 bytes: BROTLI_FRAME_MAGIC
+     1 byte: flags
+     8 bytes: decompressed size of the chunk
+     8 bytes: compressed size of the chunk, i.e. number of bytes after the
+              end of this metadata block
+   Chunk with BROTLI_FRAME_FLAG_RESTART does not reference preceding data, and
+   could be decoded from the default decoder state; if chunk does not start
+   the stream, backward distances are limited by the window size only.
+   Chunk with BROTLI_FRAME_FLAG_DICTIONARY might reference a custom dictionary
+   that is not recorded in the stream. Regular decoders skip the metadata
+   blocks. */
+#define BROTLI_FRAME_MAGIC 0x4652429Bu
+#define BROTLI_FRAME_SIZE 21
+#define BROTLI_FRAME_FLAG_RESTART 1
+#define BROTLI_FRAME_FLAG_LAST 2
+#define BROTLI_FRAME_FLAG_DICTIONARY 4
+
 typedef struct BrotliDistanceCodeLimit {
   uint32_t max_alphabet_size;
   uint32_t max_distance;
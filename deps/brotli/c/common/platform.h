@@ -193,6 +193,15 @@ OR:
 #define BROTLI_TARGET_NEON
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BROTLI_TARGET_SSE2
+#endif
+
+#if defined(__AVX2__)
+#define BROTLI_TARGET_AVX2
+#endif
+
 #if defined(__i386) || defined(_M_IX86)
 #define BROTLI_TARGET_X86
 #endif
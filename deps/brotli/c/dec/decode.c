@@ -25,6 +25,10 @@
 #include <arm_neon.h>
 #endif
 
+#if defined(BROTLI_DECODER_THREADS)
+#include <pthread.h>
+#endif
+
 #if defined(__cplusplus) || defined(c_plusplus)
 extern "C" {
 #endif
@@ -44,7 +48,8 @@ extern "C" {
     - doing up to two 16-byte copies for fast backward copying
     - inserting transformed dictionary word:
         255 prefix + 32 base + 255 suffix */
-static const brotli_reg_t kRingBufferWriteAheadSlack = 542;
+static const brotli_reg_t kRingBufferWriteAheadSlack =
+    BROTLI_DECODER_DIRECT_SLACK;
 
 static const uint8_t kCodeLengthCodeOrder[BROTLI_CODE_LENGTH_CODES] = {
   1, 2, 3, 4, 0, 5, 17, 6, 16, 7, 8, 9, 10, 11, 12, 13, 14, 15,
@@ -1289,7 +1294,10 @@ static BrotliDecoderErrorCode BROTLI_NOINLINE WriteRingBuffer(
     *next_out = start;
   } else {
     if (next_out) {
-      memcpy(*next_out, start, num_written);
+      /* Output is already in place when decoding directly into it. */
+      if (*next_out != start) {
+        memcpy(*next_out, start, num_written);
+      }
       *next_out += num_written;
     }
   }
@@ -1308,7 +1316,8 @@ static BrotliDecoderErrorCode BROTLI_NOINLINE WriteRingBuffer(
     }
   }
   /* Wrap ring buffer only if it has reached its maximal size. */
-  if (s->ringbuffer_size == (1 << s->window_bits) &&
+  if (!s->external_ringbuffer &&
+      s->ringbuffer_size == (1 << s->window_bits) &&
       s->pos >= s->ringbuffer_size) {
     s->pos -= s->ringbuffer_size;
     s->rb_roundtrips++;
@@ -1345,6 +1354,11 @@ static BROTLI_BOOL BROTLI_NOINLINE BrotliEnsureRingBuffer(
     s->ringbuffer = old_ringbuffer;
     return BROTLI_FALSE;
   }
+  if (s->is_restart_segment) {
+    /* Distances up to the window size are valid from the very beginning;
+       do not expose stale heap contents on corrupted input. */
+    memset(s->ringbuffer, 0, (size_t)s->new_ringbuffer_size);
+  }
   s->ringbuffer[s->new_ringbuffer_size - 2] = 0;
   s->ringbuffer[s->new_ringbuffer_size - 1] = 0;
 
@@ -1434,7 +1448,8 @@ static BrotliDecoderErrorCode BROTLI_NOINLINE CopyUncompressedBlockToOutput(
         BrotliCopyBytes(&s->ringbuffer[s->pos], &s->br, (size_t)nbytes);
         s->pos += nbytes;
         s->meta_block_remaining_len -= nbytes;
-        if (s->pos < 1 << s->window_bits) {
+        /* External ring-buffer is never wrapped; whole meta-block fits. */
+        if (s->pos < 1 << s->window_bits || s->external_ringbuffer) {
           if (s->meta_block_remaining_len == 0) {
             return BROTLI_DECODER_SUCCESS;
           }
@@ -1879,6 +1894,15 @@ static BROTLI_INLINE BROTLI_BOOL SafeReadCommand(
   return ReadCommandInternal(1, s, br, insert_length);
 }
 
+/* Returns the byte |back| positions before |pos|, used for context modeling.
+   Regular ring-buffer keeps zeroes in its last two bytes for the stream start;
+   external output buffer has no such tail, hence the explicit check. */
+static BROTLI_INLINE uint8_t PrecedingByte(
+    const BrotliDecoderState* s, int pos, int back) {
+  if (BROTLI_PREDICT_FALSE(pos < back) && s->external_ringbuffer) return 0;
+  return s->ringbuffer[(pos - back) & s->ringbuffer_mask];
+}
+
 static BROTLI_INLINE BROTLI_BOOL CheckInputAmount(
     int safe, BrotliBitReader* const br) {
   if (safe) {
@@ -1989,8 +2013,8 @@ CommandInner:
       }
     } while (--i != 0);
   } else {
-    uint8_t p1 = s->ringbuffer[(pos - 1) & s->ringbuffer_mask];
-    uint8_t p2 = s->ringbuffer[(pos - 2) & s->ringbuffer_mask];
+    uint8_t p1 = PrecedingByte(s, pos, 1);
+    uint8_t p2 = PrecedingByte(s, pos, 2);
     do {
       const HuffmanCode* hc;
       uint8_t context;
@@ -2082,8 +2106,8 @@ CommandPostDecodeLiterals:
       }
     } else if (i >= SHARED_BROTLI_MIN_DICTIONARY_WORD_LENGTH &&
                i <= SHARED_BROTLI_MAX_DICTIONARY_WORD_LENGTH) {
-      uint8_t p1 = s->ringbuffer[(pos - 1) & s->ringbuffer_mask];
-      uint8_t p2 = s->ringbuffer[(pos - 2) & s->ringbuffer_mask];
+      uint8_t p1 = PrecedingByte(s, pos, 1);
+      uint8_t p2 = PrecedingByte(s, pos, 2);
       uint8_t dict_id = s->dictionary->context_based ?
           s->dictionary->context_map[BROTLI_CONTEXT(p1, p2, s->context_lookup)]
           : 0;
@@ -2286,6 +2310,317 @@ BrotliDecoderResult BrotliDecoderDecompress(
   return result;
 }
 
+BrotliDecoderResult BrotliDecoderDecompressDirect(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size,
+    uint8_t decoded_buffer[BROTLI_ARRAY_PARAM(*decoded_size)]) {
+  BrotliDecoderState s;
+  BrotliDecoderResult result;
+  size_t total_out = 0;
+  size_t available_in = encoded_size;
+  const uint8_t* next_in = encoded_buffer;
+  size_t available_out;
+  uint8_t* next_out = decoded_buffer;
+  size_t limit = *decoded_size;
+  *decoded_size = 0;
+  if (limit < kRingBufferWriteAheadSlack) {
+    return BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+  }
+  /* Tail of the buffer is the write-ahead slack. Positions are kept far from
+     int overflow. */
+  limit -= kRingBufferWriteAheadSlack;
+  if (limit > ((size_t)1 << 30)) limit = (size_t)1 << 30;
+  if (!BrotliDecoderStateInit(&s, 0, 0, 0)) {
+    return BROTLI_DECODER_RESULT_ERROR;
+  }
+  /* Mask is never applied to a position outside of [0, limit), because
+     distances beyond the current position are dictionary references. */
+  s.external_ringbuffer = 1;
+  s.ringbuffer = decoded_buffer;
+  s.ringbuffer_size = (int)limit;
+  s.new_ringbuffer_size = (int)limit;
+  s.ringbuffer_mask = 0x7FFFFFFF;
+  s.ringbuffer_end = decoded_buffer + limit;
+  available_out = limit;
+  result = BrotliDecoderDecompressStream(
+      &s, &available_in, &next_in, &available_out, &next_out, &total_out);
+  *decoded_size = total_out;
+  BrotliDecoderStateCleanup(&s);
+  if (result == BROTLI_DECODER_RESULT_SUCCESS && available_in != 0) {
+    /* Trailing garbage. */
+    result = BROTLI_DECODER_RESULT_ERROR;
+  } else if (result != BROTLI_DECODER_RESULT_SUCCESS &&
+      result != BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+    result = BROTLI_DECODER_RESULT_ERROR;
+  }
+  return result;
+}
+
+/* Parallel decompression of framed streams (BROTLI_PARAM_RESTART_POINTS).
+
+   Stream is walked through its frame metadata blocks (see BROTLI_FRAME_MAGIC).
+   Every restart point starts a unit that spans the following segments up to
+   the next restart point; units are decoded by separate decoder instances
+   directly into their place in the output. */
+
+typedef struct BrotliFrameReader {
+  const uint8_t* data;
+  size_t size;
+  size_t bit_pos;
+} BrotliFrameReader;
+
+static BROTLI_BOOL FrameReadBits(BrotliFrameReader* r, uint32_t n_bits,
+                                 uint32_t* val) {
+  uint32_t i;
+  *val = 0;
+  for (i = 0; i < n_bits; ++i) {
+    size_t byte = r->bit_pos >> 3;
+    if (byte >= r->size) return BROTLI_FALSE;
+    *val |= (uint32_t)((r->data[byte] >> (r->bit_pos & 7)) & 1) << i;
+    r->bit_pos++;
+  }
+  return BROTLI_TRUE;
+}
+
+typedef struct BrotliDecoderUnit {
+  const uint8_t* input;
+  size_t input_size;
+  size_t output_offset;
+  size_t output_size;
+  uint8_t* output;
+  BROTLI_BOOL is_restart;
+  BROTLI_BOOL is_last;
+  int window_bits;
+  BROTLI_BOOL result;
+} BrotliDecoderUnit;
+
+/* Returns the number of units in a framed stream, or 0 if stream is not
+   framed (or is a large window stream). Units are stored to |units|, if it is
+   not NULL; decompressed size is stored to |*total_size|, and whether any
+   frame refers to a custom dictionary to |*has_dictionary|. */
+static size_t FindDecoderUnits(size_t size, const uint8_t* data,
+    BrotliDecoderUnit* units, size_t* total_size,
+    BROTLI_BOOL* has_dictionary) {
+  BrotliFrameReader r;
+  BrotliDecoderUnit* unit = NULL;
+  size_t num_units = 0;
+  size_t position = 0;
+  uint32_t bits;
+  int window_bits;
+  r.data = data;
+  r.size = size;
+  r.bit_pos = 0;
+  *has_dictionary = BROTLI_FALSE;
+
+  /* Stream header, see DecodeWindowBits. */
+  if (!FrameReadBits(&r, 1, &bits)) return 0;
+  if (bits == 0) {
+    window_bits = 16;
+  } else {
+    if (!FrameReadBits(&r, 3, &bits)) return 0;
+    if (bits != 0) {
+      window_bits = 17 + (int)bits;
+    } else {
+      if (!FrameReadBits(&r, 3, &bits) || bits == 1) return 0;
+      window_bits = (bits != 0) ? 8 + (int)bits : 17;
+    }
+  }
+
+  while (BROTLI_TRUE) {
+    uint32_t skip_bytes;
+    size_t length = 0;
+    size_t content;
+    const uint8_t* frame;
+    uint64_t decompressed_size;
+    uint64_t compressed_size;
+    uint32_t i;
+
+    /* Only metadata blocks are expected between segments: ISLAST = 0,
+       MNIBBLES = 0 (encoded as 3), reserved bit. */
+    if (!FrameReadBits(&r, 4, &bits) || bits != 6) return 0;
+    if (!FrameReadBits(&r, 2, &skip_bytes)) return 0;
+    for (i = 0; i < skip_bytes; ++i) {
+      if (!FrameReadBits(&r, 8, &bits)) return 0;
+      length |= (size_t)bits << (8 * i);
+    }
+    if (skip_bytes != 0) length++;
+    content = (r.bit_pos + 7) >> 3;
+    if (content > size || length > size - content) return 0;
+    r.bit_pos = (content + length) << 3;
+    frame = data + content;
+    if (length != BROTLI_FRAME_SIZE ||
+        BROTLI_UNALIGNED_LOAD32LE(frame) != BROTLI_FRAME_MAGIC) {
+      continue;
+    }
+
+    content += length;
+    decompressed_size = BROTLI_UNALIGNED_LOAD64LE(frame + 5);
+    compressed_size = BROTLI_UNALIGNED_LOAD64LE(frame + 13);
+    if (compressed_size == 0 || compressed_size > size - content ||
+        decompressed_size > (uint64_t)(~(size_t)0 - position)) {
+      return 0;
+    }
+    if (frame[4] & BROTLI_FRAME_FLAG_DICTIONARY) {
+      *has_dictionary = BROTLI_TRUE;
+    }
+    if (frame[4] & BROTLI_FRAME_FLAG_RESTART) {
+      unit = units ? &units[num_units] : NULL;
+      num_units++;
+      if (unit) {
+        unit->input = data + content;
+        unit->output_offset = position;
+        unit->output_size = 0;
+        unit->is_restart = TO_BROTLI_BOOL(position != 0);
+        unit->window_bits = window_bits;
+      }
+    } else if (num_units == 0) {
+      /* Stream does not start with a restart point. */
+      return 0;
+    }
+    content += (size_t)compressed_size;
+    position += (size_t)decompressed_size;
+    r.bit_pos = content << 3;
+    if (unit) {
+      unit->input_size = (size_t)(data + content - unit->input);
+      unit->output_size = position - unit->output_offset;
+      unit->is_last = TO_BROTLI_BOOL(frame[4] & BROTLI_FRAME_FLAG_LAST);
+    }
+    if (frame[4] & BROTLI_FRAME_FLAG_LAST) break;
+  }
+  *total_size = position;
+  return num_units;
+}
+
+static void DecodeUnit(BrotliDecoderUnit* unit) {
+  BrotliDecoderState s;
+  BrotliDecoderResult result;
+  size_t available_in = unit->input_size;
+  const uint8_t* next_in = unit->input;
+  size_t available_out = unit->output_size;
+  uint8_t* next_out = unit->output;
+  unit->result = BROTLI_FALSE;
+  if (!BrotliDecoderStateInit(&s, 0, 0, 0)) return;
+  s.is_segment = 1;
+  s.is_restart_segment = unit->is_restart ? 1 : 0;
+  s.window_bits = (unsigned int)unit->window_bits;
+  result = BrotliDecoderDecompressStream(
+      &s, &available_in, &next_in, &available_out, &next_out, NULL);
+  /* Unit that is not last ends in the middle of the stream. */
+  unit->result = TO_BROTLI_BOOL(available_out == 0 && (unit->is_last ?
+      result == BROTLI_DECODER_RESULT_SUCCESS :
+      (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT &&
+       available_in == 0)));
+  BrotliDecoderStateCleanup(&s);
+}
+
+typedef struct BrotliDecoderWorker {
+  BrotliDecoderUnit* units;
+  size_t num_units;
+  size_t first;
+  size_t stride;
+#if defined(BROTLI_DECODER_THREADS)
+  pthread_t thread;
+  BROTLI_BOOL has_thread;
+#endif
+} BrotliDecoderWorker;
+
+static void* DecodeUnits(void* opaque) {
+  BrotliDecoderWorker* worker = (BrotliDecoderWorker*)opaque;
+  size_t i;
+  for (i = worker->first; i < worker->num_units; i += worker->stride) {
+    DecodeUnit(&worker->units[i]);
+  }
+  return NULL;
+}
+
+BROTLI_BOOL BrotliDecoderGetDecodedSize(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size) {
+  size_t total_size = 0;
+  BROTLI_BOOL has_dictionary;
+  if (FindDecoderUnits(encoded_size, encoded_buffer, NULL, &total_size,
+                       &has_dictionary) == 0) {
+    return BROTLI_FALSE;
+  }
+  *decoded_size = total_size;
+  return BROTLI_TRUE;
+}
+
+BrotliDecoderResult BrotliDecoderDecompressParallel(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size,
+    uint8_t decoded_buffer[BROTLI_ARRAY_PARAM(*decoded_size)],
+    int num_threads) {
+  BrotliDecoderWorker workers[BROTLI_DECODER_MAX_NUM_THREADS];
+  BrotliDecoderUnit* units;
+  BROTLI_BOOL result = BROTLI_TRUE;
+  BROTLI_BOOL has_dictionary;
+  size_t total_size = 0;
+  size_t num_workers;
+  size_t num_units;
+  size_t i;
+
+  num_units = FindDecoderUnits(encoded_size, encoded_buffer, NULL, &total_size,
+                               &has_dictionary);
+  /* There is no way to attach the dictionary; decoding would produce garbage
+     or fail somewhere in the middle. */
+  if (has_dictionary) {
+    *decoded_size = 0;
+    return BROTLI_DECODER_RESULT_ERROR;
+  }
+  if (num_units < 2 || num_threads < 2 || total_size > *decoded_size) {
+    return BrotliDecoderDecompress(
+        encoded_size, encoded_buffer, decoded_size, decoded_buffer);
+  }
+  units = (BrotliDecoderUnit*)malloc(num_units * sizeof(BrotliDecoderUnit));
+  if (!units) return BROTLI_DECODER_RESULT_ERROR;
+  FindDecoderUnits(encoded_size, encoded_buffer, units, &total_size,
+                   &has_dictionary);
+  for (i = 0; i < num_units; ++i) {
+    units[i].output = decoded_buffer + units[i].output_offset;
+  }
+
+  num_workers = BROTLI_MIN(size_t, num_units, BROTLI_MIN(size_t,
+      (size_t)num_threads, BROTLI_DECODER_MAX_NUM_THREADS));
+  for (i = 0; i < num_workers; ++i) {
+    workers[i].units = units;
+    workers[i].num_units = num_units;
+    workers[i].first = i;
+    workers[i].stride = num_workers;
+  }
+#if defined(BROTLI_DECODER_THREADS)
+  for (i = 1; i < num_workers; ++i) {
+    workers[i].has_thread = TO_BROTLI_BOOL(pthread_create(
+        &workers[i].thread, NULL, DecodeUnits, &workers[i]) == 0);
+  }
+  DecodeUnits(&workers[0]);
+  for (i = 1; i < num_workers; ++i) {
+    if (workers[i].has_thread) {
+      pthread_join(workers[i].thread, NULL);
+    } else {
+      DecodeUnits(&workers[i]);
+    }
+  }
+#else
+  /* No thread support; output is the same, just not faster. */
+  for (i = 0; i < num_workers; ++i) DecodeUnits(&workers[i]);
+#endif
+
+  for (i = 0; i < num_units; ++i) {
+    if (!units[i].result) result = BROTLI_FALSE;
+  }
+  free(units);
+  if (!result) {
+    *decoded_size = 0;
+    return BROTLI_DECODER_RESULT_ERROR;
+  }
+  *decoded_size = total_size;
+  return BROTLI_DECODER_RESULT_SUCCESS;
+}
+
 /* Invariant: input stream is never overconsumed:
     - invalid input implies that the whole stream is invalid -> any amount of
       input could be read and discarded
@@ -2404,6 +2739,10 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
           result = BROTLI_DECODER_NEEDS_MORE_INPUT;
           break;
         }
+        if (s->is_segment) {
+          s->state = BROTLI_STATE_INITIALIZE;
+          break;
+        }
         /* Decode window size. */
         result = DecodeWindowBits(s, br);  /* Reads 1..8 bits. */
         if (result != BROTLI_DECODER_SUCCESS) {
@@ -2436,6 +2775,10 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         BROTLI_LOG_UINT(s->window_bits);
         /* Maximum distance, see section 9.1. of the spec. */
         s->max_backward_distance = (1 << s->window_bits) - BROTLI_WINDOW_GAP;
+        if (s->is_restart_segment) {
+          /* Segment continues a stream that is at least one window long. */
+          s->max_distance = s->max_backward_distance;
+        }
 
         /* Allocate memory for both block_type_trees and block_len_trees. */
         s->block_type_trees = (HuffmanCode*)BROTLI_DECODER_ALLOC(s,
@@ -2484,7 +2827,16 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
           s->state = BROTLI_STATE_METABLOCK_DONE;
           break;
         }
-        BrotliCalculateRingBufferSize(s);
+        if (s->external_ringbuffer) {
+          /* Meta-block does not fit; the caller falls back to the regular
+             ring-buffer decoding. */
+          if (s->meta_block_remaining_len > s->ringbuffer_size - s->pos) {
+            result = BROTLI_DECODER_NEEDS_MORE_OUTPUT;
+            break;
+          }
+        } else {
+          BrotliCalculateRingBufferSize(s);
+        }
         if (s->is_uncompressed) {
           s->state = BROTLI_STATE_UNCOMPRESSED;
           break;
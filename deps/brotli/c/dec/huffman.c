@@ -109,7 +109,6 @@ void BrotliBuildCodeLengthsHuffmanTable(HuffmanCode* table,
   int symbol;             /* symbol index in original or sorted table */
   brotli_reg_t key;       /* prefix code */
   brotli_reg_t key_step;  /* prefix code addend */
-  int step;               /* step size to replicate values in current table */
   int table_size;         /* size of current table */
   int sorted[BROTLI_CODE_LENGTH_CODES];  /* symbols sorted by code length */
   /* offsets in sorted table for each length */
@@ -152,21 +151,23 @@ void BrotliBuildCodeLengthsHuffmanTable(HuffmanCode* table,
     return;
   }
 
-  /* Fill in table. */
+  /* Fill in table; see BrotliBuildHuffmanTable. */
   key = 0;
   key_step = BROTLI_REVERSE_BITS_LOWEST;
   symbol = 0;
   bits = 1;
-  step = 2;
-  do {
+  while (BROTLI_TRUE) {
     for (bits_count = count[bits]; bits_count != 0; --bits_count) {
-      code = ConstructHuffmanCode((uint8_t)bits, (uint16_t)sorted[symbol++]);
-      ReplicateValue(&table[BrotliReverseBits(key)], step, table_size, code);
+      table[BrotliReverseBits(key)] =
+          ConstructHuffmanCode((uint8_t)bits, (uint16_t)sorted[symbol++]);
       key += key_step;
     }
-    step <<= 1;
     key_step >>= 1;
-  } while (++bits <= BROTLI_HUFFMAN_MAX_CODE_LENGTH_CODE_LENGTH);
+    if (bits == BROTLI_HUFFMAN_MAX_CODE_LENGTH_CODE_LENGTH) break;
+    memcpy(&table[(size_t)1 << bits], &table[0],
+           ((size_t)1 << bits) * sizeof(table[0]));
+    ++bits;
+  }
 }
 
 uint32_t BrotliBuildHuffmanTable(HuffmanCode* root_table,
@@ -207,21 +208,26 @@ uint32_t BrotliBuildHuffmanTable(HuffmanCode* root_table,
     table_bits = max_length;
     table_size = 1 << table_bits;
   }
+  /* Codes of length |bits| are stored into the first 2^|bits| entries; then
+     those are doubled for the next length. Bulk copies replace the strided
+     stores of ReplicateValue. */
   key = 0;
   key_step = BROTLI_REVERSE_BITS_LOWEST;
   bits = 1;
-  step = 2;
-  do {
+  while (BROTLI_TRUE) {
     symbol = bits - (BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1);
     for (bits_count = count[bits]; bits_count != 0; --bits_count) {
       symbol = symbol_lists[symbol];
-      code = ConstructHuffmanCode((uint8_t)bits, (uint16_t)symbol);
-      ReplicateValue(&table[BrotliReverseBits(key)], step, table_size, code);
+      table[BrotliReverseBits(key)] =
+          ConstructHuffmanCode((uint8_t)bits, (uint16_t)symbol);
       key += key_step;
     }
-    step <<= 1;
     key_step >>= 1;
-  } while (++bits <= table_bits);
+    if (bits == table_bits) break;
+    memcpy(&table[(size_t)1 << bits], &table[0],
+           ((size_t)1 << bits) * sizeof(table[0]));
+    ++bits;
+  }
 
   /* If root_bits != table_bits then replicate to fill the remaining slots. */
   while (total_size != table_size) {
@@ -71,6 +71,9 @@ BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
   s->is_metadata = 0;
   s->should_wrap_ringbuffer = 0;
   s->canny_ringbuffer_allocation = 1;
+  s->is_segment = 0;
+  s->is_restart_segment = 0;
+  s->external_ringbuffer = 0;
 
   s->window_bits = 0;
   s->max_distance = 0;
@@ -153,7 +156,9 @@ void BrotliDecoderStateCleanup(BrotliDecoderState* s) {
   BROTLI_DECODER_FREE(s, s->compound_dictionary);
   BrotliSharedDictionaryDestroyInstance(s->dictionary);
   s->dictionary = NULL;
-  BROTLI_DECODER_FREE(s, s->ringbuffer);
+  if (!s->external_ringbuffer) {
+    BROTLI_DECODER_FREE(s, s->ringbuffer);
+  }
   BROTLI_DECODER_FREE(s, s->block_type_trees);
 }
 
@@ -351,7 +351,15 @@ struct BrotliDecoderStateStruct {
   unsigned int large_window : 1;
   unsigned int window_bits : 6;
   unsigned int size_nibbles : 8;
-  /* TODO(eustas): +12 bits padding */
+  /* Decoding a segment of a framed stream: there is no stream header and
+     |window_bits| is already set. */
+  unsigned int is_segment : 1;
+  /* Segment starts at a restart point beyond the first window. */
+  unsigned int is_restart_segment : 1;
+  /* |ringbuffer| is the caller's output buffer; it is neither reallocated,
+     wrapped nor freed, see BrotliDecoderDecompressDirect. */
+  unsigned int external_ringbuffer : 1;
+  /* TODO(eustas): +9 bits padding */
 
   brotli_reg_t num_literal_htrees;
   uint8_t* context_map;
@@ -38,6 +38,10 @@
 #include "utf8_util.h"
 #include "write_bits.h"
 
+#if defined(BROTLI_ENCODER_THREADS)
+#include <pthread.h>
+#endif
+
 #if defined(__cplusplus) || defined(c_plusplus)
 extern "C" {
 #endif
@@ -107,6 +111,15 @@ BROTLI_BOOL BrotliEncoderSetParameter(
       state->params.stream_offset = value;
       return BROTLI_TRUE;
 
+    case BROTLI_PARAM_NUM_THREADS:
+      if (value > BROTLI_MAX_NUM_THREADS) return BROTLI_FALSE;
+      state->params.num_threads = (value == 0) ? 1 : (int)value;
+      return BROTLI_TRUE;
+
+    case BROTLI_PARAM_RESTART_POINTS:
+      state->params.restart_points = TO_BROTLI_BOOL(!!value);
+      return BROTLI_TRUE;
+
     default: return BROTLI_FALSE;
   }
 }
@@ -632,6 +645,7 @@ static BROTLI_BOOL EnsureInitialized(BrotliEncoderState* s) {
   }
 
   RingBufferSetup(&s->params, &s->ringbuffer_);
+  RingBufferRecycle(m, &s->ringbuffer_);
 
   /* Initialize last byte with stream header. */
   {
@@ -650,13 +664,26 @@ static BROTLI_BOOL EnsureInitialized(BrotliEncoderState* s) {
     }
   }
 
+  /* Arenas might be left from the previous stream, see
+     BrotliEncoderResetInstance. */
   if (s->params.quality == FAST_ONE_PASS_COMPRESSION_QUALITY) {
-    s->one_pass_arena_ = BROTLI_ALLOC(m, BrotliOnePassArena, 1);
-    if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+    if (!s->one_pass_arena_) {
+      s->one_pass_arena_ = BROTLI_ALLOC(m, BrotliOnePassArena, 1);
+      if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+    }
     InitCommandPrefixCodes(s->one_pass_arena_);
   } else if (s->params.quality == FAST_TWO_PASS_COMPRESSION_QUALITY) {
-    s->two_pass_arena_ = BROTLI_ALLOC(m, BrotliTwoPassArena, 1);
-    if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+    if (!s->two_pass_arena_) {
+      s->two_pass_arena_ = BROTLI_ALLOC(m, BrotliTwoPassArena, 1);
+      if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+    }
+  }
+
+  /* Fast modes do not keep a ring buffer that chunks could be primed with. */
+  if (s->params.quality == FAST_ONE_PASS_COMPRESSION_QUALITY ||
+      s->params.quality == FAST_TWO_PASS_COMPRESSION_QUALITY) {
+    s->params.num_threads = 1;
+    s->params.restart_points = BROTLI_FALSE;
   }
 
   s->is_initialized_ = BROTLI_TRUE;
@@ -666,6 +693,8 @@ static BROTLI_BOOL EnsureInitialized(BrotliEncoderState* s) {
 static void BrotliEncoderInitParams(BrotliEncoderParams* params) {
   params->mode = BROTLI_DEFAULT_MODE;
   params->large_window = BROTLI_FALSE;
+  params->num_threads = 1;
+  params->restart_points = BROTLI_FALSE;
   params->quality = BROTLI_DEFAULT_QUALITY;
   params->lgwin = BROTLI_DEFAULT_WINDOW;
   params->lgblock = 0;
@@ -686,8 +715,8 @@ static void BrotliEncoderCleanupParams(MemoryManager* m,
   BrotliCleanupSharedEncoderDictionary(m, &params->dictionary);
 }
 
-static void BrotliEncoderInitState(BrotliEncoderState* s) {
-  BrotliEncoderInitParams(&s->params);
+/* Initializes everything, but parameters and allocated memory. */
+static void BrotliEncoderInitStreamState(BrotliEncoderState* s) {
   s->input_pos_ = 0;
   s->num_commands_ = 0;
   s->num_literals_ = 0;
@@ -696,15 +725,6 @@ static void BrotliEncoderInitState(BrotliEncoderState* s) {
   s->last_processed_pos_ = 0;
   s->prev_byte_ = 0;
   s->prev_byte2_ = 0;
-  s->storage_size_ = 0;
-  s->storage_ = 0;
-  HasherInit(&s->hasher_);
-  s->large_table_ = NULL;
-  s->large_table_size_ = 0;
-  s->one_pass_arena_ = NULL;
-  s->two_pass_arena_ = NULL;
-  s->command_buf_ = NULL;
-  s->literal_buf_ = NULL;
   s->total_in_ = 0;
   s->next_out_ = NULL;
   s->available_out_ = 0;
@@ -712,11 +732,10 @@ static void BrotliEncoderInitState(BrotliEncoderState* s) {
   s->stream_state_ = BROTLI_STREAM_PROCESSING;
   s->is_last_block_emitted_ = BROTLI_FALSE;
   s->is_initialized_ = BROTLI_FALSE;
-
-  RingBufferInit(&s->ringbuffer_);
-
-  s->commands_ = 0;
-  s->cmd_alloc_size_ = 0;
+  s->parallel_history_ = 0;
+  s->parallel_pending_ = 0;
+  s->parallel_position_ = 0;
+  s->parallel_last_restart_ = 0;
 
   /* Initialize distance cache. */
   s->dist_cache_[0] = 4;
@@ -728,6 +747,27 @@ static void BrotliEncoderInitState(BrotliEncoderState* s) {
   memcpy(s->saved_dist_cache_, s->dist_cache_, sizeof(s->saved_dist_cache_));
 }
 
+static void BrotliEncoderInitState(BrotliEncoderState* s) {
+  BrotliEncoderInitParams(&s->params);
+  s->storage_size_ = 0;
+  s->storage_ = 0;
+  HasherInit(&s->hasher_);
+  s->large_table_ = NULL;
+  s->large_table_size_ = 0;
+  s->one_pass_arena_ = NULL;
+  s->two_pass_arena_ = NULL;
+  s->command_buf_ = NULL;
+  s->literal_buf_ = NULL;
+  s->parallel_input_ = NULL;
+
+  RingBufferInit(&s->ringbuffer_);
+
+  s->commands_ = 0;
+  s->cmd_alloc_size_ = 0;
+
+  BrotliEncoderInitStreamState(s);
+}
+
 BrotliEncoderState* BrotliEncoderCreateInstance(
     brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
   BrotliEncoderState* state = (BrotliEncoderState*)BrotliBootstrapAlloc(
@@ -771,6 +811,7 @@ static void BrotliEncoderCleanupState(BrotliEncoderState* s) {
   BROTLI_FREE(m, s->two_pass_arena_);
   BROTLI_FREE(m, s->command_buf_);
   BROTLI_FREE(m, s->literal_buf_);
+  BROTLI_FREE(m, s->parallel_input_);
   BrotliEncoderCleanupParams(m, &s->params);
 }
 
@@ -784,6 +825,53 @@ void BrotliEncoderDestroyInstance(BrotliEncoderState* state) {
   }
 }
 
+void BrotliEncoderResetInstance(BrotliEncoderState* s) {
+  MemoryManager* m = &s->memory_manager_;
+  BROTLI_ENCODER_ON_FINISH(s);
+  if (BROTLI_IS_OOM(m)) {
+    /* Allocations of the failed stream are not tracked reliably. */
+    BrotliWipeOutMemoryManager(m);
+    BrotliInitMemoryManager(m, m->alloc_func, m->free_func, m->opaque);
+    BrotliEncoderInitState(s);
+    return;
+  }
+  BrotliEncoderCleanupParams(m, &s->params);
+  BrotliEncoderInitParams(&s->params);
+  /* Ring-buffer is recycled in EnsureInitialized, when its size is known;
+     parallel input buffer size depends on parameters, so it is not kept. */
+  HasherRecycle(&s->hasher_);
+  BROTLI_FREE(m, s->parallel_input_);
+  BrotliEncoderInitStreamState(s);
+}
+
+/* Room for rounding the arena allocations up to the alignment. */
+static const size_t kArenaAllocationOverhead = (size_t)1 << 14;
+
+BrotliEncoderArena* BrotliEncoderCreateArena(size_t size,
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
+  BrotliArena* arena = (BrotliArena*)BrotliBootstrapAlloc(
+      sizeof(BrotliArena), alloc_func, free_func, opaque);
+  size_t overhead = sizeof(BrotliEncoderState) + kArenaAllocationOverhead;
+  if (arena == NULL) return NULL;
+  if (size > ~(size_t)0 - overhead) size = ~(size_t)0 - overhead;
+  if (!BrotliInitArena(arena, size + overhead, alloc_func, free_func, opaque)) {
+    arena->free_func(arena->opaque, arena);
+    return NULL;
+  }
+  return arena;
+}
+
+void BrotliEncoderDestroyArena(BrotliEncoderArena* arena) {
+  if (!arena) return;
+  BrotliCleanupArena(arena);
+  arena->free_func(arena->opaque, arena);
+}
+
+BrotliEncoderState* BrotliEncoderCreateInstanceInArena(
+    BrotliEncoderArena* arena) {
+  return BrotliEncoderCreateInstance(BrotliArenaAlloc, BrotliArenaFree, arena);
+}
+
 /*
    Copies the given input data to the internal ring buffer of the compressor.
    No processing of the data occurs at this time and this function can be
@@ -1497,6 +1585,361 @@ static BROTLI_BOOL BrotliEncoderCompressStreamFast(
   return BROTLI_TRUE;
 }
 
+/* Block-parallel compression (BROTLI_PARAM_NUM_THREADS > 1).
+
+   Pending input is cut into chunks that do not depend on the number of
+   threads. Every chunk is compressed by a separate encoder that continues the
+   stream: it is primed with up to one window of the preceding input, omits the
+   stream header (unless it is the very first chunk) and is flushed, so that
+   its output starts and ends on a byte boundary.
+
+   With BROTLI_PARAM_RESTART_POINTS every chunk is preceded by a frame
+   metadata block (see BROTLI_FRAME_MAGIC). A chunk that starts at least one
+   window into the stream and at least one full chunk after the previous
+   restart point is not primed, so it could be decoded independently; other
+   chunks are primed only with the input that follows the last restart point.
+   Flushes cut chunks short; the spacing keeps frequent flushes from turning
+   every chunk into a restart point that is compressed without history. */
+
+static size_t ParallelChunkSize(const BrotliEncoderParams* params) {
+  int lgchunk = BROTLI_MIN(int, BROTLI_MAX(int, params->lgwin + 2, 22), 28);
+  return (size_t)1 << lgchunk;
+}
+
+static size_t ParallelHistorySize(const BrotliEncoderParams* params) {
+  return BROTLI_MIN(size_t, BROTLI_MAX_BACKWARD_LIMIT(params->lgwin),
+                    ParallelChunkSize(params));
+}
+
+static BROTLI_BOOL HasCustomDictionary(const BrotliEncoderParams* params) {
+  return TO_BROTLI_BOOL(params->dictionary.compound.num_chunks != 0 ||
+      params->dictionary.contextual.context_based ||
+      params->dictionary.contextual.dict[0] !=
+      &params->dictionary.contextual.instance_);
+}
+
+typedef struct ParallelChunk {
+  const BrotliEncoderState* parent;
+  BROTLI_BOOL is_restart;
+  const uint8_t* history;
+  size_t history_size;
+  const uint8_t* input;
+  size_t input_size;
+  size_t stream_offset;
+  BROTLI_BOOL emit_header;
+  BROTLI_BOOL is_last;
+  uint8_t* output;
+  /* Capacity of |output| before compression, used size after. */
+  size_t output_size;
+  BROTLI_BOOL result;
+#if defined(BROTLI_ENCODER_THREADS)
+  pthread_t thread;
+  BROTLI_BOOL has_thread;
+#endif
+} ParallelChunk;
+
+/* Makes |s| continue a stream whose last |size| bytes are |history|. Stream
+   header is not emitted; |history| is available for backward references, but
+   is not encoded. */
+static BROTLI_BOOL ContinueStream(BrotliEncoderState* s,
+    const uint8_t* history, size_t size) {
+  MemoryManager* m = &s->memory_manager_;
+  if (!EnsureInitialized(s)) return BROTLI_FALSE;
+  s->last_bytes_ = 0;
+  s->last_bytes_bits_ = 0;
+  if (size == 0) return BROTLI_TRUE;
+
+  /* Distances used by the preceding commands are unknown. */
+  s->dist_cache_[0] = -16;
+  s->dist_cache_[1] = -16;
+  s->dist_cache_[2] = -16;
+  s->dist_cache_[3] = -16;
+  memcpy(s->saved_dist_cache_, s->dist_cache_, sizeof(s->saved_dist_cache_));
+
+  CopyInputToRingBuffer(s, size, history);
+  if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+  s->last_flush_pos_ = size;
+  s->last_processed_pos_ = size;
+  s->prev_byte_ = history[size - 1];
+  if (size > 1) {
+    s->prev_byte2_ = history[size - 2];
+    /* Literal context is known; no need to emit uncompressed bytes. */
+    s->flint_ = BROTLI_FLINT_DONE;
+  }
+  HasherPrependCustomDictionary(m, &s->hasher_, &s->params, size, history);
+  if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+  return BROTLI_TRUE;
+}
+
+static void CompressParallelChunk(ParallelChunk* chunk) {
+  const BrotliEncoderState* parent = chunk->parent;
+  const BrotliEncoderParams* params = &parent->params;
+  const MemoryManager* pm = &parent->memory_manager_;
+  /* Arena is not thread-safe; chunks use its backing allocator instead. */
+  const BROTLI_BOOL in_arena =
+      TO_BROTLI_BOOL(pm->alloc_func == BrotliArenaAlloc);
+  const BrotliArena* arena = (const BrotliArena*)pm->opaque;
+  BrotliEncoderState* s = in_arena ?
+      BrotliEncoderCreateInstance(
+          arena->alloc_func, arena->free_func, arena->opaque) :
+      BrotliEncoderCreateInstance(pm->alloc_func, pm->free_func, pm->opaque);
+  SharedEncoderDictionary* dictionary;
+  size_t available_in = chunk->input_size;
+  const uint8_t* next_in = chunk->input;
+  size_t available_out = chunk->output_size;
+  uint8_t* next_out = chunk->output;
+  BROTLI_BOOL result = BROTLI_TRUE;
+  size_t i;
+  chunk->result = BROTLI_FALSE;
+  if (!s) return;
+
+  s->params.mode = params->mode;
+  s->params.quality = params->quality;
+  s->params.lgwin = params->lgwin;
+  s->params.lgblock = params->lgblock;
+  s->params.large_window = params->large_window;
+  s->params.disable_literal_context_modeling =
+      params->disable_literal_context_modeling;
+  s->params.dist.distance_postfix_bits = params->dist.distance_postfix_bits;
+  s->params.dist.num_direct_distance_codes =
+      params->dist.num_direct_distance_codes;
+  s->params.stream_offset = chunk->stream_offset;
+  s->params.size_hint = BROTLI_MIN(size_t,
+      chunk->history_size + chunk->input_size, (size_t)1 << 30);
+
+  /* Dictionaries are owned by the parent, which outlives the chunk. */
+  dictionary = &s->params.dictionary;
+  dictionary->max_quality = params->dictionary.max_quality;
+  for (i = 0; i < params->dictionary.compound.num_chunks; ++i) {
+    result = TO_BROTLI_BOOL(result && AttachPreparedDictionary(
+        &dictionary->compound, params->dictionary.compound.chunks[i]));
+  }
+  if (params->dictionary.contextual.context_based ||
+      params->dictionary.contextual.dict[0] !=
+      &params->dictionary.contextual.instance_) {
+    dictionary->contextual = params->dictionary.contextual;
+    dictionary->contextual.num_instances_ = 0;
+  }
+
+  if (result && !chunk->emit_header) {
+    result = ContinueStream(s, chunk->history, chunk->history_size);
+  }
+  if (result) {
+    result = BrotliEncoderCompressStream(s, chunk->is_last ?
+        BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+  }
+  chunk->result = TO_BROTLI_BOOL(result && available_in == 0 &&
+      !BrotliEncoderHasMoreOutput(s) &&
+      (!chunk->is_last || BrotliEncoderIsFinished(s)));
+  chunk->output_size -= available_out;
+  BrotliEncoderDestroyInstance(s);
+}
+
+static size_t WriteFrame(BrotliEncoderState* s, const ParallelChunk* chunk,
+    uint64_t decompressed_size, uint8_t* output) {
+  size_t header_size = WriteMetadataHeader(s, BROTLI_FRAME_SIZE, output);
+  uint8_t* frame = output + header_size;
+  uint64_t compressed_size = chunk->output_size;
+  uint32_t magic = BROTLI_FRAME_MAGIC;
+  int i;
+  for (i = 0; i < 4; ++i) frame[i] = (uint8_t)(magic >> (8 * i));
+  frame[4] = (uint8_t)((chunk->is_restart ? BROTLI_FRAME_FLAG_RESTART : 0) |
+      (chunk->is_last ? BROTLI_FRAME_FLAG_LAST : 0) |
+      (HasCustomDictionary(&s->params) ? BROTLI_FRAME_FLAG_DICTIONARY : 0));
+  for (i = 0; i < 8; ++i) {
+    frame[5 + i] = (uint8_t)(decompressed_size >> (8 * i));
+    frame[13 + i] = (uint8_t)(compressed_size >> (8 * i));
+  }
+  return header_size + BROTLI_FRAME_SIZE;
+}
+
+#if defined(BROTLI_ENCODER_THREADS)
+static void* ParallelChunkThread(void* chunk) {
+  CompressParallelChunk((ParallelChunk*)chunk);
+  return NULL;
+}
+#endif
+
+static void CompressParallelChunks(ParallelChunk* chunks, size_t num_chunks) {
+  size_t i;
+#if defined(BROTLI_ENCODER_THREADS)
+  for (i = 1; i < num_chunks; ++i) {
+    chunks[i].has_thread = TO_BROTLI_BOOL(pthread_create(
+        &chunks[i].thread, NULL, ParallelChunkThread, &chunks[i]) == 0);
+  }
+  CompressParallelChunk(&chunks[0]);
+  for (i = 1; i < num_chunks; ++i) {
+    if (chunks[i].has_thread) {
+      pthread_join(chunks[i].thread, NULL);
+    } else {
+      CompressParallelChunk(&chunks[i]);
+    }
+  }
+#else
+  /* No thread support; output is the same, just not faster. */
+  for (i = 0; i < num_chunks; ++i) CompressParallelChunk(&chunks[i]);
+#endif
+}
+
+/* Compresses all pending input. Output is stored in |s->next_out_|. */
+static BROTLI_BOOL EncodeParallel(BrotliEncoderState* s, BROTLI_BOOL is_last) {
+  MemoryManager* m = &s->memory_manager_;
+  const size_t chunk_size = ParallelChunkSize(&s->params);
+  const size_t max_history = ParallelHistorySize(&s->params);
+  const size_t max_offset = BROTLI_MAX_BACKWARD_LIMIT(s->params.lgwin);
+  /* Frame metadata block takes at most 26 bytes, including stream header. */
+  const size_t frame_reserve = s->params.restart_points ? 32 : 0;
+  const size_t pending = s->parallel_pending_;
+  size_t num_chunks = (pending + chunk_size - 1) / chunk_size;
+  size_t storage_size = 0;
+  size_t out_size = 0;
+  BROTLI_BOOL result = BROTLI_TRUE;
+  ParallelChunk* chunks;
+  uint8_t* storage;
+  size_t i;
+
+  if (num_chunks == 0) {
+    if (!is_last) return BROTLI_TRUE;
+    num_chunks = 1;  /* Empty last chunk. */
+  }
+  chunks = BROTLI_ALLOC(m, ParallelChunk, num_chunks);
+  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(chunks)) return BROTLI_FALSE;
+  for (i = 0; i < num_chunks; ++i) {
+    ParallelChunk* chunk = &chunks[i];
+    size_t start = s->parallel_history_ + i * chunk_size;
+    uint64_t position =
+        s->params.stream_offset + s->parallel_position_ + i * chunk_size;
+    uint64_t offset;
+    chunk->parent = s;
+    chunk->is_restart = TO_BROTLI_BOOL(s->params.restart_points &&
+        (position == 0 || (position >= max_offset &&
+         position - s->parallel_last_restart_ >= chunk_size)));
+    if (chunk->is_restart) s->parallel_last_restart_ = position;
+    chunk->input = s->parallel_input_ + start;
+    chunk->input_size =
+        BROTLI_MIN(size_t, chunk_size, pending - i * chunk_size);
+    chunk->history_size =
+        chunk->is_restart ? 0 : BROTLI_MIN(size_t, max_history, start);
+    /* Data before the restart point is not available to parallel decoder. */
+    if (s->params.restart_points &&
+        position - s->parallel_last_restart_ < chunk->history_size) {
+      chunk->history_size = (size_t)(position - s->parallel_last_restart_);
+    }
+    chunk->history = chunk->input - chunk->history_size;
+    /* Values beyond the window have the same effect. */
+    offset = position - chunk->history_size;
+    chunk->stream_offset =
+        (offset < max_offset) ? (size_t)offset : max_offset;
+    /* Frame metadata block carries the stream header, if any. */
+    chunk->emit_header = TO_BROTLI_BOOL(!s->params.restart_points &&
+        i == 0 && s->last_bytes_bits_ != 0);
+    chunk->is_last = TO_BROTLI_BOOL(is_last && i + 1 == num_chunks);
+    /* Uncompressed meta-blocks cost a few bytes per 64KiB of input. */
+    chunk->output_size = chunk->input_size + (chunk->input_size >> 10) + 64;
+    storage_size += frame_reserve + chunk->output_size;
+  }
+  storage = GetBrotliStorage(s, storage_size);
+  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(storage)) {
+    BROTLI_FREE(m, chunks);
+    return BROTLI_FALSE;
+  }
+  for (i = 0; i < num_chunks; ++i) {
+    chunks[i].output = storage + out_size + frame_reserve;
+    out_size += frame_reserve + chunks[i].output_size;
+  }
+
+  CompressParallelChunks(chunks, num_chunks);
+
+  out_size = 0;
+  for (i = 0; i < num_chunks; ++i) {
+    if (!chunks[i].result) {
+      result = BROTLI_FALSE;
+      break;
+    }
+    /* Frame never overlaps with the output of the chunk it describes. */
+    if (s->params.restart_points) {
+      out_size += WriteFrame(s, &chunks[i], chunks[i].input_size,
+                             storage + out_size);
+    }
+    memmove(storage + out_size, chunks[i].output, chunks[i].output_size);
+    out_size += chunks[i].output_size;
+  }
+  BROTLI_FREE(m, chunks);
+  if (!result) return BROTLI_FALSE;
+  if (is_last) s->is_last_block_emitted_ = BROTLI_TRUE;
+  /* Stream header, if any, has been emitted by the first chunk or frame. */
+  s->last_bytes_ = 0;
+  s->last_bytes_bits_ = 0;
+  s->next_out_ = storage;
+  s->available_out_ = out_size;
+
+  /* Keep the tail of input to prime the chunks of the next batch. */
+  {
+    size_t total = s->parallel_history_ + pending;
+    size_t keep = BROTLI_MIN(size_t, max_history, total);
+    memmove(s->parallel_input_, s->parallel_input_ + total - keep, keep);
+    s->parallel_history_ = keep;
+    s->parallel_pending_ = 0;
+    s->parallel_position_ += pending;
+  }
+  return BROTLI_TRUE;
+}
+
+static BROTLI_BOOL BrotliEncoderCompressStreamParallel(
+    BrotliEncoderState* s, BrotliEncoderOperation op, size_t* available_in,
+    const uint8_t** next_in, size_t* available_out, uint8_t** next_out,
+    size_t* total_out) {
+  const size_t capacity =
+      (size_t)s->params.num_threads * ParallelChunkSize(&s->params);
+  MemoryManager* m = &s->memory_manager_;
+  if (!s->parallel_input_) {
+    s->parallel_input_ = BROTLI_ALLOC(m, uint8_t,
+        ParallelHistorySize(&s->params) + capacity);
+    if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(s->parallel_input_)) {
+      return BROTLI_FALSE;
+    }
+  }
+
+  while (BROTLI_TRUE) {
+    if (s->parallel_pending_ < capacity && *available_in != 0 &&
+        s->stream_state_ == BROTLI_STREAM_PROCESSING) {
+      size_t copy_input_size = BROTLI_MIN(size_t,
+          capacity - s->parallel_pending_, *available_in);
+      memcpy(s->parallel_input_ + s->parallel_history_ +
+          s->parallel_pending_, *next_in, copy_input_size);
+      s->parallel_pending_ += copy_input_size;
+      *next_in += copy_input_size;
+      *available_in -= copy_input_size;
+      s->total_in_ += copy_input_size;
+      continue;
+    }
+
+    if (InjectFlushOrPushOutput(s, available_out, next_out, total_out)) {
+      continue;
+    }
+
+    /* Compress data only when internal output buffer is empty, stream is not
+       finished and there is no pending flush request. */
+    if (s->available_out_ == 0 &&
+        s->stream_state_ == BROTLI_STREAM_PROCESSING) {
+      if (s->parallel_pending_ == capacity || op != BROTLI_OPERATION_PROCESS) {
+        BROTLI_BOOL is_last = TO_BROTLI_BOOL(
+            (*available_in == 0) && op == BROTLI_OPERATION_FINISH);
+        BROTLI_BOOL force_flush = TO_BROTLI_BOOL(
+            (*available_in == 0) && op == BROTLI_OPERATION_FLUSH);
+        if (!EncodeParallel(s, is_last)) return BROTLI_FALSE;
+        if (force_flush) s->stream_state_ = BROTLI_STREAM_FLUSH_REQUESTED;
+        if (is_last) s->stream_state_ = BROTLI_STREAM_FINISHED;
+        continue;
+      }
+    }
+    break;
+  }
+  CheckFlushComplete(s);
+  return BROTLI_TRUE;
+}
+
 static BROTLI_BOOL ProcessMetadata(
     BrotliEncoderState* s, size_t* available_in, const uint8_t** next_in,
     size_t* available_out, uint8_t** next_out, size_t* total_out) {
@@ -1517,6 +1960,11 @@ static BROTLI_BOOL ProcessMetadata(
     }
     if (s->available_out_ != 0) break;
 
+    if (s->parallel_pending_ != 0) {
+      if (!EncodeParallel(s, BROTLI_FALSE)) return BROTLI_FALSE;
+      continue;
+    }
+
     if (s->input_pos_ != s->last_flush_pos_) {
       BROTLI_BOOL result = EncodeData(s, BROTLI_FALSE, BROTLI_TRUE,
           &s->available_out_, &s->next_out_);
@@ -1608,6 +2056,10 @@ BROTLI_BOOL BrotliEncoderCompressStream(
   if (s->stream_state_ != BROTLI_STREAM_PROCESSING && *available_in != 0) {
     return BROTLI_FALSE;
   }
+  if (s->params.num_threads > 1 || s->params.restart_points) {
+    return BrotliEncoderCompressStreamParallel(s, op, available_in, next_in,
+        available_out, next_out, total_out);
+  }
   if (s->params.quality == FAST_ONE_PASS_COMPRESSION_QUALITY ||
       s->params.quality == FAST_TWO_PASS_COMPRESSION_QUALITY) {
     return BrotliEncoderCompressStreamFast(s, op, available_in, next_in,
@@ -13,6 +13,16 @@
 
 #include "../common/platform.h"
 
+#if defined(BROTLI_TARGET_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(BROTLI_TARGET_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(BROTLI_TARGET_NEON)
+#include <arm_neon.h>
+#endif
+
 #if defined(__cplusplus) || defined(c_plusplus)
 extern "C" {
 #endif
@@ -23,6 +33,52 @@ static BROTLI_INLINE size_t FindMatchLengthWithLimit(const uint8_t* s1,
                                                      const uint8_t* s2,
                                                      size_t limit) {
   const uint8_t *s1_orig = s1;
+  /* Most matches are short; first 8 bytes are checked with scalar code, so
+     that vector registers are not involved for them. */
+  if (limit >= 8) {
+    uint64_t x = BROTLI_UNALIGNED_LOAD64LE(s2) ^
+                 BROTLI_UNALIGNED_LOAD64LE(s1);
+    if (x != 0) return (size_t)BROTLI_TZCNT64(x) >> 3;
+    s1 += 8;
+    s2 += 8;
+    limit -= 8;
+  }
+#if defined(BROTLI_TARGET_AVX2)
+  for (; limit >= 32; limit -= 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(const void*)s1);
+    __m256i b = _mm256_loadu_si256((const __m256i*)(const void*)s2);
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+    if (mask != 0xFFFFFFFFu) {
+      return (size_t)(s1 - s1_orig) + (size_t)BROTLI_TZCNT64(~mask);
+    }
+    s1 += 32;
+    s2 += 32;
+  }
+#endif
+#if defined(BROTLI_TARGET_SSE2)
+  for (; limit >= 16; limit -= 16) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(const void*)s1);
+    __m128i b = _mm_loadu_si128((const __m128i*)(const void*)s2);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+    if (mask != 0xFFFFu) {
+      return (size_t)(s1 - s1_orig) + (size_t)BROTLI_TZCNT64(~mask);
+    }
+    s1 += 16;
+    s2 += 16;
+  }
+#elif defined(BROTLI_TARGET_NEON)
+  for (; limit >= 16; limit -= 16) {
+    uint8x16_t eq = vceqq_u8(vld1q_u8(s1), vld1q_u8(s2));
+    /* Narrowing shift packs comparison result into 4 bits per byte. */
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+        vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+    if (mask != ~(uint64_t)0) {
+      return (size_t)(s1 - s1_orig) + ((size_t)BROTLI_TZCNT64(~mask) >> 2);
+    }
+    s1 += 16;
+    s2 += 16;
+  }
+#endif
   for (; limit >= 8; limit -= 8) {
     uint64_t x = BROTLI_UNALIGNED_LOAD64LE(s2) ^
                  BROTLI_UNALIGNED_LOAD64LE(s1);
@@ -37,6 +37,12 @@ typedef struct {
    */
   void* extra[4];
 
+  /**
+   * Sizes of "extra" allocations; those are kept by HasherRecycle and reused
+   * by the next HasherSetup, if big enough.
+   */
+  size_t extra_size[4];
+
   /**
    * False before the fisrt invocation of HasherSetup (where "extra" memory)
    * is allocated.
@@ -411,6 +417,16 @@ static BROTLI_INLINE void HasherInit(Hasher* hasher) {
   hasher->common.extra[1] = NULL;
   hasher->common.extra[2] = NULL;
   hasher->common.extra[3] = NULL;
+  hasher->common.extra_size[0] = 0;
+  hasher->common.extra_size[1] = 0;
+  hasher->common.extra_size[2] = 0;
+  hasher->common.extra_size[3] = 0;
+}
+
+/* Makes hasher ready for a new stream, possibly with different parameters.
+   Allocated memory is kept for the next HasherSetup. */
+static BROTLI_INLINE void HasherRecycle(Hasher* hasher) {
+  hasher->common.is_setup_ = BROTLI_FALSE;
 }
 
 static BROTLI_INLINE void DestroyHasher(MemoryManager* m, Hasher* hasher) {
@@ -451,9 +467,14 @@ static BROTLI_INLINE void HasherSetup(MemoryManager* m, Hasher* hasher,
     hasher->common.dict_num_matches = 0;
     HasherSize(params, one_shot, input_size, alloc_size);
     for (i = 0; i < 4; ++i) {
-      if (alloc_size[i] == 0) continue;
+      if (alloc_size[i] <= hasher->common.extra_size[i]) continue;
+      if (hasher->common.extra[i] != NULL) {
+        BROTLI_FREE(m, hasher->common.extra[i]);
+      }
+      hasher->common.extra_size[i] = 0;
       hasher->common.extra[i] = BROTLI_ALLOC(m, uint8_t, alloc_size[i]);
       if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(hasher->common.extra[i])) return;
+      hasher->common.extra_size[i] = alloc_size[i];
     }
     switch (hasher->common.params.type) {
 #define INITIALIZE_(N)                        \
@@ -505,6 +526,30 @@ static BROTLI_INLINE void InitOrStitchToPreviousBlock(
   }
 }
 
+/* Registers |size| bytes of |data| that precede the input as positions
+   [0, size) of the ring buffer. The last few positions are covered by
+   StitchToPreviousBlock when the first block is processed. */
+static BROTLI_INLINE void HasherPrependCustomDictionary(
+    MemoryManager* m, Hasher* hasher, BrotliEncoderParams* params,
+    const size_t size, const uint8_t* data) {
+  size_t overlap;
+  size_t i;
+  HasherSetup(m, hasher, params, data, 0, size, BROTLI_FALSE);
+  if (BROTLI_IS_OOM(m)) return;
+  switch (hasher->common.params.type) {
+#define PREPEND_(N)                                                  \
+    case N:                                                          \
+      overlap = (StoreLookaheadH ## N()) - 1;                        \
+      for (i = 0; i + overlap < size; i++) {                         \
+        StoreH ## N(&hasher->privat._H ## N, data, ~(size_t)0, i);  \
+      }                                                              \
+      break;
+    FOR_ALL_HASHERS(PREPEND_)
+#undef PREPEND_
+    default: break;
+  }
+}
+
 /* NB: when seamless dictionary-ring-buffer copies are implemented, don't forget
        to add proper guards for non-zero-BROTLI_PARAM_STREAM_OFFSET. */
 static BROTLI_INLINE void FindCompoundDictionaryMatch(
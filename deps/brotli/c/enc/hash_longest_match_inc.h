@@ -214,6 +214,12 @@ static BROTLI_INLINE void FN(FindLongestMatch)(
     uint32_t* BROTLI_RESTRICT bucket = &buckets[key << self->block_bits_];
     const size_t down =
         (num[key] > self->block_size_) ? (num[key] - self->block_size_) : 0u;
+    /* Only matches longer than max(best_len, 3) are interesting; such match
+       contains 4 bytes ending at max(best_len, 3). Comparing them at once
+       rejects most candidates without calling FindMatchLengthWithLimit. */
+    size_t tail_offset = (best_len > 3) ? best_len - 3 : 0;
+    uint32_t tail4 =
+        BrotliUnalignedRead32(&data[cur_ix_masked + tail_offset]);
     for (i = num[key]; i > down;) {
       size_t prev_ix = bucket[--i & self->block_mask_];
       const size_t backward = cur_ix - prev_ix;
@@ -223,7 +229,7 @@ static BROTLI_INLINE void FN(FindLongestMatch)(
       prev_ix &= ring_buffer_mask;
       if (cur_ix_masked + best_len > ring_buffer_mask ||
           prev_ix + best_len > ring_buffer_mask ||
-          data[cur_ix_masked + best_len] != data[prev_ix + best_len]) {
+          BrotliUnalignedRead32(&data[prev_ix + tail_offset]) != tail4) {
         continue;
       }
       {
@@ -241,6 +247,8 @@ static BROTLI_INLINE void FN(FindLongestMatch)(
             out->len = best_len;
             out->distance = backward;
             out->score = best_score;
+            tail_offset = best_len - 3;
+            tail4 = BrotliUnalignedRead32(&data[cur_ix_masked + tail_offset]);
           }
         }
       }
@@ -167,6 +167,80 @@ void BrotliWipeOutMemoryManager(MemoryManager* m) {
 
 #endif  /* BROTLI_ENCODER_EXIT_ON_OOM */
 
+/* Allocations are aligned to the cache line size. */
+#define BROTLI_ARENA_ALIGNMENT 64
+
+BROTLI_BOOL BrotliInitArena(BrotliArena* arena, size_t size,
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
+  if (!alloc_func) {
+    arena->alloc_func = BrotliDefaultAllocFunc;
+    arena->free_func = BrotliDefaultFreeFunc;
+    arena->opaque = 0;
+  } else {
+    arena->alloc_func = alloc_func;
+    arena->free_func = free_func;
+    arena->opaque = opaque;
+  }
+  arena->size = size & ~(size_t)(BROTLI_ARENA_ALIGNMENT - 1);
+  arena->top = 0;
+  arena->last = 0;
+  arena->num_live = 0;
+  arena->memory = NULL;
+  if (arena->size == 0) return BROTLI_TRUE;
+  arena->memory = (uint8_t*)arena->alloc_func(
+      arena->opaque, arena->size + BROTLI_ARENA_ALIGNMENT - 1);
+  return TO_BROTLI_BOOL(arena->memory != NULL);
+}
+
+void BrotliCleanupArena(BrotliArena* arena) {
+  if (arena->memory) arena->free_func(arena->opaque, arena->memory);
+  arena->memory = NULL;
+}
+
+/* Start of the aligned arena area. */
+static uint8_t* ArenaBase(const BrotliArena* arena) {
+  size_t misalignment = (size_t)arena->memory & (BROTLI_ARENA_ALIGNMENT - 1);
+  return misalignment ?
+      arena->memory + BROTLI_ARENA_ALIGNMENT - misalignment : arena->memory;
+}
+
+void* BrotliArenaAlloc(void* opaque, size_t size) {
+  BrotliArena* arena = (BrotliArena*)opaque;
+  size_t rounded = (size + BROTLI_ARENA_ALIGNMENT - 1) &
+      ~(size_t)(BROTLI_ARENA_ALIGNMENT - 1);
+  if (arena->memory && rounded >= size &&
+      rounded <= arena->size - arena->top) {
+    void* result = ArenaBase(arena) + arena->top;
+    arena->last = arena->top;
+    arena->top += rounded;
+    arena->num_live++;
+    return result;
+  }
+  /* Does not fit; fall back to the backing allocator. */
+  return arena->alloc_func(arena->opaque, size);
+}
+
+void BrotliArenaFree(void* opaque, void* address) {
+  BrotliArena* arena = (BrotliArena*)opaque;
+  uint8_t* base;
+  size_t offset;
+  if (!address) return;
+  base = arena->memory ? ArenaBase(arena) : NULL;
+  if (!base || (uint8_t*)address < base ||
+      (uint8_t*)address >= base + arena->size) {
+    arena->free_func(arena->opaque, address);
+    return;
+  }
+  offset = (size_t)((uint8_t*)address - base);
+  if (--arena->num_live == 0) {
+    arena->top = 0;
+    arena->last = 0;
+  } else if (offset == arena->last && arena->last != arena->top) {
+    /* Most recent allocation; typical for temporary buffers. */
+    arena->top = arena->last;
+  }
+}
+
 void* BrotliBootstrapAlloc(size_t size,
     brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
   if (!alloc_func && !free_func) {
@@ -118,6 +118,31 @@ V: value to append
   A[(S) - 1] = (V);                                       \
 }
 
+/* Bump-pointer arena; see BrotliEncoderCreateArena. |alloc_func|, |free_func|
+   and |opaque| serve the arena memory block itself and allocations that do
+   not fit into it. Arena is not thread-safe. */
+typedef struct BrotliEncoderArenaStruct {
+  brotli_alloc_func alloc_func;
+  brotli_free_func free_func;
+  void* opaque;
+  uint8_t* memory;
+  size_t size;
+  /* Offset of the first free byte. */
+  size_t top;
+  /* Offset of the most recent allocation; it could be returned to arena. */
+  size_t last;
+  /* Number of allocations in arena that are not freed yet; once there are
+     none, the whole arena is reclaimed. */
+  size_t num_live;
+} BrotliArena;
+
+BROTLI_INTERNAL BROTLI_BOOL BrotliInitArena(BrotliArena* arena, size_t size,
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque);
+BROTLI_INTERNAL void BrotliCleanupArena(BrotliArena* arena);
+/* brotli_alloc_func / brotli_free_func that take BrotliArena as |opaque|. */
+BROTLI_INTERNAL void* BrotliArenaAlloc(void* arena, size_t size);
+BROTLI_INTERNAL void BrotliArenaFree(void* arena, void* address);
+
 /* "Bootstrap" allocations are not tracked by memory manager; should be used
    only to allocate MemoryManager itself (or structure containing it). */
 BROTLI_INTERNAL void* BrotliBootstrapAlloc(size_t size,
@@ -38,6 +38,8 @@ typedef struct BrotliEncoderParams {
   size_t size_hint;
   BROTLI_BOOL disable_literal_context_modeling;
   BROTLI_BOOL large_window;
+  int num_threads;
+  BROTLI_BOOL restart_points;
   BrotliHasherParams hasher;
   BrotliDistanceParams dist;
   /* TODO(eustas): rename to BrotliShared... */
@@ -68,6 +68,23 @@ static BROTLI_INLINE void RingBufferFree(MemoryManager* m, RingBuffer* rb) {
   BROTLI_FREE(m, rb->data_);
 }
 
+/* Prepares buffer of the previous stream for a new one; must be invoked after
+   RingBufferSetup. Only a buffer of exactly the new full size is kept, so that
+   it is used as if it was just allocated by RingBufferWrite. */
+static BROTLI_INLINE void RingBufferRecycle(MemoryManager* m, RingBuffer* rb) {
+  rb->pos_ = 0;
+  if (!rb->data_) return;
+  if (rb->cur_size_ != rb->total_size_) {
+    RingBufferFree(m, rb);
+    RingBufferInit(rb);
+    return;
+  }
+  rb->buffer_[-2] = rb->buffer_[-1] = 0;
+  rb->buffer_[rb->size_ - 2] = 0;
+  rb->buffer_[rb->size_ - 1] = 0;
+  rb->buffer_[rb->size_] = 241;
+}
+
 /* Allocates or re-allocates data_ to the given length + plus some slack
    region before and after. Fills the slack regions with zeros. */
 static BROTLI_INLINE void RingBufferInitBuffer(
@@ -105,7 +122,8 @@ static BROTLI_INLINE void RingBufferWriteTail(
 /* Push bytes into the ring buffer. */
 static BROTLI_INLINE void RingBufferWrite(
     MemoryManager* m, const uint8_t* bytes, size_t n, RingBuffer* rb) {
-  if (rb->pos_ == 0 && n < rb->tail_size_) {
+  if (rb->pos_ == 0 && n < rb->tail_size_ &&
+      rb->cur_size_ < rb->total_size_) {
     /* Special case for the first write: to process the first block, we don't
        need to allocate the whole ring-buffer and we don't need the tail
        either. However, we do this memory usage optimization only if the
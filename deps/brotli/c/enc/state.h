@@ -96,6 +96,16 @@ typedef struct BrotliEncoderStateStruct {
 
   BROTLI_BOOL is_last_block_emitted_;
   BROTLI_BOOL is_initialized_;
+
+  /* Block-parallel compression input: |parallel_history_| bytes of already
+     compressed data followed by |parallel_pending_| bytes of new data. */
+  uint8_t* parallel_input_;
+  size_t parallel_history_;
+  size_t parallel_pending_;
+  /* Position of the first pending byte in the (uncompressed) stream. */
+  uint64_t parallel_position_;
+  /* Position of the last restart point (BROTLI_PARAM_RESTART_POINTS). */
+  uint64_t parallel_last_restart_;
 } BrotliEncoderStateStruct;
 
 typedef struct BrotliEncoderStateStruct BrotliEncoderStateInternal;
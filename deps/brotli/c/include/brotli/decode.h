@@ -229,6 +229,104 @@ BROTLI_DEC_API BrotliDecoderResult BrotliDecoderDecompress(
     size_t* decoded_size,
     uint8_t decoded_buffer[BROTLI_ARRAY_PARAM(*decoded_size)]);
 
+/**
+ * Number of trailing bytes of output buffer used as scratch space by
+ * ::BrotliDecoderDecompressDirect.
+ */
+#define BROTLI_DECODER_DIRECT_SLACK 542
+
+/**
+ * Performs one-shot memory-to-memory decompression without ring-buffer.
+ *
+ * Same as ::BrotliDecoderDecompress, but backward references are resolved
+ * right in @p decoded_buffer, so that no ring-buffer is allocated and
+ * decompressed data is not copied. This requires
+ * ::BROTLI_DECODER_DIRECT_SLACK bytes of scratch space after the end of the
+ * decompressed data.
+ *
+ * @note Contents of @p decoded_buffer past the decompressed data are
+ *       unspecified.
+ *
+ * @note Large window streams are not supported.
+ *
+ * @note Unlike ::BrotliDecoderDecompress, input is rejected if it has data
+ *       past the end of the stream.
+ *
+ * @param encoded_size size of @p encoded_buffer
+ * @param encoded_buffer compressed data buffer with at least @p encoded_size
+ *        addressable bytes
+ * @param[in, out] decoded_size @b in: size of @p decoded_buffer; \n
+ *                 @b out: length of decompressed data written to
+ *                 @p decoded_buffer
+ * @param decoded_buffer decompressed data destination buffer
+ * @returns ::BROTLI_DECODER_RESULT_ERROR if input is corrupted, truncated,
+ *          or memory allocation failed;
+ * @returns ::BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT if decompressed data
+ *          together with the slack does not fit into @p decoded_buffer;
+ *          the caller might retry with a larger buffer, or use
+ *          ::BrotliDecoderDecompress;
+ * @returns ::BROTLI_DECODER_RESULT_SUCCESS otherwise
+ */
+BROTLI_DEC_API BrotliDecoderResult BrotliDecoderDecompressDirect(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size,
+    uint8_t decoded_buffer[BROTLI_ARRAY_PARAM(*decoded_size)]);
+
+/** Maximal number of threads used by ::BrotliDecoderDecompressParallel. */
+#define BROTLI_DECODER_MAX_NUM_THREADS 64
+
+/**
+ * Gets the decompressed size of a framed stream.
+ *
+ * Framed streams are produced by encoder with ::BROTLI_PARAM_RESTART_POINTS
+ * enabled; frames record the size of every segment of the stream.
+ *
+ * @param encoded_size size of @p encoded_buffer
+ * @param encoded_buffer compressed data buffer with at least @p encoded_size
+ *        addressable bytes
+ * @param[out] decoded_size length of decompressed data
+ * @returns ::BROTLI_FALSE if stream is not framed, or frames are corrupted
+ * @returns ::BROTLI_TRUE otherwise
+ */
+BROTLI_DEC_API BROTLI_BOOL BrotliDecoderGetDecodedSize(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size);
+
+/**
+ * Performs one-shot memory-to-memory decompression on several threads.
+ *
+ * Framed streams (see ::BrotliDecoderGetDecodedSize) are cut at restart
+ * points, and the pieces are decoded concurrently. Other streams, and streams
+ * that do not fit into @p decoded_buffer, are decoded as with
+ * ::BrotliDecoderDecompress.
+ *
+ * @note Streams that refer to custom dictionaries are not supported. Framed
+ *       streams record whether a dictionary was used, and are rejected;
+ *       other streams are decoded as if there were no dictionary.
+ *
+ * @param encoded_size size of @p encoded_buffer
+ * @param encoded_buffer compressed data buffer with at least @p encoded_size
+ *        addressable bytes
+ * @param[in, out] decoded_size @b in: size of @p decoded_buffer; \n
+ *                 @b out: length of decompressed data written to
+ *                 @p decoded_buffer
+ * @param decoded_buffer decompressed data destination buffer
+ * @param num_threads maximal number of threads to use, up to
+ *        ::BROTLI_DECODER_MAX_NUM_THREADS
+ * @returns ::BROTLI_DECODER_RESULT_ERROR if input is corrupted, memory
+ *          allocation failed, @p decoded_buffer is not large enough, or
+ *          framed stream was encoded with a custom dictionary;
+ * @returns ::BROTLI_DECODER_RESULT_SUCCESS otherwise
+ */
+BROTLI_DEC_API BrotliDecoderResult BrotliDecoderDecompressParallel(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size,
+    uint8_t decoded_buffer[BROTLI_ARRAY_PARAM(*decoded_size)],
+    int num_threads);
+
 /**
  * Decompresses the input stream to the output stream.
  *
@@ -41,6 +41,8 @@ extern "C" {
 #define BROTLI_MIN_QUALITY 0
 /** Maximal value for ::BROTLI_PARAM_QUALITY parameter. */
 #define BROTLI_MAX_QUALITY 11
+/** Maximal value for ::BROTLI_PARAM_NUM_THREADS parameter. */
+#define BROTLI_MAX_NUM_THREADS 64
 
 /** Options for ::BROTLI_PARAM_MODE parameter. */
 typedef enum BrotliEncoderMode {
@@ -218,7 +220,49 @@ typedef enum BrotliEncoderParameter {
    * maximal window size have the same effect. Values greater than 2**30 are not
    * allowed.
    */
-  BROTLI_PARAM_STREAM_OFFSET = 9
+  BROTLI_PARAM_STREAM_OFFSET = 9,
+  /**
+   * Number of threads used by ::BrotliEncoderCompressStream.
+   *
+   * Values greater than 1 enable block-parallel compression: input is split
+   * into chunks of 4 windows (but at least 4MiB), every chunk is compressed by
+   * a separate encoder primed with up to one window of the preceding input,
+   * and the results are stitched into a single standard stream. Chunks do not
+   * depend on the number of threads, so the output is deterministic.
+   *
+   * Compression ratio is slightly worse than in single-threaded mode, and the
+   * encoder buffers up to (threads * chunk) bytes of input before producing
+   * output. ::BROTLI_OPERATION_FLUSH makes the encoder compress the buffered
+   * input immediately. Custom allocators must be thread-safe.
+   *
+   * Qualities 0 and 1 ignore this parameter.
+   *
+   * The default value is 1. Range is from 0 (same as 1) to
+   * ::BROTLI_MAX_NUM_THREADS.
+   */
+  BROTLI_PARAM_NUM_THREADS = 10,
+  /**
+   * Flag that makes the encoder emit restart points.
+   *
+   * Implies block-parallel compression (see ::BROTLI_PARAM_NUM_THREADS).
+   * Every chunk is preceded by a 21-byte metadata block (plus its header)
+   * that records its compressed and decompressed sizes. A chunk becomes a
+   * restart point, compressed without reference to preceding data, if it
+   * starts at least one window after the beginning of the stream and at least
+   * one full chunk (4 windows, but at least 4MiB) after the previous restart
+   * point. ::BrotliDecoderDecompressParallel decodes the data between restart
+   * points concurrently; other decoders skip the metadata blocks and decode
+   * the stream as usual.
+   *
+   * Every ::BROTLI_OPERATION_FLUSH ends a chunk, so frequent flushes add a
+   * metadata block each and make chunks short. Restart spacing does not
+   * depend on flushes, but the chunks that follow a restart point are primed
+   * only with the data after it, so ratio is lower than without this flag.
+   * Parallel decoding rejects streams encoded with a custom dictionary.
+   *
+   * Qualities 0 and 1 ignore this parameter.
+   */
+  BROTLI_PARAM_RESTART_POINTS = 11
 } BrotliEncoderParameter;
 
 /**
@@ -270,6 +314,79 @@ BROTLI_ENC_API BrotliEncoderState* BrotliEncoderCreateInstance(
  */
 BROTLI_ENC_API void BrotliEncoderDestroyInstance(BrotliEncoderState* state);
 
+/**
+ * Prepares ::BrotliEncoderState instance for a new stream.
+ *
+ * Instance becomes the same as newly created one: parameters get default
+ * values and dictionaries are detached. Memory allocated for the previous
+ * stream (hash tables, ring-buffer, command and output buffers) is kept and
+ * reused, when the new parameters permit. Resetting instead of recreating
+ * saves most of per-stream setup cost when many small inputs are compressed.
+ *
+ * Stream does not need to be finished before reset.
+ *
+ * @param state encoder instance to be reset
+ */
+BROTLI_ENC_API void BrotliEncoderResetInstance(BrotliEncoderState* state);
+
+/**
+ * Opaque structure that holds memory for encoder allocations.
+ *
+ * Allocated with ::BrotliEncoderCreateArena.
+ * Deallocated with ::BrotliEncoderDestroyArena.
+ */
+typedef struct BrotliEncoderArenaStruct BrotliEncoderArena;
+
+/**
+ * Creates a bump-pointer arena for a single encoder instance.
+ *
+ * Arena memory is allocated once; encoder allocations are carved out of it,
+ * and returned to it wholesale when the instance is destroyed, so the same
+ * arena could serve a series of instances without touching the allocator.
+ * Allocations that do not fit into arena fall back to @p alloc_func.
+ *
+ * @p size is normally a result of ::BrotliEncoderEstimatePeakMemoryUsage for
+ * the expected quality, window and input size; room for the encoder state
+ * itself is added automatically.
+ *
+ * Arena could be used by one instance at a time, and only from one thread.
+ *
+ * @p alloc_func and @p free_func have the same meaning as in
+ * ::BrotliEncoderCreateInstance.
+ *
+ * @param size arena capacity in bytes
+ * @param alloc_func custom memory allocation function
+ * @param free_func custom memory free function
+ * @param opaque custom memory manager handle
+ * @returns @c 0 if arena can not be allocated
+ * @returns pointer to arena otherwise
+ */
+BROTLI_ENC_API BrotliEncoderArena* BrotliEncoderCreateArena(size_t size,
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque);
+
+/**
+ * Frees ::BrotliEncoderArena.
+ *
+ * Instance created in arena should be destroyed before.
+ *
+ * @param arena arena to be deallocated
+ */
+BROTLI_ENC_API void BrotliEncoderDestroyArena(BrotliEncoderArena* arena);
+
+/**
+ * Creates an instance of ::BrotliEncoderState that allocates from @p arena.
+ *
+ * Instance should be destroyed with ::BrotliEncoderDestroyInstance, which
+ * makes the arena available to the next instance; it could be also reused
+ * with ::BrotliEncoderResetInstance.
+ *
+ * @param arena arena to allocate from
+ * @returns @c 0 if instance can not be allocated or initialized
+ * @returns pointer to initialized ::BrotliEncoderState otherwise
+ */
+BROTLI_ENC_API BrotliEncoderState* BrotliEncoderCreateInstanceInArena(
+    BrotliEncoderArena* arena);
+
 /* Opaque type for pointer to different possible internal structures containing
    dictionary prepared for the encoder */
 typedef struct BrotliEncoderPreparedDictionaryStruct
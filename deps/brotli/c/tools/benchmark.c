@@ -0,0 +1,619 @@
+/* Copyright 2026 the Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Compression / decompression benchmark for Brotli library.
+
+   Every input file is compressed with each combination of selected qualities
+   and window sizes, then decompressed and verified. Reported figures are
+   compression ratio, compression and decompression speed, and encoder peak
+   memory: estimated by BrotliEncoderEstimatePeakMemoryUsage vs. actually
+   allocated via custom allocator. */
+
+/* Mute strerror/fopen warnings. */
+#if !defined(_CRT_SECURE_NO_WARNINGS)
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+/* Expose clock_gettime when compiled with strict -std=c99. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include <brotli/types.h>
+
+#include "../common/constants.h"
+#include "../common/version.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#define MAX_QUALITIES (BROTLI_MAX_QUALITY + 1)
+#define MAX_WINDOWS (BROTLI_LARGE_MAX_WINDOW_BITS + 1)
+
+/* Each measured run lasts at least that long; short inputs are processed
+   repeatedly within a run. */
+static const double kMinRunTime = 0.05;
+
+typedef struct {
+  /* Parameters */
+  int qualities[MAX_QUALITIES];
+  int num_qualities;
+  int windows[MAX_WINDOWS];
+  int num_windows;
+  int repeat;
+  const char* json_path;
+  BROTLI_BOOL print_json;
+  BROTLI_BOOL help;
+
+  /* Inner state */
+  char** inputs;
+  int num_inputs;
+  FILE* json;
+  BROTLI_BOOL json_first;
+} Context;
+
+/* Counts bytes currently allocated through it, and the peak of that value. */
+typedef struct {
+  size_t current;
+  size_t peak;
+} MemoryCounter;
+
+typedef struct {
+  size_t input_size;
+  size_t compressed_size;
+  double compress_time;
+  double decompress_time;
+  size_t estimated_memory;
+  size_t encoder_memory;
+  size_t decoder_memory;
+} Result;
+
+/* Size prefix keeps allocations aligned as malloc ones. */
+typedef union {
+  size_t size;
+  double align_double;
+  void* align_pointer;
+} AllocationHeader;
+
+static void* CountingAlloc(void* opaque, size_t size) {
+  MemoryCounter* counter = (MemoryCounter*)opaque;
+  AllocationHeader* header =
+      (AllocationHeader*)malloc(sizeof(AllocationHeader) + size);
+  if (!header) return NULL;
+  header->size = size;
+  counter->current += size;
+  if (counter->current > counter->peak) counter->peak = counter->current;
+  return header + 1;
+}
+
+static void CountingFree(void* opaque, void* address) {
+  MemoryCounter* counter = (MemoryCounter*)opaque;
+  AllocationHeader* header;
+  if (!address) return;
+  header = (AllocationHeader*)address - 1;
+  counter->current -= header->size;
+  free(header);
+}
+
+/* Monotonic wall-clock time in seconds. CPU time (clock()) would add up the
+   time of all encoder threads and overstate the cost of parallel runs. */
+static double Now(void) {
+#if defined(_WIN32)
+  LARGE_INTEGER count, frequency;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return (double)count.QuadPart / (double)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+  return (double)time(NULL);
+#endif
+}
+
+/* Parses single number, or range "A-B", or comma separated list of those. */
+static BROTLI_BOOL ParseList(const char* s, int low, int high, int* values,
+                             int* count) {
+  int n = 0;
+  while (*s) {
+    char* end;
+    long first = strtol(s, &end, 10);
+    long last = first;
+    long v;
+    if (end == s) return BROTLI_FALSE;
+    s = end;
+    if (*s == '-') {
+      s++;
+      last = strtol(s, &end, 10);
+      if (end == s) return BROTLI_FALSE;
+      s = end;
+    }
+    if (first < low || last > high || first > last) return BROTLI_FALSE;
+    for (v = first; v <= last; ++v) {
+      if (n == high - low + 1) return BROTLI_FALSE;
+      values[n++] = (int)v;
+    }
+    if (*s == ',') {
+      s++;
+      if (*s == 0) return BROTLI_FALSE;
+    } else if (*s != 0) {
+      return BROTLI_FALSE;
+    }
+  }
+  if (n == 0) return BROTLI_FALSE;
+  *count = n;
+  return BROTLI_TRUE;
+}
+
+static void PrintHelp(const char* name, BROTLI_BOOL error) {
+  FILE* media = error ? stderr : stdout;
+  fprintf(media,
+"Usage: %s [OPTION]... FILE...\n",
+          name);
+  fprintf(media,
+"Options:\n"
+"  -q LIST, --quality=LIST     qualities to test (default: %d-%d)\n",
+          BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY);
+  fprintf(media,
+"  -w LIST, --lgwin=LIST       window sizes to test (%d-%d, default: 22);\n"
+"                              sizes over %d use large-window brotli\n",
+          BROTLI_MIN_WINDOW_BITS, BROTLI_LARGE_MAX_WINDOW_BITS,
+          BROTLI_MAX_WINDOW_BITS);
+  fprintf(media,
+"  -r NUM, --repeat=NUM        number of measured runs, best one is taken\n"
+"                              (1-99, default: 3)\n"
+"  --json                      print results as JSON instead of table\n"
+"  --json=FILE                 also write results as JSON to FILE\n"
+"  -h, --help                  display this help and exit\n"
+"LIST is a number, range 'A-B' or comma-separated combination of those,\n"
+"e.g. '0-4,9,11'.\n");
+}
+
+static BROTLI_BOOL ParseParams(Context* context, int argc, char** argv) {
+  int i;
+  context->inputs = (char**)malloc(sizeof(char*) * (size_t)argc);
+  if (!context->inputs) return BROTLI_FALSE;
+  for (i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = NULL;
+    char option = 0;
+    if (arg[0] != '-' || arg[1] == 0) {
+      context->inputs[context->num_inputs++] = argv[i];
+      continue;
+    }
+    if (strcmp(arg, "--json") == 0) {
+      context->print_json = BROTLI_TRUE;
+      continue;
+    }
+    if (strncmp(arg, "--json=", 7) == 0) {
+      context->json_path = arg + 7;
+      continue;
+    }
+    if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+      context->help = BROTLI_TRUE;
+      return BROTLI_FALSE;
+    }
+    if (arg[1] != '-' && arg[2] == 0) {
+      option = arg[1];
+      if (++i == argc) {
+        fprintf(stderr, "expected parameter for argument %s\n", arg);
+        return BROTLI_FALSE;
+      }
+      value = argv[i];
+    } else if (strncmp(arg, "--quality=", 10) == 0) {
+      option = 'q';
+      value = arg + 10;
+    } else if (strncmp(arg, "--lgwin=", 8) == 0) {
+      option = 'w';
+      value = arg + 8;
+    } else if (strncmp(arg, "--repeat=", 9) == 0) {
+      option = 'r';
+      value = arg + 9;
+    }
+    if (option == 'q') {
+      if (!ParseList(value, BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY,
+                     context->qualities, &context->num_qualities)) {
+        fprintf(stderr, "error parsing quality list [%s]\n", value);
+        return BROTLI_FALSE;
+      }
+    } else if (option == 'w') {
+      if (!ParseList(value, BROTLI_MIN_WINDOW_BITS,
+                     BROTLI_LARGE_MAX_WINDOW_BITS, context->windows,
+                     &context->num_windows)) {
+        fprintf(stderr, "error parsing lgwin list [%s]\n", value);
+        return BROTLI_FALSE;
+      }
+    } else if (option == 'r') {
+      char* end;
+      long repeat = strtol(value, &end, 10);
+      if (end == value || *end != 0 || repeat < 1 || repeat > 99) {
+        fprintf(stderr, "error parsing repeat count [%s]\n", value);
+        return BROTLI_FALSE;
+      }
+      context->repeat = (int)repeat;
+    } else {
+      fprintf(stderr, "invalid argument [%s]\n", arg);
+      return BROTLI_FALSE;
+    }
+  }
+  if (context->num_inputs == 0) {
+    fprintf(stderr, "no input files\n");
+    return BROTLI_FALSE;
+  }
+  return BROTLI_TRUE;
+}
+
+static BROTLI_BOOL ReadInput(const char* path, uint8_t** data, size_t* size) {
+  FILE* f = fopen(path, "rb");
+  size_t capacity = 1 << 16;
+  *data = NULL;
+  *size = 0;
+  if (!f) {
+    fprintf(stderr, "failed to open input file [%s]: %s\n", path,
+            strerror(errno));
+    return BROTLI_FALSE;
+  }
+  for (;;) {
+    uint8_t* new_data = (uint8_t*)realloc(*data, capacity);
+    if (!new_data) {
+      fprintf(stderr, "out of memory\n");
+      fclose(f);
+      return BROTLI_FALSE;
+    }
+    *data = new_data;
+    *size += fread(*data + *size, 1, capacity - *size, f);
+    if (*size < capacity) break;
+    capacity *= 2;
+  }
+  if (ferror(f)) {
+    fprintf(stderr, "failed to read input file [%s]: %s\n", path,
+            strerror(errno));
+    fclose(f);
+    return BROTLI_FALSE;
+  }
+  fclose(f);
+  return BROTLI_TRUE;
+}
+
+static BROTLI_BOOL Compress(int quality, int lgwin, const uint8_t* input,
+                            size_t input_size, uint8_t* output,
+                            size_t* output_size, MemoryCounter* counter) {
+  BrotliEncoderState* s =
+      BrotliEncoderCreateInstance(CountingAlloc, CountingFree, counter);
+  const uint8_t* next_in = input;
+  size_t available_in = input_size;
+  uint8_t* next_out = output;
+  size_t available_out = *output_size;
+  BROTLI_BOOL is_ok;
+  if (!s) return BROTLI_FALSE;
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)quality);
+  if (lgwin > BROTLI_MAX_WINDOW_BITS) {
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LARGE_WINDOW, 1u);
+  }
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)lgwin);
+  if (input_size < (1u << 30)) {
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT, (uint32_t)input_size);
+  }
+  is_ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+      &available_in, &next_in, &available_out, &next_out, NULL);
+  is_ok = TO_BROTLI_BOOL(is_ok && BrotliEncoderIsFinished(s));
+  BrotliEncoderDestroyInstance(s);
+  *output_size -= available_out;
+  return is_ok;
+}
+
+static BROTLI_BOOL Decompress(const uint8_t* input, size_t input_size,
+                              uint8_t* output, size_t* output_size,
+                              MemoryCounter* counter) {
+  BrotliDecoderState* s =
+      BrotliDecoderCreateInstance(CountingAlloc, CountingFree, counter);
+  const uint8_t* next_in = input;
+  size_t available_in = input_size;
+  uint8_t* next_out = output;
+  size_t available_out = *output_size;
+  BrotliDecoderResult result;
+  if (!s) return BROTLI_FALSE;
+  BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1u);
+  result = BrotliDecoderDecompressStream(
+      s, &available_in, &next_in, &available_out, &next_out, NULL);
+  BrotliDecoderDestroyInstance(s);
+  *output_size -= available_out;
+  return TO_BROTLI_BOOL(result == BROTLI_DECODER_RESULT_SUCCESS &&
+                        available_in == 0);
+}
+
+/* Runs compression and decompression |context->repeat| times and keeps the
+   best time of each. */
+static BROTLI_BOOL Measure(Context* context, const char* path, int quality,
+                           int lgwin, const uint8_t* input, size_t input_size,
+                           uint8_t* compressed, size_t compressed_capacity,
+                           uint8_t* decompressed, Result* result) {
+  MemoryCounter encoder_counter = {0, 0};
+  MemoryCounter decoder_counter = {0, 0};
+  size_t compressed_size = compressed_capacity;
+  size_t decompressed_size = input_size;
+  size_t inner = 1;
+  double start;
+  double elapsed;
+  int run;
+  size_t k;
+
+  start = Now();
+  if (!Compress(quality, lgwin, input, input_size, compressed,
+                &compressed_size, &encoder_counter)) {
+    fprintf(stderr, "failed to compress [%s] q%d w%d\n", path, quality, lgwin);
+    return BROTLI_FALSE;
+  }
+  elapsed = Now() - start;
+  if (!Decompress(compressed, compressed_size, decompressed,
+                  &decompressed_size, &decoder_counter) ||
+      decompressed_size != input_size ||
+      memcmp(input, decompressed, input_size) != 0) {
+    fprintf(stderr, "roundtrip failed [%s] q%d w%d\n", path, quality, lgwin);
+    return BROTLI_FALSE;
+  }
+
+  result->input_size = input_size;
+  result->compressed_size = compressed_size;
+  result->estimated_memory =
+      BrotliEncoderEstimatePeakMemoryUsage(quality, lgwin, input_size);
+  result->encoder_memory = encoder_counter.peak;
+  result->decoder_memory = decoder_counter.peak;
+
+  /* Calibrate number of repetitions per run with compression time; decoder
+     is faster, so its runs are long enough as well. */
+  if (elapsed < kMinRunTime) {
+    inner = (elapsed > 0) ? (size_t)(kMinRunTime / elapsed) + 1 : 1000;
+  }
+
+  result->compress_time = 0;
+  for (run = 0; run < context->repeat; ++run) {
+    start = Now();
+    for (k = 0; k < inner; ++k) {
+      size_t size = compressed_capacity;
+      Compress(quality, lgwin, input, input_size, compressed, &size,
+               &encoder_counter);
+    }
+    elapsed = (Now() - start) / (double)inner;
+    if (run == 0 || elapsed < result->compress_time) {
+      result->compress_time = elapsed;
+    }
+  }
+
+  result->decompress_time = 0;
+  for (run = 0; run < context->repeat; ++run) {
+    start = Now();
+    for (k = 0; k < inner; ++k) {
+      size_t size = input_size;
+      Decompress(compressed, compressed_size, decompressed, &size,
+                 &decoder_counter);
+    }
+    elapsed = (Now() - start) / (double)inner;
+    if (run == 0 || elapsed < result->decompress_time) {
+      result->decompress_time = elapsed;
+    }
+  }
+  return BROTLI_TRUE;
+}
+
+static double Speed(size_t size, double time) {
+  return (time > 0) ? (double)size / time / 1e6 : 0.0;
+}
+
+static double Ratio(size_t input_size, size_t compressed_size) {
+  return compressed_size ? (double)input_size / (double)compressed_size : 0.0;
+}
+
+static void PrintJsonString(FILE* f, const char* s) {
+  fputc('"', f);
+  for (; *s; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      fprintf(f, "\\%c", c);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+static void PrintJsonResult(Context* context, FILE* f, const char* name,
+                            int quality, int lgwin, const Result* r) {
+  fprintf(f, "%s\n    {\"file\": ", context->json_first ? "" : ",");
+  PrintJsonString(f, name);
+  fprintf(f, ", \"quality\": %d, \"lgwin\": %d, \"large_window\": %s,\n",
+          quality, lgwin, (lgwin > BROTLI_MAX_WINDOW_BITS) ? "true" : "false");
+  fprintf(f, "     \"input_size\": %lu, \"compressed_size\": %lu, "
+          "\"ratio\": %.4f,\n",
+          (unsigned long)r->input_size, (unsigned long)r->compressed_size,
+          Ratio(r->input_size, r->compressed_size));
+  fprintf(f, "     \"compress_mbps\": %.3f, \"decompress_mbps\": %.3f,\n",
+          Speed(r->input_size, r->compress_time),
+          Speed(r->input_size, r->decompress_time));
+  fprintf(f, "     \"estimated_peak_memory\": %lu, "
+          "\"encoder_peak_memory\": %lu, \"decoder_peak_memory\": %lu}",
+          (unsigned long)r->estimated_memory, (unsigned long)r->encoder_memory,
+          (unsigned long)r->decoder_memory);
+}
+
+static void ReportResult(Context* context, const char* name, int quality,
+                         int lgwin, const Result* r) {
+  if (context->print_json) {
+    PrintJsonResult(context, stdout, name, quality, lgwin, r);
+  } else {
+    /* Long paths are shown by their tails. */
+    size_t name_len = strlen(name);
+    fprintf(stdout, "%-24s %3d %3d%s %10lu %7.3f %9.2f %9.2f %11lu %11lu\n",
+            (name_len > 24) ? name + name_len - 24 : name, quality, lgwin,
+            (lgwin > BROTLI_MAX_WINDOW_BITS) ? "L" : " ",
+            (unsigned long)r->compressed_size,
+            Ratio(r->input_size, r->compressed_size),
+            Speed(r->input_size, r->compress_time),
+            Speed(r->input_size, r->decompress_time),
+            (unsigned long)r->estimated_memory,
+            (unsigned long)r->encoder_memory);
+  }
+  if (context->json) PrintJsonResult(context, context->json, name, quality,
+                                     lgwin, r);
+  context->json_first = BROTLI_FALSE;
+}
+
+static void BeginJson(FILE* f) {
+  fprintf(f, "{\n  \"version\": \"%d.%d.%d\",\n  \"results\": [",
+          BROTLI_VERSION_MAJOR, BROTLI_VERSION_MINOR, BROTLI_VERSION_PATCH);
+}
+
+static void EndJson(FILE* f) {
+  fprintf(f, "\n  ]\n}\n");
+}
+
+static BROTLI_BOOL RunBenchmark(Context* context) {
+  int i;
+  int q;
+  int w;
+  BROTLI_BOOL is_ok = BROTLI_TRUE;
+  /* Corpus totals per quality / window combination. */
+  Result* totals = (Result*)calloc(
+      (size_t)(context->num_qualities * context->num_windows), sizeof(Result));
+  if (!totals) {
+    fprintf(stderr, "out of memory\n");
+    return BROTLI_FALSE;
+  }
+
+  if (context->print_json) {
+    BeginJson(stdout);
+  } else {
+    fprintf(stdout, "%-24s %3s %4s %10s %7s %9s %9s %11s %11s\n",
+            "file", "q", "w", "compressed", "ratio", "comp MB/s", "dec MB/s",
+            "est. memory", "peak memory");
+  }
+  if (context->json) BeginJson(context->json);
+
+  for (i = 0; is_ok && i < context->num_inputs; ++i) {
+    const char* path = context->inputs[i];
+    uint8_t* input = NULL;
+    size_t input_size = 0;
+    uint8_t* compressed = NULL;
+    uint8_t* decompressed = NULL;
+    size_t compressed_capacity;
+    is_ok = ReadInput(path, &input, &input_size);
+    if (is_ok) {
+      /* BrotliEncoderMaxCompressedSize returns 0 if bound does not fit into
+         size_t; then compressed data is expected to be smaller than input. */
+      compressed_capacity = BrotliEncoderMaxCompressedSize(input_size);
+      if (compressed_capacity == 0) {
+        compressed_capacity = input_size + (input_size >> 2) + 1024;
+      }
+      compressed = (uint8_t*)malloc(compressed_capacity);
+      decompressed = (uint8_t*)malloc(input_size + 1);
+      if (!compressed || !decompressed) {
+        fprintf(stderr, "out of memory\n");
+        is_ok = BROTLI_FALSE;
+      }
+    }
+    for (q = 0; is_ok && q < context->num_qualities; ++q) {
+      for (w = 0; is_ok && w < context->num_windows; ++w) {
+        int quality = context->qualities[q];
+        int lgwin = context->windows[w];
+        Result r;
+        Result* total = &totals[q * context->num_windows + w];
+        is_ok = Measure(context, path, quality, lgwin, input, input_size,
+                        compressed, compressed_capacity, decompressed, &r);
+        if (!is_ok) break;
+        ReportResult(context, path, quality, lgwin, &r);
+        total->input_size += r.input_size;
+        total->compressed_size += r.compressed_size;
+        total->compress_time += r.compress_time;
+        total->decompress_time += r.decompress_time;
+        if (r.estimated_memory > total->estimated_memory) {
+          total->estimated_memory = r.estimated_memory;
+        }
+        if (r.encoder_memory > total->encoder_memory) {
+          total->encoder_memory = r.encoder_memory;
+        }
+        if (r.decoder_memory > total->decoder_memory) {
+          total->decoder_memory = r.decoder_memory;
+        }
+      }
+    }
+    free(decompressed);
+    free(compressed);
+    free(input);
+  }
+
+  /* Corpus summary; memory figures are the maximums over files. */
+  if (is_ok && context->num_inputs > 1) {
+    for (q = 0; q < context->num_qualities; ++q) {
+      for (w = 0; w < context->num_windows; ++w) {
+        ReportResult(context, "(total)", context->qualities[q],
+                     context->windows[w],
+                     &totals[q * context->num_windows + w]);
+      }
+    }
+  }
+
+  if (context->print_json) EndJson(stdout);
+  if (context->json) EndJson(context->json);
+  free(totals);
+  return is_ok;
+}
+
+int main(int argc, char** argv) {
+  Context context;
+  BROTLI_BOOL is_ok;
+  int i;
+
+  for (i = 0; i < MAX_QUALITIES; ++i) context.qualities[i] = i;
+  context.num_qualities = MAX_QUALITIES;
+  context.windows[0] = 22;
+  context.num_windows = 1;
+  context.repeat = 3;
+  context.json_path = NULL;
+  context.print_json = BROTLI_FALSE;
+  context.help = BROTLI_FALSE;
+  context.inputs = NULL;
+  context.num_inputs = 0;
+  context.json = NULL;
+  context.json_first = BROTLI_TRUE;
+
+  if (!ParseParams(&context, argc, argv)) {
+    PrintHelp(argv[0], !context.help);
+    free(context.inputs);
+    return context.help ? 0 : 1;
+  }
+
+  if (context.json_path) {
+    context.json = fopen(context.json_path, "w");
+    if (!context.json) {
+      fprintf(stderr, "failed to open output file [%s]: %s\n",
+              context.json_path, strerror(errno));
+      free(context.inputs);
+      return 1;
+    }
+  }
+
+  is_ok = RunBenchmark(&context);
+
+  if (context.json && fclose(context.json) != 0) {
+    fprintf(stderr, "failed to write output file [%s]: %s\n",
+            context.json_path, strerror(errno));
+    is_ok = BROTLI_FALSE;
+  }
+  free(context.inputs);
+  return is_ok ? 0 : 1;
+}
@@ -69,10 +69,13 @@ static int ms_open(const char* filename, int oflag, int pmode) {
   _sopen_s(&result, filename, oflag | O_BINARY, _SH_DENYNO, pmode);
   return result;
 }
+#define HAVE_MMAP 0
 #else  /* !defined(_WIN32) */
+#include <sys/mman.h>
 #include <unistd.h>
 #include <utime.h>
 #define MAKE_BINARY(FILENO) (FILENO)
+#define HAVE_MMAP 1
 #endif  /* defined(_WIN32) */
 
 #if defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 200809L)
@@ -100,17 +103,26 @@ typedef enum {
   COMMAND_INVALID,
   COMMAND_TEST_INTEGRITY,
   COMMAND_NOOP,
+  COMMAND_TRAIN,
   COMMAND_VERSION
 } Command;
 
 #define DEFAULT_LGWIN 24
 #define DEFAULT_SUFFIX ".br"
-#define MAX_OPTIONS 20
+#define MAX_DICTIONARIES SHARED_BROTLI_MAX_COMPOUND_DICTS
+#define MAX_OPTIONS (22 + 2 * MAX_DICTIONARIES)
+
+/* Total size of all dictionaries; leaves enough space for the window. */
+static const size_t kMaxDictionarySize =
+    BROTLI_MAX_DISTANCE - BROTLI_MAX_BACKWARD_LIMIT(24);
+static const size_t kDefaultTrainDictionarySize = 32768;
+static const size_t kMinTrainDictionarySize = 256;
 
 typedef struct {
   /* Parameters */
   int quality;
   int lgwin;
+  int num_threads;
   int verbosity;
   BROTLI_BOOL force_overwrite;
   BROTLI_BOOL junk_source;
@@ -121,7 +133,9 @@ typedef struct {
   BROTLI_BOOL decompress;
   BROTLI_BOOL large_window;
   const char* output_path;
-  const char* dictionary_path;
+  const char* dictionary_paths[MAX_DICTIONARIES];
+  size_t num_dictionaries;
+  size_t train_dictionary_size;
   const char* suffix;
   int not_input_indices[MAX_OPTIONS];
   size_t longest_path_len;
@@ -130,9 +144,9 @@ typedef struct {
   /* Inner state */
   int argc;
   char** argv;
-  uint8_t* dictionary;
-  size_t dictionary_size;
-  BrotliEncoderPreparedDictionary* prepared_dictionary;
+  uint8_t* dictionaries[MAX_DICTIONARIES];
+  size_t dictionary_sizes[MAX_DICTIONARIES];
+  BrotliEncoderPreparedDictionary* prepared_dictionaries[MAX_DICTIONARIES];
   char* modified_path;  /* Storage for path with appended / cut suffix */
   int iterator;
   int ignore;
@@ -179,6 +193,35 @@ static BROTLI_BOOL ParseInt(const char* s, int low, int high, int* result) {
   return BROTLI_TRUE;
 }
 
+/* Parse up to 9 decimal digits, optionally followed by "k" (KiB) or
+   "m" (MiB) multiplier. */
+static BROTLI_BOOL ParseSize(const char* s, size_t low, size_t high,
+                             size_t* result) {
+  size_t value = 0;
+  int shift = 0;
+  int i;
+  for (i = 0; i < 9; ++i) {
+    char c = s[i];
+    if (c < '0' || c > '9') break;
+    value = (10 * value) + (size_t)(c - '0');
+  }
+  if (i == 0) return BROTLI_FALSE;
+  if (i > 1 && s[0] == '0') return BROTLI_FALSE;
+  if (s[i] == 'k' || s[i] == 'K') {
+    shift = 10;
+    i++;
+  } else if (s[i] == 'm' || s[i] == 'M') {
+    shift = 20;
+    i++;
+  }
+  if (s[i] != 0) return BROTLI_FALSE;
+  if (value > (high >> shift)) return BROTLI_FALSE;
+  value <<= shift;
+  if (value < low) return BROTLI_FALSE;
+  *result = value;
+  return BROTLI_TRUE;
+}
+
 /* Returns "base file name" or its tail, if it contains '/' or '\'. */
 static const char* FileName(const char* path) {
   const char* separator_position = strrchr(path, '/');
@@ -215,7 +258,9 @@ static Command ParseParams(Context* params) {
   BROTLI_BOOL keep_set = BROTLI_FALSE;
   BROTLI_BOOL squash_set = BROTLI_FALSE;
   BROTLI_BOOL lgwin_set = BROTLI_FALSE;
+  BROTLI_BOOL jobs_set = BROTLI_FALSE;
   BROTLI_BOOL suffix_set = BROTLI_FALSE;
+  BROTLI_BOOL dictionary_size_set = BROTLI_FALSE;
   BROTLI_BOOL after_dash_dash = BROTLI_FALSE;
   Command command = ParseAlias(argv[0]);
 
@@ -231,7 +276,8 @@ static Command ParseParams(Context* params) {
     }
 
     /* Too many options. The expected longest option list is:
-       "-q 0 -w 10 -o f -D d -S b -d -f -k -n -v --", i.e. 16 items in total.
+       "-q 0 -w 10 -J 4 -o f -D d -S b -d -f -k -n -v --" with 15 "-D d"
+       pairs, i.e. 46 items in total.
        This check is an additional guard that is never triggered, but provides
        a guard for future changes. */
     if (next_option_index > (MAX_OPTIONS - 2)) {
@@ -344,8 +390,9 @@ static Command ParseParams(Context* params) {
           params->quality = 11;
           continue;
         }
-        /* o/q/w/D/S with parameter is expected */
-        if (c != 'o' && c != 'q' && c != 'w' && c != 'D' && c != 'S') {
+        /* o/q/w/D/J/S with parameter is expected */
+        if (c != 'o' && c != 'q' && c != 'w' && c != 'D' && c != 'J' &&
+            c != 'S') {
           fprintf(stderr, "invalid argument -%c\n", c);
           return COMMAND_INVALID;
         }
@@ -394,11 +441,23 @@ static Command ParseParams(Context* params) {
             return COMMAND_INVALID;
           }
         } else if (c == 'D') {
-          if (params->dictionary_path) {
-            fprintf(stderr, "dictionary path already set\n");
+          if (params->num_dictionaries == MAX_DICTIONARIES) {
+            fprintf(stderr, "too many dictionaries (max %d)\n",
+                    MAX_DICTIONARIES);
+            return COMMAND_INVALID;
+          }
+          params->dictionary_paths[params->num_dictionaries++] = argv[i];
+        } else if (c == 'J') {
+          if (jobs_set) {
+            fprintf(stderr, "number of jobs already set\n");
+            return COMMAND_INVALID;
+          }
+          jobs_set = ParseInt(argv[i], 1,
+                              BROTLI_MAX_NUM_THREADS, &params->num_threads);
+          if (!jobs_set) {
+            fprintf(stderr, "error parsing number of jobs [%s]\n", argv[i]);
             return COMMAND_INVALID;
           }
-          params->dictionary_path = argv[i];
         } else if (c == 'S') {
           if (suffix_set) {
             fprintf(stderr, "suffix already set\n");
@@ -475,6 +534,13 @@ static Command ParseParams(Context* params) {
         }
         command_set = BROTLI_TRUE;
         command = COMMAND_TEST_INTEGRITY;
+      } else if (strcmp("train", arg) == 0) {
+        if (command_set) {
+          fprintf(stderr, "command already set when parsing --train\n");
+          return COMMAND_INVALID;
+        }
+        command_set = BROTLI_TRUE;
+        command = COMMAND_TRAIN;
       } else if (strcmp("verbose", arg) == 0) {
         if (params->verbosity > 0) {
           fprintf(stderr, "argument --verbose / -v already set\n");
@@ -495,11 +561,34 @@ static Command ParseParams(Context* params) {
         key_len = (size_t)(value - arg);
         value++;
         if (strncmp("dictionary", arg, key_len) == 0) {
-          if (params->dictionary_path) {
-            fprintf(stderr, "dictionary path already set\n");
+          if (params->num_dictionaries == MAX_DICTIONARIES) {
+            fprintf(stderr, "too many dictionaries (max %d)\n",
+                    MAX_DICTIONARIES);
+            return COMMAND_INVALID;
+          }
+          params->dictionary_paths[params->num_dictionaries++] = value;
+        } else if (strncmp("dictionary-size", arg, key_len) == 0) {
+          if (dictionary_size_set) {
+            fprintf(stderr, "dictionary size already set\n");
+            return COMMAND_INVALID;
+          }
+          dictionary_size_set = ParseSize(value, kMinTrainDictionarySize,
+              kMaxDictionarySize, &params->train_dictionary_size);
+          if (!dictionary_size_set) {
+            fprintf(stderr, "error parsing dictionary size [%s]\n", value);
+            return COMMAND_INVALID;
+          }
+        } else if (strncmp("jobs", arg, key_len) == 0) {
+          if (jobs_set) {
+            fprintf(stderr, "number of jobs already set\n");
+            return COMMAND_INVALID;
+          }
+          jobs_set = ParseInt(value, 1,
+                              BROTLI_MAX_NUM_THREADS, &params->num_threads);
+          if (!jobs_set) {
+            fprintf(stderr, "error parsing number of jobs [%s]\n", value);
             return COMMAND_INVALID;
           }
-          params->dictionary_path = value;
         } else if (strncmp("lgwin", arg, key_len) == 0) {
           if (lgwin_set) {
             fprintf(stderr, "lgwin parameter already set\n");
@@ -573,6 +662,13 @@ static Command ParseParams(Context* params) {
   params->decompress = (command == COMMAND_DECOMPRESS);
   params->test_integrity = (command == COMMAND_TEST_INTEGRITY);
 
+  if (command == COMMAND_TRAIN) {
+    /* All inputs are samples; result goes to a single output. */
+    if (params->num_dictionaries != 0) return COMMAND_INVALID;
+    if (!params->output_path) params->write_to_stdout = BROTLI_TRUE;
+    return command;
+  }
+  if (dictionary_size_set) return COMMAND_INVALID;
   if (input_count > 1 && output_set) return COMMAND_INVALID;
   if (params->test_integrity) {
     if (params->output_path) return COMMAND_INVALID;
@@ -610,10 +706,12 @@ static void PrintHelp(const char* name, BROTLI_BOOL error) {
 "  -h, --help                  display this help and exit\n");
   fprintf(media,
 "  -j, --rm                    remove source file(s)\n"
+"  -J NUM, --jobs=NUM          compress with NUM threads (1-%d)\n"
 "  -s, --squash                remove destination file if larger than source\n"
 "  -k, --keep                  keep source file(s) (default)\n"
 "  -n, --no-copy-stat          do not copy source file(s) attributes\n"
-"  -o FILE, --output=FILE      output file (only if 1 input file)\n");
+"  -o FILE, --output=FILE      output file (only if 1 input file)\n",
+          BROTLI_MAX_NUM_THREADS);
   fprintf(media,
 "  -q NUM, --quality=NUM       compression level (%d-%d)\n",
           BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY);
@@ -633,7 +731,15 @@ static void PrintHelp(const char* name, BROTLI_BOOL error) {
 "                              decodable with regular brotli decoders\n",
           BROTLI_MIN_WINDOW_BITS, BROTLI_LARGE_MAX_WINDOW_BITS);
   fprintf(media,
-"  -D FILE, --dictionary=FILE  use FILE as raw (LZ77) dictionary\n");
+"  -D FILE, --dictionary=FILE  use FILE as raw (LZ77) dictionary; could be\n"
+"                              repeated up to %d times, dictionaries are\n"
+"                              concatenated in order\n",
+          MAX_DICTIONARIES);
+  fprintf(media,
+"  --train                     build raw dictionary from sample FILE(s)\n"
+"  --dictionary-size=NUM       size of trained dictionary (default: %lu)\n"
+"                              'k' / 'm' suffix multiplies by 1024 / 1048576\n",
+          (unsigned long)kDefaultTrainDictionarySize);
   fprintf(media,
 "  -S SUF, --suffix=SUF        output file suffix (default:'%s')\n",
           DEFAULT_SUFFIX);
@@ -664,8 +770,18 @@ static BROTLI_BOOL OpenInputFile(const char* input_path, FILE** f) {
   return BROTLI_TRUE;
 }
 
+/* Outputs that mirror an input file are created private; CopyStat applies the
+   permissions of the input afterwards. Other outputs, e.g. trained
+   dictionaries, get the usual mode of new files, restricted by umask. */
+#if defined(_WIN32)
+#define SHARED_FILE_MODE (S_IRUSR | S_IWUSR)
+#else
+#define SHARED_FILE_MODE \
+    (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)
+#endif
+
 static BROTLI_BOOL OpenOutputFile(const char* output_path, FILE** f,
-                                  BROTLI_BOOL force) {
+                                  BROTLI_BOOL force, int mode) {
   int fd;
   *f = NULL;
   if (!output_path) {
@@ -673,7 +789,7 @@ static BROTLI_BOOL OpenOutputFile(const char* output_path, FILE** f,
     return BROTLI_TRUE;
   }
   fd = open(output_path, O_CREAT | (force ? 0 : O_EXCL) | O_WRONLY | O_TRUNC,
-            S_IRUSR | S_IWUSR);
+            mode);
   if (fd < 0) {
     fprintf(stderr, "failed to open output file [%s]: %s\n",
             PrintablePath(output_path), strerror(errno));
@@ -751,65 +867,72 @@ static void CopyStat(const char* input_path, const char* output_path) {
   }
 }
 
-/* Result ownership is passed to caller.
-   |*dictionary_size| is set to resulting buffer size. */
-static BROTLI_BOOL ReadDictionary(Context* context, Command command) {
-  static const int kMaxDictionarySize =
-      BROTLI_MAX_DISTANCE - BROTLI_MAX_BACKWARD_LIMIT(24);
-  FILE* f;
-  int64_t file_size_64;
-  uint8_t* buffer;
-  size_t bytes_read;
-
-  if (context->dictionary_path == NULL) return BROTLI_TRUE;
-  f = fopen(context->dictionary_path, "rb");
-  if (f == NULL) {
-    fprintf(stderr, "failed to open dictionary file [%s]: %s\n",
-            PrintablePath(context->dictionary_path), strerror(errno));
-    return BROTLI_FALSE;
-  }
+/* Reads dictionaries listed with -D options, in order. For compression, each
+   dictionary is also prepared; prepared dictionaries reference buffers owned
+   by |context|. */
+static BROTLI_BOOL ReadDictionaries(Context* context, Command command) {
+  size_t total_size = 0;
+  size_t i;
+
+  for (i = 0; i < context->num_dictionaries; ++i) {
+    const char* path = context->dictionary_paths[i];
+    FILE* f;
+    int64_t file_size_64;
+    uint8_t* buffer;
+    size_t bytes_read;
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+      fprintf(stderr, "failed to open dictionary file [%s]: %s\n",
+              PrintablePath(path), strerror(errno));
+      return BROTLI_FALSE;
+    }
 
-  file_size_64 = FileSize(context->dictionary_path);
-  if (file_size_64 == -1) {
-    fprintf(stderr, "could not get size of dictionary file [%s]",
-            PrintablePath(context->dictionary_path));
-    fclose(f);
-    return BROTLI_FALSE;
-  }
+    file_size_64 = FileSize(path);
+    if (file_size_64 == -1) {
+      fprintf(stderr, "could not get size of dictionary file [%s]",
+              PrintablePath(path));
+      fclose(f);
+      return BROTLI_FALSE;
+    }
 
-  if (file_size_64 > kMaxDictionarySize) {
-    fprintf(stderr, "dictionary [%s] is larger than maximum allowed: %d\n",
-            PrintablePath(context->dictionary_path), kMaxDictionarySize);
-    fclose(f);
-    return BROTLI_FALSE;
-  }
-  context->dictionary_size = (size_t)file_size_64;
+    if ((uint64_t)file_size_64 > kMaxDictionarySize - total_size) {
+      fprintf(stderr,
+              "dictionary [%s] exceeds maximum allowed total size: %lu\n",
+              PrintablePath(path), (unsigned long)kMaxDictionarySize);
+      fclose(f);
+      return BROTLI_FALSE;
+    }
+    context->dictionary_sizes[i] = (size_t)file_size_64;
+    total_size += context->dictionary_sizes[i];
 
-  buffer = (uint8_t*)malloc(context->dictionary_size);
-  if (!buffer) {
-    fprintf(stderr, "could not read dictionary: out of memory\n");
-    fclose(f);
-    return BROTLI_FALSE;
-  }
-  bytes_read = fread(buffer, sizeof(uint8_t), context->dictionary_size, f);
-  if (bytes_read != context->dictionary_size) {
-    free(buffer);
-    fprintf(stderr, "failed to read dictionary [%s]: %s\n",
-            PrintablePath(context->dictionary_path), strerror(errno));
-    fclose(f);
-    return BROTLI_FALSE;
-  }
-  fclose(f);
-  context->dictionary = buffer;
-  if (command == COMMAND_COMPRESS) {
-    context->prepared_dictionary = BrotliEncoderPrepareDictionary(
-        BROTLI_SHARED_DICTIONARY_RAW, context->dictionary_size,
-        context->dictionary, BROTLI_MAX_QUALITY, NULL, NULL, NULL);
-    if (context->prepared_dictionary == NULL) {
-      fprintf(stderr, "failed to prepare dictionary [%s]\n",
-              PrintablePath(context->dictionary_path));
+    buffer = (uint8_t*)malloc(context->dictionary_sizes[i]);
+    if (!buffer) {
+      fprintf(stderr, "could not read dictionary: out of memory\n");
+      fclose(f);
+      return BROTLI_FALSE;
+    }
+    bytes_read =
+        fread(buffer, sizeof(uint8_t), context->dictionary_sizes[i], f);
+    if (bytes_read != context->dictionary_sizes[i]) {
+      free(buffer);
+      fprintf(stderr, "failed to read dictionary [%s]: %s\n",
+              PrintablePath(path), strerror(errno));
+      fclose(f);
       return BROTLI_FALSE;
     }
+    fclose(f);
+    context->dictionaries[i] = buffer;
+    if (command == COMMAND_COMPRESS) {
+      context->prepared_dictionaries[i] = BrotliEncoderPrepareDictionary(
+          BROTLI_SHARED_DICTIONARY_RAW, context->dictionary_sizes[i],
+          context->dictionaries[i], BROTLI_MAX_QUALITY, NULL, NULL, NULL);
+      if (context->prepared_dictionaries[i] == NULL) {
+        fprintf(stderr, "failed to prepare dictionary [%s]\n",
+                PrintablePath(path));
+        return BROTLI_FALSE;
+      }
+    }
   }
   return BROTLI_TRUE;
 }
@@ -890,8 +1013,8 @@ static BROTLI_BOOL NextFile(Context* context) {
 static BROTLI_BOOL OpenFiles(Context* context) {
   BROTLI_BOOL is_ok = OpenInputFile(context->current_input_path, &context->fin);
   if (!context->test_integrity && is_ok) {
-    is_ok = OpenOutputFile(
-        context->current_output_path, &context->fout, context->force_overwrite);
+    is_ok = OpenOutputFile(context->current_output_path, &context->fout,
+                           context->force_overwrite, S_IRUSR | S_IWUSR);
   }
   return is_ok;
 }
@@ -1034,9 +1157,95 @@ static const char* PrettyDecoderErrorString(BrotliDecoderErrorCode code) {
   return error_str;
 }
 
+/* Largest output of one-shot decompression; bigger files are streamed. */
+static const size_t kMaxDirectOutputSize = (size_t)1 << 30;
+
+/* Largest output buffer allocated on a guess, when stream does not record its
+   decompressed size. A wrong guess wastes at most one decode of this size. */
+static const size_t kMaxGuessedOutputSize = (size_t)1 << 24;
+
+/* Decompresses memory-mapped input file right into a single output buffer
+   with BrotliDecoderDecompressDirect, bypassing the decoder ring-buffer.
+   Streams with restart points record their decompressed size, and the output
+   buffer is sized exactly. For other streams a single attempt is made with
+   4x input, but at most kMaxGuessedOutputSize.
+   Returns BROTLI_FALSE if file should be processed by the streaming decoder:
+   input is not a regular file, output is too large, stream is corrupted or
+   uses large window, etc. In that case input file position is not changed.
+   Otherwise |is_ok| is set to the outcome of writing the output. */
+static BROTLI_BOOL DecompressFileDirect(Context* context, BROTLI_BOOL* is_ok) {
+#if HAVE_MMAP
+  int64_t input_size = context->input_file_length;
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_ERROR;
+  uint8_t* output = NULL;
+  size_t capacity;
+  size_t decoded_size = 0;
+  void* mapped;
+  if (!context->current_input_path || context->num_dictionaries != 0) {
+    return BROTLI_FALSE;
+  }
+  if (input_size <= 0 || (uint64_t)input_size > kMaxDirectOutputSize) {
+    return BROTLI_FALSE;
+  }
+  mapped = mmap(NULL, (size_t)input_size, PROT_READ, MAP_PRIVATE,
+                fileno(context->fin), 0);
+  if (mapped == MAP_FAILED) return BROTLI_FALSE;
+  if (BrotliDecoderGetDecodedSize((size_t)input_size,
+          (const uint8_t*)mapped, &capacity)) {
+    if (capacity > kMaxDirectOutputSize) capacity = 0;
+  } else if ((size_t)input_size <= kMaxGuessedOutputSize / 4) {
+    capacity = (size_t)input_size * 4;
+    if (capacity < kFileBufferSize) capacity = kFileBufferSize;
+  } else {
+    capacity = 0;
+  }
+  if (capacity != 0) {
+    output = (uint8_t*)malloc(capacity + BROTLI_DECODER_DIRECT_SLACK);
+  }
+  if (output) {
+    decoded_size = capacity + BROTLI_DECODER_DIRECT_SLACK;
+    result = BrotliDecoderDecompressDirect((size_t)input_size,
+        (const uint8_t*)mapped, &decoded_size, output);
+  }
+  munmap(mapped, (size_t)input_size);
+  if (result != BROTLI_DECODER_RESULT_SUCCESS) {
+    free(output);
+    return BROTLI_FALSE;
+  }
+
+  context->total_in = (size_t)input_size;
+  context->total_out = decoded_size;
+  *is_ok = BROTLI_TRUE;
+  if (!context->test_integrity) {
+    fwrite(output, 1, decoded_size, context->fout);
+    if (ferror(context->fout)) {
+      fprintf(stderr, "failed to write output [%s]: %s\n",
+              PrintablePath(context->current_output_path), strerror(errno));
+      *is_ok = BROTLI_FALSE;
+    }
+  }
+  free(output);
+  return BROTLI_TRUE;
+#else  /* HAVE_MMAP */
+  (void)context;
+  (void)is_ok;
+  return BROTLI_FALSE;
+#endif  /* HAVE_MMAP */
+}
+
 static BROTLI_BOOL DecompressFile(Context* context, BrotliDecoderState* s) {
   BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT;
+  BROTLI_BOOL is_ok = BROTLI_TRUE;
   InitializeBuffers(context);
+  if (DecompressFileDirect(context, &is_ok)) {
+    if (is_ok && context->verbosity > 0) {
+      context->end_time = clock();
+      fprintf(stderr, "Decompressed ");
+      PrintFileProcessingProgress(context);
+      fprintf(stderr, "\n");
+    }
+    return is_ok;
+  }
   for (;;) {
     if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
       if (!HasMoreInput(context)) {
@@ -1086,6 +1295,7 @@ static BROTLI_BOOL DecompressFile(Context* context, BrotliDecoderState* s) {
 }
 
 static BROTLI_BOOL DecompressFiles(Context* context) {
+  size_t i;
   while (NextFile(context)) {
     BROTLI_BOOL is_ok = BROTLI_TRUE;
     BROTLI_BOOL rm_input = BROTLI_FALSE;
@@ -1099,9 +1309,9 @@ static BROTLI_BOOL DecompressFiles(Context* context) {
        fragmentation (new builds decode streams that old builds don't),
        it is better from used experience perspective. */
     BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1u);
-    if (context->dictionary) {
+    for (i = 0; i < context->num_dictionaries; ++i) {
       BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
-          context->dictionary_size, context->dictionary);
+          context->dictionary_sizes[i], context->dictionaries[i]);
     }
     is_ok = OpenFiles(context);
     if (is_ok && !context->current_input_path &&
@@ -1156,14 +1366,22 @@ static BROTLI_BOOL CompressFile(Context* context, BrotliEncoderState* s) {
 }
 
 static BROTLI_BOOL CompressFiles(Context* context) {
+  /* Instance is reset between files; memory allocated for a file is reused
+     for the next one. */
+  BrotliEncoderState* s = NULL;
+  size_t i;
   while (NextFile(context)) {
     BROTLI_BOOL is_ok = BROTLI_TRUE;
     BROTLI_BOOL rm_input = BROTLI_FALSE;
     BROTLI_BOOL rm_output = BROTLI_TRUE;
-    BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
-    if (!s) {
-      fprintf(stderr, "out of memory\n");
-      return BROTLI_FALSE;
+    if (s) {
+      BrotliEncoderResetInstance(s);
+    } else {
+      s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+      if (!s) {
+        fprintf(stderr, "out of memory\n");
+        return BROTLI_FALSE;
+      }
     }
     BrotliEncoderSetParameter(s,
         BROTLI_PARAM_QUALITY, (uint32_t)context->quality);
@@ -1194,8 +1412,13 @@ static BROTLI_BOOL CompressFiles(Context* context) {
           (uint32_t)context->input_file_length : (1u << 30);
       BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT, size_hint);
     }
-    if (context->dictionary) {
-      BrotliEncoderAttachPreparedDictionary(s, context->prepared_dictionary);
+    if (context->num_threads > 1) {
+      BrotliEncoderSetParameter(s,
+          BROTLI_PARAM_NUM_THREADS, (uint32_t)context->num_threads);
+    }
+    for (i = 0; i < context->num_dictionaries; ++i) {
+      BrotliEncoderAttachPreparedDictionary(
+          s, context->prepared_dictionaries[i]);
     }
     is_ok = OpenFiles(context);
     if (is_ok && !context->current_output_path &&
@@ -1204,7 +1427,6 @@ static BROTLI_BOOL CompressFiles(Context* context) {
       is_ok = BROTLI_FALSE;
     }
     if (is_ok) is_ok = CompressFile(context, s);
-    BrotliEncoderDestroyInstance(s);
     rm_output = !is_ok;
     if (is_ok && context->reject_uncompressible) {
       if (context->total_out >= context->total_in) {
@@ -1216,11 +1438,415 @@ static BROTLI_BOOL CompressFiles(Context* context) {
     }
     rm_input = !rm_output && context->junk_source;
     if (!CloseFiles(context, rm_input, rm_output)) is_ok = BROTLI_FALSE;
-    if (!is_ok) return BROTLI_FALSE;
+    if (!is_ok) {
+      BrotliEncoderDestroyInstance(s);
+      return BROTLI_FALSE;
+    }
   }
+  BrotliEncoderDestroyInstance(s);
   return BROTLI_TRUE;
 }
 
+/* Dictionary training.
+
+   Trained dictionary is a concatenation of corpus segments that cover the most
+   common d-mers (substrings of TRAIN_DMER_SIZE bytes); approach is similar to
+   FastCover. D-mer "frequency" is the number of samples it occurs in. Corpus
+   is split into equal epochs, and each epoch contributes the segment with the
+   highest sum of frequencies of distinct d-mers it contains; d-mers of chosen
+   segments are not rewarded again. The best segments are placed at the end of
+   the dictionary, closest to the data, where distances are cheaper to encode.
+   Several segment sizes are tried; the one which gives the smallest total
+   compressed size of samples wins. */
+
+#define TRAIN_DMER_SIZE 8
+#define TRAIN_HASH_BITS 20
+
+static const size_t kMaxTrainCorpusSize = (size_t)1 << 30;
+/* Samples with total size about this are compressed to evaluate candidate
+   dictionary; longer samples are cut. */
+static const size_t kTrainEvaluationSize = (size_t)1 << 24;
+static const int kTrainEvaluationQuality = 5;
+#define NUM_TRAIN_SEGMENT_SIZES 5
+static const size_t kTrainSegmentSizes[NUM_TRAIN_SEGMENT_SIZES] =
+    {64, 128, 256, 512, 1024};
+
+typedef struct {
+  const uint8_t* data;
+  size_t data_size;
+  const size_t* offsets;  /* sample boundaries; |num_samples| + 1 items */
+  size_t num_samples;
+  uint32_t* frequencies;
+  uint32_t* scores;  /* frequencies that are not used by chosen segments yet */
+  uint16_t* active;  /* number of d-mer occurrences in current window */
+} Trainer;
+
+typedef struct {
+  size_t position;
+  uint64_t score;
+} TrainSegment;
+
+static BROTLI_INLINE uint32_t HashDmer(const uint8_t* data) {
+  static const uint64_t kHashMul =
+      BROTLI_MAKE_UINT64_T(0x1FE35A7Bu, 0xD3579BD3u);
+  return (uint32_t)((BROTLI_UNALIGNED_LOAD64LE(data) * kHashMul) >>
+                    (64 - TRAIN_HASH_BITS));
+}
+
+static void CountDmers(Trainer* t, uint32_t* last_sample) {
+  size_t i;
+  for (i = 0; i < t->num_samples; ++i) {
+    size_t pos = t->offsets[i];
+    size_t end = t->offsets[i + 1];
+    uint32_t mark = (uint32_t)i + 1;
+    for (; pos + TRAIN_DMER_SIZE <= end; ++pos) {
+      uint32_t h = HashDmer(t->data + pos);
+      if (last_sample[h] != mark) {
+        last_sample[h] = mark;
+        t->frequencies[h]++;
+      }
+    }
+  }
+}
+
+/* Finds the window of |window| d-mer positions in [begin, end) with the
+   highest score. Returns the score (0 if range is too short), and stores the
+   start of the window to |*position|. */
+static uint64_t FindBestSegment(Trainer* t, size_t begin, size_t end,
+                                size_t window, size_t* position) {
+  const uint8_t* data = t->data;
+  uint32_t* scores = t->scores;
+  uint16_t* active = t->active;
+  uint64_t score = 0;
+  uint64_t best_score = 0;
+  size_t last;
+  size_t pos;
+  if (end - begin < window + TRAIN_DMER_SIZE - 1) return 0;
+  last = end - TRAIN_DMER_SIZE;
+  for (pos = begin; pos <= last; ++pos) {
+    uint32_t h = HashDmer(data + pos);
+    if (active[h]++ == 0) score += scores[h];
+    if (pos >= begin + window) {
+      uint32_t old = HashDmer(data + pos - window);
+      if (--active[old] == 0) score -= scores[old];
+    }
+    if (pos + 1 >= begin + window && score > best_score) {
+      best_score = score;
+      *position = pos + 1 - window;
+    }
+  }
+  /* Cleanup window state for the next range. */
+  for (pos = last + 1 - window; pos <= last; ++pos) {
+    active[HashDmer(data + pos)] = 0;
+  }
+  return best_score;
+}
+
+/* Chooses up to |num_epochs| segments of |segment_size| bytes. Segments do
+   not cross sample boundaries: concatenated samples are not data that the
+   dictionary is going to be used with. */
+static size_t SelectSegments(Trainer* t, size_t segment_size,
+                             size_t num_epochs, TrainSegment* segments) {
+  size_t epoch_size = t->data_size / num_epochs;
+  size_t window = segment_size - TRAIN_DMER_SIZE + 1;
+  size_t num_segments = 0;
+  size_t sample = 0;
+  size_t epoch;
+  memcpy(t->scores, t->frequencies, sizeof(uint32_t) << TRAIN_HASH_BITS);
+  for (epoch = 0; epoch < num_epochs; ++epoch) {
+    size_t begin = epoch * epoch_size;
+    size_t end = (epoch + 1 == num_epochs) ? t->data_size : begin + epoch_size;
+    uint64_t best_score = 0;
+    size_t best_position = begin;
+    size_t i;
+    size_t pos;
+    while (t->offsets[sample + 1] <= begin) sample++;
+    for (i = sample; i < t->num_samples && t->offsets[i] < end; ++i) {
+      size_t position = 0;
+      uint64_t score = FindBestSegment(t,
+          BROTLI_MAX(size_t, begin, t->offsets[i]),
+          BROTLI_MIN(size_t, end, t->offsets[i + 1]), window, &position);
+      if (score > best_score) {
+        best_score = score;
+        best_position = position;
+      }
+    }
+
+    if (best_score == 0) continue;
+    segments[num_segments].position = best_position;
+    segments[num_segments].score = best_score;
+    num_segments++;
+    for (pos = best_position; pos < best_position + window; ++pos) {
+      t->scores[HashDmer(t->data + pos)] = 0;
+    }
+  }
+  return num_segments;
+}
+
+static int CompareSegments(const void* a, const void* b) {
+  const TrainSegment* x = (const TrainSegment*)a;
+  const TrainSegment* y = (const TrainSegment*)b;
+  if (x->score != y->score) return (x->score < y->score) ? -1 : 1;
+  if (x->position != y->position) return (x->position < y->position) ? -1 : 1;
+  return 0;
+}
+
+/* Returns size of dictionary built in |dictionary|. */
+static size_t BuildDictionary(Trainer* t, size_t segment_size,
+                              size_t dictionary_size, TrainSegment* segments,
+                              uint8_t* dictionary) {
+  size_t num_segments = SelectSegments(
+      t, segment_size, dictionary_size / segment_size, segments);
+  size_t i;
+  qsort(segments, num_segments, sizeof(TrainSegment), CompareSegments);
+  for (i = 0; i < num_segments; ++i) {
+    memcpy(dictionary + i * segment_size, t->data + segments[i].position,
+           segment_size);
+  }
+  return num_segments * segment_size;
+}
+
+/* Sets |*result| to the total compressed size of samples. */
+static BROTLI_BOOL EvaluateDictionary(const Trainer* t,
+    const uint8_t* dictionary, size_t dictionary_size, uint8_t* output,
+    size_t output_capacity, size_t* result) {
+  BrotliEncoderPreparedDictionary* prepared;
+  BrotliEncoderState* s;
+  BROTLI_BOOL is_ok = BROTLI_TRUE;
+  size_t step = t->data_size / kTrainEvaluationSize + 1;
+  size_t total = 0;
+  size_t i;
+  prepared = BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW,
+      dictionary_size, dictionary, kTrainEvaluationQuality, NULL, NULL, NULL);
+  s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  if (!prepared || !s) is_ok = BROTLI_FALSE;
+  for (i = 0; is_ok && i < t->num_samples; i += step) {
+    const uint8_t* next_in = t->data + t->offsets[i];
+    size_t available_in = t->offsets[i + 1] - t->offsets[i];
+    uint8_t* next_out = output;
+    size_t available_out = output_capacity;
+    if (available_in > kTrainEvaluationSize) {
+      available_in = kTrainEvaluationSize;
+    }
+    BrotliEncoderResetInstance(s);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY,
+        (uint32_t)kTrainEvaluationQuality);
+    BrotliEncoderAttachPreparedDictionary(s, prepared);
+    is_ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+    if (is_ok && !BrotliEncoderIsFinished(s)) is_ok = BROTLI_FALSE;
+    total += output_capacity - available_out;
+  }
+  BrotliEncoderDestroyInstance(s);
+  BrotliEncoderDestroyPreparedDictionary(prepared);
+  *result = total;
+  return is_ok;
+}
+
+/* Reads all inputs into a single buffer; |*offsets| gets sample boundaries. */
+static BROTLI_BOOL ReadSamples(Context* context, uint8_t** data,
+                               size_t* data_size, size_t** offsets,
+                               size_t* num_samples) {
+  size_t capacity = 0;
+  size_t offsets_capacity = 0;
+  *data = NULL;
+  *data_size = 0;
+  *offsets = NULL;
+  *num_samples = 0;
+  while (NextFile(context)) {
+    FILE* f;
+    BROTLI_BOOL is_ok;
+    if (*num_samples + 2 > offsets_capacity) {
+      size_t* new_offsets;
+      offsets_capacity = offsets_capacity ? 2 * offsets_capacity : 256;
+      new_offsets =
+          (size_t*)realloc(*offsets, offsets_capacity * sizeof(size_t));
+      if (!new_offsets) {
+        fprintf(stderr, "out of memory\n");
+        return BROTLI_FALSE;
+      }
+      *offsets = new_offsets;
+    }
+    (*offsets)[*num_samples] = *data_size;
+    if (!OpenInputFile(context->current_input_path, &f)) return BROTLI_FALSE;
+    for (;;) {
+      size_t bytes_read;
+      if (*data_size + kFileBufferSize > capacity) {
+        uint8_t* new_data;
+        capacity = capacity ? 2 * capacity : 2 * kFileBufferSize;
+        new_data = (uint8_t*)realloc(*data, capacity);
+        if (!new_data) {
+          fprintf(stderr, "out of memory\n");
+          fclose(f);
+          return BROTLI_FALSE;
+        }
+        *data = new_data;
+      }
+      bytes_read = fread(*data + *data_size, 1, kFileBufferSize, f);
+      *data_size += bytes_read;
+      if (bytes_read != kFileBufferSize) break;
+      if (*data_size > kMaxTrainCorpusSize) break;
+    }
+    is_ok = !ferror(f);
+    if (!is_ok) {
+      fprintf(stderr, "failed to read input [%s]: %s\n",
+              PrintablePath(context->current_input_path), strerror(errno));
+    }
+    fclose(f);
+    if (!is_ok) return BROTLI_FALSE;
+    if (*data_size > kMaxTrainCorpusSize) {
+      fprintf(stderr, "samples are larger than maximum allowed: ");
+      PrintBytes(kMaxTrainCorpusSize);
+      fprintf(stderr, "\n");
+      return BROTLI_FALSE;
+    }
+    (*offsets)[++*num_samples] = *data_size;
+  }
+  return !context->iterator_error;
+}
+
+static BROTLI_BOOL TrainDictionary(Context* context) {
+  size_t dictionary_size = context->train_dictionary_size;
+  uint8_t* data = NULL;
+  size_t data_size = 0;
+  size_t* offsets = NULL;
+  size_t num_samples = 0;
+  Trainer t;
+  TrainSegment* segments = NULL;
+  uint32_t* last_sample = NULL;
+  uint8_t* candidate = NULL;
+  uint8_t* best = NULL;
+  size_t best_size = 0;
+  uint8_t* output = NULL;
+  size_t output_capacity = 0;
+  FILE* fout = NULL;
+  BROTLI_BOOL is_ok;
+  size_t i;
+
+  t.frequencies = NULL;
+  t.scores = NULL;
+  t.active = NULL;
+  context->start_time = clock();
+  is_ok = ReadSamples(context, &data, &data_size, &offsets, &num_samples);
+  if (is_ok && data_size == 0) {
+    fprintf(stderr, "no sample data\n");
+    is_ok = BROTLI_FALSE;
+  }
+
+  if (is_ok && data_size <= dictionary_size) {
+    /* Nothing to choose from; whole corpus makes the dictionary. */
+    best = data;
+    best_size = data_size;
+    data = NULL;
+  } else if (is_ok) {
+    size_t hash_size = (size_t)1 << TRAIN_HASH_BITS;
+    size_t max_sample_size = 0;
+    size_t best_compressed_size = 0;
+    for (i = 0; i < num_samples; ++i) {
+      size_t sample_size = offsets[i + 1] - offsets[i];
+      if (sample_size > max_sample_size) max_sample_size = sample_size;
+    }
+    if (max_sample_size > kTrainEvaluationSize) {
+      max_sample_size = kTrainEvaluationSize;
+    }
+    output_capacity = BrotliEncoderMaxCompressedSize(max_sample_size);
+    t.data = data;
+    t.data_size = data_size;
+    t.offsets = offsets;
+    t.num_samples = num_samples;
+    t.frequencies = (uint32_t*)calloc(hash_size, sizeof(uint32_t));
+    t.scores = (uint32_t*)malloc(hash_size * sizeof(uint32_t));
+    t.active = (uint16_t*)calloc(hash_size, sizeof(uint16_t));
+    last_sample = (uint32_t*)calloc(hash_size, sizeof(uint32_t));
+    segments = (TrainSegment*)malloc(
+        (dictionary_size / kTrainSegmentSizes[0]) * sizeof(TrainSegment));
+    candidate = (uint8_t*)malloc(dictionary_size);
+    best = (uint8_t*)malloc(dictionary_size);
+    output = (uint8_t*)malloc(output_capacity);
+    if (!t.frequencies || !t.scores || !t.active || !last_sample ||
+        !segments || !candidate || !best || !output) {
+      fprintf(stderr, "out of memory\n");
+      is_ok = BROTLI_FALSE;
+    }
+    if (is_ok) CountDmers(&t, last_sample);
+    for (i = 0; is_ok && i < NUM_TRAIN_SEGMENT_SIZES; ++i) {
+      size_t segment_size = kTrainSegmentSizes[i];
+      size_t candidate_size;
+      size_t compressed_size;
+      if (segment_size > dictionary_size) break;
+      candidate_size = BuildDictionary(
+          &t, segment_size, dictionary_size, segments, candidate);
+      if (candidate_size == 0) continue;
+      is_ok = EvaluateDictionary(&t, candidate, candidate_size, output,
+                                 output_capacity, &compressed_size);
+      if (!is_ok) {
+        fprintf(stderr, "failed to evaluate dictionary\n");
+        break;
+      }
+      if (context->verbosity > 0) {
+        fprintf(stderr, "Segment size %d: dictionary ", (int)segment_size);
+        PrintBytes(candidate_size);
+        fprintf(stderr, ", samples compressed to ");
+        PrintBytes(compressed_size);
+        fprintf(stderr, "\n");
+      }
+      if (best_size == 0 || compressed_size < best_compressed_size) {
+        uint8_t* tmp = best;
+        best = candidate;
+        candidate = tmp;
+        best_size = candidate_size;
+        best_compressed_size = compressed_size;
+      }
+    }
+    if (is_ok && best_size == 0) {
+      fprintf(stderr, "samples are too small or have nothing in common\n");
+      is_ok = BROTLI_FALSE;
+    }
+  }
+
+  if (is_ok) {
+    is_ok = OpenOutputFile(context->output_path, &fout,
+                           context->force_overwrite, SHARED_FILE_MODE);
+  }
+  if (is_ok && !context->output_path && !context->force_overwrite &&
+      isatty(STDOUT_FILENO)) {
+    fprintf(stderr, "Use -h help. Use -f to force output to a terminal.\n");
+    is_ok = BROTLI_FALSE;
+  }
+  if (is_ok && fwrite(best, 1, best_size, fout) != best_size) {
+    fprintf(stderr, "failed to write output [%s]: %s\n",
+            PrintablePath(context->output_path), strerror(errno));
+    is_ok = BROTLI_FALSE;
+  }
+  if (fout && fclose(fout) != 0) {
+    fprintf(stderr, "fclose failed [%s]: %s\n",
+            PrintablePath(context->output_path), strerror(errno));
+    is_ok = BROTLI_FALSE;
+  }
+  if (is_ok && context->verbosity > 0) {
+    context->end_time = clock();
+    fprintf(stderr, "Trained dictionary of ");
+    PrintBytes(best_size);
+    fprintf(stderr, " from %d samples (", (int)num_samples);
+    PrintBytes(data_size);
+    fprintf(stderr, ") in %1.2f sec\n",
+            (double)(context->end_time - context->start_time) /
+            CLOCKS_PER_SEC);
+  }
+
+  free(output);
+  free(best);
+  free(candidate);
+  free(segments);
+  free(last_sample);
+  free(t.active);
+  free(t.scores);
+  free(t.frequencies);
+  free(offsets);
+  free(data);
+  return is_ok;
+}
+
 int main(int argc, char** argv) {
   Command command;
   Context context;
@@ -1229,6 +1855,7 @@ int main(int argc, char** argv) {
 
   context.quality = 11;
   context.lgwin = -1;
+  context.num_threads = 1;
   context.verbosity = 0;
   context.force_overwrite = BROTLI_FALSE;
   context.junk_source = BROTLI_FALSE;
@@ -1239,7 +1866,8 @@ int main(int argc, char** argv) {
   context.decompress = BROTLI_FALSE;
   context.large_window = BROTLI_FALSE;
   context.output_path = NULL;
-  context.dictionary_path = NULL;
+  context.num_dictionaries = 0;
+  context.train_dictionary_size = kDefaultTrainDictionarySize;
   context.suffix = DEFAULT_SUFFIX;
   for (i = 0; i < MAX_OPTIONS; ++i) context.not_input_indices[i] = 0;
   context.longest_path_len = 1;
@@ -1247,9 +1875,12 @@ int main(int argc, char** argv) {
 
   context.argc = argc;
   context.argv = argv;
-  context.dictionary = NULL;
-  context.dictionary_size = 0;
-  context.prepared_dictionary = NULL;
+  for (i = 0; i < MAX_DICTIONARIES; ++i) {
+    context.dictionary_paths[i] = NULL;
+    context.dictionaries[i] = NULL;
+    context.dictionary_sizes[i] = 0;
+    context.prepared_dictionaries[i] = NULL;
+  }
   context.modified_path = NULL;
   context.iterator = 0;
   context.ignore = 0;
@@ -1264,7 +1895,7 @@ int main(int argc, char** argv) {
 
   if (command == COMMAND_COMPRESS || command == COMMAND_DECOMPRESS ||
       command == COMMAND_TEST_INTEGRITY) {
-    if (!ReadDictionary(&context, command)) is_ok = BROTLI_FALSE;
+    if (!ReadDictionaries(&context, command)) is_ok = BROTLI_FALSE;
     if (is_ok) {
       size_t modified_path_len =
           context.longest_path_len + strlen(context.suffix) + 1;
@@ -1299,6 +1930,10 @@ int main(int argc, char** argv) {
       is_ok = DecompressFiles(&context);
       break;
 
+    case COMMAND_TRAIN:
+      is_ok = TrainDictionary(&context);
+      break;
+
     case COMMAND_HELP:
     case COMMAND_INVALID:
     default:
@@ -1309,8 +1944,10 @@ int main(int argc, char** argv) {
 
   if (context.iterator_error) is_ok = BROTLI_FALSE;
 
-  BrotliEncoderDestroyPreparedDictionary(context.prepared_dictionary);
-  free(context.dictionary);
+  for (i = 0; i < MAX_DICTIONARIES; ++i) {
+    BrotliEncoderDestroyPreparedDictionary(context.prepared_dictionaries[i]);
+    free(context.dictionaries[i]);
+  }
   free(context.modified_path);
   free(context.buffer);
 
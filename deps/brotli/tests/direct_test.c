@@ -0,0 +1,230 @@
+/* Copyright 2026 the Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Tests for BrotliDecoderDecompressDirect.
+
+   Every stream is decoded into a buffer of exactly decompressed size plus
+   BROTLI_DECODER_DIRECT_SLACK, which must succeed, and into a buffer that is
+   one byte shorter, which must ask for more output. Bytes past the buffer are
+   checked to be left untouched. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include <brotli/types.h>
+
+#define CANARY_SIZE 64
+#define CANARY_BYTE 0xA5
+
+static int failures = 0;
+static char test_name[128];
+
+#define CHECK(COND)                                                 \
+  do {                                                              \
+    if (!(COND)) {                                                  \
+      fprintf(stderr, "%s:%d: check failed: %s (%s)\n", __FILE__,   \
+              __LINE__, #COND, test_name);                          \
+      failures++;                                                   \
+      return;                                                       \
+    }                                                               \
+  } while (0)
+
+static uint32_t Random(uint32_t* seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 16;
+}
+
+/* Text-like data: random words, and copies of earlier data at distances of
+   up to |max_distance|, so that long backward references are exercised. */
+static void MakeText(uint8_t* data, size_t size, size_t max_distance) {
+  static const char* kWords[] = {
+    "direct ", "slack ", "ring ", "buffer ", "copy ", "length ", "distance ",
+    "window ", "\n", ". ", "brotli "
+  };
+  const size_t num_words = sizeof(kWords) / sizeof(kWords[0]);
+  uint32_t seed = 4321;
+  size_t pos = 0;
+  while (pos < size) {
+    size_t len;
+    if (pos > 4096 && Random(&seed) % 8 == 0) {
+      size_t distance = 1 + Random(&seed) * 37u % (pos < max_distance ?
+          pos : max_distance);
+      size_t i;
+      len = 4 + Random(&seed) % 300;
+      if (len > size - pos) len = size - pos;
+      for (i = 0; i < len; ++i) data[pos + i] = data[pos + i - distance];
+    } else {
+      const char* word = kWords[Random(&seed) % num_words];
+      len = strlen(word);
+      if (len > size - pos) len = size - pos;
+      memcpy(data + pos, word, len);
+    }
+    pos += len;
+  }
+}
+
+static void MakeNoise(uint8_t* data, size_t size) {
+  uint32_t seed = 8765;
+  size_t i;
+  for (i = 0; i < size; ++i) data[i] = (uint8_t)Random(&seed);
+}
+
+/* Decodes |encoded| into a buffer of |capacity| bytes followed by canary
+   bytes; returns the result, and checks that canary is intact. */
+static BrotliDecoderResult DecodeDirect(const uint8_t* encoded,
+    size_t encoded_size, uint8_t* output, size_t capacity,
+    size_t* decoded_size, BROTLI_BOOL* canary_ok) {
+  BrotliDecoderResult result;
+  size_t i;
+  memset(output + capacity, CANARY_BYTE, CANARY_SIZE);
+  *decoded_size = capacity;
+  result = BrotliDecoderDecompressDirect(
+      encoded_size, encoded, decoded_size, output);
+  *canary_ok = BROTLI_TRUE;
+  for (i = 0; i < CANARY_SIZE; ++i) {
+    if (output[capacity + i] != CANARY_BYTE) *canary_ok = BROTLI_FALSE;
+  }
+  return result;
+}
+
+static void TestStream(const uint8_t* input, size_t input_size, int quality,
+                       int lgwin) {
+  size_t encoded_size = BrotliEncoderMaxCompressedSize(input_size) + 16;
+  uint8_t* encoded = (uint8_t*)malloc(encoded_size + 1);
+  uint8_t* output = (uint8_t*)malloc(
+      input_size + BROTLI_DECODER_DIRECT_SLACK + CANARY_SIZE);
+  size_t decoded_size;
+  BROTLI_BOOL canary_ok;
+  BrotliDecoderResult result;
+  if (!encoded || !output) {
+    free(encoded);
+    free(output);
+    CHECK(!"out of memory");
+  }
+  if (!BrotliEncoderCompress(quality, lgwin, BROTLI_MODE_GENERIC, input_size,
+                             input, &encoded_size, encoded)) {
+    free(encoded);
+    free(output);
+    CHECK(!"compression failed");
+  }
+
+  /* Exactly enough room. */
+  result = DecodeDirect(encoded, encoded_size, output,
+      input_size + BROTLI_DECODER_DIRECT_SLACK, &decoded_size, &canary_ok);
+  if (result != BROTLI_DECODER_RESULT_SUCCESS || decoded_size != input_size ||
+      memcmp(output, input, input_size) != 0 || !canary_ok) {
+    free(encoded);
+    free(output);
+    CHECK(!"decoding with exact slack");
+  }
+
+  /* One byte short; small buffers are rejected without decoding. */
+  result = DecodeDirect(encoded, encoded_size, output,
+      input_size + BROTLI_DECODER_DIRECT_SLACK - 1, &decoded_size, &canary_ok);
+  if (result != BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT || !canary_ok) {
+    free(encoded);
+    free(output);
+    CHECK(!"decoding with one byte less than slack");
+  }
+
+  /* Data past the end of the stream is an error. */
+  encoded[encoded_size] = 0;
+  result = DecodeDirect(encoded, encoded_size + 1, output,
+      input_size + BROTLI_DECODER_DIRECT_SLACK, &decoded_size, &canary_ok);
+  if (result != BROTLI_DECODER_RESULT_ERROR || !canary_ok) {
+    free(encoded);
+    free(output);
+    CHECK(!"trailing data");
+  }
+
+  /* So is a truncated stream. */
+  result = DecodeDirect(encoded, encoded_size - 1, output,
+      input_size + BROTLI_DECODER_DIRECT_SLACK, &decoded_size, &canary_ok);
+  free(encoded);
+  free(output);
+  CHECK(result == BROTLI_DECODER_RESULT_ERROR);
+  CHECK(canary_ok);
+}
+
+/* Large window streams are not supported; they must not decode. */
+static void TestLargeWindow(const uint8_t* input, size_t input_size) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t encoded_size = BrotliEncoderMaxCompressedSize(input_size) + 16;
+  uint8_t* encoded = (uint8_t*)malloc(encoded_size);
+  uint8_t* output = (uint8_t*)malloc(
+      input_size + BROTLI_DECODER_DIRECT_SLACK + CANARY_SIZE);
+  size_t available_in = input_size;
+  const uint8_t* next_in = input;
+  size_t available_out = encoded_size;
+  uint8_t* next_out = encoded;
+  size_t decoded_size;
+  BROTLI_BOOL canary_ok;
+  BROTLI_BOOL encoded_ok;
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_SUCCESS;
+  encoded_ok = TO_BROTLI_BOOL(s && encoded && output);
+  if (encoded_ok) {
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, 5);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LARGE_WINDOW, 1);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, 26);
+    encoded_ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+    encoded_ok = TO_BROTLI_BOOL(encoded_ok && BrotliEncoderIsFinished(s));
+  }
+  if (encoded_ok) {
+    result = DecodeDirect(encoded, encoded_size - available_out, output,
+        input_size + BROTLI_DECODER_DIRECT_SLACK, &decoded_size, &canary_ok);
+  }
+  BrotliEncoderDestroyInstance(s);
+  free(encoded);
+  free(output);
+  CHECK(encoded_ok);
+  CHECK(result == BROTLI_DECODER_RESULT_ERROR);
+  CHECK(canary_ok);
+}
+
+int main(void) {
+  static const int kQualities[] = {0, 1, 5, 9, 11};
+  static const int kWindows[] = {10, 16, 22};
+  static const size_t kSizes[] = {0, 1, 100, 70000, (size_t)1 << 21};
+  const size_t max_size = (size_t)1 << 21;
+  uint8_t* text = (uint8_t*)malloc(max_size);
+  uint8_t* noise = (uint8_t*)malloc(max_size);
+  size_t q;
+  size_t w;
+  size_t n;
+  if (!text || !noise) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  MakeText(text, max_size, (size_t)1 << 22);
+  MakeNoise(noise, max_size);
+  for (n = 0; n < sizeof(kSizes) / sizeof(kSizes[0]); ++n) {
+    for (q = 0; q < sizeof(kQualities) / sizeof(kQualities[0]); ++q) {
+      for (w = 0; w < sizeof(kWindows) / sizeof(kWindows[0]); ++w) {
+        /* High qualities on megabytes of input take too long for a test. */
+        if (kQualities[q] >= 9 && kSizes[n] > 70000) continue;
+        snprintf(test_name, sizeof(test_name), "text, %d bytes, q%d, w%d",
+                 (int)kSizes[n], kQualities[q], kWindows[w]);
+        TestStream(text, kSizes[n], kQualities[q], kWindows[w]);
+        snprintf(test_name, sizeof(test_name), "noise, %d bytes, q%d, w%d",
+                 (int)kSizes[n], kQualities[q], kWindows[w]);
+        TestStream(noise, kSizes[n], kQualities[q], kWindows[w]);
+      }
+    }
+  }
+  snprintf(test_name, sizeof(test_name), "large window");
+  TestLargeWindow(text, max_size);
+  free(text);
+  free(noise);
+  if (failures) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,245 @@
+/* Copyright 2026 the Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Tests for BrotliEncoderResetInstance and arena-backed encoder instances.
+
+   Output of an instance that is reset between streams, and of instances
+   created in an arena, must be byte-identical to the output of a fresh
+   instance with the same parameters. Reset instances keep their hash tables
+   and buffers, so settings are visited forwards and backwards to have
+   memory reused both by bigger and by smaller configurations. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/encode.h>
+#include <brotli/types.h>
+
+#define INPUT_SIZE ((size_t)200 << 10)
+
+static int failures = 0;
+static char test_name[128];
+
+#define CHECK(COND)                                                 \
+  do {                                                              \
+    if (!(COND)) {                                                  \
+      fprintf(stderr, "%s:%d: check failed: %s (%s)\n", __FILE__,   \
+              __LINE__, #COND, test_name);                          \
+      failures++;                                                   \
+      return;                                                       \
+    }                                                               \
+  } while (0)
+
+typedef struct Config {
+  int quality;
+  int lgwin;
+  int num_threads;
+} Config;
+
+static const Config kConfigs[] = {
+  {0, 16, 1}, {1, 18, 1}, {2, 10, 1}, {4, 22, 1}, {5, 16, 1}, {5, 24, 2},
+  {7, 20, 1}, {9, 22, 1}, {10, 16, 1}, {11, 22, 1}, {6, 12, 1}, {3, 24, 1}
+};
+#define NUM_CONFIGS (sizeof(kConfigs) / sizeof(kConfigs[0]))
+
+/* Text-like input, with copies of earlier parts at varying distances. */
+static void MakeInput(uint8_t* data, size_t size) {
+  static const char* kWords[] = {
+    "reset ", "arena ", "instance ", "hasher ", "ring ", "buffer ", "quality ",
+    "window ", "\n", ", ", "brotli "
+  };
+  const size_t num_words = sizeof(kWords) / sizeof(kWords[0]);
+  uint32_t seed = 777;
+  size_t pos = 0;
+  while (pos < size) {
+    size_t len;
+    seed = seed * 1103515245u + 12345u;
+    if (pos > 1024 && (seed >> 16) % 6 == 0) {
+      size_t distance = 1 + (seed >> 8) % pos;
+      size_t i;
+      len = 8 + (seed >> 20) % 64;
+      if (len > size - pos) len = size - pos;
+      for (i = 0; i < len; ++i) data[pos + i] = data[pos + i - distance];
+    } else {
+      const char* word = kWords[(seed >> 16) % num_words];
+      len = strlen(word);
+      if (len > size - pos) len = size - pos;
+      memcpy(data + pos, word, len);
+    }
+    pos += len;
+  }
+}
+
+/* Input size for |config|; slow qualities get a shorter prefix. */
+static size_t InputSize(const Config* config) {
+  return config->quality >= 10 ? INPUT_SIZE / 4 : INPUT_SIZE;
+}
+
+/* Compresses |input| with |s| in two pieces, and returns the compressed
+   size, or 0 on failure. */
+static size_t Compress(BrotliEncoderState* s, const Config* config,
+    const uint8_t* input, size_t input_size, uint8_t* output,
+    size_t capacity) {
+  const size_t half = input_size / 2;
+  size_t available_in = half;
+  const uint8_t* next_in = input;
+  size_t available_out = capacity;
+  uint8_t* next_out = output;
+  if (!BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY,
+                                 (uint32_t)config->quality) ||
+      !BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN,
+                                 (uint32_t)config->lgwin) ||
+      !BrotliEncoderSetParameter(s, BROTLI_PARAM_NUM_THREADS,
+                                 (uint32_t)config->num_threads) ||
+      !BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT,
+                                 (uint32_t)input_size)) {
+    return 0;
+  }
+  while (available_in != 0) {
+    if (!BrotliEncoderCompressStream(s, BROTLI_OPERATION_PROCESS,
+        &available_in, &next_in, &available_out, &next_out, NULL)) {
+      return 0;
+    }
+  }
+  available_in = input_size - half;
+  while (!BrotliEncoderIsFinished(s)) {
+    if (available_out == 0 ||
+        !BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+            &available_in, &next_in, &available_out, &next_out, NULL)) {
+      return 0;
+    }
+  }
+  return capacity - available_out;
+}
+
+/* Starts a stream with different parameters and abandons it, so that the
+   next reset happens in the middle of a stream. */
+static BROTLI_BOOL StartOtherStream(BrotliEncoderState* s,
+    const uint8_t* input, uint8_t* output, size_t capacity) {
+  size_t available_in = INPUT_SIZE / 3;
+  const uint8_t* next_in = input + INPUT_SIZE / 2;
+  size_t available_out = capacity;
+  uint8_t* next_out = output;
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, 9);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, 18);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+  return BrotliEncoderCompressStream(s, BROTLI_OPERATION_FLUSH,
+      &available_in, &next_in, &available_out, &next_out, NULL);
+}
+
+typedef struct Expected {
+  uint8_t* data;
+  size_t size;
+} Expected;
+
+static void CheckOutput(const Expected* expected, const uint8_t* output,
+                        size_t size) {
+  CHECK(size != 0);
+  CHECK(size == expected->size);
+  CHECK(memcmp(output, expected->data, size) == 0);
+}
+
+static void TestReset(const uint8_t* input, const Expected* expected,
+                      uint8_t* output, size_t capacity) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t pass;
+  size_t i;
+  CHECK(s != NULL);
+  for (pass = 0; pass < 2; ++pass) {
+    for (i = 0; i < NUM_CONFIGS; ++i) {
+      size_t index = pass == 0 ? i : NUM_CONFIGS - 1 - i;
+      const Config* config = &kConfigs[index];
+      size_t size;
+      snprintf(test_name, sizeof(test_name), "reset, q%d, w%d, pass %d",
+               config->quality, config->lgwin, (int)pass);
+      BrotliEncoderResetInstance(s);
+      size = Compress(s, config, input, InputSize(config), output, capacity);
+      CheckOutput(&expected[index], output, size);
+      if (failures) break;
+      /* Abandoned stream must not leak into the next one either. */
+      BrotliEncoderResetInstance(s);
+      if (!StartOtherStream(s, input, output, capacity)) {
+        CHECK(!"abandoned stream failed");
+      }
+    }
+  }
+  BrotliEncoderDestroyInstance(s);
+}
+
+static void TestArena(const uint8_t* input, const Expected* expected,
+                      uint8_t* output, size_t capacity, size_t arena_size) {
+  BrotliEncoderArena* arena =
+      BrotliEncoderCreateArena(arena_size, NULL, NULL, NULL);
+  size_t i;
+  CHECK(arena != NULL);
+  for (i = 0; i < NUM_CONFIGS && !failures; ++i) {
+    const Config* config = &kConfigs[i];
+    BrotliEncoderState* s = BrotliEncoderCreateInstanceInArena(arena);
+    size_t size;
+    snprintf(test_name, sizeof(test_name), "arena of %d bytes, q%d, w%d",
+             (int)arena_size, config->quality, config->lgwin);
+    if (!s) {
+      BrotliEncoderDestroyArena(arena);
+      CHECK(!"instance in arena");
+    }
+    size = Compress(s, config, input, InputSize(config), output, capacity);
+    CheckOutput(&expected[i], output, size);
+    /* Instance in arena is reset the same way. */
+    if (!failures) {
+      BrotliEncoderResetInstance(s);
+      size = Compress(s, config, input, InputSize(config), output, capacity);
+      CheckOutput(&expected[i], output, size);
+    }
+    BrotliEncoderDestroyInstance(s);
+  }
+  BrotliEncoderDestroyArena(arena);
+}
+
+int main(void) {
+  static const size_t kArenaSizes[] = {0, (size_t)1 << 20, (size_t)1 << 26};
+  const size_t capacity = BrotliEncoderMaxCompressedSize(INPUT_SIZE);
+  uint8_t* input = (uint8_t*)malloc(INPUT_SIZE);
+  uint8_t* output = (uint8_t*)malloc(capacity);
+  Expected expected[NUM_CONFIGS];
+  size_t i;
+  if (!input || !output) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  MakeInput(input, INPUT_SIZE);
+
+  /* Reference output of fresh instances. */
+  for (i = 0; i < NUM_CONFIGS; ++i) {
+    BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    expected[i].data = (uint8_t*)malloc(capacity);
+    expected[i].size = 0;
+    if (s && expected[i].data) {
+      expected[i].size = Compress(s, &kConfigs[i], input,
+          InputSize(&kConfigs[i]), expected[i].data, capacity);
+    }
+    BrotliEncoderDestroyInstance(s);
+    if (expected[i].size == 0) {
+      fprintf(stderr, "reference compression failed, q%d, w%d\n",
+              kConfigs[i].quality, kConfigs[i].lgwin);
+      return 1;
+    }
+  }
+
+  TestReset(input, expected, output, capacity);
+  for (i = 0; i < sizeof(kArenaSizes) / sizeof(kArenaSizes[0]); ++i) {
+    TestArena(input, expected, output, capacity, kArenaSizes[i]);
+  }
+
+  for (i = 0; i < NUM_CONFIGS; ++i) free(expected[i].data);
+  free(input);
+  free(output);
+  if (failures) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
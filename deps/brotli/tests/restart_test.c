@@ -0,0 +1,276 @@
+/* Copyright 2026 the Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Round-trip tests for restart points (BROTLI_PARAM_RESTART_POINTS) and
+   BrotliDecoderDecompressParallel.
+
+   Streams are encoded with and without restart points, in one go and with a
+   flush after every small piece of input, and decoded by the regular
+   decoder, the parallel decoder and a baseline single-threaded round-trip. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include <brotli/shared_dictionary.h>
+#include <brotli/types.h>
+
+#include "../c/common/constants.h"
+
+/* Three chunks of 4MiB, so streams have several restart points. */
+#define INPUT_SIZE ((size_t)9 << 20)
+#define FLUSH_STEP ((size_t)64 << 10)
+#define NUM_THREADS 4
+
+static int failures = 0;
+
+#define CHECK(COND)                                                 \
+  do {                                                              \
+    if (!(COND)) {                                                  \
+      fprintf(stderr, "%s:%d: check failed: %s (%s)\n", __FILE__,   \
+              __LINE__, #COND, test_name);                          \
+      failures++;                                                   \
+      return;                                                       \
+    }                                                               \
+  } while (0)
+
+static const char* test_name = "";
+
+/* Text-like input: words drawn with a fixed LCG, so runs are reproducible. */
+static uint8_t* MakeInput(size_t size) {
+  static const char* kWords[] = {
+    "the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ",
+    "restart ", "point ", "window ", "chunk ", "stream ", "parallel ",
+    "decoder ", "encoder ", "\n", ", ", ". ", "0123 ", "brotli "
+  };
+  const size_t num_words = sizeof(kWords) / sizeof(kWords[0]);
+  uint8_t* data = (uint8_t*)malloc(size);
+  uint32_t seed = 12345;
+  size_t pos = 0;
+  if (!data) return NULL;
+  while (pos < size) {
+    const char* word;
+    size_t len;
+    seed = seed * 1103515245u + 12345u;
+    word = kWords[(seed >> 16) % num_words];
+    len = strlen(word);
+    if (len > size - pos) len = size - pos;
+    memcpy(data + pos, word, len);
+    pos += len;
+  }
+  return data;
+}
+
+typedef struct Encoded {
+  uint8_t* data;
+  size_t size;
+} Encoded;
+
+/* Compresses |input|; if |flush_step| is not 0, input is fed in pieces of
+   that size, each followed by BROTLI_OPERATION_FLUSH. */
+static BROTLI_BOOL Encode(const uint8_t* input, size_t input_size,
+    int quality, int lgwin, int num_threads, BROTLI_BOOL restart_points,
+    size_t flush_step, BrotliEncoderPreparedDictionary* dictionary,
+    Encoded* out) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t capacity = BrotliEncoderMaxCompressedSize(input_size) +
+      (input_size / FLUSH_STEP + 1) * 64 + 1024;
+  size_t available_out = capacity;
+  uint8_t* next_out;
+  size_t consumed = 0;
+  BROTLI_BOOL result = BROTLI_TRUE;
+  out->data = (uint8_t*)malloc(capacity);
+  out->size = 0;
+  if (!s || !out->data) {
+    BrotliEncoderDestroyInstance(s);
+    return BROTLI_FALSE;
+  }
+  next_out = out->data;
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)quality);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)lgwin);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_NUM_THREADS,
+                            (uint32_t)num_threads);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_RESTART_POINTS,
+                            restart_points ? 1u : 0u);
+  if (dictionary) {
+    result = BrotliEncoderAttachPreparedDictionary(s, dictionary);
+  }
+  while (result) {
+    size_t step = flush_step ? flush_step : input_size;
+    size_t available_in =
+        step < input_size - consumed ? step : input_size - consumed;
+    const uint8_t* next_in = input + consumed;
+    BROTLI_BOOL is_last = consumed + available_in == input_size ?
+        BROTLI_TRUE : BROTLI_FALSE;
+    BrotliEncoderOperation op =
+        is_last ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH;
+    while (result) {
+      result = BrotliEncoderCompressStream(
+          s, op, &available_in, &next_in, &available_out, &next_out, NULL);
+      if (is_last ? BrotliEncoderIsFinished(s) :
+          (available_in == 0 && !BrotliEncoderHasMoreOutput(s))) {
+        break;
+      }
+      if (available_out == 0) result = BROTLI_FALSE;
+    }
+    consumed = (size_t)(next_in - input);
+    if (is_last) break;
+  }
+  out->size = capacity - available_out;
+  BrotliEncoderDestroyInstance(s);
+  return result;
+}
+
+/* Counts the frames that start a restart point. Stream is not parsed; the
+   magic number is unlikely to appear in compressed data by chance. */
+static size_t CountRestartPoints(const Encoded* encoded) {
+  size_t count = 0;
+  size_t i;
+  for (i = 0; i + 5 <= encoded->size; ++i) {
+    const uint8_t* p = encoded->data + i;
+    uint32_t magic = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+        ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    if (magic == BROTLI_FRAME_MAGIC && (p[4] & BROTLI_FRAME_FLAG_RESTART)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/* Decodes |encoded| with the regular and the parallel decoder and compares
+   both outputs with |input|. */
+static void CheckDecoders(const uint8_t* input, size_t input_size,
+    const Encoded* encoded, BROTLI_BOOL framed, uint8_t* output) {
+  size_t decoded_size = 0;
+  BROTLI_BOOL has_size = BrotliDecoderGetDecodedSize(
+      encoded->size, encoded->data, &decoded_size);
+  CHECK(has_size == framed);
+  if (framed) CHECK(decoded_size == input_size);
+
+  decoded_size = input_size;
+  memset(output, 0, input_size);
+  CHECK(BrotliDecoderDecompress(encoded->size, encoded->data, &decoded_size,
+      output) == BROTLI_DECODER_RESULT_SUCCESS);
+  CHECK(decoded_size == input_size);
+  CHECK(memcmp(output, input, input_size) == 0);
+
+  decoded_size = input_size;
+  memset(output, 0, input_size);
+  CHECK(BrotliDecoderDecompressParallel(encoded->size, encoded->data,
+      &decoded_size, output, NUM_THREADS) == BROTLI_DECODER_RESULT_SUCCESS);
+  CHECK(decoded_size == input_size);
+  CHECK(memcmp(output, input, input_size) == 0);
+
+  /* Output buffer that is too small is an error, not a partial result. */
+  decoded_size = input_size - 1;
+  CHECK(BrotliDecoderDecompressParallel(encoded->size, encoded->data,
+      &decoded_size, output, NUM_THREADS) != BROTLI_DECODER_RESULT_SUCCESS);
+}
+
+static void TestRoundtrip(const uint8_t* input, uint8_t* output, int quality,
+                          int lgwin, size_t flush_step) {
+  Encoded baseline;
+  Encoded threaded;
+  Encoded restart;
+  size_t max_restarts = INPUT_SIZE / ((size_t)4 << 20) + 1;
+  size_t num_restarts;
+  CHECK(Encode(input, INPUT_SIZE, quality, lgwin, 1, BROTLI_FALSE,
+               flush_step, NULL, &baseline));
+  CHECK(Encode(input, INPUT_SIZE, quality, lgwin, NUM_THREADS, BROTLI_FALSE,
+               flush_step, NULL, &threaded));
+  CHECK(Encode(input, INPUT_SIZE, quality, lgwin, NUM_THREADS, BROTLI_TRUE,
+               flush_step, NULL, &restart));
+
+  CheckDecoders(input, INPUT_SIZE, &baseline, BROTLI_FALSE, output);
+  CheckDecoders(input, INPUT_SIZE, &threaded, BROTLI_FALSE, output);
+  CheckDecoders(input, INPUT_SIZE, &restart, BROTLI_TRUE, output);
+
+  /* Flushes do not add restart points. */
+  num_restarts = CountRestartPoints(&restart);
+  CHECK(num_restarts >= 2);
+  CHECK(num_restarts <= max_restarts);
+  CHECK(CountRestartPoints(&baseline) == 0);
+  CHECK(CountRestartPoints(&threaded) == 0);
+
+  free(baseline.data);
+  free(threaded.data);
+  free(restart.data);
+}
+
+/* Parallel decoder has no way to get the dictionary; it must fail instead of
+   producing garbage. */
+static void TestDictionary(const uint8_t* input, uint8_t* output) {
+  const size_t dictionary_size = 32768;
+  const uint8_t* dictionary_data = input + INPUT_SIZE - dictionary_size;
+  BrotliEncoderPreparedDictionary* dictionary =
+      BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW,
+          dictionary_size, dictionary_data, BROTLI_MAX_QUALITY,
+          NULL, NULL, NULL);
+  BrotliDecoderState* s;
+  Encoded encoded;
+  size_t decoded_size = INPUT_SIZE;
+  size_t available_in;
+  const uint8_t* next_in;
+  size_t available_out = INPUT_SIZE;
+  uint8_t* next_out = output;
+  size_t framed_size = 0;
+  CHECK(dictionary != NULL);
+  CHECK(Encode(input, INPUT_SIZE, 5, 18, NUM_THREADS, BROTLI_TRUE,
+               0, dictionary, &encoded));
+  BrotliEncoderDestroyPreparedDictionary(dictionary);
+
+  CHECK(BrotliDecoderGetDecodedSize(encoded.size, encoded.data,
+                                    &framed_size));
+  CHECK(framed_size == INPUT_SIZE);
+  CHECK(BrotliDecoderDecompressParallel(encoded.size, encoded.data,
+      &decoded_size, output, NUM_THREADS) == BROTLI_DECODER_RESULT_ERROR);
+  CHECK(decoded_size == 0);
+
+  /* Regular decoder with the dictionary attached gets the input back. */
+  s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  CHECK(s != NULL);
+  CHECK(BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+                                      dictionary_size, dictionary_data));
+  available_in = encoded.size;
+  next_in = encoded.data;
+  memset(output, 0, INPUT_SIZE);
+  CHECK(BrotliDecoderDecompressStream(s, &available_in, &next_in,
+      &available_out, &next_out, NULL) == BROTLI_DECODER_RESULT_SUCCESS);
+  BrotliDecoderDestroyInstance(s);
+  CHECK(available_out == 0);
+  CHECK(memcmp(output, input, INPUT_SIZE) == 0);
+  free(encoded.data);
+}
+
+int main(void) {
+  static const int kQualities[] = {2, 5, 9};
+  uint8_t* input = MakeInput(INPUT_SIZE);
+  uint8_t* output = (uint8_t*)malloc(INPUT_SIZE);
+  size_t i;
+  if (!input || !output) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  for (i = 0; i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    test_name = "single flush";
+    TestRoundtrip(input, output, kQualities[i], 18, 0);
+  }
+  test_name = "frequent flushes";
+  TestRoundtrip(input, output, 5, 18, FLUSH_STEP);
+  test_name = "frequent flushes, small window";
+  TestRoundtrip(input, output, 2, 16, FLUSH_STEP);
+  test_name = "custom dictionary";
+  TestDictionary(input, output);
+  free(input);
+  free(output);
+  if (failures) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+set(ENV{QEMU_LD_PREFIX} "${BROTLI_WRAPPER_LD_PREFIX}")
+
+# Input spans several 4MiB chunks (--lgwin up to 20), so that every chunk but
+# the first is primed with the tail of the preceding one.
+file(GLOB sources "${SOURCE_DIR}/c/enc/*.c" "${SOURCE_DIR}/c/dec/*.c")
+set(corpus "")
+foreach(source ${sources})
+  file(READ "${source}" contents)
+  string(APPEND corpus "${contents}")
+endforeach()
+set(INPUT "${OUTPUT}.in")
+file(WRITE "${INPUT}" "")
+file(SIZE "${INPUT}" size)
+while(size LESS 9437184)
+  file(APPEND "${INPUT}" "${corpus}")
+  file(SIZE "${INPUT}" size)
+endwhile()
+
+set(dictionary_args)
+if(DICTIONARY)
+  set(dictionary_args --dictionary=${DICTIONARY})
+endif()
+
+execute_process(
+  WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --quality=${QUALITY} --lgwin=${LGWIN} --jobs=4 ${dictionary_args} ${INPUT} --output=${OUTPUT}.br
+  RESULT_VARIABLE result
+  ERROR_VARIABLE result_stderr)
+if(result)
+  message(FATAL_ERROR "Compression failed: ${result_stderr}")
+endif()
+
+execute_process(
+  WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --decompress ${dictionary_args} ${OUTPUT}.br --output=${OUTPUT}.unbr
+  RESULT_VARIABLE result)
+if(result)
+  message(FATAL_ERROR "Decompression failed")
+endif()
+
+file(SHA512 "${INPUT}" input_cs)
+file(SHA512 "${OUTPUT}.unbr" output_cs)
+if(NOT "${input_cs}" STREQUAL "${output_cs}")
+  message(FATAL_ERROR "Files do not match")
+endif()
+file(REMOVE "${INPUT}" "${OUTPUT}.br" "${OUTPUT}.unbr")
@@ -0,0 +1,54 @@
+set(ENV{QEMU_LD_PREFIX} "${BROTLI_WRAPPER_LD_PREFIX}")
+
+# Trains a dictionary on the encoder headers, then round-trips INPUT with the
+# trained dictionary and a second, raw one attached.
+file(GLOB samples "${SOURCE_DIR}/c/enc/*.h")
+set(DICTIONARY "${OUTPUT}.dict")
+
+execute_process(
+  WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --train --dictionary-size=16k ${samples} --output=${DICTIONARY}
+  RESULT_VARIABLE result
+  ERROR_VARIABLE result_stderr)
+if(result)
+  message(FATAL_ERROR "Training failed: ${result_stderr}")
+endif()
+file(SIZE "${DICTIONARY}" dictionary_size)
+if(dictionary_size EQUAL 0 OR dictionary_size GREATER 16384)
+  message(FATAL_ERROR "Unexpected dictionary size: ${dictionary_size}")
+endif()
+
+set(dictionary_args --dictionary=${DICTIONARY} --dictionary=${SECOND_DICTIONARY})
+
+execute_process(
+  WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --quality=${QUALITY} ${dictionary_args} ${INPUT} --output=${OUTPUT}.br
+  RESULT_VARIABLE result
+  ERROR_VARIABLE result_stderr)
+if(result)
+  message(FATAL_ERROR "Compression failed: ${result_stderr}")
+endif()
+
+execute_process(
+  WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --decompress ${dictionary_args} ${OUTPUT}.br --output=${OUTPUT}.unbr
+  RESULT_VARIABLE result)
+if(result)
+  message(FATAL_ERROR "Decompression failed")
+endif()
+
+file(SHA512 "${INPUT}" input_cs)
+file(SHA512 "${OUTPUT}.unbr" output_cs)
+if(NOT "${input_cs}" STREQUAL "${output_cs}")
+  message(FATAL_ERROR "Files do not match")
+endif()
+
+# Stream refers to the dictionaries, so it does not decode without them.
+execute_process(
+  WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --test ${OUTPUT}.br
+  RESULT_VARIABLE result
+  ERROR_QUIET)
+if(NOT result)
+  message(FATAL_ERROR "Stream decoded without dictionaries")
+endif()
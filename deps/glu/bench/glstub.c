@@ -0,0 +1,303 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <string.h>
+#include <GL/gl.h>
+#include "glstub.h"
+
+GLStubCounters glStub;
+
+void glStubReset(void)
+{
+    memset(&glStub, 0, sizeof(glStub));
+}
+
+#define CALL()		(glStub.calls++)
+#define VERTEX(x)	(glStub.calls++, glStub.vertices++, glStub.sum += (x))
+
+static const GLfloat identity[16] = {
+    1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1,
+};
+
+/*
+** State queries.  Pixel storage is at its defaults, the viewport is
+** 1024x1024, both matrices are the identity, and every texture fits.
+*/
+GLAPI void GLAPIENTRY glGetIntegerv(GLenum pname, GLint *params)
+{
+    CALL();
+    switch (pname) {
+      case GL_UNPACK_ALIGNMENT:
+      case GL_PACK_ALIGNMENT:
+	params[0] = 4;
+	break;
+      case GL_MAX_TEXTURE_SIZE:
+	params[0] = 8192;
+	break;
+      case GL_VIEWPORT:
+	params[0] = 0;
+	params[1] = 0;
+	params[2] = 1024;
+	params[3] = 1024;
+	break;
+      case GL_POLYGON_MODE:
+	params[0] = GL_FILL;
+	params[1] = GL_FILL;
+	break;
+      default:
+	params[0] = 0;
+	break;
+    }
+}
+
+GLAPI void GLAPIENTRY glGetFloatv(GLenum pname, GLfloat *params)
+{
+    CALL();
+    switch (pname) {
+      case GL_MODELVIEW_MATRIX:
+      case GL_PROJECTION_MATRIX:
+	memcpy(params, identity, sizeof(identity));
+	break;
+      default:
+	params[0] = 0;
+	break;
+    }
+}
+
+GLAPI void GLAPIENTRY glGetTexLevelParameteriv(GLenum target, GLint level,
+					       GLenum pname, GLint *params)
+{
+    CALL();
+    (void) target;
+    (void) level;
+    (void) pname;
+    params[0] = 1;
+}
+
+GLAPI const GLubyte * GLAPIENTRY glGetString(GLenum name)
+{
+    CALL();
+    return (const GLubyte *) (name == GL_VERSION ? "1.4 glu-bench" : "");
+}
+
+GLAPI GLboolean GLAPIENTRY glIsEnabled(GLenum cap)
+{
+    CALL();
+    (void) cap;
+    return GL_FALSE;
+}
+
+/* State changes */
+GLAPI void GLAPIENTRY glEnable(GLenum cap) { CALL(); (void) cap; }
+GLAPI void GLAPIENTRY glDisable(GLenum cap) { CALL(); (void) cap; }
+GLAPI void GLAPIENTRY glPushAttrib(GLbitfield mask) { CALL(); (void) mask; }
+GLAPI void GLAPIENTRY glPopAttrib(void) { CALL(); }
+GLAPI void GLAPIENTRY glPushClientAttrib(GLbitfield mask)
+{
+    CALL();
+    (void) mask;
+}
+GLAPI void GLAPIENTRY glPopClientAttrib(void) { CALL(); }
+GLAPI void GLAPIENTRY glDisableClientState(GLenum cap) { CALL(); (void) cap; }
+GLAPI void GLAPIENTRY glPixelStorei(GLenum pname, GLint param)
+{
+    CALL();
+    (void) pname;
+    (void) param;
+}
+GLAPI void GLAPIENTRY glPolygonMode(GLenum face, GLenum mode)
+{
+    CALL();
+    (void) face;
+    (void) mode;
+}
+
+/* Matrices */
+GLAPI void GLAPIENTRY glOrtho(GLdouble left, GLdouble right,
+			      GLdouble bottom, GLdouble top,
+			      GLdouble near_val, GLdouble far_val)
+{
+    CALL();
+    glStub.sum += left + right + bottom + top + near_val + far_val;
+}
+GLAPI void GLAPIENTRY glMultMatrixd(const GLdouble *m)
+{
+    CALL();
+    glStub.sum += m[0];
+}
+GLAPI void GLAPIENTRY glMultMatrixf(const GLfloat *m)
+{
+    CALL();
+    glStub.sum += m[0];
+}
+GLAPI void GLAPIENTRY glTranslated(GLdouble x, GLdouble y, GLdouble z)
+{
+    CALL();
+    glStub.sum += x + y + z;
+}
+GLAPI void GLAPIENTRY glTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{
+    CALL();
+    glStub.sum += x + y + z;
+}
+GLAPI void GLAPIENTRY glScalef(GLfloat x, GLfloat y, GLfloat z)
+{
+    CALL();
+    glStub.sum += x + y + z;
+}
+
+/* Immediate mode */
+GLAPI void GLAPIENTRY glBegin(GLenum mode) { CALL(); (void) mode; }
+GLAPI void GLAPIENTRY glEnd(void) { CALL(); }
+GLAPI void GLAPIENTRY glVertex2f(GLfloat x, GLfloat y) { VERTEX(x + y); }
+GLAPI void GLAPIENTRY glVertex2fv(const GLfloat *v) { VERTEX(v[0] + v[1]); }
+GLAPI void GLAPIENTRY glVertex3f(GLfloat x, GLfloat y, GLfloat z)
+{
+    VERTEX(x + y + z);
+}
+GLAPI void GLAPIENTRY glVertex3fv(const GLfloat *v)
+{
+    VERTEX(v[0] + v[1] + v[2]);
+}
+GLAPI void GLAPIENTRY glNormal3f(GLfloat nx, GLfloat ny, GLfloat nz)
+{
+    CALL();
+    glStub.sum += nx + ny + nz;
+}
+GLAPI void GLAPIENTRY glNormal3fv(const GLfloat *v)
+{
+    CALL();
+    glStub.sum += v[0] + v[1] + v[2];
+}
+GLAPI void GLAPIENTRY glTexCoord2f(GLfloat s, GLfloat t)
+{
+    CALL();
+    glStub.sum += s + t;
+}
+GLAPI void GLAPIENTRY glTexCoord2fv(const GLfloat *v)
+{
+    CALL();
+    glStub.sum += v[0] + v[1];
+}
+GLAPI void GLAPIENTRY glColor3f(GLfloat red, GLfloat green, GLfloat blue)
+{
+    CALL();
+    glStub.sum += red + green + blue;
+}
+
+/* Vertex arrays */
+GLAPI void GLAPIENTRY glInterleavedArrays(GLenum format, GLsizei stride,
+					  const GLvoid *pointer)
+{
+    CALL();
+    (void) format;
+    (void) stride;
+    (void) pointer;
+}
+
+GLAPI void GLAPIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    CALL();
+    (void) mode;
+    glStub.vertices += count;
+    glStub.sum += first;
+}
+
+/* Evaluators */
+GLAPI void GLAPIENTRY glMap1f(GLenum target, GLfloat u1, GLfloat u2,
+			      GLint stride, GLint order,
+			      const GLfloat *points)
+{
+    CALL();
+    (void) target;
+    (void) stride;
+    glStub.sum += u1 + u2 + order + points[0];
+}
+GLAPI void GLAPIENTRY glMap2f(GLenum target, GLfloat u1, GLfloat u2,
+			      GLint ustride, GLint uorder,
+			      GLfloat v1, GLfloat v2,
+			      GLint vstride, GLint vorder,
+			      const GLfloat *points)
+{
+    CALL();
+    (void) target;
+    (void) ustride;
+    (void) vstride;
+    glStub.sum += u1 + u2 + uorder + v1 + v2 + vorder + points[0];
+}
+GLAPI void GLAPIENTRY glMapGrid1f(GLint un, GLfloat u1, GLfloat u2)
+{
+    CALL();
+    glStub.sum += un + u1 + u2;
+}
+GLAPI void GLAPIENTRY glMapGrid2d(GLint un, GLdouble u1, GLdouble u2,
+				  GLint vn, GLdouble v1, GLdouble v2)
+{
+    CALL();
+    glStub.sum += un + u1 + u2 + vn + v1 + v2;
+}
+GLAPI void GLAPIENTRY glMapGrid2f(GLint un, GLfloat u1, GLfloat u2,
+				  GLint vn, GLfloat v1, GLfloat v2)
+{
+    CALL();
+    glStub.sum += un + u1 + u2 + vn + v1 + v2;
+}
+GLAPI void GLAPIENTRY glEvalCoord1f(GLfloat u) { VERTEX(u); }
+GLAPI void GLAPIENTRY glEvalCoord2f(GLfloat u, GLfloat v) { VERTEX(u + v); }
+GLAPI void GLAPIENTRY glEvalPoint1(GLint i) { VERTEX(i); }
+GLAPI void GLAPIENTRY glEvalPoint2(GLint i, GLint j) { VERTEX(i + j); }
+GLAPI void GLAPIENTRY glEvalMesh1(GLenum mode, GLint i1, GLint i2)
+{
+    CALL();
+    (void) mode;
+    glStub.vertices += i2 - i1 + 1;
+}
+GLAPI void GLAPIENTRY glEvalMesh2(GLenum mode, GLint i1, GLint i2,
+				  GLint j1, GLint j2)
+{
+    CALL();
+    (void) mode;
+    glStub.vertices += (unsigned long) (i2 - i1 + 1) * (j2 - j1 + 1);
+}
+
+/* Textures.  The first texel is read so the upload is not free. */
+GLAPI void GLAPIENTRY glTexImage1D(GLenum target, GLint level,
+				   GLint internalFormat, GLsizei width,
+				   GLint border, GLenum format, GLenum type,
+				   const GLvoid *pixels)
+{
+    CALL();
+    (void) target; (void) level; (void) internalFormat;
+    (void) border; (void) format; (void) type;
+    glStub.texels += width;
+    if (pixels) glStub.sum += *(const GLubyte *) pixels;
+}
+
+GLAPI void GLAPIENTRY glTexImage2D(GLenum target, GLint level,
+				   GLint internalFormat,
+				   GLsizei width, GLsizei height,
+				   GLint border, GLenum format, GLenum type,
+				   const GLvoid *pixels)
+{
+    CALL();
+    (void) target; (void) level; (void) internalFormat;
+    (void) border; (void) format; (void) type;
+    glStub.texels += (unsigned long) width * height;
+    if (pixels) glStub.sum += *(const GLubyte *) pixels;
+}
+
+GLAPI void GLAPIENTRY glTexImage3D(GLenum target, GLint level,
+				   GLint internalFormat,
+				   GLsizei width, GLsizei height,
+				   GLsizei depth, GLint border,
+				   GLenum format, GLenum type,
+				   const GLvoid *pixels)
+{
+    CALL();
+    (void) target; (void) level; (void) internalFormat;
+    (void) border; (void) format; (void) type;
+    glStub.texels += (unsigned long) width * height * depth;
+    if (pixels) glStub.sum += *(const GLubyte *) pixels;
+}
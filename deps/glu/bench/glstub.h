@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** A stand-in for the GL entry points libGLU calls.  Nothing is drawn;
+** the stub only counts what it is given, so glu-bench runs headless and
+** measures libGLU alone.
+*/
+
+#ifndef __glstub_h__
+#define __glstub_h__
+
+typedef struct {
+    unsigned long calls;	/* every GL entry point */
+    unsigned long vertices;	/* vertices, evaluator points, array elements */
+    unsigned long texels;	/* texels passed to glTexImage* */
+    double sum;			/* of all coordinates, so no work is dead */
+} GLStubCounters;
+
+extern GLStubCounters glStub;
+
+extern void glStubReset(void);
+
+#endif /* __glstub_h__ */
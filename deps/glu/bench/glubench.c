@@ -0,0 +1,602 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** glu-bench: times libGLU against the stub GL in glstub.c and writes the
+** results to stdout as JSON.
+**
+**   glu-bench [--min-time SECONDS] [--filter TEXT]
+**
+** Each case is run once to warm up, then repeatedly, doubling the count,
+** until one batch takes at least --min-time (0.1 s by default).  Only
+** cases whose group or name contains --filter are run.  Besides the time
+** per call, the GL calls, vertices and texels the stub saw per call are
+** reported, so a change in how much GLU emits shows up next to a change
+** in how long it takes.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include "glstub.h"
+
+#ifndef GL_UNSIGNED_SHORT_5_6_5
+#define GL_UNSIGNED_SHORT_5_6_5		0x8363
+#endif
+#ifndef GL_UNSIGNED_INT_8_8_8_8_REV
+#define GL_UNSIGNED_INT_8_8_8_8_REV	0x8367
+#endif
+
+#undef	PI
+#define PI	3.14159265358979323846
+
+static double minTime = 0.1;
+static const char *filter = NULL;
+static int numResults = 0;
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double) count.QuadPart / freq.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+/*
+** Runs fn(arg) until a batch takes minTime and prints one result.  params
+** is the body of a JSON object describing the case.
+*/
+static void runCase(const char *group, const char *name, const char *params,
+		    void (*fn)(void *, long), void *arg)
+{
+    long i, iterations;
+    double start, elapsed;
+
+    if (filter != NULL && strstr(group, filter) == NULL &&
+	    strstr(name, filter) == NULL) {
+	return;
+    }
+
+    fn(arg, 0);
+    for (iterations = 1; ; iterations *= 2) {
+	glStubReset();
+	start = now();
+	for (i = 0; i < iterations; i++) {
+	    fn(arg, i);
+	}
+	elapsed = now() - start;
+	if (elapsed >= minTime || iterations >= (1L << 30)) break;
+    }
+
+    printf("%s\n    {\"group\": \"%s\", \"name\": \"%s\", "
+	   "\"params\": {%s}, \"iterations\": %ld, \"ns_per_op\": %.1f, "
+	   "\"gl_calls_per_op\": %.1f, \"vertices_per_op\": %.1f, "
+	   "\"texels_per_op\": %.1f}",
+	   numResults ? "," : "", group, name, params, iterations,
+	   elapsed * 1e9 / iterations,
+	   (double) glStub.calls / iterations,
+	   (double) glStub.vertices / iterations,
+	   (double) glStub.texels / iterations);
+    numResults++;
+}
+
+/* xorshift32, so every run gets the same images */
+static unsigned int randomState = 2463534242u;
+
+static unsigned int nextRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+/*
+** Mipmaps and image scaling
+*/
+typedef struct {
+    GLenum format;
+    const char *formatName;
+    GLenum type;
+    const char *typeName;
+    int bytesPerPixel;
+} PixelFormat;
+
+static const PixelFormat pixelFormats[] = {
+    { GL_RGBA, "GL_RGBA", GL_UNSIGNED_BYTE, "GL_UNSIGNED_BYTE", 4 },
+    { GL_RGB, "GL_RGB", GL_UNSIGNED_BYTE, "GL_UNSIGNED_BYTE", 3 },
+    { GL_LUMINANCE, "GL_LUMINANCE", GL_UNSIGNED_BYTE, "GL_UNSIGNED_BYTE", 1 },
+    { GL_RGBA, "GL_RGBA", GL_UNSIGNED_SHORT, "GL_UNSIGNED_SHORT", 8 },
+    { GL_RGBA, "GL_RGBA", GL_FLOAT, "GL_FLOAT", 16 },
+    { GL_RGB, "GL_RGB", GL_UNSIGNED_SHORT_5_6_5, "GL_UNSIGNED_SHORT_5_6_5",
+      2 },
+    { GL_RGBA, "GL_RGBA", GL_UNSIGNED_INT_8_8_8_8_REV,
+      "GL_UNSIGNED_INT_8_8_8_8_REV", 4 },
+};
+
+#define NUM_PIXEL_FORMATS (sizeof(pixelFormats) / sizeof(pixelFormats[0]))
+
+typedef struct {
+    const PixelFormat *pf;
+    int width, height;
+    int outWidth, outHeight;
+    void *in, *out;
+} ImageCase;
+
+/*
+** Random pixels; floats are kept in 0..1.  Rows are padded to the
+** 4-byte pack and unpack alignment the stub reports.
+*/
+static void *makeImage(const PixelFormat *pf, int width, int height)
+{
+    size_t row = ((size_t) width * pf->bytesPerPixel + 3) & ~(size_t) 3;
+    size_t i, size = row * height;
+    unsigned char *data = malloc(size);
+
+    if (data == NULL) return NULL;
+    if (pf->type == GL_FLOAT) {
+	float *f = (float *) data;
+
+	for (i = 0; i < size / sizeof(float); i++) {
+	    f[i] = (nextRandom() & 0xffff) / 65535.0f;
+	}
+    } else {
+	for (i = 0; i < size; i++) {
+	    data[i] = (unsigned char) (nextRandom() >> 24);
+	}
+    }
+    return data;
+}
+
+static void buildMipmaps(void *arg, long iteration)
+{
+    ImageCase *c = arg;
+
+    (void) iteration;
+    gluBuild2DMipmaps(GL_TEXTURE_2D, c->pf->format, c->width, c->height,
+		      c->pf->format, c->pf->type, c->in);
+}
+
+static void scaleImage(void *arg, long iteration)
+{
+    ImageCase *c = arg;
+
+    (void) iteration;
+    gluScaleImage(c->pf->format, c->width, c->height, c->pf->type, c->in,
+		  c->outWidth, c->outHeight, c->pf->type, c->out);
+    glStub.sum += *(unsigned char *) c->out;
+}
+
+static void benchImages(void)
+{
+    static const int mipmapSizes[][2] = {
+	{ 64, 64 }, { 256, 256 }, { 1024, 1024 }, { 640, 480 },
+    };
+    static const int scaleSizes[][4] = {
+	{ 1024, 1024, 512, 512 },	/* halve */
+	{ 640, 480, 1024, 512 },	/* enlarge to a power of two */
+	{ 1000, 600, 333, 200 },	/* shrink by a non-integer factor */
+    };
+    char params[256];
+    unsigned f, s;
+
+    for (f = 0; f < NUM_PIXEL_FORMATS; f++) {
+	const PixelFormat *pf = &pixelFormats[f];
+
+	for (s = 0; s < sizeof(mipmapSizes) / sizeof(mipmapSizes[0]); s++) {
+	    ImageCase c;
+
+	    c.pf = pf;
+	    c.width = mipmapSizes[s][0];
+	    c.height = mipmapSizes[s][1];
+	    c.in = makeImage(pf, c.width, c.height);
+	    if (c.in == NULL) continue;
+	    snprintf(params, sizeof(params),
+		     "\"format\": \"%s\", \"type\": \"%s\", "
+		     "\"width\": %d, \"height\": %d",
+		     pf->formatName, pf->typeName, c.width, c.height);
+	    runCase("mipmap", "gluBuild2DMipmaps", params, buildMipmaps, &c);
+	    free(c.in);
+	}
+
+	for (s = 0; s < sizeof(scaleSizes) / sizeof(scaleSizes[0]); s++) {
+	    ImageCase c;
+
+	    c.pf = pf;
+	    c.width = scaleSizes[s][0];
+	    c.height = scaleSizes[s][1];
+	    c.outWidth = scaleSizes[s][2];
+	    c.outHeight = scaleSizes[s][3];
+	    c.in = makeImage(pf, c.width, c.height);
+	    c.out = makeImage(pf, c.outWidth, c.outHeight);
+	    if (c.in != NULL && c.out != NULL) {
+		snprintf(params, sizeof(params),
+			 "\"format\": \"%s\", \"type\": \"%s\", "
+			 "\"width\": %d, \"height\": %d, "
+			 "\"out_width\": %d, \"out_height\": %d",
+			 pf->formatName, pf->typeName, c.width, c.height,
+			 c.outWidth, c.outHeight);
+		runCase("scale", "gluScaleImage", params, scaleImage, &c);
+	    }
+	    free(c.in);
+	    free(c.out);
+	}
+    }
+}
+
+/*
+** Polygon tessellation.  Each polygon is a ring whose radius alternates
+** between 1.0 and 0.6 at every vertex, plus a circle with a quarter as
+** many vertices that cuts through the inner points of the ring, so every
+** winding rule gives a different result and the sweep has to split edges
+** at O(n) intersections.  Vertices made by the combine callback are kept
+** in blocks, since they have to stay put until the polygon is done.
+*/
+#define COMBINE_BLOCK	1024
+
+typedef struct CombineBlock {
+    struct CombineBlock *next;
+    int used;
+    GLdouble v[COMBINE_BLOCK][3];
+} CombineBlock;
+
+typedef struct {
+    GLUtesselator *tess;
+    int numVertices;
+    GLdouble *coords;		/* 3 per vertex, both contours */
+    CombineBlock *blocks;	/* reused by every polygon */
+    CombineBlock *current;
+} TessCase;
+
+static void GLAPIENTRY tessBegin(GLenum type)
+{
+    glStub.calls++;
+    glStub.sum += type;
+}
+
+static void GLAPIENTRY tessVertex(void *data)
+{
+    glStub.vertices++;
+    glStub.sum += ((GLdouble *) data)[0];
+}
+
+static void GLAPIENTRY tessEnd(void)
+{
+    glStub.calls++;
+}
+
+static void GLAPIENTRY tessCombine(GLdouble coords[3], void *data[4],
+				   GLfloat weight[4], void **outData,
+				   void *polygonData)
+{
+    TessCase *c = polygonData;
+    CombineBlock *b = c->current;
+    GLdouble *v;
+
+    (void) data;
+    (void) weight;
+    if (b == NULL || b->used == COMBINE_BLOCK) {
+	CombineBlock *next = b ? b->next : c->blocks;
+
+	if (next == NULL) {
+	    next = malloc(sizeof(CombineBlock));
+	    if (next == NULL) {
+		fprintf(stderr, "glu-bench: out of memory\n");
+		exit(1);
+	    }
+	    next->next = NULL;
+	    if (b) b->next = next; else c->blocks = next;
+	}
+	next->used = 0;
+	c->current = b = next;
+    }
+    v = b->v[b->used++];
+    v[0] = coords[0];
+    v[1] = coords[1];
+    v[2] = coords[2];
+    *outData = v;
+}
+
+static void tessellate(void *arg, long iteration)
+{
+    TessCase *c = arg;
+    int i, ring = c->numVertices, circle = c->numVertices / 4;
+
+    (void) iteration;
+    c->current = NULL;
+    gluTessBeginPolygon(c->tess, c);
+    gluTessBeginContour(c->tess);
+    for (i = 0; i < ring; i++) {
+	gluTessVertex(c->tess, c->coords + 3*i, c->coords + 3*i);
+    }
+    gluTessEndContour(c->tess);
+    gluTessBeginContour(c->tess);
+    for (i = ring; i < ring + circle; i++) {
+	gluTessVertex(c->tess, c->coords + 3*i, c->coords + 3*i);
+    }
+    gluTessEndContour(c->tess);
+    gluTessEndPolygon(c->tess);
+}
+
+static void benchTess(void)
+{
+    static const int sizes[] = { 16, 256, 1024, 4096 };
+    static const struct {
+	GLenum rule;
+	const char *name;
+    } rules[] = {
+	{ GLU_TESS_WINDING_ODD, "GLU_TESS_WINDING_ODD" },
+	{ GLU_TESS_WINDING_NONZERO, "GLU_TESS_WINDING_NONZERO" },
+	{ GLU_TESS_WINDING_POSITIVE, "GLU_TESS_WINDING_POSITIVE" },
+	{ GLU_TESS_WINDING_ABS_GEQ_TWO, "GLU_TESS_WINDING_ABS_GEQ_TWO" },
+    };
+    char params[256];
+    unsigned s, r;
+    int i;
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+	TessCase c;
+	int ring = sizes[s], circle = sizes[s] / 4;
+
+	memset(&c, 0, sizeof(c));
+	c.numVertices = ring;
+	c.coords = malloc((ring + circle) * 3 * sizeof(GLdouble));
+	c.tess = gluNewTess();
+	if (c.coords == NULL || c.tess == NULL) {
+	    free(c.coords);
+	    if (c.tess != NULL) gluDeleteTess(c.tess);
+	    continue;
+	}
+	for (i = 0; i < ring; i++) {
+	    double a = 2 * PI * i / ring, radius = (i & 1) ? 0.6 : 1.0;
+
+	    c.coords[3*i] = radius * cos(a);
+	    c.coords[3*i+1] = radius * sin(a);
+	    c.coords[3*i+2] = 0.0;
+	}
+	for (i = 0; i < circle; i++) {
+	    double a = 2 * PI * (i + 0.5) / circle;
+	    GLdouble *v = c.coords + 3 * (ring + i);
+
+	    v[0] = 0.3 + 0.5 * cos(a);
+	    v[1] = 0.5 * sin(a);
+	    v[2] = 0.0;
+	}
+
+	gluTessCallback(c.tess, GLU_TESS_BEGIN, (_GLUfuncptr) tessBegin);
+	gluTessCallback(c.tess, GLU_TESS_VERTEX, (_GLUfuncptr) tessVertex);
+	gluTessCallback(c.tess, GLU_TESS_END, (_GLUfuncptr) tessEnd);
+	gluTessCallback(c.tess, GLU_TESS_COMBINE_DATA,
+			(_GLUfuncptr) tessCombine);
+	gluTessNormal(c.tess, 0.0, 0.0, 1.0);
+
+	for (r = 0; r < sizeof(rules) / sizeof(rules[0]); r++) {
+	    gluTessProperty(c.tess, GLU_TESS_WINDING_RULE, rules[r].rule);
+	    snprintf(params, sizeof(params),
+		     "\"vertices\": %d, \"winding_rule\": \"%s\"",
+		     ring + circle, rules[r].name);
+	    runCase("tess", "gluTessEndPolygon", params, tessellate, &c);
+	}
+
+	gluDeleteTess(c.tess);
+	free(c.coords);
+	while (c.blocks != NULL) {
+	    CombineBlock *next = c.blocks->next;
+
+	    free(c.blocks);
+	    c.blocks = next;
+	}
+    }
+}
+
+/*
+** NURBS surface tessellation.  A bicubic 8x8 patch shaped like a ripple is
+** tessellated with GLU_NURBS_TESSELLATOR, so no GL evaluator is involved.
+** The sampling matrices map the patch to 1024x1024 pixels.
+*/
+#define NURBS_CONTROL	8
+#define NURBS_ORDER	4
+
+typedef struct {
+    GLUnurbs *nurb;
+    GLfloat knots[NURBS_CONTROL + NURBS_ORDER];
+    GLfloat control[NURBS_CONTROL][NURBS_CONTROL][3];
+} NurbsCase;
+
+static void GLAPIENTRY nurbsBegin(GLenum type)
+{
+    glStub.calls++;
+    glStub.sum += type;
+}
+
+static void GLAPIENTRY nurbsVertex(GLfloat *vertex)
+{
+    glStub.vertices++;
+    glStub.sum += vertex[0];
+}
+
+static void GLAPIENTRY nurbsNormal(GLfloat *normal)
+{
+    glStub.calls++;
+    glStub.sum += normal[2];
+}
+
+static void GLAPIENTRY nurbsEnd(void)
+{
+    glStub.calls++;
+}
+
+static void nurbsSurface(void *arg, long iteration)
+{
+    NurbsCase *c = arg;
+
+    (void) iteration;
+    gluBeginSurface(c->nurb);
+    gluNurbsSurface(c->nurb, NURBS_CONTROL + NURBS_ORDER, c->knots,
+		    NURBS_CONTROL + NURBS_ORDER, c->knots,
+		    NURBS_CONTROL * 3, 3, &c->control[0][0][0],
+		    NURBS_ORDER, NURBS_ORDER, GL_MAP2_VERTEX_3);
+    gluEndSurface(c->nurb);
+}
+
+static void benchNurbs(void)
+{
+    static const float tolerances[] = { 50.0f, 25.0f, 10.0f, 5.0f };
+    static const GLfloat identity[16] = {
+	1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1,
+    };
+    static const GLint viewport[4] = { 0, 0, 1024, 1024 };
+    char params[256];
+    NurbsCase c;
+    unsigned t;
+    int i, j;
+
+    for (i = 0; i < NURBS_CONTROL + NURBS_ORDER; i++) {
+	j = i - (NURBS_ORDER - 1);
+	if (j < 0) j = 0;
+	if (j > NURBS_CONTROL - NURBS_ORDER + 1) {
+	    j = NURBS_CONTROL - NURBS_ORDER + 1;
+	}
+	c.knots[i] = (GLfloat) j;
+    }
+    for (i = 0; i < NURBS_CONTROL; i++) {
+	for (j = 0; j < NURBS_CONTROL; j++) {
+	    GLfloat x = 2.0f * i / (NURBS_CONTROL - 1) - 1.0f;
+	    GLfloat y = 2.0f * j / (NURBS_CONTROL - 1) - 1.0f;
+
+	    c.control[i][j][0] = x;
+	    c.control[i][j][1] = y;
+	    c.control[i][j][2] = 0.25f * (GLfloat) sin(3.0 * (x*x + y*y));
+	}
+    }
+
+    c.nurb = gluNewNurbsRenderer();
+    if (c.nurb == NULL) return;
+    gluNurbsProperty(c.nurb, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+    gluNurbsProperty(c.nurb, GLU_AUTO_LOAD_MATRIX, GL_FALSE);
+    gluLoadSamplingMatrices(c.nurb, identity, identity, viewport);
+    gluNurbsCallback(c.nurb, GLU_NURBS_BEGIN, (_GLUfuncptr) nurbsBegin);
+    gluNurbsCallback(c.nurb, GLU_NURBS_VERTEX, (_GLUfuncptr) nurbsVertex);
+    gluNurbsCallback(c.nurb, GLU_NURBS_NORMAL, (_GLUfuncptr) nurbsNormal);
+    gluNurbsCallback(c.nurb, GLU_NURBS_END, (_GLUfuncptr) nurbsEnd);
+
+    for (t = 0; t < sizeof(tolerances) / sizeof(tolerances[0]); t++) {
+	gluNurbsProperty(c.nurb, GLU_SAMPLING_TOLERANCE, tolerances[t]);
+	snprintf(params, sizeof(params),
+		 "\"control_points\": %d, \"order\": %d, "
+		 "\"sampling_tolerance\": %g",
+		 NURBS_CONTROL * NURBS_CONTROL, NURBS_ORDER, tolerances[t]);
+	runCase("nurbs", "gluNurbsSurface", params, nurbsSurface, &c);
+    }
+    gluDeleteNurbsRenderer(c.nurb);
+}
+
+/*
+** Quadrics, with smooth normals and texture coordinates.  "repeat" draws
+** the same shape every time, "varying" changes the radius on every call
+** so the shape is always generated from scratch.
+*/
+enum { QUAD_SPHERE, QUAD_CYLINDER, QUAD_DISK };
+
+typedef struct {
+    GLUquadric *quad;
+    int shape;
+    int slices;
+    int vary;
+    long calls;
+} QuadCase;
+
+static void drawQuadric(void *arg, long iteration)
+{
+    QuadCase *c = arg;
+    GLdouble r = c->vary ? 1.0 + (c->calls++ % 1024) * 1e-3 : 1.0;
+
+    (void) iteration;
+    switch (c->shape) {
+      case QUAD_SPHERE:
+	gluSphere(c->quad, r, c->slices, c->slices);
+	break;
+      case QUAD_CYLINDER:
+	gluCylinder(c->quad, r, 0.5 * r, 2.0, c->slices, c->slices);
+	break;
+      case QUAD_DISK:
+	gluDisk(c->quad, 0.25 * r, r, c->slices, c->slices / 2);
+	break;
+    }
+}
+
+static void benchQuadrics(void)
+{
+    static const char *names[] = { "gluSphere", "gluCylinder", "gluDisk" };
+    static const int slices[] = { 16, 32, 64 };
+    char params[256];
+    QuadCase c;
+    unsigned s;
+
+    c.quad = gluNewQuadric();
+    if (c.quad == NULL) return;
+    c.calls = 0;
+    gluQuadricNormals(c.quad, GLU_SMOOTH);
+    gluQuadricTexture(c.quad, GL_TRUE);
+
+    for (c.shape = QUAD_SPHERE; c.shape <= QUAD_DISK; c.shape++) {
+	for (s = 0; s < sizeof(slices) / sizeof(slices[0]); s++) {
+	    c.slices = slices[s];
+	    for (c.vary = 0; c.vary <= 1; c.vary++) {
+		snprintf(params, sizeof(params),
+			 "\"slices\": %d, \"draw_style\": \"GLU_FILL\", "
+			 "\"calls\": \"%s\"",
+			 c.slices, c.vary ? "varying" : "repeat");
+		runCase("quadric", names[c.shape], params, drawQuadric, &c);
+	    }
+	}
+    }
+    gluDeleteQuadric(c.quad);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [--min-time SECONDS] [--filter TEXT]\n",
+	    argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+
+    for (i = 1; i < argc; i++) {
+	if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+	    minTime = atof(argv[++i]);
+	} else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+	    filter = argv[++i];
+	} else {
+	    usage(argv[0]);
+	}
+    }
+
+    printf("{\n  \"library\": \"glu\",\n  \"version\": \"%s\",\n"
+	   "  \"min_time_s\": %g,\n  \"results\": [",
+	   (const char *) gluGetString(GLU_VERSION), minTime);
+    benchImages();
+    benchTess();
+    benchNurbs();
+    benchQuadrics();
+    printf("\n  ]\n}\n");
+    return 0;
+}
@@ -66,6 +66,12 @@ extern "C" {
 /* Extensions */
 #define GLU_EXT_object_space_tess          1
 #define GLU_EXT_nurbs_tessellator          1
+#define GLU_EXT_tess_indexed_triangles     1
+#define GLU_EXT_tess_result_cache          1
+#define GLU_EXT_nurbs_retained             1
+#define GLU_EXT_nurbs_arena                1
+#define GLU_EXT_nurbs_threads              1
+#define GLU_EXT_project_array              1
 
 /* Boolean */
 #define GLU_FALSE                          0
@@ -119,6 +125,7 @@ extern "C" {
 #define GLU_NURBS_TEX_COORD_DATA_EXT       100174
 #define GLU_NURBS_END_DATA                 100175
 #define GLU_NURBS_END_DATA_EXT             100175
+#define GLU_NURBS_VERTEX_BUFFER_EXT        100176
 
 /* NurbsError */
 #define GLU_NURBS_ERROR1                   100251
@@ -174,6 +181,14 @@ extern "C" {
 #define GLU_NURBS_TESSELLATOR_EXT          100161
 #define GLU_NURBS_RENDERER                 100162
 #define GLU_NURBS_RENDERER_EXT             100162
+#define GLU_NURBS_RETAINED_EXT             100163
+#define GLU_NURBS_RETAINED_CACHE_SIZE_EXT  100218
+#define GLU_NURBS_RETAINED_CACHE_HITS_EXT  100219
+#define GLU_NURBS_RETAINED_CACHE_MISSES_EXT 100220
+#define GLU_NURBS_ARENA_SIZE_EXT           100221
+#define GLU_NURBS_ARENA_ALLOCATIONS_EXT    100222
+#define GLU_NURBS_THREADS_EXT              100223
+#define GLU_NURBS_ARENA_LIMIT_EXT          100224
 
 /* NurbsSampling */
 #define GLU_OBJECT_PARAMETRIC_ERROR        100208
@@ -223,6 +238,7 @@ extern "C" {
 #define GLU_TESS_ERROR_DATA                100109
 #define GLU_TESS_EDGE_FLAG_DATA            100110
 #define GLU_TESS_COMBINE_DATA              100111
+#define GLU_TESS_INDEXED_TRIANGLES_EXT     100113
 
 /* TessContour */
 #define GLU_CW                             100120
@@ -235,6 +251,9 @@ extern "C" {
 #define GLU_TESS_WINDING_RULE              100140
 #define GLU_TESS_BOUNDARY_ONLY             100141
 #define GLU_TESS_TOLERANCE                 100142
+#define GLU_TESS_RESULT_CACHE_SIZE_EXT     100143
+#define GLU_TESS_RESULT_CACHE_HITS_EXT     100144
+#define GLU_TESS_RESULT_CACHE_MISSES_EXT   100145
 
 /* TessError */
 #define GLU_TESS_ERROR1                    100151
@@ -323,6 +342,7 @@ GLAPI void GLAPIENTRY gluPartialDisk (GLUquadric* quad, GLdouble inner, GLdouble
 GLAPI void GLAPIENTRY gluPerspective (GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar);
 GLAPI void GLAPIENTRY gluPickMatrix (GLdouble x, GLdouble y, GLdouble delX, GLdouble delY, GLint *viewport);
 GLAPI GLint GLAPIENTRY gluProject (GLdouble objX, GLdouble objY, GLdouble objZ, const GLdouble *model, const GLdouble *proj, const GLint *view, GLdouble* winX, GLdouble* winY, GLdouble* winZ);
+GLAPI GLint GLAPIENTRY gluProjectvEXT (GLsizei count, const GLdouble *objCoords, const GLdouble *model, const GLdouble *proj, const GLint *view, GLdouble* winCoords);
 GLAPI void GLAPIENTRY gluPwlCurve (GLUnurbs* nurb, GLint count, GLfloat* data, GLint stride, GLenum type);
 GLAPI void GLAPIENTRY gluQuadricCallback (GLUquadric* quad, GLenum which, _GLUfuncptr CallBackFunc);
 GLAPI void GLAPIENTRY gluQuadricDrawStyle (GLUquadric* quad, GLenum draw);
@@ -341,6 +361,7 @@ GLAPI void GLAPIENTRY gluTessProperty (GLUtesselator* tess, GLenum which, GLdoub
 GLAPI void GLAPIENTRY gluTessVertex (GLUtesselator* tess, GLdouble *location, GLvoid* data);
 GLAPI GLint GLAPIENTRY gluUnProject (GLdouble winX, GLdouble winY, GLdouble winZ, const GLdouble *model, const GLdouble *proj, const GLint *view, GLdouble* objX, GLdouble* objY, GLdouble* objZ);
 GLAPI GLint GLAPIENTRY gluUnProject4 (GLdouble winX, GLdouble winY, GLdouble winZ, GLdouble clipW, const GLdouble *model, const GLdouble *proj, const GLint *view, GLdouble nearVal, GLdouble farVal, GLdouble* objX, GLdouble* objY, GLdouble* objZ, GLdouble* objW);
+GLAPI GLint GLAPIENTRY gluUnProjectvEXT (GLsizei count, const GLdouble *winCoords, const GLdouble *model, const GLdouble *proj, const GLint *view, GLdouble* objCoords);
 
 #ifdef __cplusplus
 }
@@ -42,6 +42,7 @@
 #include <GL/glu.h> /*for drawing bzier patch*/
 #include "bezierPatch.h"
 #include "bezierEval.h"
+#include "arena.h"
 
 /*
  *allocate an instance of bezierPatch. The control points are unknown. But
@@ -51,7 +52,7 @@
  */
 bezierPatch* bezierPatchMake(float umin, float vmin, float umax, float vmax, int uorder, int vorder, int dimension)
 {
-  bezierPatch* ret = (bezierPatch*) malloc(sizeof(bezierPatch));
+  bezierPatch* ret = (bezierPatch*) arenaMalloc(sizeof(bezierPatch));
   assert(ret);
   ret->umin = umin;
   ret->vmin = vmin;
@@ -60,7 +61,7 @@ bezierPatch* bezierPatchMake(float umin, float vmin, float umax, float vmax, int
   ret->uorder = uorder;
   ret->vorder = vorder;
   ret->dimension = dimension;
-  ret->ctlpoints = (float*) malloc(sizeof(float) * dimension * uorder * vorder);
+  ret->ctlpoints = (float*) arenaMalloc(sizeof(float) * dimension * uorder * vorder);
   assert(ret->ctlpoints);
 
   ret->next = NULL;
@@ -70,7 +71,7 @@ bezierPatch* bezierPatchMake(float umin, float vmin, float umax, float vmax, int
 
 bezierPatch* bezierPatchMake2(float umin, float vmin, float umax, float vmax, int uorder, int vorder, int dimension, int ustride, int vstride,  float* ctlpoints)
 {
-  bezierPatch* ret = (bezierPatch*) malloc(sizeof(bezierPatch));
+  bezierPatch* ret = (bezierPatch*) arenaMalloc(sizeof(bezierPatch));
   assert(ret);
   ret->umin = umin;
   ret->vmin = vmin;
@@ -79,7 +80,7 @@ bezierPatch* bezierPatchMake2(float umin, float vmin, float umax, float vmax, in
   ret->uorder = uorder;
   ret->vorder = vorder;
   ret->dimension = dimension;
-  ret->ctlpoints = (float*) malloc(sizeof(float) * dimension * uorder * vorder);
+  ret->ctlpoints = (float*) arenaMalloc(sizeof(float) * dimension * uorder * vorder);
   assert(ret->ctlpoints);
 
   /*copy the control points there*/
@@ -100,8 +101,8 @@ bezierPatch* bezierPatchMake2(float umin, float vmin, float umax, float vmax, in
  */
 void bezierPatchDelete(bezierPatch *b)
 {
-  free(b->ctlpoints);
-  free(b);
+  arenaFree(b->ctlpoints);
+  arenaFree(b);
 }
 
 /*delete the whole linked list
@@ -42,6 +42,7 @@
 #include <GL/gl.h>
 #include "bezierEval.h"
 #include "bezierPatchMesh.h"
+#include "arena.h"
 
 static int isDegenerate(float A[2], float B[2], float C[2]);
 
@@ -111,7 +112,7 @@ bezierPatchMesh *bezierPatchMeshMake(int maptype, float umin, float umax, int us
     return NULL;
   }
 
-  bezierPatchMesh *ret = (bezierPatchMesh*) malloc(sizeof(bezierPatchMesh));
+  bezierPatchMesh *ret = (bezierPatchMesh*) arenaMalloc(sizeof(bezierPatchMesh));
   assert(ret);
 
   ret->bpatch_normal = NULL;
@@ -130,11 +131,11 @@ bezierPatchMesh *bezierPatchMeshMake(int maptype, float umin, float umax, int us
 
   ret->size_UVarray = size_UVarray;
   ret->size_length_array = size_length_array;
-  ret->UVarray = (float*) malloc(sizeof(float) * size_UVarray);
+  ret->UVarray = (float*) arenaMalloc(sizeof(float) * size_UVarray);
   assert(ret->UVarray);
-  ret->length_array = (int *)malloc(sizeof(int) * size_length_array);
+  ret->length_array = (int *)arenaMalloc(sizeof(int) * size_length_array);
   assert(ret->length_array);
-  ret->type_array = (GLenum *)malloc(sizeof(GLenum) * size_length_array);
+  ret->type_array = (GLenum *)arenaMalloc(sizeof(GLenum) * size_length_array);
   assert(ret->type_array);
 
   ret->index_UVarray = 0;
@@ -151,7 +152,7 @@ bezierPatchMesh *bezierPatchMeshMake(int maptype, float umin, float umax, int us
 
 bezierPatchMesh *bezierPatchMeshMake2(int size_UVarray, int size_length_array)
 {
-  bezierPatchMesh *ret = (bezierPatchMesh*) malloc(sizeof(bezierPatchMesh));
+  bezierPatchMesh *ret = (bezierPatchMesh*) arenaMalloc(sizeof(bezierPatchMesh));
   assert(ret);
 
   ret->bpatch = NULL;
@@ -161,11 +162,11 @@ bezierPatchMesh *bezierPatchMeshMake2(int size_UVarray, int size_length_array)
 
   ret->size_UVarray = size_UVarray;
   ret->size_length_array = size_length_array;
-  ret->UVarray = (float*) malloc(sizeof(float) * size_UVarray);
+  ret->UVarray = (float*) arenaMalloc(sizeof(float) * size_UVarray);
   assert(ret->UVarray);
-  ret->length_array = (int *)malloc(sizeof(int) * size_length_array);
+  ret->length_array = (int *)arenaMalloc(sizeof(int) * size_length_array);
   assert(ret->length_array);
-  ret->type_array = (GLenum *)malloc(sizeof(GLenum) * size_length_array);
+  ret->type_array = (GLenum *)arenaMalloc(sizeof(GLenum) * size_length_array);
   assert(ret->type_array);
 
   ret->index_UVarray = 0;
@@ -231,12 +232,12 @@ void bezierPatchMeshDelete(bezierPatchMesh *bpm)
   if(bpm->bpatch_texcoord != NULL)
     bezierPatchDelete(bpm->bpatch_texcoord);
   
-  free(bpm->UVarray);
-  free(bpm->length_array);
-  free(bpm->vertex_array);
-  free(bpm->normal_array);
-  free(bpm->type_array);
-  free(bpm);
+  arenaFree(bpm->UVarray);
+  arenaFree(bpm->length_array);
+  arenaFree(bpm->vertex_array);
+  arenaFree(bpm->normal_array);
+  arenaFree(bpm->type_array);
+  arenaFree(bpm);
 }
  
 /*begin a strip
@@ -259,9 +260,9 @@ void bezierPatchMeshEndStrip(bezierPatchMesh *bpm)
   /*if the length_array is full, it should be expanded*/
   if(bpm->index_length_array >= bpm->size_length_array)
     {
-      int *temp = (int*) malloc(sizeof(int) * (bpm->size_length_array*2 + 1));
+      int *temp = (int*) arenaMalloc(sizeof(int) * (bpm->size_length_array*2 + 1));
       assert(temp);
-      GLenum *temp_type = (GLenum*) malloc(sizeof(GLenum) * (bpm->size_length_array*2 + 1));
+      GLenum *temp_type = (GLenum*) arenaMalloc(sizeof(GLenum) * (bpm->size_length_array*2 + 1));
       assert(temp_type);
       /*update the size*/
       bpm->size_length_array = bpm->size_length_array*2 + 1;
@@ -274,8 +275,8 @@ void bezierPatchMeshEndStrip(bezierPatchMesh *bpm)
 	}
       
       /*deallocate old array*/
-      free(bpm->length_array);
-      free(bpm->type_array);
+      arenaFree(bpm->length_array);
+      arenaFree(bpm->type_array);
       
       /*point to the new array which is twice as bigger*/
       bpm->length_array = temp;
@@ -293,7 +294,7 @@ void bezierPatchMeshInsertUV(bezierPatchMesh *bpm, float u, float v)
   /*if the UVarray is full, it should be expanded*/
   if(bpm->index_UVarray+1 >= bpm->size_UVarray)
     {
-      float *temp = (float*) malloc(sizeof(float) * (bpm->size_UVarray * 2 + 2));
+      float *temp = (float*) arenaMalloc(sizeof(float) * (bpm->size_UVarray * 2 + 2));
       assert(temp);
       
       /*update the size*/
@@ -306,7 +307,7 @@ void bezierPatchMeshInsertUV(bezierPatchMesh *bpm, float u, float v)
 	}
       
       /*deallocate old array*/
-      free(bpm->UVarray);
+      arenaFree(bpm->UVarray);
       
       /*pointing to the new arrays*/
       bpm->UVarray = temp;
@@ -434,11 +435,11 @@ void bezierPatchMeshDelDeg(bezierPatchMesh* bpm)
   float *new_UVarray;
   int index_new_UVarray;
 
-  new_length_array = (int*)malloc(sizeof(int) * bpm->index_length_array);
+  new_length_array = (int*)arenaMalloc(sizeof(int) * bpm->index_length_array);
   assert(new_length_array);
-  new_type_array = (GLenum*)malloc(sizeof(GLenum) * bpm->index_length_array);
+  new_type_array = (GLenum*)arenaMalloc(sizeof(GLenum) * bpm->index_length_array);
   assert(new_length_array);
-  new_UVarray = (float*) malloc(sizeof(float) * bpm->index_UVarray);
+  new_UVarray = (float*) arenaMalloc(sizeof(float) * bpm->index_UVarray);
   assert(new_UVarray);
 
   index_new_length_array = 0;
@@ -461,9 +462,9 @@ void bezierPatchMeshDelDeg(bezierPatchMesh* bpm)
 	k += 6;
       }
   }  
-  free(bpm->UVarray);
-  free(bpm->length_array);
-  free(bpm->type_array);
+  arenaFree(bpm->UVarray);
+  arenaFree(bpm->length_array);
+  arenaFree(bpm->type_array);
   bpm->UVarray=new_UVarray;
   bpm->length_array=new_length_array;
   bpm->type_array=new_type_array;
@@ -491,9 +492,9 @@ void bezierPatchMeshEval(bezierPatchMesh* bpm)
   int vstride = dimension;
   float *ctlpoints = bpm->bpatch->ctlpoints;
   
-  bpm->vertex_array = (float*) malloc(sizeof(float)* (bpm->index_UVarray/2) * 3);
+  bpm->vertex_array = (float*) arenaMalloc(sizeof(float)* (bpm->index_UVarray/2) * 3);
   assert(bpm->vertex_array);
-  bpm->normal_array = (float*) malloc(sizeof(float)* (bpm->index_UVarray/2) * 3);
+  bpm->normal_array = (float*) arenaMalloc(sizeof(float)* (bpm->index_UVarray/2) * 3);
   assert(bpm->normal_array);
 
   k=0;
@@ -93,6 +93,8 @@ surfcount++;
 tempTrim = OTL_make(10,10);
 #endif
     r->bgnsurface(0); 
+    if (r->is_retained())
+	r->retainedBgnsurface();
 }
 
 void GLAPIENTRY
@@ -124,7 +126,10 @@ OTN_write(otn, "out.otn");
 }
 #endif
 
-    r->endsurface(); 
+    if (r->is_retained())
+	r->retainedEndsurface();
+    else
+	r->endsurface(); 
 }
 
 void GLAPIENTRY
@@ -135,6 +140,8 @@ OTL_bgnTrim(tempTrim);
 #endif
 
     r->bgntrim(); 
+    if (r->is_retained())
+	r->retainedTrim(1);
 }
 
 void GLAPIENTRY
@@ -144,6 +151,8 @@ gluEndTrim(GLUnurbs *r)
 OTL_endTrim(tempTrim);
 #endif
     r->endtrim(); 
+    if (r->is_retained())
+	r->retainedTrim(0);
 }
 
 void GLAPIENTRY
@@ -167,6 +176,8 @@ OTL_pwlCurve(tempTrim, count, array, stride, type);
 	break;
     }
     r->pwlcurve(count, array, sizeof(INREAL) * stride, realType);
+    if (r->is_retained())
+	r->retainedPwlcurve(count, array, stride, type);
 }
 
 void GLAPIENTRY
@@ -193,6 +204,8 @@ OTL_nurbsCurve(tempTrim, nknots, knot, stride, ctlarray, order, type);
 
     r->nurbscurve(nknots, knot, sizeof(INREAL) * stride, ctlarray, order, 
 	    realType);
+    if (r->is_retained())
+	r->retainedNurbscurve(nknots, knot, stride, ctlarray, order, type);
 }
 
 void GLAPIENTRY
@@ -229,6 +242,9 @@ tempNurb = nurbSurfMake(sknot_count, sknot,
     r->nurbssurface(sknot_count, sknot, tknot_count, tknot, 
 	    sizeof(INREAL) * s_stride, sizeof(INREAL) * t_stride, 
 	    ctlarray, sorder, torder, type);
+    if (r->is_retained())
+	r->retainedNurbssurface(sknot_count, sknot, tknot_count, tknot,
+		s_stride, t_stride, ctlarray, sorder, torder, type);
 }
 
 void GLAPIENTRY
@@ -341,14 +357,46 @@ gluNurbsProperty(GLUnurbs *r, GLenum property, GLfloat value)
 	break;
 	
       case GLU_NURBS_MODE:
-	if(value == GLU_NURBS_RENDERER)
+	if(value == GLU_NURBS_RENDERER) {
+	  r->put_retainedFlag(0);
 	  r->put_callbackFlag(0);
-	else if(value == GLU_NURBS_TESSELLATOR)
+	}
+	else if(value == GLU_NURBS_TESSELLATOR) {
+	  r->put_retainedFlag(0);
 	  r->put_callbackFlag(1);
+	}
+	else if(value == GLU_NURBS_RETAINED_EXT)
+	  r->put_retainedFlag(1);
 	else
 	  r->postError(GLU_INVALID_ENUM);
 	break;
 
+      case GLU_NURBS_RETAINED_CACHE_SIZE_EXT:
+	if (value < 0.0) {
+	  r->postError(GLU_INVALID_VALUE);
+	  return;
+	}
+	r->retainedCache.setSize((long) value);
+	break;
+
+      case GLU_NURBS_THREADS_EXT:
+	if (value < 1.0) {
+	  r->postError(GLU_INVALID_VALUE);
+	  return;
+	}
+	if (value > IN_MAX_THREADS)
+	  value = IN_MAX_THREADS;
+	r->put_threads((int) value);
+	break;
+
+      case GLU_NURBS_ARENA_LIMIT_EXT:
+	if (value < 0.0) {
+	  r->postError(GLU_INVALID_VALUE);
+	  return;
+	}
+	r->arena.setLimit((size_t) value);
+	break;
+
       default:
 	r->postError(GLU_INVALID_ENUM);
 	return;	
@@ -414,11 +462,37 @@ gluGetNurbsProperty(GLUnurbs *r, GLenum property, GLfloat *value)
 	break;
 
       case GLU_NURBS_MODE:
-	if(r->is_callback())
+	if(r->is_retained())
+	  *value = GLU_NURBS_RETAINED_EXT;
+	else if(r->is_callback())
 	  *value = GLU_NURBS_TESSELLATOR;
 	else
 	  *value = GLU_NURBS_RENDERER;
 	break;
+
+      case GLU_NURBS_RETAINED_CACHE_SIZE_EXT:
+	*value = r->retainedCache.getSize();
+	break;
+      case GLU_NURBS_RETAINED_CACHE_HITS_EXT:
+	*value = r->retainedCache.hits;
+	break;
+      case GLU_NURBS_RETAINED_CACHE_MISSES_EXT:
+	*value = r->retainedCache.misses;
+	break;
+
+      case GLU_NURBS_ARENA_SIZE_EXT:
+	*value = r->arena.getSize();
+	break;
+      case GLU_NURBS_ARENA_ALLOCATIONS_EXT:
+	*value = r->arena.heapAllocations;
+	break;
+      case GLU_NURBS_ARENA_LIMIT_EXT:
+	*value = r->arena.getLimit();
+	break;
+
+      case GLU_NURBS_THREADS_EXT:
+	*value = r->get_threads();
+	break;
 	
       default:
 	r->postError(GLU_INVALID_ENUM);
@@ -448,6 +522,9 @@ gluNurbsCallback(GLUnurbs *r, GLenum which, _GLUfuncptr fn )
     case GLU_NURBS_ERROR:
 	r->errorCallback = (void (APIENTRY *)( GLenum e )) fn;
 	break;
+    case GLU_NURBS_VERTEX_BUFFER_EXT:
+	r->vertexBufferCallback = (vertexBufferCallbackType) fn;
+	break;
     default:
 	r->postError(GLU_INVALID_ENUM);
 	return;
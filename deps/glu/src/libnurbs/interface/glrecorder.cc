@@ -0,0 +1,154 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+/*
+ * glrecorder.c++
+ *
+ */
+
+#include "gluos.h"
+#include <stdlib.h>
+#include <string.h>
+#include "glrecorder.h"
+
+/* initial capacity, in ops and in values */
+#define RECORD_DEFAULT_SIZE 4096
+
+EvalRecorder::EvalRecorder( void )
+{
+    ops = NULL;
+    vals = NULL;
+    maxOps = 0;
+    maxVals = 0;
+    clear();
+}
+
+EvalRecorder::~EvalRecorder( void )
+{
+    free(ops);
+    free(vals);
+}
+
+/* the buffers are kept for the next surface */
+void
+EvalRecorder::clear( void )
+{
+    numOps = 0;
+    numVals = 0;
+    failed = 0;
+}
+
+int
+EvalRecorder::grow( long nops, long nvals )
+{
+    if( failed )
+	return 0;
+
+    if( numOps + nops > maxOps ) {
+	long n = maxOps ? 2 * maxOps : RECORD_DEFAULT_SIZE;
+	GLuint *p = (GLuint *) realloc(ops, n * sizeof(GLuint));
+	if( p == NULL ) {
+	    failed = 1;
+	    return 0;
+	}
+	ops = p;
+	maxOps = n;
+    }
+    if( numVals + nvals > maxVals ) {
+	long n = maxVals ? 2 * maxVals : RECORD_DEFAULT_SIZE;
+	GLfloat *p = (GLfloat *) realloc(vals, n * sizeof(GLfloat));
+	if( p == NULL ) {
+	    failed = 1;
+	    return 0;
+	}
+	vals = p;
+	maxVals = n;
+    }
+    return 1;
+}
+
+void
+EvalRecorder::begin( GLenum type )
+{
+    if( ! room(2, 0) )
+	return;
+    ops[numOps++] = RECORD_BEGIN;
+    ops[numOps++] = type;
+}
+
+void
+EvalRecorder::end( void )
+{
+    if( ! room(1, 0) )
+	return;
+    ops[numOps++] = RECORD_END;
+}
+
+void
+EvalRecorder::vertex( const GLfloat *v )
+{
+    if( ! room(1, 5) )
+	return;
+    ops[numOps++] = RECORD_VERTEX;
+    memcpy(vals + numVals, v, 5 * sizeof(GLfloat));
+    numVals += 5;
+}
+
+void
+EvalRecorder::normal( const GLfloat *n )
+{
+    if( ! room(1, 3) )
+	return;
+    ops[numOps++] = RECORD_NORMAL;
+    memcpy(vals + numVals, n, 3 * sizeof(GLfloat));
+    numVals += 3;
+}
+
+void
+EvalRecorder::color( const GLfloat *c )
+{
+    if( ! room(1, 4) )
+	return;
+    ops[numOps++] = RECORD_COLOR;
+    memcpy(vals + numVals, c, 4 * sizeof(GLfloat));
+    numVals += 4;
+}
+
+void
+EvalRecorder::texcoord( const GLfloat *t, int dim )
+{
+    if( ! room(2, 4) )
+	return;
+    ops[numOps++] = RECORD_TEXCOORD;
+    ops[numOps++] = dim;
+    memset(vals + numVals, 0, 4 * sizeof(GLfloat));
+    memcpy(vals + numVals, t, dim * sizeof(GLfloat));
+    numVals += 4;
+}
@@ -0,0 +1,91 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+/*
+ * glrecorder.h
+ *
+ * Output of OpenGLSurfaceEvaluator kept for later.  When the patches of a
+ * surface are evaluated on worker threads (GLU_NURBS_THREADS_EXT), each
+ * worker writes the begin/vertex/normal/color/texcoord/end calls it would
+ * have made into an EvalRecorder; the calling thread replays them to the
+ * client's callbacks in patch order.
+ */
+
+#ifndef __gluglrecorder_h_
+#define __gluglrecorder_h_
+
+#include <GL/gl.h>
+#include <GL/glu.h>
+
+/* operations stored in EvalRecorder::ops */
+#define RECORD_BEGIN	0	/* followed by the primitive type */
+#define RECORD_END	1
+#define RECORD_VERTEX	2	/* 5 values: x y z u v */
+#define RECORD_NORMAL	3	/* 3 values */
+#define RECORD_COLOR	4	/* 4 values */
+#define RECORD_TEXCOORD	5	/* followed by the dimension; 4 values */
+
+class EvalRecorder {
+public:
+			EvalRecorder( void );
+			~EvalRecorder( void );
+
+    void		clear( void );
+    void		begin( GLenum );
+    void		end( void );
+    void		vertex( const GLfloat * );
+    void		normal( const GLfloat * );
+    void		color( const GLfloat * );
+    void		texcoord( const GLfloat *, int );
+
+    int			failed;		/* ran out of memory */
+
+    GLuint		*ops;
+    long		numOps;
+    GLfloat		*vals;
+    long		numVals;
+
+private:
+    inline int		room( long, long );
+    int			grow( long, long );
+
+    long		maxOps;
+    long		maxVals;
+};
+
+inline int
+EvalRecorder::room( long nops, long nvals )
+{
+    if( numOps + nops <= maxOps && numVals + nvals <= maxVals )
+	return 1;
+    return grow( nops, nvals );
+}
+
+#endif /* __gluglrecorder_h_ */
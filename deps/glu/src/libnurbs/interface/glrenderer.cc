@@ -36,8 +36,10 @@
 */
 
 #include "gluos.h"
+#include <string.h>
 #include "glimports.h"
 #include "glrenderer.h"
+#include "nurbsconsts.h"
 
 GLUnurbs::GLUnurbs()
 	: NurbsTessellator(curveEvaluator, surfaceEvaluator)
@@ -101,6 +103,14 @@ GLUnurbs::GLUnurbs()
     callbackFlag = 0;
 
     errorCallback = NULL;
+
+    retainedFlag = 0;
+    retainedError = 0;
+    vertexBufferCallback = NULL;
+    callbackUserData = NULL;
+    for (int i = 0; i < 4; i++)
+	for (int j = 0; j < 4; j++)
+	    samplingMatrix[i][j] = (i == j) ? 1.0 : 0.0;
 }
 
 void
@@ -122,6 +132,7 @@ GLUnurbs::errorHandler(int i)
     int gluError;
 
     gluError = i + (GLU_NURBS_ERROR1 - 1);
+    retainedError = 1;
     postError( gluError );
 }
 
@@ -179,6 +190,8 @@ GLUnurbs::setSamplingMatrixIdentity( void )
   const long rstride = sizeof(smat[0]) / sizeof(smat[0][0]);
   const long cstride = 1;
 
+  memcpy(samplingMatrix, smat, sizeof(samplingMatrix));
+
   setnurbsproperty(GL_MAP1_VERTEX_3, N_SAMPLINGMATRIX, &smat[0][0], rstride,
 		   cstride);
   setnurbsproperty(GL_MAP1_VERTEX_4, N_SAMPLINGMATRIX, &smat[0][0], rstride,
@@ -223,6 +236,8 @@ GLUnurbs::loadSamplingMatrix(const GLfloat vmat[4][4],
     const long rstride = sizeof(smat[0]) / sizeof(smat[0][0]);
     const long cstride = 1;
 
+    memcpy(samplingMatrix, smat, sizeof(samplingMatrix));
+
     setnurbsproperty(GL_MAP1_VERTEX_3, N_SAMPLINGMATRIX, &smat[0][0], rstride,
 	    cstride);
     setnurbsproperty(GL_MAP1_VERTEX_4, N_SAMPLINGMATRIX, &smat[0][0], rstride,
@@ -299,3 +314,180 @@ GLUnurbs::multmatrix4d (GLfloat n[4][4], const GLfloat left[4][4],
     transform4d ((GLfloat *) n[2],(GLfloat *) left[2],(GLfloat (*)[4]) right);
     transform4d ((GLfloat *) n[3],(GLfloat *) left[3],(GLfloat (*)[4]) right);
 }
+
+/*---------------------------------------------------------------------
+ * GLU_NURBS_RETAINED_EXT
+ *
+ * While a surface is defined, its description is copied into the key of
+ * retainedCache.  At gluEndSurface the key is completed with the
+ * sampling properties; if a result for it is kept, the surface is
+ * discarded without tessellation and the kept buffers are passed on.
+ *---------------------------------------------------------------------
+ */
+
+/* tags for the parts of a key */
+enum { RETAINED_SURFACE = 1, RETAINED_CURVE, RETAINED_PWLCURVE,
+       RETAINED_BGNTRIM, RETAINED_ENDTRIM, RETAINED_PROPERTIES };
+
+static int
+retainedDimension(GLenum type)
+{
+    switch (type) {
+      case GL_MAP2_INDEX:
+      case GL_MAP1_INDEX:
+      case GL_MAP2_TEXTURE_COORD_1:
+      case GL_MAP1_TEXTURE_COORD_1:
+	return 1;
+      case GL_MAP2_TEXTURE_COORD_2:
+      case GL_MAP1_TEXTURE_COORD_2:
+      case GLU_MAP1_TRIM_2:
+	return 2;
+      case GL_MAP2_VERTEX_3:
+      case GL_MAP1_VERTEX_3:
+      case GL_MAP2_NORMAL:
+      case GL_MAP1_NORMAL:
+      case GL_MAP2_TEXTURE_COORD_3:
+      case GL_MAP1_TEXTURE_COORD_3:
+      case GLU_MAP1_TRIM_3:
+	return 3;
+      case GL_MAP2_VERTEX_4:
+      case GL_MAP1_VERTEX_4:
+      case GL_MAP2_TEXTURE_COORD_4:
+      case GL_MAP1_TEXTURE_COORD_4:
+      case GL_MAP2_COLOR_4:
+      case GL_MAP1_COLOR_4:
+	return 4;
+      default:
+	return 0;
+    }
+}
+
+void
+GLUnurbs::retainedBgnsurface(void)
+{
+    retainedCache.beginKey();
+    retainedError = 0;
+}
+
+void
+GLUnurbs::retainedNurbssurface(GLint sknot_count, const GLfloat *sknot,
+			       GLint tknot_count, const GLfloat *tknot,
+			       GLint s_stride, GLint t_stride,
+			       const GLfloat *ctlarray, GLint sorder,
+			       GLint torder, GLenum type)
+{
+    int dimension = retainedDimension(type);
+    long ns = sknot_count - sorder;
+    long nt = tknot_count - torder;
+
+    retainedCache.keyWord(RETAINED_SURFACE);
+    retainedCache.keyWord(type);
+    retainedCache.keyWord(sorder);
+    retainedCache.keyWord(torder);
+    retainedCache.keyWord(sknot_count);
+    retainedCache.keyFloats(sknot, sknot_count, 1, 1);
+    retainedCache.keyWord(tknot_count);
+    retainedCache.keyFloats(tknot, tknot_count, 1, 1);
+
+    /* a bad description is reported by the tessellator */
+    if (ns <= 0 || nt <= 0 || dimension == 0)
+	return;
+
+    for (long i = 0; i < ns; i++)
+	retainedCache.keyFloats(ctlarray + i * s_stride, nt, t_stride,
+				dimension);
+
+    if (type == GL_MAP2_VERTEX_3 || type == GL_MAP2_VERTEX_4) {
+	INREAL method;
+
+	getnurbsproperty(type, N_SAMPLINGMETHOD, &method);
+	if (method == N_PATHLENGTH || method == N_PARAMETRICDISTANCE ||
+	    method == N_SURFACEAREA)
+	    retainedCache.keyLevel(ctlarray, ns, nt, s_stride, t_stride,
+				   dimension, samplingMatrix);
+    }
+}
+
+void
+GLUnurbs::retainedNurbscurve(GLint nknots, const GLfloat *knot, GLint stride,
+			     const GLfloat *ctlarray, GLint order, GLenum type)
+{
+    retainedCache.keyWord(RETAINED_CURVE);
+    retainedCache.keyWord(type);
+    retainedCache.keyWord(order);
+    retainedCache.keyWord(nknots);
+    retainedCache.keyFloats(knot, nknots, 1, 1);
+    if (nknots > order)
+	retainedCache.keyFloats(ctlarray, nknots - order, stride,
+				retainedDimension(type));
+}
+
+void
+GLUnurbs::retainedPwlcurve(GLint count, const GLfloat *array, GLint stride,
+			   GLenum type)
+{
+    retainedCache.keyWord(RETAINED_PWLCURVE);
+    retainedCache.keyWord(type);
+    retainedCache.keyWord(count);
+    retainedCache.keyFloats(array, count, stride, retainedDimension(type));
+}
+
+void
+GLUnurbs::retainedTrim(int begin)
+{
+    retainedCache.keyWord(begin ? RETAINED_BGNTRIM : RETAINED_ENDTRIM);
+}
+
+void
+GLUnurbs::retainedEndsurface(void)
+{
+    static const long properties[] = {
+	N_SAMPLINGMETHOD, N_PIXEL_TOLERANCE, N_ERROR_TOLERANCE,
+	N_S_STEPS, N_T_STEPS
+    };
+    RetainedSurface *s;
+    INREAL value;
+    int keep;
+
+    retainedCache.keyWord(RETAINED_PROPERTIES);
+    for (unsigned i = 0; i < sizeof(properties) / sizeof(properties[0]); i++) {
+	getnurbsproperty(GL_MAP2_VERTEX_3, properties[i], &value);
+	retainedCache.keyFloats(&value, 1, 1, 1);
+	getnurbsproperty(GL_MAP2_VERTEX_4, properties[i], &value);
+	retainedCache.keyFloats(&value, 1, 1, 1);
+    }
+    getnurbsproperty(N_DISPLAY, &value);
+    retainedCache.keyFloats(&value, 1, 1, 1);
+
+    /* culling depends on the view, not just on the LOD level */
+    getnurbsproperty(GL_MAP2_VERTEX_3, N_CULLING, &value);
+    keep = (value != N_CULLINGON && retainedCache.getSize() > 0 &&
+	    ! retainedError);
+
+    if (keep && (s = retainedCache.lookup()) != NULL) {
+	discardsurface();
+	endsurface();
+	if (vertexBufferCallback)
+	    vertexBufferCallback(s->numVertices, s->vertices, s->numIndices,
+				 s->indices, GL_FALSE, callbackUserData);
+	return;
+    }
+
+    s = retainedCache.scratch();
+    retainedBuilder.start(s);
+    surfaceEvaluator.put_retained(&retainedBuilder);
+    endsurface();
+    surfaceEvaluator.put_retained(NULL);
+
+    if (retainedBuilder.failed) {
+	s->numVertices = 0;
+	s->numIndices = 0;
+	postError(GLU_OUT_OF_MEMORY);
+    } else if (keep && ! retainedError) {
+	s = retainedCache.keep();
+    }
+
+    if (vertexBufferCallback)
+	vertexBufferCallback(s->numVertices, s->vertices, s->numIndices,
+			     s->indices, GL_TRUE, callbackUserData);
+}
@@ -41,9 +41,12 @@
 #include "nurbstess.h"
 #include "glsurfeval.h"
 #include "glcurveval.h"
+#include "glretained.h"
 
 extern "C" {
       typedef void (APIENTRY *errorCallbackType)( GLenum );
+      typedef void (APIENTRY *vertexBufferCallbackType)( GLsizei,
+		const GLfloat *, GLsizei, const GLuint *, GLboolean, void * );
 }
 
 class GLUnurbs : public NurbsTessellator {
@@ -105,6 +108,7 @@ public:
       {
        curveEvaluator.set_callback_userData(userData);
        surfaceEvaluator.set_callback_userData(userData);
+       callbackUserData = userData;
      }
 
 
@@ -126,6 +130,41 @@ public:
 	curveEvaluator.put_vertices_call_back(flag);
       }
 
+    //GLU_NURBS_RETAINED_EXT: surfaces go to the vertex buffer callback
+    int        is_retained()
+      {
+	return retainedFlag;
+      }
+    void       put_retainedFlag(int flag)
+      {
+	retainedFlag = flag;
+	if(flag)
+	  put_callbackFlag(1);
+      }
+
+    //GLU_NURBS_THREADS_EXT: threads evaluating the patches of a surface
+    int        get_threads()
+      {
+	return surfaceEvaluator.get_threads();
+      }
+    void       put_threads(int n)
+      {
+	surfaceEvaluator.put_threads(n);
+      }
+
+    vertexBufferCallbackType vertexBufferCallback;
+    RetainedCache	retainedCache;
+
+    void	retainedBgnsurface( void );
+    void	retainedEndsurface( void );
+    void	retainedNurbssurface( GLint, const GLfloat *, GLint,
+				      const GLfloat *, GLint, GLint,
+				      const GLfloat *, GLint, GLint, GLenum );
+    void	retainedNurbscurve( GLint, const GLfloat *, GLint,
+				    const GLfloat *, GLint, GLenum );
+    void	retainedPwlcurve( GLint, const GLfloat *, GLint, GLenum );
+    void	retainedTrim( int );
+
 private:
     GLboolean			autoloadmode;
     OpenGLSurfaceEvaluator	surfaceEvaluator;
@@ -141,6 +180,12 @@ private:
 				const GLfloat right[4][4] );
 
    int                  callbackFlag;
+
+    int			retainedFlag;
+    int			retainedError;	/* error while defining the surface */
+    RetainedBuilder	retainedBuilder;
+    INREAL		samplingMatrix[4][4];	/* copy of the last one loaded */
+    void		*callbackUserData;
 };
 
 #endif /* __gluglrenderer_h_ */
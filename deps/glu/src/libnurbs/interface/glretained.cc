@@ -0,0 +1,550 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+/*
+ * glretained.c++
+ *
+ */
+
+#include "gluos.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "glretained.h"
+
+/* initial number of slots in the vertex table (a power of two) */
+#define RETAINED_TABLE_SIZE 1024
+
+/* LOD level used when part of the control net is behind the eye */
+#define RETAINED_LEVEL_BEHIND 64
+
+static unsigned long
+hashWords(unsigned long h, const GLuint *w, long n)
+{
+    /* FNV-1a, a word at a time */
+    while (n-- > 0)
+	h = (h ^ *w++) * 16777619UL;
+    return h;
+}
+
+static GLuint
+floatBits(GLfloat f)
+{
+    GLuint w;
+
+    memcpy(&w, &f, sizeof(w));
+    return w;
+}
+
+/*-------------------------------------------------------------------------
+ * RetainedSurface
+ *-------------------------------------------------------------------------
+ */
+RetainedSurface::RetainedSurface(void)
+{
+    hash = 0;
+    key = NULL;
+    keyLength = 0;
+    vertices = NULL;
+    numVertices = 0;
+    maxVertices = 0;
+    indices = NULL;
+    numIndices = 0;
+    maxIndices = 0;
+    prev = NULL;
+    next = NULL;
+}
+
+RetainedSurface::~RetainedSurface(void)
+{
+    free(key);
+    free(vertices);
+    free(indices);
+}
+
+/*-------------------------------------------------------------------------
+ * RetainedBuilder
+ *-------------------------------------------------------------------------
+ */
+RetainedBuilder::RetainedBuilder(void)
+{
+    failed = 0;
+    surface = NULL;
+    type = GL_TRIANGLES;
+    count = 0;
+    first = 0;
+    table = NULL;
+    tableMask = 0;
+}
+
+RetainedBuilder::~RetainedBuilder(void)
+{
+    free(table);
+}
+
+void
+RetainedBuilder::start(RetainedSurface *s)
+{
+    surface = s;
+    surface->numVertices = 0;
+    surface->numIndices = 0;
+    failed = 0;
+
+    current[0] = current[1] = current[2] = 0.0;
+    current[3] = current[4] = 0.0;
+    current[5] = 1.0;
+    current[6] = current[7] = 0.0;
+
+    if (table == NULL) {
+	table = (GLuint *) malloc(RETAINED_TABLE_SIZE * sizeof(GLuint));
+	if (table == NULL) {
+	    failed = 1;
+	    return;
+	}
+	tableMask = RETAINED_TABLE_SIZE - 1;
+    }
+    memset(table, 0, (tableMask + 1) * sizeof(GLuint));
+}
+
+void
+RetainedBuilder::begin(GLenum which)
+{
+    type = which;
+    count = 0;
+}
+
+void
+RetainedBuilder::end(void)
+{
+    count = 0;
+}
+
+void
+RetainedBuilder::normal(const GLfloat *n)
+{
+    current[3] = n[0];
+    current[4] = n[1];
+    current[5] = n[2];
+}
+
+void
+RetainedBuilder::texcoord(const GLfloat *t, int dimension)
+{
+    current[6] = t[0];
+    current[7] = (dimension > 1) ? t[1] : 0.0f;
+}
+
+void
+RetainedBuilder::vertex(const GLfloat *v)
+{
+    switch (type) {
+      case GL_TRIANGLES:
+      case GL_TRIANGLE_STRIP:
+      case GL_TRIANGLE_FAN:
+      case GL_QUADS:
+      case GL_QUAD_STRIP:
+      case GL_POLYGON:
+	break;
+      default:
+	return;		/* outlines have no place in a triangle list */
+    }
+    if (failed)
+	return;
+
+    current[0] = v[0];
+    current[1] = v[1];
+    current[2] = v[2];
+
+    GLuint i = addVertex();
+    if (failed)
+	return;
+
+    last[3] = last[2];
+    last[2] = last[1];
+    last[1] = last[0];
+    last[0] = i;
+    count++;
+
+    switch (type) {
+      case GL_TRIANGLES:
+	if (count % 3 == 0)
+	    addTriangle(last[2], last[1], last[0]);
+	break;
+      case GL_TRIANGLE_STRIP:
+	/* every other triangle is reversed to keep the orientation */
+	if (count >= 3) {
+	    if (count & 1)
+		addTriangle(last[2], last[1], last[0]);
+	    else
+		addTriangle(last[1], last[2], last[0]);
+	}
+	break;
+      case GL_TRIANGLE_FAN:
+      case GL_POLYGON:
+	if (count == 1)
+	    first = i;
+	else if (count >= 3)
+	    addTriangle(first, last[1], last[0]);
+	break;
+      case GL_QUADS:
+	if (count % 4 == 0) {
+	    addTriangle(last[3], last[2], last[1]);
+	    addTriangle(last[3], last[1], last[0]);
+	}
+	break;
+      case GL_QUAD_STRIP:
+	/* the quad is last[3], last[2], last[0], last[1] in order */
+	if (count >= 4 && (count & 1) == 0) {
+	    addTriangle(last[3], last[2], last[0]);
+	    addTriangle(last[3], last[0], last[1]);
+	}
+	break;
+    }
+}
+
+GLuint
+RetainedBuilder::addVertex(void)
+{
+    GLuint bits[RETAINED_VERTEX_SIZE];
+    int k;
+
+    for (k = 0; k < RETAINED_VERTEX_SIZE; k++)
+	bits[k] = floatBits(current[k]);
+
+    unsigned long slot = hashWords(2166136261UL, bits, RETAINED_VERTEX_SIZE);
+    for (slot &= tableMask; table[slot] != 0; slot = (slot + 1) & tableMask) {
+	GLuint i = table[slot] - 1;
+	if (memcmp(surface->vertices + i * RETAINED_VERTEX_SIZE, current,
+		   sizeof(current)) == 0)
+	    return i;
+    }
+
+    if (surface->numVertices == surface->maxVertices) {
+	GLsizei max = surface->maxVertices ? 2 * surface->maxVertices : 256;
+	GLfloat *v = (GLfloat *) realloc(surface->vertices,
+			     max * RETAINED_VERTEX_SIZE * sizeof(GLfloat));
+	if (v == NULL) {
+	    failed = 1;
+	    return 0;
+	}
+	surface->vertices = v;
+	surface->maxVertices = max;
+    }
+
+    GLuint i = (GLuint) surface->numVertices++;
+    memcpy(surface->vertices + i * RETAINED_VERTEX_SIZE, current,
+	   sizeof(current));
+    table[slot] = i + 1;
+
+    /* keep the table at most half full */
+    if ((unsigned long) surface->numVertices * 2 > tableMask + 1)
+	if (! growTable())
+	    failed = 1;
+    return i;
+}
+
+int
+RetainedBuilder::growTable(void)
+{
+    unsigned long size = 2 * (tableMask + 1);
+    GLuint *t = (GLuint *) calloc(size, sizeof(GLuint));
+    if (t == NULL)
+	return 0;
+
+    for (GLsizei i = 0; i < surface->numVertices; i++) {
+	GLuint bits[RETAINED_VERTEX_SIZE];
+	const GLfloat *v = surface->vertices + i * RETAINED_VERTEX_SIZE;
+	for (int k = 0; k < RETAINED_VERTEX_SIZE; k++)
+	    bits[k] = floatBits(v[k]);
+
+	unsigned long slot = hashWords(2166136261UL, bits,
+				       RETAINED_VERTEX_SIZE) & (size - 1);
+	while (t[slot] != 0)
+	    slot = (slot + 1) & (size - 1);
+	t[slot] = (GLuint) i + 1;
+    }
+    free(table);
+    table = t;
+    tableMask = size - 1;
+    return 1;
+}
+
+void
+RetainedBuilder::addTriangle(GLuint a, GLuint b, GLuint c)
+{
+    if (a == b || b == c || c == a)
+	return;
+
+    if (surface->numIndices + 3 > surface->maxIndices) {
+	GLsizei max = surface->maxIndices ? 2 * surface->maxIndices : 768;
+	GLuint *n = (GLuint *) realloc(surface->indices, max * sizeof(GLuint));
+	if (n == NULL) {
+	    failed = 1;
+	    return;
+	}
+	surface->indices = n;
+	surface->maxIndices = max;
+    }
+    surface->indices[surface->numIndices++] = a;
+    surface->indices[surface->numIndices++] = b;
+    surface->indices[surface->numIndices++] = c;
+}
+
+/*-------------------------------------------------------------------------
+ * RetainedCache
+ *-------------------------------------------------------------------------
+ */
+RetainedCache::RetainedCache(void)
+{
+    hits = 0;
+    misses = 0;
+    maxEntries = RETAINED_DEFAULT_SIZE;
+    numEntries = 0;
+    head = NULL;
+    tail = NULL;
+    key = NULL;
+    keyLength = 0;
+    keyMax = 0;
+    keyFailed = 0;
+    hash = 0;
+    level = 0;
+}
+
+RetainedCache::~RetainedCache(void)
+{
+    while (head != NULL) {
+	RetainedSurface *s = head;
+	head = s->next;
+	delete s;
+    }
+    free(key);
+}
+
+void
+RetainedCache::setSize(long n)
+{
+    maxEntries = (n < 0) ? 0 : n;
+    evict();
+}
+
+/*-------------------------------------------------------------------------
+ * beginKey - start recording the description of a surface.  The key is
+ * a sequence of words: tags and counts from the caller, and the bit
+ * patterns of knots and control points.
+ *-------------------------------------------------------------------------
+ */
+void
+RetainedCache::beginKey(void)
+{
+    keyLength = 0;
+    keyFailed = 0;
+    level = 0;
+}
+
+void
+RetainedCache::keyWord(GLuint w)
+{
+    if (keyLength == keyMax) {
+	long max = keyMax ? 2 * keyMax : 1024;
+	GLuint *k = (GLuint *) realloc(key, max * sizeof(GLuint));
+	if (k == NULL) {
+	    keyFailed = 1;
+	    return;
+	}
+	key = k;
+	keyMax = max;
+    }
+    key[keyLength++] = w;
+}
+
+void
+RetainedCache::keyFloats(const GLfloat *p, long n, long stride, int dimension)
+{
+    for (long i = 0; i < n; i++, p += stride)
+	for (int k = 0; k < dimension; k++)
+	    keyWord(floatBits(p[k]));
+}
+
+/*-------------------------------------------------------------------------
+ * keyLevel - raise the LOD level to cover a vertex control net.  The
+ * level is the binary exponent of the longest control net edge in
+ * pixels, as seen through the sampling matrix.  The path length and
+ * parametric error samplers scale with that length, so the result for
+ * one level is good for the whole range of sizes it covers.
+ *-------------------------------------------------------------------------
+ */
+void
+RetainedCache::keyLevel(const GLfloat *ctl, long ns, long nt,
+			long sstride, long tstride, int dimension,
+			const GLfloat smat[4][4])
+{
+    GLfloat longest = 0.0;
+
+    for (long i = 0; i < ns; i++) {
+	for (long j = 0; j < nt; j++) {
+	    GLfloat p[3][2];
+
+	    /* the point, and its neighbours in s and t */
+	    for (int d = 0; d < 3; d++) {
+		long ii = i + (d == 1);
+		long jj = j + (d == 2);
+		if (ii >= ns || jj >= nt)
+		    continue;
+
+		const GLfloat *c = ctl + ii * sstride + jj * tstride;
+		GLfloat w = (dimension == 4) ? c[3] : 1.0f;
+		GLfloat h = c[0] * smat[0][3] + c[1] * smat[1][3] +
+			    c[2] * smat[2][3] + w * smat[3][3];
+		if (h <= 0.0) {
+		    if (level < RETAINED_LEVEL_BEHIND)
+			level = RETAINED_LEVEL_BEHIND;
+		    return;
+		}
+		p[d][0] = (c[0] * smat[0][0] + c[1] * smat[1][0] +
+			   c[2] * smat[2][0] + w * smat[3][0]) / h;
+		p[d][1] = (c[0] * smat[0][1] + c[1] * smat[1][1] +
+			   c[2] * smat[2][1] + w * smat[3][1]) / h;
+
+		if (d > 0) {
+		    GLfloat dx = p[d][0] - p[0][0];
+		    GLfloat dy = p[d][1] - p[0][1];
+		    if (dx * dx + dy * dy > longest)
+			longest = dx * dx + dy * dy;
+		}
+	    }
+	}
+    }
+
+    int e = 0;
+    if (longest > 0.0)
+	frexp(sqrt(longest), &e);
+    if (e > level)
+	level = e;
+}
+
+/*-------------------------------------------------------------------------
+ * lookup - finish the key and find a retained result for it
+ *-------------------------------------------------------------------------
+ */
+RetainedSurface *
+RetainedCache::lookup(void)
+{
+    keyWord((GLuint) level);
+    if (keyFailed)
+	return NULL;
+    hash = hashWords(2166136261UL, key, keyLength);
+
+    for (RetainedSurface *s = head; s != NULL; s = s->next) {
+	if (s->hash == hash && s->keyLength == keyLength &&
+	    memcmp(s->key, key, keyLength * sizeof(GLuint)) == 0) {
+	    remove(s);
+	    pushFront(s);
+	    hits++;
+	    return s;
+	}
+    }
+    misses++;
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------
+ * scratch - the surface to tessellate into.  Its buffers are reused for
+ * every tessellation, and handed over to the cache entry by keep().
+ *-------------------------------------------------------------------------
+ */
+RetainedSurface *
+RetainedCache::scratch(void)
+{
+    return &work;
+}
+
+RetainedSurface *
+RetainedCache::keep(void)
+{
+    if (maxEntries == 0 || keyFailed)
+	return &work;
+
+    RetainedSurface *s = new RetainedSurface;
+    s->key = (GLuint *) malloc(keyLength * sizeof(GLuint));
+    if (s->key == NULL) {
+	delete s;
+	return &work;
+    }
+    memcpy(s->key, key, keyLength * sizeof(GLuint));
+    s->keyLength = keyLength;
+    s->hash = hash;
+
+    s->vertices = work.vertices;
+    s->numVertices = work.numVertices;
+    s->maxVertices = work.maxVertices;
+    s->indices = work.indices;
+    s->numIndices = work.numIndices;
+    s->maxIndices = work.maxIndices;
+    work.vertices = NULL;
+    work.numVertices = work.maxVertices = 0;
+    work.indices = NULL;
+    work.numIndices = work.maxIndices = 0;
+
+    pushFront(s);
+    numEntries++;
+    evict();
+    return s;
+}
+
+void
+RetainedCache::remove(RetainedSurface *s)
+{
+    if (s->prev) s->prev->next = s->next;
+    else head = s->next;
+    if (s->next) s->next->prev = s->prev;
+    else tail = s->prev;
+    s->prev = s->next = NULL;
+}
+
+void
+RetainedCache::pushFront(RetainedSurface *s)
+{
+    s->prev = NULL;
+    s->next = head;
+    if (head) head->prev = s;
+    else tail = s;
+    head = s;
+}
+
+void
+RetainedCache::evict(void)
+{
+    while (numEntries > maxEntries) {
+	RetainedSurface *s = tail;
+	remove(s);
+	delete s;
+	numEntries--;
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+/*
+ * glretained.h
+ *
+ * Retained output for GLU_NURBS_RETAINED_EXT.  A surface is tessellated
+ * once into an indexed triangle list and handed to the client through
+ * the GLU_NURBS_VERTEX_BUFFER_EXT callback.  The result is kept, keyed by
+ * a copy of the surface description, the sampling properties and (for
+ * view dependent sampling) a LOD level, so that drawing the same surface
+ * again does not tessellate it again.
+ */
+
+#ifndef __gluglretained_h_
+#define __gluglretained_h_
+
+#include <GL/gl.h>
+#include <GL/glu.h>
+
+/* floats per vertex: x y z, nx ny nz, s t */
+#define RETAINED_VERTEX_SIZE 8
+
+/* default number of surfaces kept per GLUnurbs object */
+#define RETAINED_DEFAULT_SIZE 64
+
+class RetainedSurface {
+public:
+			RetainedSurface( void );
+			~RetainedSurface( void );
+
+    unsigned long	hash;
+    GLuint		*key;		/* see RetainedCache::beginKey */
+    long		keyLength;
+
+    GLfloat		*vertices;	/* RETAINED_VERTEX_SIZE per vertex */
+    GLsizei		numVertices;
+    GLsizei		maxVertices;
+    GLuint		*indices;	/* three per triangle */
+    GLsizei		numIndices;
+    GLsizei		maxIndices;
+
+    RetainedSurface	*prev;		/* LRU list, most recent first */
+    RetainedSurface	*next;
+};
+
+/* Collects the triangles produced by OpenGLSurfaceEvaluator in place of
+ * the client's begin/vertex/normal/texcoord/end callbacks.  Strips, fans
+ * and quad strips become triangles; vertices with identical attributes
+ * are stored once.
+ */
+class RetainedBuilder {
+public:
+			RetainedBuilder( void );
+			~RetainedBuilder( void );
+
+    void		start( RetainedSurface * );
+    void		begin( GLenum );
+    void		normal( const GLfloat * );
+    void		texcoord( const GLfloat *, int );
+    void		vertex( const GLfloat * );
+    void		end( void );
+
+    int			failed;		/* ran out of memory */
+
+private:
+    GLuint		addVertex( void );
+    void		addTriangle( GLuint, GLuint, GLuint );
+    int			growTable( void );
+
+    RetainedSurface	*surface;
+    GLfloat		current[RETAINED_VERTEX_SIZE];
+
+    GLenum		type;		/* current primitive */
+    long		count;		/* vertices seen in it */
+    GLuint		first;		/* fan center */
+    GLuint		last[4];	/* most recent vertices, last[0] newest */
+
+    GLuint		*table;		/* vertex index + 1, 0 is empty */
+    unsigned long	tableMask;
+};
+
+class RetainedCache {
+public:
+			RetainedCache( void );
+			~RetainedCache( void );
+
+    void		setSize( long );
+    long		getSize( void ) { return maxEntries; }
+    long		hits;
+    long		misses;
+
+    /* describing the surface being defined */
+    void		beginKey( void );
+    void		keyWord( GLuint );
+    void		keyFloats( const GLfloat *, long count, long stride,
+				   int dimension );
+    void		keyLevel( const GLfloat *, long ns, long nt,
+				  long sstride, long tstride, int dimension,
+				  const GLfloat smat[4][4] );
+    int			getLevel( void ) { return level; }
+
+    RetainedSurface	*lookup( void );
+    RetainedSurface	*scratch( void );
+    RetainedSurface	*keep( void );
+
+private:
+    void		remove( RetainedSurface * );
+    void		pushFront( RetainedSurface * );
+    void		evict( void );
+
+    long		maxEntries;
+    long		numEntries;
+    RetainedSurface	*head;
+    RetainedSurface	*tail;
+    RetainedSurface	work;		/* tessellation target */
+
+    GLuint		*key;
+    long		keyLength;
+    long		keyMax;
+    int			keyFailed;
+    unsigned long	hash;
+    int			level;		/* LOD level of the surface */
+};
+
+#endif /* __gluglretained_h_ */
@@ -45,6 +45,8 @@
 #include "glsurfeval.h"
 #include "nurbsconsts.h"
 #include "bezierPatchMesh.h"
+#include "glretained.h"
+#include "glrecorder.h"
 
 
 //extern int surfcount;
@@ -137,6 +139,13 @@ OpenGLSurfaceEvaluator::OpenGLSurfaceEvaluator()
     texcoordCallBackData = NULL;
 
     userData = NULL;
+    retained = NULL;
+    recorder = NULL;
+
+    num_threads = 1;
+    for (i=0; i<IN_MAX_THREADS; i++) {
+	workers[i] = NULL;
+    }
 
     auto_normal_flag = 0;
     callback_auto_normal = 0; //default of GLU_CALLBACK_AUTO_NORMAL is 0
@@ -165,6 +174,12 @@ OpenGLSurfaceEvaluator::~OpenGLSurfaceEvaluator()
       delete vertexCache[ii];
       vertexCache[ii]= 0;
    }
+   for (int ii= 0; ii< IN_MAX_THREADS; ii++) {
+      if (workers[ii] != NULL) {
+	 delete workers[ii]->recorder;
+	 delete workers[ii];
+      }
+   }
 }
 
 /*---------------------------------------------------------------------------
@@ -740,13 +755,10 @@ OpenGLSurfaceEvaluator::bgnmap2f(long)
 {
   if(output_triangles)
     {
-      /*deallocate the space which may has been
-       *allocated by global_bpm previously
+      /*a list left behind by a tessellation that ended in an error
+       *lived in the tessellator's arena, which has been reset since
        */
-      if(global_bpm != NULL) {
-	bezierPatchMeshListDelete(global_bpm);
-	global_bpm = NULL;
-      }
+      global_bpm = NULL;
 
 
       /*
@@ -760,7 +772,8 @@ OpenGLSurfaceEvaluator::bgnmap2f(long)
       //if one of the two normal callback functions are set,
       //then set
       if(normalCallBackN != NULL ||
-	 normalCallBackData != NULL)
+	 normalCallBackData != NULL ||
+	 retained != NULL)
 	auto_normal_flag = 1;
       else
 	auto_normal_flag = 0;
@@ -811,7 +824,10 @@ OpenGLSurfaceEvaluator::endmap2f(void)
       //printf("surfcount=%i\n", surfcount);
       //if(surfcount == 8) exit(0);
 
-      inBPMListEvalEM(global_bpm);
+      if(num_threads > 1)
+	inBPMListEvalParallelEM(global_bpm);
+      else
+	inBPMListEvalEM(global_bpm);
 
 
 
@@ -1236,7 +1252,11 @@ void OpenGLSurfaceEvaluator::putCallBack(GLenum which, _GLUfuncptr fn )
 void
 OpenGLSurfaceEvaluator::beginCallBack(GLenum which, void *data)
 {
-  if(beginCallBackData)
+  if(recorder)
+    recorder->begin(which);
+  else if(retained)
+    retained->begin(which);
+  else if(beginCallBackData)
     beginCallBackData(which, data);
   else if(beginCallBackN)
     beginCallBackN(which);
@@ -1245,7 +1265,11 @@ OpenGLSurfaceEvaluator::beginCallBack(GLenum which, void *data)
 void
 OpenGLSurfaceEvaluator::endCallBack(void *data)
 {
-  if(endCallBackData)
+  if(recorder)
+    recorder->end();
+  else if(retained)
+    retained->end();
+  else if(endCallBackData)
     endCallBackData(data);
   else if(endCallBackN)
     endCallBackN();
@@ -1254,7 +1278,11 @@ OpenGLSurfaceEvaluator::endCallBack(void *data)
 void
 OpenGLSurfaceEvaluator::vertexCallBack(const GLfloat *vert, void* data)
 {
-  if(vertexCallBackData)
+  if(recorder)
+    recorder->vertex(vert);
+  else if(retained)
+    retained->vertex(vert);
+  else if(vertexCallBackData)
     vertexCallBackData(vert, data);
   else if(vertexCallBackN)
     vertexCallBackN(vert);
@@ -1264,7 +1292,11 @@ OpenGLSurfaceEvaluator::vertexCallBack(const GLfloat *vert, void* data)
 void
 OpenGLSurfaceEvaluator::normalCallBack(const GLfloat *normal, void* data)
 {
-  if(normalCallBackData)
+  if(recorder)
+    recorder->normal(normal);
+  else if(retained)
+    retained->normal(normal);
+  else if(normalCallBackData)
     normalCallBackData(normal, data);
   else if(normalCallBackN)
     normalCallBackN(normal);
@@ -1273,7 +1305,11 @@ OpenGLSurfaceEvaluator::normalCallBack(const GLfloat *normal, void* data)
 void
 OpenGLSurfaceEvaluator::colorCallBack(const GLfloat *color, void* data)
 {
-  if(colorCallBackData)
+  if(recorder)
+    recorder->color(color);
+  else if(retained)
+    return; //a retained buffer has no colors
+  else if(colorCallBackData)
     colorCallBackData(color, data);
   else if(colorCallBackN)
     colorCallBackN(color);
@@ -1282,12 +1318,61 @@ OpenGLSurfaceEvaluator::colorCallBack(const GLfloat *color, void* data)
 void
 OpenGLSurfaceEvaluator::texcoordCallBack(const GLfloat *texcoord, void* data)
 {
-  if(texcoordCallBackData)
+  if(recorder)
+    recorder->texcoord(texcoord, em_texcoord.k);
+  else if(retained)
+    retained->texcoord(texcoord, em_texcoord.k);
+  else if(texcoordCallBackData)
     texcoordCallBackData(texcoord, data);
   else if(texcoordCallBackN)
     texcoordCallBackN(texcoord);
 }
 
+/*---------------------------------------------------------------------------
+ * replay - pass the output a worker evaluator recorded to the callbacks
+ *---------------------------------------------------------------------------
+ */
+void
+OpenGLSurfaceEvaluator::replay(EvalRecorder *rec)
+{
+  const GLuint *op = rec->ops;
+  const GLuint *opend = rec->ops + rec->numOps;
+  const GLfloat *val = rec->vals;
+
+  while(op < opend)
+    {
+      switch(*op++)
+	{
+	case RECORD_BEGIN:
+	  beginCallBack((GLenum) *op++, userData);
+	  break;
+	case RECORD_END:
+	  endCallBack(userData);
+	  break;
+	case RECORD_VERTEX:
+	  vertexCallBack(val, userData);
+	  val += 5;
+	  break;
+	case RECORD_NORMAL:
+	  normalCallBack(val, userData);
+	  val += 3;
+	  break;
+	case RECORD_COLOR:
+	  colorCallBack(val, userData);
+	  val += 4;
+	  break;
+	case RECORD_TEXCOORD:
+	  if(retained)
+	    retained->texcoord(val, (int) *op);
+	  else
+	    texcoordCallBack(val, userData);
+	  op++;
+	  val += 4;
+	  break;
+	}
+    }
+}
+
 
 
 
@@ -60,6 +60,15 @@ class StoredVertex;
 #define IN_MAX_DIMENSION 4 
 #endif
 
+/*number of points evaluated together by inDoEvalCoord2BatchEM*/
+#define IN_EVAL_BATCH 8
+
+/*most threads GLU_NURBS_THREADS_EXT will use*/
+#define IN_MAX_THREADS 64
+
+/*surfaces with fewer points than this are evaluated on one thread*/
+#define IN_PARALLEL_MIN_POINTS 4096
+
 typedef struct surfEvalMachine{
   REAL uprime;//cached previusly evaluated uprime.
   REAL vprime;
@@ -81,6 +90,9 @@ typedef struct surfEvalMachine{
   
   
 
+class RetainedBuilder;
+class EvalRecorder;
+
 class StoredVertex {
 public:
     		StoredVertex() { type = 0; coord[0] = 0; coord[1] = 0; point[0] = 0; point[1] = 0; }
@@ -170,6 +182,24 @@ public:
        userData = data;
      }
 
+   //GLU_NURBS_RETAINED_EXT: collect the output here instead of
+   //calling the client's callbacks
+   void                  put_retained(RetainedBuilder *builder)
+     {
+       retained = builder;
+     }
+
+   //GLU_NURBS_THREADS_EXT: number of threads that evaluate the patches
+   //of a surface in the callback modes
+   void                  put_threads(int n)
+     {
+       num_threads = n;
+     }
+   int                   get_threads()
+     {
+       return num_threads;
+     }
+
     /**************begin for LOD_eval_list***********/
     void LOD_eval_list(int level);
 
@@ -213,6 +243,12 @@ private:
 
 
     void* userData; //the opaque pointer for Data callback functions.
+    RetainedBuilder* retained; //NULL unless building a retained surface
+    EvalRecorder* recorder; //NULL unless this is a worker evaluator
+
+    int num_threads;
+    OpenGLSurfaceEvaluator* workers[IN_MAX_THREADS]; //allocated when needed
+    void replay(EvalRecorder* rec);
 
    /*LOD evaluation*/
    void LOD_triangle(REAL A[2], REAL B[2], REAL C[2],
@@ -377,8 +413,19 @@ void inDoDomain2EM(surfEvalMachine *em, REAL u, REAL v,
 				REAL *retPoint);
  void inDoEvalCoord2EM(REAL u, REAL v);
 
+void inPreEvaluateBatch(int order, REAL *prime,
+			REAL coeff[][IN_EVAL_BATCH],
+			REAL coeffDeriv[][IN_EVAL_BATCH]);
+void inDoDomain2WithDerivsBatchEM(surfEvalMachine *em, REAL *u, REAL *v,
+				  REAL retPoint[][IN_EVAL_BATCH],
+				  REAL retdu[][IN_EVAL_BATCH],
+				  REAL retdv[][IN_EVAL_BATCH]);
+void inDoEvalCoord2BatchEM(int n, REAL *uv);
+
 void inBPMEvalEM(bezierPatchMesh* bpm);
 void inBPMListEvalEM(bezierPatchMesh* list);
+void inBPMRunEvalEM(bezierPatchMesh** patches, int n);
+void inBPMListEvalParallelEM(bezierPatchMesh* list);
 
 /*-------------end for surfEvalMachine -------------*/
 
@@ -41,8 +41,20 @@
 #include <GL/gl.h>
 #include <math.h>
 #include <assert.h>
+#include <thread>
 
 #include "glsurfeval.h"
+#include "glrecorder.h"
+#include "arena.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLU_SIMD_HAVE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GLU_SIMD_HAVE_NEON 1
+#endif
 
 //extern int surfcount;
 
@@ -1823,6 +1835,210 @@ void OpenGLSurfaceEvaluator::inDoEvalCoord2EM(REAL u, REAL v)
 }
 
 
+/*
+ *Batched evaluation for the vertex map.
+ *
+ *The points of a strip are evaluated IN_EVAL_BATCH at a time. The
+ *Bezier coefficients are still computed point by point (but shared
+ *between points with the same parameter, which along a strip is
+ *every other point), and are stored by lane: coeff[i][l] is
+ *coefficient i of point l. The tensor product then runs once for the
+ *whole batch: each control point is loaded once and multiplied into a
+ *vector of coefficients. The sums are formed in the same order as in
+ *inDoDomain2WithDerivsEM, so the results do not change (src/meson.build
+ *builds this file with -ffp-contract=off so neither is fused).
+ *
+ *inBPMEvalEM takes this path only when the vertex map is the only map
+ *enabled. With a normal, color or texture coordinate map active as
+ *well, every point still goes through inDoEvalCoord2EM.
+ */
+#if defined(GLU_SIMD_HAVE_SSE2)
+typedef __m128 inVec;
+#define IN_VEC_LANES 4
+#define inVecLoad(p)     _mm_loadu_ps(p)
+#define inVecStore(p,a)  _mm_storeu_ps((p),(a))
+#define inVecSplat(x)    _mm_set1_ps(x)
+#define inVecAdd(a,b)    _mm_add_ps((a),(b))
+#define inVecMul(a,b)    _mm_mul_ps((a),(b))
+#elif defined(GLU_SIMD_HAVE_NEON)
+typedef float32x4_t inVec;
+#define IN_VEC_LANES 4
+#define inVecLoad(p)     vld1q_f32(p)
+#define inVecStore(p,a)  vst1q_f32((p),(a))
+#define inVecSplat(x)    vdupq_n_f32(x)
+#define inVecAdd(a,b)    vaddq_f32((a),(b))
+#define inVecMul(a,b)    vmulq_f32((a),(b))
+#else
+typedef REAL inVec;
+#define IN_VEC_LANES 1
+#define inVecLoad(p)     (*(p))
+#define inVecStore(p,a)  (*(p) = (a))
+#define inVecSplat(x)    (x)
+#define inVecAdd(a,b)    ((a)+(b))
+#define inVecMul(a,b)    ((a)*(b))
+#endif
+
+void OpenGLSurfaceEvaluator::inPreEvaluateBatch(int order, REAL *prime,
+						REAL coeff[][IN_EVAL_BATCH],
+						REAL coeffDeriv[][IN_EVAL_BATCH])
+{
+  REAL c[IN_MAX_BEZIER_ORDER];
+  REAL cDeriv[IN_MAX_BEZIER_ORDER];
+  int i, l, from;
+
+  for(l=0; l<IN_EVAL_BATCH; l++)
+    {
+      if(l >= 1 && prime[l] == prime[l-1])
+	from = l-1;
+      else if(l >= 2 && prime[l] == prime[l-2])
+	from = l-2;
+      else
+	from = -1;
+
+      if(from >= 0)
+	{
+	  for(i=0; i<order; i++)
+	    {
+	      coeff[i][l] = coeff[i][from];
+	      coeffDeriv[i][l] = coeffDeriv[i][from];
+	    }
+	}
+      else
+	{
+	  inPreEvaluateWithDeriv(order, prime[l], c, cDeriv);
+	  for(i=0; i<order; i++)
+	    {
+	      coeff[i][l] = c[i];
+	      coeffDeriv[i][l] = cDeriv[i];
+	    }
+	}
+    }
+}
+
+void OpenGLSurfaceEvaluator::inDoDomain2WithDerivsBatchEM(surfEvalMachine *em,
+				REAL *u, REAL *v,
+				REAL retPoint[][IN_EVAL_BATCH],
+				REAL retdu[][IN_EVAL_BATCH],
+				REAL retdv[][IN_EVAL_BATCH])
+{
+    REAL ucoeff[IN_MAX_BEZIER_ORDER][IN_EVAL_BATCH];
+    REAL vcoeff[IN_MAX_BEZIER_ORDER][IN_EVAL_BATCH];
+    REAL ucoeffDeriv[IN_MAX_BEZIER_ORDER][IN_EVAL_BATCH];
+    REAL vcoeffDeriv[IN_MAX_BEZIER_ORDER][IN_EVAL_BATCH];
+    REAL uprime[IN_EVAL_BATCH];
+    REAL vprime[IN_EVAL_BATCH];
+    REAL *data;
+    int j, l, row, col;
+
+    assert(em->u2 != em->u1 && em->v2 != em->v1);
+    for (l = 0; l < IN_EVAL_BATCH; l++) {
+	uprime[l] = (u[l] - em->u1) / (em->u2 - em->u1);
+	vprime[l] = (v[l] - em->v1) / (em->v2 - em->v1);
+    }
+    inPreEvaluateBatch(em->uorder, uprime, ucoeff, ucoeffDeriv);
+    inPreEvaluateBatch(em->vorder, vprime, vcoeff, vcoeffDeriv);
+
+    for (j = 0; j < em->k; j++) {
+	for (l = 0; l < IN_EVAL_BATCH; l += IN_VEC_LANES) {
+	    inVec r = inVecSplat(0.0f);
+	    inVec rdu = r;
+	    inVec rdv = r;
+
+	    data = em->ctlPoints+j;
+	    for (row = 0; row < em->uorder; row++) {
+		inVec d = inVecSplat(*data);
+		inVec p = inVecMul(inVecLoad(&vcoeff[0][l]), d);
+		inVec pdv = inVecMul(inVecLoad(&vcoeffDeriv[0][l]), d);
+		inVec uc;
+
+		data += em->k;
+		for (col = 1; col < em->vorder; col++) {
+		    d = inVecSplat(*data);
+		    p = inVecAdd(p, inVecMul(inVecLoad(&vcoeff[col][l]), d));
+		    pdv = inVecAdd(pdv, inVecMul(inVecLoad(&vcoeffDeriv[col][l]), d));
+		    data += em->k;
+		}
+		uc = inVecLoad(&ucoeff[row][l]);
+		r = inVecAdd(r, inVecMul(uc, p));
+		rdu = inVecAdd(rdu, inVecMul(inVecLoad(&ucoeffDeriv[row][l]), p));
+		rdv = inVecAdd(rdv, inVecMul(uc, pdv));
+	    }
+	    inVecStore(&retPoint[j][l], r);
+	    inVecStore(&retdu[j][l], rdu);
+	    inVecStore(&retdv[j][l], rdv);
+	}
+    }
+}
+
+/*evaluate and output the first n (at most IN_EVAL_BATCH) points of uv[],
+ *with the same results and callbacks as n calls to inDoEvalCoord2EM.
+ *Only the vertex map may be active.
+ */
+void OpenGLSurfaceEvaluator::inDoEvalCoord2BatchEM(int n, REAL *uv)
+{
+  REAL u[IN_EVAL_BATCH];
+  REAL v[IN_EVAL_BATCH];
+  REAL point[IN_MAX_DIMENSION][IN_EVAL_BATCH];
+  REAL du[IN_MAX_DIMENSION][IN_EVAL_BATCH];
+  REAL dv[IN_MAX_DIMENSION][IN_EVAL_BATCH];
+  REAL temp_vertex[5];
+  REAL temp_normal[3];
+  REAL tdu[4];
+  REAL tdv[4];
+  int j, l;
+
+  assert(n > 0 && n <= IN_EVAL_BATCH);
+  for(l=0; l<IN_EVAL_BATCH; l++)
+    {
+      /*pad a short batch with its first point*/
+      j = (l < n)? l : 0;
+      u[l] = uv[2*j];
+      v[l] = uv[2*j+1];
+    }
+  inDoDomain2WithDerivsBatchEM(&em_vertex, u, v, point, du, dv);
+
+  for(l=0; l<n; l++)
+    {
+      for(j=0; j<em_vertex.k; j++)
+	{
+	  temp_vertex[j] = point[j][l];
+	  tdu[j] = du[j][l];
+	  tdv[j] = dv[j][l];
+	}
+
+      if(auto_normal_flag)
+	{
+	  if(em_vertex.k ==4)
+	    inComputeFirstPartials(temp_vertex, tdu, tdv);
+
+#ifdef AVOID_ZERO_NORMAL
+	  if((myabs(tdv[0]) <= MYZERO && myabs(tdv[1]) <= MYZERO && myabs(tdv[2]) <= MYZERO)
+	     || (myabs(tdu[0]) <= MYZERO && myabs(tdu[1]) <= MYZERO && myabs(tdu[2]) <= MYZERO))
+	    {
+	      /*the derivatives are re-evaluated at a nearby point*/
+	      inDoEvalCoord2EM(u[l], v[l]);
+	      continue;
+	    }
+#endif
+	  inComputeNormal2(tdu, tdv, temp_normal);
+	}
+
+      if(em_vertex.k == 4)
+	{
+	  temp_vertex[0] /= temp_vertex[3];
+	  temp_vertex[1] /= temp_vertex[3];
+	  temp_vertex[2] /= temp_vertex[3];
+	}
+      temp_vertex[3] = u[l];
+      temp_vertex[4] = v[l];
+
+      if(auto_normal_flag)
+	normalCallBack(temp_normal, userData);
+      vertexCallBack(temp_vertex, userData);
+    }
+}
+
+
 void OpenGLSurfaceEvaluator::inBPMEvalEM(bezierPatchMesh* bpm)
 {
   int i,j,k;
@@ -2012,6 +2228,23 @@ return;
 
       beginCallBack(bpm->type_array[i], userData);
 
+#if !defined(USE_LOD) && !defined(GENERIC_TEST)
+      /*batched only when no normal, color or texcoord map is active*/
+      if(vertex_flag && !normal_flag && !color_flag && !texcoord_flag
+	 && em_vertex.u2 != em_vertex.u1 && em_vertex.v2 != em_vertex.v1)
+	{
+	  int n;
+	  for(j=0; j<bpm->length_array[i]; j += n)
+	    {
+	      n = bpm->length_array[i] - j;
+	      if(n > IN_EVAL_BATCH)
+		n = IN_EVAL_BATCH;
+	      inDoEvalCoord2BatchEM(n, bpm->UVarray+k);
+	      k += 2*n;
+	    }
+	}
+      else
+#endif
       for(j=0; j<bpm->length_array[i]; j++)
 	{
 	  u = bpm->UVarray[k];
@@ -2062,3 +2295,116 @@ void OpenGLSurfaceEvaluator::inBPMListEvalEM(bezierPatchMesh* list)
     }
 }
 
+void OpenGLSurfaceEvaluator::inBPMRunEvalEM(bezierPatchMesh** patches, int n)
+{
+  int i;
+  for(i=0; i<n; i++)
+    inBPMEvalEM(patches[i]);
+}
+
+/*GLU_NURBS_THREADS_EXT: the patches of a list are evaluated independently
+ *of each other, so the list is cut into runs with about the same number
+ *of points. This thread evaluates the first run straight to the callbacks.
+ *Each other run is evaluated by a worker evaluator on a thread of its own
+ *into an EvalRecorder, which is replayed here in list order, so the client
+ *sees exactly the calls inBPMListEvalEM would make.
+ *A run whose thread cannot be started or whose recorder runs out of memory
+ *is evaluated on this thread instead.
+ */
+void OpenGLSurfaceEvaluator::inBPMListEvalParallelEM(bezierPatchMesh* list)
+{
+  bezierPatchMesh* temp;
+  bezierPatchMesh** patches;
+  std::thread threads[IN_MAX_THREADS];
+  int started[IN_MAX_THREADS];
+  int start[IN_MAX_THREADS+1];
+  long total = 0;
+  long sum;
+  int n = 0;
+  int nthreads;
+  int c, i;
+
+  for(temp = list; temp != NULL; temp = temp->next)
+    {
+      n++;
+      total += temp->index_UVarray/2;
+    }
+
+  nthreads = (num_threads < n) ? num_threads : n;
+  if(nthreads < 2 || total < IN_PARALLEL_MIN_POINTS)
+    {
+      inBPMListEvalEM(list);
+      return;
+    }
+
+  patches = (bezierPatchMesh**) arenaMalloc(sizeof(bezierPatchMesh*) * n);
+  if(patches == NULL)
+    {
+      inBPMListEvalEM(list);
+      return;
+    }
+  for(i=0, temp = list; temp != NULL; temp = temp->next)
+    patches[i++] = temp;
+
+  /*run c is patches[start[c]] .. patches[start[c+1]-1]*/
+  start[0] = 0;
+  sum = 0;
+  for(c=1, i=0; c<nthreads; c++)
+    {
+      while(i < n && sum < total * c / nthreads)
+	sum += patches[i++]->index_UVarray/2;
+      start[c] = i;
+    }
+  start[nthreads] = n;
+
+  for(c=1; c<nthreads; c++)
+    {
+      started[c] = 0;
+      if(start[c] == start[c+1])
+	continue;
+
+      if(workers[c] == NULL)
+	{
+	  workers[c] = new OpenGLSurfaceEvaluator;
+	  workers[c]->recorder = new EvalRecorder;
+	}
+      OpenGLSurfaceEvaluator* w = workers[c];
+      w->recorder->clear();
+      w->auto_normal_flag = auto_normal_flag;
+      w->vertex_flag = vertex_flag;
+      w->normal_flag = normal_flag;
+      w->color_flag = color_flag;
+      w->texcoord_flag = texcoord_flag;
+
+      try
+	{
+	  threads[c] = std::thread(&OpenGLSurfaceEvaluator::inBPMRunEvalEM, w,
+				   patches + start[c], start[c+1] - start[c]);
+	  started[c] = 1;
+	}
+      catch(...)
+	{
+	}
+    }
+
+  inBPMRunEvalEM(patches, start[1]);
+
+  for(c=1; c<nthreads; c++)
+    {
+      if(start[c] == start[c+1])
+	continue;
+      if(started[c])
+	{
+	  threads[c].join();
+	  if(! workers[c]->recorder->failed)
+	    {
+	      replay(workers[c]->recorder);
+	      continue;
+	    }
+	}
+      inBPMRunEvalEM(patches + start[c], start[c+1] - start[c]);
+    }
+
+  arenaFree(patches);
+}
+
@@ -0,0 +1,159 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+/*
+ * arena.c++
+ *
+ */
+
+#include "glimports.h"
+#include "arena.h"
+
+thread_local Arena *Arena::active = 0;
+
+Arena::Arena( void )
+{
+    blocks = 0;
+    next = 0;
+    end = 0;
+    size = 0;
+    filled = 0;
+    limit = ARENA_LIMIT;
+    heapAllocations = 0;
+}
+
+Arena::~Arena( void )
+{
+    release();
+}
+
+void
+Arena::release( void )
+{
+    while( blocks ) {
+	ArenaBlock *b = blocks;
+	blocks = b->next;
+	free( b );
+    }
+    next = end = 0;
+    size = 0;
+    filled = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Arena::setLimit - set the most memory reset() keeps between passes; what
+ * the arena holds above it is given back at once unless a pass is running
+ *-----------------------------------------------------------------------------
+ */
+void
+Arena::setLimit( size_t n )
+{
+    limit = n;
+    if( size > limit && active != this )
+	release();
+}
+
+/*-----------------------------------------------------------------------------
+ * Arena::grow - start a new block large enough for n bytes; each block is
+ * at least as large as all the earlier ones together
+ *-----------------------------------------------------------------------------
+ */
+void *
+Arena::grow( size_t n )
+{
+    size_t bsize = (size < ARENA_BLOCKSIZE) ? ARENA_BLOCKSIZE : size;
+    if( bsize < n )
+	bsize = n;
+
+    ArenaBlock *b = (ArenaBlock *) malloc( sizeof(ArenaBlock) + bsize );
+    if( b == 0 )
+	return 0;
+    heapAllocations++;
+
+    if( blocks )
+	filled += next - (char *) (blocks + 1);
+    b->next = blocks;
+    b->size = bsize;
+    blocks = b;
+    size += bsize;
+
+    next = (char *) (b + 1) + n;
+    end = (char *) (b + 1) + bsize;
+    return (void *) (b + 1);
+}
+
+int
+Arena::owns( const void *p )
+{
+    const char *c = (const char *) p;
+    for( ArenaBlock *b = blocks; b; b = b->next )
+	if( c >= (char *) (b + 1) && c < (char *) (b + 1) + b->size )
+	    return 1;
+    return 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Arena::reset - release everything allocated since the last reset.  The
+ * arena keeps one block of what the pass used, rounded up to a whole
+ * ARENA_BLOCKSIZE and at most the limit.  A single block that would still
+ * do is kept unless it is more than twice that, so surfaces of slightly
+ * different sizes do not take turns reallocating it.
+ *-----------------------------------------------------------------------------
+ */
+void
+Arena::reset( void )
+{
+    if( blocks == 0 )
+	return;
+
+    size_t used = filled + (next - (char *) (blocks + 1));
+    size_t keep = ARENA_BLOCKSIZE;
+    if( used > keep )
+	keep = (used + ARENA_BLOCKSIZE - 1) / ARENA_BLOCKSIZE * ARENA_BLOCKSIZE;
+    if( keep > limit )
+	keep = limit;
+
+    if( blocks->next || blocks->size > limit || blocks->size > 2 * keep ) {
+	release();
+	if( keep == 0 )
+	    return;
+	ArenaBlock *b = (ArenaBlock *) malloc( sizeof(ArenaBlock) + keep );
+	if( b == 0 )
+	    return;
+	heapAllocations++;
+	b->next = 0;
+	b->size = keep;
+	blocks = b;
+	size = keep;
+    }
+
+    next = (char *) (blocks + 1);
+    end = next + blocks->size;
+}
@@ -0,0 +1,142 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+/*
+ * arena.h
+ *
+ * Bump allocator for the memory a NurbsTessellator needs while it
+ * tessellates one surface or curve.  Everything taken from the arena is
+ * released together by Arena::reset() once the pass is over; the arena
+ * keeps as much memory as the pass used, up to its limit, so tessellating
+ * similar surfaces again does not go back to the heap at all, while one
+ * dense surface does not pin its memory to the object.
+ *
+ * Code that has no tessellator at hand (nurbtess, the surface evaluator)
+ * reaches the arena through Arena::current(), which ArenaScope sets for
+ * the duration of a pass.  arenaMalloc()/arenaFree() fall back to the
+ * heap when no pass is running.
+ */
+
+#ifndef __gluarena_h_
+#define __gluarena_h_
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#define ARENA_BLOCKSIZE	(64 * 1024)
+#define ARENA_LIMIT	(1024 * 1024)	/* default most kept by reset() */
+
+struct ArenaBlock {
+    ArenaBlock		*next;
+    size_t		size;		/* usable bytes after the header */
+};
+
+class Arena {
+public:
+			Arena( void );
+			~Arena( void );
+    inline void *	alloc( size_t );
+    int			owns( const void * );
+    void		reset( void );
+
+    size_t		getSize( void ) { return size; }
+    size_t		getLimit( void ) { return limit; }
+    void		setLimit( size_t );
+    long		heapAllocations;	/* blocks taken from the heap */
+
+    static inline Arena *current( void ) { return active; }
+
+private:
+    friend class	ArenaScope;
+    void *		grow( size_t );
+    void		release( void );
+
+    ArenaBlock		*blocks;		/* newest first */
+    char		*next;			/* free space in blocks */
+    char		*end;
+    size_t		size;			/* bytes held in blocks */
+    size_t		filled;			/* used in older blocks */
+    size_t		limit;			/* most kept by reset() */
+
+    static thread_local Arena *active;
+};
+
+/* Makes an arena current for the lifetime of the scope, or none, so
+ * that memory which outlives the pass of another tessellator (a callback
+ * may define a surface on a second GLUnurbs object) comes from the heap.
+ */
+class ArenaScope {
+public:
+			ArenaScope( Arena &a ) : prev( Arena::active )
+				{ Arena::active = &a; }
+			ArenaScope( void ) : prev( Arena::active )
+				{ Arena::active = 0; }
+			~ArenaScope( void ) { Arena::active = prev; }
+private:
+    Arena		*prev;
+};
+
+#define ARENA_ALIGN	16
+
+inline void *
+Arena::alloc( size_t n )
+{
+    n = (n + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+    if( (size_t) (end - next) < n )
+	return grow( n );
+    void *p = next;
+    next += n;
+    return p;
+}
+
+inline void *
+arenaMalloc( size_t n )
+{
+    Arena *a = Arena::current();
+    return a ? a->alloc( n ) : malloc( n );
+}
+
+/* Memory of the current arena is left for Arena::reset(). */
+inline void
+arenaFree( void *p )
+{
+    Arena *a = Arena::current();
+    if( a == 0 || ! a->owns( p ) )
+	free( p );
+}
+
+/* Base for objects that are created and destroyed within a pass. */
+class ArenaObj {
+public:
+    inline void *	operator new( size_t s ) { return arenaMalloc( s ); }
+    inline void		operator delete( void *p ) { arenaFree( p ); }
+};
+
+#endif /* __gluarena_h_ */
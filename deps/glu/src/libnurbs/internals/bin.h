@@ -99,7 +99,7 @@ Bin::nextarc( void )
     Arc_ptr jarc = current;
 
 #ifdef DEBUG
-    assert( jarc->check() != 0 );
+    assert( jarc == 0 || jarc->check() != 0 );
 #endif
 
     if( jarc ) current = jarc->link;
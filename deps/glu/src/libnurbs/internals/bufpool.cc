@@ -74,9 +74,9 @@ Pool::~Pool( void )
 {
     assert( (this != 0) && (magic == is_allocated) );
 
-    while( nextblock ) {
-	delete [] blocklist[--nextblock];
-        blocklist[nextblock] = 0;
+    for( int i = 0; i < NBLOCKS; i++ ) {
+	delete [] blocklist[i];
+        blocklist[i] = 0;
     }
     magic = is_free;
 }
@@ -85,14 +85,18 @@ Pool::~Pool( void )
 void Pool::grow( void )
 {
     assert( (this != 0) && (magic == is_allocated) );
-    curblock = new char[nextsize];
-    blocklist[nextblock++] = curblock;
+    if( blocklist[nextblock] == 0 )
+	blocklist[nextblock] = new char[nextsize];
+    curblock = blocklist[nextblock++];
     nextfree = nextsize;
     nextsize *= 2;
 }
 
 /*-----------------------------------------------------------------------------
  * Pool::clear - free buffers associated with pool but keep pool 
+ *
+ * The memory blocks are kept as well: block i is always initsize << i
+ * bytes, so the pool grows back into them without going to the heap.
  *-----------------------------------------------------------------------------
  */
 
@@ -101,13 +105,9 @@ Pool::clear( void )
 {
     assert( (this != 0) && (magic == is_allocated) );
 
-    while( nextblock ) {
-	delete [] blocklist[--nextblock];
-	blocklist[nextblock] = 0;
-    }
+    nextblock	= 0;
     curblock	= 0;
     freelist	= 0;
     nextfree	= 0;
-    if( nextsize > initsize )
-        nextsize /= 2;
+    nextsize	= initsize;
 }
@@ -155,6 +155,20 @@ NurbsTessellator::endsurface( void )
     THREAD2( do_endsurface );
 }
 
+/*-----------------------------------------------------------------------------
+ * discardsurface - make the next endsurface free the surface being defined
+ *		    without displaying it
+ *
+ * Client: GLUnurbs, when it already has the result
+ *-----------------------------------------------------------------------------
+ */
+void
+NurbsTessellator::discardsurface( void )
+{
+    if( inSurface )
+	isDataValid = 0;
+}
+
 
 /*-----------------------------------------------------------------------------
  * bgntrim - allocate and initialize a new trim loop structure (o_trim )
@@ -254,6 +268,9 @@ NurbsTessellator::pwlcurve( long count, INREAL array[], long byte_stride, long t
     }
 #endif
 
+    /* the vertices are kept until the surface is drawn, so they must not
+       come from the arena of a pass that is running now */
+    ArenaScope scope;
     O_pwlcurve	*o_pwlcurve = new(o_pwlcurvePool) O_pwlcurve( type, count, array, byte_stride, extTrimVertexPool.get((int)count) );
     THREAD( do_pwlcurve, o_pwlcurve, do_freepwlcurve );
 }
@@ -71,6 +71,7 @@ void
 NurbsTessellator::resetObjects( void )
 {
     subdivider.clear();
+    arena.reset();
 }
 
 void
@@ -204,6 +205,7 @@ NurbsTessellator::do_endcurve( void )
 	    return;
         }
 
+	ArenaScope scope( arena );
 	int errval;
 	errval = ::mysetjmp( jumpbuffer );
 	if( errval == 0 ) {
@@ -261,6 +263,7 @@ NurbsTessellator::do_endsurface( void )
         *nextTrim = 0;
     }
 
+    ArenaScope scope( arena );
     int errval;
 
     errval = ::mysetjmp( jumpbuffer );
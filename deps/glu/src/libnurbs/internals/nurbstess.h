@@ -43,6 +43,7 @@
 #include "maplist.h"
 #include "reader.h"
 #include "nurbsconsts.h"
+#include "arena.h"
 
 struct Knotvector;
 class Quilt;
@@ -76,6 +77,7 @@ public:
 
     void     		bgnsurface( long );
     void     		endsurface( void );
+    void		discardsurface( void );
     void     		bgntrim( void );
     void     		endtrim( void );
     void     		bgncurve( long );
@@ -142,6 +144,7 @@ private:
     Pool		propertyPool;
 public:
     Pool		quiltPool;
+    Arena		arena;			/* memory of one tessellation */
 private:
     TrimVertexPool	extTrimVertexPool;
 
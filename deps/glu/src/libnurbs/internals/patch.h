@@ -38,6 +38,7 @@
 
 #include "types.h"
 #include "defines.h"
+#include "arena.h"
 
 class Quilt;
 class Mapdesc;
@@ -59,7 +60,7 @@ struct Patchspec : public Pspec {
     void		singleStep( void );    
 };
 
-class Patch {
+class Patch : public ArenaObj {
 public:
 friend class Subdivider;
 friend class Quilt;
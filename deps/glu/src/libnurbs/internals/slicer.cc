@@ -51,6 +51,7 @@
 #include "simplemath.h"
 #include "trimvertex.h"
 #include "varray.h"
+#include "arena.h"
 
 #include "polyUtil.h" //for area()
 
@@ -619,7 +620,7 @@ static void triangulateRectTopGen(Arc_ptr arc, int n_ulines, REAL* u_val, Real v
   if(is_u)
     {
       int i,k;
-      REAL* upper_val = (REAL*) malloc(sizeof(REAL) * arc->pwlArc->npts);
+      REAL* upper_val = (REAL*) arenaMalloc(sizeof(REAL) * arc->pwlArc->npts);
       assert(upper_val);
       if(dir)
 	{
@@ -645,13 +646,13 @@ static void triangulateRectTopGen(Arc_ptr arc, int n_ulines, REAL* u_val, Real v
 			     );	 
 	}
 
-      free(upper_val);
+      arenaFree(upper_val);
       return;
     }
   else //is_v
     {
       int i,k;
-      REAL* left_val = (REAL*) malloc(sizeof(REAL) * arc->pwlArc->npts);
+      REAL* left_val = (REAL*) arenaMalloc(sizeof(REAL) * arc->pwlArc->npts);
       assert(left_val);   
       if(dir)
 	{
@@ -674,7 +675,7 @@ static void triangulateRectTopGen(Arc_ptr arc, int n_ulines, REAL* u_val, Real v
 			     arc->pwlArc->npts, arc->pwlArc->pts[0].param[0], left_val
 			     );	
 	}
-      free(left_val);
+      arenaFree(left_val);
       return;
     }
 	
@@ -691,7 +692,7 @@ static void triangulateRectTopGen(Arc_ptr arc, int n_ulines, REAL* u_val, Real v
   REAL* temp_u_val = u_val;
   if(dir ==0) //have to reverse u_val
     {
-      temp_u_val = (REAL*) malloc(sizeof(REAL) * n_ulines);
+      temp_u_val = (REAL*) arenaMalloc(sizeof(REAL) * n_ulines);
       assert(temp_u_val);
       for(i=0; i<n_ulines; i++)
 	temp_u_val[i] = u_val[n_ulines-1-i];
@@ -769,7 +770,7 @@ static void triangulateRectTopGen(Arc_ptr arc, int n_ulines, REAL* u_val, Real v
 
   }
   if(dir == 0)  //temp_u_val was mallocated
-    free(temp_u_val);
+    arenaFree(temp_u_val);
  */
 }
 
@@ -830,9 +831,9 @@ static void triangulateRectGen(Arc_ptr loop, int n_ulines, int n_vlines, Backend
     backend.surfmesh(0,0,n_ulines+1,n_vlines+1);
 return;
 */
-  REAL* u_val=(REAL*) malloc(sizeof(REAL)*n_ulines);
+  REAL* u_val=(REAL*) arenaMalloc(sizeof(REAL)*n_ulines);
   assert(u_val);
-  REAL* v_val=(REAL*)malloc(sizeof(REAL) * n_vlines);
+  REAL* v_val=(REAL*)arenaMalloc(sizeof(REAL) * n_vlines);
   assert(v_val);
   REAL u_stepsize = (right->tail()[0] - left->tail()[0])/( (REAL) n_ulines+1);
   REAL v_stepsize = (top->tail()[1] - bot->tail()[1])/( (REAL) n_vlines+1);
@@ -860,8 +861,8 @@ return;
   //triangulate the center
   triangulateRectCenter(n_ulines, u_val, n_vlines, v_val, backend);
 
-  free(u_val);
-  free(v_val);
+  arenaFree(u_val);
+  arenaFree(v_val);
   
 }
 
@@ -964,7 +965,7 @@ directedLine* arcLoopToDLineLoop(Arc_ptr loop)
 /*
 void Slicer::evalRBArray(rectBlockArray* rbArray, gridWrap* grid)
 {
-  TrimVertex *trimVert = (TrimVertex*)malloc(sizeof(TrimVertex));
+  TrimVertex *trimVert = (TrimVertex*)arenaMalloc(sizeof(TrimVertex));
   trimVert -> nuid = 0;//????
 
   Real* u_values = grid->get_u_values();
@@ -994,7 +995,7 @@ void Slicer::evalRBArray(rectBlockArray* rbArray, gridWrap* grid)
 	}
     }
   
-  free(trimVert);
+  arenaFree(trimVert);
 }
 */
 
@@ -1029,7 +1030,7 @@ void Slicer::evalStream(primStream* pStream)
   Int i,j,k;
   k=0;
 /*  TrimVertex X;*/
-  TrimVertex *trimVert =/*&X*/  (TrimVertex*)malloc(sizeof(TrimVertex));
+  TrimVertex *trimVert =/*&X*/  (TrimVertex*)arenaMalloc(sizeof(TrimVertex));
   trimVert -> nuid = 0;//???
   Real* vertices = pStream->get_vertices(); //for efficiency
   for(i=0; i<pStream->get_n_prims(); i++)
@@ -1059,7 +1060,7 @@ void Slicer::evalStream(primStream* pStream)
 
       }
     }
-  free(trimVert);
+  arenaFree(trimVert);
 }
 	   
 	   
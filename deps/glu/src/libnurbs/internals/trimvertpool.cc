@@ -44,6 +44,7 @@
 #include "trimvertex.h"
 #include "trimvertpool.h"
 #include "bufpool.h"
+#include "arena.h"
 
 /*----------------------------------------------------------------------------
  * TrimVertexPool::TrimVertexPool 
@@ -66,7 +67,7 @@ TrimVertexPool::~TrimVertexPool( void )
 {
     // free all arrays of TrimVertices vertices
     while( nextvlistslot ) {
-	delete [] vlist[--nextvlistslot];
+	arenaFree( vlist[--nextvlistslot] );
     }
 
     // reallocate space for array of pointers to vertex lists
@@ -83,15 +84,12 @@ TrimVertexPool::clear( void )
     // reinitialize pool of 3 vertex arrays    
     pool.clear();
 
-    // free all arrays of TrimVertices vertices
+    // free all arrays of TrimVertices vertices; during a tessellation
+    // they come from the tessellator's arena
     while( nextvlistslot ) {
-	delete [] vlist[--nextvlistslot];
+	arenaFree( vlist[--nextvlistslot] );
 	vlist[nextvlistslot] = 0;
     }
-
-    // reallocate space for array of pointers to vertex lists
-    if( vlist ) delete[] vlist;
-    vlist = new TrimVertex_p[vlistsize];
 }
 
 
@@ -113,7 +111,8 @@ TrimVertexPool::get( int n )
 	    if( vlist ) delete[] vlist;
 	    vlist = nvlist;
         }
-        v = vlist[nextvlistslot++] = new TrimVertex[n];
+        v = vlist[nextvlistslot++] =
+	    (TrimVertex *) arenaMalloc( sizeof(TrimVertex) * n );
     }
     return v;
 }
@@ -44,6 +44,7 @@
 #include "quicksort.h"
 #include "directedLine.h"
 #include "polyDBG.h"
+#include "arena.h"
 
 #ifdef __WATCOMC__
 #pragma warning 726 10
@@ -567,7 +568,7 @@ Int directedLine::toArraySinglePolygon(directedLine** array, Int index)
 directedLine** directedLine::toArrayAllPolygons(Int& total_num_edges)
 {
   total_num_edges=numEdgesAllPolygons();
-  directedLine** ret = (directedLine**) malloc(sizeof(directedLine*) * total_num_edges);
+  directedLine** ret = (directedLine**) arenaMalloc(sizeof(directedLine*) * total_num_edges);
   assert(ret);
 
   directedLine *temp;
@@ -38,7 +38,7 @@
 
 enum {INCREASING, DECREASING};
 
-class directedLine {
+class directedLine : public ArenaObj {
   short direction; /*INCREASING or DECREASING*/
   sampledLine* sline;
   directedLine* next; /*double linked list*/
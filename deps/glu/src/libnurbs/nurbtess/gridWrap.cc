@@ -41,6 +41,7 @@
 #include <GL/gl.h>
 #include "zlassert.h"
 #include "gridWrap.h"
+#include "arena.h"
 
 
 /*******************grid structure****************************/
@@ -64,9 +65,9 @@ gridWrap::gridWrap(Int nUlines, Real* uvals,
   u_max = uvals[nUlines-1];
   v_min = vvals[0];
   v_max = vvals[nVlines-1];
-  u_values = (Real*) malloc(sizeof(Real) * n_ulines);
+  u_values = (Real*) arenaMalloc(sizeof(Real) * n_ulines);
   assert(u_values);
-  v_values = (Real*) malloc(sizeof(Real) * n_vlines);
+  v_values = (Real*) arenaMalloc(sizeof(Real) * n_vlines);
   assert(v_values);  
   
   Int i;
@@ -88,9 +89,9 @@ gridWrap::gridWrap(Int nUlines, Int nVlines,
   u_max = uMax;
   v_min = vMin;
   v_max = vMax;
-  u_values = (Real*) malloc(sizeof(Real) * n_ulines);
+  u_values = (Real*) arenaMalloc(sizeof(Real) * n_ulines);
   assert(u_values);
-  v_values = (Real*) malloc(sizeof(Real) * n_vlines);
+  v_values = (Real*) arenaMalloc(sizeof(Real) * n_vlines);
   assert(v_values);
   
   Int i;
@@ -120,8 +121,8 @@ gridWrap::gridWrap(Int nUlines, Int nVlines,
 
 gridWrap::~gridWrap()
 {
-  free(u_values);
-  free(v_values);
+  arenaFree(u_values);
+  arenaFree(v_values);
 }
 
 void gridWrap::draw()
@@ -183,13 +184,13 @@ gridBoundaryChain::gridBoundaryChain(
 				     )
 : grid(gr), firstVlineIndex(first_vline_index), nVlines(n_vlines)
 {
-  ulineIndices = (Int*) malloc(sizeof(Int) * n_vlines);
+  ulineIndices = (Int*) arenaMalloc(sizeof(Int) * n_vlines);
   assert(ulineIndices);
 
-  innerIndices = (Int*) malloc(sizeof(Int) * n_vlines);
+  innerIndices = (Int*) arenaMalloc(sizeof(Int) * n_vlines);
   assert(innerIndices);
 
-  vertices = (Real2*) malloc(sizeof(Real2) * n_vlines);
+  vertices = (Real2*) arenaMalloc(sizeof(Real2) * n_vlines);
   assert(vertices);
   
 
@@ -38,6 +38,7 @@
 
 #include "primitiveStream.h"
 #include "zlassert.h"
+#include "arena.h"
 
 class gridWrap{
   Int n_ulines;
@@ -93,7 +94,7 @@ public:
   Int isUniform() {return is_uniform;}
 };
 
-class gridBoundaryChain{
+class gridBoundaryChain : public ArenaObj {
   gridWrap* grid;
   Int firstVlineIndex;
   Int nVlines;
@@ -109,9 +110,9 @@ public:
 
   ~gridBoundaryChain()
     {
-      free(innerIndices);
-      free(ulineIndices);
-      free(vertices);
+      arenaFree(innerIndices);
+      arenaFree(ulineIndices);
+      arenaFree(vertices);
     }
 
   /*i indexes the vlines in this chain.
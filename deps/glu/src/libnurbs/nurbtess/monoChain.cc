@@ -47,6 +47,7 @@
 #include "quicksort.h"
 #include "searchTree.h"
 #include "polyUtil.h"
+#include "arena.h"
 
 #ifndef max
 #define max(a,b) ((a>b)? a:b)
@@ -174,7 +175,7 @@ Int monoChain::toArraySingleLoop(monoChain** array, Int index)
 monoChain** monoChain::toArrayAllLoops(Int& num_chains)
 {
   num_chains = numChainsAllLoops();
-  monoChain **ret =  (monoChain**) malloc(sizeof(monoChain*) * num_chains);
+  monoChain **ret =  (monoChain**) arenaMalloc(sizeof(monoChain*) * num_chains);
   assert(ret);
   monoChain *temp;
   Int index = 0;
@@ -654,7 +655,7 @@ directedLine* MC_partitionY(directedLine *polygons, sampledLine **retSampledLine
   if(total_num_chains<=2) //there is just one single monotone polygon
     {
       loopList->deleteLoopList();
-      free(array); 
+      arenaFree(array); 
       *retSampledLines = NULL;
       return polygons;
     }
@@ -664,13 +665,13 @@ directedLine* MC_partitionY(directedLine *polygons, sampledLine **retSampledLine
   quicksort( (void**)array, 0, total_num_chains-1, (Int (*)(void*, void*))compChainHeadInY);
 //printf("after quicksort\n");  
 
-  sweepRange** ranges = (sweepRange**)malloc(sizeof(sweepRange*) * (total_num_chains));
+  sweepRange** ranges = (sweepRange**)arenaMalloc(sizeof(sweepRange*) * (total_num_chains));
   assert(ranges);
 
   if(MC_sweepY(total_num_chains, array, ranges))
     {
       loopList->deleteLoopList();
-      free(array); 
+      arenaFree(array); 
       *retSampledLines = NULL;
       return NULL;
     }
@@ -679,7 +680,7 @@ directedLine* MC_partitionY(directedLine *polygons, sampledLine **retSampledLine
 
   Int num_diagonals;
   /*number diagonals is < total_num_edges*total_num_edges*/
-  directedLine** diagonal_vertices = (directedLine**) malloc(sizeof(directedLine*) * total_num_chains*2/*total_num_edges*/);
+  directedLine** diagonal_vertices = (directedLine**) arenaMalloc(sizeof(directedLine*) * total_num_chains*2/*total_num_edges*/);
   assert(diagonal_vertices);
 
 //printf("before call MC_findDiagonales\n");
@@ -703,7 +704,7 @@ directedLine* MC_partitionY(directedLine *polygons, sampledLine **retSampledLine
 //    printf("**(%f,%f)\n", diagonal_vertices[2*i+1]->head()[0], diagonal_vertices[2*i+1]->head()[1]);
 //  }
 
-  Int *removedDiagonals=(Int*)malloc(sizeof(Int) * num_diagonals);
+  Int *removedDiagonals=(Int*)arenaMalloc(sizeof(Int) * num_diagonals);
   for(i=0; i<num_diagonals; i++)
     removedDiagonals[i] = 0;
 //  printf("first pass\n");
@@ -924,10 +925,10 @@ ret_p2->rootLinkSet(root1);
 
   //clean up
   loopList->deleteLoopList();
-  free(array);
-  free(ranges);
-  free(diagonal_vertices);
-  free(removedDiagonals);
+  arenaFree(array);
+  arenaFree(ranges);
+  arenaFree(diagonal_vertices);
+  arenaFree(removedDiagonals);
 
   *retSampledLines = newSampledLines;
   return ret_polygons;
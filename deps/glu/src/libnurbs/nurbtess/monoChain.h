@@ -38,7 +38,7 @@
 
 class monoChain;
 
-class monoChain{
+class monoChain : public ArenaObj {
   directedLine* chainHead;
   directedLine* chainTail;
   monoChain* next;
@@ -45,6 +45,7 @@
 #include "polyUtil.h" /*for area*/
 #include "partitionX.h"
 #include "monoPolyPart.h"
+#include "arena.h"
 
 
 
@@ -56,7 +57,7 @@ void monoTriangulationOpt(directedLine* poly, primStream* pStream)
 {
   Int n_cusps;
   Int n_edges = poly->numEdges();
-  directedLine** cusps = (directedLine**) malloc(sizeof(directedLine*)*n_edges);
+  directedLine** cusps = (directedLine**) arenaMalloc(sizeof(directedLine*)*n_edges);
   assert(cusps);
   findInteriorCuspsX(poly, n_cusps, cusps);
   if(n_cusps ==0) //u monotine
@@ -98,7 +99,7 @@ void monoTriangulationOpt(directedLine* poly, primStream* pStream)
       monoTriangulationFun(poly, compV2InY, pStream);    
     }
   
-  free(cusps);
+  arenaFree(cusps);
 }
 
 void monoTriangulationRecOpt(Real* topVertex, Real* botVertex, 
@@ -388,7 +389,7 @@ void  monoTriangulationRecGenOpt(Real* topVertex, Real* botVertex,
   {
     Int n_cusps;
     Int n_edges = poly->numEdges();
-    directedLine** cusps = (directedLine**) malloc(sizeof(directedLine*)*n_edges);
+    directedLine** cusps = (directedLine**) arenaMalloc(sizeof(directedLine*)*n_edges);
     assert(cusps);
     findInteriorCuspsX(poly, n_cusps, cusps);
 
@@ -441,7 +442,7 @@ void  monoTriangulationRecGenOpt(Real* topVertex, Real* botVertex,
         
       }
 
-    free(cusps);
+    arenaFree(cusps);
     /*
       if(numInteriorCuspsX(poly) == 0) //is u monotone
 	monoTriangulationFun(poly, compV2InX, pStream);
@@ -1119,7 +1120,7 @@ vertexArray::vertexArray(Real2* vertices, Int nVertices)
 {
   Int i;
   size = index = nVertices;
-  array = (Real**) malloc(sizeof(Real*) * nVertices);
+  array = (Real**) arenaMalloc(sizeof(Real*) * nVertices);
   assert(array);
   for(i=0; i<nVertices; i++)
     {
@@ -1131,25 +1132,25 @@ vertexArray::vertexArray(Real2* vertices, Int nVertices)
 vertexArray::vertexArray(Int s)
 {
   size = s;
-  array = (Real**) malloc(sizeof(Real*) * s);
+  array = (Real**) arenaMalloc(sizeof(Real*) * s);
   assert(array);
   index = 0;
 }
 
 vertexArray::~vertexArray()
 {
-  free(array);
+  arenaFree(array);
 }
 
 void vertexArray::appendVertex(Real* ptr)
 {
   Int i;
   if(index >= size){
-    Real** temp = (Real**) malloc(sizeof(Real*) * (2*size +1));
+    Real** temp = (Real**) arenaMalloc(sizeof(Real*) * (2*size +1));
     assert(temp);
     for(i=0; i<index; i++)
       temp[i] = array[i];
-    free(array);
+    arenaFree(array);
     array = temp;
     size = 2*size+1;
   }
@@ -1341,7 +1342,7 @@ Int vertexArray::skipEqualityFromStart(Real v, Int start, Int end)
 
 reflexChain::reflexChain(Int size, Int is_increasing)
 {
-  queue = (Real2*) malloc(sizeof(Real2) * size);
+  queue = (Real2*) arenaMalloc(sizeof(Real2) * size);
   assert(queue);
   index_queue = 0;
   size_queue = size;
@@ -1350,7 +1351,7 @@ reflexChain::reflexChain(Int size, Int is_increasing)
 
 reflexChain::~reflexChain()
 {
-  free(queue);
+  arenaFree(queue);
 }
 
 /*put (u,v) at the end of the queue
@@ -1360,7 +1361,7 @@ void reflexChain::insert(Real u, Real v)
 {
   Int i;
   if(index_queue >= size_queue) {
-    Real2 *temp = (Real2*) malloc(sizeof(Real2) * (2*size_queue+1));
+    Real2 *temp = (Real2*) arenaMalloc(sizeof(Real2) * (2*size_queue+1));
     assert(temp);
 
     /*copy*/
@@ -1369,7 +1370,7 @@ void reflexChain::insert(Real u, Real v)
       temp[i][1] = queue[i][1];
     }
     
-    free(queue);
+    arenaFree(queue);
     queue = temp;
     size_queue = 2*size_queue + 1;
   }
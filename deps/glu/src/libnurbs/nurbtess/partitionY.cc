@@ -44,6 +44,7 @@
 #include "searchTree.h"
 #include "quicksort.h"
 #include "polyUtil.h"
+#include "arena.h"
 
 
 #define max(a,b) ((a>b)? a:b)
@@ -150,7 +151,7 @@ Int cuspType(directedLine *v)
 sweepRange* sweepRangeMake(directedLine* left, Int leftType,
 			   directedLine* right, Int rightType)
 {
-  sweepRange* ret = (sweepRange*)malloc(sizeof(sweepRange));
+  sweepRange* ret = (sweepRange*)arenaMalloc(sizeof(sweepRange));
   assert(ret);
   ret->left = left;
   ret->leftType = leftType;
@@ -161,7 +162,7 @@ sweepRange* sweepRangeMake(directedLine* left, Int leftType,
 
 void sweepRangeDelete(sweepRange* range)
 {
-  free(range);
+  arenaFree(range);
 }
 
 Int sweepRangeEqual(sweepRange* src1, sweepRange* src2)
@@ -428,12 +429,12 @@ directedLine** DBGfindDiagonals(directedLine *polygons, Int& num_diagonals)
   Int total_num_edges = 0;
   directedLine** array = polygons->toArrayAllPolygons(total_num_edges);
   quicksort( (void**)array, 0, total_num_edges-1, (Int (*)(void*, void*)) compInY);
-  sweepRange** ranges = (sweepRange**) malloc(sizeof(sweepRange*) * total_num_edges);
+  sweepRange** ranges = (sweepRange**) arenaMalloc(sizeof(sweepRange*) * total_num_edges);
   assert(ranges);
 
   sweepY(total_num_edges, array, ranges);
 
- directedLine** diagonal_vertices = (directedLine**) malloc(sizeof(directedLine*) * total_num_edges);
+ directedLine** diagonal_vertices = (directedLine**) arenaMalloc(sizeof(directedLine*) * total_num_edges);
   assert(diagonal_vertices);
   findDiagonals(total_num_edges, array, ranges, num_diagonals, diagonal_vertices);
 
@@ -451,7 +452,7 @@ directedLine* partitionY(directedLine *polygons, sampledLine **retSampledLines)
 
   quicksort( (void**)array, 0, total_num_edges-1, (Int (*)(void*, void*)) compInY);
 
-  sweepRange** ranges = (sweepRange**) malloc(sizeof(sweepRange*) * (total_num_edges));
+  sweepRange** ranges = (sweepRange**) arenaMalloc(sizeof(sweepRange*) * (total_num_edges));
   assert(ranges);
 
 
@@ -470,7 +471,7 @@ directedLine* partitionY(directedLine *polygons, sampledLine **retSampledLines)
 
   Int num_diagonals;
   /*number diagonals is < total_num_edges*total_num_edges*/
-  directedLine** diagonal_vertices = (directedLine**) malloc(sizeof(directedLine*) * total_num_edges*2/*total_num_edges*/);
+  directedLine** diagonal_vertices = (directedLine**) arenaMalloc(sizeof(directedLine*) * total_num_edges*2/*total_num_edges*/);
   assert(diagonal_vertices);
 
 
@@ -487,7 +488,7 @@ num_diagonals=deleteRepeatDiagonals(num_diagonals, diagonal_vertices, diagonal_v
 
 
 
-  Int *removedDiagonals=(Int*)malloc(sizeof(Int) * num_diagonals);
+  Int *removedDiagonals=(Int*)arenaMalloc(sizeof(Int) * num_diagonals);
   for(i=0; i<num_diagonals; i++)
     removedDiagonals[i] = 0;
 
@@ -705,10 +706,10 @@ ret_p2->rootLinkSet(root1);
       }
 
   /*clean up spaces*/
-  free(array);
-  free(ranges);
-  free(diagonal_vertices);
-  free(removedDiagonals);
+  arenaFree(array);
+  arenaFree(ranges);
+  arenaFree(diagonal_vertices);
+  arenaFree(removedDiagonals);
 
   *retSampledLines = newSampledLines;
   return ret_polygons;
@@ -42,6 +42,7 @@
 #include <GL/gl.h> 
 
 #include "primitiveStream.h"
+#include "arena.h"
 
 Int primStream::num_triangles()
 {
@@ -70,14 +71,14 @@ void primStream::insert(Real u, Real v)
    *we have to expand the array
    */
   if(index_vertices+1 >= size_vertices) {
-    Real* temp = (Real*) malloc (sizeof(Real) * (2*size_vertices + 2));
+    Real* temp = (Real*) arenaMalloc(sizeof(Real) * (2*size_vertices + 2));
     assert(temp);
     
     /*copy*/
     for(Int i=0; i<index_vertices; i++)
       temp[i] = vertices[i];
     
-    free(vertices);
+    arenaFree(vertices);
     vertices = temp;
     size_vertices = 2*size_vertices + 2;
   }
@@ -99,9 +100,9 @@ void primStream::end(Int type)
   if(counter == 0) return ;
 
   if(index_lengths >= size_lengths){
-    Int* temp = (Int*) malloc(sizeof(Int) * (2*size_lengths + 2));
+    Int* temp = (Int*) arenaMalloc(sizeof(Int) * (2*size_lengths + 2));
     assert(temp);
-    Int* tempTypes = (Int*) malloc(sizeof(Int) * (2*size_lengths + 2));
+    Int* tempTypes = (Int*) arenaMalloc(sizeof(Int) * (2*size_lengths + 2));
     assert(tempTypes);
     
     /*copy*/
@@ -110,8 +111,8 @@ void primStream::end(Int type)
       tempTypes[i] = types[i];
     }
     
-    free(lengths);
-    free(types);
+    arenaFree(lengths);
+    arenaFree(types);
     lengths = temp;
     types = tempTypes;
     size_lengths = 2*size_lengths + 2;
@@ -144,12 +145,12 @@ void primStream::print()
 
 primStream::primStream(Int sizeLengths, Int sizeVertices)
 {
-  lengths = (Int*)malloc (sizeof(Int) * sizeLengths);
+  lengths = (Int*)arenaMalloc(sizeof(Int) * sizeLengths);
   assert(lengths);
-  types = (Int*)malloc (sizeof(Int) * sizeLengths);
+  types = (Int*)arenaMalloc(sizeof(Int) * sizeLengths);
   assert(types);
   
-  vertices = (Real*) malloc(sizeof(Real) * sizeVertices);
+  vertices = (Real*) arenaMalloc(sizeof(Real) * sizeVertices);
   assert(vertices);
   
   index_lengths = 0;
@@ -162,9 +163,9 @@ primStream::primStream(Int sizeLengths, Int sizeVertices)
 
 primStream::~primStream()
 {
-  free(lengths);
-  free(types);
-  free(vertices);
+  arenaFree(lengths);
+  arenaFree(types);
+  arenaFree(vertices);
 }
 
 void primStream::draw()
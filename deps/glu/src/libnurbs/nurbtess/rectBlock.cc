@@ -43,6 +43,7 @@
 #include <GL/gl.h>
 
 #include "rectBlock.h"
+#include "arena.h"
 
 rectBlock::rectBlock(gridBoundaryChain* left, gridBoundaryChain* right, Int beginVline, Int endVline)
 {
@@ -54,9 +55,9 @@ rectBlock::rectBlock(gridBoundaryChain* left, gridBoundaryChain* right, Int begi
   lowGridLineIndex = left->getVlineIndex(endVline);
 
   Int n = upGridLineIndex-lowGridLineIndex+1; //number of grid lines
-  leftIndices = (Int*) malloc(sizeof(Int) * n);
+  leftIndices = (Int*) arenaMalloc(sizeof(Int) * n);
   assert(leftIndices);
-  rightIndices = (Int*) malloc(sizeof(Int) * n);
+  rightIndices = (Int*) arenaMalloc(sizeof(Int) * n);
   assert(rightIndices);
   for(i=0; i<n; i++)
     {
@@ -69,8 +70,8 @@ rectBlock::rectBlock(gridBoundaryChain* left, gridBoundaryChain* right, Int begi
 
 rectBlock::~rectBlock()
 {
-  free(leftIndices);
-  free(rightIndices);
+  arenaFree(leftIndices);
+  arenaFree(rightIndices);
 }
 
 void rectBlock::print()
@@ -130,7 +131,7 @@ rectBlockArray::rectBlockArray(Int s)
   Int i;
   n_elements = 0;
   size = s;
-  array = (rectBlock**) malloc(sizeof(rectBlock*) * s);
+  array = (rectBlock**) arenaMalloc(sizeof(rectBlock*) * s);
   assert(array);
 //initialization
   for(i=0; i<s; i++)
@@ -145,7 +146,7 @@ rectBlockArray::~rectBlockArray()
       if(array[i] != NULL)
 	delete array[i];
     }
-  free(array);
+  arenaFree(array);
 }
 
 //put to the end of the array, check the size
@@ -154,7 +155,7 @@ void rectBlockArray::insert(rectBlock* newBlock)
   Int i;
   if(n_elements == size) //full
     {
-      rectBlock** temp = (rectBlock**) malloc(sizeof(rectBlock) * (2*size+1));
+      rectBlock** temp = (rectBlock**) arenaMalloc(sizeof(rectBlock) * (2*size+1));
       assert(temp);
       //initialization
       for(i=0; i<2*size+1; i++)
@@ -163,7 +164,7 @@ void rectBlockArray::insert(rectBlock* newBlock)
       for(i=0; i<n_elements; i++)
 	temp[i] = array[i];
       
-      free(array);
+      arenaFree(array);
       array = temp;
       size = 2*size +  1;
     }
@@ -36,7 +36,7 @@
 #include "definitions.h"
 #include "gridWrap.h"
 
-class rectBlock{
+class rectBlock : public ArenaObj {
   Int upGridLineIndex;
   Int lowGridLineIndex;
   Int* leftIndices; //up to bottome
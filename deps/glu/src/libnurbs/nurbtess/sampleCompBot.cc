@@ -40,6 +40,7 @@
 #include "zlassert.h"
 #include "sampleCompBot.h"
 #include "sampleCompRight.h"
+#include "arena.h"
 
 #define max(a,b) ((a>b)? a:b)
 
@@ -752,7 +753,7 @@ void sampleCompBotSimple(Real* botVertex,
   Int gridV = leftGridChain->getVlineIndex(gridIndex);
   Int gridLeftU = leftGridChain->getUlineIndex(gridIndex);
   Int gridRightU = rightGridChain->getUlineIndex(gridIndex);
-  Real2* gridPoints = (Real2*) malloc(sizeof(Real2) * (gridRightU - gridLeftU +1));
+  Real2* gridPoints = (Real2*) arenaMalloc(sizeof(Real2) * (gridRightU - gridLeftU +1));
   assert(gridPoints);
 
   for(k=0, i=gridRightU; i>= gridLeftU; i--, k++)
@@ -836,7 +837,7 @@ printf("Actual right start = %i, end=%i\n",ActualRightStart,   ActualRightEnd);
 			  ActualRightStart,
 			  ActualRightEnd,
 			  pStream);
-  free(gridPoints);
+  arenaFree(gridPoints);
 }
   
   
@@ -41,6 +41,7 @@
 #include "glimports.h"
 #include "zlassert.h"
 #include "sampleCompRight.h"
+#include "arena.h"
 
 #define max(a,b) ((a>b)? a:b)
 #define min(a,b) ((a>b)? b:a)
@@ -594,11 +595,11 @@ void stripOfFanRight(vertexArray* rightChain,
   Real grid_v_value;
   grid_v_value = grid->get_v_value(vlineIndex);
 
-  Real2* trimVerts=(Real2*) malloc(sizeof(Real2)* (largeIndex-smallIndex+1));
+  Real2* trimVerts=(Real2*) arenaMalloc(sizeof(Real2)* (largeIndex-smallIndex+1));
   assert(trimVerts);
 
 
-  Real2* gridVerts=(Real2*) malloc(sizeof(Real2)* (ulineLargeIndex-ulineSmallIndex+1));
+  Real2* gridVerts=(Real2*) arenaMalloc(sizeof(Real2)* (ulineLargeIndex-ulineSmallIndex+1));
   assert(gridVerts);
 
   Int k,i;
@@ -630,8 +631,8 @@ void stripOfFanRight(vertexArray* rightChain,
     triangulateXYMono(largeIndex-smallIndex+1, trimVerts,
 		      ulineLargeIndex-ulineSmallIndex+1, gridVerts,
 		      pStream);
-  free(trimVerts);
-  free(gridVerts);
+  arenaFree(trimVerts);
+  arenaFree(gridVerts);
 }
 
 
@@ -41,6 +41,7 @@
 #include "zlassert.h"
 #include "sampleCompTop.h"
 #include "sampleCompRight.h"
+#include "arena.h"
 
 #define max(a,b) ((a>b)? a:b)
 
@@ -928,7 +929,7 @@ void sampleCompTopSimple(Real* topVertex,
   Int gridLeftU = leftGridChain->getUlineIndex(gridIndex1);
   Int gridRightU = rightGridChain->getUlineIndex(gridIndex1);
 
-  Real2* gridPoints = (Real2*) malloc(sizeof(Real2) * (gridRightU - gridLeftU +1));
+  Real2* gridPoints = (Real2*) arenaMalloc(sizeof(Real2) * (gridRightU - gridLeftU +1));
   assert(gridPoints);
   
   for(k=0, i=gridRightU; i>= gridLeftU; i--, k++)
@@ -1024,7 +1025,7 @@ void sampleCompTopSimple(Real* topVertex,
    
   }
 
-  free(gridPoints);
+  arenaFree(gridPoints);
       
 }		  
 						   
@@ -55,6 +55,7 @@
 #include "sampleComp.h"
 #include "polyDBG.h"
 #include "partitionX.h"
+#include "arena.h"
 
 
 #define ZERO 0.00001
@@ -118,14 +119,14 @@ void triangulateConvexPolyVertical(directedLine* topV, directedLine* botV, primS
       n_rightVerts += tempV->get_npoints();
     }
 
-  Real2* temp_leftVerts = (Real2 *) malloc(sizeof(Real2) * n_leftVerts);
+  Real2* temp_leftVerts = (Real2 *) arenaMalloc(sizeof(Real2) * n_leftVerts);
   assert(temp_leftVerts);
-  Real2* temp_rightVerts = (Real2 *) malloc(sizeof(Real2) * n_rightVerts);
+  Real2* temp_rightVerts = (Real2 *) arenaMalloc(sizeof(Real2) * n_rightVerts);
   assert(temp_rightVerts);
 
-  leftVerts = (Real**) malloc(sizeof(Real2*) * n_leftVerts);
+  leftVerts = (Real**) arenaMalloc(sizeof(Real2*) * n_leftVerts);
   assert(leftVerts);
-  rightVerts = (Real**) malloc(sizeof(Real2*) * n_rightVerts);
+  rightVerts = (Real**) arenaMalloc(sizeof(Real2*) * n_rightVerts);
   assert(rightVerts);
   for(i=0; i<n_leftVerts; i++)
     leftVerts[i] = temp_leftVerts[i];
@@ -155,10 +156,10 @@ void triangulateConvexPolyVertical(directedLine* topV, directedLine* botV, primS
     }
   n_rightVerts = i;
   triangulateXYMonoTB(n_leftVerts, leftVerts, n_rightVerts, rightVerts, pStream);
-  free(leftVerts);
-  free(rightVerts);
-  free(temp_leftVerts);
-  free(temp_rightVerts);
+  arenaFree(leftVerts);
+  arenaFree(rightVerts);
+  arenaFree(temp_leftVerts);
+  arenaFree(temp_rightVerts);
 }  
 
 void triangulateConvexPolyHoriz(directedLine* leftV, directedLine* rightV, primStream *pStream)
@@ -179,9 +180,9 @@ void triangulateConvexPolyHoriz(directedLine* leftV, directedLine* rightV, primS
     {
       n_upperVerts += tempV->get_npoints();
     }
-  lowerVerts = (Real2 *) malloc(sizeof(Real2) * n_lowerVerts);
+  lowerVerts = (Real2 *) arenaMalloc(sizeof(Real2) * n_lowerVerts);
   assert(n_lowerVerts);
-  upperVerts = (Real2 *) malloc(sizeof(Real2) * n_upperVerts);
+  upperVerts = (Real2 *) arenaMalloc(sizeof(Real2) * n_upperVerts);
   assert(n_upperVerts);
   i=0;
   for(tempV = leftV; tempV != rightV; tempV = tempV->getNext())
@@ -204,8 +205,8 @@ void triangulateConvexPolyHoriz(directedLine* leftV, directedLine* rightV, primS
 	}
     }
   triangulateXYMono(n_upperVerts, upperVerts, n_lowerVerts, lowerVerts, pStream);
-  free(lowerVerts);
-  free(upperVerts);
+  arenaFree(lowerVerts);
+  arenaFree(upperVerts);
 }  
 void triangulateConvexPoly(directedLine* polygon, Int ulinear, Int vlinear, primStream* pStream)
 {
@@ -404,13 +405,13 @@ void findGridChains(directedLine* topV, directedLine* botV,
     lastGridIndex  = (Int) ((botV->head()[1] - grid->get_v_min()) / (grid->get_v_max() - grid->get_v_min()) * (grid->get_n_vlines()-1)) + 1;
 
   /*find the interval inside  the polygon for each gridline*/
-  Int *leftGridIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *leftGridIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(leftGridIndices);
-  Int *rightGridIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *rightGridIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(rightGridIndices);
-  Int *leftGridInnerIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *leftGridInnerIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(leftGridInnerIndices);
-  Int *rightGridInnerIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *rightGridInnerIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(rightGridInnerIndices);
 
   findLeftGridIndices(topV, firstGridIndex, lastGridIndex, grid,  leftGridIndices, leftGridInnerIndices);
@@ -421,10 +422,10 @@ void findGridChains(directedLine* topV, directedLine* botV,
 
   rightGridChain = new gridBoundaryChain(grid, firstGridIndex, firstGridIndex-lastGridIndex+1, rightGridIndices, rightGridInnerIndices);
 
-  free(leftGridIndices);
-  free(rightGridIndices);
-  free(leftGridInnerIndices);
-  free(rightGridInnerIndices);
+  arenaFree(leftGridIndices);
+  arenaFree(rightGridIndices);
+  arenaFree(leftGridInnerIndices);
+  arenaFree(rightGridInnerIndices);
 }
 
 void findDownCorners(Real *botVertex, 
@@ -987,7 +988,7 @@ void findLeftGridIndices(directedLine* topEdge, Int firstGridIndex, Int lastGrid
 #ifdef SHORTEN_GRID_LINE
   //uintercBuf stores all the interction u value for each grid line
   //notice that lastGridIndex<= firstGridIndex
-  Real *uintercBuf = (Real *) malloc (sizeof(Real) * (firstGridIndex-lastGridIndex+1));
+  Real *uintercBuf = (Real *) arenaMalloc(sizeof(Real) * (firstGridIndex-lastGridIndex+1));
   assert(uintercBuf);
 #endif
 
@@ -1085,7 +1086,7 @@ void findLeftGridIndices(directedLine* topEdge, Int firstGridIndex, Int lastGrid
 	}
     }
   //clean up
-  free(uintercBuf);
+  arenaFree(uintercBuf);
 #endif
 }
 
@@ -1105,7 +1106,7 @@ void findRightGridIndices(directedLine* topEdge, Int firstGridIndex, Int lastGri
 #ifdef SHORTEN_GRID_LINE
   //uintercBuf stores all the interction u value for each grid line
   //notice that firstGridIndex >= lastGridIndex
-  Real *uintercBuf = (Real *) malloc (sizeof(Real) * (firstGridIndex-lastGridIndex+1));
+  Real *uintercBuf = (Real *) arenaMalloc(sizeof(Real) * (firstGridIndex-lastGridIndex+1));
   assert(uintercBuf);
 #endif
 
@@ -1211,7 +1212,7 @@ if(ret_indices[k] < 0)
 	}
     }
   //clean up
-  free(uintercBuf);
+  arenaFree(uintercBuf);
 #endif
 }
 
@@ -1243,7 +1244,7 @@ if(grid->get_n_ulines() == 2 ||
     {
       Int n_cusps;//num interior cusps
       Int n_edges = polygon->numEdges();
-      directedLine** cusps = (directedLine**) malloc(sizeof(directedLine*) * n_edges);
+      directedLine** cusps = (directedLine**) arenaMalloc(sizeof(directedLine*) * n_edges);
       assert(cusps);
       findInteriorCuspsX(polygon, n_cusps, cusps);
 
@@ -1252,7 +1253,7 @@ if(grid->get_n_ulines() == 2 ||
 
 	  monoTriangulationFun(polygon, compV2InX, pStream);
 
-          free(cusps);
+          arenaFree(cusps);
           return;          
 	}
       else if(n_cusps == 1) //one interior cusp
@@ -1270,7 +1271,7 @@ if(grid->get_n_ulines() == 2 ||
 	  if(other == NULL)
 	    {
 	      monoTriangulationFun(polygon, compV2InX, pStream);
-	      free(cusps);
+	      arenaFree(cusps);
 	      return;
 	    }
 
@@ -1288,10 +1289,10 @@ if(grid->get_n_ulines() == 2 ||
 	  ret_p1->deleteSinglePolygonWithSline();	      
 	  ret_p2->deleteSinglePolygonWithSline();	  
 
-          free(cusps);
+          arenaFree(cusps);
           return;
          }
-     free(cusps);
+     arenaFree(cusps);
      }
 }
 
@@ -1326,13 +1327,13 @@ if(grid->get_n_ulines() == 2 ||
 
 
   /*find the interval inside  the polygon for each gridline*/
-  Int *leftGridIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *leftGridIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(leftGridIndices);
-  Int *rightGridIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *rightGridIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(rightGridIndices);
-  Int *leftGridInnerIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *leftGridInnerIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(leftGridInnerIndices);
-  Int *rightGridInnerIndices = (Int*) malloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
+  Int *rightGridInnerIndices = (Int*) arenaMalloc(sizeof(Int) * (firstGridIndex - lastGridIndex +1));
   assert(rightGridInnerIndices);
 
   findLeftGridIndices(topV, firstGridIndex, lastGridIndex, grid,  leftGridIndices, leftGridInnerIndices);
@@ -1392,10 +1393,10 @@ if(grid->get_n_ulines() == 2 ||
 
 
   /*cleanup space*/
-  free(leftGridIndices);
-  free(rightGridIndices);
-  free(leftGridInnerIndices);
-  free(rightGridInnerIndices);
+  arenaFree(leftGridIndices);
+  arenaFree(rightGridIndices);
+  arenaFree(leftGridInnerIndices);
+  arenaFree(rightGridInnerIndices);
 }
 
 void sampleMonoPolyRec(
@@ -2381,11 +2382,11 @@ void stripOfFanLeft(vertexArray* leftChain,
   Real grid_v_value;
   grid_v_value = grid->get_v_value(vlineIndex);
 
-  Real2* trimVerts=(Real2*) malloc(sizeof(Real2)* (largeIndex-smallIndex+1));
+  Real2* trimVerts=(Real2*) arenaMalloc(sizeof(Real2)* (largeIndex-smallIndex+1));
   assert(trimVerts);
 
 
-  Real2* gridVerts=(Real2*) malloc(sizeof(Real2)* (ulineLargeIndex-ulineSmallIndex+1));
+  Real2* gridVerts=(Real2*) arenaMalloc(sizeof(Real2)* (ulineLargeIndex-ulineSmallIndex+1));
   assert(gridVerts);
 
   Int k,i;
@@ -2417,8 +2418,8 @@ void stripOfFanLeft(vertexArray* leftChain,
     triangulateXYMono(largeIndex-smallIndex+1, trimVerts,
 		      ulineLargeIndex-ulineSmallIndex+1, gridVerts,
 		      pStream);
-  free(trimVerts);
-  free(gridVerts);
+  arenaFree(trimVerts);
+  arenaFree(gridVerts);
 }
 
   
@@ -41,6 +41,7 @@
 #include "glimports.h"
 #include "zlassert.h"
 #include "sampledLine.h"
+#include "arena.h"
 
 void sampledLine::setPoint(Int i, Real p[2]) 
 {
@@ -71,7 +72,7 @@ void sampledLine::deleteList()
 sampledLine::sampledLine(Int n_points)
 {
   npoints = n_points;
-  points = (Real2*) malloc(sizeof(Real2) * n_points);
+  points = (Real2*) arenaMalloc(sizeof(Real2) * n_points);
   assert(points);
   next = NULL;
 }
@@ -83,7 +84,7 @@ sampledLine::sampledLine(Int n_points, Real2 pts[])
 {
   int i;
   npoints = n_points;
-  points = (Real2*) malloc(sizeof(Real2) * n_points);
+  points = (Real2*) arenaMalloc(sizeof(Real2) * n_points);
   assert(points);
   for(i=0; i<npoints; i++) {
     points[i][0] = pts[i][0];
@@ -95,7 +96,7 @@ sampledLine::sampledLine(Int n_points, Real2 pts[])
 sampledLine::sampledLine(Real pt1[2], Real pt2[2])
 {
   npoints = 2;
-  points = (Real2*) malloc(sizeof(Real2) * 2);
+  points = (Real2*) arenaMalloc(sizeof(Real2) * 2);
   assert(points);
   points[0][0] = pt1[0];
   points[0][1] = pt1[1];
@@ -123,7 +124,7 @@ void sampledLine::init(Int n_points, Real2 *pts)
  */
 sampledLine::~sampledLine()
 {
-  free(points);
+  arenaFree(points);
 }
 
 void sampledLine::print()
@@ -153,7 +154,7 @@ void sampledLine::tessellate(Real u_reso, Real v_reso)
   //du dv could be negative  
   Real du = (points[npoints-1][0] - points[0][0])/n;
   Real dv = (points[npoints-1][1] - points[0][1])/n;
-  Real2 *temp = (Real2*) malloc(sizeof(Real2) * (n+1));
+  Real2 *temp = (Real2*) arenaMalloc(sizeof(Real2) * (n+1));
   assert(temp);
 
   Real u,v;
@@ -165,7 +166,7 @@ void sampledLine::tessellate(Real u_reso, Real v_reso)
   temp[n][0] = points[npoints-1][0];
   temp[n][1] = points[npoints-1][1];
 
-  free(points);
+  arenaFree(points);
 
   npoints = n+1;
   points = temp;
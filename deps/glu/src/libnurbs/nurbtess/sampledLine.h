@@ -34,8 +34,9 @@
 #define _SAMPLEDLINE_H
 
 #include "definitions.h"
+#include "arena.h"
 
-class sampledLine{
+class sampledLine : public ArenaObj {
   Int npoints;
   Real2 *points;
 
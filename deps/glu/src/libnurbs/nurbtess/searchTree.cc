@@ -40,12 +40,13 @@
 #include "zlassert.h"
 
 #include "searchTree.h"
+#include "arena.h"
 
 #define max(a,b) ((a>b)? a:b)
 
 treeNode* TreeNodeMake(void *key)
 {
-  treeNode *ret = (treeNode*) malloc(sizeof(treeNode));
+  treeNode *ret = (treeNode*) arenaMalloc(sizeof(treeNode));
   assert(ret);
   ret->key = key;
   ret->parent = NULL;
@@ -56,7 +57,7 @@ treeNode* TreeNodeMake(void *key)
 
 void TreeNodeDeleteSingleNode(treeNode* node)
 {
-  free(node);
+  arenaFree(node);
 }
 
 void TreeNodeDeleteWholeTree(treeNode* node)
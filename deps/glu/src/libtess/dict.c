@@ -38,7 +38,8 @@
 
 /* really __gl_dictListNewDict */
 Dict *dictNewDict( void *frame,
-		   int (*leq)(void *frame, DictKey key1, DictKey key2) )
+		   int (*leq)(void *frame, DictKey key1, DictKey key2),
+		   MemPool *pool )
 {
   Dict *dict = (Dict *) memAlloc( sizeof( Dict ));
   DictNode *head;
@@ -53,6 +54,8 @@ Dict *dictNewDict( void *frame,
 
   dict->frame = frame;
   dict->leq = leq;
+  dict->pool = pool;
+  memPoolReset( pool );
 
   return dict;
 }
@@ -60,12 +63,8 @@ Dict *dictNewDict( void *frame,
 /* really __gl_dictListDeleteDict */
 void dictDeleteDict( Dict *dict )
 {
-  DictNode *node, *next;
-
-  for( node = dict->head.next; node != &dict->head; node = next ) {
-    next = node->next;
-    memFree( node );
-  }
+  /* All the nodes live in dict->pool; recycle them in one step */
+  memPoolReset( dict->pool );
   memFree( dict );
 }
 
@@ -78,7 +77,7 @@ DictNode *dictInsertBefore( Dict *dict, DictNode *node, DictKey key )
     node = node->prev;
   } while( node->key != NULL && ! (*dict->leq)(dict->frame, node->key, key));
 
-  newNode = (DictNode *) memAlloc( sizeof( DictNode ));
+  newNode = (DictNode *) memPoolAlloc( dict->pool );
   if (newNode == NULL) return NULL;
 
   newNode->key = key;
@@ -95,7 +94,7 @@ void dictDelete( Dict *dict, DictNode *node ) /*ARGSUSED*/
 {
   node->next->prev = node->prev;
   node->prev->next = node->next;
-  memFree( node );
+  memPoolFree( node );
 }
 
 /* really __gl_dictListSearch */
@@ -35,13 +35,15 @@
 #ifndef __dict_list_h_
 #define __dict_list_h_
 
+#include "memalloc.h"
+
 /* Use #define's so that another heap implementation can use this one */
 
 #define DictKey		DictListKey
 #define Dict		DictList
 #define DictNode	DictListNode
 
-#define dictNewDict(frame,leq)		__gl_dictListNewDict(frame,leq)
+#define dictNewDict(frame,leq,pool)	__gl_dictListNewDict(frame,leq,pool)
 #define dictDeleteDict(dict)		__gl_dictListDeleteDict(dict)
 
 #define dictSearch(dict,key)		__gl_dictListSearch(dict,key)
@@ -61,9 +63,15 @@ typedef void *DictKey;
 typedef struct Dict Dict;
 typedef struct DictNode DictNode;
 
+/* The nodes of the dictionary are stored in "pool", which must be
+ * initialized for nodes of size sizeof(DictNode) and is not used for
+ * anything else while the dictionary exists.  dictDeleteDict() empties
+ * the pool in one step instead of freeing each node.
+ */
 Dict		*dictNewDict(
 			void *frame,
-			int (*leq)(void *frame, DictKey key1, DictKey key2) );
+			int (*leq)(void *frame, DictKey key1, DictKey key2),
+			MemPool *pool );
 			
 void		dictDeleteDict( Dict *dict );
 
@@ -95,6 +103,7 @@ struct Dict {
   DictNode	head;
   void		*frame;
   int		(*leq)(void *frame, DictKey key1, DictKey key2);
+  MemPool	*pool;		/* storage for the nodes */
 };
 
 #endif
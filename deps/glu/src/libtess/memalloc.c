@@ -34,6 +34,10 @@
 
 #include "memalloc.h"
 #include "string.h"
+#include <assert.h>
+#ifdef _WIN32
+#include <malloc.h>	/* _aligned_malloc */
+#endif
 
 int __gl_memInit( size_t maxFast )
 {
@@ -53,3 +57,131 @@ void *__gl_memAlloc( size_t n )
 }
 #endif
 
+
+/* Objects are carved at multiples of this, which is enough for any
+ * of the structures libtess keeps in a pool.
+ */
+typedef union { void *p; double d; long l; } MemAlign;
+
+#define MEM_ROUND(n)	(((n) + sizeof(MemAlign) - 1) & ~(sizeof(MemAlign) - 1))
+
+struct MemSlab {
+  MemPool	*pool;		/* the pool this slab belongs to */
+  MemSlab	*next;
+};
+
+#define MEM_SLAB_HEADER	MEM_ROUND( sizeof( MemSlab ))
+
+#define SlabOf(p)	((MemSlab *)((size_t)(p) & ~(size_t)(MEM_SLAB_SIZE - 1)))
+
+static MemSlab *allocSlab( void )
+{
+#ifdef _WIN32
+  return (MemSlab *)_aligned_malloc( MEM_SLAB_SIZE, MEM_SLAB_SIZE );
+#else
+  void *p;
+
+  if( posix_memalign( &p, MEM_SLAB_SIZE, MEM_SLAB_SIZE ) != 0 ) return NULL;
+  return (MemSlab *)p;
+#endif
+}
+
+static void freeSlab( MemSlab *slab )
+{
+#ifdef _WIN32
+  _aligned_free( slab );
+#else
+  free( slab );
+#endif
+}
+
+void __gl_memPoolInit( MemPool *pool, size_t size, void *owner )
+{
+  pool->size = MEM_ROUND( size );
+  assert( pool->size <= MEM_SLAB_SIZE - MEM_SLAB_HEADER );
+  pool->owner = owner;
+  pool->slabs = NULL;
+  pool->cur = NULL;
+  pool->next = NULL;
+  pool->end = NULL;
+  pool->freeList = NULL;
+}
+
+/* Move on to the next slab after pool->cur, reusing one left over from
+ * before the last reset if there is one.
+ */
+static int nextSlab( MemPool *pool )
+{
+  MemSlab *slab = (pool->cur == NULL) ? pool->slabs : pool->cur->next;
+
+  if( slab == NULL ) {
+    slab = allocSlab();
+    if (slab == NULL) return 0;
+    slab->pool = pool;
+    slab->next = NULL;
+    if( pool->cur == NULL ) {
+      pool->slabs = slab;
+    } else {
+      pool->cur->next = slab;
+    }
+  }
+  pool->cur = slab;
+  pool->next = (char *)slab + MEM_SLAB_HEADER;
+  pool->end = (char *)slab + MEM_SLAB_SIZE;
+  return 1;
+}
+
+void *__gl_memPoolAlloc( MemPool *pool )
+{
+  void *p = pool->freeList;
+
+  if( p != NULL ) {
+    pool->freeList = *(void **)p;
+  } else {
+    if( (size_t)(pool->end - pool->next) < pool->size ) {
+      if ( !nextSlab( pool ) ) return NULL;
+    }
+    p = pool->next;
+    pool->next += pool->size;
+  }
+#ifdef MEMORY_DEBUG
+  memset( p, 0xa5, pool->size );
+#endif
+  return p;
+}
+
+void __gl_memPoolFree( void *p )
+{
+  MemPool *pool = SlabOf( p )->pool;
+
+  *(void **)p = pool->freeList;
+  pool->freeList = p;
+}
+
+void *__gl_memPoolOwner( void *p )
+{
+  return SlabOf( p )->pool->owner;
+}
+
+/* Recycle every object in the pool at once.  The slabs are kept and
+ * carved again from the start.
+ */
+void __gl_memPoolReset( MemPool *pool )
+{
+  pool->cur = NULL;
+  pool->next = NULL;
+  pool->end = NULL;
+  pool->freeList = NULL;
+}
+
+void __gl_memPoolDelete( MemPool *pool )
+{
+  MemSlab *slab, *next;
+
+  for( slab = pool->slabs; slab != NULL; slab = next ) {
+    next = slab->next;
+    freeSlab( slab );
+  }
+  pool->slabs = NULL;
+  __gl_memPoolReset( pool );
+}
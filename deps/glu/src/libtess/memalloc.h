@@ -51,4 +51,42 @@ extern int		__gl_memInit( size_t );
 extern void *		__gl_memAlloc( size_t );
 #endif
 
+/* A MemPool hands out fixed-size objects carved from large slabs, and
+ * keeps freed objects on a free list.  Slabs are aligned to their own
+ * size, so the pool owning any object can be found from the object's
+ * address alone -- the mesh operations only ever see edge pointers.
+ * memPoolReset() recycles every object at once but keeps the slabs,
+ * so a pool which is reset after each polygon stops calling malloc
+ * once it has grown to the size of the largest polygon seen.
+ */
+#define MEM_SLAB_SIZE	16384
+
+typedef struct MemSlab MemSlab;
+typedef struct MemPool MemPool;
+
+struct MemPool {
+  size_t	size;		/* object size, rounded for alignment */
+  void		*owner;		/* returned by memPoolOwner() */
+  MemSlab	*slabs;		/* every slab, in the order they are carved */
+  MemSlab	*cur;		/* slab currently being carved */
+  char		*next;		/* next unused object in cur */
+  char		*end;		/* end of cur */
+  void		*freeList;	/* objects returned by memPoolFree() */
+};
+
+#define memPoolInit	__gl_memPoolInit
+#define memPoolAlloc	__gl_memPoolAlloc
+#define memPoolFree	__gl_memPoolFree
+#define memPoolReset	__gl_memPoolReset
+#define memPoolDelete	__gl_memPoolDelete
+#define memPoolOwner	__gl_memPoolOwner
+
+extern void		__gl_memPoolInit( MemPool *pool, size_t size,
+					  void *owner );
+extern void *		__gl_memPoolAlloc( MemPool *pool );
+extern void		__gl_memPoolFree( void *p );
+extern void		__gl_memPoolReset( MemPool *pool );
+extern void		__gl_memPoolDelete( MemPool *pool );
+extern void *		__gl_memPoolOwner( void *p );
+
 #endif
@@ -45,14 +45,19 @@
 #define FALSE 0
 #endif
 
-static GLUvertex *allocVertex()
+/* Every vertex, face and edge pair of a mesh lives in the pools of its
+ * GLUmeshPool, which can be found from any of them (see memalloc.h).
+ */
+#define PoolOf(p)	((GLUmeshPool *)memPoolOwner( p ))
+
+static GLUvertex *allocVertex( GLUmeshPool *pool )
 {
-   return (GLUvertex *)memAlloc( sizeof( GLUvertex ));
+   return (GLUvertex *)memPoolAlloc( &pool->vertices );
 }
 
-static GLUface *allocFace()
+static GLUface *allocFace( GLUmeshPool *pool )
 {
-   return (GLUface *)memAlloc( sizeof( GLUface ));
+   return (GLUface *)memPoolAlloc( &pool->faces );
 }
 
 /************************ Utility Routines ************************/
@@ -66,12 +71,12 @@ typedef struct { GLUhalfEdge e, eSym; } EdgePair;
  * No vertex or face structures are allocated, but these must be assigned
  * before the current edge operation is completed.
  */
-static GLUhalfEdge *MakeEdge( GLUhalfEdge *eNext )
+static GLUhalfEdge *MakeEdge( GLUmeshPool *pool, GLUhalfEdge *eNext )
 {
   GLUhalfEdge *e;
   GLUhalfEdge *eSym;
   GLUhalfEdge *ePrev;
-  EdgePair *pair = (EdgePair *)memAlloc( sizeof( EdgePair ));
+  EdgePair *pair = (EdgePair *)memPoolAlloc( &pool->edges );
   if (pair == NULL) return NULL;
 
   e = &pair->e;
@@ -214,7 +219,7 @@ static void KillEdge( GLUhalfEdge *eDel )
   eNext->Sym->next = ePrev;
   ePrev->Sym->next = eNext;
 
-  memFree( eDel );
+  memPoolFree( eDel );
 }
 
 
@@ -239,7 +244,7 @@ static void KillVertex( GLUvertex *vDel, GLUvertex *newOrg )
   vNext->prev = vPrev;
   vPrev->next = vNext;
 
-  memFree( vDel );
+  memPoolFree( vDel );
 }
 
 /* KillFace( fDel ) destroys a face and removes it from the global face
@@ -263,7 +268,7 @@ static void KillFace( GLUface *fDel, GLUface *newLface )
   fNext->prev = fPrev;
   fPrev->next = fNext;
 
-  memFree( fDel );
+  memPoolFree( fDel );
 }
 
 
@@ -274,24 +279,24 @@ static void KillFace( GLUface *fDel, GLUface *newLface )
  */
 GLUhalfEdge *__gl_meshMakeEdge( GLUmesh *mesh )
 {
-  GLUvertex *newVertex1= allocVertex();
-  GLUvertex *newVertex2= allocVertex();
-  GLUface *newFace= allocFace();
+  GLUvertex *newVertex1= allocVertex( mesh->pool );
+  GLUvertex *newVertex2= allocVertex( mesh->pool );
+  GLUface *newFace= allocFace( mesh->pool );
   GLUhalfEdge *e;
 
   /* if any one is null then all get freed */
   if (newVertex1 == NULL || newVertex2 == NULL || newFace == NULL) {
-     if (newVertex1 != NULL) memFree(newVertex1);
-     if (newVertex2 != NULL) memFree(newVertex2);
-     if (newFace != NULL) memFree(newFace);     
+     if (newVertex1 != NULL) memPoolFree(newVertex1);
+     if (newVertex2 != NULL) memPoolFree(newVertex2);
+     if (newFace != NULL) memPoolFree(newFace);     
      return NULL;
   } 
 
-  e = MakeEdge( &mesh->eHead );
+  e = MakeEdge( mesh->pool, &mesh->eHead );
   if (e == NULL) {
-     memFree(newVertex1);
-     memFree(newVertex2);
-     memFree(newFace);
+     memPoolFree(newVertex1);
+     memPoolFree(newVertex2);
+     memPoolFree(newFace);
      return NULL;
   }
 
@@ -347,7 +352,7 @@ int __gl_meshSplice( GLUhalfEdge *eOrg, GLUhalfEdge *eDst )
   Splice( eDst, eOrg );
 
   if( ! joiningVertices ) {
-    GLUvertex *newVertex= allocVertex();
+    GLUvertex *newVertex= allocVertex( PoolOf( eOrg ));
     if (newVertex == NULL) return 0;
 
     /* We split one vertex into two -- the new vertex is eDst->Org.
@@ -357,7 +362,7 @@ int __gl_meshSplice( GLUhalfEdge *eOrg, GLUhalfEdge *eDst )
     eOrg->Org->anEdge = eOrg;
   }
   if( ! joiningLoops ) {
-    GLUface *newFace= allocFace();  
+    GLUface *newFace= allocFace( PoolOf( eOrg ));  
     if (newFace == NULL) return 0;
 
     /* We split one loop into two -- the new loop is eDst->Lface.
@@ -404,7 +409,7 @@ int __gl_meshDelete( GLUhalfEdge *eDel )
 
     Splice( eDel, eDel->Oprev );
     if( ! joiningLoops ) {
-      GLUface *newFace= allocFace();
+      GLUface *newFace= allocFace( PoolOf( eDel ));
       if (newFace == NULL) return 0; 
 
       /* We are splitting one loop into two -- create a new loop for eDel. */
@@ -446,7 +451,7 @@ int __gl_meshDelete( GLUhalfEdge *eDel )
 GLUhalfEdge *__gl_meshAddEdgeVertex( GLUhalfEdge *eOrg )
 {
   GLUhalfEdge *eNewSym;
-  GLUhalfEdge *eNew = MakeEdge( eOrg );
+  GLUhalfEdge *eNew = MakeEdge( PoolOf( eOrg ), eOrg );
   if (eNew == NULL) return NULL;
 
   eNewSym = eNew->Sym;
@@ -457,7 +462,7 @@ GLUhalfEdge *__gl_meshAddEdgeVertex( GLUhalfEdge *eOrg )
   /* Set the vertex and face information */
   eNew->Org = eOrg->Dst;
   {
-    GLUvertex *newVertex= allocVertex();
+    GLUvertex *newVertex= allocVertex( PoolOf( eOrg ));
     if (newVertex == NULL) return NULL;
 
     MakeVertex( newVertex, eNewSym, eNew->Org );
@@ -509,7 +514,7 @@ GLUhalfEdge *__gl_meshConnect( GLUhalfEdge *eOrg, GLUhalfEdge *eDst )
 {
   GLUhalfEdge *eNewSym;
   int joiningLoops = FALSE;  
-  GLUhalfEdge *eNew = MakeEdge( eOrg );
+  GLUhalfEdge *eNew = MakeEdge( PoolOf( eOrg ), eOrg );
   if (eNew == NULL) return NULL;
 
   eNewSym = eNew->Sym;
@@ -533,7 +538,7 @@ GLUhalfEdge *__gl_meshConnect( GLUhalfEdge *eOrg, GLUhalfEdge *eDst )
   eOrg->Lface->anEdge = eNewSym;
 
   if( ! joiningLoops ) {
-    GLUface *newFace= allocFace();
+    GLUface *newFace= allocFace( PoolOf( eOrg ));
     if (newFace == NULL) return NULL;
 
     /* We split one loop into two -- the new loop is eNew->Lface */
@@ -593,14 +598,42 @@ void __gl_meshZapFace( GLUface *fZap )
   fNext->prev = fPrev;
   fPrev->next = fNext;
 
-  memFree( fZap );
+  memPoolFree( fZap );
 }
 
 
-/* __gl_meshNewMesh() creates a new mesh with no edges, no vertices,
- * and no loops (what we usually call a "face").
+/* __gl_meshPoolInit( pool ) prepares empty pools for the vertices, faces
+ * and edges of the meshes built by a tessellator.
+ */
+void __gl_meshPoolInit( GLUmeshPool *pool )
+{
+  memPoolInit( &pool->vertices, sizeof( GLUvertex ), pool );
+  memPoolInit( &pool->faces, sizeof( GLUface ), pool );
+  memPoolInit( &pool->edges, sizeof( EdgePair ), pool );
+}
+
+/* __gl_meshPoolDelete( pool ) releases all the storage held by the pool.
  */
-GLUmesh *__gl_meshNewMesh( void )
+void __gl_meshPoolDelete( GLUmeshPool *pool )
+{
+  memPoolDelete( &pool->vertices );
+  memPoolDelete( &pool->faces );
+  memPoolDelete( &pool->edges );
+}
+
+static void meshPoolReset( GLUmeshPool *pool )
+{
+  memPoolReset( &pool->vertices );
+  memPoolReset( &pool->faces );
+  memPoolReset( &pool->edges );
+}
+
+/* __gl_meshNewMesh( pool ) creates a new mesh with no edges, no vertices,
+ * and no loops (what we usually call a "face").  The mesh is built in
+ * the given pool, which is emptied first: only one mesh may use a pool
+ * at a time.
+ */
+GLUmesh *__gl_meshNewMesh( GLUmeshPool *pool )
 {
   GLUvertex *v;
   GLUface *f;
@@ -610,6 +643,8 @@ GLUmesh *__gl_meshNewMesh( void )
   if (mesh == NULL) {
      return NULL;
   }
+  meshPoolReset( pool );
+  mesh->pool = pool;
   
   v = &mesh->vHead;
   f = &mesh->fHead;
@@ -661,6 +696,8 @@ GLUmesh *__gl_meshUnion( GLUmesh *mesh1, GLUmesh *mesh2 )
   GLUvertex *v2 = &mesh2->vHead;
   GLUhalfEdge *e2 = &mesh2->eHead;
 
+  assert( mesh1->pool == mesh2->pool );
+
   /* Add the faces, vertices, and edges of mesh2 to those of mesh1 */
   if( f2->next != f2 ) {
     f1->prev->next = f2->next;
@@ -707,29 +744,12 @@ void __gl_meshDeleteMesh( GLUmesh *mesh )
 #else
 
 /* __gl_meshDeleteMesh( mesh ) will free all storage for any valid mesh.
+ * Everything but the mesh header lives in mesh->pool, so rather than
+ * walking the lists we hand the whole pool back at once.
  */
 void __gl_meshDeleteMesh( GLUmesh *mesh )
 {
-  GLUface *f, *fNext;
-  GLUvertex *v, *vNext;
-  GLUhalfEdge *e, *eNext;
-
-  for( f = mesh->fHead.next; f != &mesh->fHead; f = fNext ) {
-    fNext = f->next;
-    memFree( f );
-  }
-
-  for( v = mesh->vHead.next; v != &mesh->vHead; v = vNext ) {
-    vNext = v->next;
-    memFree( v );
-  }
-
-  for( e = mesh->eHead.next; e != &mesh->eHead; e = eNext ) {
-    /* One call frees both e and e->Sym (see EdgePair above) */
-    eNext = e->next;
-    memFree( e );
-  }
-
+  meshPoolReset( mesh->pool );
   memFree( mesh );
 }
 
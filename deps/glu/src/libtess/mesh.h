@@ -36,6 +36,7 @@
 #define __mesh_h_
 
 #include <GL/glu.h>
+#include "memalloc.h"
 
 typedef struct GLUmesh GLUmesh; 
 
@@ -121,6 +122,7 @@ struct GLUvertex {
   GLdouble	coords[3];	/* vertex location in 3D */
   GLdouble	s, t;		/* projection onto the sweep plane */
   long		pqHandle;	/* to allow deletion from priority queue */
+  long		index;		/* position in indexed output (render.c) */
 };
 
 struct GLUface {
@@ -160,7 +162,18 @@ struct GLUhalfEdge {
 #define Rnext	Oprev->Sym	/* 3 pointers */
 
 
+/* The vertices, faces and edges of a mesh are carved from pools which
+ * outlive the mesh itself, so that a tessellator can build one polygon
+ * after another without going back to malloc.
+ */
+typedef struct GLUmeshPool {
+  MemPool	vertices;
+  MemPool	faces;
+  MemPool	edges;		/* half-edges, allocated in pairs */
+} GLUmeshPool;
+
 struct GLUmesh {
+  GLUmeshPool	*pool;		/* where the structures below are stored */
   GLUvertex	vHead;		/* dummy header for vertex list */
   GLUface	fHead;		/* dummy header for face list */
   GLUhalfEdge	eHead;		/* dummy header for edge list */
@@ -226,8 +239,10 @@ struct GLUmesh {
  *
  * ************************ Other Operations *****************************
  *
- * __gl_meshNewMesh() creates a new mesh with no edges, no vertices,
- * and no loops (what we usually call a "face").
+ * __gl_meshNewMesh( pool ) creates a new mesh with no edges, no vertices,
+ * and no loops (what we usually call a "face"), stored in the given pool.
+ * Only one mesh may use a pool at a time; creating or deleting a mesh
+ * recycles everything in its pool.
  *
  * __gl_meshUnion( mesh1, mesh2 ) forms the union of all structures in
  * both meshes, and returns the new mesh (the old meshes are destroyed).
@@ -252,11 +267,14 @@ GLUhalfEdge	*__gl_meshAddEdgeVertex( GLUhalfEdge *eOrg );
 GLUhalfEdge	*__gl_meshSplitEdge( GLUhalfEdge *eOrg );
 GLUhalfEdge	*__gl_meshConnect( GLUhalfEdge *eOrg, GLUhalfEdge *eDst );
 
-GLUmesh		*__gl_meshNewMesh( void );
+GLUmesh		*__gl_meshNewMesh( GLUmeshPool *pool );
 GLUmesh		*__gl_meshUnion( GLUmesh *mesh1, GLUmesh *mesh2 );
 void		__gl_meshDeleteMesh( GLUmesh *mesh );
 void		__gl_meshZapFace( GLUface *fZap );
 
+void		__gl_meshPoolInit( GLUmeshPool *pool );
+void		__gl_meshPoolDelete( GLUmeshPool *pool );
+
 #ifdef NDEBUG
 #define		__gl_meshCheckMesh( mesh )
 #else
@@ -48,12 +48,21 @@
 
 #ifdef FOR_TRITE_TEST_PROGRAM
 #define LEQ(x,y)	(*pq->leq)(x,y)
+#define NodeLeq(a,b)	LEQ( h[(a).handle].key, h[(b).handle].key )
+#define SetNodeKey(n,key)	((void)0)
 #else
 /* Violates modularity, but a little faster */
 #include "geom.h"
 #define LEQ(x,y)	VertLeq((GLUvertex *)x, (GLUvertex *)y)
+/* Nodes carry their own copy of s and t, see priorityq-heap.h */
+#define NodeLeq(a,b)	VertLeq( &(a), &(b) )
+#define SetNodeKey(n,key)	((n).s = ((GLUvertex *)(key))->s, \
+				 (n).t = ((GLUvertex *)(key))->t)
 #endif
 
+#define Parent(i)	(((i) + 2) >> 2)
+#define FirstChild(i)	(((i) << 2) - 2)
+
 /* really __gl_pqHeapNewPriorityQ */
 PriorityQ *pqNewPriorityQ( int (*leq)(PQkey key1, PQkey key2) )
 {
@@ -97,29 +106,30 @@ static void FloatDown( PriorityQ *pq, long curr )
 {
   PQnode *n = pq->nodes;
   PQhandleElem *h = pq->handles;
-  PQhandle hCurr, hChild;
-  long child;
+  PQnode nCurr;
+  long child, i, last;
 
-  hCurr = n[curr].handle;
+  nCurr = n[curr];
   for( ;; ) {
-    child = curr << 1;
-    if( child < pq->size && LEQ( h[n[child+1].handle].key,
-				 h[n[child].handle].key )) {
-      ++child;
+    child = FirstChild( curr );
+    if( child > pq->size ) break;
+
+    /* Find the smallest of the (up to four) children */
+    last = child + 3;
+    if( last > pq->size ) last = pq->size;
+    for( i = child + 1; i <= last; ++i ) {
+      if( ! NodeLeq( n[child], n[i] )) child = i;
     }
 
     assert(child <= pq->max);
 
-    hChild = n[child].handle;
-    if( child > pq->size || LEQ( h[hCurr].key, h[hChild].key )) {
-      n[curr].handle = hCurr;
-      h[hCurr].node = curr;
-      break;
-    }
-    n[curr].handle = hChild;
-    h[hChild].node = curr;
+    if( NodeLeq( nCurr, n[child] )) break;
+    n[curr] = n[child];
+    h[n[curr].handle].node = curr;
     curr = child;
   }
+  n[curr] = nCurr;
+  h[nCurr.handle].node = curr;
 }
 
 
@@ -127,22 +137,19 @@ static void FloatUp( PriorityQ *pq, long curr )
 {
   PQnode *n = pq->nodes;
   PQhandleElem *h = pq->handles;
-  PQhandle hCurr, hParent;
+  PQnode nCurr;
   long parent;
 
-  hCurr = n[curr].handle;
+  nCurr = n[curr];
   for( ;; ) {
-    parent = curr >> 1;
-    hParent = n[parent].handle;
-    if( parent == 0 || LEQ( h[hParent].key, h[hCurr].key )) {
-      n[curr].handle = hCurr;
-      h[hCurr].node = curr;
-      break;
-    }
-    n[curr].handle = hParent;
-    h[hParent].node = curr;
+    parent = Parent( curr );
+    if( parent == 0 || NodeLeq( n[parent], nCurr )) break;
+    n[curr] = n[parent];
+    h[n[curr].handle].node = curr;
     curr = parent;
   }
+  n[curr] = nCurr;
+  h[nCurr.handle].node = curr;
 }
 
 /* really __gl_pqHeapInit */
@@ -150,9 +157,11 @@ void pqInit( PriorityQ *pq )
 {
   long i;
 
-  /* This method of building a heap is O(n), rather than O(n lg n). */
+  /* This method of building a heap is O(n), rather than O(n lg n).
+   * Nodes past the parent of the last one are leaves already.
+   */
 
-  for( i = pq->size; i >= 1; --i ) {
+  for( i = Parent( pq->size ); i >= 1; --i ) {
     FloatDown( pq, i );
   }
   pq->initialized = TRUE;
@@ -166,7 +175,7 @@ PQhandle pqInsert( PriorityQ *pq, PQkey keyNew )
   PQhandle free_handle;
 
   curr = ++ pq->size;
-  if( (curr*2) > pq->max ) {
+  if( curr > pq->max ) {
     PQnode *saveNodes= pq->nodes;
     PQhandleElem *saveHandles= pq->handles;
 
@@ -197,6 +206,7 @@ PQhandle pqInsert( PriorityQ *pq, PQkey keyNew )
   }
 
   pq->nodes[curr].handle = free_handle;
+  SetNodeKey( pq->nodes[curr], keyNew );
   pq->handles[free_handle].node = curr;
   pq->handles[free_handle].key = keyNew;
 
@@ -216,7 +226,7 @@ PQkey pqExtractMin( PriorityQ *pq )
   PQkey min = h[hMin].key;
 
   if( pq->size > 0 ) {
-    n[1].handle = n[pq->size].handle;
+    n[1] = n[pq->size];
     h[n[1].handle].node = 1;
 
     h[hMin].key = NULL;
@@ -240,11 +250,11 @@ void pqDelete( PriorityQ *pq, PQhandle hCurr )
   assert( hCurr >= 1 && hCurr <= pq->max && h[hCurr].key != NULL );
 
   curr = h[hCurr].node;
-  n[curr].handle = n[pq->size].handle;
+  n[curr] = n[pq->size];
   h[n[curr].handle].node = curr;
 
   if( curr <= -- pq->size ) {
-    if( curr <= 1 || LEQ( h[n[curr>>1].handle].key, h[n[curr].handle].key )) {
+    if( curr <= 1 || NodeLeq( n[Parent(curr)], n[curr] )) {
       FloatDown( pq, curr );
     } else {
       FloatUp( pq, curr );
@@ -69,18 +69,24 @@
  * complicated than an ordinary heap.  "nodes" is the heap itself;
  * active nodes are stored in the range 1..pq->size.  When the
  * heap exceeds its allocated size (pq->max), its size doubles.
- * The children of node i are nodes 2i and 2i+1.
+ * The heap is 4-ary: the children of node i are nodes 4i-2 .. 4i+1,
+ * which keeps it shallow and puts all the children of a node on
+ * one or two cache lines.
  *
  * Each node stores an index into an array "handles".  Each handle
  * stores a key, plus a pointer back to the node which currently
  * represents that key (ie. nodes[handles[i].node].handle == i).
+ * The node also keeps a copy of the sweep coordinates (s,t) of its
+ * key, so that reordering the heap never has to look at the keys
+ * themselves.  The coordinates of a vertex must not change while it
+ * is in the queue.
  */
 
 typedef void *PQkey;
 typedef long PQhandle;
 typedef struct PriorityQ PriorityQ;
 
-typedef struct { PQhandle handle; } PQnode;
+typedef struct { double s, t; PQhandle handle; } PQnode;
 typedef struct { PQkey key; PQhandle node; } PQhandleElem;
 
 struct PriorityQ {
@@ -86,39 +86,35 @@ void pqDeletePriorityQ( PriorityQ *pq )
 
 #define LT(x,y)		(! LEQ(y,x))
 #define GT(x,y)		(! LEQ(x,y))
-#define Swap(a,b)	do{PQkey *tmp = *a; *a = *b; *b = tmp;}while(0)
 
-/* really __gl_pqSortInit */
-int pqInit( PriorityQ *pq )
-{
-  PQkey **p, **r, **i, **j, *piv;
-  struct { PQkey **p, **r; } Stack[50], *top = Stack;
-  unsigned long seed = 2016473283;
+/* The initial keys are sorted as packed records which carry a copy of
+ * the sweep coordinates, so the sort walks contiguous arrays instead of
+ * following a pointer to a vertex for every comparison.
+ */
+typedef struct { double s, t; PQkey *key; } PQsortElem;
 
-  /* Create an array of indirect pointers to the keys, so that we
-   * the handles we have returned are still valid.
-   */
-/*
-  pq->order = (PQHeapKey **)memAlloc( (size_t)
-                                  (pq->size * sizeof(pq->order[0])) );
-*/
-  pq->order = (PQHeapKey **)memAlloc( (size_t)
-                                  ((pq->size+1) * sizeof(pq->order[0])) );
-/* the previous line is a patch to compensate for the fact that IBM */
-/* machines return a null on a malloc of zero bytes (unlike SGI),   */
-/* so we have to put in this defense to guard against a memory      */
-/* fault four lines down. from fossum@austin.ibm.com.               */
-  if (pq->order == NULL) return 0;
+#ifdef FOR_TRITE_TEST_PROGRAM
+#define ElemLT(a,b)	LT( *(a).key, *(b).key )
+#define ElemGT(a,b)	GT( *(a).key, *(b).key )
+#define SetElemKey(e,k)	((void)0)
+#else
+#define ElemLT(a,b)	(! VertLeq( &(b), &(a) ))
+#define ElemGT(a,b)	(! VertLeq( &(a), &(b) ))
+#define SetElemKey(e,k)	((e).s = ((GLUvertex *)(k))->s, \
+			 (e).t = ((GLUvertex *)(k))->t)
+#endif
+#define Swap(a,b)	do{PQsortElem tmp = *a; *a = *b; *b = tmp;}while(0)
 
-  p = pq->order;
-  r = p + pq->size - 1;
-  for( piv = pq->keys, i = p; i <= r; ++piv, ++i ) {
-    *i = piv;
-  }
+/* Average number of records per bucket in the presort (see pqInit) */
+#define BUCKET_SIZE	32
 
-  /* Sort the indirect pointers in descending order,
-   * using randomized Quicksort
-   */
+static void SortElems( PQsortElem *p, PQsortElem *r )
+{
+  PQsortElem *i, *j, piv;
+  struct { PQsortElem *p, *r; } Stack[50], *top = Stack;
+  unsigned long seed = 2016473283;
+
+  /* Sort the records in descending order, using randomized Quicksort */
   top->p = p; top->r = r; ++top;
   while( --top >= Stack ) {
     p = top->p;
@@ -132,8 +128,8 @@ int pqInit( PriorityQ *pq )
       i = p - 1;
       j = r + 1;
       do {
-	do { ++i; } while( GT( **i, *piv ));
-	do { --j; } while( LT( **j, *piv ));
+	do { ++i; } while( ElemGT( *i, piv ));
+	do { --j; } while( ElemLT( *j, piv ));
 	Swap( i, j );
       } while( i < j );
       Swap( i, j );	/* Undo last swap */
@@ -148,21 +144,120 @@ int pqInit( PriorityQ *pq )
     /* Insertion sort small lists */
     for( i = p+1; i <= r; ++i ) {
       piv = *i;
-      for( j = i; j > p && LT( **(j-1), *piv ); --j ) {
+      for( j = i; j > p && ElemLT( *(j-1), piv ); --j ) {
 	*j = *(j-1);
       }
       *j = piv;
     }
   }
+}
+
+/* really __gl_pqSortInit */
+int pqInit( PriorityQ *pq )
+{
+  PQsortElem *elems, *sorted;
+  long *start;
+  long n = pq->size, nb, b, k;
+#ifndef FOR_TRITE_TEST_PROGRAM
+  double sMin, sMax, scale, d;
+#endif
+
+  /* Create an array of indirect pointers to the keys, so that we
+   * the handles we have returned are still valid.
+   */
+/*
+  pq->order = (PQHeapKey **)memAlloc( (size_t)
+                                  (pq->size * sizeof(pq->order[0])) );
+*/
+  pq->order = (PQHeapKey **)memAlloc( (size_t)
+                                  ((pq->size+1) * sizeof(pq->order[0])) );
+/* the previous line is a patch to compensate for the fact that IBM */
+/* machines return a null on a malloc of zero bytes (unlike SGI),   */
+/* so we have to put in this defense to guard against a memory      */
+/* fault four lines down. from fossum@austin.ibm.com.               */
+  if (pq->order == NULL) return 0;
+
+#ifdef FOR_TRITE_TEST_PROGRAM
+  nb = 1;
+#else
+  nb = n / BUCKET_SIZE + 1;
+#endif
+
+  /* The records, the bucketed copy and the bucket offsets share
+   * one block.
+   */
+  elems = (PQsortElem *)memAlloc( (size_t)
+				  (2 * (n+1) * sizeof(elems[0])
+				   + (nb+1) * sizeof(start[0])) );
+  if (elems == NULL) {
+     memFree( pq->order );
+     pq->order = NULL;
+     return 0;
+  }
+  sorted = elems + n+1;
+  start = (long *)(sorted + n+1);
+
+  for( k = 0; k < n; ++k ) {
+    elems[k].key = &pq->keys[k];
+    SetElemKey( elems[k], pq->keys[k] );
+  }
+
+  /* Radix presort: distribute the records into buckets by the position
+   * of s within [sMin,sMax], largest s first.  This is monotone in s,
+   * so once each bucket is sorted the whole array is; the buckets are
+   * small and sort within the cache.  Clustered input just ends up
+   * with a few large buckets.
+   */
+  for( b = 0; b <= nb; ++b ) {
+    start[b] = 0;
+  }
+#ifdef FOR_TRITE_TEST_PROGRAM
+  start[1] = n;
+#define Bucket(e)	0
+#else
+  sMin = sMax = (n > 0) ? elems[0].s : 0;
+  for( k = 1; k < n; ++k ) {
+    if( elems[k].s < sMin ) sMin = elems[k].s;
+    if( elems[k].s > sMax ) sMax = elems[k].s;
+  }
+  scale = (sMax > sMin) ? nb / (sMax - sMin) : 0;
+
+  /* d may be NaN or past the end for extreme coordinates; such
+   * records go in the first bucket (the largest s)
+   */
+#define Bucket(e)	(d = ((e).s - sMin) * scale, \
+			 nb - 1 - ((d < nb) ? (long)d : nb - 1))
+  for( k = 0; k < n; ++k ) {
+    ++start[Bucket( elems[k] ) + 1];
+  }
+#endif
+  for( b = 0; b < nb; ++b ) {
+    start[b+1] += start[b];
+  }
+  for( k = 0; k < n; ++k ) {
+    sorted[start[Bucket( elems[k] )]++] = elems[k];
+  }
+#undef Bucket
+
+  /* Now start[b] is the end of bucket b */
+  for( b = 0, k = 0; b < nb; k = start[b++] ) {
+    if( start[b] - k > 1 ) {
+      SortElems( sorted + k, sorted + start[b] - 1 );
+    }
+  }
+
+  for( k = 0; k < n; ++k ) {
+    pq->order[k] = sorted[k].key;
+  }
+  memFree( elems );
+
   pq->max = pq->size;
   pq->initialized = TRUE;
   __gl_pqHeapInit( pq->heap );	/* always succeeds */
 
 #ifndef NDEBUG
-  p = pq->order;
-  r = p + pq->size - 1;
-  for( i = p; i < r; ++i ) {
-    assert( LEQ( **(i+1), **i ));
+  for( k = 0; k + 1 < pq->size; ++k ) {
+    assert( LEQ( *pq->order[k+1], *pq->order[k] ));
   }
 #endif
 
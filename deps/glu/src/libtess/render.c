@@ -355,6 +355,85 @@ void __gl_renderBoundary( GLUtesselator *tess, GLUmesh *mesh )
 }
 
 
+/************************ Indexed triangle decomposition ******************/
+
+/* Make room for "nVertices" more vertices and "nIndices" more indices
+ * in the indexed output buffers.  The buffers belong to the tessellator
+ * and only grow, so steady-state use does no allocation at all.
+ */
+void __gl_renderReserve( GLUtesselator *tess, long nVertices, long nIndices )
+{
+  long max;
+
+  if( tess->outVertexCount + nVertices > tess->outVertexMax ) {
+    void **vertices;
+
+    max = 2 * tess->outVertexMax;
+    if( max < tess->outVertexCount + nVertices ) {
+      max = tess->outVertexCount + nVertices;
+    }
+    vertices = (void **)memRealloc( tess->outVertices, max * sizeof( void * ));
+    if( vertices == NULL ) longjmp( tess->env, 1 );
+    tess->outVertices = vertices;
+    tess->outVertexMax = max;
+  }
+  if( tess->outIndexCount + nIndices > tess->outIndexMax ) {
+    GLuint *indices;
+
+    max = 2 * tess->outIndexMax;
+    if( max < tess->outIndexCount + nIndices ) {
+      max = tess->outIndexCount + nIndices;
+    }
+    indices = (GLuint *)memRealloc( tess->outIndices, max * sizeof( GLuint ));
+    if( indices == NULL ) longjmp( tess->env, 1 );
+    tess->outIndices = indices;
+    tess->outIndexMax = max;
+  }
+}
+
+
+/* __gl_renderIndexed( tess, mesh ) outputs every interior face (all of
+ * them are triangles at this point) as three indices, in CCW order.
+ * Each mesh vertex is given an output index the first time it is used,
+ * so vertices shared between triangles are only listed once.
+ */
+void __gl_renderIndexed( GLUtesselator *tess, GLUmesh *mesh )
+{
+  GLUvertex *v;
+  GLUface *f;
+  GLUhalfEdge *e;
+  GLuint *out;
+  long nVertices = 0, nTriangles = 0;
+
+  for( v = mesh->vHead.next; v != &mesh->vHead; v = v->next ) {
+    v->index = -1;
+    ++nVertices;
+  }
+  for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+    if( f->inside ) ++nTriangles;
+  }
+  __gl_renderReserve( tess, nVertices, 3 * nTriangles );
+
+  out = tess->outIndices + tess->outIndexCount;
+  for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+    if( ! f->inside ) continue;
+
+    e = f->anEdge;
+    do {
+      v = e->Org;
+      if( v->index < 0 ) {
+	v->index = tess->outVertexCount;
+	tess->outVertices[tess->outVertexCount++] = v->data;
+      }
+      *out++ = (GLuint) v->index;
+      e = e->Lnext;
+    } while( e != f->anEdge );
+  }
+  tess->outIndexCount = out - tess->outIndices;
+  assert( tess->outIndexCount <= tess->outIndexMax );
+}
+
+
 /************************ Quick-and-dirty decomposition ******************/
 
 #define SIGN_INCONSISTENT 2
@@ -483,6 +562,33 @@ GLboolean __gl_renderCache( GLUtesselator *tess )
     return TRUE;
   }
 
+  if( INDEXED_OUTPUT( tess )) {
+    /* The same fan as below, as triangles (v0, vi, vi+1) */
+    long n = tess->cacheCount;
+    long i, first = tess->outVertexCount;
+    GLuint *out;
+
+    __gl_renderReserve( tess, n, 3 * (n - 2) );
+    for( i = 0; i < n; ++i ) {
+      tess->outVertices[first + i] = v0[i].data;
+    }
+    tess->outVertexCount += n;
+
+    out = tess->outIndices + tess->outIndexCount;
+    for( i = 1; i < n - 1; ++i ) {
+      *out++ = (GLuint) first;
+      if( sign > 0 ) {
+	*out++ = (GLuint) (first + i);
+	*out++ = (GLuint) (first + i + 1);
+      } else {
+	*out++ = (GLuint) (first + n - i);
+	*out++ = (GLuint) (first + n - i - 1);
+      }
+    }
+    tess->outIndexCount = out - tess->outIndices;
+    return TRUE;
+  }
+
   CALL_BEGIN_OR_BEGIN_DATA( tess->boundaryOnly ? GL_LINE_LOOP
 			  : (tess->cacheCount > 3) ? GL_TRIANGLE_FAN
 			  : GL_TRIANGLES );
@@ -47,6 +47,14 @@
 void __gl_renderMesh( GLUtesselator *tess, GLUmesh *mesh );
 void __gl_renderBoundary( GLUtesselator *tess, GLUmesh *mesh );
 
+/* __gl_renderIndexed( tess, mesh ) appends the interior triangles of the
+ * mesh to tess->outVertices and tess->outIndices, for delivery through
+ * the GLU_TESS_INDEXED_TRIANGLES_EXT callback.  __gl_renderReserve()
+ * makes room in those buffers, and longjmps to tess->env if it cannot.
+ */
+void __gl_renderIndexed( GLUtesselator *tess, GLUmesh *mesh );
+void __gl_renderReserve( GLUtesselator *tess, long nVertices, long nIndices );
+
 GLboolean __gl_renderCache( GLUtesselator *tess );
 
 #endif
@@ -45,6 +45,7 @@
 #include "priorityq.h"
 #include "memalloc.h"
 #include "sweep.h"
+#include "tesscache.h"
 
 #ifndef TRUE
 #define TRUE 1
@@ -159,7 +160,7 @@ static void DeleteRegion( GLUtesselator *tess, ActiveRegion *reg )
   }
   reg->eUp->activeRegion = NULL;
   dictDelete( tess->dict, reg->nodeUp ); /* __gl_dictListDelete */
-  memFree( reg );
+  memPoolFree( reg );
 }
 
 
@@ -220,7 +221,7 @@ static ActiveRegion *AddRegionBelow( GLUtesselator *tess,
  * Winding number and "inside" flag are not updated.
  */
 {
-  ActiveRegion *regNew = (ActiveRegion *)memAlloc( sizeof( ActiveRegion ));
+  ActiveRegion *regNew = (ActiveRegion *)memPoolAlloc( &tess->regionPool );
   if (regNew == NULL) longjmp(tess->env,1);
 
   regNew->eUp = eNewUp;
@@ -420,7 +421,11 @@ static void CallCombine( GLUtesselator *tess, GLUvertex *isect,
   coords[2] = isect->coords[2];
 
   isect->data = NULL;
-  CALL_COMBINE_OR_COMBINE_DATA( coords, data, weights, &isect->data );
+  if( tess->recording ) {
+    isect->data = __gl_cacheCombine( tess, coords, data, weights );
+  } else {
+    CALL_COMBINE_OR_COMBINE_DATA( coords, data, weights, &isect->data );
+  }
   if( isect->data == NULL ) {
     if( ! needed ) {
       isect->data = data[0];
@@ -1132,7 +1137,7 @@ static void AddSentinel( GLUtesselator *tess, GLdouble t )
  */
 {
   GLUhalfEdge *e;
-  ActiveRegion *reg = (ActiveRegion *)memAlloc( sizeof( ActiveRegion ));
+  ActiveRegion *reg = (ActiveRegion *)memPoolAlloc( &tess->regionPool );
   if (reg == NULL) longjmp(tess->env,1);
 
   e = __gl_meshMakeEdge( tess->mesh );
@@ -1162,9 +1167,15 @@ static void InitEdgeDict( GLUtesselator *tess )
  */
 {
   /* __gl_dictListNewDict */
-  tess->dict = dictNewDict( tess, (int (*)(void *, DictKey, DictKey)) EdgeLeq );
+  tess->dict = dictNewDict( tess, (int (*)(void *, DictKey, DictKey)) EdgeLeq,
+			   &tess->dictPool );
   if (tess->dict == NULL) longjmp(tess->env,1);
 
+  /* The regions are the keys of the dictionary, and are recycled
+   * along with it.
+   */
+  memPoolReset( &tess->regionPool );
+
   AddSentinel( tess, -SENTINEL_COORD );
   AddSentinel( tess, SENTINEL_COORD );
 }
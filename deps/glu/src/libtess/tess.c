@@ -43,6 +43,7 @@
 #include "sweep.h"
 #include "tessmono.h"
 #include "render.h"
+#include "tesscache.h"
 
 #define GLU_TESS_DEFAULT_TOLERANCE 0.0
 #define GLU_TESS_MESH		100112	/* void (*)(GLUmesh *mesh)	    */
@@ -78,6 +79,11 @@
 					       GLfloat weight[4],
 					       void **outData,
 					       void *polygonData ) {}
+/*ARGSUSED*/ void GLAPIENTRY __gl_noIndexedTriangles( GLsizei vertexCount,
+						    void **vertexData,
+						    GLsizei indexCount,
+						    const GLuint *indices,
+						    void *polygonData ) {}
 
 /* Half-edges are allocated in pairs (see mesh.c) */
 typedef struct { GLUhalfEdge e, eSym; } EdgePair;
@@ -107,6 +113,13 @@ gluNewTess( void )
 
   tess->state = T_DORMANT;
 
+  /* The mesh and the sweep dictionary are rebuilt for every polygon;
+   * their storage stays with the tessellator so it can be reused.
+   */
+  __gl_meshPoolInit( &tess->meshPool );
+  memPoolInit( &tess->dictPool, sizeof( DictNode ), tess );
+  memPoolInit( &tess->regionPool, sizeof( ActiveRegion ), tess );
+
   tess->normal[0] = 0;
   tess->normal[1] = 0;
   tess->normal[2] = 0;
@@ -132,6 +145,15 @@ gluNewTess( void )
   tess->callErrorData= &__gl_noErrorData;
   tess->callCombineData= &__gl_noCombineData;
 
+  tess->resultCache = NULL;
+  tess->recording = FALSE;
+
+  tess->callIndexedTriangles= &__gl_noIndexedTriangles;
+  tess->outVertices = NULL;
+  tess->outIndices = NULL;
+  tess->outVertexMax = 0;
+  tess->outIndexMax = 0;
+
   tess->polygonData= NULL;
 
   return tess;
@@ -193,6 +215,12 @@ void GLAPIENTRY
 gluDeleteTess( GLUtesselator *tess )
 {
   RequireState( tess, T_DORMANT );
+  __gl_meshPoolDelete( &tess->meshPool );
+  memPoolDelete( &tess->dictPool );
+  memPoolDelete( &tess->regionPool );
+  if( tess->outVertices != NULL ) memFree( tess->outVertices );
+  if( tess->outIndices != NULL ) memFree( tess->outIndices );
+  if( tess->resultCache != NULL ) __gl_cacheDelete( tess->resultCache );
   memFree( tess );
 }
 
@@ -228,6 +256,21 @@ gluTessProperty( GLUtesselator *tess, GLenum which, GLdouble value )
     tess->boundaryOnly = (value != 0);
     return;
 
+  case GLU_TESS_RESULT_CACHE_SIZE_EXT:
+    if( value < 0 || value != (long) value ) break;
+    if( tess->resultCache == NULL ) {
+      if( value == 0 ) return;
+      tess->resultCache = __gl_cacheNew();
+      if( tess->resultCache == NULL ) {
+	CALL_ERROR_OR_ERROR_DATA( GLU_OUT_OF_MEMORY );
+	return;
+      }
+    }
+    if( ! __gl_cacheSetSize( tess->resultCache, (long) value )) {
+      CALL_ERROR_OR_ERROR_DATA( GLU_OUT_OF_MEMORY );
+    }
+    return;
+
   default:
     CALL_ERROR_OR_ERROR_DATA( GLU_INVALID_ENUM );
     return;
@@ -257,6 +300,15 @@ gluGetTessProperty( GLUtesselator *tess, GLenum which, GLdouble *value )
       assert(tess->boundaryOnly == TRUE || tess->boundaryOnly == FALSE);
       *value= tess->boundaryOnly;
       break;
+   case GLU_TESS_RESULT_CACHE_SIZE_EXT:
+      *value= (tess->resultCache == NULL) ? 0 : tess->resultCache->maxEntries;
+      break;
+   case GLU_TESS_RESULT_CACHE_HITS_EXT:
+      *value= (tess->resultCache == NULL) ? 0 : tess->resultCache->hits;
+      break;
+   case GLU_TESS_RESULT_CACHE_MISSES_EXT:
+      *value= (tess->resultCache == NULL) ? 0 : tess->resultCache->misses;
+      break;
    default:
       *value= 0.0;
       CALL_ERROR_OR_ERROR_DATA( GLU_INVALID_ENUM );
@@ -336,6 +388,12 @@ gluTessCallback( GLUtesselator *tess, GLenum which, _GLUfuncptr fn)
   case GLU_TESS_MESH:
     tess->callMesh = (fn == NULL) ? &noMesh : (void (GLAPIENTRY *)(GLUmesh *)) fn;
     return;
+  case GLU_TESS_INDEXED_TRIANGLES_EXT:
+    tess->callIndexedTriangles = (fn == NULL) ? &__gl_noIndexedTriangles :
+				  (void (GLAPIENTRY *)(GLsizei, void **,
+						       GLsizei, const GLuint *,
+						       void *)) fn;
+    return;
   default:
     CALL_ERROR_OR_ERROR_DATA( GLU_INVALID_ENUM );
     return;
@@ -398,7 +456,7 @@ static int EmptyCache( GLUtesselator *tess )
   CachedVertex *v = tess->cache;
   CachedVertex *vLast;
 
-  tess->mesh = __gl_meshNewMesh();
+  tess->mesh = __gl_meshNewMesh( &tess->meshPool );
   if (tess->mesh == NULL) return 0;
 
   for( vLast = v + tess->cacheCount; v < vLast; ++v ) {
@@ -411,6 +469,30 @@ static int EmptyCache( GLUtesselator *tess )
 }
 
 
+static int EmptyInput( GLUtesselator *tess )
+{
+  /* Build the mesh from the input recorded by the result cache.  The
+   * vertices carry tokens instead of the client data (see tesscache.h).
+   */
+  TessCache *cache = tess->resultCache;
+  GLdouble *coords = cache->coords;
+  long i, j, ref = 0;
+
+  tess->mesh = __gl_meshNewMesh( &tess->meshPool );
+  if (tess->mesh == NULL) return 0;
+
+  for( i = 0; i < cache->numContours; ++i ) {
+    tess->lastEdge = NULL;
+    for( j = 0; j < cache->contourSize[i]; ++j ) {
+      if ( !AddVertex( tess, coords, REF_TO_TOKEN( ref ) ) ) return 0;
+      coords += 3;
+      ++ref;
+    }
+  }
+  return 1;
+}
+
+
 void GLAPIENTRY
 gluTessVertex( GLUtesselator *tess, GLdouble coords[3], void *data )
 {
@@ -442,6 +524,13 @@ gluTessVertex( GLUtesselator *tess, GLdouble coords[3], void *data )
     CALL_ERROR_OR_ERROR_DATA( GLU_TESS_COORD_TOO_LARGE );
   }
 
+  if( tess->recording ) {
+    if ( !__gl_cacheVertex( tess->resultCache, clamped, data ) ) {
+       CALL_ERROR_OR_ERROR_DATA( GLU_OUT_OF_MEMORY );
+    }
+    return;
+  }
+
   if( tess->mesh == NULL ) {
     if( tess->cacheCount < TESS_MAX_CACHE ) {
       CacheVertex( tess, clamped, data );
@@ -468,6 +557,16 @@ gluTessBeginPolygon( GLUtesselator *tess, void *data )
   tess->emptyCache = FALSE;
   tess->mesh = NULL;
 
+  /* With the result cache enabled, the input is only recorded here and
+   * tessellated in gluTessEndPolygon if it is not found in the cache.
+   */
+  tess->recording = (tess->resultCache != NULL
+		     && tess->resultCache->maxEntries > 0
+		     && tess->callMesh == &noMesh);
+  if( tess->recording ) {
+    __gl_cacheBeginPolygon( tess->resultCache );
+  }
+
   tess->polygonData= data;
 }
 
@@ -479,6 +578,12 @@ gluTessBeginContour( GLUtesselator *tess )
 
   tess->state = T_IN_CONTOUR;
   tess->lastEdge = NULL;
+  if( tess->recording ) {
+    if ( !__gl_cacheBeginContour( tess->resultCache ) ) {
+      CALL_ERROR_OR_ERROR_DATA( GLU_OUT_OF_MEMORY );
+    }
+    return;
+  }
   if( tess->cacheCount > 0 ) {
     /* Just set a flag so we don't get confused by empty contours
      * -- these can be generated accidentally with the obsolete
@@ -509,8 +614,16 @@ gluTessEndPolygon( GLUtesselator *tess )
 
   RequireState( tess, T_IN_POLYGON );
   tess->state = T_DORMANT;
+  tess->outVertexCount = 0;
+  tess->outIndexCount = 0;
 
-  if( tess->mesh == NULL ) {
+  if( tess->recording ) {
+    if( __gl_cacheReplay( tess )) {
+      tess->polygonData= NULL;
+      return;
+    }
+    if ( !EmptyInput( tess ) ) longjmp(tess->env,1);
+  } else if( tess->mesh == NULL ) {
     if( ! tess->flagBoundary && tess->callMesh == &noMesh ) {
 
       /* Try some special code to make the easy cases go quickly
@@ -519,6 +632,9 @@ gluTessEndPolygon( GLUtesselator *tess )
        * an explicit mesh either.
        */
       if( __gl_renderCache( tess )) {
+	if( INDEXED_OUTPUT( tess )) {
+	  CALL_INDEXED_TRIANGLES();
+	}
 	tess->polygonData= NULL;
 	return;
       }
@@ -558,15 +674,21 @@ gluTessEndPolygon( GLUtesselator *tess )
 
     __gl_meshCheckMesh( mesh );
 
-    if( tess->callBegin != &noBegin || tess->callEnd != &noEnd
+    if( tess->recording ) {
+      __gl_cacheRecord( tess, mesh );	   /* store and output the result */
+    } else if( tess->callBegin != &noBegin || tess->callEnd != &noEnd
        || tess->callVertex != &noVertex || tess->callEdgeFlag != &noEdgeFlag
        || tess->callBeginData != &__gl_noBeginData
        || tess->callEndData != &__gl_noEndData
        || tess->callVertexData != &__gl_noVertexData
-       || tess->callEdgeFlagData != &__gl_noEdgeFlagData )
+       || tess->callEdgeFlagData != &__gl_noEdgeFlagData
+       || INDEXED_OUTPUT( tess ))
     {
       if( tess->boundaryOnly ) {
 	__gl_renderBoundary( tess, mesh );  /* output boundary contours */
+      } else if( INDEXED_OUTPUT( tess )) {
+	__gl_renderIndexed( tess, mesh );  /* output one triangle list */
+	CALL_INDEXED_TRIANGLES();
       } else {
 	__gl_renderMesh( tess, mesh );	   /* output strips and fans */
       }
@@ -578,6 +700,9 @@ gluTessEndPolygon( GLUtesselator *tess )
        * and we don't need to even reveal its existence.  It also leaves
        * the freedom for an implementation to not generate the exterior
        * faces in the first place.
+       *
+       * The mesh lives in tess->meshPool, so it remains valid only
+       * until the next polygon is started.
        */
       __gl_meshDiscardExterior( mesh );
       (*tess->callMesh)( mesh );		/* user wants the mesh itself */
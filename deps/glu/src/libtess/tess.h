@@ -65,6 +65,9 @@ struct GLUtesselator {
   GLUhalfEdge	*lastEdge;	/* lastEdge->Org is the most recent vertex */
   GLUmesh	*mesh;		/* stores the input contours, and eventually
                                    the tessellation itself */
+  GLUmeshPool	meshPool;	/* storage for mesh, reused for each polygon */
+  struct TessCache *resultCache;	/* see tesscache.h, or NULL */
+  GLboolean	recording;	/* input goes to the result cache */
 
   void		(GLAPIENTRY *callError)( GLenum errnum );
 
@@ -81,6 +84,8 @@ struct GLUtesselator {
   GLboolean	fatalError;	/* fatal error: needed combine callback */
 
   Dict		*dict;		/* edge dictionary for sweep line */
+  MemPool	dictPool;	/* storage for the nodes of dict */
+  MemPool	regionPool;	/* storage for the ActiveRegions in dict */
   PriorityQ	*pq;		/* priority queue of vertex events */
   GLUvertex	*event;		/* current sweep event being processed */
 
@@ -118,6 +123,16 @@ struct GLUtesselator {
 				    GLfloat weight[4], void **outData,
 				    void *polygonData );
 
+  /*** state needed for indexed triangle output (see render.c) ***/
+
+  void		(GLAPIENTRY *callIndexedTriangles)( GLsizei vertexCount,
+				    void **vertexData, GLsizei indexCount,
+				    const GLuint *indices, void *polygonData );
+  void		**outVertices;		/* client data of each output vertex */
+  GLuint	*outIndices;		/* three per triangle, into outVertices */
+  GLsizei	outVertexCount, outVertexMax;
+  GLsizei	outIndexCount, outIndexMax;
+
   jmp_buf env;			/* place to jump to when memAllocs fail */
 
   void *polygonData;		/* client data for current polygon */
@@ -131,6 +146,17 @@ void GLAPIENTRY __gl_noErrorData( GLenum errnum, void *polygonData );
 void GLAPIENTRY __gl_noCombineData( GLdouble coords[3], void *data[4],
 			 GLfloat weight[4], void **outData,
 			 void *polygonData );
+void GLAPIENTRY __gl_noIndexedTriangles( GLsizei vertexCount,
+			 void **vertexData, GLsizei indexCount,
+			 const GLuint *indices, void *polygonData );
+
+/* Triangles are collected for GLU_TESS_INDEXED_TRIANGLES_EXT instead of
+ * being passed to the begin/vertex/end callbacks.  Boundary contours
+ * are always reported through the usual callbacks.
+ */
+#define INDEXED_OUTPUT(tess) \
+   ((tess)->callIndexedTriangles != &__gl_noIndexedTriangles \
+    && ! (tess)->boundaryOnly)
 
 #define CALL_BEGIN_OR_BEGIN_DATA(a) \
    if (tess->callBeginData != &__gl_noBeginData) \
@@ -157,6 +183,11 @@ void GLAPIENTRY __gl_noCombineData( GLdouble coords[3], void *data[4],
       (*tess->callCombineData)((a),(b),(c),(d),tess->polygonData); \
    else (*tess->callCombine)((a),(b),(c),(d));
 
+#define CALL_INDEXED_TRIANGLES() \
+   (*tess->callIndexedTriangles)(tess->outVertexCount,tess->outVertices, \
+				 tess->outIndexCount,tess->outIndices, \
+				 tess->polygonData);
+
 #define CALL_ERROR_OR_ERROR_DATA(a) \
    if (tess->callErrorData != &__gl_noErrorData) \
       (*tess->callErrorData)((a),tess->polygonData); \
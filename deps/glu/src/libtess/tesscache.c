@@ -0,0 +1,559 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+#include "gluos.h"
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include "mesh.h"
+#include "tess.h"
+#include "render.h"
+#include "tesscache.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* Each entry is a single allocation: the structure, followed by the
+ * arrays it points to (doubles first, to keep them aligned).
+ */
+struct CacheEntry {
+  CacheEntry	*prev, *next;	/* LRU list, most recently used first */
+  CacheEntry	*chain;		/* next entry in the same hash bucket */
+  unsigned long	hash;
+
+  /* the key: properties and input contours */
+  GLenum	windingRule;
+  GLboolean	boundaryOnly;
+  GLboolean	flagBoundary;
+  GLdouble	normal[3];
+  long		numContours, numInput;
+  long		*contourSize;
+  GLdouble	*coords;
+
+  /* the result */
+  long		numCombines;
+  CombineRecord	*combines;
+  long		numVertices;
+  long		*vertices;	/* token index of each output vertex */
+  long		numIndices;
+  GLuint	*indices;	/* triangles, or the loops one after another */
+  GLboolean	*edgeFlags;	/* one per index, if flagBoundary */
+  long		numLoops;
+  long		*loopSize;	/* if boundaryOnly */
+};
+
+#define ROUND(n)	(((n) + sizeof(GLdouble) - 1) & ~(sizeof(GLdouble) - 1))
+
+
+TessCache *__gl_cacheNew( void )
+{
+  TessCache *cache = (TessCache *)memAlloc( sizeof( TessCache ));
+
+  if( cache == NULL ) return NULL;
+  memset( cache, 0, sizeof( TessCache ));
+  return cache;
+}
+
+
+static void FlushEntries( TessCache *cache )
+{
+  CacheEntry *entry, *next;
+
+  for( entry = cache->lruHead; entry != NULL; entry = next ) {
+    next = entry->next;
+    memFree( entry );
+  }
+  cache->lruHead = cache->lruTail = NULL;
+  cache->numEntries = 0;
+  if( cache->buckets != NULL ) {
+    memset( cache->buckets, 0,
+	    (cache->bucketMask + 1) * sizeof( CacheEntry * ));
+  }
+}
+
+
+void __gl_cacheDelete( TessCache *cache )
+{
+  FlushEntries( cache );
+  if( cache->buckets != NULL ) memFree( cache->buckets );
+  if( cache->coords != NULL ) memFree( cache->coords );
+  if( cache->data != NULL ) memFree( cache->data );
+  if( cache->contourSize != NULL ) memFree( cache->contourSize );
+  if( cache->combines != NULL ) memFree( cache->combines );
+  memFree( cache );
+}
+
+
+/* Changing the size drops all entries and resets the counters.
+ * Returns 0 if out of memory, leaving the cache disabled.
+ */
+int __gl_cacheSetSize( TessCache *cache, long maxEntries )
+{
+  unsigned long numBuckets = 1;
+
+  FlushEntries( cache );
+  if( cache->buckets != NULL ) memFree( cache->buckets );
+  cache->buckets = NULL;
+  cache->bucketMask = 0;
+  cache->maxEntries = 0;
+  cache->hits = 0;
+  cache->misses = 0;
+  if( maxEntries <= 0 ) return 1;
+
+  while( numBuckets < (unsigned long) maxEntries ) numBuckets <<= 1;
+  cache->buckets = (CacheEntry **)memAlloc( numBuckets * sizeof( CacheEntry * ));
+  if( cache->buckets == NULL ) return 0;
+  memset( cache->buckets, 0, numBuckets * sizeof( CacheEntry * ));
+  cache->bucketMask = numBuckets - 1;
+  cache->maxEntries = maxEntries;
+  return 1;
+}
+
+
+/* Grow one of the recording arrays so it holds at least "need" items. */
+static int Grow( void **array, long *max, long need, size_t size )
+{
+  long newMax = (*max < 16) ? 16 : 2 * *max;
+  void *p;
+
+  if( need <= *max ) return 1;
+  if( newMax < need ) newMax = need;
+  p = memRealloc( *array, newMax * size );
+  if( p == NULL ) return 0;
+  *array = p;
+  *max = newMax;
+  return 1;
+}
+
+
+void __gl_cacheBeginPolygon( TessCache *cache )
+{
+  cache->numInput = 0;
+  cache->numData = 0;
+  cache->numContours = 0;
+  cache->numCombines = 0;
+}
+
+
+int __gl_cacheBeginContour( TessCache *cache )
+{
+  if( ! Grow( (void **)&cache->contourSize, &cache->maxContours,
+	      cache->numContours + 1, sizeof( long ))) {
+    return 0;
+  }
+  cache->contourSize[cache->numContours++] = 0;
+  return 1;
+}
+
+
+int __gl_cacheVertex( TessCache *cache, GLdouble coords[3], void *data )
+{
+  GLdouble *c;
+
+  if( cache->numContours == 0 && ! __gl_cacheBeginContour( cache )) {
+    return 0;
+  }
+  if( ! Grow( (void **)&cache->coords, &cache->maxInput,
+	      cache->numInput + 1, 3 * sizeof( GLdouble ))
+      || ! Grow( (void **)&cache->data, &cache->maxData,
+		 cache->numData + 1, sizeof( void * ))) {
+    return 0;
+  }
+  c = cache->coords + 3 * cache->numInput;
+  c[0] = coords[0];
+  c[1] = coords[1];
+  c[2] = coords[2];
+  cache->data[cache->numData++] = data;
+  ++cache->numInput;
+  ++cache->contourSize[cache->numContours - 1];
+  return 1;
+}
+
+
+void *__gl_cacheCombine( GLUtesselator *tess, GLdouble coords[3],
+			 void *data[4], GLfloat weight[4] )
+{
+  TessCache *cache = tess->resultCache;
+  CombineRecord *r;
+  void *src[4];
+  void *outData = NULL;
+  int i;
+
+  if( ! Grow( (void **)&cache->combines, &cache->maxCombines,
+	      cache->numCombines + 1, sizeof( CombineRecord ))
+      || ! Grow( (void **)&cache->data, &cache->maxData,
+		 cache->numData + 1, sizeof( void * ))) {
+    longjmp( tess->env, 1 );
+  }
+
+  /* Fill in the record first, in case the callback changes its arguments */
+  r = &cache->combines[cache->numCombines];
+  for( i = 0; i < 3; ++i ) {
+    r->coords[i] = coords[i];
+  }
+  for( i = 0; i < 4; ++i ) {
+    r->weight[i] = weight[i];
+    r->src[i] = (data[i] == NULL) ? -1 : TOKEN_TO_REF( data[i] );
+    src[i] = (data[i] == NULL) ? NULL : cache->data[r->src[i]];
+  }
+
+  CALL_COMBINE_OR_COMBINE_DATA( coords, src, weight, &outData );
+  if( outData == NULL ) return NULL;
+
+  ++cache->numCombines;
+  cache->data[cache->numData] = outData;
+  return REF_TO_TOKEN( cache->numData++ );
+}
+
+
+/************************ Lookup ******************/
+
+#define HashValue(h,v)	HashBytes( (h), &(v), sizeof( v ))
+
+static unsigned long HashBytes( unsigned long h, const void *p, size_t n )
+{
+  /* FNV-1a */
+  const unsigned char *b = (const unsigned char *) p;
+
+  while( n-- > 0 ) {
+    h = (h ^ *b++) * 16777619UL;
+  }
+  return h;
+}
+
+static unsigned long HashInput( GLUtesselator *tess )
+{
+  TessCache *cache = tess->resultCache;
+  unsigned long h = 2166136261UL;
+
+  h = HashValue( h, tess->windingRule );
+  h = HashValue( h, tess->boundaryOnly );
+  h = HashValue( h, tess->flagBoundary );
+  h = HashValue( h, tess->normal );
+  h = HashBytes( h, cache->contourSize, cache->numContours * sizeof( long ));
+  h = HashBytes( h, cache->coords, cache->numInput * 3 * sizeof( GLdouble ));
+  return h;
+}
+
+static GLboolean SameInput( GLUtesselator *tess, CacheEntry *entry )
+{
+  TessCache *cache = tess->resultCache;
+
+  return entry->windingRule == tess->windingRule
+    && entry->boundaryOnly == tess->boundaryOnly
+    && entry->flagBoundary == tess->flagBoundary
+    && memcmp( entry->normal, tess->normal, sizeof( entry->normal )) == 0
+    && entry->numContours == cache->numContours
+    && entry->numInput == cache->numInput
+    && memcmp( entry->contourSize, cache->contourSize,
+	       cache->numContours * sizeof( long )) == 0
+    && memcmp( entry->coords, cache->coords,
+	       cache->numInput * 3 * sizeof( GLdouble )) == 0;
+}
+
+static void Unlink( TessCache *cache, CacheEntry *entry )
+{
+  if( entry->prev != NULL ) {
+    entry->prev->next = entry->next;
+  } else {
+    cache->lruHead = entry->next;
+  }
+  if( entry->next != NULL ) {
+    entry->next->prev = entry->prev;
+  } else {
+    cache->lruTail = entry->prev;
+  }
+}
+
+static void LinkFirst( TessCache *cache, CacheEntry *entry )
+{
+  entry->prev = NULL;
+  entry->next = cache->lruHead;
+  if( cache->lruHead != NULL ) {
+    cache->lruHead->prev = entry;
+  } else {
+    cache->lruTail = entry;
+  }
+  cache->lruHead = entry;
+}
+
+static void Evict( TessCache *cache, CacheEntry *entry )
+{
+  CacheEntry **p = &cache->buckets[entry->hash & cache->bucketMask];
+
+  while( *p != entry ) p = &(*p)->chain;
+  *p = entry->chain;
+  Unlink( cache, entry );
+  --cache->numEntries;
+  memFree( entry );
+}
+
+static void Insert( TessCache *cache, CacheEntry *entry )
+{
+  CacheEntry **bucket;
+
+  if( cache->numEntries >= cache->maxEntries ) {
+    Evict( cache, cache->lruTail );
+  }
+  bucket = &cache->buckets[entry->hash & cache->bucketMask];
+  entry->chain = *bucket;
+  *bucket = entry;
+  LinkFirst( cache, entry );
+  ++cache->numEntries;
+}
+
+
+/************************ Output ******************/
+
+/* Send the stored result to the callbacks.  cache->data must hold the
+ * client data for every token the entry uses.
+ */
+static void RenderEntry( GLUtesselator *tess, CacheEntry *entry )
+{
+  TessCache *cache = tess->resultCache;
+  GLuint *index;
+  long i, j;
+  int edgeState = -1;	/* force edge state output for first vertex */
+
+  __gl_renderReserve( tess, entry->numVertices, entry->numIndices );
+  for( i = 0; i < entry->numVertices; ++i ) {
+    tess->outVertices[i] = cache->data[entry->vertices[i]];
+  }
+  memcpy( tess->outIndices, entry->indices,
+	  entry->numIndices * sizeof( GLuint ));
+  tess->outVertexCount = entry->numVertices;
+  tess->outIndexCount = entry->numIndices;
+
+  if( INDEXED_OUTPUT( tess )) {
+    CALL_INDEXED_TRIANGLES();
+    return;
+  }
+
+  index = tess->outIndices;
+  if( entry->boundaryOnly ) {
+    for( i = 0; i < entry->numLoops; ++i ) {
+      CALL_BEGIN_OR_BEGIN_DATA( GL_LINE_LOOP );
+      for( j = 0; j < entry->loopSize[i]; ++j ) {
+	CALL_VERTEX_OR_VERTEX_DATA( tess->outVertices[*index++] );
+      }
+      CALL_END_OR_END_DATA();
+    }
+  } else if( entry->numIndices > 0 ) {
+    CALL_BEGIN_OR_BEGIN_DATA( GL_TRIANGLES );
+    for( i = 0; i < entry->numIndices; ++i ) {
+      if( entry->edgeFlags != NULL && edgeState != entry->edgeFlags[i] ) {
+	edgeState = entry->edgeFlags[i];
+	CALL_EDGE_FLAG_OR_EDGE_FLAG_DATA( edgeState );
+      }
+      CALL_VERTEX_OR_VERTEX_DATA( tess->outVertices[index[i]] );
+    }
+    CALL_END_OR_END_DATA();
+  }
+}
+
+
+/* Repeat the recorded combine calls with this polygon's client data.
+ * Returns FALSE if the client no longer creates the vertices.
+ */
+static GLboolean ReplayCombines( GLUtesselator *tess, CacheEntry *entry )
+{
+  TessCache *cache = tess->resultCache;
+  CombineRecord *r;
+  GLdouble coords[3];
+  GLfloat weight[4];
+  void *src[4];
+  void *outData;
+  long k;
+  int i;
+
+  if( ! Grow( (void **)&cache->data, &cache->maxData,
+	      cache->numInput + entry->numCombines, sizeof( void * ))) {
+    longjmp( tess->env, 1 );
+  }
+  cache->numData = cache->numInput;
+  for( k = 0; k < entry->numCombines; ++k ) {
+    r = &entry->combines[k];
+    for( i = 0; i < 3; ++i ) {
+      coords[i] = r->coords[i];
+    }
+    for( i = 0; i < 4; ++i ) {
+      weight[i] = r->weight[i];
+      src[i] = (r->src[i] < 0) ? NULL : cache->data[r->src[i]];
+    }
+    outData = NULL;
+    CALL_COMBINE_OR_COMBINE_DATA( coords, src, weight, &outData );
+    if( outData == NULL ) {
+      CALL_ERROR_OR_ERROR_DATA( GLU_TESS_NEED_COMBINE_CALLBACK );
+      return FALSE;
+    }
+    cache->data[cache->numData++] = outData;
+  }
+  return TRUE;
+}
+
+
+GLboolean __gl_cacheReplay( GLUtesselator *tess )
+{
+  TessCache *cache = tess->resultCache;
+  CacheEntry *entry = NULL;
+
+  cache->inputHash = HashInput( tess );
+  if( cache->buckets != NULL ) {
+    entry = cache->buckets[cache->inputHash & cache->bucketMask];
+    while( entry != NULL && ! (entry->hash == cache->inputHash
+			       && SameInput( tess, entry ))) {
+      entry = entry->chain;
+    }
+  }
+  if( entry == NULL ) {
+    ++cache->misses;
+    return FALSE;
+  }
+  ++cache->hits;
+  Unlink( cache, entry );
+  LinkFirst( cache, entry );
+
+  if( ReplayCombines( tess, entry )) {
+    RenderEntry( tess, entry );
+  }
+  return TRUE;
+}
+
+
+void __gl_cacheRecord( GLUtesselator *tess, GLUmesh *mesh )
+{
+  TessCache *cache = tess->resultCache;
+  CacheEntry *entry;
+  GLUvertex *v;
+  GLUface *f;
+  GLUhalfEdge *e;
+  long numVertices = 0, numIndices = 0, numLoops = 0, first;
+  size_t size;
+  char *p;
+
+  for( v = mesh->vHead.next; v != &mesh->vHead; v = v->next ) {
+    v->index = -1;
+    ++numVertices;
+  }
+  for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+    if( ! f->inside ) continue;
+    e = f->anEdge;
+    do {
+      ++numIndices;
+      e = e->Lnext;
+    } while( e != f->anEdge );
+    ++numLoops;
+  }
+  /* Reserve the output buffers now, so RenderEntry cannot fail
+   * once the entry is allocated.
+   */
+  __gl_renderReserve( tess, numVertices, numIndices );
+
+  size = ROUND( sizeof( CacheEntry ))
+    + ROUND( cache->numInput * 3 * sizeof( GLdouble ))
+    + ROUND( cache->numCombines * sizeof( CombineRecord ))
+    + ROUND( cache->numContours * sizeof( long ))
+    + ROUND( numVertices * sizeof( long ))
+    + ROUND( numIndices * sizeof( GLuint ))
+    + ROUND( numIndices * sizeof( GLboolean ))
+    + ROUND( numLoops * sizeof( long ));
+  p = (char *)memAlloc( size );
+  if( p == NULL ) longjmp( tess->env, 1 );
+
+  entry = (CacheEntry *) p;		p += ROUND( sizeof( CacheEntry ));
+  entry->coords = (GLdouble *) p;
+  p += ROUND( cache->numInput * 3 * sizeof( GLdouble ));
+  entry->combines = (CombineRecord *) p;
+  p += ROUND( cache->numCombines * sizeof( CombineRecord ));
+  entry->contourSize = (long *) p;
+  p += ROUND( cache->numContours * sizeof( long ));
+  entry->vertices = (long *) p;		p += ROUND( numVertices * sizeof( long ));
+  entry->indices = (GLuint *) p;	p += ROUND( numIndices * sizeof( GLuint ));
+  entry->edgeFlags = (GLboolean *) p;	p += ROUND( numIndices * sizeof( GLboolean ));
+  entry->loopSize = (long *) p;
+
+  entry->hash = cache->inputHash;
+  entry->windingRule = tess->windingRule;
+  entry->boundaryOnly = tess->boundaryOnly;
+  entry->flagBoundary = tess->flagBoundary;
+  memcpy( entry->normal, tess->normal, sizeof( entry->normal ));
+  entry->numContours = cache->numContours;
+  entry->numInput = cache->numInput;
+  memcpy( entry->contourSize, cache->contourSize,
+	  cache->numContours * sizeof( long ));
+  memcpy( entry->coords, cache->coords,
+	  cache->numInput * 3 * sizeof( GLdouble ));
+  entry->numCombines = cache->numCombines;
+  memcpy( entry->combines, cache->combines,
+	  cache->numCombines * sizeof( CombineRecord ));
+  if( ! entry->flagBoundary || entry->boundaryOnly ) entry->edgeFlags = NULL;
+  if( ! entry->boundaryOnly ) entry->loopSize = NULL;
+
+  /* Number the output vertices in order of first use, as
+   * __gl_renderIndexed does.
+   */
+  entry->numVertices = 0;
+  entry->numIndices = 0;
+  entry->numLoops = 0;
+  for( f = mesh->fHead.next; f != &mesh->fHead; f = f->next ) {
+    if( ! f->inside ) continue;
+    first = entry->numIndices;
+    e = f->anEdge;
+    do {
+      v = e->Org;
+      if( v->index < 0 ) {
+	v->index = entry->numVertices;
+	entry->vertices[entry->numVertices++] = TOKEN_TO_REF( v->data );
+      }
+      if( entry->edgeFlags != NULL ) {
+	entry->edgeFlags[entry->numIndices] = ! e->Rface->inside;
+      }
+      entry->indices[entry->numIndices++] = (GLuint) v->index;
+      e = e->Lnext;
+    } while( e != f->anEdge );
+    if( entry->loopSize != NULL ) {
+      entry->loopSize[entry->numLoops] = entry->numIndices - first;
+    }
+    ++entry->numLoops;
+  }
+  assert( entry->boundaryOnly || entry->numIndices == 3 * entry->numLoops );
+
+  RenderEntry( tess, entry );
+
+  if( cache->maxEntries > 0 ) {
+    Insert( cache, entry );
+  } else {
+    memFree( entry );
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+ * Copyright (C) 1991-2000 Silicon Graphics, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice including the dates of first publication and
+ * either this permission notice or a reference to
+ * http://oss.sgi.com/projects/FreeB/
+ * shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * SILICON GRAPHICS, INC. BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Except as contained in this notice, the name of Silicon Graphics, Inc.
+ * shall not be used in advertising or otherwise to promote the sale, use or
+ * other dealings in this Software without prior written authorization from
+ * Silicon Graphics, Inc.
+ */
+
+#ifndef __tesscache_h_
+#define __tesscache_h_
+
+#include "mesh.h"
+
+/* The result cache remembers the output of recent polygons, so that a
+ * client which tessellates the same contours again (typically once per
+ * frame) gets the stored triangles back without another sweep.
+ *
+ * While a polygon is being recorded, the input vertices are only copied
+ * into the cache; the mesh is built from this copy on a cache miss.  The
+ * client data pointers are replaced by small integer tokens (an index
+ * into "data", plus one) so that the stored result does not refer to
+ * this frame's data.  Vertices created by the combine callback get the
+ * next tokens, and the combine calls themselves are recorded so they
+ * can be repeated (with the new frame's data) on a hit.
+ */
+
+typedef struct CombineRecord {
+  GLdouble	coords[3];
+  GLfloat	weight[4];
+  long		src[4];		/* tokens of the source vertices, or -1 */
+} CombineRecord;
+
+typedef struct CacheEntry CacheEntry;
+
+typedef struct TessCache {
+  long		maxEntries;	/* 0 disables the cache */
+  long		numEntries;
+  CacheEntry	*lruHead;	/* most recently used entry */
+  CacheEntry	*lruTail;	/* next to be evicted */
+  CacheEntry	**buckets;	/* hash chains */
+  unsigned long	bucketMask;
+
+  long		hits, misses;
+
+  /* input of the polygon being recorded */
+  unsigned long	inputHash;
+  GLdouble	*coords;	/* three per input vertex */
+  long		numInput, maxInput;
+  void		**data;		/* input vertices, then combined vertices */
+  long		numData, maxData;
+  long		*contourSize;
+  long		numContours, maxContours;
+  CombineRecord	*combines;	/* combine calls made during the sweep */
+  long		numCombines, maxCombines;
+} TessCache;
+
+#define TOKEN_TO_REF(p)	((long)(size_t)(p) - 1)
+#define REF_TO_TOKEN(r)	((void *)(size_t)((r) + 1))
+
+TessCache *__gl_cacheNew( void );
+void __gl_cacheDelete( TessCache *cache );
+int __gl_cacheSetSize( TessCache *cache, long maxEntries );
+
+/* Input recording: __gl_cacheBeginPolygon() discards the previous input,
+ * __gl_cacheBeginContour() starts a new contour, __gl_cacheVertex()
+ * appends one vertex and returns 0 if out of memory.
+ */
+void __gl_cacheBeginPolygon( TessCache *cache );
+int __gl_cacheBeginContour( TessCache *cache );
+int __gl_cacheVertex( TessCache *cache, GLdouble coords[3], void *data );
+
+/* __gl_cacheCombine( tess, coords, data, weight ) is called by the sweep
+ * instead of the combine callback while recording.  "data" holds
+ * tokens; the return value is a new token, or NULL if the client did
+ * not create a vertex.
+ */
+void *__gl_cacheCombine( GLUtesselator *tess, GLdouble coords[3],
+			 void *data[4], GLfloat weight[4] );
+
+/* __gl_cacheReplay( tess ) looks up the recorded input.  On a hit it
+ * sends the stored output to the callbacks and returns TRUE.
+ *
+ * __gl_cacheRecord( tess, mesh ) stores the result of a miss, taken
+ * from the finished mesh, and sends it to the callbacks the same way.
+ */
+GLboolean __gl_cacheReplay( GLUtesselator *tess );
+void __gl_cacheRecord( GLUtesselator *tess, GLUmesh *mesh );
+
+#endif
@@ -36,6 +36,22 @@
 #include <string.h>
 #include <limits.h>		/* UINT_MAX */
 #include <math.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLU_SIMD_HAVE_SSE2 1
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GLU_SIMD_HAVE_AVX2 1
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GLU_SIMD_HAVE_NEON 1
+#endif
 
 typedef union {
     unsigned char ub[4];
@@ -246,6 +262,15 @@ static void emptyImage3D(const PixelStorageModes *,
 static void scaleInternal3D(GLint, GLint, GLint, GLint, const GLushort *,
 			    GLint, GLint, GLint, GLushort *);
 
+typedef GLint (*HalveRowProc)(GLint, GLint, const void *, const void *,
+			      void *);
+typedef GLint (*Halve1DRowProc)(GLint, GLint, const void *, void *);
+typedef GLint (*Halve3DRowProc)(GLint, GLint, const void *, const void *,
+				const void *, const void *, void *);
+static HalveRowProc halveRowProc(GLenum, GLint, GLint, GLint);
+static Halve1DRowProc halve1DRowProc(GLenum, GLint, GLint, GLint);
+static Halve3DRowProc halve3DRowProc(GLenum, GLint, GLint, GLint);
+
 static void retrieveStoreModes(PixelStorageModes *psm)
 {
     glGetIntegerv(GL_UNPACK_ALIGNMENT, &psm->unpack_alignment);
@@ -284,6 +309,116 @@ static void retrieveStoreModes3D(PixelStorageModes *psm)
     glGetIntegerv(GL_PACK_IMAGE_HEIGHT, &psm->pack_image_height);
 }
 
+/*
+** Per-thread scratch arena for the image buffers of the mipmap builders
+** and the rescalers.  Blocks are handed out and released in LIFO order.
+** A request that doesn't fit while other blocks are live is served by
+** malloc instead, but remembered, so the next time the arena is empty it
+** grows to hold everything at once.  After the first build of a given
+** size no further heap allocations are made.  The arena is kept until
+** the thread exits.
+*/
+#define SCRATCH_ALIGN 16
+
+typedef struct {
+    char *base;
+    size_t capacity;
+    size_t used;
+    size_t spilled;	/* bytes served by malloc since the arena was empty */
+    size_t wanted;	/* most bytes ever needed at once */
+} ScratchArena;
+
+#ifdef _WIN32
+static __declspec(thread) ScratchArena scratchArenaTLS;
+
+static ScratchArena *getScratchArena(void)
+{
+    return &scratchArenaTLS;
+}
+#else
+static pthread_key_t scratchKey;
+static pthread_once_t scratchOnce = PTHREAD_ONCE_INIT;
+static int scratchKeyValid;
+
+static void freeScratchArena(void *data)
+{
+    ScratchArena *arena = (ScratchArena *)data;
+
+    free(arena->base);
+    free(arena);
+}
+
+static void initScratchKey(void)
+{
+    scratchKeyValid = pthread_key_create(&scratchKey, freeScratchArena) == 0;
+}
+
+static ScratchArena *getScratchArena(void)
+{
+    ScratchArena *arena;
+
+    pthread_once(&scratchOnce, initScratchKey);
+    if (!scratchKeyValid) {
+	return NULL;
+    }
+    arena = (ScratchArena *)pthread_getspecific(scratchKey);
+    if (arena == NULL) {
+	arena = (ScratchArena *)calloc(1, sizeof(ScratchArena));
+	if (arena == NULL) {
+	    return NULL;
+	}
+	if (pthread_setspecific(scratchKey, arena) != 0) {
+	    free(arena);
+	    return NULL;
+	}
+    }
+    return arena;
+}
+#endif
+
+static void *scratchAlloc(size_t size)
+{
+    ScratchArena *arena = getScratchArena();
+    size_t need = (size + SCRATCH_ALIGN - 1) & ~(size_t)(SCRATCH_ALIGN - 1);
+    void *block;
+
+    if (arena == NULL) {
+	return malloc(size);
+    }
+    if (arena->used == 0) {
+	arena->spilled = 0;
+    }
+    if (arena->used + arena->spilled + need > arena->wanted) {
+	arena->wanted = arena->used + arena->spilled + need;
+    }
+    if (arena->used == 0 && arena->capacity < arena->wanted) {
+	free(arena->base);
+	arena->base = (char *)malloc(arena->wanted);
+	arena->capacity = arena->base ? arena->wanted : 0;
+    }
+    if (arena->used + need > arena->capacity) {
+	arena->spilled += need;
+	return malloc(size);
+    }
+    block = arena->base + arena->used;
+    arena->used += need;
+    return block;
+}
+
+/* Releases block and everything handed out after it. */
+static void scratchFree(void *block)
+{
+    ScratchArena *arena = getScratchArena();
+    char *p = (char *)block;
+
+    if (arena != NULL && arena->base != NULL &&
+	p >= arena->base && p < arena->base + arena->capacity) {
+	arena->used = p - arena->base;
+    } else {
+	free(block);
+    }
+}
+
 static int computeLog(GLuint value)
 {
     int i;
@@ -336,187 +471,1298 @@ static int nearestPower(GLuint value)
         ((GLuint)((const GLubyte*)(s))[2])<<16 | \
         ((GLuint)((const GLubyte*)(s))[1])<<8  | ((const GLubyte*)(s))[0])
 
-static void halveImage(GLint components, GLuint width, GLuint height,
-		       const GLushort *datain, GLushort *dataout)
+/*
+** SIMD versions of the 2x2 box filter.
+**
+** A row kernel reduces the pixel pairs of one destination row (two source
+** rows for halveImage_*, one for the single-row case of halve1Dimage_*)
+** and returns how many destination groups it produced; the scalar loops
+** pick up from there to finish the row.  The kernels are only used for
+** data that needs no byte swapping and whose components are tightly
+** packed, and they produce exactly the same values as the scalar code:
+** integer types are averaged in a wider type with the same rounding, and
+** floats are summed in the same order.
+**
+** SSE2 and AVX2 handle groups of 1, 2 or 4 components, NEON handles 1
+** to 4.  AVX2 is only used for the 2D kernels and is picked at run time.
+**
+** Defining GLU_MIPMAP_SCALAR leaves this and the other fast paths of this
+** file out at run time; the tests build a copy of it that way to compare
+** against.
+*/
+#define GLU_SIMD_NONE	0
+#define GLU_SIMD_SSE2	1
+#define GLU_SIMD_AVX2	2
+#define GLU_SIMD_NEON	3
+
+static int simdLevel(void)
 {
-    int i, j, k;
-    int newwidth, newheight;
-    int delta;
-    GLushort *s;
-    const GLushort *t;
+#if defined(GLU_MIPMAP_SCALAR)
+    return GLU_SIMD_NONE;
+#elif defined(GLU_SIMD_HAVE_SSE2)
+#if defined(GLU_SIMD_HAVE_AVX2)
+    if (__builtin_cpu_supports("avx2")) return GLU_SIMD_AVX2;
+#endif
+    return GLU_SIMD_SSE2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+    return GLU_SIMD_NEON;
+#else
+    return GLU_SIMD_NONE;
+#endif
+}
 
-    newwidth = width / 2;
-    newheight = height / 2;
-    delta = width * components;
-    s = dataout;
-    t = datain;
+#if defined(GLU_SIMD_HAVE_SSE2)
+/* Splits v0:v1 into its even and odd groups of 32-bit lanes. */
+static void evenOdd_sse2(GLint components, __m128 v0, __m128 v1,
+			 __m128 *even, __m128 *odd)
+{
+    switch (components) {
+    case 1:
+	*even = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2,0,2,0));
+	*odd = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3,1,3,1));
+	break;
+    case 2:
+	*even = _mm_movelh_ps(v0, v1);
+	*odd = _mm_movehl_ps(v1, v0);
+	break;
+    default:
+	*even = v0;
+	*odd = v1;
+	break;
+    }
+}
 
-    /* Piece o' cake! */
-    for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
-	    for (k = 0; k < components; k++) {
-		s[0] = (t[0] + t[components] + t[delta] +
-			t[delta+components] + 2) / 4;
-		s++; t++;
-	    }
-	    t += components;
-	}
-	t += delta;
+/* Adds the even and odd groups of 16-bit lanes in lo:hi (2 or 4 lanes
+** per group). */
+static __m128i pairSum16_sse2(GLint components, __m128i lo, __m128i hi)
+{
+    if (components == 2) {
+	lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3,1,2,0));
+	hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3,1,2,0));
     }
+    return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi),
+			 _mm_unpackhi_epi64(lo, hi));
 }
 
-static void halveImage_ubyte(GLint components, GLuint width, GLuint height,
-			const GLubyte *datain, GLubyte *dataout,
-			GLint element_size, GLint ysize, GLint group_size)
+/* Adds the even and odd groups of 32-bit lanes in v0:v1. */
+static __m128i pairSum32_sse2(GLint components, __m128i v0, __m128i v1)
 {
-    int i, j, k;
-    int newwidth, newheight;
-    int padBytes;
-    GLubyte *s;
-    const char *t;
+    __m128 even, odd;
 
-    /* handle case where there is only 1 column/row */
-    if (width == 1 || height == 1) {
-       assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
-       halve1Dimage_ubyte(components,width,height,datain,dataout,
-			  element_size,ysize,group_size);
-       return;
-    }
+    evenOdd_sse2(components, _mm_castsi128_ps(v0), _mm_castsi128_ps(v1),
+		 &even, &odd);
+    return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+}
 
-    newwidth = width / 2;
-    newheight = height / 2;
-    padBytes = ysize - (width*group_size);
-    s = dataout;
-    t = (const char *)datain;
+/* SSE2 has no unsigned 32 to 16 bit pack, so bias into signed range. */
+static __m128i packus32_sse2(__m128i lo, __m128i hi)
+{
+    const __m128i bias = _mm_set1_epi32(0x8000);
 
-    /* Piece o' cake! */
-    for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
-	    for (k = 0; k < components; k++) {
-		s[0] = (*(const GLubyte*)t +
-			*(const GLubyte*)(t+group_size) +
-			*(const GLubyte*)(t+ysize) +
-			*(const GLubyte*)(t+ysize+group_size) + 2) / 4;
-		s++; t += element_size;
-	    }
-	    t += group_size;
+    lo = _mm_sub_epi32(lo, bias);
+    hi = _mm_sub_epi32(hi, bias);
+    return _mm_xor_si128(_mm_packs_epi32(lo, hi),
+			 _mm_set1_epi16((short)0x8000));
+}
+
+static GLint halveRow_ubyte_sse2(GLint components, GLint groups,
+				 const void *row0, const void *row1,
+				 void *dest)
+{
+    const GLubyte *t0 = (const GLubyte *)row0;
+    const GLubyte *t1 = (const GLubyte *)row1;
+    GLubyte *s = (GLubyte *)dest;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    const __m128i two = _mm_set1_epi16(2);
+    GLint n = groups * components;
+    GLint i;
+
+    /* 16 bytes of each source row make 8 destination bytes */
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m128i a = _mm_loadu_si128((const __m128i *)(t0 + 2*i));
+	__m128i b = _mm_loadu_si128((const __m128i *)(t1 + 2*i));
+	__m128i sum;
+
+	if (components == 1) {
+	    sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, mask),
+					      _mm_srli_epi16(a, 8)),
+				_mm_add_epi16(_mm_and_si128(b, mask),
+					      _mm_srli_epi16(b, 8)));
+	} else {
+	    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+				       _mm_unpacklo_epi8(b, zero));
+	    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+				       _mm_unpackhi_epi8(b, zero));
+	    sum = pairSum16_sse2(components, lo, hi);
 	}
-	t += padBytes;
-	t += ysize;
+	sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+	_mm_storel_epi64((__m128i *)(s + i), _mm_packus_epi16(sum, sum));
     }
+    return i / components;
 }
 
-/* */
-static void halve1Dimage_ubyte(GLint components, GLuint width, GLuint height,
-			       const GLubyte *dataIn, GLubyte *dataOut,
-			       GLint element_size, GLint ysize,
-			       GLint group_size)
+static GLint halve1DRow_ubyte_sse2(GLint components, GLint groups,
+				   const void *src, void *dest)
 {
-   GLint halfWidth= width / 2;
-   GLint halfHeight= height / 2;
-   const char *src= (const char *) dataIn;
-   GLubyte *dest= dataOut;
-   int jj;
-
-   assert(width == 1 || height == 1); /* must be 1D */
-   assert(width != height);	/* can't be square */
-
-   if (height == 1) {		/* 1 row */
-      assert(width != 1);	/* widthxheight can't be 1x1 */
-      halfHeight= 1;
+    const GLubyte *t = (const GLubyte *)src;
+    GLubyte *s = (GLubyte *)dest;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    GLint n = groups * components;
+    GLint i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m128i a = _mm_loadu_si128((const __m128i *)(t + 2*i));
+	__m128i sum;
+
+	if (components == 1) {
+	    sum = _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+	} else {
+	    sum = pairSum16_sse2(components, _mm_unpacklo_epi8(a, zero),
+				 _mm_unpackhi_epi8(a, zero));
+	}
+	sum = _mm_srli_epi16(sum, 1);
+	_mm_storel_epi64((__m128i *)(s + i), _mm_packus_epi16(sum, sum));
+    }
+    return i / components;
+}
 
-      for (jj= 0; jj< halfWidth; jj++) {
-	 int kk;
-	 for (kk= 0; kk< components; kk++) {
-	    *dest= (*(const GLubyte*)src +
-		 *(const GLubyte*)(src+group_size)) / 2;
+static GLint halveRow_ushort_sse2(GLint components, GLint groups,
+				  const void *row0, const void *row1,
+				  void *dest)
+{
+    const GLushort *t0 = (const GLushort *)row0;
+    const GLushort *t1 = (const GLushort *)row1;
+    GLushort *s = (GLushort *)dest;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi32(2);
+    GLint n = groups * components;
+    GLint i;
+
+    /* 16 shorts of each source row make 8 destination shorts */
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m128i a0 = _mm_loadu_si128((const __m128i *)(t0 + 2*i));
+	__m128i a1 = _mm_loadu_si128((const __m128i *)(t0 + 2*i + 8));
+	__m128i b0 = _mm_loadu_si128((const __m128i *)(t1 + 2*i));
+	__m128i b1 = _mm_loadu_si128((const __m128i *)(t1 + 2*i + 8));
+	__m128i v0 = _mm_add_epi32(_mm_unpacklo_epi16(a0, zero),
+				   _mm_unpacklo_epi16(b0, zero));
+	__m128i v1 = _mm_add_epi32(_mm_unpackhi_epi16(a0, zero),
+				   _mm_unpackhi_epi16(b0, zero));
+	__m128i v2 = _mm_add_epi32(_mm_unpacklo_epi16(a1, zero),
+				   _mm_unpacklo_epi16(b1, zero));
+	__m128i v3 = _mm_add_epi32(_mm_unpackhi_epi16(a1, zero),
+				   _mm_unpackhi_epi16(b1, zero));
+	__m128i lo = pairSum32_sse2(components, v0, v1);
+	__m128i hi = pairSum32_sse2(components, v2, v3);
+
+	lo = _mm_srli_epi32(_mm_add_epi32(lo, two), 2);
+	hi = _mm_srli_epi32(_mm_add_epi32(hi, two), 2);
+	_mm_storeu_si128((__m128i *)(s + i), packus32_sse2(lo, hi));
+    }
+    return i / components;
+}
 
-	    src+= element_size;
-	    dest++;
-	 }
-	 src+= group_size;	/* skip to next 2 */
-      }
-      {
-	 int padBytes= ysize - (width*group_size);
-	 src+= padBytes;	/* for assertion only */
-      }
-   }
-   else if (width == 1) {	/* 1 column */
-      int padBytes= ysize - (width * group_size);
-      assert(height != 1);	/* widthxheight can't be 1x1 */
-      halfWidth= 1;
-      /* one vertical column with possible pad bytes per row */
-      /* average two at a time */
+static GLint halve1DRow_ushort_sse2(GLint components, GLint groups,
+				    const void *src, void *dest)
+{
+    const GLushort *t = (const GLushort *)src;
+    GLushort *s = (GLushort *)dest;
+    const __m128i zero = _mm_setzero_si128();
+    GLint n = groups * components;
+    GLint i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m128i a0 = _mm_loadu_si128((const __m128i *)(t + 2*i));
+	__m128i a1 = _mm_loadu_si128((const __m128i *)(t + 2*i + 8));
+	__m128i lo = pairSum32_sse2(components, _mm_unpacklo_epi16(a0, zero),
+				    _mm_unpackhi_epi16(a0, zero));
+	__m128i hi = pairSum32_sse2(components, _mm_unpacklo_epi16(a1, zero),
+				    _mm_unpackhi_epi16(a1, zero));
+
+	_mm_storeu_si128((__m128i *)(s + i),
+			 packus32_sse2(_mm_srli_epi32(lo, 1),
+				       _mm_srli_epi32(hi, 1)));
+    }
+    return i / components;
+}
 
-      for (jj= 0; jj< halfHeight; jj++) {
-	 int kk;
-	 for (kk= 0; kk< components; kk++) {
-	    *dest= (*(const GLubyte*)src + *(const GLubyte*)(src+ysize)) / 2;
+static GLint halveRow_float_sse2(GLint components, GLint groups,
+				 const void *row0, const void *row1,
+				 void *dest)
+{
+    const GLfloat *t0 = (const GLfloat *)row0;
+    const GLfloat *t1 = (const GLfloat *)row1;
+    GLfloat *s = (GLfloat *)dest;
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    GLint n = groups * components;
+    GLint i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+	__m128 e0, o0, e1, o1, sum;
+
+	evenOdd_sse2(components, _mm_loadu_ps(t0 + 2*i),
+		     _mm_loadu_ps(t0 + 2*i + 4), &e0, &o0);
+	evenOdd_sse2(components, _mm_loadu_ps(t1 + 2*i),
+		     _mm_loadu_ps(t1 + 2*i + 4), &e1, &o1);
+	/* same summation order as the scalar loop */
+	sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(e0, o0), e1), o1);
+	_mm_storeu_ps(s + i, _mm_mul_ps(sum, quarter));
+    }
+    return i / components;
+}
 
-	    src+= element_size;
-	    dest++;
-	 }
-	 src+= padBytes; /* add pad bytes, if any, to get to end to row */
-	 src+= ysize;
-      }
-   }
+static GLint halve1DRow_float_sse2(GLint components, GLint groups,
+				   const void *src, void *dest)
+{
+    const GLfloat *t = (const GLfloat *)src;
+    GLfloat *s = (GLfloat *)dest;
+    const __m128 half = _mm_set1_ps(0.5f);
+    GLint n = groups * components;
+    GLint i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+	__m128 even, odd;
+
+	evenOdd_sse2(components, _mm_loadu_ps(t + 2*i),
+		     _mm_loadu_ps(t + 2*i + 4), &even, &odd);
+	_mm_storeu_ps(s + i, _mm_mul_ps(_mm_add_ps(even, odd), half));
+    }
+    return i / components;
+}
 
-   assert(src == &((const char *)dataIn)[ysize*height]);
-   assert((char *)dest == &((char *)dataOut)
-	  [components * element_size * halfWidth * halfHeight]);
-} /* halve1Dimage_ubyte() */
+/*
+** 2x2x2 kernels for halveImage3D(): row0 and row1 are a row pair of one
+** image, row2 and row3 the same pair of the next.  Like shoveUbyte() and
+** shoveUshort(), the average of the 8 pixels is truncated.
+*/
+static GLint halve3DRow_ubyte_sse2(GLint components, GLint groups,
+				   const void *row0, const void *row1,
+				   const void *row2, const void *row3,
+				   void *dest)
+{
+    const GLubyte *t[4];
+    GLubyte *s = (GLubyte *)dest;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    GLint n = groups * components;
+    GLint i, r;
+
+    t[0] = (const GLubyte *)row0;
+    t[1] = (const GLubyte *)row1;
+    t[2] = (const GLubyte *)row2;
+    t[3] = (const GLubyte *)row3;
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m128i sum = zero, lo = zero, hi = zero;
+
+	for (r = 0; r < 4; r++) {
+	    __m128i a = _mm_loadu_si128((const __m128i *)(t[r] + 2*i));
+
+	    if (components == 1) {
+		sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_and_si128(a, mask),
+						       _mm_srli_epi16(a, 8)));
+	    } else {
+		lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(a, zero));
+		hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(a, zero));
+	    }
+	}
+	if (components != 1) {
+	    sum = pairSum16_sse2(components, lo, hi);
+	}
+	sum = _mm_srli_epi16(sum, 3);
+	_mm_storel_epi64((__m128i *)(s + i), _mm_packus_epi16(sum, sum));
+    }
+    return i / components;
+}
 
-static void halveImage_byte(GLint components, GLuint width, GLuint height,
-			const GLbyte *datain, GLbyte *dataout,
-			GLint element_size,
-			GLint ysize, GLint group_size)
+static GLint halve3DRow_ushort_sse2(GLint components, GLint groups,
+				    const void *row0, const void *row1,
+				    const void *row2, const void *row3,
+				    void *dest)
 {
-    int i, j, k;
-    int newwidth, newheight;
-    int padBytes;
-    GLbyte *s;
-    const char *t;
+    const GLushort *t[4];
+    GLushort *s = (GLushort *)dest;
+    const __m128i zero = _mm_setzero_si128();
+    GLint n = groups * components;
+    GLint i, r;
+
+    t[0] = (const GLushort *)row0;
+    t[1] = (const GLushort *)row1;
+    t[2] = (const GLushort *)row2;
+    t[3] = (const GLushort *)row3;
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m128i v0 = zero, v1 = zero, v2 = zero, v3 = zero, lo, hi;
+
+	for (r = 0; r < 4; r++) {
+	    __m128i a0 = _mm_loadu_si128((const __m128i *)(t[r] + 2*i));
+	    __m128i a1 = _mm_loadu_si128((const __m128i *)(t[r] + 2*i + 8));
+
+	    v0 = _mm_add_epi32(v0, _mm_unpacklo_epi16(a0, zero));
+	    v1 = _mm_add_epi32(v1, _mm_unpackhi_epi16(a0, zero));
+	    v2 = _mm_add_epi32(v2, _mm_unpacklo_epi16(a1, zero));
+	    v3 = _mm_add_epi32(v3, _mm_unpackhi_epi16(a1, zero));
+	}
+	lo = _mm_srli_epi32(pairSum32_sse2(components, v0, v1), 3);
+	hi = _mm_srli_epi32(pairSum32_sse2(components, v2, v3), 3);
+	_mm_storeu_si128((__m128i *)(s + i), packus32_sse2(lo, hi));
+    }
+    return i / components;
+}
 
-    /* handle case where there is only 1 column/row */
-    if (width == 1 || height == 1) {
-       assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
-       halve1Dimage_byte(components,width,height,datain,dataout,
-			 element_size,ysize,group_size);
-       return;
+/*
+** The scalar code sums floats in double, which is kept here so that the
+** results stay identical.
+*/
+static GLint halve3DRow_float_sse2(GLint components, GLint groups,
+				   const void *row0, const void *row1,
+				   const void *row2, const void *row3,
+				   void *dest)
+{
+    const GLfloat *t[4];
+    GLfloat *s = (GLfloat *)dest;
+    const __m128d eighth = _mm_set1_pd(0.125);
+    GLint n = groups * components;
+    GLint i, r;
+
+    t[0] = (const GLfloat *)row0;
+    t[1] = (const GLfloat *)row1;
+    t[2] = (const GLfloat *)row2;
+    t[3] = (const GLfloat *)row3;
+    for (i = 0; i + 4 <= n; i += 4) {
+	__m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd();
+	__m128 even, odd;
+
+	for (r = 0; r < 4; r++) {
+	    evenOdd_sse2(components, _mm_loadu_ps(t[r] + 2*i),
+			 _mm_loadu_ps(t[r] + 2*i + 4), &even, &odd);
+	    lo = _mm_add_pd(_mm_add_pd(lo, _mm_cvtps_pd(even)),
+			    _mm_cvtps_pd(odd));
+	    hi = _mm_add_pd(_mm_add_pd(hi,
+				       _mm_cvtps_pd(_mm_movehl_ps(even, even))),
+			    _mm_cvtps_pd(_mm_movehl_ps(odd, odd)));
+	}
+	_mm_storeu_ps(s + i,
+		      _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(lo, eighth)),
+				    _mm_cvtpd_ps(_mm_mul_pd(hi, eighth))));
     }
+    return i / components;
+}
+#endif /* GLU_SIMD_HAVE_SSE2 */
 
-    newwidth = width / 2;
-    newheight = height / 2;
-    padBytes = ysize - (width*group_size);
-    s = dataout;
-    t = (const char *)datain;
+#if defined(GLU_SIMD_HAVE_AVX2)
+/*
+** The AVX2 pair sums work within 128-bit lanes, so for 1 and 2 components
+** the 64-bit quarters of the result come out as 0,2,1,3 and need a final
+** permute.
+*/
+#define GLU_AVX2 __attribute__((target("avx2")))
 
-    /* Piece o' cake! */
-    for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
-	    for (k = 0; k < components; k++) {
-		s[0] = (*(const GLbyte*)t +
-			*(const GLbyte*)(t+group_size) +
-			*(const GLbyte*)(t+ysize) +
-			*(const GLbyte*)(t+ysize+group_size) + 2) / 4;
-		s++; t += element_size;
+GLU_AVX2
+static void evenOdd_avx2(GLint components, __m256 v0, __m256 v1,
+			 __m256 *even, __m256 *odd)
+{
+    switch (components) {
+    case 1:
+	*even = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(2,0,2,0));
+	*odd = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3,1,3,1));
+	break;
+    case 2:
+	*even = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(v0),
+						    _mm256_castps_pd(v1)));
+	*odd = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(v0),
+						   _mm256_castps_pd(v1)));
+	break;
+    default:
+	*even = _mm256_permute2f128_ps(v0, v1, 0x20);
+	*odd = _mm256_permute2f128_ps(v0, v1, 0x31);
+	break;
+    }
+}
+
+GLU_AVX2
+static GLint halveRow_ubyte_avx2(GLint components, GLint groups,
+				 const void *row0, const void *row1,
+				 void *dest)
+{
+    const GLubyte *t0 = (const GLubyte *)row0;
+    const GLubyte *t1 = (const GLubyte *)row1;
+    GLubyte *s = (GLubyte *)dest;
+    const __m256i mask = _mm256_set1_epi16(0x00ff);
+    const __m256i two = _mm256_set1_epi16(2);
+    GLint n = groups * components;
+    GLint i;
+
+    /* 32 bytes of each source row make 16 destination bytes */
+    for (i = 0; i + 16 <= n; i += 16) {
+	__m256i sum;
+
+	if (components == 1) {
+	    __m256i a = _mm256_loadu_si256((const __m256i *)(t0 + 2*i));
+	    __m256i b = _mm256_loadu_si256((const __m256i *)(t1 + 2*i));
+
+	    sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_and_si256(a, mask),
+						    _mm256_srli_epi16(a, 8)),
+				   _mm256_add_epi16(_mm256_and_si256(b, mask),
+						    _mm256_srli_epi16(b, 8)));
+	} else {
+	    __m256i lo = _mm256_add_epi16(
+		_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(t0 + 2*i))),
+		_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(t1 + 2*i))));
+	    __m256i hi = _mm256_add_epi16(
+		_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(t0 + 2*i + 16))),
+		_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(t1 + 2*i + 16))));
+
+	    if (components == 2) {
+		lo = _mm256_shuffle_epi32(lo, _MM_SHUFFLE(3,1,2,0));
+		hi = _mm256_shuffle_epi32(hi, _MM_SHUFFLE(3,1,2,0));
 	    }
-	    t += group_size;
+	    sum = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi),
+				   _mm256_unpackhi_epi64(lo, hi));
+	    sum = _mm256_permute4x64_epi64(sum, _MM_SHUFFLE(3,1,2,0));
 	}
-	t += padBytes;
-	t += ysize;
+	sum = _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+	_mm_storeu_si128((__m128i *)(s + i),
+			 _mm_packus_epi16(_mm256_castsi256_si128(sum),
+					  _mm256_extracti128_si256(sum, 1)));
     }
+    return i / components;
 }
 
-static void halve1Dimage_byte(GLint components, GLuint width, GLuint height,
-			      const GLbyte *dataIn, GLbyte *dataOut,
-			      GLint element_size,GLint ysize, GLint group_size)
+GLU_AVX2
+static GLint halveRow_ushort_avx2(GLint components, GLint groups,
+				  const void *row0, const void *row1,
+				  void *dest)
 {
-   GLint halfWidth= width / 2;
-   GLint halfHeight= height / 2;
-   const char *src= (const char *) dataIn;
-   GLbyte *dest= dataOut;
-   int jj;
+    const GLushort *t0 = (const GLushort *)row0;
+    const GLushort *t1 = (const GLushort *)row1;
+    GLushort *s = (GLushort *)dest;
+    const __m256i two = _mm256_set1_epi32(2);
+    GLint n = groups * components;
+    GLint i;
+
+    /* 16 shorts of each source row make 8 destination shorts */
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256i lo = _mm256_add_epi32(
+	    _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(t0 + 2*i))),
+	    _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(t1 + 2*i))));
+	__m256i hi = _mm256_add_epi32(
+	    _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(t0 + 2*i + 8))),
+	    _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(t1 + 2*i + 8))));
+	__m256 even, odd;
+	__m256i sum;
+
+	evenOdd_avx2(components, _mm256_castsi256_ps(lo),
+		     _mm256_castsi256_ps(hi), &even, &odd);
+	sum = _mm256_add_epi32(_mm256_castps_si256(even),
+			       _mm256_castps_si256(odd));
+	if (components != 4)
+	    sum = _mm256_permute4x64_epi64(sum, _MM_SHUFFLE(3,1,2,0));
+	sum = _mm256_srli_epi32(_mm256_add_epi32(sum, two), 2);
+	_mm_storeu_si128((__m128i *)(s + i),
+			 _mm_packus_epi32(_mm256_castsi256_si128(sum),
+					  _mm256_extracti128_si256(sum, 1)));
+    }
+    return i / components;
+}
+
+GLU_AVX2
+static GLint halveRow_float_avx2(GLint components, GLint groups,
+				 const void *row0, const void *row1,
+				 void *dest)
+{
+    const GLfloat *t0 = (const GLfloat *)row0;
+    const GLfloat *t1 = (const GLfloat *)row1;
+    GLfloat *s = (GLfloat *)dest;
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    GLint n = groups * components;
+    GLint i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256 e0, o0, e1, o1, sum;
+
+	evenOdd_avx2(components, _mm256_loadu_ps(t0 + 2*i),
+		     _mm256_loadu_ps(t0 + 2*i + 8), &e0, &o0);
+	evenOdd_avx2(components, _mm256_loadu_ps(t1 + 2*i),
+		     _mm256_loadu_ps(t1 + 2*i + 8), &e1, &o1);
+	sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(e0, o0), e1), o1);
+	sum = _mm256_mul_ps(sum, quarter);
+	if (components != 4)
+	    sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum),
+							 _MM_SHUFFLE(3,1,2,0)));
+	_mm256_storeu_ps(s + i, sum);
+    }
+    return i / components;
+}
+#endif /* GLU_SIMD_HAVE_AVX2 */
+
+#if defined(GLU_SIMD_HAVE_NEON)
+/*
+** NEON deinterleaves groups with vldN, so each component is reduced in its
+** own register: vpaddl adds neighbouring pixels, vpadal accumulates the
+** second row and vrshrn does the "+ 2) / 4".
+*/
+#define HALVE_U8(a, b) vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a), (b)), 2)
+#define HALVE_U16(a, b) vrshrn_n_u32(vpadalq_u16(vpaddlq_u16(a), (b)), 2)
+
+static GLint halveRow_ubyte_neon(GLint components, GLint groups,
+				 const void *row0, const void *row1,
+				 void *dest)
+{
+    const GLubyte *t0 = (const GLubyte *)row0;
+    const GLubyte *t1 = (const GLubyte *)row1;
+    GLubyte *s = (GLubyte *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 8 <= groups; j += 8) {
+	    vst1_u8(s + j, HALVE_U8(vld1q_u8(t0 + 2*j), vld1q_u8(t1 + 2*j)));
+	}
+	break;
+    case 2:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x2_t a = vld2q_u8(t0 + 4*j), b = vld2q_u8(t1 + 4*j);
+	    uint8x8x2_t r;
+	    for (k = 0; k < 2; k++) r.val[k] = HALVE_U8(a.val[k], b.val[k]);
+	    vst2_u8(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x3_t a = vld3q_u8(t0 + 6*j), b = vld3q_u8(t1 + 6*j);
+	    uint8x8x3_t r;
+	    for (k = 0; k < 3; k++) r.val[k] = HALVE_U8(a.val[k], b.val[k]);
+	    vst3_u8(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x4_t a = vld4q_u8(t0 + 8*j), b = vld4q_u8(t1 + 8*j);
+	    uint8x8x4_t r;
+	    for (k = 0; k < 4; k++) r.val[k] = HALVE_U8(a.val[k], b.val[k]);
+	    vst4_u8(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+static GLint halve1DRow_ubyte_neon(GLint components, GLint groups,
+				   const void *src, void *dest)
+{
+    const GLubyte *t = (const GLubyte *)src;
+    GLubyte *s = (GLubyte *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 8 <= groups; j += 8) {
+	    vst1_u8(s + j, vshrn_n_u16(vpaddlq_u8(vld1q_u8(t + 2*j)), 1));
+	}
+	break;
+    case 2:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x2_t a = vld2q_u8(t + 4*j);
+	    uint8x8x2_t r;
+	    for (k = 0; k < 2; k++) r.val[k] = vshrn_n_u16(vpaddlq_u8(a.val[k]), 1);
+	    vst2_u8(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x3_t a = vld3q_u8(t + 6*j);
+	    uint8x8x3_t r;
+	    for (k = 0; k < 3; k++) r.val[k] = vshrn_n_u16(vpaddlq_u8(a.val[k]), 1);
+	    vst3_u8(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x4_t a = vld4q_u8(t + 8*j);
+	    uint8x8x4_t r;
+	    for (k = 0; k < 4; k++) r.val[k] = vshrn_n_u16(vpaddlq_u8(a.val[k]), 1);
+	    vst4_u8(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+static GLint halveRow_ushort_neon(GLint components, GLint groups,
+				  const void *row0, const void *row1,
+				  void *dest)
+{
+    const GLushort *t0 = (const GLushort *)row0;
+    const GLushort *t1 = (const GLushort *)row1;
+    GLushort *s = (GLushort *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 4 <= groups; j += 4) {
+	    vst1_u16(s + j, HALVE_U16(vld1q_u16(t0 + 2*j), vld1q_u16(t1 + 2*j)));
+	}
+	break;
+    case 2:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x2_t a = vld2q_u16(t0 + 4*j), b = vld2q_u16(t1 + 4*j);
+	    uint16x4x2_t r;
+	    for (k = 0; k < 2; k++) r.val[k] = HALVE_U16(a.val[k], b.val[k]);
+	    vst2_u16(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x3_t a = vld3q_u16(t0 + 6*j), b = vld3q_u16(t1 + 6*j);
+	    uint16x4x3_t r;
+	    for (k = 0; k < 3; k++) r.val[k] = HALVE_U16(a.val[k], b.val[k]);
+	    vst3_u16(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x4_t a = vld4q_u16(t0 + 8*j), b = vld4q_u16(t1 + 8*j);
+	    uint16x4x4_t r;
+	    for (k = 0; k < 4; k++) r.val[k] = HALVE_U16(a.val[k], b.val[k]);
+	    vst4_u16(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+static GLint halve1DRow_ushort_neon(GLint components, GLint groups,
+				    const void *src, void *dest)
+{
+    const GLushort *t = (const GLushort *)src;
+    GLushort *s = (GLushort *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 4 <= groups; j += 4) {
+	    vst1_u16(s + j, vshrn_n_u32(vpaddlq_u16(vld1q_u16(t + 2*j)), 1));
+	}
+	break;
+    case 2:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x2_t a = vld2q_u16(t + 4*j);
+	    uint16x4x2_t r;
+	    for (k = 0; k < 2; k++) r.val[k] = vshrn_n_u32(vpaddlq_u16(a.val[k]), 1);
+	    vst2_u16(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x3_t a = vld3q_u16(t + 6*j);
+	    uint16x4x3_t r;
+	    for (k = 0; k < 3; k++) r.val[k] = vshrn_n_u32(vpaddlq_u16(a.val[k]), 1);
+	    vst3_u16(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x4_t a = vld4q_u16(t + 8*j);
+	    uint16x4x4_t r;
+	    for (k = 0; k < 4; k++) r.val[k] = vshrn_n_u32(vpaddlq_u16(a.val[k]), 1);
+	    vst4_u16(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+/*
+** Floats keep the scalar summation order, so instead of pairwise adds the
+** even and odd pixels of 8 source pixels are split apart with vuzp.
+*/
+static float32x4_t halveFloat_neon(float32x4_t a0, float32x4_t a1,
+				   float32x4_t b0, float32x4_t b1)
+{
+    float32x4x2_t a = vuzpq_f32(a0, a1);
+    float32x4x2_t b = vuzpq_f32(b0, b1);
+    float32x4_t sum = vaddq_f32(vaddq_f32(vaddq_f32(a.val[0], a.val[1]),
+					  b.val[0]), b.val[1]);
+    return vmulq_n_f32(sum, 0.25f);
+}
+
+static float32x4_t halve1DFloat_neon(float32x4_t a0, float32x4_t a1)
+{
+    float32x4x2_t a = vuzpq_f32(a0, a1);
+    return vmulq_n_f32(vaddq_f32(a.val[0], a.val[1]), 0.5f);
+}
+
+static GLint halveRow_float_neon(GLint components, GLint groups,
+				 const void *row0, const void *row1,
+				 void *dest)
+{
+    const GLfloat *t0 = (const GLfloat *)row0;
+    const GLfloat *t1 = (const GLfloat *)row1;
+    GLfloat *s = (GLfloat *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 4 <= groups; j += 4) {
+	    vst1q_f32(s + j, halveFloat_neon(vld1q_f32(t0 + 2*j),
+					     vld1q_f32(t0 + 2*j + 4),
+					     vld1q_f32(t1 + 2*j),
+					     vld1q_f32(t1 + 2*j + 4)));
+	}
+	break;
+    case 2:
+	for (; j + 4 <= groups; j += 4) {
+	    float32x4x2_t a0 = vld2q_f32(t0 + 4*j), a1 = vld2q_f32(t0 + 4*j + 8);
+	    float32x4x2_t b0 = vld2q_f32(t1 + 4*j), b1 = vld2q_f32(t1 + 4*j + 8);
+	    float32x4x2_t r;
+	    for (k = 0; k < 2; k++)
+		r.val[k] = halveFloat_neon(a0.val[k], a1.val[k],
+					   b0.val[k], b1.val[k]);
+	    vst2q_f32(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 4 <= groups; j += 4) {
+	    float32x4x3_t a0 = vld3q_f32(t0 + 6*j), a1 = vld3q_f32(t0 + 6*j + 12);
+	    float32x4x3_t b0 = vld3q_f32(t1 + 6*j), b1 = vld3q_f32(t1 + 6*j + 12);
+	    float32x4x3_t r;
+	    for (k = 0; k < 3; k++)
+		r.val[k] = halveFloat_neon(a0.val[k], a1.val[k],
+					   b0.val[k], b1.val[k]);
+	    vst3q_f32(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 4 <= groups; j += 4) {
+	    float32x4x4_t a0 = vld4q_f32(t0 + 8*j), a1 = vld4q_f32(t0 + 8*j + 16);
+	    float32x4x4_t b0 = vld4q_f32(t1 + 8*j), b1 = vld4q_f32(t1 + 8*j + 16);
+	    float32x4x4_t r;
+	    for (k = 0; k < 4; k++)
+		r.val[k] = halveFloat_neon(a0.val[k], a1.val[k],
+					   b0.val[k], b1.val[k]);
+	    vst4q_f32(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+static GLint halve1DRow_float_neon(GLint components, GLint groups,
+				   const void *src, void *dest)
+{
+    const GLfloat *t = (const GLfloat *)src;
+    GLfloat *s = (GLfloat *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 4 <= groups; j += 4) {
+	    vst1q_f32(s + j, halve1DFloat_neon(vld1q_f32(t + 2*j),
+					       vld1q_f32(t + 2*j + 4)));
+	}
+	break;
+    case 2:
+	for (; j + 4 <= groups; j += 4) {
+	    float32x4x2_t a0 = vld2q_f32(t + 4*j), a1 = vld2q_f32(t + 4*j + 8);
+	    float32x4x2_t r;
+	    for (k = 0; k < 2; k++)
+		r.val[k] = halve1DFloat_neon(a0.val[k], a1.val[k]);
+	    vst2q_f32(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 4 <= groups; j += 4) {
+	    float32x4x3_t a0 = vld3q_f32(t + 6*j), a1 = vld3q_f32(t + 6*j + 12);
+	    float32x4x3_t r;
+	    for (k = 0; k < 3; k++)
+		r.val[k] = halve1DFloat_neon(a0.val[k], a1.val[k]);
+	    vst3q_f32(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 4 <= groups; j += 4) {
+	    float32x4x4_t a0 = vld4q_f32(t + 8*j), a1 = vld4q_f32(t + 8*j + 16);
+	    float32x4x4_t r;
+	    for (k = 0; k < 4; k++)
+		r.val[k] = halve1DFloat_neon(a0.val[k], a1.val[k]);
+	    vst4q_f32(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+/*
+** 2x2x2 kernels for halveImage3D(), see the SSE2 ones.  NEON has no
+** double vectors everywhere, so floats are left to the scalar loop.
+*/
+#define HALVE3D_U8(a, b, c, d) \
+    vshrn_n_u16(vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(a), (b)), \
+				      (c)), (d)), 3)
+#define HALVE3D_U16(a, b, c, d) \
+    vshrn_n_u32(vpadalq_u16(vpadalq_u16(vpadalq_u16(vpaddlq_u16(a), (b)), \
+					(c)), (d)), 3)
+
+static GLint halve3DRow_ubyte_neon(GLint components, GLint groups,
+				   const void *row0, const void *row1,
+				   const void *row2, const void *row3,
+				   void *dest)
+{
+    const GLubyte *t0 = (const GLubyte *)row0;
+    const GLubyte *t1 = (const GLubyte *)row1;
+    const GLubyte *t2 = (const GLubyte *)row2;
+    const GLubyte *t3 = (const GLubyte *)row3;
+    GLubyte *s = (GLubyte *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 8 <= groups; j += 8) {
+	    vst1_u8(s + j, HALVE3D_U8(vld1q_u8(t0 + 2*j), vld1q_u8(t1 + 2*j),
+				      vld1q_u8(t2 + 2*j), vld1q_u8(t3 + 2*j)));
+	}
+	break;
+    case 2:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x2_t a = vld2q_u8(t0 + 4*j), b = vld2q_u8(t1 + 4*j);
+	    uint8x16x2_t c = vld2q_u8(t2 + 4*j), d = vld2q_u8(t3 + 4*j);
+	    uint8x8x2_t r;
+	    for (k = 0; k < 2; k++)
+		r.val[k] = HALVE3D_U8(a.val[k], b.val[k], c.val[k], d.val[k]);
+	    vst2_u8(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x3_t a = vld3q_u8(t0 + 6*j), b = vld3q_u8(t1 + 6*j);
+	    uint8x16x3_t c = vld3q_u8(t2 + 6*j), d = vld3q_u8(t3 + 6*j);
+	    uint8x8x3_t r;
+	    for (k = 0; k < 3; k++)
+		r.val[k] = HALVE3D_U8(a.val[k], b.val[k], c.val[k], d.val[k]);
+	    vst3_u8(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 8 <= groups; j += 8) {
+	    uint8x16x4_t a = vld4q_u8(t0 + 8*j), b = vld4q_u8(t1 + 8*j);
+	    uint8x16x4_t c = vld4q_u8(t2 + 8*j), d = vld4q_u8(t3 + 8*j);
+	    uint8x8x4_t r;
+	    for (k = 0; k < 4; k++)
+		r.val[k] = HALVE3D_U8(a.val[k], b.val[k], c.val[k], d.val[k]);
+	    vst4_u8(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+static GLint halve3DRow_ushort_neon(GLint components, GLint groups,
+				    const void *row0, const void *row1,
+				    const void *row2, const void *row3,
+				    void *dest)
+{
+    const GLushort *t0 = (const GLushort *)row0;
+    const GLushort *t1 = (const GLushort *)row1;
+    const GLushort *t2 = (const GLushort *)row2;
+    const GLushort *t3 = (const GLushort *)row3;
+    GLushort *s = (GLushort *)dest;
+    GLint j = 0;
+    int k;
+
+    switch (components) {
+    case 1:
+	for (; j + 4 <= groups; j += 4) {
+	    vst1_u16(s + j, HALVE3D_U16(vld1q_u16(t0 + 2*j),
+					vld1q_u16(t1 + 2*j),
+					vld1q_u16(t2 + 2*j),
+					vld1q_u16(t3 + 2*j)));
+	}
+	break;
+    case 2:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x2_t a = vld2q_u16(t0 + 4*j), b = vld2q_u16(t1 + 4*j);
+	    uint16x8x2_t c = vld2q_u16(t2 + 4*j), d = vld2q_u16(t3 + 4*j);
+	    uint16x4x2_t r;
+	    for (k = 0; k < 2; k++)
+		r.val[k] = HALVE3D_U16(a.val[k], b.val[k], c.val[k], d.val[k]);
+	    vst2_u16(s + 2*j, r);
+	}
+	break;
+    case 3:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x3_t a = vld3q_u16(t0 + 6*j), b = vld3q_u16(t1 + 6*j);
+	    uint16x8x3_t c = vld3q_u16(t2 + 6*j), d = vld3q_u16(t3 + 6*j);
+	    uint16x4x3_t r;
+	    for (k = 0; k < 3; k++)
+		r.val[k] = HALVE3D_U16(a.val[k], b.val[k], c.val[k], d.val[k]);
+	    vst3_u16(s + 3*j, r);
+	}
+	break;
+    case 4:
+	for (; j + 4 <= groups; j += 4) {
+	    uint16x8x4_t a = vld4q_u16(t0 + 8*j), b = vld4q_u16(t1 + 8*j);
+	    uint16x8x4_t c = vld4q_u16(t2 + 8*j), d = vld4q_u16(t3 + 8*j);
+	    uint16x4x4_t r;
+	    for (k = 0; k < 4; k++)
+		r.val[k] = HALVE3D_U16(a.val[k], b.val[k], c.val[k], d.val[k]);
+	    vst4_u16(s + 4*j, r);
+	}
+	break;
+    }
+    return j;
+}
+
+#undef HALVE3D_U8
+#undef HALVE3D_U16
+#undef HALVE_U8
+#undef HALVE_U16
+#endif /* GLU_SIMD_HAVE_NEON */
+
+/*
+** Picks the row kernel for a 2x2 reduction of the given type, or NULL if
+** the scalar loops have to do all the work.
+*/
+static HalveRowProc halveRowProc(GLenum type, GLint components,
+				 GLint element_size, GLint group_size)
+{
+    int level = simdLevel();
+
+    if (level == GLU_SIMD_NONE || components < 1 || components > 4 ||
+	group_size != element_size * components) {
+	return NULL;
+    }
+    if (components == 3 && level != GLU_SIMD_NEON) {
+	return NULL;
+    }
+
+    switch (type) {
+    case GL_UNSIGNED_BYTE:
+	if (element_size != sizeof(GLubyte)) return NULL;
+#if defined(GLU_SIMD_HAVE_AVX2)
+	if (level == GLU_SIMD_AVX2) return halveRow_ubyte_avx2;
+#endif
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halveRow_ubyte_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halveRow_ubyte_neon;
+#endif
+	break;
+    case GL_UNSIGNED_SHORT:
+	if (element_size != sizeof(GLushort)) return NULL;
+#if defined(GLU_SIMD_HAVE_AVX2)
+	if (level == GLU_SIMD_AVX2) return halveRow_ushort_avx2;
+#endif
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halveRow_ushort_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halveRow_ushort_neon;
+#endif
+	break;
+    case GL_FLOAT:
+	if (element_size != sizeof(GLfloat)) return NULL;
+#if defined(GLU_SIMD_HAVE_AVX2)
+	if (level == GLU_SIMD_AVX2) return halveRow_float_avx2;
+#endif
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halveRow_float_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halveRow_float_neon;
+#endif
+	break;
+    }
+    return NULL;
+}
+
+/* Same as halveRowProc() for the single-row case of halve1Dimage_*. */
+static Halve1DRowProc halve1DRowProc(GLenum type, GLint components,
+				     GLint element_size, GLint group_size)
+{
+    int level = simdLevel();
+
+    if (level == GLU_SIMD_NONE || components < 1 || components > 4 ||
+	group_size != element_size * components) {
+	return NULL;
+    }
+    if (components == 3 && level != GLU_SIMD_NEON) {
+	return NULL;
+    }
+
+    switch (type) {
+    case GL_UNSIGNED_BYTE:
+	if (element_size != sizeof(GLubyte)) return NULL;
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halve1DRow_ubyte_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halve1DRow_ubyte_neon;
+#endif
+	break;
+    case GL_UNSIGNED_SHORT:
+	if (element_size != sizeof(GLushort)) return NULL;
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halve1DRow_ushort_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halve1DRow_ushort_neon;
+#endif
+	break;
+    case GL_FLOAT:
+	if (element_size != sizeof(GLfloat)) return NULL;
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halve1DRow_float_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halve1DRow_float_neon;
+#endif
+	break;
+    }
+    return NULL;
+}
+
+/* Same as halveRowProc() for the 2x2x2 reduction of halveImage3D(). */
+static Halve3DRowProc halve3DRowProc(GLenum type, GLint components,
+				     GLint element_size, GLint group_size)
+{
+    int level = simdLevel();
+
+    if (level == GLU_SIMD_NONE || components < 1 || components > 4 ||
+	group_size != element_size * components) {
+	return NULL;
+    }
+    if (components == 3 && level != GLU_SIMD_NEON) {
+	return NULL;
+    }
+
+    switch (type) {
+    case GL_UNSIGNED_BYTE:
+	if (element_size != sizeof(GLubyte)) return NULL;
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halve3DRow_ubyte_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halve3DRow_ubyte_neon;
+#endif
+	break;
+    case GL_UNSIGNED_SHORT:
+	if (element_size != sizeof(GLushort)) return NULL;
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halve3DRow_ushort_sse2;
+#elif defined(GLU_SIMD_HAVE_NEON)
+	return halve3DRow_ushort_neon;
+#endif
+	break;
+    case GL_FLOAT:
+	if (element_size != sizeof(GLfloat)) return NULL;
+#if defined(GLU_SIMD_HAVE_SSE2)
+	return halve3DRow_float_sse2;
+#endif
+	break;
+    }
+    return NULL;
+}
+
+static void halveImage(GLint components, GLuint width, GLuint height,
+		       const GLushort *datain, GLushort *dataout)
+{
+    int i, j, k;
+    int newwidth, newheight;
+    int delta;
+    GLushort *s;
+    const GLushort *t;
+
+    newwidth = width / 2;
+    newheight = height / 2;
+    delta = width * components;
+    s = dataout;
+    t = datain;
+
+    /* Piece o' cake! */
+    for (i = 0; i < newheight; i++) {
+	for (j = 0; j < newwidth; j++) {
+	    for (k = 0; k < components; k++) {
+		s[0] = (t[0] + t[components] + t[delta] +
+			t[delta+components] + 2) / 4;
+		s++; t++;
+	    }
+	    t += components;
+	}
+	t += delta;
+    }
+}
+
+static void halveImage_ubyte(GLint components, GLuint width, GLuint height,
+			const GLubyte *datain, GLubyte *dataout,
+			GLint element_size, GLint ysize, GLint group_size)
+{
+    int i, j, k;
+    int newwidth, newheight;
+    int padBytes;
+    GLubyte *s;
+    const char *t;
+    HalveRowProc halveRow;
+
+    /* handle case where there is only 1 column/row */
+    if (width == 1 || height == 1) {
+       assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
+       halve1Dimage_ubyte(components,width,height,datain,dataout,
+			  element_size,ysize,group_size);
+       return;
+    }
+
+    newwidth = width / 2;
+    newheight = height / 2;
+    padBytes = ysize - (width*group_size);
+    s = dataout;
+    t = (const char *)datain;
+    halveRow = halveRowProc(GL_UNSIGNED_BYTE, components, element_size,
+			    group_size);
+
+    /* Piece o' cake! */
+    for (i = 0; i < newheight; i++) {
+	j = 0;
+	if (halveRow != NULL) {
+	    j = halveRow(components, newwidth, t, t+ysize, s);
+	    s += j * components;
+	    t += j * 2 * group_size;
+	}
+	for (; j < newwidth; j++) {
+	    for (k = 0; k < components; k++) {
+		s[0] = (*(const GLubyte*)t +
+			*(const GLubyte*)(t+group_size) +
+			*(const GLubyte*)(t+ysize) +
+			*(const GLubyte*)(t+ysize+group_size) + 2) / 4;
+		s++; t += element_size;
+	    }
+	    t += group_size;
+	}
+	t += padBytes;
+	t += ysize;
+    }
+}
+
+/* */
+static void halve1Dimage_ubyte(GLint components, GLuint width, GLuint height,
+			       const GLubyte *dataIn, GLubyte *dataOut,
+			       GLint element_size, GLint ysize,
+			       GLint group_size)
+{
+   GLint halfWidth= width / 2;
+   GLint halfHeight= height / 2;
+   const char *src= (const char *) dataIn;
+   GLubyte *dest= dataOut;
+   int jj;
+
+   assert(width == 1 || height == 1); /* must be 1D */
+   assert(width != height);	/* can't be square */
+
+   if (height == 1) {		/* 1 row */
+      Halve1DRowProc halveRow= halve1DRowProc(GL_UNSIGNED_BYTE, components,
+					      element_size, group_size);
+      assert(width != 1);	/* widthxheight can't be 1x1 */
+      halfHeight= 1;
+
+      jj= 0;
+      if (halveRow != NULL) {
+	 jj= halveRow(components, halfWidth, src, dest);
+	 src+= jj * 2 * group_size;
+	 dest+= jj * components;
+      }
+      for (; jj< halfWidth; jj++) {
+	 int kk;
+	 for (kk= 0; kk< components; kk++) {
+	    *dest= (*(const GLubyte*)src +
+		 *(const GLubyte*)(src+group_size)) / 2;
+
+	    src+= element_size;
+	    dest++;
+	 }
+	 src+= group_size;	/* skip to next 2 */
+      }
+      {
+	 int padBytes= ysize - (width*group_size);
+	 src+= padBytes;	/* for assertion only */
+      }
+   }
+   else if (width == 1) {	/* 1 column */
+      int padBytes= ysize - (width * group_size);
+      assert(height != 1);	/* widthxheight can't be 1x1 */
+      halfWidth= 1;
+      /* one vertical column with possible pad bytes per row */
+      /* average two at a time */
+
+      for (jj= 0; jj< halfHeight; jj++) {
+	 int kk;
+	 for (kk= 0; kk< components; kk++) {
+	    *dest= (*(const GLubyte*)src + *(const GLubyte*)(src+ysize)) / 2;
+
+	    src+= element_size;
+	    dest++;
+	 }
+	 src+= padBytes; /* add pad bytes, if any, to get to end to row */
+	 src+= ysize;
+      }
+   }
+
+   assert(src == &((const char *)dataIn)[ysize*height]);
+   assert((char *)dest == &((char *)dataOut)
+	  [components * element_size * halfWidth * halfHeight]);
+} /* halve1Dimage_ubyte() */
+
+static void halveImage_byte(GLint components, GLuint width, GLuint height,
+			const GLbyte *datain, GLbyte *dataout,
+			GLint element_size,
+			GLint ysize, GLint group_size)
+{
+    int i, j, k;
+    int newwidth, newheight;
+    int padBytes;
+    GLbyte *s;
+    const char *t;
+
+    /* handle case where there is only 1 column/row */
+    if (width == 1 || height == 1) {
+       assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
+       halve1Dimage_byte(components,width,height,datain,dataout,
+			 element_size,ysize,group_size);
+       return;
+    }
+
+    newwidth = width / 2;
+    newheight = height / 2;
+    padBytes = ysize - (width*group_size);
+    s = dataout;
+    t = (const char *)datain;
+
+    /* Piece o' cake! */
+    for (i = 0; i < newheight; i++) {
+	for (j = 0; j < newwidth; j++) {
+	    for (k = 0; k < components; k++) {
+		s[0] = (*(const GLbyte*)t +
+			*(const GLbyte*)(t+group_size) +
+			*(const GLbyte*)(t+ysize) +
+			*(const GLbyte*)(t+ysize+group_size) + 2) / 4;
+		s++; t += element_size;
+	    }
+	    t += group_size;
+	}
+	t += padBytes;
+	t += ysize;
+    }
+}
+
+static void halve1Dimage_byte(GLint components, GLuint width, GLuint height,
+			      const GLbyte *dataIn, GLbyte *dataOut,
+			      GLint element_size,GLint ysize, GLint group_size)
+{
+   GLint halfWidth= width / 2;
+   GLint halfHeight= height / 2;
+   const char *src= (const char *) dataIn;
+   GLbyte *dest= dataOut;
+   int jj;
 
    assert(width == 1 || height == 1); /* must be 1D */
    assert(width != height);	/* can't be square */
@@ -576,6 +1822,7 @@ static void halveImage_ushort(GLint components, GLuint width, GLuint height,
     int padBytes;
     GLushort *s;
     const char *t;
+    HalveRowProc halveRow;
 
     /* handle case where there is only 1 column/row */
     if (width == 1 || height == 1) {
@@ -590,11 +1837,19 @@ static void halveImage_ushort(GLint components, GLuint width, GLuint height,
     padBytes = ysize - (width*group_size);
     s = dataout;
     t = (const char *)datain;
+    halveRow = halveRowProc(GL_UNSIGNED_SHORT, components, element_size,
+			    group_size);
 
     /* Piece o' cake! */
     if (!myswap_bytes)
     for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
+	j = 0;
+	if (halveRow != NULL) {
+	    j = halveRow(components, newwidth, t, t+ysize, s);
+	    s += j * components;
+	    t += j * 2 * group_size;
+	}
+	for (; j < newwidth; j++) {
 	    for (k = 0; k < components; k++) {
 		s[0] = (*(const GLushort*)t +
 			*(const GLushort*)(t+group_size) +
@@ -639,10 +1894,18 @@ static void halve1Dimage_ushort(GLint components, GLuint width, GLuint height,
    assert(width != height);	/* can't be square */
 
    if (height == 1) {		/* 1 row */
+      Halve1DRowProc halveRow= halve1DRowProc(GL_UNSIGNED_SHORT, components,
+					      element_size, group_size);
       assert(width != 1);	/* widthxheight can't be 1x1 */
       halfHeight= 1;
 
-      for (jj= 0; jj< halfWidth; jj++) {
+      jj= 0;
+      if (halveRow != NULL && !myswap_bytes) {
+	 jj= halveRow(components, halfWidth, src, dest);
+	 src+= jj * 2 * group_size;
+	 dest+= jj * components;
+      }
+      for (; jj< halfWidth; jj++) {
 	 int kk;
 	 for (kk= 0; kk< components; kk++) {
 #define BOX2 2
@@ -994,23 +2257,172 @@ static void halve1Dimage_uint(GLint components, GLuint width, GLuint height,
    assert((char *)dest == &((char *)dataOut)
 	  [components * element_size * halfWidth * halfHeight]);
 
-} /* halve1Dimage_uint() */
+} /* halve1Dimage_uint() */
+
+static void halveImage_int(GLint components, GLuint width, GLuint height,
+			const GLint *datain, GLint *dataout, GLint element_size,
+			GLint ysize, GLint group_size, GLint myswap_bytes)
+{
+    int i, j, k;
+    int newwidth, newheight;
+    int padBytes;
+    GLint *s;
+    const char *t;
+
+    /* handle case where there is only 1 column/row */
+    if (width == 1 || height == 1) {
+       assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
+       halve1Dimage_int(components,width,height,datain,dataout,
+			element_size,ysize,group_size, myswap_bytes);
+       return;
+    }
+
+    newwidth = width / 2;
+    newheight = height / 2;
+    padBytes = ysize - (width*group_size);
+    s = dataout;
+    t = (const char *)datain;
+
+    /* Piece o' cake! */
+    if (!myswap_bytes)
+    for (i = 0; i < newheight; i++) {
+	for (j = 0; j < newwidth; j++) {
+	    for (k = 0; k < components; k++) {
+		s[0] = ((float)*(const GLint*)t +
+			(float)*(const GLint*)(t+group_size) +
+			(float)*(const GLint*)(t+ysize) +
+			(float)*(const GLint*)(t+ysize+group_size))/4 + 0.5;
+		s++; t += element_size;
+	    }
+	    t += group_size;
+	}
+	t += padBytes;
+	t += ysize;
+    }
+    else
+    for (i = 0; i < newheight; i++) {
+	for (j = 0; j < newwidth; j++) {
+	    for (k = 0; k < components; k++) {
+		GLuint b;
+		GLfloat buf;
+		b = __GLU_SWAP_4_BYTES(t);
+		buf = *(GLint*)&b;
+		b = __GLU_SWAP_4_BYTES(t+group_size);
+		buf += *(GLint*)&b;
+		b = __GLU_SWAP_4_BYTES(t+ysize);
+		buf += *(GLint*)&b;
+		b = __GLU_SWAP_4_BYTES(t+ysize+group_size);
+		buf += *(GLint*)&b;
+		s[0] = (GLint)(buf/4 + 0.5);
+
+		s++; t += element_size;
+	    }
+	    t += group_size;
+	}
+	t += padBytes;
+	t += ysize;
+    }
+}
+
+/* */
+static void halve1Dimage_int(GLint components, GLuint width, GLuint height,
+			     const GLint *dataIn, GLint *dataOut,
+			     GLint element_size, GLint ysize,
+			     GLint group_size, GLint myswap_bytes)
+{
+   GLint halfWidth= width / 2;
+   GLint halfHeight= height / 2;
+   const char *src= (const char *) dataIn;
+   GLint *dest= dataOut;
+   int jj;
+
+   assert(width == 1 || height == 1); /* must be 1D */
+   assert(width != height);	/* can't be square */
+
+   if (height == 1) {		/* 1 row */
+      assert(width != 1);	/* widthxheight can't be 1x1 */
+      halfHeight= 1;
+
+      for (jj= 0; jj< halfWidth; jj++) {
+	 int kk;
+	 for (kk= 0; kk< components; kk++) {
+#define BOX2 2
+	    GLuint uint[BOX2];
+	    if (myswap_bytes) {
+	       uint[0]= __GLU_SWAP_4_BYTES(src);
+	       uint[1]= __GLU_SWAP_4_BYTES(src+group_size);
+	    }
+	    else {
+	       uint[0]= *(const GLuint*)src;
+	       uint[1]= *(const GLuint*)(src+group_size);
+	    }
+	    *dest= ((float)uint[0]+(float)uint[1])/2.0;
+
+	    src+= element_size;
+	    dest++;
+	 }
+	 src+= group_size;	/* skip to next 2 */
+      }
+      {
+	 int padBytes= ysize - (width*group_size);
+	 src+= padBytes;	/* for assertion only */
+      }
+   }
+   else if (width == 1) {	/* 1 column */
+      int padBytes= ysize - (width * group_size);
+      assert(height != 1);	/* widthxheight can't be 1x1 */
+      halfWidth= 1;
+      /* one vertical column with possible pad bytes per row */
+      /* average two at a time */
+
+      for (jj= 0; jj< halfHeight; jj++) {
+	 int kk;
+	 for (kk= 0; kk< components; kk++) {
+#define BOX2 2
+	    GLuint uint[BOX2];
+	    if (myswap_bytes) {
+	       uint[0]= __GLU_SWAP_4_BYTES(src);
+	       uint[1]= __GLU_SWAP_4_BYTES(src+ysize);
+	    }
+	    else {
+	       uint[0]= *(const GLuint*)src;
+	       uint[1]= *(const GLuint*)(src+ysize);
+	    }
+	    *dest= ((float)uint[0]+(float)uint[1])/2.0;
+
+	    src+= element_size;
+	    dest++;
+	 }
+	 src+= padBytes; /* add pad bytes, if any, to get to end to row */
+	 src+= ysize;
+      }
+
+      assert(src == &((const char *)dataIn)[ysize*height]);
+   }
+
+   assert((char *)dest == &((char *)dataOut)
+	  [components * element_size * halfWidth * halfHeight]);
+
+} /* halve1Dimage_int() */
 
-static void halveImage_int(GLint components, GLuint width, GLuint height,
-			const GLint *datain, GLint *dataout, GLint element_size,
-			GLint ysize, GLint group_size, GLint myswap_bytes)
+
+static void halveImage_float(GLint components, GLuint width, GLuint height,
+			const GLfloat *datain, GLfloat *dataout,
+			GLint element_size, GLint ysize, GLint group_size,
+			GLint myswap_bytes)
 {
     int i, j, k;
     int newwidth, newheight;
     int padBytes;
-    GLint *s;
+    GLfloat *s;
     const char *t;
+    HalveRowProc halveRow;
 
     /* handle case where there is only 1 column/row */
     if (width == 1 || height == 1) {
        assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
-       halve1Dimage_int(components,width,height,datain,dataout,
-			element_size,ysize,group_size, myswap_bytes);
+       halve1Dimage_float(components,width,height,datain,dataout,
+			  element_size,ysize,group_size, myswap_bytes);
        return;
     }
 
@@ -1019,16 +2431,24 @@ static void halveImage_int(GLint components, GLuint width, GLuint height,
     padBytes = ysize - (width*group_size);
     s = dataout;
     t = (const char *)datain;
+    halveRow = halveRowProc(GL_FLOAT, components, element_size,
+			    group_size);
 
     /* Piece o' cake! */
     if (!myswap_bytes)
     for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
+	j = 0;
+	if (halveRow != NULL) {
+	    j = halveRow(components, newwidth, t, t+ysize, s);
+	    s += j * components;
+	    t += j * 2 * group_size;
+	}
+	for (; j < newwidth; j++) {
 	    for (k = 0; k < components; k++) {
-		s[0] = ((float)*(const GLint*)t +
-			(float)*(const GLint*)(t+group_size) +
-			(float)*(const GLint*)(t+ysize) +
-			(float)*(const GLint*)(t+ysize+group_size))/4 + 0.5;
+		s[0] = (*(const GLfloat*)t +
+			*(const GLfloat*)(t+group_size) +
+			*(const GLfloat*)(t+ysize) +
+			*(const GLfloat*)(t+ysize+group_size)) / 4;
 		s++; t += element_size;
 	    }
 	    t += group_size;
@@ -1040,18 +2460,16 @@ static void halveImage_int(GLint components, GLuint width, GLuint height,
     for (i = 0; i < newheight; i++) {
 	for (j = 0; j < newwidth; j++) {
 	    for (k = 0; k < components; k++) {
-		GLuint b;
-		GLfloat buf;
-		b = __GLU_SWAP_4_BYTES(t);
-		buf = *(GLint*)&b;
-		b = __GLU_SWAP_4_BYTES(t+group_size);
-		buf += *(GLint*)&b;
-		b = __GLU_SWAP_4_BYTES(t+ysize);
-		buf += *(GLint*)&b;
-		b = __GLU_SWAP_4_BYTES(t+ysize+group_size);
-		buf += *(GLint*)&b;
-		s[0] = (GLint)(buf/4 + 0.5);
-
+		union { GLuint b; GLfloat f; } swapbuf;
+		swapbuf.b = __GLU_SWAP_4_BYTES(t);
+		s[0] = swapbuf.f;
+		swapbuf.b = __GLU_SWAP_4_BYTES(t+group_size);
+		s[0] += swapbuf.f;
+		swapbuf.b = __GLU_SWAP_4_BYTES(t+ysize);
+		s[0] += swapbuf.f;
+		swapbuf.b = __GLU_SWAP_4_BYTES(t+ysize+group_size);
+		s[0] += swapbuf.f;
+		s[0] /= 4;
 		s++; t += element_size;
 	    }
 	    t += group_size;
@@ -1062,39 +2480,47 @@ static void halveImage_int(GLint components, GLuint width, GLuint height,
 }
 
 /* */
-static void halve1Dimage_int(GLint components, GLuint width, GLuint height,
-			     const GLint *dataIn, GLint *dataOut,
-			     GLint element_size, GLint ysize,
-			     GLint group_size, GLint myswap_bytes)
+static void halve1Dimage_float(GLint components, GLuint width, GLuint height,
+			       const GLfloat *dataIn, GLfloat *dataOut,
+			       GLint element_size, GLint ysize,
+			       GLint group_size, GLint myswap_bytes)
 {
    GLint halfWidth= width / 2;
    GLint halfHeight= height / 2;
    const char *src= (const char *) dataIn;
-   GLint *dest= dataOut;
+   GLfloat *dest= dataOut;
    int jj;
 
    assert(width == 1 || height == 1); /* must be 1D */
    assert(width != height);	/* can't be square */
 
    if (height == 1) {		/* 1 row */
+      Halve1DRowProc halveRow= halve1DRowProc(GL_FLOAT, components,
+					      element_size, group_size);
       assert(width != 1);	/* widthxheight can't be 1x1 */
       halfHeight= 1;
 
-      for (jj= 0; jj< halfWidth; jj++) {
+      jj= 0;
+      if (halveRow != NULL && !myswap_bytes) {
+	 jj= halveRow(components, halfWidth, src, dest);
+	 src+= jj * 2 * group_size;
+	 dest+= jj * components;
+      }
+      for (; jj< halfWidth; jj++) {
 	 int kk;
 	 for (kk= 0; kk< components; kk++) {
 #define BOX2 2
-	    GLuint uint[BOX2];
+	    GLfloat sfloat[BOX2];
 	    if (myswap_bytes) {
-	       uint[0]= __GLU_SWAP_4_BYTES(src);
-	       uint[1]= __GLU_SWAP_4_BYTES(src+group_size);
+	       sfloat[0]= __GLU_SWAP_4_BYTES(src);
+	       sfloat[1]= __GLU_SWAP_4_BYTES(src+group_size);
 	    }
 	    else {
-	       uint[0]= *(const GLuint*)src;
-	       uint[1]= *(const GLuint*)(src+group_size);
+	       sfloat[0]= *(const GLfloat*)src;
+	       sfloat[1]= *(const GLfloat*)(src+group_size);
 	    }
-	    *dest= ((float)uint[0]+(float)uint[1])/2.0;
 
+	    *dest= (sfloat[0] + sfloat[1]) / 2.0;
 	    src+= element_size;
 	    dest++;
 	 }
@@ -1116,175 +2542,776 @@ static void halve1Dimage_int(GLint components, GLuint width, GLuint height,
 	 int kk;
 	 for (kk= 0; kk< components; kk++) {
 #define BOX2 2
-	    GLuint uint[BOX2];
+	    GLfloat sfloat[BOX2];
 	    if (myswap_bytes) {
-	       uint[0]= __GLU_SWAP_4_BYTES(src);
-	       uint[1]= __GLU_SWAP_4_BYTES(src+ysize);
+	       sfloat[0]= __GLU_SWAP_4_BYTES(src);
+	       sfloat[1]= __GLU_SWAP_4_BYTES(src+ysize);
 	    }
 	    else {
-	       uint[0]= *(const GLuint*)src;
-	       uint[1]= *(const GLuint*)(src+ysize);
+	       sfloat[0]= *(const GLfloat*)src;
+	       sfloat[1]= *(const GLfloat*)(src+ysize);
 	    }
-	    *dest= ((float)uint[0]+(float)uint[1])/2.0;
+	    *dest= (sfloat[0] + sfloat[1]) / 2.0;
 
 	    src+= element_size;
 	    dest++;
 	 }
 	 src+= padBytes; /* add pad bytes, if any, to get to end to row */
-	 src+= ysize;
+	 src+= ysize;		/* skip to odd row */
       }
-
-      assert(src == &((const char *)dataIn)[ysize*height]);
    }
 
+   assert(src == &((const char *)dataIn)[ysize*height]);
    assert((char *)dest == &((char *)dataOut)
 	  [components * element_size * halfWidth * halfHeight]);
+} /* halve1Dimage_float() */
 
-} /* halve1Dimage_int() */
+/*
+** Integer paths for the packed pixel types textures are most commonly
+** uploaded in.  Every other component of a pixel is masked out, which
+** leaves enough room between the remaining fields that the fields of
+** several pixels can be summed in one word and then rounded and shifted
+** back in place, without converting through float.  Results are rounded
+** to nearest like the shove*() routines do.  A GLU_MIPMAP_SCALAR build
+** finds no format in the table, and keeps to the float path.
+*/
+typedef struct {
+    GLenum type;
+    void (*extract)(int, const void *, GLfloat []);
+    GLint components;
+    GLint size;		/* bytes per pixel */
+    GLuint even;	/* mask of components 0 and 2 */
+    GLuint odd;		/* mask of components 1 and 3 */
+    GLint oddshift;	/* lowest bit of odd */
+    GLint shift[4];	/* lowest bit of each component */
+    GLint max[4];	/* largest value of each component */
+} PackedIntFormat;
+
+static const PackedIntFormat packedIntFormats[] = {
+    { GL_UNSIGNED_SHORT_5_6_5, extract565, 3, 2, 0xf81f, 0x07e0, 5,
+      { 11, 5, 0, 0 }, { 31, 63, 31, 0 } },
+    { GL_UNSIGNED_SHORT_4_4_4_4, extract4444, 4, 2, 0xf0f0, 0x0f0f, 0,
+      { 12, 8, 4, 0 }, { 15, 15, 15, 15 } },
+    { GL_UNSIGNED_SHORT_5_5_5_1, extract5551, 4, 2, 0xf83e, 0x07c1, 0,
+      { 11, 6, 1, 0 }, { 31, 31, 31, 1 } },
+    { GL_UNSIGNED_INT_8_8_8_8_REV, extract8888rev, 4, 4,
+      0x00ff00ff, 0xff00ff00, 8,
+      { 0, 8, 16, 24 }, { 255, 255, 255, 255 } },
+};
+
+static const PackedIntFormat *packedIntFormat(GLenum type)
+{
+    size_t i;
 
+#if defined(GLU_MIPMAP_SCALAR)
+    return NULL;
+#endif
+    for (i = 0; i < sizeof(packedIntFormats)/sizeof(packedIntFormats[0]);
+	 i++) {
+	if (packedIntFormats[i].type == type) {
+	    return &packedIntFormats[i];
+	}
+    }
+    return NULL;
+}
 
-static void halveImage_float(GLint components, GLuint width, GLuint height,
-			const GLfloat *datain, GLfloat *dataout,
-			GLint element_size, GLint ysize, GLint group_size,
-			GLint myswap_bytes)
+/* Same as above, for the routines that only get the extract function. */
+static const PackedIntFormat *packedIntFormatOf(void (*extract)
+						(int, const void *,
+						 GLfloat []))
 {
-    int i, j, k;
-    int newwidth, newheight;
-    int padBytes;
-    GLfloat *s;
-    const char *t;
+    size_t i;
 
-    /* handle case where there is only 1 column/row */
-    if (width == 1 || height == 1) {
-       assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
-       halve1Dimage_float(components,width,height,datain,dataout,
-			  element_size,ysize,group_size, myswap_bytes);
-       return;
+#if defined(GLU_MIPMAP_SCALAR)
+    return NULL;
+#endif
+    for (i = 0; i < sizeof(packedIntFormats)/sizeof(packedIntFormats[0]);
+	 i++) {
+	if (packedIntFormats[i].extract == extract) {
+	    return &packedIntFormats[i];
+	}
+    }
+    return NULL;
+}
+
+static GLuint loadPackedPixel(const PackedIntFormat *fmt, const char *p,
+			      GLint isSwap)
+{
+    if (fmt->size == 2) {
+	return isSwap ? __GLU_SWAP_2_BYTES(p) : *(const GLushort *)p;
+    }
+    return isSwap ? __GLU_SWAP_4_BYTES(p) : *(const GLuint *)p;
+}
+
+/*
+** Separable rescaler.
+**
+** Both box filters used by the scale_internal* routines are separable: the
+** weight of source pixel (l, m) is the product of a weight that depends on
+** l and the output column and one that depends on m and the output row.
+** So instead of walking the full 2D box for every output pixel, the
+** weights of each axis are computed once into a table, every source row is
+** filtered horizontally once, and output rows are weighted sums of those
+** filtered rows.  The work is done in tiles of output columns so that the
+** few filtered rows that are live at a time stay in cache.
+**
+** The tables reproduce the per-pixel weights of the 2D loops, so results
+** only differ from them by rounding, except where the loops misbehaved:
+** their left and right edge pointers drifted one group per row when a box
+** spanned more than three rows, and the last row of an image that wasn't
+** shrunk vertically got a zero or negative weight.
+**
+** 8 bit types and the packed types of packedIntFormats[] are filtered in
+** fixed point: 1.14 weights, with horizontally filtered rows kept to 8
+** fractional bits so the vertical sums fit in 32 bits.  Wider types are
+** filtered in float like before.
+*/
+#define SCALE_FIXED_SHIFT 14
+#define SCALE_FIXED_ONE (1 << SCALE_FIXED_SHIFT)
+#define SCALE_ROW_SHIFT 8
+#define SCALE_TILE_BYTES 32768
+
+typedef struct {
+    GLint first;	/* first entry in index[], weight[] and fixed[] */
+    GLint count;	/* number of source samples */
+    GLfloat area;	/* sum of the weights */
+} ScaleSpan;
+
+typedef struct {
+    ScaleSpan *span;	/* one per output sample */
+    GLint *index;	/* source sample */
+    GLfloat *weight;	/* box filter coverage of the source sample */
+    GLint *fixed;	/* weight / conv in 1.14 fixed point, box filter only */
+} ScaleAxis;
+
+/* Upper bound of the table entries either builder needs for one axis. */
+static GLint scaleAxisEntries(GLint sizein, GLint sizeout)
+{
+    return sizeout * (sizein / sizeout + 3);
+}
+
+static void addScaleWeight(ScaleAxis *axis, GLint sizein, GLint *entries,
+			   GLint index, GLfloat weight)
+{
+    if (index > sizein - 1) index = sizein - 1;
+    if (index < 0) index = 0;
+    axis->index[*entries] = index;
+    axis->weight[*entries] = weight;
+    (*entries)++;
+}
+
+/*
+** Converts the weights of each span to fixed point, normalized by the
+** filter width.  The rounding error is folded into the largest weight so
+** that a span sums to exactly the fixed point value of area / norm, which
+** keeps flat areas flat.
+*/
+static void finishScaleAxis(ScaleAxis *axis, GLint sizeout, GLfloat norm)
+{
+    GLint i, e;
+
+    for (i = 0; i < sizeout; i++) {
+	ScaleSpan *span = &axis->span[i];
+	GLint target, sum = 0, largest = span->first;
+
+	for (e = span->first; e < span->first + span->count; e++) {
+	    axis->fixed[e] = floor(axis->weight[e] / norm * SCALE_FIXED_ONE +
+				   0.5);
+	    sum += axis->fixed[e];
+	    if (axis->weight[e] > axis->weight[largest]) largest = e;
+	}
+	target = floor(span->area / norm * SCALE_FIXED_ONE + 0.5);
+	axis->fixed[largest] += target - sum;
+    }
+}
+
+/*
+** Weights of the scale_internal_<type> filter: output sample i covers
+** [i*conv, (i+1)*conv) of the input, tracked with the same integer and
+** fractional recurrences the 2D loops use.  Only the rows were clamped
+** there, so only the rows are clamped here.
+*/
+static void initScaleAxisBox(ScaleAxis *axis, GLint sizein, GLint sizeout,
+			     GLboolean clamp)
+{
+    float conv, conv_float, low_float, high_float;
+    int conv_int, low_int, high_int;
+    GLint i, l, entries = 0;
+
+    conv = (float) sizein/sizeout;
+    conv_int = floor(conv);
+    conv_float = conv - conv_int;
+
+    low_int = 0;
+    low_float = 0;
+    high_int = conv_int;
+    high_float = conv_float;
+
+    for (i = 0; i < sizeout; i++) {
+	ScaleSpan *span = &axis->span[i];
+	GLboolean clamped = GL_FALSE;
+
+	if (clamp && high_int >= sizein) {
+	    high_int = sizein - 1;
+	    clamped = GL_TRUE;
+	}
+
+	span->first = entries;
+	if (high_int > low_int) {
+	    addScaleWeight(axis, sizein, &entries, low_int, 1-low_float);
+	    for (l = low_int+1; l < high_int; l++) {
+		addScaleWeight(axis, sizein, &entries, l, 1);
+	    }
+	    addScaleWeight(axis, sizein, &entries, high_int, high_float);
+	} else if (clamped) {
+	    /*
+	    ** The box ends exactly at the end of the last row and rounding
+	    ** pushed it over; high_float - low_float would be zero or
+	    ** negative here.
+	    */
+	    addScaleWeight(axis, sizein, &entries, low_int, 1-low_float);
+	} else {
+	    addScaleWeight(axis, sizein, &entries, low_int,
+			   high_float - low_float);
+	}
+	span->count = entries - span->first;
+	span->area = 0;
+	for (l = span->first; l < entries; l++) {
+	    span->area += axis->weight[l];
+	}
+
+	low_int = high_int;
+	low_float = high_float;
+	high_int += conv_int;
+	high_float += conv_float;
+	if (high_float > 1) {
+	    high_float -= 1.0;
+	    high_int++;
+	}
+    }
+    finishScaleAxis(axis, sizeout, conv);
+}
+
+/*
+** Weights of the scale_internal() filter: a box of width conv (or 1 when
+** enlarging) centered on the output sample, wrapping around the edges.
+*/
+static void initScaleAxisWrap(ScaleAxis *axis, GLint sizein, GLint sizeout)
+{
+    float x, low, high, conv, halfconv, percent;
+    int xint;
+    GLint i, entries = 0;
+
+    conv = (float) sizein/sizeout;
+    halfconv = conv/2;
+    for (i = 0; i < sizeout; i++) {
+	ScaleSpan *span = &axis->span[i];
+
+	x = conv * (i+0.5);
+	if (sizein > sizeout) {
+	    high = x + halfconv;
+	    low = x - halfconv;
+	} else {
+	    high = x + 0.5;
+	    low = x - 0.5;
+	}
+
+	span->first = entries;
+	span->area = 0;
+	x = low;
+	xint = floor(x);
+	while (x < high) {
+	    if (high < xint+1) {
+		percent = high - x;
+	    } else {
+		percent = xint+1 - x;
+	    }
+	    addScaleWeight(axis, sizein, &entries,
+			   (xint + sizein) % sizein, percent);
+	    span->area += percent;
+	    xint++;
+	    x = xint;
+	}
+	span->count = entries - span->first;
+    }
+}
+
+typedef struct {
+    GLenum type;
+    GLint components;
+    const char *data;
+    GLint element_size;
+    GLint group_size;
+    GLint ysize;
+    GLint swap;
+} ScaleSource;
+
+/* Decodes groups [first, last] of 8 bit source row m into integers. */
+static void scaleDecodeRowInt(const ScaleSource *src, GLint m,
+			      GLint first, GLint last, GLint *dest)
+{
+    const char *t = src->data + m * src->ysize + first * src->group_size;
+    GLint padding = src->group_size - src->components * src->element_size;
+    GLint l, k;
+
+    if (padding == 0 && src->element_size == 1) {
+	/* tightly packed, the row is a plain run of bytes */
+	GLint n = (last - first + 1) * src->components;
+
+	if (src->type == GL_BYTE) {
+	    for (k = 0; k < n; k++) dest[k] = ((const GLbyte *)t)[k];
+	} else {
+	    for (k = 0; k < n; k++) dest[k] = ((const GLubyte *)t)[k];
+	}
+    } else if (src->type == GL_BYTE) {
+	for (l = first; l <= last; l++, t += padding) {
+	    for (k = 0; k < src->components; k++, t += src->element_size) {
+		*dest++ = *(const GLbyte *)t;
+	    }
+	}
+    } else {
+	for (l = first; l <= last; l++, t += padding) {
+	    for (k = 0; k < src->components; k++, t += src->element_size) {
+		*dest++ = *(const GLubyte *)t;
+	    }
+	}
     }
+}
+
+/* Decodes pixels [first, last] of packed source row m into components. */
+static void scaleDecodeRowPacked(const ScaleSource *src,
+				 const PackedIntFormat *fmt, GLint m,
+				 GLint first, GLint last, GLint *dest)
+{
+    const char *t = src->data + m * src->ysize + first * src->group_size;
+    const GLint s0 = fmt->shift[0], s1 = fmt->shift[1];
+    const GLint s2 = fmt->shift[2], s3 = fmt->shift[3];
+    const GLint m0 = fmt->max[0], m1 = fmt->max[1];
+    const GLint m2 = fmt->max[2], m3 = fmt->max[3];
+    GLint l;
+    GLuint p;
+
+    for (l = first; l <= last; l++, t += src->group_size) {
+	if (src->swap) {
+	    p = loadPackedPixel(fmt, t, 1);
+	} else if (fmt->size == 2) {
+	    p = *(const GLushort *)t;
+	} else {
+	    p = *(const GLuint *)t;
+	}
+	dest[0] = (p >> s0) & m0;
+	dest[1] = (p >> s1) & m1;
+	dest[2] = (p >> s2) & m2;
+	if (fmt->components == 4) {
+	    dest[3] = (p >> s3) & m3;
+	}
+	dest += fmt->components;
+    }
+}
+
+/* Decodes groups [first, last] of source row m into floats. */
+static void scaleDecodeRowFloat(const ScaleSource *src, GLint m,
+				GLint first, GLint last, GLfloat *dest)
+{
+    const char *t = src->data + m * src->ysize + first * src->group_size;
+    GLint padding = src->group_size - src->components * src->element_size;
+    GLint l, k;
+    union { GLuint b; GLint i; GLfloat f; } swapbuf;
+    GLushort swapbuf16;
+
+    if (padding == 0 && !src->swap) {
+	/* tightly packed and in host order, convert the whole run */
+	GLint n = (last - first + 1) * src->components;
+
+	switch (src->type) {
+	case GL_UNSIGNED_SHORT:
+	    for (k = 0; k < n; k++) dest[k] = ((const GLushort *)t)[k];
+	    return;
+	case GL_SHORT:
+	    for (k = 0; k < n; k++) dest[k] = ((const GLshort *)t)[k];
+	    return;
+	case GL_UNSIGNED_INT:
+	    for (k = 0; k < n; k++) dest[k] = ((const GLuint *)t)[k];
+	    return;
+	case GL_INT:
+	    for (k = 0; k < n; k++) dest[k] = ((const GLint *)t)[k];
+	    return;
+	case GL_FLOAT:
+	    memcpy(dest, t, n * sizeof(GLfloat));
+	    return;
+	}
+    }
+
+    for (l = first; l <= last; l++, t += padding) {
+	for (k = 0; k < src->components; k++, t += src->element_size) {
+	    switch (src->type) {
+	    case GL_UNSIGNED_SHORT:
+		*dest++ = src->swap ? __GLU_SWAP_2_BYTES(t) :
+				      *(const GLushort *)t;
+		break;
+	    case GL_SHORT:
+		if (src->swap) {
+		    swapbuf16 = __GLU_SWAP_2_BYTES(t);
+		    *dest++ = (GLshort)swapbuf16;
+		} else {
+		    *dest++ = *(const GLshort *)t;
+		}
+		break;
+	    case GL_UNSIGNED_INT:
+		*dest++ = src->swap ? __GLU_SWAP_4_BYTES(t) :
+				      *(const GLuint *)t;
+		break;
+	    case GL_INT:
+		if (src->swap) {
+		    swapbuf.b = __GLU_SWAP_4_BYTES(t);
+		    *dest++ = swapbuf.i;
+		} else {
+		    *dest++ = *(const GLint *)t;
+		}
+		break;
+	    case GL_FLOAT:
+		if (src->swap) {
+		    swapbuf.b = __GLU_SWAP_4_BYTES(t);
+		    *dest++ = swapbuf.f;
+		} else {
+		    *dest++ = *(const GLfloat *)t;
+		}
+		break;
+	    }
+	}
+    }
+}
+
+/*
+** Filters output columns [j0, j1) of one decoded row v, whose first group
+** is input column lmin, into h.  Written out per component count so the
+** accumulators stay in registers.
+*/
+#define SCALE_FIXED_ROW(x) (((x) + (1 << (SCALE_ROW_SHIFT-1))) >> SCALE_ROW_SHIFT)
+#define SCALE_FLOAT_ROW(x) (x)
+#define SCALE_FILTER_ROW(TYPE, WEIGHT, FINISH, C) \
+    for (j = j0; j < j1; j++, h += C) { \
+	const ScaleSpan *span = &ax->span[j]; \
+	const GLint *index = ax->index + span->first; \
+	const TYPE *weight = ax->WEIGHT + span->first; \
+	TYPE s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+	for (e = 0; e < span->count; e++) { \
+	    const TYPE *p = v + (index[e] - lmin) * C; \
+	    s0 += weight[e] * p[0]; \
+	    if (C > 1) s1 += weight[e] * p[1]; \
+	    if (C > 2) s2 += weight[e] * p[2]; \
+	    if (C > 3) s3 += weight[e] * p[3]; \
+	} \
+	h[0] = FINISH(s0); \
+	if (C > 1) h[1] = FINISH(s1); \
+	if (C > 2) h[2] = FINISH(s2); \
+	if (C > 3) h[3] = FINISH(s3); \
+    }
+
+static void scaleFilterRowFixed(const ScaleAxis *ax, GLint j0, GLint j1,
+				GLint lmin, GLint components,
+				const GLint *v, GLint *h)
+{
+    GLint j, e;
+
+    switch (components) {
+    case 1: SCALE_FILTER_ROW(GLint, fixed, SCALE_FIXED_ROW, 1) break;
+    case 2: SCALE_FILTER_ROW(GLint, fixed, SCALE_FIXED_ROW, 2) break;
+    case 3: SCALE_FILTER_ROW(GLint, fixed, SCALE_FIXED_ROW, 3) break;
+    default: SCALE_FILTER_ROW(GLint, fixed, SCALE_FIXED_ROW, 4) break;
+    }
+}
+
+static void scaleFilterRowFloat(const ScaleAxis *ax, GLint j0, GLint j1,
+				GLint lmin, GLint components,
+				const GLfloat *v, GLfloat *h)
+{
+    GLint j, e;
+
+    switch (components) {
+    case 1: SCALE_FILTER_ROW(GLfloat, weight, SCALE_FLOAT_ROW, 1) break;
+    case 2: SCALE_FILTER_ROW(GLfloat, weight, SCALE_FLOAT_ROW, 2) break;
+    case 3: SCALE_FILTER_ROW(GLfloat, weight, SCALE_FLOAT_ROW, 3) break;
+    default: SCALE_FILTER_ROW(GLfloat, weight, SCALE_FLOAT_ROW, 4) break;
+    }
+}
+#undef SCALE_FILTER_ROW
+#undef SCALE_FLOAT_ROW
+#undef SCALE_FIXED_ROW
+
+/* Stores n fixed point sums, truncating toward zero like a float cast. */
+static void scaleStoreFixed(GLenum type, const GLint *acc, GLint n,
+			    void *dataout)
+{
+    const GLint shift = 2*SCALE_FIXED_SHIFT - SCALE_ROW_SHIFT;
+    GLint k, v;
+
+    if (type == GL_BYTE) {
+	GLbyte *out = (GLbyte *)dataout;
+
+	for (k = 0; k < n; k++) {
+	    v = acc[k] < 0 ? -(-acc[k] >> shift) : acc[k] >> shift;
+	    out[k] = v < SCHAR_MIN ? SCHAR_MIN : v > SCHAR_MAX ? SCHAR_MAX : v;
+	}
+    } else {
+	GLubyte *out = (GLubyte *)dataout;
 
-    newwidth = width / 2;
-    newheight = height / 2;
-    padBytes = ysize - (width*group_size);
-    s = dataout;
-    t = (const char *)datain;
+	for (k = 0; k < n; k++) {
+	    v = acc[k] >> shift;
+	    out[k] = v < 0 ? 0 : v > UCHAR_MAX ? UCHAR_MAX : v;
+	}
+    }
+}
 
-    /* Piece o' cake! */
-    if (!myswap_bytes)
-    for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
-	    for (k = 0; k < components; k++) {
-		s[0] = (*(const GLfloat*)t +
-			*(const GLfloat*)(t+group_size) +
-			*(const GLfloat*)(t+ysize) +
-			*(const GLfloat*)(t+ysize+group_size)) / 4;
-		s++; t += element_size;
-	    }
-	    t += group_size;
+/* Packs n fixed point component sums, rounding to nearest like shove*(). */
+static void scaleStorePacked(const PackedIntFormat *fmt, const GLint *acc,
+			     GLint n, void *dataout)
+{
+    const GLint shift = 2*SCALE_FIXED_SHIFT - SCALE_ROW_SHIFT;
+    GLint j, k, v;
+    GLuint p;
+
+    for (j = 0; j < n / fmt->components; j++) {
+	p = 0;
+	for (k = 0; k < fmt->components; k++, acc++) {
+	    v = (*acc + (1 << (shift-1))) >> shift;
+	    v = v < 0 ? 0 : v > fmt->max[k] ? fmt->max[k] : v;
+	    p |= (GLuint)v << fmt->shift[k];
+	}
+	if (fmt->size == 2) {
+	    ((GLushort *)dataout)[j] = p;
+	} else {
+	    ((GLuint *)dataout)[j] = p;
 	}
-	t += padBytes;
-	t += ysize;
     }
-    else
-    for (i = 0; i < newheight; i++) {
-	for (j = 0; j < newwidth; j++) {
-	    for (k = 0; k < components; k++) {
-		union { GLuint b; GLfloat f; } swapbuf;
-		swapbuf.b = __GLU_SWAP_4_BYTES(t);
-		s[0] = swapbuf.f;
-		swapbuf.b = __GLU_SWAP_4_BYTES(t+group_size);
-		s[0] += swapbuf.f;
-		swapbuf.b = __GLU_SWAP_4_BYTES(t+ysize);
-		s[0] += swapbuf.f;
-		swapbuf.b = __GLU_SWAP_4_BYTES(t+ysize+group_size);
-		s[0] += swapbuf.f;
-		s[0] /= 4;
-		s++; t += element_size;
+}
+
+/* Stores n float sums divided by area, converted like the 2D loops did. */
+static void scaleStoreFloat(GLenum type, const GLfloat *acc, GLint n,
+			    float area, void *dataout)
+{
+    GLint k;
+    float value;
+
+    switch (type) {
+    case GL_UNSIGNED_SHORT:
+	for (k = 0; k < n; k++) {
+	    value = acc[k]/area;
+	    ((GLushort *)dataout)[k] =
+		value < 0 ? 0 : value > USHRT_MAX ? USHRT_MAX : value;
+	}
+	break;
+    case GL_SHORT:
+	for (k = 0; k < n; k++) {
+	    value = acc[k]/area;
+	    ((GLshort *)dataout)[k] =
+		value < SHRT_MIN ? SHRT_MIN : value > SHRT_MAX ? SHRT_MAX : value;
+	}
+	break;
+    case GL_UNSIGNED_INT:
+	for (k = 0; k < n; k++) {
+	    value = acc[k]/area;
+	    if (value >= (float) UINT_MAX) {	/* need '=' */
+		((GLuint *)dataout)[k] = UINT_MAX;
+	    } else {
+		((GLuint *)dataout)[k] = value < 0 ? 0 : value;
 	    }
-	    t += group_size;
 	}
-	t += padBytes;
-	t += ysize;
+	break;
+    case GL_INT:
+	for (k = 0; k < n; k++) {
+	    ((GLint *)dataout)[k] = acc[k]/area;
+	}
+	break;
+    case GL_FLOAT:
+	for (k = 0; k < n; k++) {
+	    ((GLfloat *)dataout)[k] = acc[k]/area;
+	}
+	break;
     }
 }
 
-/* */
-static void halve1Dimage_float(GLint components, GLuint width, GLuint height,
-			       const GLfloat *dataIn, GLfloat *dataOut,
-			       GLint element_size, GLint ysize,
-			       GLint group_size, GLint myswap_bytes)
+/*
+** Rescales with the separable filter.  wrap selects the scale_internal()
+** filter and rounding (GLushort data only), otherwise the filter of the
+** scale_internal_<type> routines and scaleInternalPackedPixel() is used.
+** Returns GL_FALSE without touching dataout if the scratch memory can't
+** be allocated, or in a GLU_MIPMAP_SCALAR build, in which case the caller
+** falls back to its 2D loops.
+*/
+static GLboolean scaleSeparable(GLenum type, GLint components,
+				GLint widthin, GLint heightin,
+				const void *datain,
+				GLint widthout, GLint heightout,
+				void *dataout, GLint element_size,
+				GLint ysize, GLint group_size,
+				GLint myswap_bytes, GLboolean wrap)
 {
-   GLint halfWidth= width / 2;
-   GLint halfHeight= height / 2;
-   const char *src= (const char *) dataIn;
-   GLfloat *dest= dataOut;
-   int jj;
+    const PackedIntFormat *packed = packedIntFormat(type);
+    GLboolean fixed = type == GL_UNSIGNED_BYTE || type == GL_BYTE ||
+		      packed != NULL;
+    GLint out_group = wrap ? components * sizeof(GLushort) :
+		      packed ? packed->size : components * element_size;
+    ScaleSource src;
+    ScaleAxis ax, ay;
+    GLint xentries = scaleAxisEntries(widthin, widthout);
+    GLint yentries = scaleAxisEntries(heightin, heightout);
+    GLint ring, tile, j0, j1, i, e, k;
+    GLint *ringrow;
+    float area;
+    char *rowbuf, *ringbuf, *accbuf, *mem;
 
-   assert(width == 1 || height == 1); /* must be 1D */
-   assert(width != height);	/* can't be square */
+#if defined(GLU_MIPMAP_SCALAR)
+    return GL_FALSE;
+#endif
 
-   if (height == 1) {		/* 1 row */
-      assert(width != 1);	/* widthxheight can't be 1x1 */
-      halfHeight= 1;
+    /*
+    ** Ring of horizontally filtered rows, big enough to hold every row
+    ** one output row needs.  It only caches rows, so a smaller ring would
+    ** still give the same result.
+    */
+    ring = heightin < heightout ? 2 : heightin / heightout + 3;
+    tile = SCALE_TILE_BYTES / ((ring + 1) * components * 4);
+    if (tile < 16) tile = 16;
+    if (tile > widthout) tile = widthout;
+
+    mem = (char *)scratchAlloc((size_t)(widthout + heightout) *
+				   sizeof(ScaleSpan) +
+			       (size_t)(xentries + yentries) *
+				   (sizeof(GLint) * 2 + sizeof(GLfloat)) +
+			       (size_t)ring * sizeof(GLint) +
+			       (size_t)widthin * components * 4 +
+			       (size_t)(ring + 1) * tile * components * 4);
+    if (mem == NULL) {
+	return GL_FALSE;
+    }
 
-      for (jj= 0; jj< halfWidth; jj++) {
-	 int kk;
-	 for (kk= 0; kk< components; kk++) {
-#define BOX2 2
-	    GLfloat sfloat[BOX2];
-	    if (myswap_bytes) {
-	       sfloat[0]= __GLU_SWAP_4_BYTES(src);
-	       sfloat[1]= __GLU_SWAP_4_BYTES(src+group_size);
-	    }
-	    else {
-	       sfloat[0]= *(const GLfloat*)src;
-	       sfloat[1]= *(const GLfloat*)(src+group_size);
-	    }
+    accbuf = mem;
+    mem += (size_t)tile * components * 4;
+    ringbuf = mem;
+    mem += (size_t)ring * tile * components * 4;
+    rowbuf = mem;
+    mem += (size_t)widthin * components * 4;
+    ax.span = (ScaleSpan *)mem;
+    mem += widthout * sizeof(ScaleSpan);
+    ay.span = (ScaleSpan *)mem;
+    mem += heightout * sizeof(ScaleSpan);
+    ax.index = (GLint *)mem;
+    mem += xentries * sizeof(GLint);
+    ax.fixed = (GLint *)mem;
+    mem += xentries * sizeof(GLint);
+    ax.weight = (GLfloat *)mem;
+    mem += xentries * sizeof(GLfloat);
+    ay.index = (GLint *)mem;
+    mem += yentries * sizeof(GLint);
+    ay.fixed = (GLint *)mem;
+    mem += yentries * sizeof(GLint);
+    ay.weight = (GLfloat *)mem;
+    mem += yentries * sizeof(GLfloat);
+    ringrow = (GLint *)mem;
+
+    if (wrap) {
+	initScaleAxisWrap(&ax, widthin, widthout);
+	initScaleAxisWrap(&ay, heightin, heightout);
+    } else {
+	initScaleAxisBox(&ax, widthin, widthout, GL_FALSE);
+	initScaleAxisBox(&ay, heightin, heightout, GL_TRUE);
+    }
+    area = (float) widthin/widthout * ((float) heightin/heightout);
+
+    src.type = type;
+    src.components = components;
+    src.data = (const char *)datain;
+    src.element_size = element_size;
+    src.group_size = group_size;
+    src.ysize = ysize;
+    src.swap = myswap_bytes;
+
+    for (j0 = 0; j0 < widthout; j0 = j1) {
+	GLint lmin = widthin, lmax = 0;
+
+	j1 = j0 + tile;
+	if (j1 > widthout) j1 = widthout;
+	for (e = ax.span[j0].first;
+	     e < ax.span[j1-1].first + ax.span[j1-1].count; e++) {
+	    if (ax.index[e] < lmin) lmin = ax.index[e];
+	    if (ax.index[e] > lmax) lmax = ax.index[e];
+	}
+	for (e = 0; e < ring; e++) {
+	    ringrow[e] = -1;
+	}
 
-	    *dest= (sfloat[0] + sfloat[1]) / 2.0;
-	    src+= element_size;
-	    dest++;
-	 }
-	 src+= group_size;	/* skip to next 2 */
-      }
-      {
-	 int padBytes= ysize - (width*group_size);
-	 src+= padBytes;	/* for assertion only */
-      }
-   }
-   else if (width == 1) {	/* 1 column */
-      int padBytes= ysize - (width * group_size);
-      assert(height != 1);	/* widthxheight can't be 1x1 */
-      halfWidth= 1;
-      /* one vertical column with possible pad bytes per row */
-      /* average two at a time */
+	for (i = 0; i < heightout; i++) {
+	    const ScaleSpan *yspan = &ay.span[i];
+	    GLint n = (j1 - j0) * components;
+	    char *out = (char *)dataout +
+			(size_t)(j0 + i * widthout) * out_group;
+
+	    memset(accbuf, 0, n * 4);
+	    for (e = yspan->first; e < yspan->first + yspan->count; e++) {
+		GLint m = ay.index[e];
+		GLint slot = m % ring;
+		char *hrow = ringbuf + (size_t)slot * tile * components * 4;
+
+		if (ringrow[slot] != m) {
+		    if (packed) {
+			scaleDecodeRowPacked(&src, packed, m, lmin, lmax,
+					     (GLint *)rowbuf);
+			scaleFilterRowFixed(&ax, j0, j1, lmin, components,
+					    (const GLint *)rowbuf,
+					    (GLint *)hrow);
+		    } else if (fixed) {
+			scaleDecodeRowInt(&src, m, lmin, lmax,
+					  (GLint *)rowbuf);
+			scaleFilterRowFixed(&ax, j0, j1, lmin, components,
+					    (const GLint *)rowbuf,
+					    (GLint *)hrow);
+		    } else {
+			scaleDecodeRowFloat(&src, m, lmin, lmax,
+					    (GLfloat *)rowbuf);
+			scaleFilterRowFloat(&ax, j0, j1, lmin, components,
+					    (const GLfloat *)rowbuf,
+					    (GLfloat *)hrow);
+		    }
+		    ringrow[slot] = m;
+		}
 
-      for (jj= 0; jj< halfHeight; jj++) {
-	 int kk;
-	 for (kk= 0; kk< components; kk++) {
-#define BOX2 2
-	    GLfloat sfloat[BOX2];
-	    if (myswap_bytes) {
-	       sfloat[0]= __GLU_SWAP_4_BYTES(src);
-	       sfloat[1]= __GLU_SWAP_4_BYTES(src+ysize);
-	    }
-	    else {
-	       sfloat[0]= *(const GLfloat*)src;
-	       sfloat[1]= *(const GLfloat*)(src+ysize);
+		if (fixed) {
+		    const GLint *h = (const GLint *)hrow;
+		    GLint *acc = (GLint *)accbuf;
+		    GLint w = ay.fixed[e];
+
+		    for (k = 0; k < n; k++) acc[k] += w * h[k];
+		} else {
+		    const GLfloat *h = (const GLfloat *)hrow;
+		    GLfloat *acc = (GLfloat *)accbuf;
+		    GLfloat w = ay.weight[e];
+
+		    for (k = 0; k < n; k++) acc[k] += h[k] * w;
+		}
 	    }
-	    *dest= (sfloat[0] + sfloat[1]) / 2.0;
 
-	    src+= element_size;
-	    dest++;
-	 }
-	 src+= padBytes; /* add pad bytes, if any, to get to end to row */
-	 src+= ysize;		/* skip to odd row */
-      }
-   }
+	    if (packed) {
+		scaleStorePacked(packed, (const GLint *)accbuf, n, out);
+	    } else if (fixed) {
+		scaleStoreFixed(type, (const GLint *)accbuf, n, out);
+	    } else if (wrap) {
+		/* rounded like scale_internal() */
+		const GLfloat *acc = (const GLfloat *)accbuf;
 
-   assert(src == &((const char *)dataIn)[ysize*height]);
-   assert((char *)dest == &((char *)dataOut)
-	  [components * element_size * halfWidth * halfHeight]);
-} /* halve1Dimage_float() */
+		for (k = 0; k < n; k++) {
+		    ((GLushort *)out)[k] = (acc[k]+0.5) /
+			(ax.span[j0 + k / components].area * yspan->area);
+		}
+	    } else {
+		scaleStoreFloat(type, (const GLfloat *)accbuf, n, area, out);
+	    }
+	}
+    }
+
+    scratchFree(accbuf);
+    return GL_TRUE;
+}
 
 static void scale_internal(GLint components, GLint widthin, GLint heightin,
 			   const GLushort *datain,
@@ -1305,6 +3332,13 @@ static void scale_internal(GLint components, GLint widthin, GLint heightin,
 	halveImage(components, widthin, heightin, datain, dataout);
 	return;
     }
+    if (scaleSeparable(GL_UNSIGNED_SHORT, components, widthin, heightin,
+		       datain, widthout, heightout, dataout,
+		       sizeof(GLushort),
+		       widthin * components * sizeof(GLushort),
+		       components * sizeof(GLushort), 0, GL_TRUE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     halfconvx = convx/2;
@@ -1414,6 +3448,11 @@ static void scale_internal_ubyte(GLint components, GLint widthin,
 	element_size, ysize, group_size);
 	return;
     }
+    if (scaleSeparable(GL_UNSIGNED_BYTE, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, 0, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -1631,6 +3670,11 @@ static void scale_internal_byte(GLint components, GLint widthin,
 	element_size, ysize, group_size);
 	return;
     }
+    if (scaleSeparable(GL_BYTE, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, 0, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -1849,6 +3893,11 @@ static void scale_internal_ushort(GLint components, GLint widthin,
 	element_size, ysize, group_size, myswap_bytes);
 	return;
     }
+    if (scaleSeparable(GL_UNSIGNED_SHORT, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, myswap_bytes, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -2131,6 +4180,11 @@ static void scale_internal_short(GLint components, GLint widthin,
 	element_size, ysize, group_size, myswap_bytes);
 	return;
     }
+    if (scaleSeparable(GL_SHORT, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, myswap_bytes, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -2423,6 +4477,11 @@ static void scale_internal_uint(GLint components, GLint widthin,
 	element_size, ysize, group_size, myswap_bytes);
 	return;
     }
+    if (scaleSeparable(GL_UNSIGNED_INT, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, myswap_bytes, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -2712,6 +4771,11 @@ static void scale_internal_int(GLint components, GLint widthin,
 	element_size, ysize, group_size, myswap_bytes);
 	return;
     }
+    if (scaleSeparable(GL_INT, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, myswap_bytes, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -3008,6 +5072,11 @@ static void scale_internal_float(GLint components, GLint widthin,
 	element_size, ysize, group_size, myswap_bytes);
 	return;
     }
+    if (scaleSeparable(GL_FLOAT, components, widthin, heightin, datain,
+		       widthout, heightout, dataout, element_size,
+		       ysize, group_size, myswap_bytes, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -3521,12 +5590,12 @@ gluScaleImage(GLenum format, GLsizei widthin, GLsizei heightin,
        return GLU_INVALID_OPERATION;
     }
     beforeImage =
-	malloc(image_size(widthin, heightin, format, GL_UNSIGNED_SHORT));
+	scratchAlloc(image_size(widthin, heightin, format, GL_UNSIGNED_SHORT));
     afterImage =
-	malloc(image_size(widthout, heightout, format, GL_UNSIGNED_SHORT));
+	scratchAlloc(image_size(widthout, heightout, format, GL_UNSIGNED_SHORT));
     if (beforeImage == NULL || afterImage == NULL) {
-	free(beforeImage);
-	free(afterImage);
+	scratchFree(afterImage);
+	scratchFree(beforeImage);
 	return GLU_OUT_OF_MEMORY;
     }
 
@@ -3538,8 +5607,8 @@ gluScaleImage(GLenum format, GLsizei widthin, GLsizei heightin,
 	    widthout, heightout, afterImage);
     empty_image(&psm,widthout, heightout, format, typeout,
 	    is_index(format), afterImage, dataout);
-    free((GLbyte *) beforeImage);
-    free((GLbyte *) afterImage);
+    scratchFree(afterImage);
+    scratchFree(beforeImage);
 
     return 0;
 }
@@ -3553,6 +5622,7 @@ int gluBuild1DMipmapLevelsCore(GLenum target, GLint internalFormat,
 {
     GLint newwidth;
     GLint level, levels;
+    GLushort *chain;
     GLushort *newImage;
     GLint newImage_width;
     GLushort *otherImage;
@@ -3564,20 +5634,24 @@ int gluBuild1DMipmapLevelsCore(GLenum target, GLint internalFormat,
     assert(checkMipmapArgs(internalFormat,format,type) == 0);
     assert(width >= 1);
 
-    otherImage = NULL;
-
     newwidth= widthPowerOf2;
     levels = computeLog(newwidth);
 
     levels+= userLevel;
 
     retrieveStoreModes(&psm);
-    newImage = (GLushort *)
-	malloc(image_size(width, 1, format, GL_UNSIGNED_SHORT));
-    newImage_width = width;
-    if (newImage == NULL) {
+    /* both ping-pong buffers in one block */
+    memreq = image_size(width, 1, format, GL_UNSIGNED_SHORT);
+    memreq = (memreq + SCRATCH_ALIGN - 1) & ~(SCRATCH_ALIGN - 1);
+    chain = (GLushort *)
+	scratchAlloc(memreq + image_size(newwidth, 1, format,
+					 GL_UNSIGNED_SHORT));
+    if (chain == NULL) {
 	return GLU_OUT_OF_MEMORY;
     }
+    newImage = chain;
+    otherImage = (GLushort *)((GLubyte *)chain + memreq);
+    newImage_width = width;
     fill_image(&psm,width, 1, format, type, is_index(format),
 	    data, newImage);
     cmpts = elements_per_group(format,type);
@@ -3598,19 +5672,6 @@ int gluBuild1DMipmapLevelsCore(GLenum target, GLint internalFormat,
 		    0, format, GL_UNSIGNED_SHORT, (void *) newImage);
 	    }
 	} else {
-	    if (otherImage == NULL) {
-		memreq = image_size(newwidth, 1, format, GL_UNSIGNED_SHORT);
-		otherImage = (GLushort *) malloc(memreq);
-		if (otherImage == NULL) {
-		    glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
-		    glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
-		    glPixelStorei(GL_UNPACK_SKIP_PIXELS,psm.unpack_skip_pixels);
-		    glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
-		    glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
-		    free(newImage);
-		    return GLU_OUT_OF_MEMORY;
-		}
-	    }
 	    scale_internal(cmpts, newImage_width, 1, newImage,
 		    newwidth, 1, otherImage);
 	    /* Swap newImage and otherImage */
@@ -3632,10 +5693,7 @@ int gluBuild1DMipmapLevelsCore(GLenum target, GLint internalFormat,
     glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
     glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
 
-    free((GLbyte *) newImage);
-    if (otherImage) {
-	free((GLbyte *) otherImage);
-    }
+    scratchFree(chain);
     return 0;
 }
 
@@ -3788,17 +5846,377 @@ static int bitmapBuild2DMipmaps(GLenum target, GLint internalFormat,
     glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
     glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
 
-    free((GLbyte *) newImage);
-    if (otherImage) {
-	free((GLbyte *) otherImage);
+    free((GLbyte *) newImage);
+    if (otherImage) {
+	free((GLbyte *) otherImage);
+    }
+    return 0;
+}
+
+/* To make swapping images less error prone */
+#define __GLU_INIT_SWAP_IMAGE void *tmpImage
+#define __GLU_SWAP_IMAGE(a,b) tmpImage = a; a = b; b = tmpImage;
+
+/*
+** Allocates the scratch memory of a 2D mipmap chain whose first computed
+** image is width x height: that image, a buffer for the next level to
+** ping-pong with, and room to re-pad the rows of any level to alignment
+** before it is handed to glTexImage2D.  Everything comes from a single
+** scratch block, which is returned for scratchFree().
+*/
+static void *allocMipmapChain2D(GLint width, GLint height, GLenum format,
+				GLenum type, GLint alignment,
+				void **first, void **second, void **padded)
+{
+    GLint group_size = bytes_per_element(type) *
+		       elements_per_group(format, type);
+    GLint rowsize = width * group_size;
+    size_t firstSize, secondSize, paddedSize = 0;
+    char *chain;
+
+    firstSize = image_size(width, height, format, type);
+    firstSize = (firstSize + SCRATCH_ALIGN - 1) & ~(size_t)(SCRATCH_ALIGN - 1);
+    secondSize = image_size(width > 1 ? width/2 : 1, height > 1 ? height/2 : 1,
+			    format, type);
+    secondSize = (secondSize + SCRATCH_ALIGN - 1) &
+		 ~(size_t)(SCRATCH_ALIGN - 1);
+
+    /* same walk down the chain as the level loop */
+    for (;;) {
+	GLint rowPad = rowsize % alignment;
+
+	if (rowPad != 0 &&
+	    (size_t)(rowsize + alignment - rowPad) * height > paddedSize) {
+	    paddedSize = (size_t)(rowsize + alignment - rowPad) * height;
+	}
+	if (width == 1 && height == 1) break;
+	if (width > 1) { width /= 2; rowsize /= 2; }
+	if (height > 1) height /= 2;
+    }
+
+    chain = (char *)scratchAlloc(firstSize + secondSize + paddedSize);
+    if (chain == NULL) {
+	return NULL;
+    }
+    *first = chain;
+    *second = chain + firstSize;
+    *padded = chain + firstSize + secondSize;
+    return chain;
+}
+
+/*
+** The chain images have tightly packed rows.  Returns image itself if
+** that matches alignment, otherwise a copy in padded with every row
+** padded to it.  The pad bytes are not visited and will contain garbage,
+** which is ok.
+*/
+static const void *padMipmapRows(const void *image, void *padded,
+				 GLint rowsize, GLint height, GLint alignment)
+{
+    GLint rowPad = rowsize % alignment;
+    GLint newRowLength, ii;
+    const unsigned char *srcTrav;
+    unsigned char *dstTrav;
+
+    if (rowPad == 0) {
+	return image;
+    }
+    newRowLength = rowsize + alignment - rowPad;
+    for (ii = 0, dstTrav = (unsigned char *)padded,
+	 srcTrav = (const unsigned char *)image;
+	 ii < height;
+	 ii++, dstTrav += newRowLength, srcTrav += rowsize) {
+	memcpy(dstTrav, srcTrav, rowsize);
+    }
+    return padded;
+}
+
+/* Halves a 2D image of any type; see the halveImage*() routines. */
+static void halveImage2D(GLenum type, GLint cmpts, GLint width, GLint height,
+			 const void *srcImage, void *dstImage,
+			 GLint element_size, GLint rowsize, GLint group_size,
+			 GLint myswap_bytes)
+{
+    switch(type) {
+    case GL_UNSIGNED_BYTE:
+	halveImage_ubyte(cmpts, width, height,
+			 (const GLubyte *)srcImage, (GLubyte *)dstImage, element_size,
+			 rowsize, group_size);
+	break;
+    case GL_BYTE:
+	halveImage_byte(cmpts, width, height,
+			 (const GLbyte *)srcImage, (GLbyte *)dstImage, element_size,
+			 rowsize, group_size);
+	break;
+    case GL_UNSIGNED_SHORT:
+	halveImage_ushort(cmpts, width, height,
+			 (const GLushort *)srcImage, (GLushort *)dstImage, element_size,
+			 rowsize, group_size, myswap_bytes);
+	break;
+    case GL_SHORT:
+	halveImage_short(cmpts, width, height,
+			 (const GLshort *)srcImage, (GLshort *)dstImage, element_size,
+			 rowsize, group_size, myswap_bytes);
+	break;
+    case GL_UNSIGNED_INT:
+	halveImage_uint(cmpts, width, height,
+			 (const GLuint *)srcImage, (GLuint *)dstImage, element_size,
+			 rowsize, group_size, myswap_bytes);
+	break;
+    case GL_INT:
+	halveImage_int(cmpts, width, height,
+			 (const GLint *)srcImage, (GLint *)dstImage, element_size,
+			 rowsize, group_size, myswap_bytes);
+	break;
+    case GL_FLOAT:
+	halveImage_float(cmpts, width, height,
+			 (const GLfloat *)srcImage, (GLfloat *)dstImage, element_size,
+			 rowsize, group_size, myswap_bytes);
+	break;
+    case GL_UNSIGNED_BYTE_3_3_2:
+	halveImagePackedPixel(3,extract332,shove332,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_BYTE_2_3_3_REV:
+	halveImagePackedPixel(3,extract233rev,shove233rev,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_SHORT_5_6_5:
+	halveImagePackedPixel(3,extract565,shove565,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_SHORT_5_6_5_REV:
+	halveImagePackedPixel(3,extract565rev,shove565rev,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+	halveImagePackedPixel(4,extract4444,shove4444,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+	halveImagePackedPixel(4,extract4444rev,shove4444rev,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+	halveImagePackedPixel(4,extract5551,shove5551,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+	halveImagePackedPixel(4,extract1555rev,shove1555rev,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_INT_8_8_8_8:
+	halveImagePackedPixel(4,extract8888,shove8888,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_INT_8_8_8_8_REV:
+	halveImagePackedPixel(4,extract8888rev,shove8888rev,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_INT_10_10_10_2:
+	halveImagePackedPixel(4,extract1010102,shove1010102,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+	halveImagePackedPixel(4,extract2101010rev,shove2101010rev,
+			      width,height,
+			      srcImage,dstImage,element_size,rowsize,
+			      myswap_bytes);
+	break;
+    default:
+	assert(0);
+	break;
+    }
+}
+
+/*
+** Optional threaded halving.  When GLU_MIPMAP_THREADS is set to a count
+** above 1, levels of at least MIPMAP_THREAD_PIXELS source pixels are
+** split into bands of output rows, which that many threads halve
+** together: the calling thread and a pool of workers that are started on
+** first use and kept for the life of the process.  Only the halving is
+** shared; the glTexImage2D calls stay on the calling thread, in order.
+** A build that finds the pool busy with another thread's level halves on
+** its own.  A GLU_MIPMAP_SCALAR build never starts the pool.
+*/
+#ifndef _WIN32
+#define MIPMAP_MAX_THREADS 64
+#define MIPMAP_THREAD_PIXELS (256*256)
+#define MIPMAP_BAND_ROWS 16
+
+typedef struct {
+    GLenum type;
+    GLint cmpts;
+    GLint width;
+    GLint halfHeight;
+    const char *src;
+    char *dst;
+    GLint element_size;
+    GLint rowsize;
+    GLint group_size;
+    GLint myswap_bytes;
+    GLint bandRows;
+    GLint bands;
+} HalveJob;
+
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t submit;	/* held by the thread that owns job */
+    pthread_mutex_t lock;	/* protects the fields below */
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    int threads;		/* including the submitting thread */
+    HalveJob *job;
+    GLint next;			/* next band to hand out */
+    GLint pending;		/* bands not finished yet */
+} mipmapPool = {
+    PTHREAD_ONCE_INIT, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, 1, NULL, 0, 0
+};
+
+static void halveBand(const HalveJob *job, GLint band)
+{
+    GLint first = band * job->bandRows;
+    GLint rows = job->halfHeight - first;
+
+    if (rows > job->bandRows) rows = job->bandRows;
+    halveImage2D(job->type, job->cmpts, job->width, 2 * rows,
+		 job->src + (size_t)2 * first * job->rowsize,
+		 job->dst + (size_t)first * (job->width / 2) * job->group_size,
+		 job->element_size, job->rowsize, job->group_size,
+		 job->myswap_bytes);
+}
+
+/* Works on bands of the current job until none are left.  Called locked. */
+static void runHalveBands(void)
+{
+    HalveJob *job = mipmapPool.job;
+
+    while (mipmapPool.next < job->bands) {
+	GLint band = mipmapPool.next++;
+
+	pthread_mutex_unlock(&mipmapPool.lock);
+	halveBand(job, band);
+	pthread_mutex_lock(&mipmapPool.lock);
+	if (--mipmapPool.pending == 0) {
+	    pthread_cond_signal(&mipmapPool.done);
+	}
+    }
+}
+
+static void *mipmapWorker(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&mipmapPool.lock);
+    for (;;) {
+	while (mipmapPool.job == NULL ||
+	       mipmapPool.next >= mipmapPool.job->bands) {
+	    pthread_cond_wait(&mipmapPool.wake, &mipmapPool.lock);
+	}
+	runHalveBands();
+    }
+    return NULL;
+}
+
+static void startMipmapPool(void)
+{
+    const char *env = getenv("GLU_MIPMAP_THREADS");
+    int threads = env ? atoi(env) : 1;
+    pthread_attr_t attr;
+    pthread_t thread;
+
+#if defined(GLU_MIPMAP_SCALAR)
+    threads = 1;
+#endif
+    if (threads > MIPMAP_MAX_THREADS) threads = MIPMAP_MAX_THREADS;
+    if (threads <= 1 || pthread_attr_init(&attr) != 0) {
+	return;
+    }
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    while (mipmapPool.threads < threads &&
+	   pthread_create(&thread, &attr, mipmapWorker, NULL) == 0) {
+	mipmapPool.threads++;
+    }
+    pthread_attr_destroy(&attr);
+}
+#endif /* !_WIN32 */
+
+/*
+** Halves one level of a 2D mipmap chain, in parallel if the pool is
+** enabled and the level is big enough to be worth it.
+*/
+static void halveMipmapLevel(GLenum type, GLint cmpts,
+			     GLint width, GLint height,
+			     const void *srcImage, void *dstImage,
+			     GLint element_size, GLint rowsize,
+			     GLint group_size, GLint myswap_bytes)
+{
+#ifndef _WIN32
+    HalveJob job;
+    GLboolean big = width > 1 && height > 1 &&
+		    (size_t)width * height >= MIPMAP_THREAD_PIXELS;
+
+    if (big) {
+	pthread_once(&mipmapPool.once, startMipmapPool);
     }
-    return 0;
+    if (big && mipmapPool.threads > 1 &&
+	pthread_mutex_trylock(&mipmapPool.submit) == 0) {
+	job.type = type;
+	job.cmpts = cmpts;
+	job.width = width;
+	job.halfHeight = height / 2;
+	job.src = (const char *)srcImage;
+	job.dst = (char *)dstImage;
+	job.element_size = element_size;
+	job.rowsize = rowsize;
+	job.group_size = group_size;
+	job.myswap_bytes = myswap_bytes;
+	/* a few bands per thread, to even out uneven progress */
+	job.bandRows = job.halfHeight / (4 * mipmapPool.threads);
+	if (job.bandRows < MIPMAP_BAND_ROWS) job.bandRows = MIPMAP_BAND_ROWS;
+	job.bands = (job.halfHeight + job.bandRows - 1) / job.bandRows;
+
+	pthread_mutex_lock(&mipmapPool.lock);
+	mipmapPool.job = &job;
+	mipmapPool.next = 0;
+	mipmapPool.pending = job.bands;
+	pthread_cond_broadcast(&mipmapPool.wake);
+	runHalveBands();
+	while (mipmapPool.pending > 0) {
+	    pthread_cond_wait(&mipmapPool.done, &mipmapPool.lock);
+	}
+	mipmapPool.job = NULL;
+	pthread_mutex_unlock(&mipmapPool.lock);
+	pthread_mutex_unlock(&mipmapPool.submit);
+	return;
+    }
+#endif
+    halveImage2D(type, cmpts, width, height, srcImage, dstImage,
+		 element_size, rowsize, group_size, myswap_bytes);
 }
 
-/* To make swapping images less error prone */
-#define __GLU_INIT_SWAP_IMAGE void *tmpImage
-#define __GLU_SWAP_IMAGE(a,b) tmpImage = a; a = b; b = tmpImage;
-
 static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
 				      GLsizei width, GLsizei height,
 				      GLsizei widthPowerOf2,
@@ -3812,8 +6230,9 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
     GLint level, levels;
     const void *usersImage; /* passed from user. Don't touch! */
     void *srcImage, *dstImage; /* scratch area to build mipmapped images */
+    void *otherImage, *padImage;
+    void *chain;
     __GLU_INIT_SWAP_IMAGE;
-    GLint memreq;
     GLint cmpts;
 
     GLint myswap_bytes, groups_per_line, element_size, group_size;
@@ -3890,53 +6309,11 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
 	   /* clamp to 1 */
 	   if (nextWidth < 1) nextWidth= 1;
 	   if (nextHeight < 1) nextHeight= 1;
-	memreq = image_size(nextWidth, nextHeight, format, type);
-	}
-
-	switch(type) {
-	case GL_UNSIGNED_BYTE:
-	  dstImage = (GLubyte *)malloc(memreq);
-	  break;
-	case GL_BYTE:
-	  dstImage = (GLbyte *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_SHORT:
-	  dstImage = (GLushort *)malloc(memreq);
-	  break;
-	case GL_SHORT:
-	  dstImage = (GLshort *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_INT:
-	  dstImage = (GLuint *)malloc(memreq);
-	  break;
-	case GL_INT:
-	  dstImage = (GLint *)malloc(memreq);
-	  break;
-	case GL_FLOAT:
-	  dstImage = (GLfloat *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_BYTE_3_3_2:
-	case GL_UNSIGNED_BYTE_2_3_3_REV:
-	  dstImage = (GLubyte *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_SHORT_5_6_5:
-	case GL_UNSIGNED_SHORT_5_6_5_REV:
-	case GL_UNSIGNED_SHORT_4_4_4_4:
-	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-	case GL_UNSIGNED_SHORT_5_5_5_1:
-	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-	  dstImage = (GLushort *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_INT_8_8_8_8:
-	case GL_UNSIGNED_INT_8_8_8_8_REV:
-	case GL_UNSIGNED_INT_10_10_10_2:
-	case GL_UNSIGNED_INT_2_10_10_10_REV:
-	  dstImage = (GLuint *)malloc(memreq);  
-	  break;
-	default:
-	  return GLU_INVALID_ENUM;
+	chain = allocMipmapChain2D(nextWidth, nextHeight, format, type,
+				   psm.unpack_alignment, &dstImage,
+				   &otherImage, &padImage);
 	}
-	if (dstImage == NULL) {
+	if (chain == NULL) {
 	  glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
 	  glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
 	  glPixelStorei(GL_UNPACK_SKIP_PIXELS, psm.unpack_skip_pixels);
@@ -3945,108 +6322,8 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
 	  return GLU_OUT_OF_MEMORY;
 	}
 	else
-	  switch(type) {
-	  case GL_UNSIGNED_BYTE:
-	    halveImage_ubyte(cmpts, width, height,
-			     (const GLubyte *)usersImage, (GLubyte *)dstImage,
-			     element_size, rowsize, group_size);
-	    break;
-	  case GL_BYTE:
-	    halveImage_byte(cmpts, width, height,
-			    (const GLbyte *)usersImage, (GLbyte *)dstImage,
-			    element_size, rowsize, group_size);
-	    break;
-	  case GL_UNSIGNED_SHORT:
-	    halveImage_ushort(cmpts, width, height,
-			      (const GLushort *)usersImage, (GLushort *)dstImage,
-			      element_size, rowsize, group_size, myswap_bytes);
-	    break;
-	  case GL_SHORT:
-	    halveImage_short(cmpts, width, height,
-			     (const GLshort *)usersImage, (GLshort *)dstImage,
-			     element_size, rowsize, group_size, myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_INT:
-	    halveImage_uint(cmpts, width, height,
-			    (const GLuint *)usersImage, (GLuint *)dstImage,
-			    element_size, rowsize, group_size, myswap_bytes);
-	    break;
-	  case GL_INT:
-	    halveImage_int(cmpts, width, height,
-			   (const GLint *)usersImage, (GLint *)dstImage,
+	  halveMipmapLevel(type, cmpts, width, height, usersImage, dstImage,
 			   element_size, rowsize, group_size, myswap_bytes);
-	    break;
-	  case GL_FLOAT:
-	    halveImage_float(cmpts, width, height,
-			     (const GLfloat *)usersImage, (GLfloat *)dstImage,
-			     element_size, rowsize, group_size, myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_BYTE_3_3_2:
-	    assert(format == GL_RGB);
-	    halveImagePackedPixel(3,extract332,shove332,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_BYTE_2_3_3_REV:
-	    assert(format == GL_RGB);
-	    halveImagePackedPixel(3,extract233rev,shove233rev,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_SHORT_5_6_5:
-	    halveImagePackedPixel(3,extract565,shove565,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_SHORT_5_6_5_REV:
-	    halveImagePackedPixel(3,extract565rev,shove565rev,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_SHORT_4_4_4_4:
-	    halveImagePackedPixel(4,extract4444,shove4444,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-	    halveImagePackedPixel(4,extract4444rev,shove4444rev,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_SHORT_5_5_5_1:
-	    halveImagePackedPixel(4,extract5551,shove5551,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-	    halveImagePackedPixel(4,extract1555rev,shove1555rev,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_INT_8_8_8_8:
-	    halveImagePackedPixel(4,extract8888,shove8888,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_INT_8_8_8_8_REV:
-	    halveImagePackedPixel(4,extract8888rev,shove8888rev,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_INT_10_10_10_2:
-	    halveImagePackedPixel(4,extract1010102,shove1010102,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  case GL_UNSIGNED_INT_2_10_10_10_REV:
-	    halveImagePackedPixel(4,extract2101010rev,shove2101010rev,
-				  width,height,usersImage,dstImage,
-				  element_size,rowsize,myswap_bytes);
-	    break;
-	  default:
-	    assert(0);
-	    break;
-	  }
 	newwidth = width/2;
 	newheight = height/2;
 	/* clamp to 1 */
@@ -4055,110 +6332,15 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
 
 	myswap_bytes = 0;
 	rowsize = newwidth * group_size;
-	memreq = image_size(newwidth, newheight, format, type);
-	/* Swap srcImage and dstImage */
-	__GLU_SWAP_IMAGE(srcImage,dstImage);
-	switch(type) {
-	case GL_UNSIGNED_BYTE:
-	  dstImage = (GLubyte *)malloc(memreq);
-	  break;
-	case GL_BYTE:
-	  dstImage = (GLbyte *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_SHORT:
-	  dstImage = (GLushort *)malloc(memreq);
-	  break;
-	case GL_SHORT:
-	  dstImage = (GLshort *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_INT:
-	  dstImage = (GLuint *)malloc(memreq);
-	  break;
-	case GL_INT:
-	  dstImage = (GLint *)malloc(memreq);
-	  break;
-	case GL_FLOAT:
-	  dstImage = (GLfloat *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_BYTE_3_3_2:
-	case GL_UNSIGNED_BYTE_2_3_3_REV:
-	  dstImage = (GLubyte *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_SHORT_5_6_5:
-	case GL_UNSIGNED_SHORT_5_6_5_REV:
-	case GL_UNSIGNED_SHORT_4_4_4_4:
-	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-	case GL_UNSIGNED_SHORT_5_5_5_1:
-	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-	  dstImage = (GLushort *)malloc(memreq);
-	  break;
-	case GL_UNSIGNED_INT_8_8_8_8:
-	case GL_UNSIGNED_INT_8_8_8_8_REV:
-	case GL_UNSIGNED_INT_10_10_10_2:
-	case GL_UNSIGNED_INT_2_10_10_10_REV:
-	  dstImage = (GLuint *)malloc(memreq);
-	  break;
-	default:
-	  return GLU_INVALID_ENUM;
-	}
-	if (dstImage == NULL) {
-	  glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
-	  glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
-	  glPixelStorei(GL_UNPACK_SKIP_PIXELS, psm.unpack_skip_pixels);
-	  glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
-	  glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
-	  free(srcImage);
-	  return GLU_OUT_OF_MEMORY;
-	}
+	srcImage = dstImage;
+	dstImage = otherImage;
 	/* level userLevel+1 is in srcImage; level userLevel already saved */
 	level = userLevel+1;
     } else { /* user's image is *not* nice power-of-2 sized square */
-	memreq = image_size(newwidth, newheight, format, type);
-	switch(type) {
-	    case GL_UNSIGNED_BYTE:
-		dstImage = (GLubyte *)malloc(memreq);
-		break;
-	    case GL_BYTE:
-		dstImage = (GLbyte *)malloc(memreq);
-		break;
-	    case GL_UNSIGNED_SHORT:
-		dstImage = (GLushort *)malloc(memreq);
-		break;
-	    case GL_SHORT:
-		dstImage = (GLshort *)malloc(memreq);
-		break;
-	    case GL_UNSIGNED_INT:
-		dstImage = (GLuint *)malloc(memreq);
-		break;
-	    case GL_INT:
-		dstImage = (GLint *)malloc(memreq);
-		break;
-	    case GL_FLOAT:
-		dstImage = (GLfloat *)malloc(memreq);
-		break;
-	    case GL_UNSIGNED_BYTE_3_3_2:
-	    case GL_UNSIGNED_BYTE_2_3_3_REV:
-		dstImage = (GLubyte *)malloc(memreq);
-		break;
-	    case GL_UNSIGNED_SHORT_5_6_5:
-	    case GL_UNSIGNED_SHORT_5_6_5_REV:
-	    case GL_UNSIGNED_SHORT_4_4_4_4:
-	    case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-	    case GL_UNSIGNED_SHORT_5_5_5_1:
-	    case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-		dstImage = (GLushort *)malloc(memreq);
-		break;
-	    case GL_UNSIGNED_INT_8_8_8_8:
-	    case GL_UNSIGNED_INT_8_8_8_8_REV:
-	    case GL_UNSIGNED_INT_10_10_10_2:
-	    case GL_UNSIGNED_INT_2_10_10_10_REV:
-		dstImage = (GLuint *)malloc(memreq);
-		break;
-	    default:
-		return GLU_INVALID_ENUM;
-	}
-
-	if (dstImage == NULL) {
+	chain = allocMipmapChain2D(newwidth, newheight, format, type,
+				   psm.unpack_alignment, &dstImage,
+				   &otherImage, &padImage);
+	if (chain == NULL) {
 	    glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
 	    glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
 	    glPixelStorei(GL_UNPACK_SKIP_PIXELS, psm.unpack_skip_pixels);
@@ -4288,72 +6470,8 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
 	}
 	myswap_bytes = 0;
 	rowsize = newwidth * group_size;
-	/* Swap dstImage and srcImage */
-	__GLU_SWAP_IMAGE(srcImage,dstImage);
-
-	if(levels != 0) { /* use as little memory as possible */
-	  {
-	     int nextWidth= newwidth/2;
-	     int nextHeight= newheight/2;
-	     if (nextWidth < 1) nextWidth= 1;
-	     if (nextHeight < 1) nextHeight= 1; 
-
-	  memreq = image_size(nextWidth, nextHeight, format, type);
-	  }
-
-	  switch(type) {
-	  case GL_UNSIGNED_BYTE:
-	    dstImage = (GLubyte *)malloc(memreq);
-	    break;
-	  case GL_BYTE:
-	    dstImage = (GLbyte *)malloc(memreq);
-	    break;
-	  case GL_UNSIGNED_SHORT:
-	    dstImage = (GLushort *)malloc(memreq);
-	    break;
-	  case GL_SHORT:
-	    dstImage = (GLshort *)malloc(memreq);
-	    break;
-	  case GL_UNSIGNED_INT:
-	    dstImage = (GLuint *)malloc(memreq);
-	    break;
-	  case GL_INT:
-	    dstImage = (GLint *)malloc(memreq);
-	    break;
-	  case GL_FLOAT:
-	    dstImage = (GLfloat *)malloc(memreq);
-	    break;
-	  case GL_UNSIGNED_BYTE_3_3_2:
-	  case GL_UNSIGNED_BYTE_2_3_3_REV:
-	    dstImage = (GLubyte *)malloc(memreq);
-	    break;
-	  case GL_UNSIGNED_SHORT_5_6_5:
-	  case GL_UNSIGNED_SHORT_5_6_5_REV:
-	  case GL_UNSIGNED_SHORT_4_4_4_4:
-	  case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-	  case GL_UNSIGNED_SHORT_5_5_5_1:
-	  case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-	    dstImage = (GLushort *)malloc(memreq);
-	    break;
-	  case GL_UNSIGNED_INT_8_8_8_8:
-	  case GL_UNSIGNED_INT_8_8_8_8_REV:
-	  case GL_UNSIGNED_INT_10_10_10_2:
-	  case GL_UNSIGNED_INT_2_10_10_10_REV:
-	    dstImage = (GLuint *)malloc(memreq);
-	    break;
-	  default:
-	    return GLU_INVALID_ENUM;
-	  }
-	  if (dstImage == NULL) {
-	    glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
-	    glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
-	    glPixelStorei(GL_UNPACK_SKIP_PIXELS, psm.unpack_skip_pixels);
-	    glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
-	    glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
-	    free(srcImage);
-	    return GLU_OUT_OF_MEMORY;
-	  }
-	}
+	srcImage = dstImage;
+	dstImage = otherImage;
 	/* level userLevel is in srcImage; nothing saved yet */
 	level = userLevel;
     }
@@ -4361,181 +6479,26 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
     glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_FALSE);
     if (baseLevel <= level && level <= maxLevel) {
     glTexImage2D(target, level, internalFormat, newwidth, newheight, 0,
-		 format, type, (void *)srcImage);
+		 format, type,
+		 padMipmapRows(srcImage, padImage, rowsize, newheight,
+			       psm.unpack_alignment));
     }
 
     level++; /* update current level for the loop */
     for (; level <= levels; level++) {
-	switch(type) {
-	    case GL_UNSIGNED_BYTE:
-		halveImage_ubyte(cmpts, newwidth, newheight,
-		(GLubyte *)srcImage, (GLubyte *)dstImage, element_size,
-		rowsize, group_size);
-		break;
-	    case GL_BYTE:
-		halveImage_byte(cmpts, newwidth, newheight,
-		(GLbyte *)srcImage, (GLbyte *)dstImage, element_size,
-		rowsize, group_size);
-		break;
-	    case GL_UNSIGNED_SHORT:
-		halveImage_ushort(cmpts, newwidth, newheight,
-		(GLushort *)srcImage, (GLushort *)dstImage, element_size,
-		rowsize, group_size, myswap_bytes);
-		break;
-	    case GL_SHORT:
-		halveImage_short(cmpts, newwidth, newheight,
-		(GLshort *)srcImage, (GLshort *)dstImage, element_size,
-		rowsize, group_size, myswap_bytes);
-		break;
-	    case GL_UNSIGNED_INT:
-		halveImage_uint(cmpts, newwidth, newheight,
-		(GLuint *)srcImage, (GLuint *)dstImage, element_size,
-		rowsize, group_size, myswap_bytes);
-		break;
-	    case GL_INT:
-		halveImage_int(cmpts, newwidth, newheight,
-		(GLint *)srcImage, (GLint *)dstImage, element_size,
-		rowsize, group_size, myswap_bytes);
-		break;
-	    case GL_FLOAT:
-		halveImage_float(cmpts, newwidth, newheight,
-		(GLfloat *)srcImage, (GLfloat *)dstImage, element_size,
-		rowsize, group_size, myswap_bytes);
-		break;
-	    case GL_UNSIGNED_BYTE_3_3_2:
-		halveImagePackedPixel(3,extract332,shove332,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_BYTE_2_3_3_REV:
-		halveImagePackedPixel(3,extract233rev,shove233rev,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_SHORT_5_6_5:
-		halveImagePackedPixel(3,extract565,shove565,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_SHORT_5_6_5_REV:
-		halveImagePackedPixel(3,extract565rev,shove565rev,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_SHORT_4_4_4_4:
-		halveImagePackedPixel(4,extract4444,shove4444,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-		halveImagePackedPixel(4,extract4444rev,shove4444rev,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_SHORT_5_5_5_1:	        
-		halveImagePackedPixel(4,extract5551,shove5551,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_SHORT_1_5_5_5_REV: 	        
-		halveImagePackedPixel(4,extract1555rev,shove1555rev,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_INT_8_8_8_8:
-		halveImagePackedPixel(4,extract8888,shove8888,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_INT_8_8_8_8_REV:
-		halveImagePackedPixel(4,extract8888rev,shove8888rev,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_INT_10_10_10_2:
-		halveImagePackedPixel(4,extract1010102,shove1010102,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    case GL_UNSIGNED_INT_2_10_10_10_REV:
-		halveImagePackedPixel(4,extract2101010rev,shove2101010rev,
-				      newwidth,newheight,
-				      srcImage,dstImage,element_size,rowsize,
-				      myswap_bytes);
-		break;
-	    default:
-		assert(0);
-		break;
-	}
+	halveMipmapLevel(type, cmpts, newwidth, newheight, srcImage, dstImage,
+			 element_size, rowsize, group_size, myswap_bytes);
 
 	__GLU_SWAP_IMAGE(srcImage,dstImage);
 
 	if (newwidth > 1) { newwidth /= 2; rowsize /= 2;}
 	if (newheight > 1) newheight /= 2;
-      {
-       /* compute amount to pad per row, if any */
-       int rowPad= rowsize % psm.unpack_alignment;
-
-       /* should row be padded? */
-       if (rowPad == 0) {	/* nope, row should not be padded */
-	   /* call tex image with srcImage untouched since it's not padded */
-	   if (baseLevel <= level && level <= maxLevel) {
-	   glTexImage2D(target, level, internalFormat, newwidth, newheight, 0,
-	   format, type, (void *) srcImage);
-	   }
-       }
-       else {			/* yes, row should be padded */
-	  /* compute length of new row in bytes, including padding */
-	  int newRowLength= rowsize + psm.unpack_alignment - rowPad;
-	  int ii; unsigned char *dstTrav, *srcTrav; /* indices for copying */
-
-	  /* allocate new image for mipmap of size newRowLength x newheight */
-	  void *newMipmapImage= malloc((size_t) (newRowLength*newheight));
-	  if (newMipmapImage == NULL) {
-	     /* out of memory so return */
-	     glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
-	     glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
-	     glPixelStorei(GL_UNPACK_SKIP_PIXELS, psm.unpack_skip_pixels);
-	     glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
-	     glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
-	     free(srcImage);
-	     free(dstImage);
-	     return GLU_OUT_OF_MEMORY;
-	  }
-
-	  /* copy image from srcImage into newMipmapImage by rows */
-	  for (ii= 0,
-	       dstTrav= (unsigned char *) newMipmapImage,
-	       srcTrav= (unsigned char *) srcImage;
-	       ii< newheight;
-	       ii++,
-	       dstTrav+= newRowLength, /* make sure the correct distance... */
-	       srcTrav+= rowsize) {    /* ...is skipped */
-	     memcpy(dstTrav,srcTrav,rowsize);
-	     /* note that the pad bytes are not visited and will contain
-	      * garbage, which is ok.
-	      */
-	  }
-
-	  /* ...and use this new image for mipmapping instead */
-	  if (baseLevel <= level && level <= maxLevel) {
-	  glTexImage2D(target, level, internalFormat, newwidth, newheight, 0,
-		       format, type, newMipmapImage);
-	  }
-	  free(newMipmapImage); /* don't forget to free it! */
-       } /* else */
-      }
+	if (baseLevel <= level && level <= maxLevel) {
+	glTexImage2D(target, level, internalFormat, newwidth, newheight, 0,
+		     format, type,
+		     padMipmapRows(srcImage, padImage, rowsize, newheight,
+				   psm.unpack_alignment));
+	}
     } /* for level */
     glPixelStorei(GL_UNPACK_ALIGNMENT, psm.unpack_alignment);
     glPixelStorei(GL_UNPACK_SKIP_ROWS, psm.unpack_skip_rows);
@@ -4543,10 +6506,7 @@ static int gluBuild2DMipmapLevelsCore(GLenum target, GLint internalFormat,
     glPixelStorei(GL_UNPACK_ROW_LENGTH, psm.unpack_row_length);
     glPixelStorei(GL_UNPACK_SWAP_BYTES, psm.unpack_swap_bytes);
 
-    free(srcImage); /*if you get to here, a srcImage has always been malloc'ed*/
-    if (dstImage) { /* if it's non-rectangular and only 1 level */
-      free(dstImage);
-    }
+    scratchFree(chain);
     return 0;
 } /* gluBuild2DMipmapLevelsCore() */
 
@@ -6045,6 +8005,7 @@ static void scaleInternalPackedPixel(int components,
     int convy_int, convx_int;
     int l, m;
     const char *left, *right;
+    const PackedIntFormat *fmt;
 
     if (widthIn == widthOut*2 && heightIn == heightOut*2) {
 	halveImagePackedPixel(components,extractPackedPixel,shovePackedPixel,
@@ -6052,6 +8013,13 @@ static void scaleInternalPackedPixel(int components,
 			      pixelSizeInBytes,rowSizeInBytes,isSwap);
 	return;
     }
+    fmt = packedIntFormatOf(extractPackedPixel);
+    if (fmt != NULL &&
+	scaleSeparable(fmt->type, components, widthIn, heightIn, dataIn,
+		       widthOut, heightOut, dataOut, pixelSizeInBytes,
+		       rowSizeInBytes, pixelSizeInBytes, isSwap, GL_FALSE)) {
+	return;
+    }
     convy = (float) heightIn/heightOut;
     convx = (float) widthIn/widthOut;
     convy_int = floor(convy);
@@ -6413,6 +8381,55 @@ static void scaleInternalPackedPixel(int components,
     assert(outindex == (widthOut*heightOut - 1));
 } /* scaleInternalPackedPixel() */
 
+/*
+** Integer version of halveImagePackedPixel() for packedIntFormats[].
+** A 1 pixel wide or high image reads each pixel twice, which averages
+** the same as halve1DimagePackedPixel().
+*/
+#define HALVE_PACKED_INT(TYPE)						\
+    for (ii = 0; ii < halfHeight; ii++) {				\
+	const char *src = (const char *)dataIn + 2*ii*rowSizeInBytes;	\
+	TYPE *dest = (TYPE *)dataOut + ii*halfWidth;			\
+	for (jj = 0; jj < halfWidth; jj++, src += 2*fmt->size) {	\
+	    p0 = loadPackedPixel(fmt, src, isSwap);			\
+	    p1 = loadPackedPixel(fmt, src + xstep, isSwap);		\
+	    p2 = loadPackedPixel(fmt, src + ystep, isSwap);		\
+	    p3 = loadPackedPixel(fmt, src + xstep + ystep, isSwap);	\
+	    even = (p0 & fmt->even) + (p1 & fmt->even) +		\
+		   (p2 & fmt->even) + (p3 & fmt->even);			\
+	    odd = ((p0 & fmt->odd) >> fmt->oddshift) +			\
+		  ((p1 & fmt->odd) >> fmt->oddshift) +			\
+		  ((p2 & fmt->odd) >> fmt->oddshift) +			\
+		  ((p3 & fmt->odd) >> fmt->oddshift);			\
+	    dest[jj] = (((even + evenround) >> 2) & fmt->even) |	\
+		       ((((odd + oddround) >> 2) & oddmask) << fmt->oddshift); \
+	}								\
+    }
+
+static void halvePackedInt(const PackedIntFormat *fmt,
+			   GLint width, GLint height,
+			   const void *dataIn, void *dataOut,
+			   GLint rowSizeInBytes, GLint isSwap)
+{
+    GLint halfWidth = width > 1 ? width / 2 : 1;
+    GLint halfHeight = height > 1 ? height / 2 : 1;
+    GLint xstep = width > 1 ? fmt->size : 0;
+    GLint ystep = height > 1 ? rowSizeInBytes : 0;
+    GLuint oddmask = fmt->odd >> fmt->oddshift;
+    /* 2 in the lowest bit of every field, to round the sum of 4 */
+    GLuint evenround = (fmt->even & ~(fmt->even << 1)) << 1;
+    GLuint oddround = (oddmask & ~(oddmask << 1)) << 1;
+    GLuint p0, p1, p2, p3, even, odd;
+    GLint ii, jj;
+
+    if (fmt->size == 2) {
+	HALVE_PACKED_INT(GLushort)
+    } else {
+	HALVE_PACKED_INT(GLuint)
+    }
+}
+#undef HALVE_PACKED_INT
+
 /* rowSizeInBytes is at least the width (in bytes) due to padding on
  *  inputs; not always equal. Output NEVER has row padding.
  */
@@ -6426,6 +8443,13 @@ static void halveImagePackedPixel(int components,
 				  GLint pixelSizeInBytes,
 				  GLint rowSizeInBytes, GLint isSwap)
 {
+   const PackedIntFormat *fmt = packedIntFormatOf(extractPackedPixel);
+
+   if (fmt != NULL) {
+      halvePackedInt(fmt,width,height,dataIn,dataOut,rowSizeInBytes,isSwap);
+      return;
+   }
+
    /* handle case where there is only 1 column/row */
    if (width == 1 || height == 1) {
       assert(!(width == 1 && height == 1)); /* can't be 1x1 */
@@ -8417,8 +10441,10 @@ static int gluBuild3DMipmapLevelsCore(GLenum target, GLint internalFormat,
        __GLU_SWAP_IMAGE(srcImage,dstImage);
 
        if (newWidth > 1) { newWidth /= 2; rowSize /= 2;}
-       if (newHeight > 1) { newHeight /= 2; imageSize = rowSize * newHeight; }
+       if (newHeight > 1) newHeight /= 2;
        if (newDepth > 1) newDepth /= 2;
+       /* rows shrink with the width too, so this is needed once height is 1 */
+       imageSize = rowSize * newHeight;
        {
 	  /* call tex image with srcImage untouched since it's not padded */
 	  if (baseLevel <= level && level <= maxLevel) {
@@ -8823,6 +10849,113 @@ static void halveImageSlice(int components,
 
 } /* halveImageSlice() */
 
+/*
+** halveImage3D() for unswapped GLubyte, GLushort and GLfloat data, which
+** is most 3D textures.  It averages the 2x2x2 boxes with typed loops and
+** SIMD row kernels instead of calling extract and shove per component,
+** and gives the same results.  Returns GL_FALSE for any other data, and
+** in a GLU_MIPMAP_SCALAR build.
+*/
+static GLboolean halveImage3DDirect(int components,
+				    GLdouble (*extract)(int, const void *),
+				    GLint width, GLint height, GLint depth,
+				    const void *dataIn, void *dataOut,
+				    GLint elementSizeInBytes,
+				    GLint groupSizeInBytes,
+				    GLint rowSizeInBytes,
+				    GLint imageSizeInBytes,
+				    GLint isSwap)
+{
+   GLenum type;
+   Halve3DRowProc halveRow;
+   int halfWidth= width / 2;
+   int halfHeight= height / 2;
+   int halfDepth= depth / 2;
+   int ii, jj, dd, cc, x;
+
+#if defined(GLU_MIPMAP_SCALAR)
+   return GL_FALSE;
+#endif
+   if (extract == extractUbyte) {
+      type= GL_UNSIGNED_BYTE;
+   }
+   else if (extract == extractUshort && !isSwap) {
+      type= GL_UNSIGNED_SHORT;
+   }
+   else if (extract == extractFloat && !isSwap) {
+      type= GL_FLOAT;
+   }
+   else {
+      return GL_FALSE;
+   }
+   if (groupSizeInBytes != elementSizeInBytes * components) {
+      return GL_FALSE;
+   }
+   halveRow= halve3DRowProc(type, components, elementSizeInBytes,
+			    groupSizeInBytes);
+
+#define BOX3D(T) \
+   (((const T *)r0)[x] + ((const T *)r0)[x+components] + \
+    ((const T *)r1)[x] + ((const T *)r1)[x+components] + \
+    ((const T *)r2)[x] + ((const T *)r2)[x+components] + \
+    ((const T *)r3)[x] + ((const T *)r3)[x+components])
+
+   for (dd= 0; dd < halfDepth; dd++) {
+      for (ii= 0; ii < halfHeight; ii++) {
+	 const char *r0= (const char *)dataIn +
+			 (size_t)2*dd*imageSizeInBytes +
+			 (size_t)2*ii*rowSizeInBytes;
+	 const char *r1= r0 + rowSizeInBytes;
+	 const char *r2= r0 + imageSizeInBytes;
+	 const char *r3= r2 + rowSizeInBytes;
+	 char *out= (char *)dataOut +
+		    (size_t)(dd*halfHeight + ii) * halfWidth * groupSizeInBytes;
+
+	 jj= 0;
+	 if (halveRow != NULL) {
+	    jj= halveRow(components, halfWidth, r0, r1, r2, r3, out);
+	 }
+	 switch (type) {
+	 case GL_UNSIGNED_BYTE:
+	    for (; jj < halfWidth; jj++) {
+	       for (cc= 0; cc < components; cc++) {
+		  x= 2*jj*components + cc;
+		  ((GLubyte *)out)[jj*components + cc]= BOX3D(GLubyte) / 8;
+	       }
+	    }
+	    break;
+	 case GL_UNSIGNED_SHORT:
+	    for (; jj < halfWidth; jj++) {
+	       for (cc= 0; cc < components; cc++) {
+		  x= 2*jj*components + cc;
+		  ((GLushort *)out)[jj*components + cc]= BOX3D(GLushort) / 8;
+	       }
+	    }
+	    break;
+	 case GL_FLOAT:
+	    /* summed in double and in the same order as halveImage3D() */
+	    for (; jj < halfWidth; jj++) {
+	       for (cc= 0; cc < components; cc++) {
+		  x= 2*jj*components + cc;
+		  ((GLfloat *)out)[jj*components + cc]=
+		     ((GLdouble)((const GLfloat *)r0)[x] +
+		      ((const GLfloat *)r0)[x+components] +
+		      ((const GLfloat *)r1)[x] +
+		      ((const GLfloat *)r1)[x+components] +
+		      ((const GLfloat *)r2)[x] +
+		      ((const GLfloat *)r2)[x+components] +
+		      ((const GLfloat *)r3)[x] +
+		      ((const GLfloat *)r3)[x+components]) / 8.0;
+	       }
+	    }
+	    break;
+	 }
+      }
+   }
+#undef BOX3D
+   return GL_TRUE;
+} /* halveImage3DDirect() */
+
 static void halveImage3D(int components,
 			 GLdouble (*extract)(int, const void *),
 			 void (*shove)(GLdouble, int, void *),
@@ -8845,6 +10978,12 @@ static void halveImage3D(int components,
 		      rowSizeInBytes, imageSizeInBytes, isSwap);
       return;
    }
+   if (halveImage3DDirect(components, extract, width, height, depth,
+			  dataIn, dataOut, elementSizeInBytes,
+			  groupSizeInBytes, rowSizeInBytes, imageSizeInBytes,
+			  isSwap)) {
+      return;
+   }
    {
       int ii, jj, dd;
 
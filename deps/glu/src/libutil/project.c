@@ -34,6 +34,15 @@
 #include <GL/glu.h>
 #include "gluint.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLU_SIMD_HAVE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GLU_SIMD_HAVE_NEON 1
+#endif
+
 /*
 ** Make m an identity matrix
 */
@@ -344,6 +353,273 @@ gluUnProject4(GLdouble winx, GLdouble winy, GLdouble winz, GLdouble clipw,
     return(GL_TRUE);
 }
 
+/*
+** Batched gluProject/gluUnProject (GLU_EXT_project_array).  The matrices
+** are multiplied, and for gluUnProjectvEXT inverted, once per call instead
+** of once per point.  Points are then transformed two at a time with SSE2
+** or NEON: the x, y and z of a pair are split into separate vectors, so
+** each lane does the same operations in the same order as the single
+** point code below, which handles the odd point and any pair with w == 0.
+*/
+static GLboolean projectPoint(const GLdouble m[16], const GLint viewport[4],
+			      const GLdouble obj[3], GLdouble win[3])
+{
+    double in[4];
+    double out[4];
+
+    in[0]=obj[0];
+    in[1]=obj[1];
+    in[2]=obj[2];
+    in[3]=1.0;
+    __gluMultMatrixVecd(m, in, out);
+    if (out[3] == 0.0) return GL_FALSE;
+    out[0] /= out[3];
+    out[1] /= out[3];
+    out[2] /= out[3];
+    /* Map x, y and z to range 0-1 */
+    out[0] = out[0] * 0.5 + 0.5;
+    out[1] = out[1] * 0.5 + 0.5;
+    out[2] = out[2] * 0.5 + 0.5;
+
+    /* Map x,y to viewport */
+    win[0] = out[0] * viewport[2] + viewport[0];
+    win[1] = out[1] * viewport[3] + viewport[1];
+    win[2] = out[2];
+    return GL_TRUE;
+}
+
+static GLboolean unProjectPoint(const GLdouble m[16], const GLint viewport[4],
+				const GLdouble win[3], GLdouble obj[3])
+{
+    double in[4];
+    double out[4];
+
+    /* Map x and y from window coordinates */
+    in[0] = (win[0] - viewport[0]) / viewport[2];
+    in[1] = (win[1] - viewport[1]) / viewport[3];
+
+    /* Map to range -1 to 1 */
+    in[0] = in[0] * 2 - 1;
+    in[1] = in[1] * 2 - 1;
+    in[2] = win[2] * 2 - 1;
+    in[3] = 1.0;
+
+    __gluMultMatrixVecd(m, in, out);
+    if (out[3] == 0.0) return GL_FALSE;
+    obj[0] = out[0] / out[3];
+    obj[1] = out[1] / out[3];
+    obj[2] = out[2] / out[3];
+    return GL_TRUE;
+}
+
+#if defined(GLU_SIMD_HAVE_SSE2)
+typedef __m128d pointPair;
+
+#define pairSet(v)	_mm_set1_pd(v)
+#define pairAdd(a, b)	_mm_add_pd(a, b)
+#define pairSub(a, b)	_mm_sub_pd(a, b)
+#define pairMul(a, b)	_mm_mul_pd(a, b)
+#define pairDiv(a, b)	_mm_div_pd(a, b)
+
+static GLboolean pairHasZero(pointPair v)
+{
+    return _mm_movemask_pd(_mm_cmpeq_pd(v, _mm_setzero_pd())) != 0;
+}
+
+/* Splits two packed xyz points into x, y and z pairs. */
+static void loadPair(const GLdouble *p, pointPair *x, pointPair *y,
+		     pointPair *z)
+{
+    __m128d a = _mm_loadu_pd(p);	/* x0 y0 */
+    __m128d b = _mm_loadu_pd(p + 2);	/* z0 x1 */
+    __m128d c = _mm_loadu_pd(p + 4);	/* y1 z1 */
+
+    *x = _mm_shuffle_pd(a, b, 2);
+    *y = _mm_shuffle_pd(a, c, 1);
+    *z = _mm_shuffle_pd(b, c, 2);
+}
+
+static void storePair(GLdouble *p, pointPair x, pointPair y, pointPair z)
+{
+    _mm_storeu_pd(p, _mm_unpacklo_pd(x, y));
+    _mm_storeu_pd(p + 2, _mm_shuffle_pd(z, x, 2));
+    _mm_storeu_pd(p + 4, _mm_unpackhi_pd(y, z));
+}
+#define GLU_PROJECT_PAIRS 1
+#elif defined(GLU_SIMD_HAVE_NEON)
+typedef float64x2_t pointPair;
+
+#define pairSet(v)	vdupq_n_f64(v)
+#define pairAdd(a, b)	vaddq_f64(a, b)
+#define pairSub(a, b)	vsubq_f64(a, b)
+#define pairMul(a, b)	vmulq_f64(a, b)
+#define pairDiv(a, b)	vdivq_f64(a, b)
+
+static GLboolean pairHasZero(pointPair v)
+{
+    return vmaxvq_u32(vreinterpretq_u32_u64(vceqzq_f64(v))) != 0;
+}
+
+static void loadPair(const GLdouble *p, pointPair *x, pointPair *y,
+		     pointPair *z)
+{
+    float64x2x3_t v = vld3q_f64(p);
+
+    *x = v.val[0];
+    *y = v.val[1];
+    *z = v.val[2];
+}
+
+static void storePair(GLdouble *p, pointPair x, pointPair y, pointPair z)
+{
+    float64x2x3_t v;
+
+    v.val[0] = x;
+    v.val[1] = y;
+    v.val[2] = z;
+    vst3q_f64(p, v);
+}
+#define GLU_PROJECT_PAIRS 1
+#endif
+
+#if defined(GLU_PROJECT_PAIRS)
+/* Row i of m times (x, y, z, 1), summed as in __gluMultMatrixVecd(). */
+static pointPair transformPair(const GLdouble m[16], int i, pointPair x,
+			       pointPair y, pointPair z)
+{
+    pointPair r;
+
+    r = pairMul(x, pairSet(m[0*4+i]));
+    r = pairAdd(r, pairMul(y, pairSet(m[1*4+i])));
+    r = pairAdd(r, pairMul(z, pairSet(m[2*4+i])));
+    return pairAdd(r, pairSet(m[3*4+i]));
+}
+
+/* Returns the number of points done, always even. */
+static GLsizei projectPairs(const GLdouble m[16], const GLint viewport[4],
+			    GLsizei count, const GLdouble *obj, GLdouble *win,
+			    GLint *result)
+{
+    const pointPair half = pairSet(0.5);
+    const pointPair vx = pairSet(viewport[0]);
+    const pointPair vy = pairSet(viewport[1]);
+    const pointPair vw = pairSet(viewport[2]);
+    const pointPair vh = pairSet(viewport[3]);
+    GLsizei i;
+
+    for (i = 0; i + 2 <= count; i += 2, obj += 6, win += 6) {
+	pointPair x, y, z, cx, cy, cz, cw;
+
+	loadPair(obj, &x, &y, &z);
+	cw = transformPair(m, 3, x, y, z);
+	if (pairHasZero(cw)) {
+	    if (!projectPoint(m, viewport, obj, win)) *result = GL_FALSE;
+	    if (!projectPoint(m, viewport, obj+3, win+3)) *result = GL_FALSE;
+	    continue;
+	}
+	cx = pairDiv(transformPair(m, 0, x, y, z), cw);
+	cy = pairDiv(transformPair(m, 1, x, y, z), cw);
+	cz = pairDiv(transformPair(m, 2, x, y, z), cw);
+	cx = pairAdd(pairMul(cx, half), half);
+	cy = pairAdd(pairMul(cy, half), half);
+	cz = pairAdd(pairMul(cz, half), half);
+	cx = pairAdd(pairMul(cx, vw), vx);
+	cy = pairAdd(pairMul(cy, vh), vy);
+	storePair(win, cx, cy, cz);
+    }
+    return i;
+}
+
+static GLsizei unProjectPairs(const GLdouble m[16], const GLint viewport[4],
+			      GLsizei count, const GLdouble *win,
+			      GLdouble *obj, GLint *result)
+{
+    const pointPair one = pairSet(1.0);
+    const pointPair two = pairSet(2.0);
+    const pointPair vx = pairSet(viewport[0]);
+    const pointPair vy = pairSet(viewport[1]);
+    const pointPair vw = pairSet(viewport[2]);
+    const pointPair vh = pairSet(viewport[3]);
+    GLsizei i;
+
+    for (i = 0; i + 2 <= count; i += 2, win += 6, obj += 6) {
+	pointPair x, y, z, ow;
+
+	loadPair(win, &x, &y, &z);
+	x = pairDiv(pairSub(x, vx), vw);
+	y = pairDiv(pairSub(y, vy), vh);
+	x = pairSub(pairMul(x, two), one);
+	y = pairSub(pairMul(y, two), one);
+	z = pairSub(pairMul(z, two), one);
+	ow = transformPair(m, 3, x, y, z);
+	if (pairHasZero(ow)) {
+	    if (!unProjectPoint(m, viewport, win, obj)) *result = GL_FALSE;
+	    if (!unProjectPoint(m, viewport, win+3, obj+3)) *result = GL_FALSE;
+	    continue;
+	}
+	storePair(obj, pairDiv(transformPair(m, 0, x, y, z), ow),
+		  pairDiv(transformPair(m, 1, x, y, z), ow),
+		  pairDiv(transformPair(m, 2, x, y, z), ow));
+    }
+    return i;
+}
+#endif /* GLU_PROJECT_PAIRS */
+
+GLint GLAPIENTRY
+gluProjectvEXT(GLsizei count, const GLdouble *objCoords,
+	       const GLdouble *modelMatrix,
+	       const GLdouble *projMatrix,
+	       const GLint *viewport,
+	       GLdouble *winCoords)
+{
+    double finalMatrix[16];
+    GLint result = GL_TRUE;
+    GLsizei i = 0;
+
+    if (count < 0) return(GL_FALSE);
+    __gluMultMatricesd(modelMatrix, projMatrix, finalMatrix);
+
+#if defined(GLU_PROJECT_PAIRS)
+    i = projectPairs(finalMatrix, viewport, count, objCoords, winCoords,
+		     &result);
+#endif
+    for (; i < count; i++) {
+	if (!projectPoint(finalMatrix, viewport, objCoords + 3*i,
+			  winCoords + 3*i)) {
+	    result = GL_FALSE;
+	}
+    }
+    return(result);
+}
+
+GLint GLAPIENTRY
+gluUnProjectvEXT(GLsizei count, const GLdouble *winCoords,
+		 const GLdouble *modelMatrix,
+		 const GLdouble *projMatrix,
+		 const GLint *viewport,
+		 GLdouble *objCoords)
+{
+    double finalMatrix[16];
+    GLint result = GL_TRUE;
+    GLsizei i = 0;
+
+    if (count < 0) return(GL_FALSE);
+    __gluMultMatricesd(modelMatrix, projMatrix, finalMatrix);
+    if (!__gluInvertMatrixd(finalMatrix, finalMatrix)) return(GL_FALSE);
+
+#if defined(GLU_PROJECT_PAIRS)
+    i = unProjectPairs(finalMatrix, viewport, count, winCoords, objCoords,
+		       &result);
+#endif
+    for (; i < count; i++) {
+	if (!unProjectPoint(finalMatrix, viewport, winCoords + 3*i,
+			    objCoords + 3*i)) {
+	    result = GL_FALSE;
+	}
+    }
+    return(result);
+}
+
 void GLAPIENTRY
 gluPickMatrix(GLdouble x, GLdouble y, GLdouble deltax, GLdouble deltay,
 		  GLint viewport[4])
@@ -32,6 +32,7 @@
 #include "gluint.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
@@ -42,12 +43,69 @@
 #undef	PI
 #define PI	      3.14159265358979323846
 
+/* Shapes kept per quadric object, and the largest shape (in vertices)
+ * that is kept.
+ */
+#define SHAPE_CACHE_SIZE	8
+#define SHAPE_MAX_VERTICES	65536
+
+/* floats per stored vertex, in GL_T2F_N3F_V3F order */
+#define SHAPE_VERTEX_SIZE	8
+
+enum { SHAPE_CYLINDER, SHAPE_DISK, SHAPE_SPHERE };
+
+/* Everything the vertices of a shape depend on.  Keys are compared with
+ * memcmp, so they are cleared before they are filled in.
+ */
+typedef struct {
+    GLint	shape;
+    GLdouble	params[4];
+    GLint	slices;
+    GLint	stacks;
+    GLint	normals;
+    GLboolean	textureCoords;
+    GLint	orientation;
+    GLint	drawStyle;
+} ShapeKey;
+
+typedef struct {
+    GLenum	mode;
+    GLint	first;
+    GLsizei	count;
+} ShapePrimitive;
+
+/* The output of one gluCylinder/gluPartialDisk/gluSphere call: the
+ * vertices with the normal and texture coordinate current at each one,
+ * and the primitives drawn from them.
+ */
+typedef struct Shape {
+    ShapeKey	key;
+    GLfloat	*vertices;		/* SHAPE_VERTEX_SIZE per vertex */
+    GLint	numVertices;
+    GLint	maxVertices;
+    ShapePrimitive *prims;
+    GLint	numPrims;
+    GLint	maxPrims;
+
+    GLfloat	normal[3];		/* current normal, if hasNormal */
+    GLfloat	texCoord[2];		/* current texcoord, if hasTexCoord */
+    GLboolean	hasNormal;
+    GLboolean	hasTexCoord;
+    GLboolean	failed;			/* out of memory */
+    GLboolean	immediate;		/* cannot be drawn from arrays */
+
+    struct Shape *next;			/* most recently used first */
+} Shape;
+
 struct GLUquadric {
     GLint	normals;
     GLboolean	textureCoords;
     GLint	orientation;
     GLint	drawStyle;
     void	(GLAPIENTRY *errorCallback)( GLint );
+
+    Shape	*shapes;		/* shapes drawn before */
+    Shape	*recording;		/* shape being recorded, or NULL */
 };
 
 GLUquadric * GLAPIENTRY
@@ -65,13 +123,27 @@ gluNewQuadric(void)
     newstate->orientation = GLU_OUTSIDE;
     newstate->drawStyle = GLU_FILL;
     newstate->errorCallback = NULL;
+    newstate->shapes = NULL;
+    newstate->recording = NULL;
     return newstate;
 }
 
+static void freeShape(Shape *shape)
+{
+    free(shape->vertices);
+    free(shape->prims);
+    free(shape);
+}
 
 void GLAPIENTRY
 gluDeleteQuadric(GLUquadric *state)
 {
+    Shape *shape, *next;
+
+    for (shape = state->shapes; shape != NULL; shape = next) {
+	next = shape->next;
+	freeShape(shape);
+    }
     free(state);
 }
 
@@ -146,9 +218,298 @@ gluQuadricDrawStyle(GLUquadric *qobj, GLenum drawStyle)
     qobj->drawStyle = drawStyle;
 }
 
+/*
+** Shape cache.  Applications tend to draw the same quadric many times
+** (a molecule viewer draws every atom with the same gluSphere call), so
+** the output of each call is recorded into vertex and primitive arrays
+** the first time, kept on the quadric object keyed by the arguments and
+** the quadric state, and drawn with vertex arrays when the call is
+** repeated.  Each strip or fan stays a primitive of its own, so flat
+** shading, polygon mode and line stipple give the same picture as the
+** immediate mode calls.
+**
+** The drawing code calls quadBegin/quadEnd/quadNormal3f/quadTexCoord2f/
+** quadVertex3f, which go to GL directly unless a shape is being recorded.
+**
+** Defining GLU_QUADRIC_IMMEDIATE leaves the cache out, so every call is
+** drawn in immediate mode; the tests build a copy of this file that way
+** to compare against.
+*/
+
+static void quadBegin(GLUquadric *qobj, GLenum mode)
+{
+    Shape *shape = qobj->recording;
+
+    if (shape == NULL) {
+	glBegin(mode);
+	return;
+    }
+    if (shape->numPrims == shape->maxPrims) {
+	ShapePrimitive *prims;
+	GLint max = shape->maxPrims ? 2 * shape->maxPrims : 16;
+
+	prims = (ShapePrimitive *) realloc(shape->prims,
+		max * sizeof(ShapePrimitive));
+	if (prims == NULL) {
+	    shape->failed = GL_TRUE;
+	    return;
+	}
+	shape->prims = prims;
+	shape->maxPrims = max;
+    }
+    shape->prims[shape->numPrims].mode = mode;
+    shape->prims[shape->numPrims].first = shape->numVertices;
+}
+
+static void quadEnd(GLUquadric *qobj)
+{
+    Shape *shape = qobj->recording;
+    ShapePrimitive *prim;
+
+    if (shape == NULL) {
+	glEnd();
+	return;
+    }
+    if (shape->failed) return;
+    prim = &shape->prims[shape->numPrims];
+    prim->count = shape->numVertices - prim->first;
+    if (prim->count > 0) {
+	shape->numPrims++;
+    }
+}
+
+static void quadNormal3f(GLUquadric *qobj, GLfloat x, GLfloat y, GLfloat z)
+{
+    Shape *shape = qobj->recording;
+
+    if (shape == NULL) {
+	glNormal3f(x, y, z);
+	return;
+    }
+    shape->normal[0] = x;
+    shape->normal[1] = y;
+    shape->normal[2] = z;
+    shape->hasNormal = GL_TRUE;
+}
+
+static void quadTexCoord2f(GLUquadric *qobj, GLfloat s, GLfloat t)
+{
+    Shape *shape = qobj->recording;
+
+    if (shape == NULL) {
+	glTexCoord2f(s, t);
+	return;
+    }
+    shape->texCoord[0] = s;
+    shape->texCoord[1] = t;
+    shape->hasTexCoord = GL_TRUE;
+}
+
+static void quadVertex3f(GLUquadric *qobj, GLfloat x, GLfloat y, GLfloat z)
+{
+    Shape *shape = qobj->recording;
+    GLfloat *v;
+
+    if (shape == NULL) {
+	glVertex3f(x, y, z);
+	return;
+    }
+    if (shape->failed || shape->immediate) return;
+
+    /* A vertex that uses the normal or texture coordinate the client
+    ** left current cannot be stored; such shapes are always drawn in
+    ** immediate mode.
+    */
+    if ((qobj->normals != GLU_NONE && !shape->hasNormal) ||
+	    (qobj->textureCoords && !shape->hasTexCoord)) {
+	shape->immediate = GL_TRUE;
+	return;
+    }
+
+    if (shape->numVertices == shape->maxVertices) {
+	GLint max = 2 * shape->maxVertices;
+
+	if (max > SHAPE_MAX_VERTICES ||
+		(v = (GLfloat *) realloc(shape->vertices,
+			max * SHAPE_VERTEX_SIZE * sizeof(GLfloat))) == NULL) {
+	    shape->failed = GL_TRUE;
+	    return;
+	}
+	shape->vertices = v;
+	shape->maxVertices = max;
+    }
+    v = shape->vertices + shape->numVertices * SHAPE_VERTEX_SIZE;
+    v[0] = shape->texCoord[0];
+    v[1] = shape->texCoord[1];
+    v[2] = shape->normal[0];
+    v[3] = shape->normal[1];
+    v[4] = shape->normal[2];
+    v[5] = x;
+    v[6] = y;
+    v[7] = z;
+    shape->numVertices++;
+}
+
+static void drawShape(GLUquadric *qobj, Shape *shape)
+{
+    GLint i;
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glInterleavedArrays(GL_T2F_N3F_V3F, 0, shape->vertices);
+    if (qobj->normals == GLU_NONE) {
+	glDisableClientState(GL_NORMAL_ARRAY);
+    }
+    if (!qobj->textureCoords) {
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    }
+    for (i = 0; i < shape->numPrims; i++) {
+	glDrawArrays(shape->prims[i].mode, shape->prims[i].first,
+		shape->prims[i].count);
+    }
+    glPopClientAttrib();
+
+    /* leave the same current values as the immediate mode calls */
+    if (shape->hasNormal) {
+	glNormal3fv(shape->normal);
+    }
+    if (shape->hasTexCoord) {
+	glTexCoord2fv(shape->texCoord);
+    }
+}
+
+static void makeKey(GLUquadric *qobj, ShapeKey *key, GLint shape,
+		    GLdouble p0, GLdouble p1, GLdouble p2, GLdouble p3,
+		    GLint slices, GLint stacks)
+{
+    memset(key, 0, sizeof(ShapeKey));
+    key->shape = shape;
+    key->params[0] = p0;
+    key->params[1] = p1;
+    key->params[2] = p2;
+    key->params[3] = p3;
+    key->slices = slices;
+    key->stacks = stacks;
+    key->normals = qobj->normals;
+    key->textureCoords = qobj->textureCoords;
+    key->orientation = qobj->orientation;
+    key->drawStyle = qobj->drawStyle;
+}
+
+/* Looks the shape up.  Returns GL_TRUE if it was drawn from the cache.
+** Otherwise the caller draws it, and it is recorded if qobj->recording
+** was set.
+*/
+static GLboolean beginShape(GLUquadric *qobj, const ShapeKey *key)
+{
+    Shape *shape, **link;
+    GLint i, slices, stacks, size;
+
+#if defined(GLU_QUADRIC_IMMEDIATE)
+    return GL_FALSE;
+#endif
+
+    for (link = &qobj->shapes, i = 0; (shape = *link) != NULL;
+	    link = &shape->next, i++) {
+	if (memcmp(&shape->key, key, sizeof(ShapeKey)) == 0) {
+	    *link = shape->next;
+	    shape->next = qobj->shapes;
+	    qobj->shapes = shape;
+	    if (shape->immediate) return GL_FALSE;
+	    drawShape(qobj, shape);
+	    return GL_TRUE;
+	}
+	if (i == SHAPE_CACHE_SIZE - 1) {
+	    /* evict the least recently used shape */
+	    *link = NULL;
+	    freeShape(shape);
+	    break;
+	}
+    }
+
+    /* every style draws at most about 2 * (slices+1) * (stacks+1)
+    ** vertices, where stacks is the number of loops for a disk
+    */
+    slices = key->slices < CACHE_SIZE ? key->slices : CACHE_SIZE-1;
+    stacks = key->stacks;
+    if (slices < 2 || stacks < 1 ||
+	    stacks >= SHAPE_MAX_VERTICES / (2 * (slices + 1)) - 1) {
+	return GL_FALSE;
+    }
+    size = 2 * (slices + 1) * (stacks + 1);
+
+    shape = (Shape *) calloc(1, sizeof(Shape));
+    if (shape == NULL) return GL_FALSE;
+    shape->vertices = (GLfloat *)
+	    malloc(size * SHAPE_VERTEX_SIZE * sizeof(GLfloat));
+    if (shape->vertices == NULL) {
+	free(shape);
+	return GL_FALSE;
+    }
+    shape->maxVertices = size;
+    shape->key = *key;
+    qobj->recording = shape;
+    return GL_FALSE;
+}
+
+/* Ends the recording started by beginShape.  Returns GL_FALSE if the
+** caller has to draw the shape again, in immediate mode.
+*/
+static GLboolean endShape(GLUquadric *qobj)
+{
+    Shape *shape = qobj->recording;
+
+    if (shape == NULL) return GL_TRUE;
+    qobj->recording = NULL;
+
+    if (shape->failed) {
+	freeShape(shape);
+	return GL_FALSE;
+    }
+    if (shape->immediate) {
+	/* keep the key, so that it is not recorded again */
+	free(shape->vertices);
+	free(shape->prims);
+	shape->vertices = NULL;
+	shape->prims = NULL;
+    } else if (shape->numPrims == 0) {
+	/* invalid arguments, nothing was drawn */
+	freeShape(shape);
+	return GL_TRUE;
+    }
+    shape->next = qobj->shapes;
+    qobj->shapes = shape;
+    if (shape->immediate) return GL_FALSE;
+    drawShape(qobj, shape);
+    return GL_TRUE;
+}
+
+static void drawCylinder(GLUquadric *qobj, GLdouble baseRadius,
+			 GLdouble topRadius, GLdouble height, GLint slices,
+			 GLint stacks);
+static void drawPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
+			    GLdouble outerRadius, GLint slices, GLint loops,
+			    GLdouble startAngle, GLdouble sweepAngle);
+static void drawSphere(GLUquadric *qobj, GLdouble radius, GLint slices,
+		       GLint stacks);
+
 void GLAPIENTRY
 gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 		GLdouble height, GLint slices, GLint stacks)
+{
+    ShapeKey key;
+
+    makeKey(qobj, &key, SHAPE_CYLINDER, baseRadius, topRadius, height, 0.0,
+	    slices, stacks);
+    if (beginShape(qobj, &key)) return;
+    drawCylinder(qobj, baseRadius, topRadius, height, slices, stacks);
+    if (!endShape(qobj)) {
+	drawCylinder(qobj, baseRadius, topRadius, height, slices, stacks);
+    }
+}
+
+static void
+drawCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
+		GLdouble height, GLint slices, GLint stacks)
 {
     GLint i,j;
     GLfloat sinCache[CACHE_SIZE];
@@ -195,7 +556,11 @@ gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 	if (qobj->drawStyle != GLU_POINT) {
 	    needCache3 = 1;
 	}
-	if (qobj->drawStyle == GLU_LINE) {
+	/* the points and the lines along the sides take the vertex
+	** normals; without them they would be drawn with whatever the
+	** stack held
+	*/
+	if (qobj->drawStyle != GLU_FILL) {
 	    needCache2 = 1;
 	}
     }
@@ -261,14 +626,14 @@ gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 	    radiusLow = baseRadius - deltaRadius * ((float) j / stacks);
 	    radiusHigh = baseRadius - deltaRadius * ((float) (j + 1) / stacks);
 
-	    glBegin(GL_QUAD_STRIP);
+	    quadBegin(qobj, GL_QUAD_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		switch(qobj->normals) {
 		  case GLU_FLAT:
-		    glNormal3f(sinCache3[i], cosCache3[i], zNormal);
+		    quadNormal3f(qobj, sinCache3[i], cosCache3[i], zNormal);
 		    break;
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2[i], cosCache2[i], zNormal);
+		    quadNormal3f(qobj, sinCache2[i], cosCache2[i], zNormal);
 		    break;
 		  case GLU_NONE:
 		  default:
@@ -276,42 +641,42 @@ gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 		}
 		if (qobj->orientation == GLU_OUTSIDE) {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				(float) j / stacks);
 		    }
-		    glVertex3f(radiusLow * sinCache[i],
+		    quadVertex3f(qobj, radiusLow * sinCache[i],
 			    radiusLow * cosCache[i], zLow);
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				(float) (j+1) / stacks);
 		    }
-		    glVertex3f(radiusHigh * sinCache[i],
+		    quadVertex3f(qobj, radiusHigh * sinCache[i],
 			    radiusHigh * cosCache[i], zHigh);
 		} else {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				(float) (j+1) / stacks);
 		    }
-		    glVertex3f(radiusHigh * sinCache[i],
+		    quadVertex3f(qobj, radiusHigh * sinCache[i],
 			    radiusHigh * cosCache[i], zHigh);
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				(float) j / stacks);
 		    }
-		    glVertex3f(radiusLow * sinCache[i],
+		    quadVertex3f(qobj, radiusLow * sinCache[i],
 			    radiusLow * cosCache[i], zLow);
 		}
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	break;
       case GLU_POINT:
-	glBegin(GL_POINTS);
+	quadBegin(qobj, GL_POINTS);
 	for (i = 0; i < slices; i++) {
 	    switch(qobj->normals) {
 	      case GLU_FLAT:
 	      case GLU_SMOOTH:
-		glNormal3f(sinCache2[i], cosCache2[i], zNormal);
+		quadNormal3f(qobj, sinCache2[i], cosCache2[i], zNormal);
 		break;
 	      case GLU_NONE:
 	      default:
@@ -324,41 +689,41 @@ gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 		radiusLow = baseRadius - deltaRadius * ((float) j / stacks);
 
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    (float) j / stacks);
 		}
-		glVertex3f(radiusLow * sintemp,
+		quadVertex3f(qobj, radiusLow * sintemp,
 			radiusLow * costemp, zLow);
 	    }
 	}
-	glEnd();
+	quadEnd(qobj);
 	break;
       case GLU_LINE:
 	for (j = 1; j < stacks; j++) {
 	    zLow = j * height / stacks;
 	    radiusLow = baseRadius - deltaRadius * ((float) j / stacks);
 
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		switch(qobj->normals) {
 		  case GLU_FLAT:
-		    glNormal3f(sinCache3[i], cosCache3[i], zNormal);
+		    quadNormal3f(qobj, sinCache3[i], cosCache3[i], zNormal);
 		    break;
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2[i], cosCache2[i], zNormal);
+		    quadNormal3f(qobj, sinCache2[i], cosCache2[i], zNormal);
 		    break;
 		  case GLU_NONE:
 		  default:
 		    break;
 		}
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    (float) j / stacks);
 		}
-		glVertex3f(radiusLow * sinCache[i],
+		quadVertex3f(qobj, radiusLow * sinCache[i],
 			radiusLow * cosCache[i], zLow);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	/* Intentionally fall through here... */
       case GLU_SILHOUETTE:
@@ -366,33 +731,33 @@ gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 	    zLow = j * height / stacks;
 	    radiusLow = baseRadius - deltaRadius * ((float) j / stacks);
 
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		switch(qobj->normals) {
 		  case GLU_FLAT:
-		    glNormal3f(sinCache3[i], cosCache3[i], zNormal);
+		    quadNormal3f(qobj, sinCache3[i], cosCache3[i], zNormal);
 		    break;
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2[i], cosCache2[i], zNormal);
+		    quadNormal3f(qobj, sinCache2[i], cosCache2[i], zNormal);
 		    break;
 		  case GLU_NONE:
 		  default:
 		    break;
 		}
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    (float) j / stacks);
 		}
-		glVertex3f(radiusLow * sinCache[i], radiusLow * cosCache[i],
-			zLow);
+		quadVertex3f(qobj, radiusLow * sinCache[i],
+			radiusLow * cosCache[i], zLow);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	for (i = 0; i < slices; i++) {
 	    switch(qobj->normals) {
 	      case GLU_FLAT:
 	      case GLU_SMOOTH:
-		glNormal3f(sinCache2[i], cosCache2[i], 0.0);
+		quadNormal3f(qobj, sinCache2[i], cosCache2[i], 0.0);
 		break;
 	      case GLU_NONE:
 	      default:
@@ -400,19 +765,19 @@ gluCylinder(GLUquadric *qobj, GLdouble baseRadius, GLdouble topRadius,
 	    }
 	    sintemp = sinCache[i];
 	    costemp = cosCache[i];
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (j = 0; j <= stacks; j++) {
 		zLow = j * height / stacks;
 		radiusLow = baseRadius - deltaRadius * ((float) j / stacks);
 
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    (float) j / stacks);
 		}
-		glVertex3f(radiusLow * sintemp,
+		quadVertex3f(qobj, radiusLow * sintemp,
 			radiusLow * costemp, zLow);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	break;
       default:
@@ -431,6 +796,24 @@ void GLAPIENTRY
 gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 		   GLdouble outerRadius, GLint slices, GLint loops,
 		   GLdouble startAngle, GLdouble sweepAngle)
+{
+    ShapeKey key;
+
+    makeKey(qobj, &key, SHAPE_DISK, innerRadius, outerRadius, startAngle,
+	    sweepAngle, slices, loops);
+    if (beginShape(qobj, &key)) return;
+    drawPartialDisk(qobj, innerRadius, outerRadius, slices, loops,
+	    startAngle, sweepAngle);
+    if (!endShape(qobj)) {
+	drawPartialDisk(qobj, innerRadius, outerRadius, slices, loops,
+		startAngle, sweepAngle);
+    }
+}
+
+static void
+drawPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
+		   GLdouble outerRadius, GLint slices, GLint loops,
+		   GLdouble startAngle, GLdouble sweepAngle)
 {
     GLint i,j;
     GLfloat sinCache[CACHE_SIZE];
@@ -485,9 +868,9 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
       case GLU_FLAT:
       case GLU_SMOOTH:
 	if (qobj->orientation == GLU_OUTSIDE) {
-	    glNormal3f(0.0, 0.0, 1.0);
+	    quadNormal3f(qobj, 0.0, 0.0, 1.0);
 	} else {
-	    glNormal3f(0.0, 0.0, -1.0);
+	    quadNormal3f(qobj, 0.0, 0.0, -1.0);
 	}
 	break;
       default:
@@ -500,11 +883,11 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 	if (innerRadius == 0.0) {
 	    finish = loops - 1;
 	    /* Triangle strip for inner polygons */
-	    glBegin(GL_TRIANGLE_FAN);
+	    quadBegin(qobj, GL_TRIANGLE_FAN);
 	    if (qobj->textureCoords) {
-		glTexCoord2f(0.5, 0.5);
+		quadTexCoord2f(qobj, 0.5, 0.5);
 	    }
-	    glVertex3f(0.0, 0.0, 0.0);
+	    quadVertex3f(qobj, 0.0, 0.0, 0.0);
 	    radiusLow = outerRadius -
 		    deltaRadius * ((float) (loops-1) / loops);
 	    if (qobj->textureCoords) {
@@ -514,23 +897,23 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 	    if (qobj->orientation == GLU_OUTSIDE) {
 		for (i = slices; i >= 0; i--) {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(texLow * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 				texLow * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusLow * sinCache[i],
+		    quadVertex3f(qobj, radiusLow * sinCache[i],
 			    radiusLow * cosCache[i], 0.0);
 		}
 	    } else {
 		for (i = 0; i <= slices; i++) {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(texLow * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 				texLow * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusLow * sinCache[i],
+		    quadVertex3f(qobj, radiusLow * sinCache[i],
 			    radiusLow * cosCache[i], 0.0);
 		}
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	} else {
 	    finish = loops;
 	}
@@ -542,43 +925,43 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 		texHigh = radiusHigh / outerRadius / 2;
 	    }
 
-	    glBegin(GL_QUAD_STRIP);
+	    quadBegin(qobj, GL_QUAD_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		if (qobj->orientation == GLU_OUTSIDE) {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(texLow * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 				texLow * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusLow * sinCache[i],
+		    quadVertex3f(qobj, radiusLow * sinCache[i],
 			    radiusLow * cosCache[i], 0.0);
 
 		    if (qobj->textureCoords) {
-			glTexCoord2f(texHigh * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texHigh * sinCache[i] + 0.5,
 				texHigh * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusHigh * sinCache[i],
+		    quadVertex3f(qobj, radiusHigh * sinCache[i],
 			    radiusHigh * cosCache[i], 0.0);
 		} else {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(texHigh * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texHigh * sinCache[i] + 0.5,
 				texHigh * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusHigh * sinCache[i],
+		    quadVertex3f(qobj, radiusHigh * sinCache[i],
 			    radiusHigh * cosCache[i], 0.0);
 
 		    if (qobj->textureCoords) {
-			glTexCoord2f(texLow * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 				texLow * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusLow * sinCache[i],
+		    quadVertex3f(qobj, radiusLow * sinCache[i],
 			    radiusLow * cosCache[i], 0.0);
 		}
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	break;
       case GLU_POINT:
-	glBegin(GL_POINTS);
+	quadBegin(qobj, GL_POINTS);
 	for (i = 0; i < slices2; i++) {
 	    sintemp = sinCache[i];
 	    costemp = cosCache[i];
@@ -588,27 +971,28 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 		if (qobj->textureCoords) {
 		    texLow = radiusLow / outerRadius / 2;
 
-		    glTexCoord2f(texLow * sinCache[i] + 0.5,
+		    quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 			    texLow * cosCache[i] + 0.5);
 		}
-		glVertex3f(radiusLow * sintemp, radiusLow * costemp, 0.0);
+		quadVertex3f(qobj, radiusLow * sintemp,
+			radiusLow * costemp, 0.0);
 	    }
 	}
-	glEnd();
+	quadEnd(qobj);
 	break;
       case GLU_LINE:
 	if (innerRadius == outerRadius) {
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 
 	    for (i = 0; i <= slices; i++) {
 		if (qobj->textureCoords) {
-		    glTexCoord2f(sinCache[i] / 2 + 0.5,
+		    quadTexCoord2f(qobj, sinCache[i] / 2 + 0.5,
 			    cosCache[i] / 2 + 0.5);
 		}
-		glVertex3f(innerRadius * sinCache[i],
+		quadVertex3f(qobj, innerRadius * sinCache[i],
 			innerRadius * cosCache[i], 0.0);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	    break;
 	}
 	for (j = 0; j <= loops; j++) {
@@ -617,21 +1001,21 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 		texLow = radiusLow / outerRadius / 2;
 	    }
 
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		if (qobj->textureCoords) {
-		    glTexCoord2f(texLow * sinCache[i] + 0.5,
+		    quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 			    texLow * cosCache[i] + 0.5);
 		}
-		glVertex3f(radiusLow * sinCache[i],
+		quadVertex3f(qobj, radiusLow * sinCache[i],
 			radiusLow * cosCache[i], 0.0);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	for (i=0; i < slices2; i++) {
 	    sintemp = sinCache[i];
 	    costemp = cosCache[i];
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (j = 0; j <= loops; j++) {
 		radiusLow = outerRadius - deltaRadius * ((float) j / loops);
 		if (qobj->textureCoords) {
@@ -639,12 +1023,13 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 		}
 
 		if (qobj->textureCoords) {
-		    glTexCoord2f(texLow * sinCache[i] + 0.5,
+		    quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 			    texLow * cosCache[i] + 0.5);
 		}
-		glVertex3f(radiusLow * sintemp, radiusLow * costemp, 0.0);
+		quadVertex3f(qobj, radiusLow * sintemp,
+			radiusLow * costemp, 0.0);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	break;
       case GLU_SILHOUETTE:
@@ -652,18 +1037,19 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 	    for (i = 0; i <= slices; i+= slices) {
 		sintemp = sinCache[i];
 		costemp = cosCache[i];
-		glBegin(GL_LINE_STRIP);
+		quadBegin(qobj, GL_LINE_STRIP);
 		for (j = 0; j <= loops; j++) {
 		    radiusLow = outerRadius - deltaRadius * ((float) j / loops);
 
 		    if (qobj->textureCoords) {
 			texLow = radiusLow / outerRadius / 2;
-			glTexCoord2f(texLow * sinCache[i] + 0.5,
+			quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 				texLow * cosCache[i] + 0.5);
 		    }
-		    glVertex3f(radiusLow * sintemp, radiusLow * costemp, 0.0);
+		    quadVertex3f(qobj, radiusLow * sintemp,
+			radiusLow * costemp, 0.0);
 		}
-		glEnd();
+		quadEnd(qobj);
 	    }
 	}
 	for (j = 0; j <= loops; j += loops) {
@@ -672,16 +1058,16 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 		texLow = radiusLow / outerRadius / 2;
 	    }
 
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		if (qobj->textureCoords) {
-		    glTexCoord2f(texLow * sinCache[i] + 0.5,
+		    quadTexCoord2f(qobj, texLow * sinCache[i] + 0.5,
 			    texLow * cosCache[i] + 0.5);
 		}
-		glVertex3f(radiusLow * sinCache[i],
+		quadVertex3f(qobj, radiusLow * sinCache[i],
 			radiusLow * cosCache[i], 0.0);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	    if (innerRadius == outerRadius) break;
 	}
 	break;
@@ -692,6 +1078,19 @@ gluPartialDisk(GLUquadric *qobj, GLdouble innerRadius,
 
 void GLAPIENTRY
 gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
+{
+    ShapeKey key;
+
+    makeKey(qobj, &key, SHAPE_SPHERE, radius, 0.0, 0.0, 0.0, slices, stacks);
+    if (beginShape(qobj, &key)) return;
+    drawSphere(qobj, radius, slices, stacks);
+    if (!endShape(qobj)) {
+	drawSphere(qobj, radius, slices, stacks);
+    }
+}
+
+static void
+drawSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 {
     GLint i,j;
     GLfloat sinCache1a[CACHE_SIZE];
@@ -733,7 +1132,8 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 	if (qobj->drawStyle != GLU_POINT) {
 	    needCache3 = GL_TRUE;
 	}
-	if (qobj->drawStyle == GLU_LINE) {
+	/* as in drawCylinder, only filled spheres do without them */
+	if (qobj->drawStyle != GLU_FILL) {
 	    needCache2 = GL_TRUE;
 	}
     }
@@ -817,26 +1217,26 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 	      case GLU_SMOOTH:
 		sintemp3 = sinCache2b[1];
 		costemp3 = cosCache2b[1];
-		glNormal3f(sinCache2a[0] * sinCache2b[0],
+		quadNormal3f(qobj, sinCache2a[0] * sinCache2b[0],
 			cosCache2a[0] * sinCache2b[0],
 			cosCache2b[0]);
 		break;
 	      default:
 		break;
 	    }
-	    glBegin(GL_TRIANGLE_FAN);
-	    glVertex3f(0.0, 0.0, radius);
+	    quadBegin(qobj, GL_TRIANGLE_FAN);
+	    quadVertex3f(qobj, 0.0, 0.0, radius);
 	    if (qobj->orientation == GLU_OUTSIDE) {
 		for (i = slices; i >= 0; i--) {
 		    switch(qobj->normals) {
 		      case GLU_SMOOTH:
-			glNormal3f(sinCache2a[i] * sintemp3,
+			quadNormal3f(qobj, sinCache2a[i] * sintemp3,
 				cosCache2a[i] * sintemp3,
 				costemp3);
 			break;
 		      case GLU_FLAT:
 			if (i != slices) {
-			    glNormal3f(sinCache3a[i+1] * sintemp3,
+			    quadNormal3f(qobj, sinCache3a[i+1] * sintemp3,
 				    cosCache3a[i+1] * sintemp3,
 				    costemp3);
 			}
@@ -845,19 +1245,19 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		      default:
 			break;
 		    }
-		    glVertex3f(sintemp2 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp2 * sinCache1a[i],
 			    sintemp2 * cosCache1a[i], zHigh);
 		}
 	    } else {
 		for (i = 0; i <= slices; i++) {
 		    switch(qobj->normals) {
 		      case GLU_SMOOTH:
-			glNormal3f(sinCache2a[i] * sintemp3,
+			quadNormal3f(qobj, sinCache2a[i] * sintemp3,
 				cosCache2a[i] * sintemp3,
 				costemp3);
 			break;
 		      case GLU_FLAT:
-			glNormal3f(sinCache3a[i] * sintemp3,
+			quadNormal3f(qobj, sinCache3a[i] * sintemp3,
 				cosCache3a[i] * sintemp3,
 				costemp3);
 			break;
@@ -865,11 +1265,11 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		      default:
 			break;
 		    }
-		    glVertex3f(sintemp2 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp2 * sinCache1a[i],
 			    sintemp2 * cosCache1a[i], zHigh);
 		}
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 
 	    /* High end next (j == stacks-1 iteration) */
 	    sintemp2 = sinCache1b[stacks-1];
@@ -882,25 +1282,26 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 	      case GLU_SMOOTH:
 		sintemp3 = sinCache2b[stacks-1];
 		costemp3 = cosCache2b[stacks-1];
-		glNormal3f(sinCache2a[stacks] * sinCache2b[stacks],
-			cosCache2a[stacks] * sinCache2b[stacks],
+		/* sinCache2a is by slice; slice 0, as at the low end */
+		quadNormal3f(qobj, sinCache2a[0] * sinCache2b[stacks],
+			cosCache2a[0] * sinCache2b[stacks],
 			cosCache2b[stacks]);
 		break;
 	      default:
 		break;
 	    }
-	    glBegin(GL_TRIANGLE_FAN);
-	    glVertex3f(0.0, 0.0, -radius);
+	    quadBegin(qobj, GL_TRIANGLE_FAN);
+	    quadVertex3f(qobj, 0.0, 0.0, -radius);
 	    if (qobj->orientation == GLU_OUTSIDE) {
 		for (i = 0; i <= slices; i++) {
 		    switch(qobj->normals) {
 		      case GLU_SMOOTH:
-			glNormal3f(sinCache2a[i] * sintemp3,
+			quadNormal3f(qobj, sinCache2a[i] * sintemp3,
 				cosCache2a[i] * sintemp3,
 				costemp3);
 			break;
 		      case GLU_FLAT:
-			glNormal3f(sinCache3a[i] * sintemp3,
+			quadNormal3f(qobj, sinCache3a[i] * sintemp3,
 				cosCache3a[i] * sintemp3,
 				costemp3);
 			break;
@@ -908,20 +1309,20 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		      default:
 			break;
 		    }
-		    glVertex3f(sintemp2 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp2 * sinCache1a[i],
 			    sintemp2 * cosCache1a[i], zHigh);
 		}
 	    } else {
 		for (i = slices; i >= 0; i--) {
 		    switch(qobj->normals) {
 		      case GLU_SMOOTH:
-			glNormal3f(sinCache2a[i] * sintemp3,
+			quadNormal3f(qobj, sinCache2a[i] * sintemp3,
 				cosCache2a[i] * sintemp3,
 				costemp3);
 			break;
 		      case GLU_FLAT:
 			if (i != slices) {
-			    glNormal3f(sinCache3a[i+1] * sintemp3,
+			    quadNormal3f(qobj, sinCache3a[i+1] * sintemp3,
 				    cosCache3a[i+1] * sintemp3,
 				    costemp3);
 			}
@@ -930,11 +1331,11 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		      default:
 			break;
 		    }
-		    glVertex3f(sintemp2 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp2 * sinCache1a[i],
 			    sintemp2 * cosCache1a[i], zHigh);
 		}
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	} else {
 	    start = 0;
 	    finish = stacks;
@@ -966,11 +1367,11 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		break;
 	    }
 
-	    glBegin(GL_QUAD_STRIP);
+	    quadBegin(qobj, GL_QUAD_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		switch(qobj->normals) {
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2a[i] * sintemp3,
+		    quadNormal3f(qobj, sinCache2a[i] * sintemp3,
 			    cosCache2a[i] * sintemp3,
 			    costemp3);
 		    break;
@@ -981,27 +1382,27 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		}
 		if (qobj->orientation == GLU_OUTSIDE) {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				1 - (float) (j+1) / stacks);
 		    }
-		    glVertex3f(sintemp2 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp2 * sinCache1a[i],
 			    sintemp2 * cosCache1a[i], zHigh);
 		} else {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				1 - (float) j / stacks);
 		    }
-		    glVertex3f(sintemp1 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp1 * sinCache1a[i],
 			    sintemp1 * cosCache1a[i], zLow);
 		}
 		switch(qobj->normals) {
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2a[i] * sintemp4,
+		    quadNormal3f(qobj, sinCache2a[i] * sintemp4,
 			    cosCache2a[i] * sintemp4,
 			    costemp4);
 		    break;
 		  case GLU_FLAT:
-		    glNormal3f(sinCache3a[i] * sintemp4,
+		    quadNormal3f(qobj, sinCache3a[i] * sintemp4,
 			    cosCache3a[i] * sintemp4,
 			    costemp4);
 		    break;
@@ -1011,25 +1412,25 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		}
 		if (qobj->orientation == GLU_OUTSIDE) {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				1 - (float) j / stacks);
 		    }
-		    glVertex3f(sintemp1 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp1 * sinCache1a[i],
 			    sintemp1 * cosCache1a[i], zLow);
 		} else {
 		    if (qobj->textureCoords) {
-			glTexCoord2f(1 - (float) i / slices,
+			quadTexCoord2f(qobj, 1 - (float) i / slices,
 				1 - (float) (j+1) / stacks);
 		    }
-		    glVertex3f(sintemp2 * sinCache1a[i],
+		    quadVertex3f(qobj, sintemp2 * sinCache1a[i],
 			    sintemp2 * cosCache1a[i], zHigh);
 		}
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	break;
       case GLU_POINT:
-	glBegin(GL_POINTS);
+	quadBegin(qobj, GL_POINTS);
 	for (j = 0; j <= stacks; j++) {
 	    sintemp1 = sinCache1b[j];
 	    costemp1 = cosCache1b[j];
@@ -1046,7 +1447,7 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		switch(qobj->normals) {
 		  case GLU_FLAT:
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2a[i] * sintemp2,
+		    quadNormal3f(qobj, sinCache2a[i] * sintemp2,
 			    cosCache2a[i] * sintemp2,
 			    costemp2);
 		    break;
@@ -1058,14 +1459,14 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		zLow = j * radius / stacks;
 
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    1 - (float) j / stacks);
 		}
-		glVertex3f(sintemp1 * sinCache1a[i],
+		quadVertex3f(qobj, sintemp1 * sinCache1a[i],
 			sintemp1 * cosCache1a[i], costemp1);
 	    }
 	}
-	glEnd();
+	quadEnd(qobj);
 	break;
       case GLU_LINE:
       case GLU_SILHOUETTE:
@@ -1082,16 +1483,16 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		break;
 	    }
 
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (i = 0; i <= slices; i++) {
 		switch(qobj->normals) {
 		  case GLU_FLAT:
-		    glNormal3f(sinCache3a[i] * sintemp2,
+		    quadNormal3f(qobj, sinCache3a[i] * sintemp2,
 			    cosCache3a[i] * sintemp2,
 			    costemp2);
 		    break;
 		  case GLU_SMOOTH:
-		    glNormal3f(sinCache2a[i] * sintemp2,
+		    quadNormal3f(qobj, sinCache2a[i] * sintemp2,
 			    cosCache2a[i] * sintemp2,
 			    costemp2);
 		    break;
@@ -1100,13 +1501,13 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		    break;
 		}
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    1 - (float) j / stacks);
 		}
-		glVertex3f(sintemp1 * sinCache1a[i],
+		quadVertex3f(qobj, sintemp1 * sinCache1a[i],
 			sintemp1 * cosCache1a[i], costemp1);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	for (i = 0; i < slices; i++) {
 	    sintemp1 = sinCache1a[i];
@@ -1121,16 +1522,16 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		break;
 	    }
 
-	    glBegin(GL_LINE_STRIP);
+	    quadBegin(qobj, GL_LINE_STRIP);
 	    for (j = 0; j <= stacks; j++) {
 		switch(qobj->normals) {
 		  case GLU_FLAT:
-		    glNormal3f(sintemp2 * sinCache3b[j],
+		    quadNormal3f(qobj, sintemp2 * sinCache3b[j],
 			    costemp2 * sinCache3b[j],
 			    cosCache3b[j]);
 		    break;
 		  case GLU_SMOOTH:
-		    glNormal3f(sintemp2 * sinCache2b[j],
+		    quadNormal3f(qobj, sintemp2 * sinCache2b[j],
 			    costemp2 * sinCache2b[j],
 			    cosCache2b[j]);
 		    break;
@@ -1140,13 +1541,13 @@ gluSphere(GLUquadric *qobj, GLdouble radius, GLint slices, GLint stacks)
 		}
 
 		if (qobj->textureCoords) {
-		    glTexCoord2f(1 - (float) i / slices,
+		    quadTexCoord2f(qobj, 1 - (float) i / slices,
 			    1 - (float) j / stacks);
 		}
-		glVertex3f(sintemp1 * sinCache1b[j],
+		quadVertex3f(qobj, sintemp1 * sinCache1b[j],
 			costemp1 * sinCache1b[j], cosCache1b[j]);
 	    }
-	    glEnd();
+	    quadEnd(qobj);
 	}
 	break;
       default:
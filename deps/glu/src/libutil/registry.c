@@ -36,8 +36,14 @@
 
 static const GLubyte versionString[] = "1.3";
 static const GLubyte extensionString[] =
+    "GLU_EXT_nurbs_arena "
+    "GLU_EXT_nurbs_retained "
     "GLU_EXT_nurbs_tessellator "
+    "GLU_EXT_nurbs_threads "
     "GLU_EXT_object_space_tess "
+    "GLU_EXT_project_array "
+    "GLU_EXT_tess_indexed_triangles "
+    "GLU_EXT_tess_result_cache "
     ;
 
 const GLubyte * GLAPIENTRY
@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** What every test has: CHECK() counts and reports the conditions that do
+** not hold, naming the case in testName, and main() fails if failures is
+** not 0.  Each test is one translation unit, so the state is static.
+*/
+
+#ifndef __check_h__
+#define __check_h__
+
+#include <stdio.h>
+
+static int failures = 0;
+static char testName[160];
+
+#define CHECK(COND)							\
+    do {								\
+	if (!(COND)) {							\
+	    fprintf(stderr, "%s:%d: check failed: %s (%s)\n", __FILE__, \
+		    __LINE__, #COND, testName);				\
+	    failures++;							\
+	}								\
+    } while (0)
+
+#define COUNT(a) (sizeof(a)/sizeof((a)[0]))
+
+#endif /* __check_h__ */
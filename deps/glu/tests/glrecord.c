@@ -0,0 +1,604 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <GL/gl.h>
+#include "glrecord.h"
+
+GLRECORD_THREAD GLRecord glRecord;
+
+static const GLfloat identity[16] = {
+    1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1,
+};
+
+typedef struct {
+    GLint alignment;
+    GLint rowLength;
+    GLint skipRows;
+    GLint skipPixels;
+    GLint swapBytes;
+    GLint lsbFirst;
+    GLint skipImages;
+    GLint imageHeight;
+} PixelStore;
+
+/* GL state, and what glInterleavedArrays was given */
+static GLRECORD_THREAD PixelStore unpack = { 4 }, pack = { 4 };
+static GLRECORD_THREAD GLfloat currentNormal[3] = { 0, 0, 1 };
+static GLRECORD_THREAD GLfloat currentTexCoord[2];
+static GLRECORD_THREAD GLint primitiveOpen;
+
+static GLRECORD_THREAD GLenum arrayFormat;
+static GLRECORD_THREAD GLsizei arrayStride;
+static GLRECORD_THREAD const GLfloat *arrayPointer;
+
+/*
+** Which of the normal and texture coordinate arrays are enabled, and what
+** the last glPushClientAttrib saved of that; one level is enough for GLU.
+*/
+static GLRECORD_THREAD GLboolean normalArray, texCoordArray;
+static GLRECORD_THREAD GLboolean savedNormalArray, savedTexCoordArray;
+
+static GLRECORD_THREAD GLsizei proxyWidth, proxyHeight;
+
+static void *grow(void *array, int count, size_t size)
+{
+    /* capacity doubles at every power of 2 */
+    if (count == 0 || (count & (count - 1)) == 0) {
+	array = realloc(array, (count ? 2 * count : 16) * size);
+	if (array == NULL) {
+	    fprintf(stderr, "glrecord: out of memory\n");
+	    abort();
+	}
+    }
+    return array;
+}
+
+void glRecordReset(void)
+{
+    int i;
+
+    for (i = 0; i < glRecord.imageCount; i++) {
+	free(glRecord.images[i].pixels);
+    }
+    free(glRecord.images);
+    free(glRecord.primitives);
+    free(glRecord.vertices);
+    memset(&glRecord, 0, sizeof(glRecord));
+
+    memset(&unpack, 0, sizeof(unpack));
+    memset(&pack, 0, sizeof(pack));
+    unpack.alignment = 4;
+    pack.alignment = 4;
+    memset(currentNormal, 0, sizeof(currentNormal));
+    currentNormal[2] = 1;
+    memset(currentTexCoord, 0, sizeof(currentTexCoord));
+    primitiveOpen = 0;
+    arrayFormat = 0;
+    arrayStride = 0;
+    arrayPointer = NULL;
+    normalArray = texCoordArray = GL_FALSE;
+    savedNormalArray = savedTexCoordArray = GL_FALSE;
+}
+
+static GLint elementSize(GLenum type)
+{
+    switch (type) {
+      case GL_UNSIGNED_BYTE:
+      case GL_BYTE:
+      case GL_UNSIGNED_BYTE_3_3_2:
+      case GL_UNSIGNED_BYTE_2_3_3_REV:
+	return 1;
+      case GL_UNSIGNED_SHORT:
+      case GL_SHORT:
+      case GL_UNSIGNED_SHORT_5_6_5:
+      case GL_UNSIGNED_SHORT_5_6_5_REV:
+      case GL_UNSIGNED_SHORT_4_4_4_4:
+      case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+      case GL_UNSIGNED_SHORT_5_5_5_1:
+      case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+	return 2;
+      default:
+	return 4;
+    }
+}
+
+static GLboolean isPacked(GLenum type)
+{
+    switch (type) {
+      case GL_UNSIGNED_BYTE:
+      case GL_BYTE:
+      case GL_UNSIGNED_SHORT:
+      case GL_SHORT:
+      case GL_UNSIGNED_INT:
+      case GL_INT:
+      case GL_FLOAT:
+	return GL_FALSE;
+      default:
+	return GL_TRUE;
+    }
+}
+
+GLint glRecordGroupSize(GLenum format, GLenum type)
+{
+    GLint components;
+
+    if (isPacked(type)) return elementSize(type);
+    switch (format) {
+      case GL_LUMINANCE_ALPHA:
+	components = 2;
+	break;
+      case GL_RGB:
+      case GL_BGR:
+	components = 3;
+	break;
+      case GL_RGBA:
+      case GL_BGRA:
+	components = 4;
+	break;
+      default:
+	components = 1;
+	break;
+    }
+    return components * elementSize(type);
+}
+
+/*
+** Copies a texture image out of client memory the way GL unpacks it,
+** without row padding and with bytes in native order.
+*/
+static void recordImage(GLenum target, GLint level, GLint internalFormat,
+			GLsizei width, GLsizei height, GLsizei depth,
+			GLenum format, GLenum type, const GLvoid *pixels)
+{
+    GLRecordImage *image;
+    GLint groupSize = glRecordGroupSize(format, type);
+    GLint size = elementSize(type);
+    size_t rowSize, imageSize, lineSize;
+    const GLubyte *src;
+    GLubyte *dst;
+    GLint i, j, k;
+
+    glRecord.images = grow(glRecord.images, glRecord.imageCount,
+			   sizeof(GLRecordImage));
+    image = &glRecord.images[glRecord.imageCount++];
+    image->target = target;
+    image->level = level;
+    image->internalFormat = internalFormat;
+    image->width = width;
+    image->height = height;
+    image->depth = depth;
+    image->format = format;
+    image->type = type;
+    image->pixels = NULL;
+    image->size = 0;
+    if (pixels == NULL) return;
+
+    lineSize = (size_t) width * groupSize;
+    rowSize = (size_t) (unpack.rowLength > 0 ? unpack.rowLength : width) *
+	      groupSize;
+    rowSize = (rowSize + unpack.alignment - 1) / unpack.alignment *
+	      unpack.alignment;
+    imageSize = rowSize *
+		(unpack.imageHeight > 0 ? unpack.imageHeight : height);
+    src = (const GLubyte *) pixels + unpack.skipRows * rowSize +
+	  unpack.skipPixels * groupSize;
+    if (depth > 1 || target == GL_TEXTURE_3D) {
+	src += unpack.skipImages * imageSize;
+    }
+
+    image->size = lineSize * height * depth;
+    image->pixels = malloc(image->size ? image->size : 1);
+    if (image->pixels == NULL) {
+	fprintf(stderr, "glrecord: out of memory\n");
+	abort();
+    }
+    dst = image->pixels;
+    for (k = 0; k < depth; k++) {
+	for (j = 0; j < height; j++) {
+	    const GLubyte *row = src + k * imageSize + j * rowSize;
+
+	    if (unpack.swapBytes && size > 1) {
+		for (i = 0; i < (GLint) lineSize; i += size) {
+		    GLint b;
+
+		    for (b = 0; b < size; b++) {
+			dst[i + b] = row[i + size - 1 - b];
+		    }
+		}
+	    } else {
+		memcpy(dst, row, lineSize);
+	    }
+	    dst += lineSize;
+	}
+    }
+}
+
+static void addVertex(GLfloat x, GLfloat y, GLfloat z)
+{
+    GLRecordVertex *v;
+
+    glRecord.vertices = grow(glRecord.vertices, glRecord.vertexCount,
+			     sizeof(GLRecordVertex));
+    v = &glRecord.vertices[glRecord.vertexCount++];
+    v->position[0] = x;
+    v->position[1] = y;
+    v->position[2] = z;
+    memcpy(v->normal, currentNormal, sizeof(currentNormal));
+    memcpy(v->texcoord, currentTexCoord, sizeof(currentTexCoord));
+}
+
+static void beginPrimitive(GLenum mode)
+{
+    GLRecordPrimitive *p;
+
+    glRecord.primitives = grow(glRecord.primitives, glRecord.primitiveCount,
+			       sizeof(GLRecordPrimitive));
+    p = &glRecord.primitives[glRecord.primitiveCount++];
+    p->mode = mode;
+    p->first = glRecord.vertexCount;
+    p->count = 0;
+    primitiveOpen = 1;
+}
+
+static void endPrimitive(void)
+{
+    GLRecordPrimitive *p = &glRecord.primitives[glRecord.primitiveCount - 1];
+
+    p->count = glRecord.vertexCount - p->first;
+    primitiveOpen = 0;
+}
+
+/*
+** State queries.  The viewport is 1024x1024, both matrices are the
+** identity, and proxy textures fit unless they exceed maxTextureSize.
+*/
+GLAPI void GLAPIENTRY glGetIntegerv(GLenum pname, GLint *params)
+{
+    switch (pname) {
+      case GL_UNPACK_ALIGNMENT: params[0] = unpack.alignment; break;
+      case GL_UNPACK_ROW_LENGTH: params[0] = unpack.rowLength; break;
+      case GL_UNPACK_SKIP_ROWS: params[0] = unpack.skipRows; break;
+      case GL_UNPACK_SKIP_PIXELS: params[0] = unpack.skipPixels; break;
+      case GL_UNPACK_SWAP_BYTES: params[0] = unpack.swapBytes; break;
+      case GL_UNPACK_LSB_FIRST: params[0] = unpack.lsbFirst; break;
+      case GL_UNPACK_SKIP_IMAGES: params[0] = unpack.skipImages; break;
+      case GL_UNPACK_IMAGE_HEIGHT: params[0] = unpack.imageHeight; break;
+      case GL_PACK_ALIGNMENT: params[0] = pack.alignment; break;
+      case GL_PACK_ROW_LENGTH: params[0] = pack.rowLength; break;
+      case GL_PACK_SKIP_ROWS: params[0] = pack.skipRows; break;
+      case GL_PACK_SKIP_PIXELS: params[0] = pack.skipPixels; break;
+      case GL_PACK_SWAP_BYTES: params[0] = pack.swapBytes; break;
+      case GL_PACK_LSB_FIRST: params[0] = pack.lsbFirst; break;
+      case GL_PACK_SKIP_IMAGES: params[0] = pack.skipImages; break;
+      case GL_PACK_IMAGE_HEIGHT: params[0] = pack.imageHeight; break;
+      case GL_MAX_TEXTURE_SIZE:
+      case GL_MAX_3D_TEXTURE_SIZE:
+	params[0] = glRecord.maxTextureSize ? glRecord.maxTextureSize : 8192;
+	break;
+      case GL_VIEWPORT:
+	params[0] = 0;
+	params[1] = 0;
+	params[2] = 1024;
+	params[3] = 1024;
+	break;
+      case GL_POLYGON_MODE:
+	params[0] = GL_FILL;
+	params[1] = GL_FILL;
+	break;
+      default:
+	params[0] = 0;
+	break;
+    }
+}
+
+GLAPI void GLAPIENTRY glGetFloatv(GLenum pname, GLfloat *params)
+{
+    switch (pname) {
+      case GL_MODELVIEW_MATRIX:
+      case GL_PROJECTION_MATRIX:
+	memcpy(params, identity, sizeof(identity));
+	break;
+      default:
+	params[0] = 0;
+	break;
+    }
+}
+
+GLAPI void GLAPIENTRY glGetTexLevelParameteriv(GLenum target, GLint level,
+					       GLenum pname, GLint *params)
+{
+    (void) target;
+    (void) level;
+    (void) pname;
+    if (glRecord.maxTextureSize &&
+	(2 * proxyWidth > glRecord.maxTextureSize ||
+	 2 * proxyHeight > glRecord.maxTextureSize)) {
+	params[0] = 0;
+    } else {
+	params[0] = proxyWidth;
+    }
+}
+
+GLAPI const GLubyte * GLAPIENTRY glGetString(GLenum name)
+{
+    return (const GLubyte *) (name == GL_VERSION ? "1.4 glu-test" : "");
+}
+
+GLAPI GLboolean GLAPIENTRY glIsEnabled(GLenum cap)
+{
+    (void) cap;
+    return GL_FALSE;
+}
+
+/* State changes */
+GLAPI void GLAPIENTRY glEnable(GLenum cap) { (void) cap; }
+GLAPI void GLAPIENTRY glDisable(GLenum cap) { (void) cap; }
+GLAPI void GLAPIENTRY glPushAttrib(GLbitfield mask) { (void) mask; }
+GLAPI void GLAPIENTRY glPopAttrib(void) { }
+GLAPI void GLAPIENTRY glPushClientAttrib(GLbitfield mask)
+{
+    (void) mask;
+    savedNormalArray = normalArray;
+    savedTexCoordArray = texCoordArray;
+}
+GLAPI void GLAPIENTRY glPopClientAttrib(void)
+{
+    normalArray = savedNormalArray;
+    texCoordArray = savedTexCoordArray;
+}
+GLAPI void GLAPIENTRY glDisableClientState(GLenum cap)
+{
+    if (cap == GL_NORMAL_ARRAY) normalArray = GL_FALSE;
+    if (cap == GL_TEXTURE_COORD_ARRAY) texCoordArray = GL_FALSE;
+}
+GLAPI void GLAPIENTRY glPolygonMode(GLenum face, GLenum mode)
+{
+    (void) face;
+    (void) mode;
+}
+
+GLAPI void GLAPIENTRY glPixelStorei(GLenum pname, GLint param)
+{
+    switch (pname) {
+      case GL_UNPACK_ALIGNMENT: unpack.alignment = param; break;
+      case GL_UNPACK_ROW_LENGTH: unpack.rowLength = param; break;
+      case GL_UNPACK_SKIP_ROWS: unpack.skipRows = param; break;
+      case GL_UNPACK_SKIP_PIXELS: unpack.skipPixels = param; break;
+      case GL_UNPACK_SWAP_BYTES: unpack.swapBytes = param; break;
+      case GL_UNPACK_LSB_FIRST: unpack.lsbFirst = param; break;
+      case GL_UNPACK_SKIP_IMAGES: unpack.skipImages = param; break;
+      case GL_UNPACK_IMAGE_HEIGHT: unpack.imageHeight = param; break;
+      case GL_PACK_ALIGNMENT: pack.alignment = param; break;
+      case GL_PACK_ROW_LENGTH: pack.rowLength = param; break;
+      case GL_PACK_SKIP_ROWS: pack.skipRows = param; break;
+      case GL_PACK_SKIP_PIXELS: pack.skipPixels = param; break;
+      case GL_PACK_SWAP_BYTES: pack.swapBytes = param; break;
+      case GL_PACK_LSB_FIRST: pack.lsbFirst = param; break;
+      case GL_PACK_SKIP_IMAGES: pack.skipImages = param; break;
+      case GL_PACK_IMAGE_HEIGHT: pack.imageHeight = param; break;
+    }
+}
+
+/* Matrices */
+GLAPI void GLAPIENTRY glOrtho(GLdouble left, GLdouble right,
+			      GLdouble bottom, GLdouble top,
+			      GLdouble near_val, GLdouble far_val)
+{
+    (void) left; (void) right; (void) bottom;
+    (void) top; (void) near_val; (void) far_val;
+}
+GLAPI void GLAPIENTRY glMultMatrixd(const GLdouble *m) { (void) m; }
+GLAPI void GLAPIENTRY glMultMatrixf(const GLfloat *m) { (void) m; }
+GLAPI void GLAPIENTRY glTranslated(GLdouble x, GLdouble y, GLdouble z)
+{
+    (void) x; (void) y; (void) z;
+}
+GLAPI void GLAPIENTRY glTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{
+    (void) x; (void) y; (void) z;
+}
+GLAPI void GLAPIENTRY glScalef(GLfloat x, GLfloat y, GLfloat z)
+{
+    (void) x; (void) y; (void) z;
+}
+
+/* Immediate mode */
+GLAPI void GLAPIENTRY glBegin(GLenum mode) { beginPrimitive(mode); }
+GLAPI void GLAPIENTRY glEnd(void) { if (primitiveOpen) endPrimitive(); }
+GLAPI void GLAPIENTRY glVertex2f(GLfloat x, GLfloat y) { addVertex(x, y, 0); }
+GLAPI void GLAPIENTRY glVertex2fv(const GLfloat *v) { addVertex(v[0], v[1], 0); }
+GLAPI void GLAPIENTRY glVertex3f(GLfloat x, GLfloat y, GLfloat z)
+{
+    addVertex(x, y, z);
+}
+GLAPI void GLAPIENTRY glVertex3fv(const GLfloat *v)
+{
+    addVertex(v[0], v[1], v[2]);
+}
+GLAPI void GLAPIENTRY glNormal3f(GLfloat nx, GLfloat ny, GLfloat nz)
+{
+    currentNormal[0] = nx;
+    currentNormal[1] = ny;
+    currentNormal[2] = nz;
+}
+GLAPI void GLAPIENTRY glNormal3fv(const GLfloat *v)
+{
+    memcpy(currentNormal, v, sizeof(currentNormal));
+}
+GLAPI void GLAPIENTRY glTexCoord2f(GLfloat s, GLfloat t)
+{
+    currentTexCoord[0] = s;
+    currentTexCoord[1] = t;
+}
+GLAPI void GLAPIENTRY glTexCoord2fv(const GLfloat *v)
+{
+    memcpy(currentTexCoord, v, sizeof(currentTexCoord));
+}
+GLAPI void GLAPIENTRY glColor3f(GLfloat red, GLfloat green, GLfloat blue)
+{
+    (void) red; (void) green; (void) blue;
+}
+
+/*
+** Vertex arrays.  Only the formats libGLU uses are unpacked: T2F_N3F_V3F,
+** N3F_V3F and V3F.  Normals and texture coordinates are taken only from
+** the arrays that are enabled, and the current values of those are NaN
+** after glDrawArrays, since GL leaves them undefined.
+*/
+GLAPI void GLAPIENTRY glInterleavedArrays(GLenum format, GLsizei stride,
+					  const GLvoid *pointer)
+{
+    arrayFormat = format;
+    arrayStride = stride;
+    arrayPointer = (const GLfloat *) pointer;
+    normalArray = format == GL_T2F_N3F_V3F || format == GL_N3F_V3F;
+    texCoordArray = format == GL_T2F_N3F_V3F;
+}
+
+GLAPI void GLAPIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    GLint floats, i;
+
+    switch (arrayFormat) {
+      case GL_T2F_N3F_V3F: floats = 8; break;
+      case GL_N3F_V3F: floats = 6; break;
+      case GL_V3F: floats = 3; break;
+      default:
+	fprintf(stderr, "glrecord: unsupported array format 0x%x\n",
+		arrayFormat);
+	abort();
+    }
+    if (arrayStride != 0) floats = arrayStride / sizeof(GLfloat);
+
+    glRecord.drawArraysCalls++;
+    beginPrimitive(mode);
+    for (i = first; i < first + count; i++) {
+	const GLfloat *v = arrayPointer + (size_t) i * floats;
+
+	switch (arrayFormat) {
+	  case GL_T2F_N3F_V3F:
+	    if (texCoordArray) glTexCoord2fv(v);
+	    if (normalArray) glNormal3fv(v + 2);
+	    addVertex(v[5], v[6], v[7]);
+	    break;
+	  case GL_N3F_V3F:
+	    if (normalArray) glNormal3fv(v);
+	    addVertex(v[3], v[4], v[5]);
+	    break;
+	  default:
+	    addVertex(v[0], v[1], v[2]);
+	    break;
+	}
+    }
+    endPrimitive();
+    if (normalArray) {
+	currentNormal[0] = currentNormal[1] = currentNormal[2] = NAN;
+    }
+    if (texCoordArray) {
+	currentTexCoord[0] = currentTexCoord[1] = NAN;
+    }
+}
+
+/* Evaluators.  The tests use libGLU's own evaluation, so these are unused. */
+GLAPI void GLAPIENTRY glMap1f(GLenum target, GLfloat u1, GLfloat u2,
+			      GLint stride, GLint order,
+			      const GLfloat *points)
+{
+    (void) target; (void) u1; (void) u2;
+    (void) stride; (void) order; (void) points;
+}
+GLAPI void GLAPIENTRY glMap2f(GLenum target, GLfloat u1, GLfloat u2,
+			      GLint ustride, GLint uorder,
+			      GLfloat v1, GLfloat v2,
+			      GLint vstride, GLint vorder,
+			      const GLfloat *points)
+{
+    (void) target; (void) u1; (void) u2; (void) ustride; (void) uorder;
+    (void) v1; (void) v2; (void) vstride; (void) vorder; (void) points;
+}
+GLAPI void GLAPIENTRY glMapGrid1f(GLint un, GLfloat u1, GLfloat u2)
+{
+    (void) un; (void) u1; (void) u2;
+}
+GLAPI void GLAPIENTRY glMapGrid2d(GLint un, GLdouble u1, GLdouble u2,
+				  GLint vn, GLdouble v1, GLdouble v2)
+{
+    (void) un; (void) u1; (void) u2; (void) vn; (void) v1; (void) v2;
+}
+GLAPI void GLAPIENTRY glMapGrid2f(GLint un, GLfloat u1, GLfloat u2,
+				  GLint vn, GLfloat v1, GLfloat v2)
+{
+    (void) un; (void) u1; (void) u2; (void) vn; (void) v1; (void) v2;
+}
+GLAPI void GLAPIENTRY glEvalCoord1f(GLfloat u) { (void) u; }
+GLAPI void GLAPIENTRY glEvalCoord2f(GLfloat u, GLfloat v)
+{
+    (void) u; (void) v;
+}
+GLAPI void GLAPIENTRY glEvalPoint1(GLint i) { (void) i; }
+GLAPI void GLAPIENTRY glEvalPoint2(GLint i, GLint j) { (void) i; (void) j; }
+GLAPI void GLAPIENTRY glEvalMesh1(GLenum mode, GLint i1, GLint i2)
+{
+    (void) mode; (void) i1; (void) i2;
+}
+GLAPI void GLAPIENTRY glEvalMesh2(GLenum mode, GLint i1, GLint i2,
+				  GLint j1, GLint j2)
+{
+    (void) mode; (void) i1; (void) i2; (void) j1; (void) j2;
+}
+
+/* Textures.  Proxy targets only remember the size asked about. */
+GLAPI void GLAPIENTRY glTexImage1D(GLenum target, GLint level,
+				   GLint internalFormat, GLsizei width,
+				   GLint border, GLenum format, GLenum type,
+				   const GLvoid *pixels)
+{
+    (void) border;
+    if (target == GL_PROXY_TEXTURE_1D) {
+	proxyWidth = width;
+	proxyHeight = 1;
+	return;
+    }
+    recordImage(target, level, internalFormat, width, 1, 1, format, type,
+		pixels);
+}
+
+GLAPI void GLAPIENTRY glTexImage2D(GLenum target, GLint level,
+				   GLint internalFormat,
+				   GLsizei width, GLsizei height,
+				   GLint border, GLenum format, GLenum type,
+				   const GLvoid *pixels)
+{
+    (void) border;
+    if (target == GL_PROXY_TEXTURE_2D ||
+	target == GL_PROXY_TEXTURE_CUBE_MAP) {
+	proxyWidth = width;
+	proxyHeight = height;
+	return;
+    }
+    recordImage(target, level, internalFormat, width, height, 1, format,
+		type, pixels);
+}
+
+GLAPI void GLAPIENTRY glTexImage3D(GLenum target, GLint level,
+				   GLint internalFormat,
+				   GLsizei width, GLsizei height,
+				   GLsizei depth, GLint border,
+				   GLenum format, GLenum type,
+				   const GLvoid *pixels)
+{
+    (void) border;
+    if (target == GL_PROXY_TEXTURE_3D) {
+	proxyWidth = width;
+	proxyHeight = height > depth ? height : depth;
+	return;
+    }
+    recordImage(target, level, internalFormat, width, height, depth, format,
+		type, pixels);
+}
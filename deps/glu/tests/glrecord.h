@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** A stand-in for the GL entry points libGLU calls, for the tests.
+** Unlike the glu-bench stub it keeps what it is given: pixel storage
+** state, a tightly packed copy of every texture image, and the
+** primitives and vertices drawn in immediate mode or from interleaved
+** vertex arrays.  Everything else is accepted and ignored.
+*/
+
+#ifndef __glrecord_h__
+#define __glrecord_h__
+
+#include <stddef.h>
+#include <GL/gl.h>
+
+typedef struct {
+    GLenum target;
+    GLint level;
+    GLint internalFormat;
+    GLsizei width, height, depth;
+    GLenum format, type;
+    GLubyte *pixels;		/* without row padding, NULL if none given */
+    size_t size;		/* bytes in pixels */
+} GLRecordImage;
+
+typedef struct {
+    GLfloat position[3];
+    GLfloat normal[3];		/* current normal */
+    GLfloat texcoord[2];	/* current texture coordinates */
+} GLRecordVertex;
+
+typedef struct {
+    GLenum mode;
+    GLint first;		/* index into glRecord.vertices */
+    GLint count;
+} GLRecordPrimitive;
+
+typedef struct {
+    GLRecordImage *images;
+    int imageCount;
+    GLRecordPrimitive *primitives;
+    int primitiveCount;
+    GLRecordVertex *vertices;
+    int vertexCount;
+    GLint drawArraysCalls;
+
+    /*
+    ** Proxy textures with a side bigger than this don't fit, so the
+    ** mipmap builders shrink images to fit.  0 means no limit.
+    */
+    GLint maxTextureSize;
+} GLRecord;
+
+/*
+** GL state belongs to the context current on a thread, so everything is
+** kept per thread, and builds on several threads are recorded apart.
+*/
+#ifdef _WIN32
+#define GLRECORD_THREAD __declspec(thread)
+#else
+#define GLRECORD_THREAD __thread
+#endif
+
+extern GLRECORD_THREAD GLRecord glRecord;
+
+/* Forgets everything recorded, and puts GL state back at its defaults. */
+extern void glRecordReset(void);
+
+/* Bytes per group of a format and type, for unpacking texture images. */
+extern GLint glRecordGroupSize(GLenum format, GLenum type);
+
+#endif /* __glrecord_h__ */
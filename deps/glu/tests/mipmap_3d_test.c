@@ -0,0 +1,230 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** 3D mipmaps of GLubyte, GLushort and GLfloat images are halved with
+** typed loops instead of extract and shove calls.  The levels must be
+** bit-identical to those of the scalar build for every component count,
+** for boxes and for the slices left once a side is down to 1, with skips,
+** and with swapped bytes, which the typed loops pass on.  The other types
+** are checked as well, since they share the code that picks the loops.
+** Swapped floats are left out: extractFloat() converts the swapped bits
+** as an integer, so the values it reads fail the asserts in mipmap.c.
+**
+** The scalar halveImage3D() misreads user images whose rows are padded
+** or longer than the image, the assert at its end fails for images with
+** an image height, and the builder uploads the levels it computes under
+** the caller's unpack alignment, so those comparisons use images with an
+** alignment of 1 and no image height.  For padded images, level 1 is
+** checked against a 2x2x2 box filter computed here instead: truncated
+** like shoveUbyte() and shoveUshort() do for integers, and within a
+** unit for floats.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+#include "mipmapcheck.h"
+#include "check.h"
+
+static const GLenum types[] = {
+    GL_UNSIGNED_BYTE, GL_BYTE, GL_UNSIGNED_SHORT, GL_SHORT,
+    GL_UNSIGNED_INT, GL_INT, GL_FLOAT,
+};
+
+/* The types the typed loops handle */
+static const GLenum directTypes[] = {
+    GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_FLOAT,
+};
+
+static const GLenum formats[] = {
+    GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA,
+};
+
+static const GLsizei sizes[][3] = {
+    { 16, 16, 16 }, { 64, 4, 2 }, { 2, 8, 32 }, { 1, 8, 4 }, { 8, 1, 4 },
+    { 8, 4, 1 }, { 1, 1, 16 }, { 32, 1, 1 }, { 2, 2, 2 },
+};
+
+/*
+** Boxes only, with levels 1 rows that need no padding at an alignment of
+** 8, so that they are uploaded as computed.
+*/
+static const GLsizei paddedSizes[][3] = {
+    { 16, 16, 16 }, { 64, 4, 2 }, { 32, 2, 8 },
+};
+
+/* Pixel storage modes the user's image is read with */
+typedef struct {
+    const char *name;
+    GLint alignment;
+    GLint rowPadding;		/* row length - width, when not 0 */
+    GLint skipRows;
+    GLint skipPixels;
+    GLint imagePadding;		/* image height - height, when not 0 */
+    GLint skipImages;
+    GLint swapBytes;
+} StoreModes;
+
+static const StoreModes storeModes[] = {
+    { "alignment 1", 1, 0, 0, 0, 0, 0, 0 },
+    { "skips", 1, 0, 1, 2, 0, 2, 0 },
+    { "swapped bytes", 1, 0, 0, 0, 0, 0, 1 },
+};
+
+static const StoreModes paddedModes[] = {
+    { "defaults", 4, 0, 0, 0, 0, 0, 0 },
+    { "alignment 8", 8, 0, 0, 0, 0, 0, 0 },
+    { "row length and skips", 2, 3, 2, 1, 0, 0, 0 },
+    { "row length and image height", 4, 1, 0, 0, 2, 1, 0 },
+};
+
+static void *newImage(const StoreModes *modes, GLenum format, GLenum type,
+		      const GLsizei *size3, unsigned *seed)
+{
+    GLsizei width = size3[0], height = size3[1], depth = size3[2];
+    size_t size;
+    void *data;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, modes->alignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH,
+		  modes->rowPadding ? width + modes->rowPadding : 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, modes->skipRows);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, modes->skipPixels);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT,
+		  modes->imagePadding ? height + modes->imagePadding : 0);
+    glPixelStorei(GL_UNPACK_SKIP_IMAGES, modes->skipImages);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, modes->swapBytes);
+
+    size = imageBytes(width, height, depth, format, type, GL_FALSE);
+    data = malloc(size);
+    if (data != NULL) randomImage(data, size, type, seed);
+    snprintf(testName, sizeof(testName),
+	     "%s, format 0x%x, type 0x%x, %dx%dx%d", modes->name, format,
+	     type, width, height, depth);
+    return data;
+}
+
+static void testScalar(const StoreModes *modes, GLenum format, GLenum type,
+		       const GLsizei *size3, unsigned *seed)
+{
+    void *data = newImage(modes, format, type, size3, seed);
+
+    CHECK(data != NULL);
+    if (data == NULL) return;
+    CHECK(checkBuild3D(format, size3[0], size3[1], size3[2], format, type,
+		       data) == 0);
+    free(data);
+}
+
+/*
+** Largest difference between level 1 and the box filter of the user's
+** image, read with modes.
+*/
+static double boxDifference(const StoreModes *modes, const GLRecordImage *level1,
+			    GLenum format, GLenum type, const GLsizei *size3,
+			    const void *data)
+{
+    GLint group = glRecordGroupSize(format, type);
+    GLint element = glRecordGroupSize(GL_LUMINANCE, type);
+    GLint components = group / element;
+    GLsizei width = size3[0], height = size3[1];
+    size_t rowSize = (size_t) (width + modes->rowPadding) * group;
+    size_t imageSize, first;
+    double worst = 0;
+    GLint i, j, k, c, b;
+
+    rowSize = (rowSize + modes->alignment - 1) / modes->alignment *
+	      modes->alignment;
+    imageSize = rowSize * (height + modes->imagePadding);
+    first = modes->skipImages * imageSize + modes->skipRows * rowSize +
+	    modes->skipPixels * group;
+    for (k = 0; k < level1->depth; k++) {
+	for (j = 0; j < level1->height; j++) {
+	    for (i = 0; i < level1->width; i++) {
+		for (c = 0; c < components; c++) {
+		    size_t out = (((size_t) k * level1->height + j) *
+				  level1->width + i) * components + c;
+		    double sum = 0, d;
+
+		    for (b = 0; b < 8; b++) {
+			size_t in = first +
+				    (2 * k + (b >> 2)) * imageSize +
+				    (2 * j + ((b >> 1) & 1)) * rowSize +
+				    (2 * i + (b & 1)) * group;
+
+			sum += elementValue((const GLubyte *) data + in, c,
+					    type);
+		    }
+		    sum /= 8;
+		    if (type != GL_FLOAT) sum = floor(sum);
+		    d = fabs(elementValue(level1->pixels, out, type) - sum) /
+			elementUnit(type);
+		    if (d > worst) worst = d;
+		}
+	    }
+	}
+    }
+    return worst;
+}
+
+static void testPadded(const StoreModes *modes, GLenum format, GLenum type,
+		       const GLsizei *size3, unsigned *seed)
+{
+    void *data = newImage(modes, format, type, size3, seed);
+    MipmapLevels levels;
+    GLint status;
+    double d = -1;
+
+    CHECK(data != NULL);
+    if (data == NULL) return;
+    status = gluBuild3DMipmaps(GL_TEXTURE_3D, format, size3[0], size3[1],
+			       size3[2], format, type, data);
+    takeLevels(&levels);
+    if (status == 0 && levels.count > 1) {
+	d = boxDifference(modes, &levels.images[1], format, type, size3,
+			  data);
+    }
+    CHECK(d >= 0 && d < (type == GL_FLOAT ? 1.5 : 0.5));
+    freeLevels(&levels);
+    free(data);
+}
+
+int main(void)
+{
+    unsigned seed = 6;
+    size_t m, f, t, s;
+
+    glRecordReset();
+    for (m = 0; m < COUNT(storeModes); m++) {
+	for (f = 0; f < COUNT(formats); f++) {
+	    for (t = 0; t < COUNT(types); t++) {
+		for (s = 0; s < COUNT(sizes); s++) {
+		    if (storeModes[m].swapBytes && types[t] == GL_FLOAT) {
+			continue;
+		    }
+		    testScalar(&storeModes[m], formats[f], types[t], sizes[s],
+			       &seed);
+		}
+	    }
+	}
+    }
+    for (m = 0; m < COUNT(paddedModes); m++) {
+	for (f = 0; f < COUNT(formats); f++) {
+	    for (t = 0; t < COUNT(directTypes); t++) {
+		for (s = 0; s < COUNT(paddedSizes); s++) {
+		    testPadded(&paddedModes[m], formats[f], directTypes[t],
+			       paddedSizes[s], &seed);
+		}
+	    }
+	}
+    }
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** 2D mipmaps of power of two images must be bit-identical to those of the
+** scalar build, for every component type and group size the SIMD row
+** kernels handle or pass on, under various pixel storage modes.  Widths
+** go from 1 to 512 so that both kernel loops and scalar tails are used.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+#include "mipmapcheck.h"
+#include "check.h"
+
+static const GLenum types[] = {
+    GL_UNSIGNED_BYTE, GL_BYTE, GL_UNSIGNED_SHORT, GL_SHORT,
+    GL_UNSIGNED_INT, GL_INT, GL_FLOAT,
+};
+
+static const GLenum formats[] = {
+    GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA,
+};
+
+static const GLsizei sizes[][2] = {
+    { 64, 64 }, { 512, 4 }, { 4, 512 }, { 32, 1 }, { 1, 32 }, { 2, 2 },
+    { 128, 16 }, { 8, 2 },
+};
+
+/* Pixel storage modes the user's image is read with */
+typedef struct {
+    const char *name;
+    GLint alignment;
+    GLint rowPadding;		/* row length - width, when not 0 */
+    GLint skipRows;
+    GLint skipPixels;
+    GLint swapBytes;
+} StoreModes;
+
+static const StoreModes storeModes[] = {
+    { "defaults", 4, 0, 0, 0, 0 },
+    { "alignment 1", 1, 0, 0, 0, 0 },
+    { "alignment 8", 8, 0, 0, 0, 0 },
+    { "row length and skips", 2, 3, 2, 1, 0 },
+    { "swapped bytes", 4, 0, 0, 0, 1 },
+};
+
+static void testImage(const StoreModes *modes, GLenum format, GLenum type,
+		      GLsizei width, GLsizei height, unsigned *seed)
+{
+    size_t size;
+    void *data;
+    double d;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, modes->alignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH,
+		  modes->rowPadding ? width + modes->rowPadding : 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, modes->skipRows);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, modes->skipPixels);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, modes->swapBytes);
+
+    size = imageBytes(width, height, 1, format, type, GL_FALSE);
+    data = malloc(size);
+    if (data == NULL) {
+	CHECK(!"out of memory");
+	return;
+    }
+    randomImage(data, size, type, seed);
+    snprintf(testName, sizeof(testName), "%s, format 0x%x, type 0x%x, %dx%d",
+	     modes->name, format, type, width, height);
+    d = checkBuild2D(format, width, height, format, type, data);
+    CHECK(d == 0);
+    free(data);
+}
+
+int main(void)
+{
+    unsigned seed = 1;
+    size_t m, f, t, s;
+
+    glRecordReset();
+    for (m = 0; m < COUNT(storeModes); m++) {
+	for (f = 0; f < COUNT(formats); f++) {
+	    for (t = 0; t < COUNT(types); t++) {
+		for (s = 0; s < COUNT(sizes); s++) {
+		    testImage(&storeModes[m], formats[f], types[t],
+			      sizes[s][0], sizes[s][1], &seed);
+		}
+	    }
+	}
+    }
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** GL_UNSIGNED_SHORT_5_6_5, 4_4_4_4, 5_5_5_1 and GL_UNSIGNED_INT_8_8_8_8_REV
+** are halved and rescaled in the integer domain, the other packed types
+** through extract*() and shove*().  Every packed type, with each format it
+** is legal with, must stay within one step of every field of the scalar
+** build: for power of two images, for images that are scaled to fit
+** first, and with gluScaleImage, with and without swapped bytes.  The
+** scaled images shrink vertically by less than 3 times, which is where the
+** scalar loops are a valid reference; see mipmap_scale_test.c.
+**
+** Ties may round either way, and a level that is one step off changes
+** the levels below it, so each level is compared with the scalar build
+** halving the level uploaded before it, not with the scalar chain.  The
+** one exception is the level halved from the caller's own image: the
+** builders read swapped bytes the way a big endian host would, which is
+** not how GL unpacks the level 0 it is given, so that level is compared
+** with the scalar chain.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+#include "mipmapcheck.h"
+#include "check.h"
+
+static const struct {
+    GLenum type;
+    GLenum formats[2];
+} packedTypes[] = {
+    { GL_UNSIGNED_BYTE_3_3_2, { GL_RGB, 0 } },
+    { GL_UNSIGNED_BYTE_2_3_3_REV, { GL_RGB, 0 } },
+    { GL_UNSIGNED_SHORT_5_6_5, { GL_RGB, 0 } },
+    { GL_UNSIGNED_SHORT_5_6_5_REV, { GL_RGB, 0 } },
+    { GL_UNSIGNED_SHORT_4_4_4_4, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_SHORT_4_4_4_4_REV, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_SHORT_5_5_5_1, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_SHORT_1_5_5_5_REV, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_INT_8_8_8_8, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_INT_8_8_8_8_REV, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_INT_10_10_10_2, { GL_RGBA, GL_BGRA } },
+    { GL_UNSIGNED_INT_2_10_10_10_REV, { GL_RGBA, GL_BGRA } },
+};
+
+/* Images that are only halved */
+static const GLsizei potSizes[][2] = {
+    { 64, 64 }, { 32, 8 }, { 2, 128 }, { 1, 16 }, { 16, 1 }, { 2, 2 },
+};
+
+/* Images that are scaled to a power of two first */
+static const GLsizei npotSizes[][2] = {
+    { 90, 45 }, { 45, 90 }, { 100, 90 }, { 5, 9 }, { 23, 180 }, { 37, 1 },
+};
+
+static const GLsizei scaleSizes[][4] = {
+    { 37, 23, 64, 64 }, { 64, 64, 17, 9 }, { 100, 7, 13, 50 },
+    { 5, 5, 3, 3 }, { 3, 2, 300, 5 },
+};
+
+static void *newImage(GLsizei width, GLsizei height, GLenum format,
+		      GLenum type, unsigned *seed)
+{
+    size_t size = imageBytes(width, height, 1, format, type, GL_FALSE);
+    void *data = malloc(size);
+
+    if (data != NULL) randomImage(data, size, type, seed);
+    return data;
+}
+
+/*
+** Largest difference between next and the scalar build halving prev,
+** which it was halved from.
+*/
+static double stepDifference(const GLRecordImage *prev,
+			     const GLRecordImage *next)
+{
+    MipmapLevels step, ours = { (GLRecordImage *) next, 1 };
+    GLint alignment, swap, status;
+    double d = -1;
+
+    /* levels are recorded tightly packed, in native byte order */
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glGetIntegerv(GL_UNPACK_SWAP_BYTES, &swap);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_FALSE);
+    status = scalarBuild2DMipmapLevels(GL_TEXTURE_2D, prev->format,
+				       prev->width, prev->height,
+				       prev->format, prev->type, prev->level,
+				       prev->level, prev->level + 1,
+				       prev->pixels);
+    takeLevels(&step);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, swap);
+    if (status == 0 && step.count == 2) {
+	MipmapLevels halved = { &step.images[1], 1 };
+
+	d = compareLevels(&ours, &halved);
+    }
+    freeLevels(&step);
+    return d;
+}
+
+/*
+** Largest difference of a build from the scalar build at level 0, and at
+** level 1 if level 0 is the caller's image, and from the scalar halving
+** of its own level above at the others.
+*/
+static double buildDifference(GLenum format, GLenum type, GLsizei width,
+			      GLsizei height, const void *data)
+{
+    MipmapLevels levels, scalar;
+    GLint status, scalarStatus;
+    double d = -1, e;
+    int i;
+
+    status = gluBuild2DMipmaps(GL_TEXTURE_2D, format, width, height, format,
+			       type, data);
+    takeLevels(&levels);
+    scalarStatus = scalarBuild2DMipmaps(GL_TEXTURE_2D, format, width,
+					height, format, type, data);
+    takeLevels(&scalar);
+    if (status == 0 && scalarStatus == 0 && levels.count > 0 &&
+	levels.count == scalar.count) {
+	GLboolean scaled = levels.images[0].width != width ||
+			   levels.images[0].height != height;
+
+	for (i = 0, d = 0; i < levels.count && d >= 0; i++) {
+	    if (i == 0 || (i == 1 && !scaled)) {
+		MipmapLevels ours = { &levels.images[i], 1 };
+		MipmapLevels first = { &scalar.images[i], 1 };
+
+		e = compareLevels(&ours, &first);
+	    } else {
+		e = stepDifference(&levels.images[i - 1], &levels.images[i]);
+	    }
+	    d = e < 0 ? -1 : e > d ? e : d;
+	}
+    }
+    freeLevels(&levels);
+    freeLevels(&scalar);
+    return d;
+}
+
+static void testType(GLenum format, GLenum type, GLboolean swap,
+		     unsigned *seed)
+{
+    size_t s;
+
+    for (s = 0; s < COUNT(potSizes) + COUNT(npotSizes); s++) {
+	const GLsizei *z = s < COUNT(potSizes) ? potSizes[s] :
+			   npotSizes[s - COUNT(potSizes)];
+	void *data = newImage(z[0], z[1], format, type, seed);
+	double d;
+
+	snprintf(testName, sizeof(testName),
+		 "gluBuild2DMipmaps, format 0x%x, type 0x%x, %dx%d%s",
+		 format, type, z[0], z[1], swap ? ", swapped" : "");
+	d = data ? buildDifference(format, type, z[0], z[1], data) : -1;
+	CHECK(d >= 0 && d < 1.5);
+	free(data);
+    }
+    for (s = 0; s < COUNT(scaleSizes); s++) {
+	const GLsizei *z = scaleSizes[s];
+	void *data = newImage(z[0], z[1], format, type, seed);
+	double d;
+
+	snprintf(testName, sizeof(testName),
+		 "gluScaleImage, format 0x%x, type 0x%x, %dx%d to %dx%d%s",
+		 format, type, z[0], z[1], z[2], z[3],
+		 swap ? ", swapped" : "");
+	d = data ? checkScale(format, z[0], z[1], type, data, z[2], z[3],
+			      type) : -1;
+	CHECK(d >= 0 && d < 1.5);
+	free(data);
+    }
+}
+
+int main(void)
+{
+    unsigned seed = 4;
+    size_t t, f;
+    int swap;
+
+    glRecordReset();
+    for (swap = 0; swap < 2; swap++) {
+	glPixelStorei(GL_UNPACK_SWAP_BYTES, swap);
+	for (t = 0; t < COUNT(packedTypes); t++) {
+	    for (f = 0; f < 2 && packedTypes[t].formats[f] != 0; f++) {
+		testType(packedTypes[t].formats[f], packedTypes[t].type,
+			 (GLboolean) swap, &seed);
+	    }
+	}
+    }
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** The separable rescaler must stay within one unit of the 2D box filter
+** loops it replaces.  gluScaleImage is compared with the scalar build for
+** all sizes.  For the mipmap builders the scalar loops are only a valid
+** reference for images that shrink vertically, by less than 3 times: their
+** edge pointers drift on taller boxes, and the weight of the last row of
+** an enlarged image depends on float rounding.  So level 0 of every build
+** is also checked against a box filter computed in double here, including
+** images that are enlarged, and images that have to shrink a lot to fit a
+** small maximum texture size.  The unit is the one of elementUnit(), or
+** a step of the GLushort image gluScaleImage works on.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+#include "mipmapcheck.h"
+#include "check.h"
+
+#define TYPES COUNT(types)
+#define FORMATS COUNT(formats)
+
+static const GLenum types[] = {
+    GL_UNSIGNED_BYTE, GL_BYTE, GL_UNSIGNED_SHORT, GL_SHORT,
+    GL_UNSIGNED_INT, GL_INT, GL_FLOAT,
+};
+
+static const GLenum formats[] = {
+    GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA,
+};
+
+static void *newImage(GLsizei width, GLsizei height, GLenum format,
+		      GLenum type, unsigned *seed)
+{
+    size_t size = imageBytes(width, height, 1, format, type, GL_FALSE);
+    void *data = malloc(size);
+
+    if (data != NULL) randomImage(data, size, type, seed);
+    return data;
+}
+
+/* gluScaleImage, between any two sizes */
+static void testScaleImage(unsigned *seed)
+{
+    static const GLsizei sizes[][4] = {
+	{ 37, 23, 64, 64 }, { 64, 64, 17, 9 }, { 100, 7, 13, 50 },
+	{ 5, 5, 3, 3 }, { 1, 40, 7, 3 }, { 256, 200, 31, 29 },
+	{ 3, 2, 300, 5 }, { 16, 16, 16, 16 },
+    };
+    static const GLenum typePairs[][2] = {
+	{ GL_UNSIGNED_BYTE, GL_FLOAT }, { GL_FLOAT, GL_UNSIGNED_BYTE },
+	{ GL_UNSIGNED_SHORT, GL_INT },
+    };
+    size_t f, t, s;
+
+    for (f = 0; f < FORMATS; f++) {
+	for (t = 0; t < TYPES + 3; t++) {
+	    GLenum typein = t < TYPES ? types[t] : typePairs[t - TYPES][0];
+	    GLenum typeout = t < TYPES ? types[t] : typePairs[t - TYPES][1];
+
+	    for (s = 0; s < COUNT(sizes); s++) {
+		const GLsizei *z = sizes[s];
+		void *data = newImage(z[0], z[1], formats[f], typein, seed);
+		double d;
+
+		snprintf(testName, sizeof(testName),
+			 "gluScaleImage, format 0x%x, types 0x%x 0x%x, "
+			 "%dx%d to %dx%d", formats[f], typein, typeout,
+			 z[0], z[1], z[2], z[3]);
+		d = data ? checkScale(formats[f], z[0], z[1], typein, data,
+				      z[2], z[3], typeout) : -1;
+		CHECK(d >= 0 && d <= 1);
+		free(data);
+	    }
+	}
+    }
+}
+
+/* Mipmaps of images that don't have power of two sizes, and shrink */
+static void testBuildShrinking(unsigned *seed)
+{
+    static const GLsizei sizes[][2] = {
+	{ 90, 45 }, { 45, 90 }, { 100, 90 }, { 5, 9 }, { 1, 90 }, { 23, 180 },
+    };
+    size_t f, t, s;
+
+    for (f = 0; f < FORMATS; f++) {
+	for (t = 0; t < TYPES; t++) {
+	    for (s = 0; s < COUNT(sizes); s++) {
+		void *data = newImage(sizes[s][0], sizes[s][1], formats[f],
+				      types[t], seed);
+		double d;
+
+		snprintf(testName, sizeof(testName),
+			 "gluBuild2DMipmaps, format 0x%x, type 0x%x, %dx%d",
+			 formats[f], types[t], sizes[s][0], sizes[s][1]);
+		d = data ? checkBuild2D(formats[f], sizes[s][0], sizes[s][1],
+					formats[f], types[t], data) : -1;
+		CHECK(d >= 0 && d <= 1);
+		free(data);
+	    }
+	}
+    }
+}
+
+/* Share of [low, high) that source sample i covers */
+static double coverage(int i, double low, double high)
+{
+    double a = i > low ? i : low;
+    double b = i + 1 < high ? i + 1 : high;
+
+    return b > a ? b - a : 0;
+}
+
+/*
+** Largest difference between level 0 of a build, scaled from a
+** width x height image with no row padding, and the box filter of the
+** scale_internal_<type> routines: output sample i covers [i*conv,
+** (i+1)*conv) of the input.  The filter is computed in double and
+** rounded to the nearest value of type.
+*/
+static double boxDifference(const GLRecordImage *level0, GLsizei width,
+			    GLsizei height, GLint components, GLenum type,
+			    const void *data)
+{
+    double convx = (double) width / level0->width;
+    double convy = (double) height / level0->height;
+    double worst = 0;
+    GLint i, j, k, l, m;
+
+    for (i = 0; i < level0->height; i++) {
+	for (j = 0; j < level0->width; j++) {
+	    for (k = 0; k < components; k++) {
+		double sum = 0, area = 0, d;
+		size_t index = ((size_t) i * level0->width + j) * components +
+			       k;
+
+		for (m = (int) floor(i * convy); m < height; m++) {
+		    double wy = coverage(m, i * convy, (i + 1) * convy);
+
+		    if (m >= (i + 1) * convy) break;
+		    for (l = (int) floor(j * convx); l < width; l++) {
+			double w = wy * coverage(l, j * convx,
+						 (j + 1) * convx);
+
+			if (l >= (j + 1) * convx) break;
+			sum += w * elementValue(data, ((size_t) m * width + l) *
+						components + k, type);
+			area += w;
+		    }
+		}
+		sum /= area;
+		sum = type == GL_FLOAT ? (GLfloat) sum : floor(sum + 0.5);
+		d = fabs(elementValue(level0->pixels, index, type) - sum) /
+		    elementUnit(type);
+		if (d > worst) worst = d;
+	    }
+	}
+    }
+    return worst;
+}
+
+static void testBuildBox(unsigned *seed)
+{
+    static const struct {
+	GLsizei width, height;
+	GLint maxTextureSize;
+    } cases[] = {
+	{ 100, 3, 0 }, { 3, 100, 0 }, { 90, 45, 0 }, { 7, 5, 0 },
+	{ 200, 120, 32 }, { 33, 200, 16 }, { 100, 6, 0 }, { 50, 500, 64 },
+    };
+    size_t f, t, c;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (f = 0; f < FORMATS; f++) {
+	for (t = 0; t < TYPES; t++) {
+	    for (c = 0; c < COUNT(cases); c++) {
+		GLsizei width = cases[c].width, height = cases[c].height;
+		void *data = newImage(width, height, formats[f], types[t],
+				      seed);
+		MipmapLevels levels;
+		GLint components = glRecordGroupSize(formats[f], types[t]) /
+				   glRecordGroupSize(GL_LUMINANCE, types[t]);
+		GLint status;
+		double d = -1;
+
+		snprintf(testName, sizeof(testName),
+			 "box filter, format 0x%x, type 0x%x, %dx%d, "
+			 "maximum size %d", formats[f], types[t], width,
+			 height, cases[c].maxTextureSize);
+		glRecord.maxTextureSize = cases[c].maxTextureSize;
+		status = data ? gluBuild2DMipmaps(GL_TEXTURE_2D, formats[f],
+						  width, height, formats[f],
+						  types[t], data) : -1;
+		takeLevels(&levels);
+		if (status == 0 && levels.count > 0 &&
+		    levels.images[0].level == 0) {
+		    d = boxDifference(&levels.images[0], width, height,
+				      components, types[t], data);
+		}
+		CHECK(d >= 0 && d <= 1);
+		freeLevels(&levels);
+		free(data);
+	    }
+	}
+    }
+    glRecord.maxTextureSize = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+int main(void)
+{
+    unsigned seed = 2;
+
+    glRecordReset();
+    testScaleImage(&seed);
+    testBuildShrinking(&seed);
+    testBuildBox(&seed);
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
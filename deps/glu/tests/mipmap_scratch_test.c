@@ -0,0 +1,343 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** The mipmap builders take their buffers from a per-thread scratch arena
+** and pad rows for GL_UNPACK_ALIGNMENT in it.
+**
+** Every level uploaded for GL_UNSIGNED_BYTE images, with rows that are not
+** a multiple of the unpack alignment, must be the 2x2 box filter of the
+** level before it, read with that alignment; this includes the first
+** computed level, and the levels must be those of the scalar build, up to
+** rounding.  Results must not depend on the alignment, nor on what
+** the arena held before: builds after a sequence of bigger and smaller
+** ones, which grow the arena and spill to malloc, are compared with the
+** same builds on a fresh thread.  gluScaleImage is run on several threads
+** at once, which must not share an arena.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#include "glrecord.h"
+#include "mipmapcheck.h"
+#include "check.h"
+
+static const GLenum formats[] = {
+    GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB,
+};
+
+static const GLsizei sizes[][2] = {
+    { 4, 64 }, { 2, 16 }, { 6, 40 }, { 3, 3 }, { 1, 5 }, { 5, 1 },
+    { 2, 100 }, { 70, 3 },
+};
+
+static const GLint alignments[] = { 1, 2, 4, 8 };
+
+/*
+** Lays out a tightly packed image with the current unpack alignment;
+** returns NULL if out of memory.
+*/
+static GLubyte *alignImage(const GLubyte *packed, GLsizei width,
+			   GLsizei height, GLenum format)
+{
+    size_t line = (size_t) width * glRecordGroupSize(format,
+						     GL_UNSIGNED_BYTE);
+    size_t size = imageBytes(width, height, 1, format, GL_UNSIGNED_BYTE,
+			     GL_FALSE);
+    size_t row = height > 0 ? size / height : 0;
+    GLubyte *data = (GLubyte *) malloc(size ? size : 1);
+    GLsizei j;
+
+    if (data == NULL) return NULL;
+    memset(data, 0xee, size);
+    for (j = 0; j < height; j++) {
+	memcpy(data + j * row, packed + j * line, line);
+    }
+    return data;
+}
+
+/* Checks that each level is the box filter of the one before it. */
+static void checkChain(const MipmapLevels *levels, GLint components)
+{
+    int i;
+
+    CHECK(levels->count > 0);
+    for (i = 1; i < levels->count; i++) {
+	const GLRecordImage *a = &levels->images[i - 1];
+	const GLRecordImage *b = &levels->images[i];
+	GLint w = a->width, h = a->height;
+	GLint ii, jj, k, bad = 0;
+
+	CHECK(b->level == a->level + 1);
+	CHECK(b->width == (w > 1 ? w / 2 : 1));
+	CHECK(b->height == (h > 1 ? h / 2 : 1));
+	if (b->width != (w > 1 ? w / 2 : 1) ||
+	    b->height != (h > 1 ? h / 2 : 1)) {
+	    return;
+	}
+	for (ii = 0; ii < b->height; ii++) {
+	    for (jj = 0; jj < b->width; jj++) {
+		for (k = 0; k < components; k++) {
+		    const GLubyte *p = a->pixels;
+		    GLint x = 2 * jj, y = 2 * ii, v;
+
+		    if (w > 1 && h > 1) {
+			v = (p[(y * w + x) * components + k] +
+			     p[(y * w + x + 1) * components + k] +
+			     p[((y + 1) * w + x) * components + k] +
+			     p[((y + 1) * w + x + 1) * components + k] + 2) /
+			    4;
+		    } else if (w > 1) {
+			v = (p[x * components + k] +
+			     p[(x + 1) * components + k]) / 2;
+		    } else {
+			v = (p[y * components + k] +
+			     p[(y + 1) * components + k]) / 2;
+		    }
+		    if (b->pixels[(ii * b->width + jj) * components + k] != v) {
+			bad = 1;
+		    }
+		}
+	    }
+	}
+	CHECK(!bad);
+    }
+}
+
+static void testAlignment(unsigned *seed)
+{
+    size_t f, s, a;
+
+    for (f = 0; f < COUNT(formats); f++) {
+	GLint components = glRecordGroupSize(formats[f], GL_UNSIGNED_BYTE);
+
+	for (s = 0; s < COUNT(sizes); s++) {
+	    GLsizei width = sizes[s][0], height = sizes[s][1];
+	    size_t size = (size_t) width * height * components;
+	    GLubyte *packed = (GLubyte *) malloc(size);
+	    MipmapLevels first = { NULL, 0 };
+
+	    if (packed == NULL) {
+		CHECK(!"out of memory");
+		return;
+	    }
+	    randomImage(packed, size, GL_UNSIGNED_BYTE, seed);
+	    for (a = 0; a < COUNT(alignments); a++) {
+		GLubyte *data;
+		MipmapLevels levels;
+		GLint status;
+		double d;
+
+		snprintf(testName, sizeof(testName),
+			 "format 0x%x, %dx%d, alignment %d", formats[f],
+			 width, height, alignments[a]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignments[a]);
+		data = alignImage(packed, width, height, formats[f]);
+		CHECK(data != NULL);
+		if (data == NULL) break;
+		/*
+		** The first level may be scaled, and round differently.  The
+		** scalar loops give a single row that is scaled no weight.
+		*/
+		if (height > 1) {
+		    d = checkBuild2D(formats[f], width, height, formats[f],
+				     GL_UNSIGNED_BYTE, data);
+		    CHECK(d >= 0 && d < 1.5);
+		}
+		status = gluBuild2DMipmaps(GL_TEXTURE_2D, formats[f], width,
+					   height, formats[f],
+					   GL_UNSIGNED_BYTE, data);
+		takeLevels(&levels);
+		CHECK(status == 0);
+		checkChain(&levels, components);
+		if (a == 0) {
+		    first = levels;
+		} else {
+		    CHECK(compareLevels(&levels, &first) == 0);
+		    freeLevels(&levels);
+		}
+		free(data);
+	    }
+	    freeLevels(&first);
+	    free(packed);
+	}
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+#ifndef _WIN32
+/* Sizes to build, from big to small and back, so the arena is reused. */
+static const GLsizei reuseSizes[][2] = {
+    { 300, 200 }, { 17, 9 }, { 1000, 3 }, { 64, 64 }, { 3, 700 }, { 5, 5 },
+    { 513, 257 },
+};
+#define REUSE_SIZES (COUNT(reuseSizes))
+
+typedef struct {
+    const GLubyte *data;
+    GLsizei width, height;
+    MipmapLevels levels;
+    GLint status;
+} BuildJob;
+
+static void *buildOnThread(void *arg)
+{
+    BuildJob *job = (BuildJob *) arg;
+
+    job->status = gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, job->width,
+				    job->height, GL_RGBA, GL_UNSIGNED_BYTE,
+				    job->data);
+    takeLevels(&job->levels);
+    return NULL;
+}
+
+static void testReuse(unsigned *seed)
+{
+    GLubyte *data = (GLubyte *) malloc((size_t) 1024 * 1024 * 4);
+    int pass;
+    size_t s;
+
+    if (data == NULL) {
+	CHECK(!"out of memory");
+	return;
+    }
+    randomImage(data, (size_t) 1024 * 1024 * 4, GL_UNSIGNED_BYTE, seed);
+    for (pass = 0; pass < 2; pass++) {
+	for (s = 0; s < REUSE_SIZES; s++) {
+	    size_t i = pass == 0 ? s : REUSE_SIZES - 1 - s;
+	    BuildJob job;
+	    pthread_t thread;
+	    MipmapLevels levels;
+	    GLint status;
+
+	    snprintf(testName, sizeof(testName), "reused arena, %dx%d",
+		     reuseSizes[i][0], reuseSizes[i][1]);
+	    status = gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA,
+				       reuseSizes[i][0], reuseSizes[i][1],
+				       GL_RGBA, GL_UNSIGNED_BYTE, data);
+	    takeLevels(&levels);
+	    CHECK(status == 0);
+
+	    /* the same build with the empty arena of a new thread */
+	    job.data = data;
+	    job.width = reuseSizes[i][0];
+	    job.height = reuseSizes[i][1];
+	    job.status = -1;
+	    if (pthread_create(&thread, NULL, buildOnThread, &job) == 0) {
+		pthread_join(thread, NULL);
+		CHECK(job.status == 0);
+		CHECK(compareLevels(&levels, &job.levels) == 0);
+		freeLevels(&job.levels);
+	    }
+	    freeLevels(&levels);
+	}
+    }
+    free(data);
+}
+
+#define SCALE_THREADS 4
+
+typedef struct {
+    const GLushort *data;
+    GLsizei widthin, heightin, widthout, heightout;
+    GLushort *out;
+    GLint status;
+} ScaleJob;
+
+static void *scaleOnThread(void *arg)
+{
+    ScaleJob *job = (ScaleJob *) arg;
+    int i;
+
+    /* repeat, so that the threads' arenas are in use at the same time */
+    for (i = 0; i < 20 && job->status == 0; i++) {
+	job->status = gluScaleImage(GL_RGBA, job->widthin, job->heightin,
+				    GL_UNSIGNED_SHORT, job->data,
+				    job->widthout, job->heightout,
+				    GL_UNSIGNED_SHORT, job->out);
+    }
+    return NULL;
+}
+
+static void testThreads(unsigned *seed)
+{
+    static const GLsizei scaleSizes[SCALE_THREADS][4] = {
+	{ 200, 100, 77, 301 }, { 31, 400, 250, 17 }, { 128, 128, 9, 9 },
+	{ 5, 6, 333, 222 },
+    };
+    GLushort *data = (GLushort *) malloc((size_t) 400 * 400 * 4 *
+					 sizeof(GLushort));
+    ScaleJob jobs[SCALE_THREADS];
+    pthread_t threads[SCALE_THREADS];
+    int started[SCALE_THREADS];
+    int i;
+
+    if (data == NULL) {
+	CHECK(!"out of memory");
+	return;
+    }
+    randomImage(data, (size_t) 400 * 400 * 4 * sizeof(GLushort),
+		GL_UNSIGNED_SHORT, seed);
+    for (i = 0; i < SCALE_THREADS; i++) {
+	size_t size = (size_t) scaleSizes[i][2] * scaleSizes[i][3] * 4;
+
+	jobs[i].data = data;
+	jobs[i].widthin = scaleSizes[i][0];
+	jobs[i].heightin = scaleSizes[i][1];
+	jobs[i].widthout = scaleSizes[i][2];
+	jobs[i].heightout = scaleSizes[i][3];
+	jobs[i].out = (GLushort *) malloc(size * sizeof(GLushort));
+	jobs[i].status = jobs[i].out ? 0 : -1;
+    }
+    for (i = 0; i < SCALE_THREADS; i++) {
+	started[i] = pthread_create(&threads[i], NULL, scaleOnThread,
+				    &jobs[i]) == 0;
+    }
+    for (i = 0; i < SCALE_THREADS; i++) {
+	size_t size = (size_t) scaleSizes[i][2] * scaleSizes[i][3] * 4;
+	GLushort *expected = (GLushort *) malloc(size * sizeof(GLushort));
+
+	if (started[i]) pthread_join(threads[i], NULL);
+	snprintf(testName, sizeof(testName),
+		 "gluScaleImage on thread %d, %dx%d to %dx%d", i,
+		 scaleSizes[i][0], scaleSizes[i][1], scaleSizes[i][2],
+		 scaleSizes[i][3]);
+	CHECK(jobs[i].status == 0);
+	CHECK(expected != NULL);
+	if (expected != NULL && jobs[i].status == 0) {
+	    CHECK(gluScaleImage(GL_RGBA, scaleSizes[i][0], scaleSizes[i][1],
+				GL_UNSIGNED_SHORT, data, scaleSizes[i][2],
+				scaleSizes[i][3], GL_UNSIGNED_SHORT,
+				expected) == 0);
+	    CHECK(memcmp(expected, jobs[i].out,
+			 size * sizeof(GLushort)) == 0);
+	}
+	free(expected);
+	free(jobs[i].out);
+    }
+    free(data);
+}
+#endif /* !_WIN32 */
+
+int main(void)
+{
+    unsigned seed = 3;
+
+    glRecordReset();
+    testAlignment(&seed);
+#ifndef _WIN32
+    testReuse(&seed);
+    testThreads(&seed);
+#endif
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
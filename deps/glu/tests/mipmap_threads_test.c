@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** Run with GLU_MIPMAP_THREADS set, so that levels of 256x256 pixels and
+** more are halved in bands by the thread pool.  Three threads split the
+** levels into bands that don't divide them evenly.  The images have power
+** of two sizes, so that every level is halved, and the levels must be
+** bit-identical to the scalar build, which never starts the pool, also
+** while builds on two threads compete for it and one of them halves on
+** its own.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+#include "mipmapcheck.h"
+#include "check.h"
+
+/*
+** The packed types are ones halved through extract*() and shove*(),
+** which the scalar build shares; see mipmap_packed_test.c for the others.
+*/
+static const struct {
+    GLenum format;
+    GLenum type;
+} formats[] = {
+    { GL_LUMINANCE, GL_UNSIGNED_BYTE }, { GL_RGB, GL_UNSIGNED_BYTE },
+    { GL_RGBA, GL_UNSIGNED_BYTE }, { GL_RGBA, GL_BYTE },
+    { GL_LUMINANCE_ALPHA, GL_UNSIGNED_SHORT }, { GL_RGB, GL_SHORT },
+    { GL_RGBA, GL_UNSIGNED_INT }, { GL_LUMINANCE, GL_INT },
+    { GL_RGBA, GL_FLOAT }, { GL_RGB, GL_FLOAT },
+    { GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4_REV },
+    { GL_RGBA, GL_UNSIGNED_INT_10_10_10_2 },
+};
+
+static const GLsizei sizes[][2] = {
+    { 256, 256 }, { 512, 512 }, { 1024, 64 }, { 64, 1024 }, { 128, 512 },
+};
+
+static void *newImage(GLsizei width, GLsizei height, GLenum format,
+		      GLenum type, unsigned *seed)
+{
+    size_t size = imageBytes(width, height, 1, format, type, GL_FALSE);
+    void *data = malloc(size);
+
+    if (data != NULL) randomImage(data, size, type, seed);
+    return data;
+}
+
+static void testSerial(unsigned *seed)
+{
+    size_t f, s;
+
+    for (f = 0; f < COUNT(formats); f++) {
+	for (s = 0; s < COUNT(sizes); s++) {
+	    void *data = newImage(sizes[s][0], sizes[s][1], formats[f].format,
+				  formats[f].type, seed);
+
+	    snprintf(testName, sizeof(testName),
+		     "format 0x%x, type 0x%x, %dx%d", formats[f].format,
+		     formats[f].type, sizes[s][0], sizes[s][1]);
+	    CHECK(data != NULL);
+	    if (data != NULL) {
+		CHECK(checkBuild2D(formats[f].format, sizes[s][0],
+				   sizes[s][1], formats[f].format,
+				   formats[f].type, data) == 0);
+	    }
+	    free(data);
+	}
+    }
+}
+
+#ifndef _WIN32
+#include <pthread.h>
+
+typedef struct {
+    const void *data;
+    MipmapLevels levels;
+    GLint status;
+} BuildJob;
+
+static void *buildOnThread(void *arg)
+{
+    BuildJob *job = (BuildJob *) arg;
+
+    job->status = gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, 1024, 1024,
+				    GL_RGBA, GL_UNSIGNED_BYTE, job->data);
+    takeLevels(&job->levels);
+    return NULL;
+}
+
+/* Two builds at once; glrecord keeps the images of each thread apart. */
+static void testCompeting(unsigned *seed)
+{
+    BuildJob jobs[2];
+    pthread_t threads[2];
+    int started[2];
+    MipmapLevels scalar;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+	jobs[i].data = newImage(1024, 1024, GL_RGBA, GL_UNSIGNED_BYTE, seed);
+	jobs[i].status = -1;
+	started[i] = jobs[i].data != NULL &&
+		     pthread_create(&threads[i], NULL, buildOnThread,
+				    &jobs[i]) == 0;
+    }
+    for (i = 0; i < 2; i++) {
+	snprintf(testName, sizeof(testName), "competing build %d", i);
+	CHECK(started[i]);
+	if (!started[i]) continue;
+	pthread_join(threads[i], NULL);
+	CHECK(jobs[i].status == 0);
+	CHECK(scalarBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, 1024, 1024,
+				   GL_RGBA, GL_UNSIGNED_BYTE,
+				   jobs[i].data) == 0);
+	takeLevels(&scalar);
+	CHECK(compareLevels(&jobs[i].levels, &scalar) == 0);
+	freeLevels(&scalar);
+	freeLevels(&jobs[i].levels);
+    }
+    for (i = 0; i < 2; i++) {
+	free((void *) jobs[i].data);
+    }
+}
+#endif /* !_WIN32 */
+
+int main(void)
+{
+    unsigned seed = 5;
+
+    snprintf(testName, sizeof(testName), "environment");
+    CHECK(getenv("GLU_MIPMAP_THREADS") != NULL);
+
+    glRecordReset();
+    testSerial(&seed);
+#ifndef _WIN32
+    testCompeting(&seed);
+#endif
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,333 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#include "mipmapcheck.h"
+
+/* Fields of the packed types, as (shift, width) pairs */
+typedef struct {
+    GLenum type;
+    GLint size;
+    GLint fields;
+    GLint shift[4];
+    GLint width[4];
+} PackedType;
+
+static const PackedType packedTypes[] = {
+    { GL_UNSIGNED_BYTE_3_3_2, 1, 3, { 5, 2, 0 }, { 3, 3, 2 } },
+    { GL_UNSIGNED_BYTE_2_3_3_REV, 1, 3, { 0, 3, 6 }, { 3, 3, 2 } },
+    { GL_UNSIGNED_SHORT_5_6_5, 2, 3, { 11, 5, 0 }, { 5, 6, 5 } },
+    { GL_UNSIGNED_SHORT_5_6_5_REV, 2, 3, { 0, 5, 11 }, { 5, 6, 5 } },
+    { GL_UNSIGNED_SHORT_4_4_4_4, 2, 4, { 12, 8, 4, 0 }, { 4, 4, 4, 4 } },
+    { GL_UNSIGNED_SHORT_4_4_4_4_REV, 2, 4, { 0, 4, 8, 12 }, { 4, 4, 4, 4 } },
+    { GL_UNSIGNED_SHORT_5_5_5_1, 2, 4, { 11, 6, 1, 0 }, { 5, 5, 5, 1 } },
+    { GL_UNSIGNED_SHORT_1_5_5_5_REV, 2, 4, { 0, 5, 10, 15 }, { 5, 5, 5, 1 } },
+    { GL_UNSIGNED_INT_8_8_8_8, 4, 4, { 24, 16, 8, 0 }, { 8, 8, 8, 8 } },
+    { GL_UNSIGNED_INT_8_8_8_8_REV, 4, 4, { 0, 8, 16, 24 }, { 8, 8, 8, 8 } },
+    { GL_UNSIGNED_INT_10_10_10_2, 4, 4, { 22, 12, 2, 0 },
+      { 10, 10, 10, 2 } },
+    { GL_UNSIGNED_INT_2_10_10_10_REV, 4, 4, { 0, 10, 20, 30 },
+      { 10, 10, 10, 2 } },
+};
+
+static const PackedType *packedType(GLenum type)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(packedTypes)/sizeof(packedTypes[0]); i++) {
+	if (packedTypes[i].type == type) return &packedTypes[i];
+    }
+    return NULL;
+}
+
+static GLint elementBytes(GLenum type)
+{
+    const PackedType *packed = packedType(type);
+
+    if (packed != NULL) return packed->size;
+    switch (type) {
+      case GL_UNSIGNED_BYTE:
+      case GL_BYTE:
+	return 1;
+      case GL_UNSIGNED_SHORT:
+      case GL_SHORT:
+	return 2;
+      default:
+	return 4;
+    }
+}
+
+size_t imageBytes(GLsizei width, GLsizei height, GLsizei depth,
+		  GLenum format, GLenum type, GLboolean pack)
+{
+    GLint alignment, rowLength, skipRows, skipPixels, skipImages;
+    GLint imageHeight;
+    GLint group = glRecordGroupSize(format, type);
+    size_t rowSize;
+
+    glGetIntegerv(pack ? GL_PACK_ALIGNMENT : GL_UNPACK_ALIGNMENT,
+		  &alignment);
+    glGetIntegerv(pack ? GL_PACK_ROW_LENGTH : GL_UNPACK_ROW_LENGTH,
+		  &rowLength);
+    glGetIntegerv(pack ? GL_PACK_SKIP_ROWS : GL_UNPACK_SKIP_ROWS, &skipRows);
+    glGetIntegerv(pack ? GL_PACK_SKIP_PIXELS : GL_UNPACK_SKIP_PIXELS,
+		  &skipPixels);
+    glGetIntegerv(pack ? GL_PACK_SKIP_IMAGES : GL_UNPACK_SKIP_IMAGES,
+		  &skipImages);
+    glGetIntegerv(pack ? GL_PACK_IMAGE_HEIGHT : GL_UNPACK_IMAGE_HEIGHT,
+		  &imageHeight);
+    rowSize = (size_t) (rowLength > 0 ? rowLength : width) * group;
+    rowSize = (rowSize + alignment - 1) / alignment * alignment;
+    return rowSize * ((imageHeight > 0 ? imageHeight : height) *
+		      (skipImages + depth) + skipRows) +
+	   (size_t) skipPixels * group;
+}
+
+void randomImage(void *data, size_t size, GLenum type, unsigned *seed)
+{
+    size_t i;
+
+    if (type == GL_FLOAT) {
+	GLfloat *f = (GLfloat *) data;
+
+	for (i = 0; i < size / sizeof(GLfloat); i++) {
+	    *seed = *seed * 1103515245u + 12345u;
+	    f[i] = (GLfloat) (*seed >> 8) / 16777216.0f;
+	}
+    } else {
+	GLubyte *b = (GLubyte *) data;
+	GLubyte mask = type == GL_BYTE || type == GL_SHORT || type == GL_INT ?
+		       0x7f : 0xff;
+
+	for (i = 0; i < size; i++) {
+	    *seed = *seed * 1103515245u + 12345u;
+	    b[i] = (GLubyte) (*seed >> 16) & mask;
+	}
+    }
+}
+
+void takeLevels(MipmapLevels *levels)
+{
+    levels->images = glRecord.images;
+    levels->count = glRecord.imageCount;
+    glRecord.images = NULL;
+    glRecord.imageCount = 0;
+}
+
+void freeLevels(MipmapLevels *levels)
+{
+    int i;
+
+    for (i = 0; i < levels->count; i++) {
+	free(levels->images[i].pixels);
+    }
+    free(levels->images);
+    levels->images = NULL;
+    levels->count = 0;
+}
+
+double elementValue(const void *data, size_t index, GLenum type)
+{
+    switch (type) {
+      case GL_UNSIGNED_BYTE:
+	return ((const GLubyte *) data)[index];
+      case GL_BYTE:
+	return ((const GLbyte *) data)[index];
+      case GL_UNSIGNED_SHORT:
+	return ((const GLushort *) data)[index];
+      case GL_SHORT:
+	return ((const GLshort *) data)[index];
+      case GL_UNSIGNED_INT:
+	return ((const GLuint *) data)[index];
+      case GL_INT:
+	return ((const GLint *) data)[index];
+      default:
+	return ((const GLfloat *) data)[index];
+    }
+}
+
+double elementUnit(GLenum type)
+{
+    /* 4 times the float spacing just below 2^32, 2^31 and 1 */
+    switch (type) {
+      case GL_UNSIGNED_INT:
+	return 4 * 256.0;
+      case GL_INT:
+	return 4 * 128.0;
+      case GL_FLOAT:
+	return 4 / 16777216.0;
+      default:
+	return 1;
+    }
+}
+
+/* One step of the GLushort image gluScaleImage goes through */
+static double scaleUnit(GLenum type)
+{
+    switch (type) {
+      case GL_UNSIGNED_INT:
+	return (double) UINT_MAX / 65535;
+      case GL_INT:
+	return (double) INT_MAX / 65535;
+      case GL_FLOAT:
+	return 1.0 / 65535;
+      default:
+	return 1;
+    }
+}
+
+static double elementDifference(const GLubyte *a, const GLubyte *b,
+				GLenum type)
+{
+    const PackedType *packed = packedType(type);
+    double d = 0;
+
+    if (packed != NULL) {
+	GLuint pa, pb;
+	GLint k;
+
+	if (packed->size == 1) {
+	    pa = *a;
+	    pb = *b;
+	} else if (packed->size == 2) {
+	    pa = *(const GLushort *) a;
+	    pb = *(const GLushort *) b;
+	} else {
+	    pa = *(const GLuint *) a;
+	    pb = *(const GLuint *) b;
+	}
+	for (k = 0; k < packed->fields; k++) {
+	    GLuint mask = (1u << packed->width[k]) - 1;
+	    double fa = (pa >> packed->shift[k]) & mask;
+	    double fb = (pb >> packed->shift[k]) & mask;
+
+	    if (fabs(fa - fb) > d) d = fabs(fa - fb);
+	}
+	return d;
+    }
+
+    if (type == GL_FLOAT && memcmp(a, b, sizeof(GLfloat)) != 0) {
+	d = fabs(elementValue(a, 0, type) - elementValue(b, 0, type)) /
+	    elementUnit(type);
+	/* differing NaNs, or -0 and 0, still count as different */
+	return d > 0 ? d : 1;
+    }
+    return fabs(elementValue(a, 0, type) - elementValue(b, 0, type)) /
+	   elementUnit(type);
+}
+
+double compareImages(const void *a, const void *b, size_t size, GLenum type)
+{
+    GLint step = elementBytes(type);
+    double d, worst = 0;
+    size_t i;
+
+    for (i = 0; i + step <= size; i += step) {
+	d = elementDifference((const GLubyte *) a + i,
+			      (const GLubyte *) b + i, type);
+	if (d > worst) worst = d;
+    }
+    return worst;
+}
+
+double compareLevels(const MipmapLevels *a, const MipmapLevels *b)
+{
+    double d, worst = 0;
+    int i;
+
+    if (a->count != b->count || a->count == 0) return -1;
+    for (i = 0; i < a->count; i++) {
+	const GLRecordImage *ia = &a->images[i];
+	const GLRecordImage *ib = &b->images[i];
+
+	if (ia->target != ib->target || ia->level != ib->level ||
+	    ia->width != ib->width || ia->height != ib->height ||
+	    ia->depth != ib->depth || ia->format != ib->format ||
+	    ia->type != ib->type || ia->size != ib->size ||
+	    ia->pixels == NULL || ib->pixels == NULL) {
+	    return -1;
+	}
+	d = compareImages(ia->pixels, ib->pixels, ia->size, ia->type);
+	if (d > worst) worst = d;
+    }
+    return worst;
+}
+
+static double finishCheck(GLint status, GLint scalarStatus,
+			  MipmapLevels *levels, MipmapLevels *scalar)
+{
+    double d = -1;
+
+    if (status == 0 && scalarStatus == 0) {
+	d = compareLevels(levels, scalar);
+    }
+    freeLevels(levels);
+    freeLevels(scalar);
+    return d;
+}
+
+double checkBuild2D(GLint internalFormat, GLsizei width, GLsizei height,
+		    GLenum format, GLenum type, const void *data)
+{
+    MipmapLevels levels, scalar;
+    GLint status, scalarStatus;
+
+    takeLevels(&levels);
+    freeLevels(&levels);
+    status = gluBuild2DMipmaps(GL_TEXTURE_2D, internalFormat, width, height,
+			       format, type, data);
+    takeLevels(&levels);
+    scalarStatus = scalarBuild2DMipmaps(GL_TEXTURE_2D, internalFormat,
+					width, height, format, type, data);
+    takeLevels(&scalar);
+    return finishCheck(status, scalarStatus, &levels, &scalar);
+}
+
+double checkBuild3D(GLint internalFormat, GLsizei width, GLsizei height,
+		    GLsizei depth, GLenum format, GLenum type,
+		    const void *data)
+{
+    MipmapLevels levels, scalar;
+    GLint status, scalarStatus;
+
+    takeLevels(&levels);
+    freeLevels(&levels);
+    status = gluBuild3DMipmaps(GL_TEXTURE_3D, internalFormat, width, height,
+			       depth, format, type, data);
+    takeLevels(&levels);
+    scalarStatus = scalarBuild3DMipmaps(GL_TEXTURE_3D, internalFormat,
+					width, height, depth, format, type,
+					data);
+    takeLevels(&scalar);
+    return finishCheck(status, scalarStatus, &levels, &scalar);
+}
+
+double checkScale(GLenum format, GLsizei widthin, GLsizei heightin,
+		  GLenum typein, const void *datain,
+		  GLsizei widthout, GLsizei heightout, GLenum typeout)
+{
+    size_t size = imageBytes(widthout, heightout, 1, format, typeout,
+			     GL_TRUE);
+    void *out = malloc(size);
+    void *scalarOut = malloc(size);
+    double d = -1;
+
+    if (out != NULL && scalarOut != NULL) {
+	memset(out, 0, size);
+	memset(scalarOut, 0, size);
+	if (gluScaleImage(format, widthin, heightin, typein, datain,
+			  widthout, heightout, typeout, out) == 0 &&
+	    scalarScaleImage(format, widthin, heightin, typein, datain,
+			     widthout, heightout, typeout, scalarOut) == 0) {
+	    /* whole steps, give or take the conversion to typeout */
+	    d = floor(compareImages(out, scalarOut, size, typeout) *
+		      elementUnit(typeout) / scaleUnit(typeout) + 0.5);
+	}
+    }
+    free(out);
+    free(scalarOut);
+    return d;
+}
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** Helpers for the mipmap tests: random images of any type, and runs of
+** the mipmap builders and gluScaleImage against the scalar build of
+** mipmap.c, which tests/meson.build compiles with GLU_MIPMAP_SCALAR and
+** with its entry points renamed to scalar*.
+*/
+
+#ifndef __mipmapcheck_h__
+#define __mipmapcheck_h__
+
+#include <stddef.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+
+extern GLint GLAPIENTRY scalarBuild1DMipmaps(GLenum, GLint, GLsizei, GLenum,
+					     GLenum, const void *);
+extern GLint GLAPIENTRY scalarBuild2DMipmaps(GLenum, GLint, GLsizei, GLsizei,
+					     GLenum, GLenum, const void *);
+extern GLint GLAPIENTRY scalarBuild2DMipmapLevels(GLenum, GLint, GLsizei,
+							GLsizei, GLenum, GLenum,
+							GLint, GLint, GLint,
+							const void *);
+extern GLint GLAPIENTRY scalarBuild3DMipmaps(GLenum, GLint, GLsizei, GLsizei,
+					     GLsizei, GLenum, GLenum,
+					     const void *);
+extern GLint GLAPIENTRY scalarScaleImage(GLenum, GLsizei, GLsizei, GLenum,
+					 const void *, GLsizei, GLsizei,
+					 GLenum, GLvoid *);
+
+/* Texture images recorded by one call of a mipmap builder */
+typedef struct {
+    GLRecordImage *images;
+    int count;
+} MipmapLevels;
+
+/*
+** Bytes of a width x height x depth image with the current unpack
+** alignment, or a tightly packed one if packed is set.
+*/
+extern size_t imageBytes(GLsizei width, GLsizei height, GLsizei depth,
+			 GLenum format, GLenum type, GLboolean packed);
+
+/*
+** Fills size bytes with random elements of type: any bit pattern for
+** unsigned types, [0, 1) for floats.  Signed elements are kept
+** non-negative in either byte order, since mipmap.c asserts that what
+** it stores for them is.
+*/
+extern void randomImage(void *data, size_t size, GLenum type,
+			unsigned *seed);
+
+/* Takes the images glRecord holds, and leaves it with none. */
+extern void takeLevels(MipmapLevels *levels);
+extern void freeLevels(MipmapLevels *levels);
+
+/*
+** Value of element index of an image of a non-packed type, and the unit
+** differences are measured in: 1 for 8 and 16 bit types.  The builders
+** sum 32 bit and float elements in float, and sums of the same box taken
+** in another order can round a few times apart, so for those types it is
+** 4 times the float spacing at the top of their range.
+*/
+extern double elementValue(const void *data, size_t index, GLenum type);
+extern double elementUnit(GLenum type);
+
+/*
+** Largest difference between two runs, element by element, or field by
+** field for packed types, in units of elementUnit(); packed fields are
+** compared in units of 1.  0 means the runs are bit-identical; -1 means
+** they uploaded different levels or sizes.
+*/
+extern double compareLevels(const MipmapLevels *a, const MipmapLevels *b);
+extern double compareImages(const void *a, const void *b, size_t size,
+			    GLenum type);
+
+/*
+** Build mipmaps of an image with libGLU and with the scalar build, under
+** the current pixel storage modes, and compare the results.  Returns -1
+** as well if either build fails.
+*/
+extern double checkBuild2D(GLint internalFormat, GLsizei width,
+			   GLsizei height, GLenum format, GLenum type,
+			   const void *data);
+extern double checkBuild3D(GLint internalFormat, GLsizei width,
+			   GLsizei height, GLsizei depth, GLenum format,
+			   GLenum type, const void *data);
+
+/*
+** Same for gluScaleImage, in steps of the GLushort image it scales, for
+** every type.
+*/
+extern double checkScale(GLenum format, GLsizei widthin, GLsizei heightin,
+			 GLenum typein, const void *datain,
+			 GLsizei widthout, GLsizei heightout, GLenum typeout);
+
+#endif /* __mipmapcheck_h__ */
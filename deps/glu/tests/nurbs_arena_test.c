@@ -0,0 +1,301 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** A NURBS object takes the temporaries of a tessellation pass from its
+** own arena, which is emptied after each surface but keeps what the pass
+** used, up to GLU_NURBS_ARENA_LIMIT_EXT.  An object reused for many
+** surfaces, large and small, in any order, in tessellator and retained
+** mode, after a surface that raised an error or gave nothing to draw,
+** and while a callback draws with another object, must call back exactly
+** what a new object does for each surface.  Drawing a surface that fits
+** in the limit again takes no more memory from the heap, and after a
+** large surface a small one gives most of the arena back.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#include "nurbscheck.h"
+#include "check.h"
+
+#define SAMPLING	GLU_PATH_LENGTH
+#define TOLERANCE	5.0f
+
+/* ARENA_LIMIT, and one above what any of the surfaces needs */
+#define DEFAULT_LIMIT	(1024 * 1024)
+#define LARGE_LIMIT	(64 * 1024 * 1024)
+
+static NurbsSurface surfaces[NURBS_SURFACES];
+static NurbsOutput fresh[NURBS_SURFACES];
+
+/* Runs surface k on nurb and compares it with the new object's run */
+static void checkReused(GLUnurbs *nurb, int k, const char *when)
+{
+    NurbsOutput out = { 0 };
+
+    snprintf(testName, sizeof(testName), "%s, %s", surfaces[k].name, when);
+    drawSurface(nurb, &surfaces[k], 0, &out);
+    CHECK(out.error == 0);
+    CHECK(compareEvents(&out, &fresh[k], 0) == 0);
+    freeOutput(&out);
+}
+
+static GLfloat heapAllocations(GLUnurbs *nurb)
+{
+    GLfloat value;
+
+    gluGetNurbsProperty(nurb, GLU_NURBS_ARENA_ALLOCATIONS_EXT, &value);
+    return value;
+}
+
+static GLfloat arenaSize(GLUnurbs *nurb)
+{
+    GLfloat value;
+
+    gluGetNurbsProperty(nurb, GLU_NURBS_ARENA_SIZE_EXT, &value);
+    return value;
+}
+
+static void testReuse(void)
+{
+    GLUnurbs *nurb = newNurbs(SAMPLING, TOLERANCE);
+    NurbsSurface bad;
+    NurbsOutput failed = { 0 };
+    GLfloat allocations, largest;
+    char when[80];
+    int k, round;
+
+    for (round = 0; round < 3; round++) {
+	for (k = 0; k < NURBS_SURFACES; k++) {
+	    int j = round == 1 ? NURBS_SURFACES - 1 - k : k;
+
+	    snprintf(when, sizeof(when), "reused, round %d", round);
+	    checkReused(nurb, j, when);
+	}
+    }
+    snprintf(testName, sizeof(testName), "arena size");
+    CHECK(arenaSize(nurb) > 0);
+    CHECK(arenaSize(nurb) <= DEFAULT_LIMIT);
+
+    /*
+    ** With room for every surface, the second of two draws of the same
+    ** surface stays in the arena, and a small surface after the largest
+    ** one shrinks it.
+    */
+    gluNurbsProperty(nurb, GLU_NURBS_ARENA_LIMIT_EXT, LARGE_LIMIT);
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	checkReused(nurb, NURBS_HOLES, "large limit");
+	largest = arenaSize(nurb);
+	checkReused(nurb, k, "large limit, after the largest");
+	allocations = heapAllocations(nurb);
+	checkReused(nurb, k, "large limit, again");
+	CHECK(heapAllocations(nurb) == allocations);
+	CHECK(arenaSize(nurb) <= largest);
+    }
+    snprintf(testName, sizeof(testName), "large limit, shrinking");
+    checkReused(nurb, NURBS_HOLES, "large limit");
+    largest = arenaSize(nurb);
+    CHECK(largest > DEFAULT_LIMIT);
+    checkReused(nurb, NURBS_RATIONAL, "large limit, small surface");
+    CHECK(arenaSize(nurb) < largest / 2);
+    gluNurbsProperty(nurb, GLU_NURBS_ARENA_LIMIT_EXT, DEFAULT_LIMIT);
+
+    /*
+    ** Knots out of order are an error, and a hole that crosses itself
+    ** leaves nothing to draw.
+    */
+    bad = surfaces[NURBS_TRIMMED];
+    bad.knots[0][6] = bad.knots[0][8] + 0.01f;
+    snprintf(testName, sizeof(testName), "knots out of order");
+    drawSurface(nurb, &bad, 0, &failed);
+    CHECK(failed.error == GLU_NURBS_ERROR4);
+    CHECK(failed.eventCount == 0);
+    freeOutput(&failed);
+    for (k = NURBS_SURFACES - 1; k >= 0; k--) {
+	checkReused(nurb, k, "reused after an error");
+    }
+    bad = surfaces[NURBS_TRIMMED];
+    bad.trims[1][10][0] = 0.7f;
+    snprintf(testName, sizeof(testName), "hole crossing itself");
+    drawSurface(nurb, &bad, 0, &failed);
+    CHECK(failed.eventCount == 0);
+    freeOutput(&failed);
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	checkReused(nurb, k, "reused after nothing was drawn");
+    }
+    gluDeleteNurbsRenderer(nurb);
+}
+
+static GLenum propertyError;
+
+static void GLAPIENTRY recordError(GLenum errorCode)
+{
+    propertyError = errorCode;
+}
+
+/*
+** The limit: what the arena keeps after any surface, a limit of 0 that
+** gives everything back after each pass, and a lower limit that gives the
+** memory above it back at once.
+*/
+static void testLimit(void)
+{
+    GLUnurbs *nurb = newNurbs(SAMPLING, TOLERANCE);
+    GLfloat value;
+    int k;
+
+    gluNurbsCallback(nurb, GLU_NURBS_ERROR, (_GLUfuncptr) recordError);
+    snprintf(testName, sizeof(testName), "default limit");
+    gluGetNurbsProperty(nurb, GLU_NURBS_ARENA_LIMIT_EXT, &value);
+    CHECK(value == DEFAULT_LIMIT);
+    for (k = NURBS_SURFACES - 1; k >= 0; k--) {
+	checkReused(nurb, k, "default limit");
+	CHECK(arenaSize(nurb) > 0);
+	CHECK(arenaSize(nurb) <= DEFAULT_LIMIT);
+    }
+
+    snprintf(testName, sizeof(testName), "negative limit");
+    gluNurbsProperty(nurb, GLU_NURBS_ARENA_LIMIT_EXT, -1);
+    CHECK(propertyError == GLU_INVALID_VALUE);
+    gluGetNurbsProperty(nurb, GLU_NURBS_ARENA_LIMIT_EXT, &value);
+    CHECK(value == DEFAULT_LIMIT);
+
+    snprintf(testName, sizeof(testName), "lower limit");
+    propertyError = 0;
+    gluNurbsProperty(nurb, GLU_NURBS_ARENA_LIMIT_EXT, 0);
+    CHECK(propertyError == 0);
+    CHECK(arenaSize(nurb) == 0);
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	checkReused(nurb, k, "limit 0");
+	CHECK(arenaSize(nurb) == 0);
+    }
+    gluDeleteNurbsRenderer(nurb);
+}
+
+/*
+** The first begin callback of the outer object draws every surface with
+** the inner one before recording the begin, so the inner passes run in
+** the middle of the outer one.
+*/
+static GLUnurbs *inner;
+static NurbsOutput innerOutputs[NURBS_SURFACES];
+
+static void GLAPIENTRY nestedBegin(GLenum type, void *data)
+{
+    NurbsOutput *out = (NurbsOutput *) data;
+    int k;
+
+    if (out->eventCount == 0) {
+	for (k = 0; k < NURBS_SURFACES; k++) {
+	    drawSurface(inner, &surfaces[k], 0, &innerOutputs[k]);
+	}
+	gluNurbsCallbackData(inner, NULL);
+    }
+    addEvent(out, NURBS_BEGIN)->type = type;
+}
+
+static void testNested(void)
+{
+    GLUnurbs *outer = newNurbs(SAMPLING, TOLERANCE);
+    int k, j;
+
+    inner = newNurbs(SAMPLING, TOLERANCE);
+    gluNurbsCallback(outer, GLU_NURBS_BEGIN_DATA, (_GLUfuncptr) nestedBegin);
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	NurbsOutput out = { 0 };
+
+	drawSurface(outer, &surfaces[k], 0, &out);
+	snprintf(testName, sizeof(testName), "%s, outer", surfaces[k].name);
+	CHECK(out.error == 0);
+	CHECK(compareEvents(&out, &fresh[k], 0) == 0);
+	for (j = 0; j < NURBS_SURFACES; j++) {
+	    snprintf(testName, sizeof(testName), "%s, inside %s",
+		     surfaces[j].name, surfaces[k].name);
+	    CHECK(innerOutputs[j].error == 0);
+	    CHECK(compareEvents(&innerOutputs[j], &fresh[j], 0) == 0);
+	    freeOutput(&innerOutputs[j]);
+	}
+	freeOutput(&out);
+    }
+    gluDeleteNurbsRenderer(outer);
+    gluDeleteNurbsRenderer(inner);
+}
+
+/*
+** Retained mode tessellates into its own buffers, from the same arena.
+** With retention off every draw is a new pass, which must give the
+** buffers a new object does.
+*/
+static void testRetained(void)
+{
+    GLUnurbs *nurb = newNurbs(SAMPLING, TOLERANCE);
+    NurbsOutput first[NURBS_SURFACES] = { { 0 } };
+    int k, round;
+
+    gluNurbsProperty(nurb, GLU_NURBS_MODE, GLU_NURBS_RETAINED_EXT);
+    gluNurbsProperty(nurb, GLU_NURBS_RETAINED_CACHE_SIZE_EXT, 0);
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	GLUnurbs *reference = newNurbs(SAMPLING, TOLERANCE);
+
+	gluNurbsProperty(reference, GLU_NURBS_MODE, GLU_NURBS_RETAINED_EXT);
+	drawSurface(reference, &surfaces[k], 0, &first[k]);
+	gluDeleteNurbsRenderer(reference);
+    }
+    for (round = 0; round < 2; round++) {
+	for (k = 0; k < NURBS_SURFACES; k++) {
+	    int j = round == 1 ? NURBS_SURFACES - 1 - k : k;
+	    NurbsOutput out = { 0 };
+
+	    snprintf(testName, sizeof(testName), "%s, retained, round %d",
+		     surfaces[j].name, round);
+	    drawSurface(nurb, &surfaces[j], 0, &out);
+	    CHECK(out.error == 0);
+	    CHECK(out.bufferCount == 1);
+	    CHECK(out.vertexCount == first[j].vertexCount);
+	    CHECK(out.indexCount == first[j].indexCount);
+	    if (out.vertexCount == first[j].vertexCount &&
+		out.indexCount == first[j].indexCount) {
+		CHECK(memcmp(out.vertices, first[j].vertices,
+			     out.vertexCount * 8 * sizeof(GLfloat)) == 0);
+		CHECK(memcmp(out.indices, first[j].indices,
+			     out.indexCount * sizeof(GLuint)) == 0);
+	    }
+	    freeOutput(&out);
+	}
+    }
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	freeOutput(&first[k]);
+    }
+    gluDeleteNurbsRenderer(nurb);
+}
+
+int main(void)
+{
+    int k;
+
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	GLUnurbs *nurb = newNurbs(SAMPLING, TOLERANCE);
+
+	makeSurface(&surfaces[k], k);
+	snprintf(testName, sizeof(testName), "%s, new object",
+		 surfaces[k].name);
+	drawSurface(nurb, &surfaces[k], 0, &fresh[k]);
+	CHECK(fresh[k].error == 0);
+	CHECK(fresh[k].counts[NURBS_VERTEX] > 0);
+	gluDeleteNurbsRenderer(nurb);
+    }
+    testReuse();
+    testLimit();
+    testNested();
+    testRetained();
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	freeOutput(&fresh[k]);
+    }
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** In GLU_NURBS_TESSELLATOR mode, the points of a surface with only a
+** vertex map are evaluated IN_EVAL_BATCH at a time, and with a texture
+** coordinate map as well, one at a time.  Adding the texture map must not
+** change a single bit of the primitives, vertices or normals called back,
+** for rational and polynomial surfaces, a degenerate edge, trims, and
+** every sampling method.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "nurbscheck.h"
+#include "check.h"
+
+static const struct {
+    GLenum method;
+    GLfloat tolerance;
+} samplings[] = {
+    { GLU_PATH_LENGTH, 50 },
+    { GLU_PATH_LENGTH, 5 },
+    { GLU_PARAMETRIC_ERROR, 0.5f },
+    { GLU_DOMAIN_DISTANCE, 7 },
+    { GLU_DOMAIN_DISTANCE, 40 },
+};
+
+static void testSurface(const NurbsSurface *surface, GLenum method,
+			GLfloat tolerance)
+{
+    GLUnurbs *nurb = newNurbs(method, tolerance);
+    NurbsOutput batched = { 0 }, scalar = { 0 };
+
+    snprintf(testName, sizeof(testName), "%s, sampling %d, tolerance %g",
+	     surface->name, method, tolerance);
+    drawSurface(nurb, surface, 0, &batched);
+    drawSurface(nurb, surface, NURBS_TEXTURE, &scalar);
+    CHECK(batched.error == 0);
+    CHECK(scalar.error == 0);
+    CHECK(batched.counts[NURBS_VERTEX] > 0);
+    CHECK(batched.counts[NURBS_TEXCOORD] == 0);
+    CHECK(scalar.counts[NURBS_TEXCOORD] == scalar.counts[NURBS_VERTEX]);
+    CHECK(compareEvents(&batched, &scalar, 1 << NURBS_TEXCOORD) == 0);
+    freeOutput(&batched);
+    freeOutput(&scalar);
+    gluDeleteNurbsRenderer(nurb);
+}
+
+int main(void)
+{
+    NurbsSurface surface;
+    size_t s;
+    int k;
+
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	makeSurface(&surface, k);
+	for (s = 0; s < COUNT(samplings); s++) {
+	    testSurface(&surface, samplings[s].method, samplings[s].tolerance);
+	}
+    }
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
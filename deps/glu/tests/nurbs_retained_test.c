@@ -0,0 +1,381 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** In GLU_NURBS_RETAINED_EXT mode a surface comes back as one vertex
+** buffer and triangle list instead of primitives.  Its triangles must be
+** those of the fans and quad strips GLU_NURBS_TESSELLATOR mode calls
+** back, with the same positions, normals and texture coordinates to
+** the bit, and wound the same way.  What may differ is what the buffers
+** are for: each vertex is stored once, triangles with two identical
+** vertices are left out, and a vertex with no texture map has texture
+** coordinates 0, 0.  A surface drawn again with the same description and
+** sampling is not tessellated again: the same buffers come back, marked
+** unchanged, until the surface is evicted or its LOD level changes.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#include "nurbscheck.h"
+#include "check.h"
+
+static const struct {
+    GLenum method;
+    GLfloat tolerance;
+} samplings[] = {
+    { GLU_PATH_LENGTH, 50 },
+    { GLU_PATH_LENGTH, 5 },
+    { GLU_PARAMETRIC_ERROR, 0.5f },
+    { GLU_DOMAIN_DISTANCE, 7 },
+};
+
+/* x y z, nx ny nz, s t */
+#define VERTEX_SIZE 8
+
+typedef struct {
+    GLfloat v[3][VERTEX_SIZE];
+} Triangle;
+
+typedef struct {
+    Triangle *triangles;
+    int count, max;
+} Triangles;
+
+/*
+** Adds a triangle, starting from its smallest vertex so the same
+** triangle compares equal however it was listed, unless two of its
+** vertices are the same.
+*/
+static void addTriangle(Triangles *t, const GLfloat *a, const GLfloat *b,
+			const GLfloat *c)
+{
+    const size_t size = VERTEX_SIZE * sizeof(GLfloat);
+    const GLfloat *v[3];
+    int i, first = 0;
+
+    v[0] = a;
+    v[1] = b;
+    v[2] = c;
+    if (memcmp(a, b, size) == 0 || memcmp(b, c, size) == 0 ||
+	memcmp(c, a, size) == 0) {
+	return;
+    }
+    for (i = 1; i < 3; i++) {
+	if (memcmp(v[i], v[first], size) < 0) first = i;
+    }
+    if (t->count >= t->max) {
+	t->max = t->max ? 2 * t->max : 256;
+	t->triangles = (Triangle *)
+	    realloc(t->triangles, t->max * sizeof(Triangle));
+	if (t->triangles == NULL) abort();
+    }
+    for (i = 0; i < 3; i++) {
+	memcpy(t->triangles[t->count].v[i], v[(first + i) % 3], size);
+    }
+    t->count++;
+}
+
+static int compareTriangle(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(Triangle));
+}
+
+/*
+** The triangles of the primitives called back in tessellator mode.  A
+** quad a, b, c, d is split into a, b, c and a, c, d.
+*/
+static void immediateTriangles(const NurbsOutput *out, Triangles *t)
+{
+    GLfloat current[VERTEX_SIZE] = { 0, 0, 0, 0, 0, 1, 0, 0 };
+    GLfloat (*v)[VERTEX_SIZE] = NULL;
+    GLenum type = GL_TRIANGLES;
+    int i, n = 0, max = 0;
+
+    for (i = 0; i < out->eventCount; i++) {
+	const NurbsEvent *e = &out->events[i];
+
+	switch (e->kind) {
+	  case NURBS_BEGIN:
+	    type = e->type;
+	    n = 0;
+	    break;
+	  case NURBS_NORMAL:
+	    memcpy(&current[3], e->coords, 3 * sizeof(GLfloat));
+	    break;
+	  case NURBS_TEXCOORD:
+	    memcpy(&current[6], e->coords, 2 * sizeof(GLfloat));
+	    break;
+	  case NURBS_VERTEX:
+	    if (n >= max) {
+		max = max ? 2 * max : 256;
+		v = (GLfloat (*)[VERTEX_SIZE])
+		    realloc(v, max * sizeof(*v));
+		if (v == NULL) abort();
+	    }
+	    memcpy(current, e->coords, 3 * sizeof(GLfloat));
+	    memcpy(v[n++], current, sizeof(current));
+	    break;
+	  case NURBS_END:
+	    break;
+	}
+	if (e->kind != NURBS_VERTEX) continue;
+
+	switch (type) {
+	  case GL_TRIANGLES:
+	    if (n % 3 == 0) addTriangle(t, v[n - 3], v[n - 2], v[n - 1]);
+	    break;
+	  case GL_TRIANGLE_STRIP:
+	    if (n >= 3 && n % 2 == 1) {
+		addTriangle(t, v[n - 3], v[n - 2], v[n - 1]);
+	    } else if (n >= 3) {
+		addTriangle(t, v[n - 2], v[n - 3], v[n - 1]);
+	    }
+	    break;
+	  case GL_TRIANGLE_FAN:
+	  case GL_POLYGON:
+	    if (n >= 3) addTriangle(t, v[0], v[n - 2], v[n - 1]);
+	    break;
+	  case GL_QUADS:
+	    if (n % 4 == 0) {
+		addTriangle(t, v[n - 4], v[n - 3], v[n - 2]);
+		addTriangle(t, v[n - 4], v[n - 2], v[n - 1]);
+	    }
+	    break;
+	  case GL_QUAD_STRIP:
+	    /* The quad is v[n - 4], v[n - 3], v[n - 1], v[n - 2] */
+	    if (n >= 4 && n % 2 == 0) {
+		addTriangle(t, v[n - 4], v[n - 3], v[n - 1]);
+		addTriangle(t, v[n - 4], v[n - 1], v[n - 2]);
+	    }
+	    break;
+	}
+    }
+    free(v);
+    qsort(t->triangles, t->count, sizeof(Triangle), compareTriangle);
+}
+
+static int compareVertex(const void *a, const void *b)
+{
+    return memcmp(a, b, VERTEX_SIZE * sizeof(GLfloat));
+}
+
+/*
+** The triangles of the last vertex buffer, and the number of indices out
+** of range and of vertices stored twice.
+*/
+static int retainedTriangles(const NurbsOutput *out, Triangles *t)
+{
+    const GLfloat *vertices = out->vertices;
+    GLfloat *sorted;
+    int i, errors = 0;
+
+    for (i = 0; i < out->indexCount; i++) {
+	if (out->indices[i] >= (GLuint) out->vertexCount) errors++;
+    }
+    if (errors || out->indexCount % 3 != 0) return errors + 1;
+    for (i = 0; i < out->indexCount; i += 3) {
+	addTriangle(t, &vertices[out->indices[i] * VERTEX_SIZE],
+		    &vertices[out->indices[i + 1] * VERTEX_SIZE],
+		    &vertices[out->indices[i + 2] * VERTEX_SIZE]);
+    }
+    qsort(t->triangles, t->count, sizeof(Triangle), compareTriangle);
+
+    sorted = (GLfloat *) malloc(out->vertexCount * sizeof(GLfloat) *
+				VERTEX_SIZE + 1);
+    if (sorted == NULL) abort();
+    memcpy(sorted, vertices, out->vertexCount * sizeof(GLfloat) * VERTEX_SIZE);
+    qsort(sorted, out->vertexCount, VERTEX_SIZE * sizeof(GLfloat),
+	  compareVertex);
+    for (i = 1; i < out->vertexCount; i++) {
+	if (compareVertex(&sorted[(i - 1) * VERTEX_SIZE],
+			  &sorted[i * VERTEX_SIZE]) == 0) {
+	    errors++;
+	}
+    }
+    free(sorted);
+    return errors;
+}
+
+/* Number of triangles that are not in both, or -1 if their counts differ */
+static int compareTriangles(const Triangles *a, const Triangles *b)
+{
+    int i, differences = 0;
+
+    if (a->count != b->count) return -1;
+    for (i = 0; i < a->count; i++) {
+	if (compareTriangle(&a->triangles[i], &b->triangles[i]) != 0) {
+	    differences++;
+	}
+    }
+    return differences;
+}
+
+static void getCounts(GLUnurbs *nurb, GLfloat *hits, GLfloat *misses)
+{
+    gluGetNurbsProperty(nurb, GLU_NURBS_RETAINED_CACHE_HITS_EXT, hits);
+    gluGetNurbsProperty(nurb, GLU_NURBS_RETAINED_CACHE_MISSES_EXT, misses);
+}
+
+/* Draws surface in both modes and compares the triangles */
+static void checkSurface(GLUnurbs *immediate, GLUnurbs *retained,
+			 const NurbsSurface *surface, int flags,
+			 NurbsOutput *out)
+{
+    NurbsOutput reference = { 0 };
+    Triangles expected = { 0 }, got = { 0 };
+
+    drawSurface(immediate, surface, flags, &reference);
+    drawSurface(retained, surface, flags, out);
+    CHECK(reference.error == 0);
+    CHECK(out->error == 0);
+    CHECK(out->eventCount == 0);
+    CHECK(out->bufferCount == 1);
+    immediateTriangles(&reference, &expected);
+    CHECK(retainedTriangles(out, &got) == 0);
+    CHECK(got.count > 0);
+    CHECK(compareTriangles(&got, &expected) == 0);
+    free(expected.triangles);
+    free(got.triangles);
+    freeOutput(&reference);
+}
+
+static void testSurface(const NurbsSurface *surface, GLenum method,
+			GLfloat tolerance, int flags)
+{
+    GLUnurbs *immediate = newNurbs(method, tolerance);
+    GLUnurbs *retained = newNurbs(method, tolerance);
+    NurbsOutput first = { 0 }, again = { 0 };
+    GLfloat hits, misses;
+
+    snprintf(testName, sizeof(testName), "%s, sampling %d, tolerance %g%s",
+	     surface->name, method, tolerance,
+	     flags & NURBS_TEXTURE ? ", texture" : "");
+    gluNurbsProperty(retained, GLU_NURBS_MODE, GLU_NURBS_RETAINED_EXT);
+    checkSurface(immediate, retained, surface, flags, &first);
+    CHECK(first.changed == GL_TRUE);
+
+    drawSurface(retained, surface, flags, &again);
+    CHECK(again.bufferCount == 1);
+    CHECK(again.changed == GL_FALSE);
+    CHECK(again.vertexCount == first.vertexCount);
+    CHECK(again.indexCount == first.indexCount);
+    if (again.vertexCount == first.vertexCount &&
+	again.indexCount == first.indexCount) {
+	CHECK(memcmp(again.vertices, first.vertices, first.vertexCount *
+		     VERTEX_SIZE * sizeof(GLfloat)) == 0);
+	CHECK(memcmp(again.indices, first.indices,
+		     first.indexCount * sizeof(GLuint)) == 0);
+    }
+    getCounts(retained, &hits, &misses);
+    CHECK(hits == 1);
+    CHECK(misses == 1);
+
+    freeOutput(&first);
+    freeOutput(&again);
+    gluDeleteNurbsRenderer(immediate);
+    gluDeleteNurbsRenderer(retained);
+}
+
+/*
+** Two surfaces drawn in turn, with room for both and for one, and with
+** retention off.  Whatever is tessellated again must match tessellator
+** mode.
+*/
+static void testEviction(int cacheSize)
+{
+    GLUnurbs *immediate = newNurbs(GLU_PATH_LENGTH, 25);
+    GLUnurbs *retained = newNurbs(GLU_PATH_LENGTH, 25);
+    NurbsSurface surfaces[2];
+    GLfloat hits, misses;
+    int draw;
+
+    makeSurface(&surfaces[0], NURBS_RIPPLE);
+    makeSurface(&surfaces[1], NURBS_RIPPLE);
+    surfaces[1].control[3][4][2] += 0.5f;
+    gluNurbsProperty(retained, GLU_NURBS_MODE, GLU_NURBS_RETAINED_EXT);
+    gluNurbsProperty(retained, GLU_NURBS_RETAINED_CACHE_SIZE_EXT,
+		     (GLfloat) cacheSize);
+    for (draw = 0; draw < 6; draw++) {
+	NurbsOutput out = { 0 };
+	int fits = cacheSize >= 2 && draw >= 2;
+
+	snprintf(testName, sizeof(testName), "cache size %d, draw %d",
+		 cacheSize, draw);
+	if (fits) {
+	    drawSurface(retained, &surfaces[draw % 2], 0, &out);
+	    CHECK(out.bufferCount == 1);
+	} else {
+	    checkSurface(immediate, retained, &surfaces[draw % 2], 0, &out);
+	}
+	CHECK(out.changed == !fits);
+	freeOutput(&out);
+    }
+    getCounts(retained, &hits, &misses);
+    /* With retention off nothing is looked up */
+    CHECK(hits == (cacheSize >= 2 ? 4 : 0));
+    CHECK(misses == (cacheSize == 0 ? 0 : cacheSize >= 2 ? 2 : 6));
+    gluDeleteNurbsRenderer(immediate);
+    gluDeleteNurbsRenderer(retained);
+}
+
+/*
+** Zooming in by 4 changes the LOD level, so the surface is tessellated
+** again, like tessellator mode does at the new scale.
+*/
+static void testLevel(void)
+{
+    static const GLfloat identity[16] = {
+	1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1,
+    };
+    static const GLint viewport[4] = { 0, 0, 2048, 2048 };
+    GLUnurbs *immediate = newNurbs(GLU_PATH_LENGTH, 25);
+    GLUnurbs *retained = newNurbs(GLU_PATH_LENGTH, 25);
+    NurbsSurface surface;
+    NurbsOutput near = { 0 }, far = { 0 };
+    GLfloat hits, misses;
+
+    snprintf(testName, sizeof(testName), "LOD level");
+    makeSurface(&surface, NURBS_RIPPLE);
+    gluNurbsProperty(retained, GLU_NURBS_MODE, GLU_NURBS_RETAINED_EXT);
+    checkSurface(immediate, retained, &surface, 0, &far);
+    gluLoadSamplingMatrices(immediate, identity, identity, viewport);
+    gluLoadSamplingMatrices(retained, identity, identity, viewport);
+    checkSurface(immediate, retained, &surface, 0, &near);
+    CHECK(near.changed == GL_TRUE);
+    CHECK(near.indexCount > far.indexCount);
+    getCounts(retained, &hits, &misses);
+    CHECK(hits == 0);
+    CHECK(misses == 2);
+    freeOutput(&near);
+    freeOutput(&far);
+    gluDeleteNurbsRenderer(immediate);
+    gluDeleteNurbsRenderer(retained);
+}
+
+int main(void)
+{
+    NurbsSurface surface;
+    size_t s;
+    int k;
+
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	makeSurface(&surface, k);
+	for (s = 0; s < COUNT(samplings); s++) {
+	    testSurface(&surface, samplings[s].method, samplings[s].tolerance,
+			0);
+	    testSurface(&surface, samplings[s].method, samplings[s].tolerance,
+			NURBS_TEXTURE);
+	}
+    }
+    testEviction(0);
+    testEviction(1);
+    testEviction(2);
+    testLevel();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** With GLU_NURBS_THREADS_EXT above 1, the patches of a surface with
+** enough points are evaluated in runs on several threads and replayed in
+** order, so the callbacks must be exactly those of one thread, to the bit
+** and in the same order, for any number of threads, with and without a
+** texture map, and in retained mode.  The only intended difference is
+** that fewer than 2 threads or small surfaces stay on the calling thread,
+** which nothing called back can tell.  The property takes no value below
+** 1 and clamps values above its maximum.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#include "nurbscheck.h"
+#include "check.h"
+
+/* IN_PARALLEL_MIN_POINTS, below which a surface stays serial */
+#define PARALLEL_MIN_POINTS	4096
+#define MAX_THREADS		64
+
+static const struct {
+    GLenum method;
+    GLfloat tolerance;
+} samplings[] = {
+    { GLU_PATH_LENGTH, 50 },
+    { GLU_PATH_LENGTH, 5 },
+    { GLU_PARAMETRIC_ERROR, 0.5f },
+    { GLU_DOMAIN_DISTANCE, 7 },
+    { GLU_DOMAIN_DISTANCE, 40 },
+};
+
+/* Thread counts that split the patches unevenly, and more than there are */
+static const int threadCounts[] = { 2, 3, 4, 7, 64 };
+
+static int parallelRuns;
+
+static void testSurface(const NurbsSurface *surface, GLenum method,
+			GLfloat tolerance, int flags)
+{
+    GLUnurbs *nurb = newNurbs(method, tolerance);
+    NurbsOutput serial = { 0 };
+    size_t t;
+
+    snprintf(testName, sizeof(testName),
+	     "%s, sampling %d, tolerance %g, flags %d, 1 thread",
+	     surface->name, method, tolerance, flags);
+    drawSurface(nurb, surface, flags, &serial);
+    CHECK(serial.error == 0);
+    CHECK(serial.counts[NURBS_VERTEX] > 0);
+    if (serial.counts[NURBS_VERTEX] >= PARALLEL_MIN_POINTS) {
+	parallelRuns++;
+    }
+    for (t = 0; t < COUNT(threadCounts); t++) {
+	NurbsOutput out = { 0 };
+
+	snprintf(testName, sizeof(testName),
+		 "%s, sampling %d, tolerance %g, flags %d, %d threads",
+		 surface->name, method, tolerance, flags, threadCounts[t]);
+	gluNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, threadCounts[t]);
+	drawSurface(nurb, surface, flags, &out);
+	CHECK(out.error == 0);
+	CHECK(compareEvents(&out, &serial, 0) == 0);
+	freeOutput(&out);
+
+	/* Again, on the worker evaluators left from the first draw */
+	drawSurface(nurb, surface, flags, &out);
+	CHECK(compareEvents(&out, &serial, 0) == 0);
+	freeOutput(&out);
+    }
+    freeOutput(&serial);
+    gluDeleteNurbsRenderer(nurb);
+}
+
+/*
+** The worker evaluators are kept for the next surface, which must not
+** inherit the maps of the last one: one object draws the surface with
+** and without a texture map in turn.
+*/
+static void testAlternating(const NurbsSurface *surface)
+{
+    GLUnurbs *nurb = newNurbs(GLU_PATH_LENGTH, 5);
+    NurbsOutput serial[2] = { { 0 } };	/* plain, textured */
+    int textured, round;
+
+    drawSurface(nurb, surface, 0, &serial[0]);
+    drawSurface(nurb, surface, NURBS_TEXTURE, &serial[1]);
+    gluNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, 4);
+    for (round = 0; round < 4; round++) {
+	NurbsOutput out = { 0 };
+
+	textured = !(round & 1);
+	snprintf(testName, sizeof(testName), "%s, alternating, round %d",
+		 surface->name, round);
+	drawSurface(nurb, surface, textured ? NURBS_TEXTURE : 0, &out);
+	CHECK(out.error == 0);
+	CHECK(compareEvents(&out, &serial[textured], 0) == 0);
+	freeOutput(&out);
+    }
+    freeOutput(&serial[0]);
+    freeOutput(&serial[1]);
+    gluDeleteNurbsRenderer(nurb);
+}
+
+static void drawRetained(const NurbsSurface *surface, int threads, int flags,
+			 NurbsOutput *out)
+{
+    GLUnurbs *nurb = newNurbs(GLU_PATH_LENGTH, 5);
+
+    gluNurbsProperty(nurb, GLU_NURBS_MODE, GLU_NURBS_RETAINED_EXT);
+    gluNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, threads);
+    drawSurface(nurb, surface, flags, out);
+    gluDeleteNurbsRenderer(nurb);
+}
+
+static void testRetained(const NurbsSurface *surface, int flags)
+{
+    NurbsOutput serial = { 0 }, out = { 0 };
+
+    snprintf(testName, sizeof(testName), "%s, retained, flags %d",
+	     surface->name, flags);
+    drawRetained(surface, 1, flags, &serial);
+    drawRetained(surface, 4, flags, &out);
+    CHECK(serial.error == 0);
+    CHECK(out.error == 0);
+    CHECK(serial.bufferCount == 1);
+    CHECK(out.bufferCount == 1);
+    CHECK(out.vertexCount == serial.vertexCount);
+    CHECK(out.indexCount == serial.indexCount);
+    if (out.vertexCount == serial.vertexCount &&
+	out.indexCount == serial.indexCount) {
+	CHECK(memcmp(out.vertices, serial.vertices,
+		     out.vertexCount * 8 * sizeof(GLfloat)) == 0);
+	CHECK(memcmp(out.indices, serial.indices,
+		     out.indexCount * sizeof(GLuint)) == 0);
+    }
+    freeOutput(&serial);
+    freeOutput(&out);
+}
+
+static GLenum propertyError;
+
+static void GLAPIENTRY recordError(GLenum errorCode)
+{
+    propertyError = errorCode;
+}
+
+static void testProperty(void)
+{
+    GLUnurbs *nurb = gluNewNurbsRenderer();
+    GLfloat value;
+
+    gluNurbsCallback(nurb, GLU_NURBS_ERROR, (_GLUfuncptr) recordError);
+    snprintf(testName, sizeof(testName), "default threads");
+    gluGetNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, &value);
+    CHECK(value == 1);
+
+    snprintf(testName, sizeof(testName), "0 threads");
+    gluNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, 0);
+    CHECK(propertyError == GLU_INVALID_VALUE);
+    gluGetNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, &value);
+    CHECK(value == 1);
+
+    snprintf(testName, sizeof(testName), "5 threads");
+    propertyError = 0;
+    gluNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, 5);
+    CHECK(propertyError == 0);
+    gluGetNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, &value);
+    CHECK(value == 5);
+
+    snprintf(testName, sizeof(testName), "too many threads");
+    gluNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, 1000);
+    CHECK(propertyError == 0);
+    gluGetNurbsProperty(nurb, GLU_NURBS_THREADS_EXT, &value);
+    CHECK(value == MAX_THREADS);
+    gluDeleteNurbsRenderer(nurb);
+}
+
+int main(void)
+{
+    NurbsSurface surface;
+    size_t s;
+    int k;
+
+    for (k = 0; k < NURBS_SURFACES; k++) {
+	makeSurface(&surface, k);
+	for (s = 0; s < COUNT(samplings); s++) {
+	    testSurface(&surface, samplings[s].method, samplings[s].tolerance,
+			0);
+	    testSurface(&surface, samplings[s].method, samplings[s].tolerance,
+			NURBS_TEXTURE);
+	}
+	testAlternating(&surface);
+	testRetained(&surface, 0);
+	testRetained(&surface, NURBS_TEXTURE);
+    }
+    snprintf(testName, sizeof(testName), "surfaces evaluated in parallel");
+    CHECK(parallelRuns > 0);
+    testProperty();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
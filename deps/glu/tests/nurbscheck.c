@@ -0,0 +1,340 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#include "nurbscheck.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const char *const surfaceNames[NURBS_SURFACES] = {
+    "ripple", "rational", "cone", "quartic", "trimmed ripple",
+    "quartic with holes",
+};
+
+static void setKnots(NurbsSurface *s, int uCount, int vCount, int order,
+		     int dimension)
+{
+    int d, i, j, count;
+
+    s->uCount = uCount;
+    s->vCount = vCount;
+    s->order = order;
+    s->dimension = dimension;
+    for (d = 0; d < 2; d++) {
+	count = d == 0 ? uCount : vCount;
+	for (i = 0; i < count + order; i++) {
+	    j = i - (order - 1);
+	    if (j < 0) j = 0;
+	    if (j > count - order + 1) j = count - order + 1;
+	    s->knots[d][i] = (GLfloat) j / (count - order + 1);
+	}
+    }
+}
+
+static void setPoint(NurbsSurface *s, int i, int j, double x, double y,
+		     double z)
+{
+    s->control[i][j][0] = (GLfloat) x;
+    s->control[i][j][1] = (GLfloat) y;
+    s->control[i][j][2] = (GLfloat) z;
+    s->control[i][j][3] = 1.0f;
+}
+
+/* A closed loop of count - 1 points on a circle, clockwise if cw is set */
+static void addLoop(NurbsSurface *s, int count, double u, double v,
+		    double radius, int cw)
+{
+    GLfloat (*p)[2] = s->trims[s->trimCount];
+    int i;
+
+    for (i = 0; i < count; i++) {
+	double a = (cw ? -2 : 2) * M_PI * (i % (count - 1)) / (count - 1);
+
+	p[i][0] = (GLfloat) (u + radius * cos(a));
+	p[i][1] = (GLfloat) (v + radius * sin(a));
+    }
+    s->trimSizes[s->trimCount++] = count;
+}
+
+/* The boundary of the domain, inset by a little */
+static void addBoundary(NurbsSurface *s)
+{
+    static const GLfloat square[5][2] = {
+	{ 0.05f, 0.05f }, { 0.95f, 0.05f }, { 0.95f, 0.95f }, { 0.05f, 0.95f },
+	{ 0.05f, 0.05f },
+    };
+
+    memcpy(s->trims[s->trimCount], square, sizeof(square));
+    s->trimSizes[s->trimCount++] = 5;
+}
+
+void makeSurface(NurbsSurface *s, int kind)
+{
+    int i, j;
+
+    memset(s, 0, sizeof(*s));
+    switch (kind) {
+      case NURBS_RIPPLE:
+      case NURBS_TRIMMED:
+	setKnots(s, 8, 8, 4, 3);
+	for (i = 0; i < 8; i++) {
+	    for (j = 0; j < 8; j++) {
+		double x = 2.0 * i / 7 - 1, y = 2.0 * j / 7 - 1;
+
+		setPoint(s, i, j, x, y, 0.25 * sin(3 * (x*x + y*y)));
+	    }
+	}
+	if (kind == NURBS_TRIMMED) {
+	    addBoundary(s);
+	    addLoop(s, 33, 0.5, 0.5, 0.25, 1);
+	}
+	break;
+      case NURBS_RATIONAL:
+	/* The arc is exact with the middle weight sqrt(2)/2 */
+	setKnots(s, 3, 3, 3, 4);
+	for (i = 0; i < 3; i++) {
+	    for (j = 0; j < 3; j++) {
+		static const double arc[3][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 } };
+		double w = i == 1 ? sqrt(0.5) : 1;
+
+		setPoint(s, i, j, 0.8 * arc[i][0] * w, (j - 1) * w,
+			 0.8 * arc[i][1] * w);
+		s->control[i][j][3] = (GLfloat) w;
+	    }
+	}
+	break;
+      case NURBS_CONE:
+	setKnots(s, 4, 4, 4, 3);
+	for (i = 0; i < 4; i++) {
+	    for (j = 0; j < 4; j++) {
+		double r = i / 3.0, a = M_PI * j / 3;
+
+		setPoint(s, i, j, r * cos(a), r * sin(a), 1 - r);
+	    }
+	}
+	break;
+      default:
+	setKnots(s, 12, 12, 5, 3);
+	for (i = 0; i < 12; i++) {
+	    for (j = 0; j < 12; j++) {
+		double x = 2.0 * i / 11 - 1, y = 2.0 * j / 11 - 1;
+
+		setPoint(s, i, j, x, y,
+			 0.5 * exp(-4 * (x*x + y*y)) + 0.1 * x * y);
+	    }
+	}
+	if (kind == NURBS_HOLES) {
+	    addBoundary(s);
+	    addLoop(s, 17, 0.3, 0.3, 0.15, 1);
+	    /*
+	    ** With a radius of 0.2, a corner where the triangle crosses a
+	    ** patch boundary lands on a grid line of GLU_DOMAIN_DISTANCE 40,
+	    ** which gridWrap::outputFanWithPoint() asserts against.
+	    */
+	    addLoop(s, 4, 0.7, 0.6, 0.21, 1);
+	}
+	break;
+    }
+    s->name = surfaceNames[kind];
+}
+
+NurbsEvent *addEvent(NurbsOutput *out, int kind)
+{
+    NurbsEvent *e;
+
+    if (out->eventCount >= out->eventMax) {
+	out->eventMax = out->eventMax ? 2 * out->eventMax : 256;
+	out->events = (NurbsEvent *)
+	    realloc(out->events, out->eventMax * sizeof(NurbsEvent));
+	if (out->events == NULL) abort();
+    }
+    e = &out->events[out->eventCount++];
+    memset(e, 0, sizeof(*e));
+    e->kind = kind;
+    out->counts[kind]++;
+    return e;
+}
+
+static void GLAPIENTRY beginData(GLenum type, void *data)
+{
+    addEvent((NurbsOutput *) data, NURBS_BEGIN)->type = type;
+}
+
+static void GLAPIENTRY vertexData(GLfloat *vertex, void *data)
+{
+    memcpy(addEvent((NurbsOutput *) data, NURBS_VERTEX)->coords, vertex,
+	   3 * sizeof(GLfloat));
+}
+
+static void GLAPIENTRY normalData(GLfloat *normal, void *data)
+{
+    memcpy(addEvent((NurbsOutput *) data, NURBS_NORMAL)->coords, normal,
+	   3 * sizeof(GLfloat));
+}
+
+static void GLAPIENTRY texcoordData(GLfloat *texcoord, void *data)
+{
+    memcpy(addEvent((NurbsOutput *) data, NURBS_TEXCOORD)->coords, texcoord,
+	   2 * sizeof(GLfloat));
+}
+
+static void GLAPIENTRY endData(void *data)
+{
+    addEvent((NurbsOutput *) data, NURBS_END);
+}
+
+static void GLAPIENTRY vertexBuffer(GLsizei vertexCount,
+				    const GLfloat *vertices,
+				    GLsizei indexCount, const GLuint *indices,
+				    GLboolean changed, void *data)
+{
+    NurbsOutput *out = (NurbsOutput *) data;
+    size_t size = (size_t) vertexCount * 8 * sizeof(GLfloat);
+
+    out->bufferCount++;
+    out->changed = changed;
+    out->vertices = (GLfloat *) realloc(out->vertices, size + 1);
+    out->indices = (GLuint *)
+	realloc(out->indices, indexCount * sizeof(GLuint) + 1);
+    if (out->vertices == NULL || out->indices == NULL) abort();
+    memcpy(out->vertices, vertices, size);
+    memcpy(out->indices, indices, indexCount * sizeof(GLuint));
+    out->vertexCount = vertexCount;
+    out->indexCount = indexCount;
+}
+
+/* The error callback is given no data */
+static GLenum lastError;
+
+static void GLAPIENTRY error(GLenum errorCode)
+{
+    lastError = errorCode;
+}
+
+GLUnurbs *newNurbs(GLenum samplingMethod, GLfloat tolerance)
+{
+    static const GLfloat identity[16] = {
+	1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1,
+    };
+    static const GLint viewport[4] = { 0, 0, 512, 512 };
+    GLUnurbs *nurb = gluNewNurbsRenderer();
+
+    if (nurb == NULL) abort();
+    gluNurbsProperty(nurb, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+    gluNurbsProperty(nurb, GLU_AUTO_LOAD_MATRIX, GL_FALSE);
+    gluLoadSamplingMatrices(nurb, identity, identity, viewport);
+    gluNurbsProperty(nurb, GLU_SAMPLING_METHOD, (GLfloat) samplingMethod);
+    if (samplingMethod == GLU_DOMAIN_DISTANCE) {
+	gluNurbsProperty(nurb, GLU_U_STEP, tolerance);
+	gluNurbsProperty(nurb, GLU_V_STEP, tolerance);
+    } else if (samplingMethod == GLU_PARAMETRIC_ERROR) {
+	gluNurbsProperty(nurb, GLU_PARAMETRIC_TOLERANCE, tolerance);
+    } else {
+	gluNurbsProperty(nurb, GLU_SAMPLING_TOLERANCE, tolerance);
+    }
+    gluNurbsCallback(nurb, GLU_NURBS_BEGIN_DATA, (_GLUfuncptr) beginData);
+    gluNurbsCallback(nurb, GLU_NURBS_VERTEX_DATA, (_GLUfuncptr) vertexData);
+    gluNurbsCallback(nurb, GLU_NURBS_NORMAL_DATA, (_GLUfuncptr) normalData);
+    gluNurbsCallback(nurb, GLU_NURBS_TEXTURE_COORD_DATA,
+		     (_GLUfuncptr) texcoordData);
+    gluNurbsCallback(nurb, GLU_NURBS_END_DATA, (_GLUfuncptr) endData);
+    gluNurbsCallback(nurb, GLU_NURBS_VERTEX_BUFFER_EXT,
+		     (_GLUfuncptr) vertexBuffer);
+    gluNurbsCallback(nurb, GLU_NURBS_ERROR, (_GLUfuncptr) error);
+    return nurb;
+}
+
+/* The parameter a B-spline's control point i has the most weight at */
+static GLfloat greville(const GLfloat *knots, int i, int order)
+{
+    double sum = 0;
+    int k;
+
+    for (k = 1; k < order; k++) {
+	sum += knots[i + k];
+    }
+    return (GLfloat) (sum / (order - 1));
+}
+
+void drawSurface(GLUnurbs *nurb, const NurbsSurface *s, int flags,
+		 NurbsOutput *out)
+{
+    GLfloat texcoords[NURBS_MAX_CONTROL][NURBS_MAX_CONTROL][2];
+    int t;
+
+    lastError = 0;
+    gluNurbsCallbackData(nurb, out);
+    gluBeginSurface(nurb);
+    gluNurbsSurface(nurb, s->uCount + s->order, (GLfloat *) s->knots[0],
+		    s->vCount + s->order, (GLfloat *) s->knots[1],
+		    NURBS_MAX_CONTROL * 4, 4, (GLfloat *) &s->control[0][0][0],
+		    s->order, s->order,
+		    s->dimension == 4 ? GL_MAP2_VERTEX_4 : GL_MAP2_VERTEX_3);
+    if (flags & NURBS_TEXTURE) {
+	int i, j;
+
+	for (i = 0; i < s->uCount; i++) {
+	    for (j = 0; j < s->vCount; j++) {
+		texcoords[i][j][0] = greville(s->knots[0], i, s->order);
+		texcoords[i][j][1] = greville(s->knots[1], j, s->order);
+	    }
+	}
+	gluNurbsSurface(nurb, s->uCount + s->order, (GLfloat *) s->knots[0],
+			s->vCount + s->order, (GLfloat *) s->knots[1],
+			NURBS_MAX_CONTROL * 2, 2, &texcoords[0][0][0],
+			s->order, s->order, GL_MAP2_TEXTURE_COORD_2);
+    }
+    for (t = 0; t < s->trimCount; t++) {
+	gluBeginTrim(nurb);
+	gluPwlCurve(nurb, s->trimSizes[t], (GLfloat *) &s->trims[t][0][0], 2,
+		    GLU_MAP1_TRIM_2);
+	gluEndTrim(nurb);
+    }
+    gluEndSurface(nurb);
+    out->error = lastError;
+}
+
+void freeOutput(NurbsOutput *out)
+{
+    free(out->events);
+    free(out->vertices);
+    free(out->indices);
+    memset(out, 0, sizeof(*out));
+}
+
+/* Index of the next event at or after i not ignored, or count */
+static int nextEvent(const NurbsOutput *out, int i, int ignore)
+{
+    while (i < out->eventCount && (ignore & (1 << out->events[i].kind))) {
+	i++;
+    }
+    return i;
+}
+
+int compareEvents(const NurbsOutput *a, const NurbsOutput *b, int ignore)
+{
+    int i, j, kind, differences = 0;
+
+    for (kind = 0; kind <= NURBS_END; kind++) {
+	if (!(ignore & (1 << kind)) && a->counts[kind] != b->counts[kind]) {
+	    return -1;
+	}
+    }
+    i = nextEvent(a, 0, ignore);
+    j = nextEvent(b, 0, ignore);
+    while (i < a->eventCount && j < b->eventCount) {
+	const NurbsEvent *e = &a->events[i], *f = &b->events[j];
+
+	if (e->kind != f->kind || e->type != f->type ||
+	    memcmp(e->coords, f->coords, sizeof(e->coords)) != 0) {
+	    differences++;
+	}
+	i = nextEvent(a, i + 1, ignore);
+	j = nextEvent(b, j + 1, ignore);
+    }
+    return differences;
+}
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** Helpers for the NURBS tests: a few surfaces, NURBS objects that give
+** their triangles back through the GLU_NURBS_TESSELLATOR callbacks, and
+** records of what those callbacks are given.
+*/
+
+#ifndef __nurbscheck_h__
+#define __nurbscheck_h__
+
+#include <GL/glu.h>
+
+#define NURBS_MAX_CONTROL	12
+#define NURBS_MAX_ORDER		5
+#define NURBS_MAX_TRIMS		3
+#define NURBS_MAX_TRIM_POINTS	65
+
+/*
+** A surface over [0, 1] x [0, 1] with uniform clamped knots, and closed
+** piecewise linear trim loops: the first one counterclockwise around the
+** domain, any others clockwise holes.
+*/
+typedef struct {
+    const char *name;
+    int uCount, vCount;		/* control points */
+    int order;			/* in both directions */
+    int dimension;		/* 3, or 4 for a rational surface */
+    GLfloat knots[2][NURBS_MAX_CONTROL + NURBS_MAX_ORDER];
+    GLfloat control[NURBS_MAX_CONTROL][NURBS_MAX_CONTROL][4];
+    int trimCount;
+    int trimSizes[NURBS_MAX_TRIMS];
+    GLfloat trims[NURBS_MAX_TRIMS][NURBS_MAX_TRIM_POINTS][2];
+} NurbsSurface;
+
+/* The surfaces makeSurface() makes */
+enum {
+    NURBS_RIPPLE,		/* bicubic 8x8, like glu-bench's */
+    NURBS_RATIONAL,		/* quadratic, a quarter cylinder */
+    NURBS_CONE,			/* one edge collapsed to a point */
+    NURBS_QUARTIC,		/* order 5, 12x12, with a bump */
+    NURBS_TRIMMED,		/* the ripple, with a boundary and a hole */
+    NURBS_HOLES,		/* the quartic, with two holes */
+    NURBS_SURFACES
+};
+
+extern void makeSurface(NurbsSurface *surface, int kind);
+
+/* One callback, in the order they were made */
+typedef struct {
+    enum {
+	NURBS_BEGIN, NURBS_VERTEX, NURBS_NORMAL, NURBS_TEXCOORD, NURBS_END,
+    } kind;
+    GLenum type;		/* of a primitive */
+    GLfloat coords[3];		/* of a vertex, normal or texcoord */
+} NurbsEvent;
+
+typedef struct {
+    NurbsEvent *events;
+    int eventCount, eventMax;
+    int counts[NURBS_END + 1];	/* events of each kind */
+    GLenum error;		/* last error reported, or 0 */
+
+    /*
+    ** GLU_NURBS_VERTEX_BUFFER_EXT calls, and a copy of what the last one
+    ** was given: x y z, nx ny nz, s t per vertex, and three indices per
+    ** triangle.
+    */
+    int bufferCount;
+    GLboolean changed;
+    GLfloat *vertices;
+    GLsizei vertexCount;
+    GLuint *indices;
+    GLsizei indexCount;
+} NurbsOutput;
+
+/*
+** Adds an event of the given kind to out, and returns it to be filled in;
+** for callbacks a test installs in place of the ones newNurbs() does.
+** Exits when out of memory.
+*/
+extern NurbsEvent *addEvent(NurbsOutput *out, int kind);
+
+/* Flags for drawSurface() */
+/*
+** The texture map has the knots of the vertex map, with its control
+** points at the Greville abscissae so that it maps (u, v) to itself: a
+** map with other breakpoints has its patches split to the vertex map's,
+** which fails an assert in patch.cc.
+*/
+#define NURBS_TEXTURE	0x1	/* add a GL_MAP2_TEXTURE_COORD_2 map */
+
+/*
+** A NURBS object in GLU_NURBS_TESSELLATOR mode with the given sampling
+** method and tolerance (in pixels, or the steps of GLU_DOMAIN_DISTANCE),
+** its sampling matrices mapping [-1, 1] x [-1, 1] to 512 x 512 pixels,
+** and callbacks that record into the NurbsOutput passed to drawSurface(),
+** including the vertex buffer callback of GLU_NURBS_RETAINED_EXT.
+*/
+extern GLUnurbs *newNurbs(GLenum samplingMethod, GLfloat tolerance);
+
+/*
+** Draws surface with the NURBS object and records its callbacks in out,
+** which must be zeroed or freed.
+*/
+extern void drawSurface(GLUnurbs *nurb, const NurbsSurface *surface,
+			int flags, NurbsOutput *out);
+extern void freeOutput(NurbsOutput *out);
+
+/*
+** Number of callbacks that differ between two runs, ignoring the kinds
+** of events set in ignore (as 1 << kind), or -1 if their counts differ.
+** Values must be the same to the bit.
+*/
+extern int compareEvents(const NurbsOutput *a, const NurbsOutput *b,
+			 int ignore);
+
+#endif /* __nurbscheck_h__ */
@@ -0,0 +1,316 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** gluProjectvEXT and gluUnProjectvEXT map arrays of points, two at a time
+** where SIMD is available.  Every point must come out as gluProject and
+** gluUnProject map it on its own: bit for bit for gluUnProjectvEXT, and
+** to the last few bits for gluProjectvEXT, which multiplies by the
+** composed matrix.  A point with w == 0, at either place in a pair or
+** alone at the end, makes both return GL_FALSE and is left as it was,
+** while the others are still written, also when the output overwrites
+** the input.  A singular matrix writes nothing.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <GL/glu.h>
+#include "check.h"
+
+#define MAX_POINTS	40
+
+/* Left in the outputs, so that points that are not written show */
+#define UNWRITTEN	12345.0
+
+static double randomUnit(unsigned *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (double) (*seed >> 8) / 16777216.0;
+}
+
+static void identity(GLdouble m[16])
+{
+    int i;
+
+    for (i = 0; i < 16; i++) {
+	m[i] = i % 5 == 0;
+    }
+}
+
+/* A camera 10 units back, turned about the x and y axes */
+static void viewMatrix(GLdouble m[16])
+{
+    const double a = 0.6, b = -1.1;
+
+    identity(m);
+    m[0] = cos(b);
+    m[2] = -sin(b);
+    m[4] = sin(a) * sin(b);
+    m[5] = cos(a);
+    m[6] = sin(a) * cos(b);
+    m[8] = cos(a) * sin(b);
+    m[9] = -sin(a);
+    m[10] = cos(a) * cos(b);
+    m[12] = 0.25;
+    m[13] = -0.5;
+    m[14] = -10;
+}
+
+/* glFrustum(l, r, b, t, n, f), column-major */
+static void frustum(GLdouble m[16], double l, double r, double b, double t,
+		    double n, double f)
+{
+    memset(m, 0, 16 * sizeof(GLdouble));
+    m[0] = 2 * n / (r - l);
+    m[5] = 2 * n / (t - b);
+    m[8] = (r + l) / (r - l);
+    m[9] = (t + b) / (t - b);
+    m[10] = -(f + n) / (f - n);
+    m[11] = -1;
+    m[14] = -2 * f * n / (f - n);
+}
+
+/* glOrtho(l, r, b, t, n, f), column-major */
+static void ortho(GLdouble m[16], double l, double r, double b, double t,
+		  double n, double f)
+{
+    identity(m);
+    m[0] = 2 / (r - l);
+    m[5] = 2 / (t - b);
+    m[10] = -2 / (f - n);
+    m[12] = -(r + l) / (r - l);
+    m[13] = -(t + b) / (t - b);
+    m[14] = -(f + n) / (f - n);
+}
+
+/*
+** Matrices whose products and inverse are exact: a scale and shift that
+** keeps z, and a projection that swaps z and w.  An object point with
+** z == 0 has w == 0, and so does a window point with z == 0.5.
+*/
+static void exactMatrices(GLdouble model[16], GLdouble proj[16])
+{
+    identity(model);
+    model[0] = 2;
+    model[5] = 0.5;
+    model[12] = 1;
+    model[13] = -0.25;
+    identity(proj);
+    proj[10] = proj[15] = 0;
+    proj[11] = proj[14] = 1;
+}
+
+static const GLint viewports[][4] = {
+    { 0, 0, 640, 480 },
+    { 10, -20, 333, 77 },
+};
+
+static const int counts[] = { 0, 1, 2, 3, 7, 8, 33, MAX_POINTS };
+
+static int closeEnough(double a, double b)
+{
+    return fabs(a - b) <= 1e-9 * (fabs(b) > 1 ? fabs(b) : 1);
+}
+
+/*
+** Compares gluProjectvEXT with gluProject for count points, with the
+** output in a separate array and in place.
+*/
+static void checkProject(const GLdouble model[16], const GLdouble proj[16],
+			 const GLint viewport[4], const GLdouble *obj,
+			 int count)
+{
+    GLdouble expected[MAX_POINTS * 3], win[MAX_POINTS * 3];
+    GLboolean mapped[MAX_POINTS];
+    GLint expectedResult = GL_TRUE;
+    int i, pass;
+
+    for (i = 0; i < count; i++) {
+	mapped[i] = gluProject(obj[3*i], obj[3*i+1], obj[3*i+2], model, proj,
+			       viewport, &expected[3*i], &expected[3*i+1],
+			       &expected[3*i+2]);
+	if (!mapped[i]) expectedResult = GL_FALSE;
+    }
+    for (pass = 0; pass < 2; pass++) {
+	const GLdouble *in = pass == 0 ? obj : win;
+	int differ = 0;
+
+	for (i = 0; i < count * 3; i++) {
+	    win[i] = pass == 0 ? UNWRITTEN : obj[i];
+	}
+	CHECK(gluProjectvEXT(count, in, model, proj, viewport, win) ==
+	      expectedResult);
+	for (i = 0; i < count * 3; i++) {
+	    if (mapped[i / 3]) {
+		differ += !closeEnough(win[i], expected[i]);
+	    } else {
+		differ += win[i] != (pass == 0 ? UNWRITTEN : obj[i]);
+	    }
+	}
+	CHECK(differ == 0);
+    }
+}
+
+/* As checkProject, for gluUnProjectvEXT, to the bit */
+static void checkUnProject(const GLdouble model[16], const GLdouble proj[16],
+			   const GLint viewport[4], const GLdouble *win,
+			   int count)
+{
+    GLdouble expected[MAX_POINTS * 3], obj[MAX_POINTS * 3];
+    GLboolean mapped[MAX_POINTS];
+    GLint expectedResult = GL_TRUE;
+    int i, pass;
+
+    for (i = 0; i < count; i++) {
+	mapped[i] = gluUnProject(win[3*i], win[3*i+1], win[3*i+2], model,
+				 proj, viewport, &expected[3*i],
+				 &expected[3*i+1], &expected[3*i+2]);
+	if (!mapped[i]) expectedResult = GL_FALSE;
+    }
+    for (pass = 0; pass < 2; pass++) {
+	const GLdouble *in = pass == 0 ? win : obj;
+	int differ = 0;
+
+	for (i = 0; i < count * 3; i++) {
+	    obj[i] = pass == 0 ? UNWRITTEN : win[i];
+	}
+	CHECK(gluUnProjectvEXT(count, in, model, proj, viewport, obj) ==
+	      expectedResult);
+	for (i = 0; i < count * 3; i++) {
+	    if (mapped[i / 3]) {
+		differ += memcmp(&obj[i], &expected[i], sizeof(GLdouble)) != 0;
+	    } else {
+		differ += obj[i] != (pass == 0 ? UNWRITTEN : win[i]);
+	    }
+	}
+	CHECK(differ == 0);
+    }
+}
+
+static void testCamera(const char *name, const GLdouble model[16],
+		       const GLdouble proj[16], unsigned *seed)
+{
+    GLdouble points[MAX_POINTS * 3];
+    size_t v, c;
+    int i;
+
+    for (v = 0; v < COUNT(viewports); v++) {
+	for (c = 0; c < COUNT(counts); c++) {
+	    const GLint *viewport = viewports[v];
+
+	    snprintf(testName, sizeof(testName), "%s, viewport %d, %d points",
+		     name, (int) v, counts[c]);
+	    for (i = 0; i < counts[c]; i++) {
+		points[3*i] = 4 * randomUnit(seed) - 2;
+		points[3*i+1] = 4 * randomUnit(seed) - 2;
+		points[3*i+2] = 4 * randomUnit(seed) - 2;
+	    }
+	    checkProject(model, proj, viewport, points, counts[c]);
+	    for (i = 0; i < counts[c]; i++) {
+		points[3*i] = viewport[0] + viewport[2] * randomUnit(seed);
+		points[3*i+1] = viewport[1] + viewport[3] * randomUnit(seed);
+		points[3*i+2] = randomUnit(seed);
+	    }
+	    checkUnProject(model, proj, viewport, points, counts[c]);
+	}
+    }
+}
+
+/*
+** Points with w == 0 first and second in a pair, both, and last of an
+** odd count, among points that map.
+*/
+static void testZeroW(unsigned *seed)
+{
+    static const int zeros[][3] = {
+	{ 0, -1, -1 },
+	{ 1, -1, -1 },
+	{ 4, 5, -1 },
+	{ 2, 7, 8 },
+    };
+    GLdouble model[16], proj[16], points[9 * 3];
+    GLdouble win[3] = { 1, 2, 3 }, obj[3] = { 1, 2, 3 };
+    size_t z;
+    int i, j, k;
+
+    exactMatrices(model, proj);
+    snprintf(testName, sizeof(testName), "w == 0, reference");
+    CHECK(!gluProject(1, 2, 0, model, proj, viewports[0], &win[0], &win[1],
+		      &win[2]));
+    CHECK(!gluUnProject(100, 200, 0.5, model, proj, viewports[0], &obj[0],
+			&obj[1], &obj[2]));
+    CHECK(win[0] == 1 && obj[0] == 1);
+
+    for (z = 0; z < COUNT(zeros); z++) {
+	for (k = 8; k <= 9; k++) {
+	    snprintf(testName, sizeof(testName), "w == 0, case %d, %d points",
+		     (int) z, k);
+	    for (i = 0; i < k; i++) {
+		int zero = 0;
+
+		for (j = 0; j < 3; j++) {
+		    zero |= zeros[z][j] == i;
+		}
+		points[3*i] = 4 * randomUnit(seed) - 2;
+		points[3*i+1] = 4 * randomUnit(seed) - 2;
+		points[3*i+2] = zero ? 0 : 1 + randomUnit(seed);
+	    }
+	    checkProject(model, proj, viewports[1], points, k);
+	    for (i = 0; i < k; i++) {
+		points[3*i+2] = points[3*i+2] == 0 ? 0.5 : randomUnit(seed) / 4;
+	    }
+	    checkUnProject(model, proj, viewports[1], points, k);
+	}
+    }
+}
+
+static void testErrors(void)
+{
+    GLdouble model[16], proj[16], points[6] = { 1, 2, 0.5, 3, 4, 0.25 };
+    GLdouble out[6];
+    int i;
+
+    viewMatrix(model);
+    memset(proj, 0, sizeof(proj));
+    for (i = 0; i < 6; i++) {
+	out[i] = UNWRITTEN;
+    }
+    snprintf(testName, sizeof(testName), "singular matrix");
+    CHECK(gluUnProjectvEXT(2, points, model, proj, viewports[0], out) ==
+	  GL_FALSE);
+    for (i = 0; i < 6; i++) {
+	CHECK(out[i] == UNWRITTEN);
+    }
+
+    snprintf(testName, sizeof(testName), "negative count");
+    frustum(proj, -1, 1, -1, 1, 1, 100);
+    CHECK(gluProjectvEXT(-1, points, model, proj, viewports[0], out) ==
+	  GL_FALSE);
+    CHECK(gluUnProjectvEXT(-1, points, model, proj, viewports[0], out) ==
+	  GL_FALSE);
+}
+
+int main(void)
+{
+    GLdouble model[16], proj[16];
+    unsigned seed = 1;
+
+    viewMatrix(model);
+    frustum(proj, -1, 1, -0.75, 0.75, 1, 100);
+    testCamera("perspective", model, proj, &seed);
+    frustum(proj, -0.5, 1.5, -1, 0.25, 2, 30);
+    testCamera("off-center perspective", model, proj, &seed);
+    ortho(proj, -3, 3, -2, 2, 1, 20);
+    testCamera("orthographic", model, proj, &seed);
+    exactMatrices(model, proj);
+    testCamera("exact", model, proj, &seed);
+    testZeroW(&seed);
+    testErrors();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
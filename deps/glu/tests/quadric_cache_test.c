@@ -0,0 +1,327 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** A quadric object records what gluCylinder, gluPartialDisk, gluDisk and
+** gluSphere draw, and draws it again from vertex arrays when a call is
+** repeated with the same arguments and quadric state.  The first call and
+** the repeated ones must draw the primitives, vertices, normals and
+** texture coordinates that quad.c without the cache draws in immediate
+** mode, and leave the same normal and texture coordinate current, for
+** every normal mode, orientation and draw style, with and without texture
+** coordinates, after the state changes between calls, after shapes were
+** evicted, for shapes too big to keep, and for arguments that are errors.
+** No normal may be made from memory left uninitialized.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <GL/glu.h>
+#include "glrecord.h"
+#include "check.h"
+
+/* quad.c built with GLU_QUADRIC_IMMEDIATE; see meson.build */
+extern GLUquadric * GLAPIENTRY immediateNewQuadric(void);
+extern void GLAPIENTRY immediateDeleteQuadric(GLUquadric *);
+extern void GLAPIENTRY immediateQuadricCallback(GLUquadric *, GLenum,
+						_GLUfuncptr);
+extern void GLAPIENTRY immediateQuadricNormals(GLUquadric *, GLenum);
+extern void GLAPIENTRY immediateQuadricTexture(GLUquadric *, GLboolean);
+extern void GLAPIENTRY immediateQuadricOrientation(GLUquadric *, GLenum);
+extern void GLAPIENTRY immediateQuadricDrawStyle(GLUquadric *, GLenum);
+extern void GLAPIENTRY immediateCylinder(GLUquadric *, GLdouble, GLdouble,
+					 GLdouble, GLint, GLint);
+extern void GLAPIENTRY immediateDisk(GLUquadric *, GLdouble, GLdouble,
+				     GLint, GLint);
+extern void GLAPIENTRY immediatePartialDisk(GLUquadric *, GLdouble, GLdouble,
+					    GLint, GLint, GLdouble, GLdouble);
+extern void GLAPIENTRY immediateSphere(GLUquadric *, GLdouble, GLint, GLint);
+
+enum { CYLINDER, DISK, PARTIAL_DISK, SPHERE };
+
+typedef struct {
+    const char *name;
+    int shape;
+    GLdouble params[4];		/* radii, height, angles */
+    GLint slices, stacks;	/* stacks are loops for a disk */
+} Call;
+
+/* More shapes than a quadric keeps, so later ones evict earlier ones */
+static const Call calls[] = {
+    { "cylinder", CYLINDER, { 1, 1, 2 }, 16, 4 },
+    { "cylinder, wider base", CYLINDER, { 1.5, 1, 2 }, 16, 4 },
+    { "cylinder, wider top", CYLINDER, { 1, 1.5, 2 }, 16, 4 },
+    { "cylinder, longer", CYLINDER, { 1, 1, 3 }, 16, 4 },
+    { "cylinder, one more slice", CYLINDER, { 1, 1, 2 }, 17, 4 },
+    { "cylinder, one more stack", CYLINDER, { 1, 1, 2 }, 16, 5 },
+    { "cone", CYLINDER, { 1, 0, 2 }, 7, 3 },
+    { "flared cylinder", CYLINDER, { 0.5, 1.5, 1 }, 30, 1 },
+    { "cylinder, many slices", CYLINDER, { 1, 1, 1 }, 300, 2 },
+    { "disk", DISK, { 0.5, 1 }, 20, 3 },
+    { "disk without hole", DISK, { 0, 1 }, 9, 1 },
+    { "partial disk", PARTIAL_DISK, { 0.25, 1, 30, 135 }, 12, 4 },
+    { "partial disk, turned", PARTIAL_DISK, { 0.25, 1, 60, 135 }, 12, 4 },
+    { "partial disk, wider", PARTIAL_DISK, { 0.25, 1, 30, 160 }, 12, 4 },
+    { "partial disk, full sweep", PARTIAL_DISK, { 0, 1, -90, 360 }, 10, 2 },
+    { "partial disk, backwards", PARTIAL_DISK, { 0.5, 2, 45, -200 }, 8, 3 },
+    { "sphere", SPHERE, { 1 }, 24, 12 },
+    { "sphere, bigger", SPHERE, { 1.5 }, 24, 12 },
+    { "flat cone, arguments like the sphere's", CYLINDER, { 1 }, 24, 12 },
+    { "small sphere", SPHERE, { 2 }, 5, 2 },
+    { "sphere, too big to keep", SPHERE, { 1 }, 16, 3000 },
+    { "cylinder, 1 slice", CYLINDER, { 1, 1, 1 }, 1, 1 },
+    { "sphere, no stacks", SPHERE, { 1 }, 8, 0 },
+    { "disk, negative radius", DISK, { -1, 1 }, 8, 2 },
+};
+
+typedef struct {
+    GLRecordPrimitive *primitives;
+    int primitiveCount;
+    GLRecordVertex *vertices;
+    int vertexCount;
+    GLint drawArraysCalls;
+    int errors;
+} Drawing;
+
+static int errorCount;
+
+static void GLAPIENTRY countError(GLenum errorCode)
+{
+    (void) errorCode;
+    errorCount++;
+}
+
+static void drawCall(const Call *c, GLUquadric *quadric, int immediate)
+{
+    const GLdouble *p = c->params;
+
+    switch (c->shape) {
+      case CYLINDER:
+	(immediate ? immediateCylinder : gluCylinder)(quadric, p[0], p[1],
+						       p[2], c->slices,
+						       c->stacks);
+	break;
+      case DISK:
+	(immediate ? immediateDisk : gluDisk)(quadric, p[0], p[1], c->slices,
+					      c->stacks);
+	break;
+      case PARTIAL_DISK:
+	(immediate ? immediatePartialDisk : gluPartialDisk)(quadric, p[0],
+							    p[1], c->slices,
+							    c->stacks, p[2],
+							    p[3]);
+	break;
+      default:
+	(immediate ? immediateSphere : gluSphere)(quadric, p[0], c->slices,
+						  c->stacks);
+	break;
+    }
+}
+
+/*
+** Draws from a clean GL state, and one more point after the shape to see
+** the normal and texture coordinate it left current.
+*/
+static void draw(const Call *c, GLUquadric *quadric, int immediate,
+		 Drawing *out)
+{
+    glRecordReset();
+    errorCount = 0;
+    drawCall(c, quadric, immediate);
+    glBegin(GL_POINTS);
+    glVertex3f(0, 0, 0);
+    glEnd();
+
+    out->primitives = glRecord.primitives;
+    out->primitiveCount = glRecord.primitiveCount;
+    out->vertices = glRecord.vertices;
+    out->vertexCount = glRecord.vertexCount;
+    out->drawArraysCalls = glRecord.drawArraysCalls;
+    out->errors = errorCount;
+    glRecord.primitives = NULL;
+    glRecord.primitiveCount = 0;
+    glRecord.vertices = NULL;
+    glRecord.vertexCount = 0;
+}
+
+static void freeDrawing(Drawing *d)
+{
+    free(d->primitives);
+    free(d->vertices);
+}
+
+/* Number of primitives and vertices that differ, or -1 if counts differ */
+static int compareDrawings(const Drawing *a, const Drawing *b)
+{
+    int i, differ = 0;
+
+    if (a->primitiveCount != b->primitiveCount ||
+	a->vertexCount != b->vertexCount) {
+	return -1;
+    }
+    for (i = 0; i < a->primitiveCount; i++) {
+	differ += a->primitives[i].mode != b->primitives[i].mode ||
+		  a->primitives[i].first != b->primitives[i].first ||
+		  a->primitives[i].count != b->primitives[i].count;
+    }
+    for (i = 0; i < a->vertexCount; i++) {
+	const GLRecordVertex *u = &a->vertices[i], *v = &b->vertices[i];
+
+	differ += memcmp(u, v, sizeof(*u)) != 0;
+    }
+    return differ;
+}
+
+/*
+** Vertices with a normal longer than 1, or much shorter, which would have
+** been made from memory the drawing code never filled in.  The lines
+** along a cone take the horizontal part of its normal, which is shorter,
+** and none at all for a flat one.
+*/
+static int badNormals(const Drawing *d)
+{
+    int i, bad = 0;
+
+    for (i = 0; i < d->vertexCount; i++) {
+	const GLfloat *n = d->vertices[i].normal;
+	double length = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+
+	bad += !((length > 0.5 || length == 0) && length < 1 + 1e-5);
+    }
+    return bad;
+}
+
+static const GLenum normalModes[] = { GLU_SMOOTH, GLU_FLAT, GLU_NONE };
+static const GLenum orientations[] = { GLU_OUTSIDE, GLU_INSIDE };
+static const GLenum drawStyles[] = {
+    GLU_FILL, GLU_LINE, GLU_SILHOUETTE, GLU_POINT
+};
+
+static GLUquadric *cached, *immediate;
+static int fromArrays;
+
+static void setState(GLenum normals, GLboolean textureCoords,
+		     GLenum orientation, GLenum drawStyle)
+{
+    gluQuadricNormals(cached, normals);
+    gluQuadricTexture(cached, textureCoords);
+    gluQuadricOrientation(cached, orientation);
+    gluQuadricDrawStyle(cached, drawStyle);
+    immediateQuadricNormals(immediate, normals);
+    immediateQuadricTexture(immediate, textureCoords);
+    immediateQuadricOrientation(immediate, orientation);
+    immediateQuadricDrawStyle(immediate, drawStyle);
+}
+
+/* Draws the call in immediate mode, and twice with the cache */
+static void testCall(const Call *c, const char *when)
+{
+    Drawing reference, out;
+    int round;
+
+    draw(c, immediate, 1, &reference);
+    snprintf(testName, sizeof(testName), "%s, %s, immediate", c->name, when);
+    CHECK(reference.drawArraysCalls == 0);
+    CHECK(badNormals(&reference) == 0);
+    for (round = 0; round < 2; round++) {
+	snprintf(testName, sizeof(testName), "%s, %s, draw %d",
+		 c->name, when, round);
+	draw(c, cached, 0, &out);
+	CHECK(out.errors == reference.errors);
+	CHECK(compareDrawings(&out, &reference) == 0);
+	if (round == 1 && out.drawArraysCalls > 0) {
+	    fromArrays++;
+	}
+	freeDrawing(&out);
+    }
+    freeDrawing(&reference);
+}
+
+static void testStates(void)
+{
+    char when[80];
+    size_t n, t, o, d, k;
+
+    for (n = 0; n < COUNT(normalModes); n++) {
+	for (t = 0; t < 2; t++) {
+	    for (o = 0; o < COUNT(orientations); o++) {
+		for (d = 0; d < COUNT(drawStyles); d++) {
+		    setState(normalModes[n], (GLboolean) t, orientations[o],
+			     drawStyles[d]);
+		    snprintf(when, sizeof(when),
+			     "normals %d, texture %d, orientation %d, "
+			     "style %d", (int) normalModes[n], (int) t,
+			     (int) orientations[o], (int) drawStyles[d]);
+		    for (k = 0; k < COUNT(calls); k++) {
+			testCall(&calls[k], when);
+		    }
+		}
+	    }
+	}
+    }
+}
+
+/*
+** Shapes kept while others are drawn and evicted: the first few calls
+** again in reverse order after each of the others, and each call again
+** after one part of the quadric state changed and after it changed back,
+** while the shape drawn with the first state is still kept.
+*/
+static void testEviction(void)
+{
+    static const struct {
+	const char *name;
+	GLenum normals;
+	GLboolean textureCoords;
+	GLenum orientation, drawStyle;
+    } changes[] = {
+	{ "normals changed", GLU_FLAT, GL_TRUE, GLU_OUTSIDE, GLU_FILL },
+	{ "texture changed", GLU_SMOOTH, GL_FALSE, GLU_OUTSIDE, GLU_FILL },
+	{ "orientation changed", GLU_SMOOTH, GL_TRUE, GLU_INSIDE, GLU_FILL },
+	{ "style changed", GLU_SMOOTH, GL_TRUE, GLU_OUTSIDE, GLU_LINE },
+    };
+    size_t k, j;
+
+    setState(GLU_SMOOTH, GL_TRUE, GLU_OUTSIDE, GLU_FILL);
+    for (k = 0; k < COUNT(calls); k++) {
+	for (j = k < 4 ? k + 1 : 4; j > 0; j--) {
+	    testCall(&calls[j - 1], "kept");
+	}
+	testCall(&calls[k], "evicting");
+	for (j = 0; j < COUNT(changes); j++) {
+	    setState(changes[j].normals, changes[j].textureCoords,
+		     changes[j].orientation, changes[j].drawStyle);
+	    testCall(&calls[k], changes[j].name);
+	    setState(GLU_SMOOTH, GL_TRUE, GLU_OUTSIDE, GLU_FILL);
+	    testCall(&calls[k], "state changed back");
+	}
+    }
+}
+
+int main(void)
+{
+    cached = gluNewQuadric();
+    immediate = immediateNewQuadric();
+    if (cached == NULL || immediate == NULL) {
+	fprintf(stderr, "out of memory\n");
+	return 1;
+    }
+    gluQuadricCallback(cached, GLU_ERROR, (_GLUfuncptr) countError);
+    immediateQuadricCallback(immediate, GLU_ERROR, (_GLUfuncptr) countError);
+
+    testStates();
+    testEviction();
+    snprintf(testName, sizeof(testName), "shapes drawn from arrays");
+    CHECK(fromArrays > 0);
+
+    gluDeleteQuadric(cached);
+    immediateDeleteQuadric(immediate);
+    glRecordReset();
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
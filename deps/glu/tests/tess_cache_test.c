@@ -0,0 +1,293 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** With GLU_TESS_RESULT_CACHE_SIZE_EXT set, the output of recent polygons
+** is kept and replayed when the same contours come again.  Misses and
+** hits must give the triangles, edge flags and contours a tessellator
+** without the cache gives through the sweep, and the same callbacks as
+** each other: one GL_TRIANGLES primitive, or GL_LINE_LOOPs for the
+** boundary.  A hit must hand back this frame's vertex data, and repeat
+** the combine calls of the miss so the vertices it makes are this
+** frame's too.  The counters must count hits and misses, the least
+** recently used polygon must be evicted first, and any property that
+** changes the output must miss.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "tesscheck.h"
+#include "check.h"
+
+static const GLenum windingRules[] = {
+    GLU_TESS_WINDING_ODD, GLU_TESS_WINDING_NONZERO,
+    GLU_TESS_WINDING_POSITIVE, GLU_TESS_WINDING_NEGATIVE,
+    GLU_TESS_WINDING_ABS_GEQ_TWO,
+};
+
+#define POLYGONS 7
+
+static const char *const polygonNames[POLYGONS] = {
+    "hexagon", "clockwise octagon", "square with a hole", "7-pointed star",
+    "wavy, 1000 vertices", "scribble, 40 vertices", "nested squares",
+};
+
+/* The same polygons for every seed, in new storage each time */
+static void makePolygons(TessPolygon *polys, unsigned seed)
+{
+    addRegular(&polys[0], 6, 0, 0, 1, GL_FALSE);
+    addRegular(&polys[1], 8, 0, 0, 1, GL_TRUE);
+    addRegular(&polys[2], 4, 0, 0, 2, GL_FALSE);
+    addRegular(&polys[2], 4, 0, 0, 1, GL_TRUE);
+    addStar(&polys[3], 7, 3, 0, 0, 1);
+    addWavy(&polys[4], 1000, 0, 0, 1, &seed);
+    addScribble(&polys[5], 40, &seed);
+    addRegular(&polys[6], 4, 0, 0, 3, GL_FALSE);
+    addRegular(&polys[6], 4, 0, 0, 2, GL_FALSE);
+    addRegular(&polys[6], 4, 0, 0, 1, GL_FALSE);
+}
+
+static void freePolygons(TessPolygon *polys)
+{
+    int p;
+
+    for (p = 0; p < POLYGONS; p++) {
+	freePolygon(&polys[p]);
+    }
+}
+
+static double cacheCounter(GLUtesselator *tess, GLenum which)
+{
+    GLdouble value = -1;
+
+    gluGetTessProperty(tess, which, &value);
+    return value;
+}
+
+/* Number of vertices called back that are not from poly or out */
+static int foreignVertices(const TessOutput *out, const TessPolygon *poly)
+{
+    int i, j, count = 0;
+
+    for (i = 0; i < out->eventCount; i++) {
+	const TessVertex *data = out->events[i].data;
+	GLboolean ours;
+
+	if (out->events[i].kind != TESS_VERTEX) continue;
+	ours = data >= poly->vertices &&
+	       data < poly->vertices + poly->vertexCount;
+	for (j = 0; j < out->combineCount && !ours; j++) {
+	    ours = data == out->combined[j];
+	}
+	if (!ours) count++;
+    }
+    return count;
+}
+
+/* Number of primitives that are not of type */
+static int otherPrimitives(const TessOutput *out, GLenum type)
+{
+    int i, count = 0;
+
+    for (i = 0; i < out->eventCount; i++) {
+	if (out->events[i].kind == TESS_BEGIN &&
+	    out->events[i].value != type) {
+	    count++;
+	}
+    }
+    return count;
+}
+
+static void setFlagged(TessOutput *out)
+{
+    int i;
+
+    for (i = 0; i < out->triangleCount; i++) {
+	out->triangles[i].flags[0] = GL_TRUE;
+	out->triangles[i].flags[1] = GL_TRUE;
+	out->triangles[i].flags[2] = GL_TRUE;
+    }
+}
+
+/*
+** One polygon, missed and hit twice, against a tessellator without the
+** cache.  That one is given edge flags, so it takes the sweep like the
+** cache does; without edge flags they are all set.
+*/
+static void testPolygon(const TessPolygon *frames, int p, GLenum windingRule,
+			GLboolean boundaryOnly, int flags, unsigned *seed)
+{
+    GLUtesselator *tess = newTess(windingRule, boundaryOnly);
+    GLUtesselator *uncached = newTess(windingRule, boundaryOnly);
+    TessOutput reference = { 0 }, runs[3] = { { 0 } };
+    int r;
+
+    snprintf(testName, sizeof(testName), "%s, rule %d%s%s, uncached",
+	     polygonNames[p], windingRule,
+	     boundaryOnly ? ", boundary only" : "",
+	     flags ? ", edge flags" : "");
+    runTess(uncached, &frames[p], flags | TESS_EDGE_FLAGS, &reference);
+    CHECK(reference.error == 0);
+    if (!(flags & TESS_EDGE_FLAGS)) setFlagged(&reference);
+
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, 1);
+    for (r = 0; r < 3; r++) {
+	const TessPolygon *poly = &frames[r * POLYGONS + p];
+	TessOutput *out = &runs[r];
+
+	snprintf(testName, sizeof(testName), "%s, rule %d%s%s, %s",
+		 polygonNames[p], windingRule,
+		 boundaryOnly ? ", boundary only" : "",
+		 flags ? ", edge flags" : "", r == 0 ? "miss" : "hit");
+	runTess(tess, poly, flags, out);
+	CHECK(out->error == 0);
+	CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_HITS_EXT) == r);
+	CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_MISSES_EXT) == 1);
+	CHECK(compareTriangles(out, &reference) == 0);
+	CHECK(out->combineCount == reference.combineCount);
+	CHECK(foreignVertices(out, poly) == 0);
+	if (boundaryOnly) {
+	    CHECK(otherPrimitives(out, GL_LINE_LOOP) == 0);
+	    CHECK(compareEvents(out, &reference) == 0);
+	} else {
+	    CHECK(otherPrimitives(out, GL_TRIANGLES) == 0);
+	    CHECK(out->primitiveCount == (out->triangleCount > 0));
+	}
+	CHECK(coverageErrors(poly, windingRule, out, 200, seed) == 0);
+	if (r > 0) CHECK(compareEvents(out, &runs[0]) == 0);
+    }
+
+    for (r = 0; r < 3; r++) {
+	freeOutput(&runs[r]);
+    }
+    freeOutput(&reference);
+    gluDeleteTess(tess);
+    gluDeleteTess(uncached);
+}
+
+/*
+** Polygons 0, 1 and 2 in turn, twice, in a cache of size entries: a
+** cache of 2 always evicts the polygon that comes next.
+*/
+static void testEviction(const TessPolygon *polys, int size, int hits)
+{
+    GLUtesselator *tess = newTess(GLU_TESS_WINDING_ODD, GL_FALSE);
+    int i;
+
+    snprintf(testName, sizeof(testName), "eviction, cache %d", size);
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, size);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT) == size);
+    for (i = 0; i < 6; i++) {
+	TessOutput out = { 0 };
+
+	runTess(tess, &polys[i % 3], 0, &out);
+	freeOutput(&out);
+    }
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_HITS_EXT) == hits);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_MISSES_EXT) == 6 - hits);
+
+    /* Setting the size empties the cache and resets the counters */
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, size);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_HITS_EXT) == 0);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_MISSES_EXT) == 0);
+    gluDeleteTess(tess);
+}
+
+/* Each change of a property that the output depends on must miss. */
+static void testKey(const TessPolygon *poly)
+{
+    GLUtesselator *tess = newTess(GLU_TESS_WINDING_ODD, GL_FALSE);
+    TessOutput out = { 0 }, uncached = { 0 };
+    GLUtesselator *reference;
+    int misses = 0;
+
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, 8);
+
+#define RUN(what)							\
+    do {								\
+	snprintf(testName, sizeof(testName), "key, %s", what);		\
+	runTess(tess, poly, 0, &out);					\
+	freeOutput(&out);						\
+	CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_MISSES_EXT) ==	\
+	      ++misses);						\
+    } while (0)
+
+    RUN("first run");
+    gluTessProperty(tess, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
+    RUN("winding rule");
+    gluTessProperty(tess, GLU_TESS_BOUNDARY_ONLY, GL_TRUE);
+    RUN("boundary only");
+    gluTessNormal(tess, 0, 0, -1);
+    RUN("normal");
+    gluTessProperty(tess, GLU_TESS_BOUNDARY_ONLY, GL_FALSE);
+    snprintf(testName, sizeof(testName), "key, edge flags");
+    runTess(tess, poly, TESS_EDGE_FLAGS, &out);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_MISSES_EXT) == ++misses);
+
+    /* The last run against one with the same properties, uncached */
+    reference = newTess(GLU_TESS_WINDING_NONZERO, GL_FALSE);
+    gluTessNormal(reference, 0, 0, -1);
+    runTess(reference, poly, TESS_EDGE_FLAGS, &uncached);
+    CHECK(compareTriangles(&out, &uncached) == 0);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_HITS_EXT) == 0);
+#undef RUN
+
+    freeOutput(&out);
+    freeOutput(&uncached);
+    gluDeleteTess(reference);
+    gluDeleteTess(tess);
+}
+
+/* A size of 0 turns the cache off, and the fan is used again. */
+static void testDisabled(const TessPolygon *hexagon)
+{
+    GLUtesselator *tess = newTess(GLU_TESS_WINDING_ODD, GL_FALSE);
+    TessOutput out = { 0 };
+
+    snprintf(testName, sizeof(testName), "disabled");
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, 4);
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, 0);
+    runTess(tess, hexagon, 0, &out);
+    CHECK(out.primitiveCount == 1);
+    CHECK(otherPrimitives(&out, GL_TRIANGLE_FAN) == 0);
+    freeOutput(&out);
+    runTess(tess, hexagon, 0, &out);
+    CHECK(cacheCounter(tess, GLU_TESS_RESULT_CACHE_HITS_EXT) == 0);
+    freeOutput(&out);
+    gluDeleteTess(tess);
+}
+
+int main(void)
+{
+    TessPolygon frames[3 * POLYGONS] = { { 0 } };
+    unsigned seed = 10;
+    size_t r;
+    int f, p, b, flags;
+
+    for (f = 0; f < 3; f++) {
+	makePolygons(&frames[f * POLYGONS], 100);
+    }
+    for (p = 0; p < POLYGONS; p++) {
+	for (r = 0; r < COUNT(windingRules); r++) {
+	    for (b = 0; b < 2; b++) {
+		for (flags = 0; flags <= TESS_EDGE_FLAGS; flags++) {
+		    testPolygon(frames, p, windingRules[r], (GLboolean) b,
+				flags, &seed);
+		}
+	    }
+	}
+    }
+    testEviction(frames, 2, 0);
+    testEviction(frames, 3, 3);
+    testKey(&frames[2]);
+    testDisabled(&frames[0]);
+    for (f = 0; f < 3; f++) {
+	freePolygons(&frames[f * POLYGONS]);
+    }
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** With a GLU_TESS_INDEXED_TRIANGLES_EXT callback, a polygon comes back in
+** one call as a vertex array and counterclockwise triangles, from the
+** single-contour fan as well as from the sweep.  The triangles must be
+** those of the strips and fans a tessellator gives without the
+** callback, with each vertex listed once, with the result cache off and
+** on, and whether the cache hits or misses.  No primitives or edge flags
+** are called back alongside, and boundary-only output ignores the
+** callback.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "tesscheck.h"
+#include "check.h"
+
+static const GLenum windingRules[] = {
+    GLU_TESS_WINDING_ODD, GLU_TESS_WINDING_NONZERO,
+    GLU_TESS_WINDING_POSITIVE, GLU_TESS_WINDING_NEGATIVE,
+    GLU_TESS_WINDING_ABS_GEQ_TWO,
+};
+
+#define POLYGONS 8
+
+static const char *const polygonNames[POLYGONS] = {
+    "triangle", "hexagon", "clockwise octagon", "square with a hole",
+    "7-pointed star", "wavy, 1000 vertices", "scribble, 40 vertices",
+    "nested squares",
+};
+
+static void makePolygons(TessPolygon *polys, unsigned *seed)
+{
+    addRegular(&polys[0], 3, 0, 0, 1, GL_FALSE);
+    addRegular(&polys[1], 6, 0, 0, 1, GL_FALSE);
+    addRegular(&polys[2], 8, 0, 0, 1, GL_TRUE);
+    addRegular(&polys[3], 4, 0, 0, 2, GL_FALSE);
+    addRegular(&polys[3], 4, 0, 0, 1, GL_TRUE);
+    addStar(&polys[4], 7, 3, 0, 0, 1);
+    addWavy(&polys[5], 1000, 0, 0, 1, seed);
+    addScribble(&polys[6], 40, seed);
+    addRegular(&polys[7], 4, 0, 0, 3, GL_FALSE);
+    addRegular(&polys[7], 4, 0, 0, 2, GL_FALSE);
+    addRegular(&polys[7], 4, 0, 0, 1, GL_FALSE);
+}
+
+/* Number of triangles that are not counterclockwise */
+static int clockwiseTriangles(const TessOutput *out)
+{
+    int i, count = 0;
+
+    for (i = 0; i < out->triangleCount; i++) {
+	const GLdouble (*c)[3] = out->triangles[i].coords;
+
+	if ((c[1][0] - c[0][0]) * (c[2][1] - c[0][1]) -
+	    (c[2][0] - c[0][0]) * (c[1][1] - c[0][1]) <= 0) {
+	    count++;
+	}
+    }
+    return count;
+}
+
+/*
+** Indexed runs against runs of a second tessellator without the callback,
+** which takes the same path: the fan is not used with the cache on, or
+** with edge flags.  Edge flags are left out of indexed output.
+*/
+static void testPolygon(const TessPolygon *poly, const char *name,
+			GLenum windingRule, int cacheSize, unsigned *seed)
+{
+    GLUtesselator *tess = newTess(windingRule, GL_FALSE);
+    GLUtesselator *reference = newTess(windingRule, GL_FALSE);
+    int run, i;
+
+    gluTessProperty(tess, GLU_TESS_RESULT_CACHE_SIZE_EXT, cacheSize);
+    gluTessProperty(reference, GLU_TESS_RESULT_CACHE_SIZE_EXT, cacheSize);
+
+    /*
+    ** With the cache on, the second run hits.  Whether edge flags are
+    ** asked for is part of the key, so the third run misses.
+    */
+    for (run = 0; run < 3; run++) {
+	int flags = run == 2 ? TESS_EDGE_FLAGS : 0;
+	TessOutput indexed = { 0 }, strips = { 0 };
+
+	snprintf(testName, sizeof(testName), "%s, rule %d, cache %d, run %d%s",
+		 name, windingRule, cacheSize, run,
+		 run == 2 ? ", edge flags" : "");
+	runTess(reference, poly, flags, &strips);
+	for (i = 0; i < strips.triangleCount; i++) {
+	    strips.triangles[i].flags[0] = GL_TRUE;
+	    strips.triangles[i].flags[1] = GL_TRUE;
+	    strips.triangles[i].flags[2] = GL_TRUE;
+	}
+	runTess(tess, poly, TESS_INDEXED | flags, &indexed);
+	CHECK(indexed.error == 0);
+	CHECK(indexed.indexedCount == 1);
+	CHECK(indexed.indexErrors == 0);
+	CHECK(indexed.eventCount == 0);
+	CHECK(compareTriangles(&indexed, &strips) == 0);
+	CHECK(clockwiseTriangles(&indexed) == 0);
+	CHECK(coverageErrors(poly, windingRule, &indexed, 200, seed) == 0);
+	freeOutput(&indexed);
+	freeOutput(&strips);
+    }
+    if (cacheSize > 0) {
+	GLdouble hits;
+
+	gluGetTessProperty(tess, GLU_TESS_RESULT_CACHE_HITS_EXT, &hits);
+	CHECK(hits == 1);
+    }
+    gluDeleteTess(tess);
+    gluDeleteTess(reference);
+}
+
+/* Boundary-only output is the same with and without the callback. */
+static void testBoundary(const TessPolygon *poly, const char *name,
+			 GLenum windingRule)
+{
+    GLUtesselator *tess = newTess(windingRule, GL_TRUE);
+    TessOutput loops = { 0 }, indexed = { 0 };
+
+    snprintf(testName, sizeof(testName), "%s, rule %d, boundary only", name,
+	     windingRule);
+    runTess(tess, poly, 0, &loops);
+    runTess(tess, poly, TESS_INDEXED, &indexed);
+    CHECK(indexed.indexedCount == 0);
+    CHECK(compareEvents(&indexed, &loops) == 0);
+    freeOutput(&loops);
+    freeOutput(&indexed);
+    gluDeleteTess(tess);
+}
+
+int main(void)
+{
+    static const int cacheSizes[] = { 0, 4 };
+    TessPolygon polys[POLYGONS] = { { 0 } };
+    unsigned seed = 9;
+    size_t r, c;
+    int p;
+
+    makePolygons(polys, &seed);
+    for (p = 0; p < POLYGONS; p++) {
+	for (r = 0; r < COUNT(windingRules); r++) {
+	    for (c = 0; c < COUNT(cacheSizes); c++) {
+		testPolygon(&polys[p], polygonNames[p], windingRules[r],
+			    cacheSizes[c], &seed);
+	    }
+	    testBoundary(&polys[p], polygonNames[p], windingRules[r]);
+	}
+	freePolygon(&polys[p]);
+    }
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
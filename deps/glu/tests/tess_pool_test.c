@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** The mesh and the sweep of a tessellator take their storage from pools
+** that are recycled for every polygon and only freed by gluDeleteTess.
+** A tessellator reused for many polygons, in any order, large and small,
+** and after a polygon the sweep gave up on, must call back exactly what
+** a new tessellator does for each of them, for every winding rule and
+** with boundary-only output.  The polygons span many slabs and free
+** objects during the sweep, and every run must cover the region of its
+** polygon.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glu.h>
+#include "tesscheck.h"
+#include "check.h"
+
+static const GLenum windingRules[] = {
+    GLU_TESS_WINDING_ODD, GLU_TESS_WINDING_NONZERO,
+    GLU_TESS_WINDING_POSITIVE, GLU_TESS_WINDING_NEGATIVE,
+    GLU_TESS_WINDING_ABS_GEQ_TWO,
+};
+
+#define POLYGONS 7
+
+static const char *const polygonNames[POLYGONS] = {
+    "hexagon", "square with a hole", "7-pointed star", "wavy, 3000 vertices",
+    "overlapping wavy", "scribble, 60 vertices", "nested squares",
+};
+
+static void makePolygons(TessPolygon *polys, unsigned *seed)
+{
+    addRegular(&polys[0], 6, 0, 0, 1, GL_FALSE);
+    addRegular(&polys[1], 4, 0, 0, 2, GL_FALSE);
+    addRegular(&polys[1], 4, 0, 0, 1, GL_TRUE);
+    addStar(&polys[2], 7, 3, 0, 0, 1);
+    addWavy(&polys[3], 3000, 0, 0, 1, seed);
+    addWavy(&polys[4], 500, 0, 0, 1, seed);
+    addWavy(&polys[4], 500, 0.5, 0.2, 1, seed);
+    addScribble(&polys[5], 60, seed);
+    addRegular(&polys[6], 4, 0, 0, 3, GL_FALSE);
+    addRegular(&polys[6], 4, 0, 0, 2, GL_FALSE);
+    addRegular(&polys[6], 4, 0, 0, 1, GL_FALSE);
+}
+
+/* Runs polygon p on tess and compares it with the new tessellator's run */
+static void checkReused(GLUtesselator *tess, const TessPolygon *polys,
+			const TessOutput *fresh, int p, const char *when)
+{
+    TessOutput out = { 0 };
+
+    snprintf(testName, sizeof(testName), "%s, %s", polygonNames[p], when);
+    runTess(tess, &polys[p], 0, &out);
+    CHECK(out.error == 0);
+    CHECK(compareEvents(&out, &fresh[p]) == 0);
+    freeOutput(&out);
+}
+
+static void testRule(const TessPolygon *polys, GLenum windingRule,
+		     GLboolean boundaryOnly, unsigned *seed)
+{
+    TessOutput fresh[POLYGONS] = { { 0 } };
+    TessOutput failed = { 0 };
+    GLUtesselator *tess;
+    char when[80];
+    int p, round;
+
+    for (p = 0; p < POLYGONS; p++) {
+	tess = newTess(windingRule, boundaryOnly);
+	snprintf(testName, sizeof(testName), "%s, rule %d%s, new tessellator",
+		 polygonNames[p], windingRule,
+		 boundaryOnly ? ", boundary only" : "");
+	runTess(tess, &polys[p], 0, &fresh[p]);
+	CHECK(fresh[p].error == 0);
+	CHECK(coverageErrors(&polys[p], windingRule, &fresh[p], 400,
+			     seed) == 0);
+	gluDeleteTess(tess);
+    }
+
+    tess = newTess(windingRule, boundaryOnly);
+    for (round = 0; round < 3; round++) {
+	for (p = 0; p < POLYGONS; p++) {
+	    int q = round == 1 ? POLYGONS - 1 - p : p;
+
+	    snprintf(when, sizeof(when), "rule %d%s, reused, round %d",
+		     windingRule, boundaryOnly ? ", boundary only" : "", round);
+	    checkReused(tess, polys, fresh, q, when);
+	}
+    }
+
+    /* The scribble crosses itself, and the sweep stops at the first
+     * crossing when no vertex is combined.
+     */
+    snprintf(testName, sizeof(testName), "scribble without combine");
+    runTess(tess, &polys[5], TESS_NO_COMBINE, &failed);
+    CHECK(failed.error == GLU_TESS_NEED_COMBINE_CALLBACK);
+    freeOutput(&failed);
+    for (p = POLYGONS - 1; p >= 0; p--) {
+	snprintf(when, sizeof(when), "rule %d%s, reused after an error",
+		 windingRule, boundaryOnly ? ", boundary only" : "");
+	checkReused(tess, polys, fresh, p, when);
+    }
+    gluDeleteTess(tess);
+
+    for (p = 0; p < POLYGONS; p++) {
+	freeOutput(&fresh[p]);
+    }
+}
+
+int main(void)
+{
+    TessPolygon polys[POLYGONS] = { { 0 } };
+    unsigned seed = 7;
+    size_t r;
+    int p;
+
+    makePolygons(polys, &seed);
+    for (r = 0; r < COUNT(windingRules); r++) {
+	testRule(polys, windingRules[r], GL_FALSE, &seed);
+	testRule(polys, windingRules[r], GL_TRUE, &seed);
+    }
+    for (p = 0; p < POLYGONS; p++) {
+	freePolygon(&polys[p]);
+    }
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
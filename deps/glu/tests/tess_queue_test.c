@@ -0,0 +1,253 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** The sweep takes its events from a priority queue: keys inserted before
+** pqInit() are presorted in buckets, and the rest go in a 4-ary heap
+** whose nodes keep a copy of each vertex's (s,t).  Whatever the queue
+** holds, pqMinimum() and pqExtractMin() must give a vertex with the
+** smallest (s,t), like a scan of the vertices left does, through any mix
+** of inserts and deletes, with clustered, tied and extreme coordinates.
+** Ties may come out in any order, since their (s,t) are the same, so the
+** tessellation only depends on the order of distinct vertices.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mesh.h"
+#include "priorityq.h"
+#include "check.h"
+
+/* The order of the sweep, see VertLeq() in geom.h */
+static int vertLeq(const GLUvertex *u, const GLUvertex *v)
+{
+    return u->s < v->s || (u->s == v->s && u->t <= v->t);
+}
+
+static int leq(PQkey key1, PQkey key2)
+{
+    return vertLeq((GLUvertex *) key1, (GLUvertex *) key2);
+}
+
+static int sameKey(PQkey key1, PQkey key2)
+{
+    return key1 != NULL && key2 != NULL &&
+	   ((GLUvertex *) key1)->s == ((GLUvertex *) key2)->s &&
+	   ((GLUvertex *) key1)->t == ((GLUvertex *) key2)->t;
+}
+
+static double randomUnit(unsigned *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (double) (*seed >> 8) / 16777216.0;
+}
+
+enum {
+    UNIFORM, CLUSTERED, SAME_S, TIED, EXTREME, ASCENDING, DESCENDING,
+    OUTLIER, DISTRIBUTIONS
+};
+
+static const char *const distributionNames[DISTRIBUTIONS] = {
+    "uniform", "clustered", "same s", "tied", "extreme", "ascending",
+    "descending", "outlier",
+};
+
+static void setCoords(GLUvertex *v, int distribution, long i, long n,
+		      unsigned *seed)
+{
+    static const double extremes[] = {
+	-1e150, -1e10, -1, -1e-300, 0, 1e-300, 1, 1e10, 1e150,
+    };
+
+    switch (distribution) {
+      case UNIFORM:
+	v->s = randomUnit(seed);
+	v->t = randomUnit(seed);
+	break;
+      case CLUSTERED:
+	v->s = (int) (3 * randomUnit(seed)) + 1e-9 * randomUnit(seed);
+	v->t = randomUnit(seed);
+	break;
+      case SAME_S:
+	v->s = 0.5;
+	v->t = randomUnit(seed);
+	break;
+      case TIED:
+	v->s = (int) (8 * randomUnit(seed));
+	v->t = (int) (4 * randomUnit(seed));
+	break;
+      case EXTREME:
+	v->s = extremes[(int) (COUNT(extremes) * randomUnit(seed))] *
+	       (1 + randomUnit(seed));
+	v->t = extremes[(int) (COUNT(extremes) * randomUnit(seed))];
+	break;
+      case ASCENDING:
+	v->s = (double) i;
+	v->t = randomUnit(seed);
+	break;
+      case DESCENDING:
+	v->s = (double) (n - i);
+	v->t = (double) -i;
+	break;
+      default:
+	v->s = i == n / 2 ? 1e12 : randomUnit(seed);
+	v->t = randomUnit(seed);
+	break;
+    }
+}
+
+/* The vertices in the queue, and their handles */
+typedef struct {
+    GLUvertex **vertices;
+    PQhandle *handles;
+    long count;
+} Reference;
+
+static void refAdd(Reference *ref, GLUvertex *v, PQhandle handle)
+{
+    ref->vertices[ref->count] = v;
+    ref->handles[ref->count++] = handle;
+}
+
+static void refRemove(Reference *ref, long i)
+{
+    --ref->count;
+    ref->vertices[i] = ref->vertices[ref->count];
+    ref->handles[i] = ref->handles[ref->count];
+}
+
+/* Index of a smallest vertex, or -1 */
+static long refMinimum(const Reference *ref)
+{
+    long i, min = ref->count > 0 ? 0 : -1;
+
+    for (i = 1; i < ref->count; i++) {
+	if (!vertLeq(ref->vertices[min], ref->vertices[i])) min = i;
+    }
+    return min;
+}
+
+static long refFind(const Reference *ref, PQkey key)
+{
+    long i;
+
+    for (i = 0; i < ref->count; i++) {
+	if (ref->vertices[i] == key) return i;
+    }
+    return -1;
+}
+
+/* Extracts the minimum from both, and checks they agree. */
+static void extractMin(PriorityQ *pq, Reference *ref)
+{
+    long min = refMinimum(ref);
+    PQkey key, first = pqMinimum(pq);
+
+    key = pqExtractMin(pq);
+    CHECK(key == first);
+    if (min < 0) {
+	CHECK(key == NULL);
+	return;
+    }
+    CHECK(sameKey(key, ref->vertices[min]));
+    min = refFind(ref, key);
+    CHECK(min >= 0);
+    if (min >= 0) refRemove(ref, min);
+}
+
+/*
+** Inserts n vertices, initializes the queue, and then inserts, deletes
+** and extracts at random for ops operations before emptying the queue.
+*/
+static void testQueue(int distribution, long n, long ops, unsigned *seed)
+{
+    long total = n + ops, i, next = 0;
+    GLUvertex *vertices = (GLUvertex *) calloc(total + 1, sizeof(GLUvertex));
+    Reference ref;
+    PriorityQ *pq = pqNewPriorityQ(leq);
+
+    snprintf(testName, sizeof(testName), "%s, %ld vertices, %ld operations",
+	     distributionNames[distribution], n, ops);
+    ref.vertices = (GLUvertex **) malloc((total + 1) * sizeof(GLUvertex *));
+    ref.handles = (PQhandle *) malloc((total + 1) * sizeof(PQhandle));
+    ref.count = 0;
+    CHECK(vertices != NULL && ref.vertices != NULL && ref.handles != NULL &&
+	  pq != NULL);
+    if (vertices == NULL || ref.vertices == NULL || ref.handles == NULL ||
+	pq == NULL) {
+	exit(1);
+    }
+
+    for (i = 0; i < total; i++) {
+	setCoords(&vertices[i], distribution, i, total, seed);
+    }
+    for (; next < n; next++) {
+	refAdd(&ref, &vertices[next], pqInsert(pq, &vertices[next]));
+    }
+    CHECK(pqInit(pq));
+    CHECK(pqIsEmpty(pq) == (n == 0));
+
+    for (i = 0; i < ops; i++) {
+	double op = randomUnit(seed);
+
+	if (op < 0.4) {
+	    extractMin(pq, &ref);
+	} else if (op < 0.75) {
+	    refAdd(&ref, &vertices[next], pqInsert(pq, &vertices[next]));
+	    next++;
+	} else if (ref.count > 0) {
+	    long k = (long) (ref.count * randomUnit(seed));
+
+	    pqDelete(pq, ref.handles[k]);
+	    refRemove(&ref, k);
+	}
+	CHECK(pqIsEmpty(pq) == (ref.count == 0));
+    }
+
+    /* Emptying a large queue this way is quadratic; sort instead */
+    while (ref.count > 0 && ref.count <= 5000) {
+	extractMin(pq, &ref);
+    }
+    if (ref.count > 0) {
+	GLUvertex *prev = NULL;
+	PQkey key;
+
+	for (i = 0; (key = pqExtractMin(pq)) != NULL; i++) {
+	    CHECK(prev == NULL || vertLeq(prev, (GLUvertex *) key));
+	    prev = (GLUvertex *) key;
+	}
+	CHECK(i == ref.count);
+	ref.count = 0;
+    }
+    CHECK(pqIsEmpty(pq));
+    CHECK(pqMinimum(pq) == NULL);
+    CHECK(pqExtractMin(pq) == NULL);
+
+    pqDeletePriorityQ(pq);
+    free(ref.vertices);
+    free(ref.handles);
+    free(vertices);
+}
+
+int main(void)
+{
+    static const long sizes[][2] = {
+	{ 0, 0 }, { 1, 0 }, { 0, 5 }, { 2, 4 }, { 3, 40 }, { 31, 100 },
+	{ 32, 100 }, { 33, 100 }, { 100, 1000 }, { 1000, 3000 },
+	{ 5000, 2000 }, { 200000, 0 },
+    };
+    unsigned seed = 8;
+    size_t s;
+    int d;
+
+    for (d = 0; d < DISTRIBUTIONS; d++) {
+	for (s = 0; s < COUNT(sizes); s++) {
+	    testQueue(d, sizes[s][0], sizes[s][1], &seed);
+	}
+    }
+
+    if (failures) {
+	fprintf(stderr, "%d check(s) failed\n", failures);
+	return 1;
+    }
+    return 0;
+}
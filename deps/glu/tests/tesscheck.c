@@ -0,0 +1,584 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glu.h>
+#include "tesscheck.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Grows an array to hold count + 1 elements; exits when out of memory. */
+static void *grow(void *array, int count, int *max, size_t size)
+{
+    if (count >= *max) {
+	*max = *max ? 2 * *max : 64;
+	array = realloc(array, *max * size);
+	if (array == NULL) abort();
+    }
+    return array;
+}
+
+static double randomUnit(unsigned *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (double) (*seed >> 8) / 16777216.0;
+}
+
+TessVertex *addContour(TessPolygon *poly, int count)
+{
+    int i;
+
+    poly->contourSizes = (int *) grow(poly->contourSizes, poly->contourCount,
+				      &poly->contourMax, sizeof(int));
+    poly->contourSizes[poly->contourCount++] = count;
+    while (poly->vertexCount + count > poly->vertexMax) {
+	poly->vertices = (TessVertex *)
+	    grow(poly->vertices, poly->vertexMax, &poly->vertexMax,
+		 sizeof(TessVertex));
+    }
+    for (i = 0; i < count; i++) {
+	TessVertex *v = &poly->vertices[poly->vertexCount + i];
+
+	v->coords[0] = v->coords[1] = v->coords[2] = 0;
+	v->id = poly->vertexCount + i;
+    }
+    poly->vertexCount += count;
+    return &poly->vertices[poly->vertexCount - count];
+}
+
+void freePolygon(TessPolygon *poly)
+{
+    free(poly->vertices);
+    free(poly->contourSizes);
+    memset(poly, 0, sizeof(*poly));
+}
+
+static void setPolar(TessVertex *v, double x, double y, double r, double a)
+{
+    v->coords[0] = x + r * cos(a);
+    v->coords[1] = y + r * sin(a);
+}
+
+void addRegular(TessPolygon *poly, int count, double x, double y,
+		double radius, GLboolean cw)
+{
+    TessVertex *v = addContour(poly, count);
+    int i;
+
+    for (i = 0; i < count; i++) {
+	setPolar(&v[i], x, y, radius, (cw ? -2 : 2) * M_PI * i / count);
+    }
+}
+
+void addStar(TessPolygon *poly, int count, int step, double x, double y,
+	     double radius)
+{
+    TessVertex *v = addContour(poly, count);
+    int i;
+
+    for (i = 0; i < count; i++) {
+	setPolar(&v[i], x, y, radius, 2 * M_PI * (i * step % count) / count);
+    }
+}
+
+void addWavy(TessPolygon *poly, int count, double x, double y,
+	     double radius, unsigned *seed)
+{
+    TessVertex *v = addContour(poly, count);
+    int i;
+
+    for (i = 0; i < count; i++) {
+	setPolar(&v[i], x, y, radius * (0.3 + 0.7 * randomUnit(seed)),
+		 2 * M_PI * i / count);
+    }
+}
+
+void addScribble(TessPolygon *poly, int count, unsigned *seed)
+{
+    TessVertex *v = addContour(poly, count);
+    int i;
+
+    for (i = 0; i < count; i++) {
+	v[i].coords[0] = 2 * randomUnit(seed) - 1;
+	v[i].coords[1] = 2 * randomUnit(seed) - 1;
+    }
+}
+
+GLUtesselator *newTess(GLenum windingRule, GLboolean boundaryOnly)
+{
+    GLUtesselator *tess = gluNewTess();
+
+    if (tess == NULL) abort();
+    gluTessProperty(tess, GLU_TESS_WINDING_RULE, windingRule);
+    gluTessProperty(tess, GLU_TESS_BOUNDARY_ONLY, boundaryOnly);
+    gluTessNormal(tess, 0, 0, 1);
+    return tess;
+}
+
+/* Callbacks; the polygon data is the TessOutput */
+
+static TessEvent *addEvent(TessOutput *out, int kind)
+{
+    TessEvent *e;
+
+    out->events = (TessEvent *) grow(out->events, out->eventCount,
+				     &out->eventMax, sizeof(TessEvent));
+    e = &out->events[out->eventCount++];
+    memset(e, 0, sizeof(*e));
+    e->kind = kind;
+    return e;
+}
+
+static void GLAPIENTRY beginData(GLenum type, void *polygonData)
+{
+    TessOutput *out = (TessOutput *) polygonData;
+
+    addEvent(out, TESS_BEGIN)->value = type;
+    out->primitiveCount++;
+}
+
+static void GLAPIENTRY vertexData(void *data, void *polygonData)
+{
+    TessEvent *e = addEvent((TessOutput *) polygonData, TESS_VERTEX);
+
+    e->data = (const TessVertex *) data;
+    memcpy(e->coords, e->data->coords, sizeof(e->coords));
+}
+
+static void GLAPIENTRY edgeFlagData(GLboolean flag, void *polygonData)
+{
+    addEvent((TessOutput *) polygonData, TESS_EDGE_FLAG)->value = flag;
+}
+
+static void GLAPIENTRY endData(void *polygonData)
+{
+    addEvent((TessOutput *) polygonData, TESS_END);
+}
+
+static void GLAPIENTRY combineData(GLdouble coords[3], void *data[4],
+				   GLfloat weight[4], void **outData,
+				   void *polygonData)
+{
+    TessOutput *out = (TessOutput *) polygonData;
+    TessVertex *v = (TessVertex *) malloc(sizeof(TessVertex));
+
+    (void) data;
+    (void) weight;
+    if (v == NULL) abort();
+    memcpy(v->coords, coords, sizeof(v->coords));
+    v->id = -1;
+    out->combined = (TessVertex **) grow(out->combined, out->combineCount,
+					 &out->combinedMax,
+					 sizeof(TessVertex *));
+    out->combined[out->combineCount++] = v;
+    *outData = v;
+}
+
+static void GLAPIENTRY noCombineData(GLdouble coords[3], void *data[4],
+				     GLfloat weight[4], void **outData,
+				     void *polygonData)
+{
+    (void) coords;
+    (void) data;
+    (void) weight;
+    (void) polygonData;
+    *outData = NULL;
+}
+
+static void GLAPIENTRY errorData(GLenum error, void *polygonData)
+{
+    ((TessOutput *) polygonData)->error = error;
+}
+
+static void addTriangle(TessOutput *out, const TessEvent *a,
+			const TessEvent *b, const TessEvent *c,
+			const GLboolean *flags);
+
+static void GLAPIENTRY indexedTriangles(GLsizei vertexCount,
+				       void **vertexData, GLsizei indexCount,
+				       const GLuint *indices,
+				       void *polygonData)
+{
+    static const GLboolean flagged[3] = { GL_TRUE, GL_TRUE, GL_TRUE };
+    TessOutput *out = (TessOutput *) polygonData;
+    TessEvent v[3];
+    int *uses = (int *) calloc(vertexCount + 1, sizeof(int));
+    GLsizei i, j;
+
+    if (uses == NULL) abort();
+    out->indexedCount++;
+    if (indexCount % 3 != 0) out->indexErrors++;
+    for (i = 0; i + 2 < indexCount; i += 3) {
+	for (j = 0; j < 3; j++) {
+	    const TessVertex *data = NULL;
+
+	    if (indices[i + j] < (GLuint) vertexCount) {
+		data = (const TessVertex *) vertexData[indices[i + j]];
+		uses[indices[i + j]]++;
+	    } else {
+		out->indexErrors++;
+	    }
+	    memset(&v[j], 0, sizeof(v[j]));
+	    v[j].kind = TESS_VERTEX;
+	    v[j].data = data;
+	    if (data != NULL) {
+		memcpy(v[j].coords, data->coords, sizeof(v[j].coords));
+	    }
+	}
+	addTriangle(out, &v[0], &v[1], &v[2], flagged);
+    }
+    for (i = 0; i < vertexCount; i++) {
+	if (uses[i] == 0) out->indexErrors++;
+	for (j = 0; j < i; j++) {
+	    if (vertexData[j] == vertexData[i]) out->indexErrors++;
+	}
+    }
+    free(uses);
+}
+
+static void addTriangle(TessOutput *out, const TessEvent *a,
+			const TessEvent *b, const TessEvent *c,
+			const GLboolean *flags)
+{
+    TessTriangle *t;
+
+    out->triangles = (TessTriangle *)
+	grow(out->triangles, out->triangleCount, &out->triangleMax,
+	     sizeof(TessTriangle));
+    t = &out->triangles[out->triangleCount++];
+    memcpy(t->coords[0], a->coords, sizeof(t->coords[0]));
+    memcpy(t->coords[1], b->coords, sizeof(t->coords[1]));
+    memcpy(t->coords[2], c->coords, sizeof(t->coords[2]));
+    t->flags[0] = flags[0];
+    t->flags[1] = flags[1];
+    t->flags[2] = flags[2];
+}
+
+/*
+** Splits the triangle primitives into triangles, counterclockwise ones
+** as GL would draw them.  Strips and fans are only made without edge
+** flags, so their edges are all flagged.
+*/
+static void findTriangles(TessOutput *out)
+{
+    static const GLboolean flagged[3] = { GL_TRUE, GL_TRUE, GL_TRUE };
+    const TessEvent *v[3];
+    GLboolean flags[3], flag = GL_TRUE;
+    GLenum type = 0;
+    int i, n = 0;
+
+    for (i = 0; i < out->eventCount; i++) {
+	const TessEvent *e = &out->events[i];
+
+	switch (e->kind) {
+	  case TESS_BEGIN:
+	    type = e->value;
+	    flag = GL_TRUE;
+	    n = 0;
+	    break;
+	  case TESS_EDGE_FLAG:
+	    flag = (GLboolean) e->value;
+	    break;
+	  case TESS_END:
+	    break;
+	  case TESS_VERTEX:
+	    if (type == GL_TRIANGLES) {
+		flags[n % 3] = flag;
+		v[n++ % 3] = e;
+		if (n % 3 == 0) addTriangle(out, v[0], v[1], v[2], flags);
+	    } else if (type == GL_TRIANGLE_STRIP) {
+		if (n >= 2) {
+		    if (n % 2 == 0) {
+			addTriangle(out, v[0], v[1], e, flagged);
+		    } else {
+			addTriangle(out, v[1], v[0], e, flagged);
+		    }
+		    v[0] = v[1];
+		}
+		v[n < 2 ? n : 1] = e;
+		n++;
+	    } else if (type == GL_TRIANGLE_FAN) {
+		if (n >= 2) addTriangle(out, v[0], v[1], e, flagged);
+		v[n < 2 ? n : 1] = e;
+		n++;
+	    }
+	    break;
+	}
+    }
+}
+
+void runTess(GLUtesselator *tess, const TessPolygon *poly, int flags,
+	     TessOutput *out)
+{
+    int c, i, k = 0;
+
+    gluTessCallback(tess, GLU_TESS_BEGIN_DATA, (_GLUfuncptr) beginData);
+    gluTessCallback(tess, GLU_TESS_VERTEX_DATA, (_GLUfuncptr) vertexData);
+    gluTessCallback(tess, GLU_TESS_END_DATA, (_GLUfuncptr) endData);
+    gluTessCallback(tess, GLU_TESS_EDGE_FLAG_DATA,
+		    (flags & TESS_EDGE_FLAGS) ? (_GLUfuncptr) edgeFlagData
+					      : NULL);
+    gluTessCallback(tess, GLU_TESS_COMBINE_DATA,
+		    (flags & TESS_NO_COMBINE) ? (_GLUfuncptr) noCombineData
+					      : (_GLUfuncptr) combineData);
+    gluTessCallback(tess, GLU_TESS_ERROR_DATA, (_GLUfuncptr) errorData);
+    gluTessCallback(tess, GLU_TESS_INDEXED_TRIANGLES_EXT,
+		    (flags & TESS_INDEXED) ? (_GLUfuncptr) indexedTriangles
+					   : NULL);
+
+    gluTessBeginPolygon(tess, out);
+    for (c = 0; c < poly->contourCount; c++) {
+	gluTessBeginContour(tess);
+	for (i = 0; i < poly->contourSizes[c]; i++, k++) {
+	    gluTessVertex(tess, poly->vertices[k].coords, &poly->vertices[k]);
+	}
+	gluTessEndContour(tess);
+    }
+    gluTessEndPolygon(tess);
+    findTriangles(out);
+}
+
+void freeOutput(TessOutput *out)
+{
+    int i;
+
+    for (i = 0; i < out->combineCount; i++) {
+	free(out->combined[i]);
+    }
+    free(out->combined);
+    free(out->events);
+    free(out->triangles);
+    memset(out, 0, sizeof(*out));
+}
+
+int compareEvents(const TessOutput *a, const TessOutput *b)
+{
+    int i, n = a->eventCount < b->eventCount ? a->eventCount
+					     : b->eventCount;
+    int differences = abs(a->eventCount - b->eventCount);
+
+    for (i = 0; i < n; i++) {
+	const TessEvent *x = &a->events[i], *y = &b->events[i];
+
+	if (x->kind != y->kind || x->value != y->value ||
+	    memcmp(x->coords, y->coords, sizeof(x->coords)) != 0) {
+	    differences++;
+	}
+    }
+    return differences;
+}
+
+static int compareCoords(const GLdouble *a, const GLdouble *b)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+	if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compareTriangle(const void *a, const void *b)
+{
+    const TessTriangle *x = (const TessTriangle *) a;
+    const TessTriangle *y = (const TessTriangle *) b;
+    int i, c;
+
+    for (i = 0; i < 3; i++) {
+	c = compareCoords(x->coords[i], y->coords[i]);
+	if (c != 0) return c;
+    }
+    for (i = 0; i < 3; i++) {
+	if (x->flags[i] != y->flags[i]) return x->flags[i] < y->flags[i] ? -1
+									 : 1;
+    }
+    return 0;
+}
+
+/* The triangles, each rotated to start at its smallest vertex, sorted. */
+static TessTriangle *sortedTriangles(const TessOutput *out)
+{
+    TessTriangle *t = (TessTriangle *)
+	malloc((out->triangleCount + 1) * sizeof(TessTriangle));
+    int i, j;
+
+    if (t == NULL) abort();
+    for (i = 0; i < out->triangleCount; i++) {
+	const TessTriangle *s = &out->triangles[i];
+	int first = 0;
+
+	for (j = 1; j < 3; j++) {
+	    if (compareCoords(s->coords[j], s->coords[first]) < 0) first = j;
+	}
+	for (j = 0; j < 3; j++) {
+	    memcpy(t[i].coords[j], s->coords[(first + j) % 3],
+		   sizeof(t[i].coords[j]));
+	    t[i].flags[j] = s->flags[(first + j) % 3];
+	}
+    }
+    qsort(t, out->triangleCount, sizeof(TessTriangle), compareTriangle);
+    return t;
+}
+
+int compareTriangles(const TessOutput *a, const TessOutput *b)
+{
+    TessTriangle *x = sortedTriangles(a), *y = sortedTriangles(b);
+    int i = 0, j = 0, differences = 0;
+
+    while (i < a->triangleCount && j < b->triangleCount) {
+	int c = compareTriangle(&x[i], &y[j]);
+
+	if (c == 0) {
+	    i++;
+	    j++;
+	} else {
+	    differences++;
+	    if (c < 0) i++; else j++;
+	}
+    }
+    differences += a->triangleCount - i + b->triangleCount - j;
+    free(x);
+    free(y);
+    return differences;
+}
+
+/* Coverage */
+
+static double distanceToSegment(const double *p, const GLdouble *a,
+				const GLdouble *b)
+{
+    double dx = b[0] - a[0], dy = b[1] - a[1];
+    double length2 = dx * dx + dy * dy;
+    double u = length2 > 0 ? ((p[0] - a[0]) * dx + (p[1] - a[1]) * dy) /
+			     length2 : 0;
+
+    if (u < 0) u = 0;
+    if (u > 1) u = 1;
+    return hypot(p[0] - a[0] - u * dx, p[1] - a[1] - u * dy);
+}
+
+/* Winding number of the edge from a to b around p */
+static int crossing(const double *p, const GLdouble *a, const GLdouble *b)
+{
+    double side = (b[0] - a[0]) * (p[1] - a[1]) -
+		  (p[0] - a[0]) * (b[1] - a[1]);
+
+    if (a[1] <= p[1] && b[1] > p[1] && side > 0) return 1;
+    if (a[1] > p[1] && b[1] <= p[1] && side < 0) return -1;
+    return 0;
+}
+
+static GLboolean isInside(GLenum windingRule, int winding)
+{
+    switch (windingRule) {
+      case GLU_TESS_WINDING_ODD:
+	return (winding & 1) != 0;
+      case GLU_TESS_WINDING_NONZERO:
+	return winding != 0;
+      case GLU_TESS_WINDING_POSITIVE:
+	return winding > 0;
+      case GLU_TESS_WINDING_NEGATIVE:
+	return winding < 0;
+      default:
+	return winding >= 2 || winding <= -2;
+    }
+}
+
+/*
+** Winding number of poly around p, or INT_MIN if p is within eps of an
+** edge.
+*/
+static int polygonWinding(const TessPolygon *poly, const double *p,
+			  double eps)
+{
+    int c, i, first = 0, winding = 0;
+
+    for (c = 0; c < poly->contourCount; first += poly->contourSizes[c++]) {
+	int n = poly->contourSizes[c];
+
+	for (i = 0; i < n; i++) {
+	    const GLdouble *a = poly->vertices[first + i].coords;
+	    const GLdouble *b = poly->vertices[first + (i + 1) % n].coords;
+
+	    if (distanceToSegment(p, a, b) < eps) return INT_MIN;
+	    winding += crossing(p, a, b);
+	}
+    }
+    return winding;
+}
+
+/*
+** Number of triangles of out around p, or the winding number of its
+** contours; -1 if p is within eps of an edge.
+*/
+static int outputCover(const TessOutput *out, const double *p, double eps)
+{
+    int i, j, cover = 0;
+
+    for (i = 0; i < out->triangleCount; i++) {
+	const TessTriangle *t = &out->triangles[i];
+	int winding = 0;
+
+	for (j = 0; j < 3; j++) {
+	    if (distanceToSegment(p, t->coords[j], t->coords[(j + 1) % 3]) <
+		eps) {
+		return -1;
+	    }
+	    winding += crossing(p, t->coords[j], t->coords[(j + 1) % 3]);
+	}
+	if (winding != 0) cover++;
+    }
+    for (i = 0; i < out->eventCount; i++) {
+	const TessEvent *first = &out->events[i + 1], *last;
+
+	if (out->events[i].kind != TESS_BEGIN ||
+	    out->events[i].value != GL_LINE_LOOP) {
+	    continue;
+	}
+	for (last = first; last->kind == TESS_VERTEX; last++) {
+	    const TessEvent *next = last[1].kind == TESS_VERTEX ? last + 1
+								: first;
+
+	    if (distanceToSegment(p, last->coords, next->coords) < eps) {
+		return -1;
+	    }
+	    cover += crossing(p, last->coords, next->coords);
+	}
+    }
+    return cover;
+}
+
+int coverageErrors(const TessPolygon *poly, GLenum windingRule,
+		   const TessOutput *out, int samples, unsigned *seed)
+{
+    double min[2], max[2], eps, p[2];
+    int i, k, errors = 0;
+
+    if (poly->vertexCount == 0) return 0;
+    for (k = 0; k < 2; k++) {
+	min[k] = max[k] = poly->vertices[0].coords[k];
+	for (i = 1; i < poly->vertexCount; i++) {
+	    double x = poly->vertices[i].coords[k];
+
+	    if (x < min[k]) min[k] = x;
+	    if (x > max[k]) max[k] = x;
+	}
+    }
+    eps = 1e-7 * (max[0] - min[0] + max[1] - min[1]);
+    for (i = 0; i < samples; i++) {
+	int winding, cover;
+
+	for (k = 0; k < 2; k++) {
+	    p[k] = min[k] + (max[k] - min[k]) * (1.2 * randomUnit(seed) - 0.1);
+	}
+	winding = polygonWinding(poly, p, eps);
+	cover = outputCover(out, p, eps);
+	if (winding == INT_MIN || cover < 0) continue;
+	if (cover != (isInside(windingRule, winding) ? 1 : 0)) errors++;
+    }
+    return errors;
+}
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+** Helpers for the tessellator tests: polygons in the z = 0 plane, runs of
+** a tessellator that record what its callbacks are given, and checks of
+** the recorded output against the region the polygon covers under a
+** winding rule, sampled at random points.
+*/
+
+#ifndef __tesscheck_h__
+#define __tesscheck_h__
+
+#include <GL/glu.h>
+
+/*
+** The vertex data passed to gluTessVertex, and made by the combine
+** callback.  id is the position in the polygon, or -1 for combined
+** vertices.
+*/
+typedef struct {
+    GLdouble coords[3];
+    int id;
+} TessVertex;
+
+/* Contours, stored one after another */
+typedef struct {
+    TessVertex *vertices;
+    int vertexCount, vertexMax;
+    int *contourSizes;
+    int contourCount, contourMax;
+} TessPolygon;
+
+/* One callback, in the order they were made */
+typedef struct {
+    enum { TESS_BEGIN, TESS_VERTEX, TESS_EDGE_FLAG, TESS_END } kind;
+    GLenum value;		/* primitive type, or edge flag */
+    GLdouble coords[3];		/* of a vertex */
+    const TessVertex *data;	/* of a vertex */
+} TessEvent;
+
+/* A triangle, with the edge flag of the edge that starts at each vertex */
+typedef struct {
+    GLdouble coords[3][3];
+    GLboolean flags[3];
+} TessTriangle;
+
+typedef struct {
+    TessEvent *events;
+    int eventCount, eventMax;
+    TessTriangle *triangles;	/* of every triangle primitive */
+    int triangleCount, triangleMax;
+    int primitiveCount;
+    int combineCount;
+    GLenum error;		/* last error reported, or 0 */
+
+    /*
+    ** GLU_TESS_INDEXED_TRIANGLES_EXT calls, whose triangles are added to
+    ** the others, and the indices in them that are out of range, and
+    ** vertices listed twice or not used.
+    */
+    int indexedCount;
+    int indexErrors;
+
+    /* vertices made by the combine callback, freed by freeOutput() */
+    TessVertex **combined;
+    int combinedMax;
+} TessOutput;
+
+/* Flags for runTess() */
+#define TESS_EDGE_FLAGS		0x1	/* register an edge flag callback */
+#define TESS_NO_COMBINE		0x2	/* combine callback makes no vertex */
+#define TESS_INDEXED		0x4	/* register an indexed triangle callback */
+
+/* Adds a contour of count vertices, and returns them to be filled in. */
+extern TessVertex *addContour(TessPolygon *poly, int count);
+extern void freePolygon(TessPolygon *poly);
+
+/*
+** Contours: a regular polygon, counterclockwise unless cw is set; a star
+** that crosses itself, joining every step-th of count points on a
+** circle; a simple polygon with count vertices at random radii; and
+** count random points in [-1, 1] x [-1, 1], which cross a lot.
+*/
+extern void addRegular(TessPolygon *poly, int count, double x, double y,
+		       double radius, GLboolean cw);
+extern void addStar(TessPolygon *poly, int count, int step, double x,
+		    double y, double radius);
+extern void addWavy(TessPolygon *poly, int count, double x, double y,
+		    double radius, unsigned *seed);
+extern void addScribble(TessPolygon *poly, int count, unsigned *seed);
+
+/* A tessellator for the z = 0 plane, with the given properties. */
+extern GLUtesselator *newTess(GLenum windingRule, GLboolean boundaryOnly);
+
+/*
+** Tessellates poly with the begin, vertex, end, combine and error
+** callbacks, and the ones flags asks for, and records them in out,
+** which must be zeroed or freed.
+*/
+extern void runTess(GLUtesselator *tess, const TessPolygon *poly,
+		    int flags, TessOutput *out);
+extern void freeOutput(TessOutput *out);
+
+/*
+** Number of differences between two runs: callback by callback, or
+** between their triangles in any order.  Triangles are the same if
+** their vertices and edge flags are, starting from any vertex.
+*/
+extern int compareEvents(const TessOutput *a, const TessOutput *b);
+extern int compareTriangles(const TessOutput *a, const TessOutput *b);
+
+/*
+** Number of samples random points in and around poly at which out does
+** not cover the region poly covers under windingRule exactly once: with
+** its triangles, or with the contours of boundary-only output, which
+** must wind once around the region and not at all around the rest.
+** Points near an edge of poly or of out are not counted.
+*/
+extern int coverageErrors(const TessPolygon *poly, GLenum windingRule,
+			  const TessOutput *out, int samples,
+			  unsigned *seed);
+
+#endif /* __tesscheck_h__ */